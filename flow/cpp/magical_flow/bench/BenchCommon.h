@@ -0,0 +1,88 @@
+/**
+ * @file BenchCommon.h
+ * @brief The inputs shared by the micro-benchmarks: the example designs and the synthetic scaled layouts
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_BENCH_COMMON_H_
+#define MAGICAL_FLOW_BENCH_COMMON_H_
+
+#include <cstdlib>
+#include <memory>
+#include "db/DesignDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace bench
+{
+    /// @brief an example design of examples/
+    struct ExampleDesign
+    {
+        const char *name; ///< The name of the example, the directory under examples/
+        const char *netlist; ///< The netlist, relative to the directory of the example
+        bool isHspice; ///< Whether the netlist is in hspice syntax. Otherwise spectre
+    };
+
+    /// @brief the example designs, as their json files name them
+    static const ExampleDesign EXAMPLE_DESIGNS[] = {
+        {"ota1", "ota1.sp", false},
+        {"ota2", "ota2.sp", false},
+        {"ota3", "Telescopic_Three_stage_flow.sp", false},
+        {"comp", "comp.sp", false},
+        {"adc1", "CTDSM_TOP.sp", true},
+        {"adc2", "CTDSM_CORE_NEW_hspice.sp", true},
+    };
+
+    /// @brief get the examples/ directory: $MAGICAL_EXAMPLES_DIR if set, otherwise the one of the source tree
+    inline std::string examplesDir()
+    {
+        const char *env = std::getenv("MAGICAL_EXAMPLES_DIR");
+        if (env != nullptr)
+        {
+            return std::string(env) + "/";
+        }
+#ifdef MAGICAL_FLOW_EXAMPLES_DIR
+        return std::string(MAGICAL_FLOW_EXAMPLES_DIR) + "/";
+#else
+        return "examples/";
+#endif
+    }
+
+    /// @brief get a writable directory for the temporary files: $TMPDIR if set, otherwise /tmp
+    inline std::string tempDir()
+    {
+        const char *env = std::getenv("TMPDIR");
+        return std::string(env != nullptr ? env : "/tmp") + "/";
+    }
+
+    /// @brief get the technology of the mock PDK of the examples
+    /// @return the technology database, parsed once
+    std::shared_ptr<const TechDB> mockTechDB();
+
+    /// @brief parse the netlist of an example design
+    /// @param first: the example design
+    /// @param second: the design database to fill
+    /// @return whether the parsing is successful
+    bool parseExample(const ExampleDesign &design, DesignDB &designDB);
+
+    /// @brief fill a layout with a grid of rectangles, spread over the layers round-robin, as a placed circuit of the given size
+    /// @param first: the layout, initialized with its layers
+    /// @param second: the number of rectangles
+    void fillSyntheticLayout(Layout &layout, IndexType numRects);
+
+    /// @brief make a rectilinear polygon: a staircase of steps, closed by its bottom-right corner
+    /// @param first: the number of steps
+    /// @param second: the offset of the polygon
+    /// @return the points of the polygon
+    std::vector<XY<LocType>> staircasePolygon(IndexType numSteps, LocType offset);
+
+    /// @brief register the benchmarks of the netlists of the example designs, one per design
+    void registerDesignBenchmarks();
+
+    /// @brief register the benchmarks of the GDSII files of the example designs, one per file
+    void registerLayoutBenchmarks();
+}
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_BENCH_COMMON_H_
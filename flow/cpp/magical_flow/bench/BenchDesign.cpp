@@ -0,0 +1,187 @@
+/**
+ * @file BenchDesign.cpp
+ * @brief The micro-benchmarks of the netlist level on the example and the synthetic designs: parsing, the hierarchy, the current flow and the flattening
+ * @date 10/14/2026
+ */
+
+#include <benchmark/benchmark.h>
+#include "BenchCommon.h"
+#include "csflow/CSFlow.h"
+#include "db/SyntheticDesign.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace bench
+{
+    namespace
+    {
+        /// @brief parse the netlist of an example into a fresh database
+        void benchParseNetlist(::benchmark::State &state, const ExampleDesign &design)
+        {
+            for (auto _ : state)
+            {
+                DesignDB designDB;
+                if (!parseExample(design, designDB))
+                {
+                    state.SkipWithError("cannot parse the netlist");
+                    return;
+                }
+                ::benchmark::DoNotOptimize(designDB.numCkts());
+            }
+        }
+
+        /// @brief find the root circuit of an example, from a cold hierarchy each time
+        void benchFindRootCkt(::benchmark::State &state, const ExampleDesign &design)
+        {
+            DesignDB designDB;
+            if (!parseExample(design, designDB))
+            {
+                state.SkipWithError("cannot parse the netlist");
+                return;
+            }
+            for (auto _ : state)
+            {
+                designDB.invalidateHierarchy();
+                ::benchmark::DoNotOptimize(designDB.findRootCkt());
+            }
+            state.counters["ckts"] = designDB.numCkts();
+        }
+
+        /// @brief compute the current flow of every circuit of an example but the devices
+        void benchComputeCurrentFlow(::benchmark::State &state, const ExampleDesign &design)
+        {
+            DesignDB designDB;
+            if (!parseExample(design, designDB))
+            {
+                state.SkipWithError("cannot parse the netlist");
+                return;
+            }
+            CSFlow csflow(designDB);
+            IndexType numPaths = 0;
+            for (auto _ : state)
+            {
+                numPaths = 0;
+                for (IndexType cktIdx = 0; cktIdx < designDB.numCkts(); ++cktIdx)
+                {
+                    auto &ckt = designDB.subCkt(cktIdx);
+                    if (MfUtil::isImplTypeDevice(ckt.implType()))
+                    {
+                        continue;
+                    }
+                    csflow.computeCurrentFlow(ckt);
+                    numPaths += csflow.numCurrentPaths();
+                }
+                ::benchmark::DoNotOptimize(numPaths);
+            }
+            state.counters["paths"] = numPaths;
+        }
+
+        /// @brief the synthetic design of a scale: two levels under the top, the fan-out given, and 64 devices per leaf
+        /// @param the fan-out. 4, 8, 16 and 40 give about 1k, 4k, 16k and 100k devices
+        SyntheticSpec syntheticSpec(IndexType fanOut)
+        {
+            SyntheticSpec spec;
+            spec.depth = 2;
+            spec.fanOut = fanOut;
+            spec.devicesPerLeaf = 64;
+            return spec;
+        }
+    }
+
+    /// @brief generate the synthetic designs
+    void BM_SyntheticGenerate(::benchmark::State &state)
+    {
+        for (auto _ : state)
+        {
+            DesignDB designDB;
+            designDB.setTechDB(mockTechDB());
+            ::benchmark::DoNotOptimize(SyntheticDesign(designDB).generate(syntheticSpec(state.range(0))));
+        }
+        state.counters["devices"] = static_cast<double>(state.range(0) * state.range(0) * 64);
+    }
+    BENCHMARK(BM_SyntheticGenerate)->Arg(4)->Arg(8)->Arg(16)->Arg(40)->Unit(::benchmark::kMillisecond);
+
+    /// @brief find the root circuit of the synthetic designs, from a cold hierarchy each time
+    void BM_SyntheticFindRootCkt(::benchmark::State &state)
+    {
+        DesignDB designDB;
+        SyntheticDesign(designDB).generate(syntheticSpec(state.range(0)));
+        for (auto _ : state)
+        {
+            designDB.invalidateHierarchy();
+            ::benchmark::DoNotOptimize(designDB.findRootCkt());
+        }
+        state.counters["ckts"] = designDB.numCkts();
+    }
+    BENCHMARK(BM_SyntheticFindRootCkt)->Arg(4)->Arg(8)->Arg(16)->Arg(40)->Unit(::benchmark::kMicrosecond);
+
+    /// @brief compute the current flow of every sub circuit of the synthetic designs
+    void BM_SyntheticCurrentFlow(::benchmark::State &state)
+    {
+        DesignDB designDB;
+        SyntheticDesign(designDB).generate(syntheticSpec(state.range(0)));
+        CSFlow csflow(designDB);
+        IndexType numPaths = 0;
+        for (auto _ : state)
+        {
+            numPaths = 0;
+            for (IndexType cktIdx = 0; cktIdx < designDB.numCkts(); ++cktIdx)
+            {
+                auto &ckt = designDB.subCkt(cktIdx);
+                if (!MfUtil::isImplTypeDevice(ckt.implType()))
+                {
+                    csflow.computeCurrentFlow(ckt);
+                    numPaths += csflow.numCurrentPaths();
+                }
+            }
+            ::benchmark::DoNotOptimize(numPaths);
+        }
+        state.counters["paths"] = numPaths;
+    }
+    BENCHMARK(BM_SyntheticCurrentFlow)->Arg(4)->Arg(8)->Arg(16)->Arg(40)->Unit(::benchmark::kMillisecond);
+
+    /// @brief flatten the device layouts of the synthetic designs bottom-up, as the placement of each level does
+    void BM_SyntheticFlatten(::benchmark::State &state)
+    {
+        DesignDB designDB;
+        designDB.setTechDB(mockTechDB());
+        SyntheticDesign(designDB).generate(syntheticSpec(state.range(0)));
+        designDB.findRootCkt();
+        std::vector<IndexType> cells;
+        for (IndexType cktIdx : designDB.hierarchy().bottomUpOrder())
+        {
+            if (!MfUtil::isImplTypeDevice(designDB.subCkt(cktIdx).implType()))
+            {
+                cells.emplace_back(cktIdx);
+            }
+        }
+        const IndexType numLayers = designDB.techDB().numLayers();
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            for (IndexType cktIdx : cells)
+            {
+                designDB.subCkt(cktIdx).layout().init(numLayers);
+            }
+            state.ResumeTiming();
+            for (IndexType cktIdx : cells)
+            {
+                designDB.insertSubLayouts(cktIdx, false);
+            }
+        }
+        state.counters["rects"] = designDB.subCkt(cells.back()).layout().numRects(0);
+    }
+    BENCHMARK(BM_SyntheticFlatten)->Arg(4)->Arg(8)->Arg(16)->Arg(40)->Unit(::benchmark::kMillisecond);
+
+    void registerDesignBenchmarks()
+    {
+        for (const auto &design : EXAMPLE_DESIGNS)
+        {
+            ::benchmark::RegisterBenchmark((std::string("ParseNetlist/") + design.name).c_str(), benchParseNetlist, design)->Unit(::benchmark::kMillisecond);
+            ::benchmark::RegisterBenchmark((std::string("FindRootCkt/") + design.name).c_str(), benchFindRootCkt, design)->Unit(::benchmark::kMicrosecond);
+            ::benchmark::RegisterBenchmark((std::string("ComputeCurrentFlow/") + design.name).c_str(), benchComputeCurrentFlow, design)->Unit(::benchmark::kMicrosecond);
+        }
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,309 @@
+/**
+ * @file BenchLayout.cpp
+ * @brief The micro-benchmarks of the layout level: GDSII reading and writing, the sub layout insertion and the polygon slicing
+ * @date 10/14/2026
+ */
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <sstream>
+#include "BenchCommon.h"
+#include "parser/ParseGDS.h"
+#include "parser/GdsStreamReader.h"
+#include "util/Polygon2Rect.h"
+#include "writer/GdsBatchWriter.h"
+#include "writer/GdsWriter.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace bench
+{
+    namespace
+    {
+        /// @brief the routed standard cells of adc1, the GDSII files under examples/
+        const char *STD_CELL_GDS[] = {"INVD4BWP_LVT", "NR2D8BWP_LVT", "BUFFD4BWP_LVT", "SR_Latch_LVT", "DFCND4BWP_LVT"};
+
+        /// @brief get the number of rectangles over all the layers
+        IndexType totalRects(const Layout &layout)
+        {
+            IndexType numRects = 0;
+            for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); ++layerIdx)
+            {
+                numRects += layout.numRects(layerIdx);
+            }
+            return numRects;
+        }
+
+        /// @brief a design of one circuit holding a synthetic layout
+        struct SyntheticDesign
+        {
+            explicit SyntheticDesign(IndexType numRects)
+            {
+                designDB.setTechDB(mockTechDB());
+                cktIdx = designDB.allocateCkt();
+                auto &ckt = designDB.subCkt(cktIdx);
+                ckt.setName("SYNTH");
+                ckt.layout().init(designDB.techDB().numLayers());
+                fillSyntheticLayout(ckt.layout(), numRects);
+            }
+            DesignDB designDB; ///< The design
+            IndexType cktIdx = INDEX_TYPE_MAX; ///< The circuit of the layout
+        };
+
+        /// @brief get a GDSII file of a synthetic layout, written once per size
+        /// @param the number of rectangles
+        /// @return the file name
+        std::string syntheticGds(IndexType numRects)
+        {
+            const std::string fileName = tempDir() + "magicalFlow_bench_" + std::to_string(numRects) + ".gds";
+            SyntheticDesign design(numRects);
+            GdsStreamWriter(design.designDB, design.designDB.techDB()).writeGdsLayout(design.cktIdx, fileName);
+            return fileName;
+        }
+
+        /// @brief read a GDSII file with the GdsDB based parser
+        void benchParseGds(::benchmark::State &state, const std::string &fileName)
+        {
+            const TechDB &techDB = *mockTechDB();
+            IndexType numRects = 0;
+            for (auto _ : state)
+            {
+                Layout layout;
+                layout.init(techDB.numLayers());
+                Parser parser(fileName, layout, techDB);
+                numRects = totalRects(layout);
+                ::benchmark::DoNotOptimize(numRects);
+            }
+            state.counters["rects"] = numRects;
+        }
+
+        /// @brief read a GDSII file with the streaming reader
+        void benchStreamReadGds(::benchmark::State &state, const std::string &fileName)
+        {
+            const TechDB &techDB = *mockTechDB();
+            IndexType numRects = 0;
+            for (auto _ : state)
+            {
+                Layout layout;
+                layout.init(techDB.numLayers());
+                if (!GdsStreamReader(layout, techDB).read(fileName))
+                {
+                    state.SkipWithError("cannot read the GDSII file");
+                    return;
+                }
+                numRects = totalRects(layout);
+                ::benchmark::DoNotOptimize(numRects);
+            }
+            state.counters["rects"] = numRects;
+        }
+    }
+
+    /// @brief both GDSII readers on the synthetic layouts
+    void BM_ParseGdsSynthetic(::benchmark::State &state)
+    {
+        const std::string fileName = syntheticGds(state.range(0));
+        benchParseGds(state, fileName);
+        std::remove(fileName.c_str());
+    }
+    BENCHMARK(BM_ParseGdsSynthetic)->RangeMultiplier(8)->Range(1 << 9, 1 << 18)->Unit(::benchmark::kMillisecond);
+
+    void BM_StreamReadGdsSynthetic(::benchmark::State &state)
+    {
+        const std::string fileName = syntheticGds(state.range(0));
+        benchStreamReadGds(state, fileName);
+        std::remove(fileName.c_str());
+    }
+    BENCHMARK(BM_StreamReadGdsSynthetic)->RangeMultiplier(8)->Range(1 << 9, 1 << 18)->Unit(::benchmark::kMillisecond);
+
+    /// @brief place a synthetic sub layout into a parent layout, as DesignDB::insertSubLayouts does for each node
+    void BM_InsertLayout(::benchmark::State &state)
+    {
+        const IndexType numLayers = mockTechDB()->numLayers();
+        Layout subLayout;
+        subLayout.init(numLayers);
+        fillSyntheticLayout(subLayout, state.range(0));
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            Layout layout;
+            layout.init(numLayers);
+            state.ResumeTiming();
+            layout.insertLayout(subLayout, XY<LocType>(1000, 2000), OriType::FS, true);
+            ::benchmark::DoNotOptimize(layout.numRects(0));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_InsertLayout)->RangeMultiplier(8)->Range(1 << 9, 1 << 18)->Unit(::benchmark::kMicrosecond);
+
+    /// @brief merge the rectangles of a row of copies of a synthetic layout, flattened as DesignDB::insertSubLayouts does
+    void BM_MergeRects(::benchmark::State &state)
+    {
+        const IndexType numLayers = mockTechDB()->numLayers();
+        Layout subLayout;
+        subLayout.init(numLayers);
+        fillSyntheticLayout(subLayout, state.range(0) / 16);
+        Layout flattened;
+        flattened.init(numLayers);
+        std::vector<LayoutPlacement> placements;
+        for (LocType idx = 0; idx < 16; ++idx)
+        {
+            placements.emplace_back(&subLayout, XY<LocType>(idx * subLayout.boundary().xLen(), 0), OriType::N, false);
+        }
+        flattened.insertLayouts(placements, false);
+        IndexType numRemoved = 0;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            Layout layout = flattened;
+            state.ResumeTiming();
+            numRemoved = layout.mergeRects();
+        }
+        state.counters["removed"] = numRemoved;
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_MergeRects)->RangeMultiplier(8)->Range(1 << 9, 1 << 18)->Unit(::benchmark::kMillisecond);
+
+    /// @brief write a synthetic layout with the GdsDB based writer
+    void BM_GdsWriter(::benchmark::State &state)
+    {
+        SyntheticDesign design(state.range(0));
+        TechDB techDB = design.designDB.techDB();
+        const std::string fileName = tempDir() + "magicalFlow_bench_writer.gds";
+        for (auto _ : state)
+        {
+            GdsWriter(design.designDB, techDB).writeGdsLayout(design.cktIdx, fileName);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        std::remove(fileName.c_str());
+    }
+    BENCHMARK(BM_GdsWriter)->RangeMultiplier(8)->Range(1 << 9, 1 << 18)->Unit(::benchmark::kMillisecond);
+
+    /// @brief write a synthetic layout with the streaming writer, into memory so that the disk is not timed
+    void BM_GdsStreamWriter(::benchmark::State &state)
+    {
+        SyntheticDesign design(state.range(0));
+        GdsStreamWriter writer(design.designDB, design.designDB.techDB());
+        std::size_t numBytes = 0;
+        for (auto _ : state)
+        {
+            std::ostringstream os(std::ios::binary);
+            writer.writeGdsLayout(design.cktIdx, os);
+            numBytes = os.tellp();
+            ::benchmark::DoNotOptimize(numBytes);
+        }
+        state.SetBytesProcessed(state.iterations() * numBytes);
+    }
+    BENCHMARK(BM_GdsStreamWriter)->RangeMultiplier(8)->Range(1 << 9, 1 << 18)->Unit(::benchmark::kMillisecond);
+
+    namespace
+    {
+        /// @brief a design of many circuits holding synthetic layouts, and a file for each
+        struct SyntheticBatch
+        {
+            explicit SyntheticBatch(IndexType numCkts, IndexType numRects)
+            {
+                designDB.setTechDB(mockTechDB());
+                for (IndexType idx = 0; idx < numCkts; ++idx)
+                {
+                    IndexType cktIdx = designDB.allocateCkt();
+                    auto &ckt = designDB.subCkt(cktIdx);
+                    ckt.setName("SYNTH" + std::to_string(idx));
+                    ckt.layout().init(designDB.techDB().numLayers());
+                    fillSyntheticLayout(ckt.layout(), numRects);
+                    cktIdxs.emplace_back(cktIdx);
+                    fileNames.emplace_back(tempDir() + "magicalFlow_bench_batch_" + std::to_string(idx) + ".gds");
+                }
+            }
+            ~SyntheticBatch()
+            {
+                for (const auto &fileName : fileNames)
+                {
+                    std::remove(fileName.c_str());
+                }
+            }
+            DesignDB designDB; ///< The design
+            std::vector<IndexType> cktIdxs; ///< The circuits
+            std::vector<std::string> fileNames; ///< The file of each circuit
+        };
+        constexpr IndexType BATCH_NUM_CKTS = 32; ///< The number of circuits of a batch
+    }
+
+    /// @brief write the layouts of a batch of circuits one by one
+    void BM_GdsSerialFiles(::benchmark::State &state)
+    {
+        SyntheticBatch batch(BATCH_NUM_CKTS, state.range(0));
+        GdsStreamWriter writer(batch.designDB, batch.designDB.techDB());
+        for (auto _ : state)
+        {
+            for (IndexType idx = 0; idx < BATCH_NUM_CKTS; ++idx)
+            {
+                writer.writeGdsLayout(batch.cktIdxs[idx], batch.fileNames[idx]);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * BATCH_NUM_CKTS * state.range(0));
+    }
+    BENCHMARK(BM_GdsSerialFiles)->RangeMultiplier(8)->Range(1 << 9, 1 << 15)->Unit(::benchmark::kMillisecond)->UseRealTime();
+
+    /// @brief write the layouts of a batch of circuits with the batch writer
+    void BM_GdsBatchFiles(::benchmark::State &state)
+    {
+        SyntheticBatch batch(BATCH_NUM_CKTS, state.range(0));
+        GdsBatchWriter writer(batch.designDB, batch.designDB.techDB());
+        for (auto _ : state)
+        {
+            writer.writeGdsLayouts(batch.cktIdxs, batch.fileNames);
+        }
+        state.SetItemsProcessed(state.iterations() * BATCH_NUM_CKTS * state.range(0));
+    }
+    BENCHMARK(BM_GdsBatchFiles)->RangeMultiplier(8)->Range(1 << 9, 1 << 15)->Unit(::benchmark::kMillisecond)->UseRealTime();
+
+    /// @brief slice staircase polygons one by one
+    void BM_Polygon2Rect(::benchmark::State &state)
+    {
+        const auto pts = staircasePolygon(state.range(0), 0);
+        std::vector<Box<LocType>> rects;
+        for (auto _ : state)
+        {
+            rects.clear();
+            ::klib::convertPolygon2Rects(pts, rects);
+            ::benchmark::DoNotOptimize(rects.data());
+        }
+        state.counters["rects"] = rects.size();
+    }
+    BENCHMARK(BM_Polygon2Rect)->RangeMultiplier(4)->Range(4, 1 << 10)->Unit(::benchmark::kMicrosecond);
+
+    /// @brief slice a batch of 1024 staircase polygons at once, as the GDSII readers do for a cell
+    void BM_Polygon2RectBatch(::benchmark::State &state)
+    {
+        const IndexType numPolygons = 1024;
+        std::vector<std::vector<XY<LocType>>> polygons;
+        for (IndexType polyIdx = 0; polyIdx < numPolygons; ++polyIdx)
+        {
+            polygons.emplace_back(staircasePolygon(state.range(0), static_cast<LocType>(polyIdx) * 100000));
+        }
+        ::klib::Polygon2RectBatch<LocType> batch;
+        for (auto _ : state)
+        {
+            batch.clear();
+            for (const auto &pts : polygons)
+            {
+                batch.addPolygon(pts.begin(), pts.end());
+            }
+            ::benchmark::DoNotOptimize(batch.run());
+        }
+        state.SetItemsProcessed(state.iterations() * numPolygons);
+    }
+    BENCHMARK(BM_Polygon2RectBatch)->RangeMultiplier(4)->Range(4, 256)->Unit(::benchmark::kMillisecond);
+
+    void registerLayoutBenchmarks()
+    {
+        for (const char *cell : STD_CELL_GDS)
+        {
+            const std::string fileName = examplesDir() + "adc1/stdcell/" + cell + ".route.gds";
+            ::benchmark::RegisterBenchmark((std::string("ParseGds/") + cell).c_str(), benchParseGds, fileName)->Unit(::benchmark::kMicrosecond);
+            ::benchmark::RegisterBenchmark((std::string("StreamReadGds/") + cell).c_str(), benchStreamReadGds, fileName)->Unit(::benchmark::kMicrosecond);
+        }
+    }
+}
+
+PROJECT_NAMESPACE_END
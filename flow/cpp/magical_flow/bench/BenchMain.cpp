@@ -0,0 +1,119 @@
+/**
+ * @file BenchMain.cpp
+ * @brief The entry of magicalFlow_bench, and the inputs shared by the micro-benchmarks
+ * @date 10/14/2026
+ */
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <set>
+#include "BenchCommon.h"
+#include "parser/ParseNetlist.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace bench
+{
+    std::shared_ptr<const TechDB> mockTechDB()
+    {
+        static std::shared_ptr<const TechDB> techDB;
+        static std::once_flag once;
+        std::call_once(once, []()
+                {
+                    auto parsed = std::make_shared<TechDB>();
+                    if (!PARSE::parseSimpleTechFile(examplesDir() + "mockPDK/techfile.simple", *parsed))
+                    {
+                        ERR("magicalFlow_bench: cannot read the mock PDK under %s \n", examplesDir().c_str());
+                    }
+                    techDB = parsed;
+                });
+        return techDB;
+    }
+
+    bool parseExample(const ExampleDesign &design, DesignDB &designDB)
+    {
+        designDB.setTechDB(mockTechDB());
+        if (!PARSE::parseNetlist(examplesDir() + design.name + "/" + design.netlist, designDB, design.isHspice))
+        {
+            return false;
+        }
+        // The power nets as MagicalDB.markPowerNets labels them with the default Params
+        const std::set<std::string> vddNetNames = {"VDD", "vdd", "vdda", "vddd"};
+        const std::set<std::string> vssNetNames = {"VSS", "GND", "vss", "gnd", "vssa", "vssd"};
+        for (IndexType cktIdx = 0; cktIdx < designDB.numCkts(); ++cktIdx)
+        {
+            auto &ckt = designDB.subCkt(cktIdx);
+            for (IndexType psubIdx = 0; psubIdx < ckt.numPsubs(); ++psubIdx)
+            {
+                ckt.psub(psubIdx).markVssFlag();
+            }
+            for (IndexType nwellIdx = 0; nwellIdx < ckt.numNwells(); ++nwellIdx)
+            {
+                ckt.nwell(nwellIdx).markVddFlag();
+            }
+            for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+            {
+                auto &net = ckt.net(netIdx);
+                if (vddNetNames.count(net.name()))
+                {
+                    net.markVddFlag();
+                }
+                if (vssNetNames.count(net.name()))
+                {
+                    net.markVssFlag();
+                }
+            }
+        }
+        return true;
+    }
+
+    void fillSyntheticLayout(Layout &layout, IndexType numRects)
+    {
+        // A square grid of 100x40 rectangles on a 200 pitch, as the fingers of the devices
+        const IndexType numCols = std::max<IndexType>(1, static_cast<IndexType>(std::sqrt(static_cast<double>(numRects))));
+        for (IndexType rectIdx = 0; rectIdx < numRects; ++rectIdx)
+        {
+            const LocType x = static_cast<LocType>(rectIdx % numCols) * 200;
+            const LocType y = static_cast<LocType>(rectIdx / numCols) * 200;
+            layout.insertRect(rectIdx % layout.numLayers(), Box<LocType>(x, y, x + 100, y + 40));
+        }
+    }
+
+    std::vector<XY<LocType>> staircasePolygon(IndexType numSteps, LocType offset)
+    {
+        std::vector<XY<LocType>> pts;
+        pts.reserve(2 * numSteps + 2);
+        pts.emplace_back(offset, offset);
+        for (IndexType step = 0; step < numSteps; ++step)
+        {
+            const LocType lo = offset + static_cast<LocType>(step) * 10;
+            pts.emplace_back(lo, lo + 10);
+            pts.emplace_back(lo + 10, lo + 10);
+        }
+        pts.emplace_back(offset + static_cast<LocType>(numSteps) * 10, offset);
+        return pts;
+    }
+}
+
+PROJECT_NAMESPACE_END
+
+/// The results are written as JSON unless --benchmark_format says otherwise, so that the runs of two commits compare with compare.py
+int main(int argc, char **argv)
+{
+    std::vector<char *> args(argv, argv + argc);
+    char jsonFormat[] = "--benchmark_format=json";
+    args.insert(args.begin() + 1, jsonFormat);
+    int numArgs = static_cast<int>(args.size());
+    ::benchmark::Initialize(&numArgs, args.data());
+    if (::benchmark::ReportUnrecognizedArguments(numArgs, args.data()))
+    {
+        return 1;
+    }
+    PROJECT_NAMESPACE::bench::registerDesignBenchmarks();
+    PROJECT_NAMESPACE::bench::registerLayoutBenchmarks();
+    ::benchmark::RunSpecifiedBenchmarks();
+    ::benchmark::Shutdown();
+    return 0;
+}
@@ -7,18 +7,105 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 #include "csflow/CSFlow.h"
+#include "csflow/PlacerPathSet.h"
 
 namespace py = pybind11;
 
+namespace {
+/// @brief a read-only numpy view of an index array, without copying. The owner is kept alive as long as the view
+template<typename T>
+py::array_t<T> indexArrayView(const std::vector<T>& vec, py::handle owner) {
+  py::array_t<T> view({static_cast<py::ssize_t>(vec.size())}, {static_cast<py::ssize_t>(sizeof(T))}, vec.data(), owner);
+  view.attr("setflags")(py::arg("write") = false);
+  return view;
+}
+}
+
 void initCSFlowAPI(py::module &m) {
+  py::class_<PROJECT_NAMESPACE::CSFlowResult>(m, "CSFlowResult")
+    .def(py::init<>())
+    .def("cktIdx", &PROJECT_NAMESPACE::CSFlowResult::cktIdx)
+    .def("numCurrentPaths", &PROJECT_NAMESPACE::CSFlowResult::numCurrentPaths)
+    .def("pathLength", &PROJECT_NAMESPACE::CSFlowResult::pathLength, "The number of pins on a current path")
+    .def("nodeArray", [](py::object self) { return indexArrayView(self.cast<const PROJECT_NAMESPACE::CSFlowResult&>().nodeArray(), self); },
+         "numpy view of the node indices of the pins of all the paths")
+    .def("intNetArray", [](py::object self) { return indexArrayView(self.cast<const PROJECT_NAMESPACE::CSFlowResult&>().intNetArray(), self); },
+         "numpy view of the internal net indices of the pins of all the paths")
+    .def("pathStartArray", [](py::object self) { return indexArrayView(self.cast<const PROJECT_NAMESPACE::CSFlowResult&>().pathStartArray(), self); },
+         "numpy view of the path offsets: path i is [pathStartArray[i], pathStartArray[i + 1]) of the other arrays")
+    .def("currentPinPath", &PROJECT_NAMESPACE::CSFlowResult::currentPinPath)
+    .def("currentCellPath", &PROJECT_NAMESPACE::CSFlowResult::currentCellPath)
+    .def("currentPinPaths", &PROJECT_NAMESPACE::CSFlowResult::currentPinPaths)
+    .def("currentCellPaths", &PROJECT_NAMESPACE::CSFlowResult::currentCellPaths)
+    .def("truncated", &PROJECT_NAMESPACE::CSFlowResult::truncated);
+
+  py::class_<PROJECT_NAMESPACE::SignalFlowResult>(m, "SignalFlowResult")
+    .def(py::init<>())
+    .def("cktIdx", &PROJECT_NAMESPACE::SignalFlowResult::cktIdx)
+    .def("numSignalPaths", &PROJECT_NAMESPACE::SignalFlowResult::numSignalPaths)
+    .def("pathLength", &PROJECT_NAMESPACE::SignalFlowResult::pathLength, "The number of pins on a signal path")
+    .def("signalPath", &PROJECT_NAMESPACE::SignalFlowResult::signalPath, "The pin indices of a signal path, alternating gate and drain pins")
+    .def("pinArray", [](py::object self) { return indexArrayView(self.cast<const PROJECT_NAMESPACE::SignalFlowResult&>().pinArray(), self); },
+         "numpy view of the pin indices of all the paths")
+    .def("pathStartArray", [](py::object self) { return indexArrayView(self.cast<const PROJECT_NAMESPACE::SignalFlowResult&>().pathStartArray(), self); },
+         "numpy view of the path offsets: path i is [pathStartArray[i], pathStartArray[i + 1]) of pinArray")
+    .def("truncated", &PROJECT_NAMESPACE::SignalFlowResult::truncated);
+
+  using PlacerPathSet = PROJECT_NAMESPACE::PlacerPathSet;
+  py::class_<PlacerPathSet> placerPathSet(m, "PlacerPathSet");
+  py::enum_<PlacerPathSet::Category>(placerPathSet, "Category")
+    .value("SIGNAL", PlacerPathSet::Category::SIGNAL)
+    .value("LOW_CURRENT", PlacerPathSet::Category::LOW_CURRENT)
+    .value("MEDIUM_CURRENT", PlacerPathSet::Category::MEDIUM_CURRENT)
+    .value("HIGH_CURRENT", PlacerPathSet::Category::HIGH_CURRENT);
+  placerPathSet
+    .def(py::init<const PROJECT_NAMESPACE::DesignDB&, const PROJECT_NAMESPACE::IndexType>(), py::keep_alive<1, 2>())
+    .def("addConstraintPaths", &PlacerPathSet::addConstraintPaths, "Add the signal paths of a constraint store, the power ones as current paths")
+    .def("addSignalPaths", &PlacerPathSet::addSignalPaths, "Add the signal paths of CSFlow.signalFlow")
+    .def("addCurrentPaths", &PlacerPathSet::addCurrentPaths, "Add the current paths of CSFlow.currentFlow")
+    .def("compile", &PlacerPathSet::compile, "Map the added paths to the placer cells and pins, drop the repeated and contained ones and weight them")
+    .def("setCategoryWeight", &PlacerPathSet::setCategoryWeight)
+    .def("setCategoryRatios", &PlacerPathSet::setCategoryRatios, "Set the strength relative to the strongest current path for the medium and the high categories")
+    .def("categoryWeight", &PlacerPathSet::categoryWeight)
+    .def("cktIdx", &PlacerPathSet::cktIdx)
+    .def("numPaths", &PlacerPathSet::numPaths)
+    .def("pathLength", &PlacerPathSet::pathLength)
+    .def("isPower", &PlacerPathSet::isPower)
+    .def("category", &PlacerPathSet::category)
+    .def("weight", &PlacerPathSet::weight)
+    .def("cellArray", [](py::object self) { return indexArrayView(self.cast<const PlacerPathSet&>().cellArray(), self); }, "The placer cells of the pins of all the paths")
+    .def("pinArray", [](py::object self) { return indexArrayView(self.cast<const PlacerPathSet&>().pinArray(), self); }, "The placer pins of the pins of all the paths")
+    .def("intNetArray", [](py::object self) { return indexArrayView(self.cast<const PlacerPathSet&>().intNetArray(), self); },
+         "The internal nets of the pins of all the paths, in the sub circuits of their nodes")
+    .def("pathStartArray", [](py::object self) { return indexArrayView(self.cast<const PlacerPathSet&>().pathStartArray(), self); },
+         "Path i is [pathStartArray()[i], pathStartArray()[i + 1]) of the pin arrays")
+    .def("categoryArray", [](py::object self) { return indexArrayView(self.cast<const PlacerPathSet&>().categoryArray(), self); })
+    .def("weightArray", [](py::object self) { return indexArrayView(self.cast<const PlacerPathSet&>().weightArray(), self); })
+    .def("numAddedPaths", &PlacerPathSet::numAddedPaths)
+    .def("numRedundantPaths", &PlacerPathSet::numRedundantPaths, "The number of paths the last compile dropped as repeated or contained")
+    .def("numUnmappedPins", &PlacerPathSet::numUnmappedPins, "The number of pins the last compile dropped for having no placer pin");
+
   py::class_<PROJECT_NAMESPACE::CSFlow>(m, "CSFlow")
-    .def(py::init<PROJECT_NAMESPACE::DesignDB&>())
+    .def(py::init<PROJECT_NAMESPACE::DesignDB&>(), py::keep_alive<1, 2>())
     .def("computeCurrentFlow", &PROJECT_NAMESPACE::CSFlow::computeCurrentFlow)
     .def("computeSignalFlow", &PROJECT_NAMESPACE::CSFlow::computeSignalFlow)
+    .def("signalFlow", &PROJECT_NAMESPACE::CSFlow::signalFlow,
+         "The signal paths of a circuit, recomputed only if the circuit has changed since the last call")
+    .def("invalidateSignalFlow", &PROJECT_NAMESPACE::CSFlow::invalidateSignalFlow)
+    .def("signalFlowResult", &PROJECT_NAMESPACE::CSFlow::signalFlowResult, py::return_value_policy::reference_internal, "The result of the last computeSignalFlow")
+    .def("setMaxSignalDepth", &PROJECT_NAMESPACE::CSFlow::setMaxSignalDepth, "Limit the number of transistors on one signal path")
+    .def("setMaxSignalFanout", &PROJECT_NAMESPACE::CSFlow::setMaxSignalFanout, "Limit the number of gates followed from one drain")
+    .def("setMaxSignalPaths", &PROJECT_NAMESPACE::CSFlow::setMaxSignalPaths, "Limit the number of signal paths of one circuit")
+    .def("setMaxCurrentPaths", &PROJECT_NAMESPACE::CSFlow::setMaxCurrentPaths, "Limit the number of current paths enumerated in one computeCurrentFlow call")
     .def("numCurrentPaths", &PROJECT_NAMESPACE::CSFlow::numCurrentPaths)
     .def("currentPinPath", &PROJECT_NAMESPACE::CSFlow::currentPinPath)
     .def("currentCellPath", &PROJECT_NAMESPACE::CSFlow::currentCellPath)
     .def("currentPinPaths", &PROJECT_NAMESPACE::CSFlow::currentPinPaths)
-    .def("currentCellPaths", &PROJECT_NAMESPACE::CSFlow::currentCellPaths);
+    .def("currentCellPaths", &PROJECT_NAMESPACE::CSFlow::currentCellPaths)
+    .def("currentFlowResult", &PROJECT_NAMESPACE::CSFlow::currentFlowResult, py::return_value_policy::reference_internal, "The result of the last computeCurrentFlow")
+    .def("currentFlow", &PROJECT_NAMESPACE::CSFlow::currentFlow, "Compute the current paths of a circuit into an independent result")
+    .def("computeAllCurrentFlows", &PROJECT_NAMESPACE::CSFlow::computeAllCurrentFlows, py::call_guard<py::gil_scoped_release>(),
+         "Compute the current paths of all the UNSET circuits in parallel");
 }
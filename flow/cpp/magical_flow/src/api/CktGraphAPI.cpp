@@ -7,22 +7,148 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 #include "db/CktGraph.h"
 
 namespace py = pybind11;
 
+namespace
+{
+    typedef py::array_t<PROJECT_NAMESPACE::LocType, py::array::c_style | py::array::forcecast> LocArray;
+    typedef py::array_t<PROJECT_NAMESPACE::IntType, py::array::c_style | py::array::forcecast> IntArray;
+
+    /// @brief copy a field of all the elements of an array into a numpy array
+    template<typename T, typename Array, typename Field>
+    py::array_t<T> fieldArray(const Array &array, Field field)
+    {
+        py::array_t<T> values(static_cast<py::ssize_t>(array.size()));
+        auto out = values.template mutable_unchecked<1>();
+        for (py::ssize_t idx = 0; idx < values.shape(0); ++idx)
+        {
+            out(idx) = static_cast<T>(field(array[idx]));
+        }
+        return values;
+    }
+
+    /// @brief the offsets of all the nodes as an N x 2 array
+    LocArray nodeOffsetArray(const PROJECT_NAMESPACE::CktGraph &ckt)
+    {
+        LocArray offsets({static_cast<py::ssize_t>(ckt.numNodes()), static_cast<py::ssize_t>(2)});
+        auto out = offsets.mutable_unchecked<2>();
+        for (PROJECT_NAMESPACE::IndexType nodeIdx = 0; nodeIdx < ckt.numNodes(); ++nodeIdx)
+        {
+            out(nodeIdx, 0) = ckt.node(nodeIdx).offset().x();
+            out(nodeIdx, 1) = ckt.node(nodeIdx).offset().y();
+        }
+        return offsets;
+    }
+
+    /// @brief set the offsets of the nodes [begin, begin + N) from an N x 2 array
+    void setNodeOffsets(PROJECT_NAMESPACE::CktGraph &ckt, const LocArray &offsets, PROJECT_NAMESPACE::IndexType begin)
+    {
+        if (offsets.ndim() != 2 || offsets.shape(1) != 2)
+        {
+            throw std::invalid_argument("setNodeOffsets: expecting an N x 2 array");
+        }
+        if (static_cast<py::ssize_t>(begin) + offsets.shape(0) > static_cast<py::ssize_t>(ckt.numNodes()))
+        {
+            throw std::out_of_range("setNodeOffsets: more offsets than nodes");
+        }
+        auto in = offsets.unchecked<2>();
+        for (py::ssize_t idx = 0; idx < in.shape(0); ++idx)
+        {
+            ckt.node(begin + idx).setOffset(in(idx, 0), in(idx, 1));
+        }
+    }
+
+    /// @brief set the orientations of the nodes [begin, begin + N)
+    void setNodeOrients(PROJECT_NAMESPACE::CktGraph &ckt, const IntArray &orients, PROJECT_NAMESPACE::IndexType begin)
+    {
+        if (orients.ndim() != 1 || static_cast<py::ssize_t>(begin) + orients.shape(0) > static_cast<py::ssize_t>(ckt.numNodes()))
+        {
+            throw std::out_of_range("setNodeOrients: expecting a 1-D array of at most the number of nodes");
+        }
+        auto in = orients.unchecked<1>();
+        for (py::ssize_t idx = 0; idx < in.shape(0); ++idx)
+        {
+            ckt.node(begin + idx).setOrient(static_cast<PROJECT_NAMESPACE::OriType>(in(idx)));
+        }
+    }
+
+    /// @brief the io pins of all the nets: the net indices, the N x 4 shapes and the metal layers
+    py::tuple ioPinArrays(const PROJECT_NAMESPACE::CktGraph &ckt)
+    {
+        py::ssize_t numIoPins = 0;
+        for (const auto &net : ckt.netArray())
+        {
+            numIoPins += net.numIoPins();
+        }
+        py::array_t<PROJECT_NAMESPACE::IndexType> netIdxArray(numIoPins);
+        LocArray shapes({numIoPins, static_cast<py::ssize_t>(4)});
+        py::array_t<PROJECT_NAMESPACE::IndexType> layers(numIoPins);
+        auto netOut = netIdxArray.mutable_unchecked<1>();
+        auto shapeOut = shapes.mutable_unchecked<2>();
+        auto layerOut = layers.mutable_unchecked<1>();
+        py::ssize_t idx = 0;
+        for (PROJECT_NAMESPACE::IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+        {
+            const auto &net = ckt.net(netIdx);
+            for (PROJECT_NAMESPACE::IndexType ioIdx = 0; ioIdx < net.numIoPins(); ++ioIdx, ++idx)
+            {
+                const auto &shape = net.ioPinShape(ioIdx);
+                netOut(idx) = netIdx;
+                shapeOut(idx, 0) = shape.xLo();
+                shapeOut(idx, 1) = shape.yLo();
+                shapeOut(idx, 2) = shape.xHi();
+                shapeOut(idx, 3) = shape.yHi();
+                layerOut(idx) = net.ioPinMetalLayer(ioIdx);
+            }
+        }
+        return py::make_tuple(netIdxArray, shapes, layers);
+    }
+}
+
 void initCktGraphAPI(py::module &m)
 {
+    py::class_<PROJECT_NAMESPACE::CktConstraint>(m , "CktConstraint")
+        .def(py::init<>())
+        .def("isSymGenerated", &PROJECT_NAMESPACE::CktConstraint::isSymGenerated, "Whether the symmetry constraints have been generated")
+        .def("markSymGenerated", &PROJECT_NAMESPACE::CktConstraint::markSymGenerated, "Mark the symmetry constraints as generated")
+        .def("clearSym", &PROJECT_NAMESPACE::CktConstraint::clearSym, "Remove all the symmetry constraints")
+        .def("addSymPair", &PROJECT_NAMESPACE::CktConstraint::addSymPair, "Add a pair of symmetric nodes")
+        .def("numSymPairs", &PROJECT_NAMESPACE::CktConstraint::numSymPairs)
+        .def("symPair", &PROJECT_NAMESPACE::CktConstraint::symPair, "Get a symmetric node pair as a tuple")
+        .def("addSelfSym", &PROJECT_NAMESPACE::CktConstraint::addSelfSym, "Add a self-symmetric node")
+        .def("numSelfSyms", &PROJECT_NAMESPACE::CktConstraint::numSelfSyms)
+        .def("selfSym", &PROJECT_NAMESPACE::CktConstraint::selfSym)
+        .def("addSymNetPair", &PROJECT_NAMESPACE::CktConstraint::addSymNetPair, "Add a pair of symmetric nets")
+        .def("numSymNetPairs", &PROJECT_NAMESPACE::CktConstraint::numSymNetPairs)
+        .def("symNetPair", &PROJECT_NAMESPACE::CktConstraint::symNetPair, "Get a symmetric net pair as a tuple")
+        .def("addSelfSymNet", &PROJECT_NAMESPACE::CktConstraint::addSelfSymNet, "Add a self-symmetric net")
+        .def("numSelfSymNets", &PROJECT_NAMESPACE::CktConstraint::numSelfSymNets)
+        .def("selfSymNet", &PROJECT_NAMESPACE::CktConstraint::selfSymNet)
+        .def("clearSignalPaths", &PROJECT_NAMESPACE::CktConstraint::clearSignalPaths)
+        .def("allocateSignalPath", &PROJECT_NAMESPACE::CktConstraint::allocateSignalPath, "Start a new signal path", py::arg("isPower") = false)
+        .def("addPinToSignalPath", &PROJECT_NAMESPACE::CktConstraint::addPinToSignalPath, "Append a pin (node, internal net) to the last signal path")
+        .def("numSignalPaths", &PROJECT_NAMESPACE::CktConstraint::numSignalPaths)
+        .def("isSignalPathPower", &PROJECT_NAMESPACE::CktConstraint::isSignalPathPower)
+        .def("signalPathLength", &PROJECT_NAMESPACE::CktConstraint::signalPathLength)
+        .def("signalPathNode", &PROJECT_NAMESPACE::CktConstraint::signalPathNode)
+        .def("signalPathIntNet", &PROJECT_NAMESPACE::CktConstraint::signalPathIntNet);
+
     py::class_<PROJECT_NAMESPACE::CktGraph>(m , "CktGraph")
         .def(py::init<>())
-        .def("setTechDB", &PROJECT_NAMESPACE::CktGraph::setTechDB)
+        .def("setTechDB", [](PROJECT_NAMESPACE::CktGraph &ckt, std::shared_ptr<PROJECT_NAMESPACE::TechDB> techDB) { ckt.setTechDB(techDB); },
+                "Reference a technology database shared with the DesignDB")
         .def("allocateNode", &PROJECT_NAMESPACE::CktGraph::allocateNode)
+        .def("compactConnectivity", &PROJECT_NAMESPACE::CktGraph::compactConnectivity, "Pack the pin lists of the nodes and the nets")
+        .def("touchNodes", &PROJECT_NAMESPACE::CktGraph::touchNodes, "Mark the nodes as changed after changing the sub circuit of a node")
         .def("numNodes", &PROJECT_NAMESPACE::CktGraph::numNodes)
-        .def("node", &PROJECT_NAMESPACE::CktGraph::node, py::return_value_policy::reference)
+        .def("node", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::CktGraph::node), py::return_value_policy::reference)
         .def("allocatePin", &PROJECT_NAMESPACE::CktGraph::allocatePin)
         .def("resizeNodes", &PROJECT_NAMESPACE::CktGraph::resizeNodeArray, "Resize the node vector in this circuit")
         .def("numPins", &PROJECT_NAMESPACE::CktGraph::numPins)
-        .def("pin", &PROJECT_NAMESPACE::CktGraph::pin, py::return_value_policy::reference)
+        .def("pin", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::CktGraph::pin), py::return_value_policy::reference)
         .def("allocateNet", &PROJECT_NAMESPACE::CktGraph::allocateNet)
         .def("allocatePsub", &PROJECT_NAMESPACE::CktGraph::allocatePsub)
         .def("addPsubIdx", &PROJECT_NAMESPACE::CktGraph::addPsubIdx)
@@ -31,15 +157,41 @@ void initCktGraphAPI(py::module &m)
         .def("numNets", &PROJECT_NAMESPACE::CktGraph::numNets)
         .def("numPsubs", &PROJECT_NAMESPACE::CktGraph::numPsubs)
         .def("numNwells", &PROJECT_NAMESPACE::CktGraph::numNwells)
-        .def("net", &PROJECT_NAMESPACE::CktGraph::net, py::return_value_policy::reference)
+        .def("net", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::CktGraph::net), py::return_value_policy::reference)
+        .def("nodeOffsetArray", &nodeOffsetArray, "A copy of the offsets of all the nodes as an N x 2 numpy array")
+        .def("nodeOrientArray", [](const PROJECT_NAMESPACE::CktGraph &ckt)
+                { return fieldArray<PROJECT_NAMESPACE::IntType>(ckt.nodeArray(), [](const PROJECT_NAMESPACE::CktNode &node) { return node.orient(); }); },
+                "A copy of the orientations of all the nodes as integers of OriType")
+        .def("nodeFlipVertArray", [](const PROJECT_NAMESPACE::CktGraph &ckt)
+                { return fieldArray<bool>(ckt.nodeArray(), [](const PROJECT_NAMESPACE::CktNode &node) { return node.flipVertFlag(); }); },
+                "A copy of the flip vertical flags of all the nodes")
+        .def("setNodeOffsets", &setNodeOffsets, "Set the offsets of the nodes [begin, begin + N) from an N x 2 array", py::arg("offsets"), py::arg("begin") = 0)
+        .def("setNodeOrients", &setNodeOrients, "Set the orientations of the nodes [begin, begin + N) from integers of OriType", py::arg("orients"), py::arg("begin") = 0)
+        .def("pinNodeIdxArray", [](const PROJECT_NAMESPACE::CktGraph &ckt)
+                { return fieldArray<PROJECT_NAMESPACE::IndexType>(ckt.pinArray(), [](const PROJECT_NAMESPACE::Pin &pin) { return pin.nodeIdx(); }); },
+                "A copy of the node indices of all the pins")
+        .def("pinNetIdxArray", [](const PROJECT_NAMESPACE::CktGraph &ckt)
+                { return fieldArray<PROJECT_NAMESPACE::IndexType>(ckt.pinArray(), [](const PROJECT_NAMESPACE::Pin &pin) { return pin.netIdx(); }); },
+                "A copy of the net indices of all the pins")
+        .def("pinIntNetIdxArray", [](const PROJECT_NAMESPACE::CktGraph &ckt)
+                { return fieldArray<PROJECT_NAMESPACE::IndexType>(ckt.pinArray(), [](const PROJECT_NAMESPACE::Pin &pin) { return pin.intNetIdx(); }); },
+                "A copy of the net indices inside the sub circuits of all the pins")
+        .def("ioPinArrays", &ioPinArrays, "The io pins of all the nets as (net indices, N x 4 shapes, metal layers) numpy arrays")
         .def("psub", &PROJECT_NAMESPACE::CktGraph::psub, py::return_value_policy::reference)
         .def("nwell", &PROJECT_NAMESPACE::CktGraph::nwell, py::return_value_policy::reference)
         .def_property("name", &PROJECT_NAMESPACE::CktGraph::name, &PROJECT_NAMESPACE::CktGraph::setName)
-        .def("layout", &PROJECT_NAMESPACE::CktGraph::layout, py::return_value_policy::reference)
-        .def("parseGDS", &PROJECT_NAMESPACE::CktGraph::parseGDS, py::return_value_policy::reference)
+        .def("layout", py::overload_cast<>(&PROJECT_NAMESPACE::CktGraph::layout), py::return_value_policy::reference)
+        .def("hasLayout", &PROJECT_NAMESPACE::CktGraph::hasLayout, "Whether the layout has been allocated")
+        .def("layoutView", [](const PROJECT_NAMESPACE::CktGraph &ckt) -> const PROJECT_NAMESPACE::Layout & { return ckt.layout(); }, py::return_value_policy::reference,
+                "The layout for reading only. Unlike layout(), a shared layout is not copied, so it must not be modified")
+        .def("isLayoutShared", &PROJECT_NAMESPACE::CktGraph::isLayoutShared, "Whether the layout is shared with other circuits, such as the ones of a standard cell")
+        .def("constraint", py::overload_cast<>(&PROJECT_NAMESPACE::CktGraph::constraint), py::return_value_policy::reference, "The placement constraints of the circuit")
+        .def("parseGDS", &PROJECT_NAMESPACE::CktGraph::parseGDS, py::call_guard<py::gil_scoped_release>())
+        .def("parseGDSCell", &PROJECT_NAMESPACE::CktGraph::parseGDSCell, py::call_guard<py::gil_scoped_release>(),
+                "Read one cell of a GDSII library, which stays mapped for the following calls", py::arg("file"), py::arg("cellName"))
         .def_property("implType", &PROJECT_NAMESPACE::CktGraph::implType, &PROJECT_NAMESPACE::CktGraph::setImplType) 
         .def_property("implIdx", &PROJECT_NAMESPACE::CktGraph::implIdx, &PROJECT_NAMESPACE::CktGraph::setImplIdx)
         .def_property("isImpl", &PROJECT_NAMESPACE::CktGraph::isImpl, &PROJECT_NAMESPACE::CktGraph::setIsImpl)
-        .def("GdsData", &::MAGICAL_FLOW::CktGraph::gdsData, py::return_value_policy::reference)
-        .def("gdsData", &::MAGICAL_FLOW::CktGraph::gdsData, py::return_value_policy::reference);
+        .def("GdsData", py::overload_cast<>(&::MAGICAL_FLOW::CktGraph::gdsData), py::return_value_policy::reference)
+        .def("gdsData", py::overload_cast<>(&::MAGICAL_FLOW::CktGraph::gdsData), py::return_value_policy::reference);
 }
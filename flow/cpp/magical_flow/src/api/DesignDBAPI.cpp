@@ -8,23 +8,505 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
+#include <pybind11/numpy.h>
 #include "db/DesignDB.h"
+#include "db/DrcScreen.h"
+#include "db/InstanceView.h"
+#include "db/LayoutConnectivity.h"
+#include "db/CktContentHash.h"
+#include "db/FloorplanEstimator.h"
+#include "db/NetLength.h"
+#include "db/PrimarySym.h"
+#include "db/ShapeBuffer.h"
+#include "db/PowerGeometry.h"
+#include "db/PcellGenerator.h"
+#include "db/MemoryUsage.h"
+#include "db/SpectralSim.h"
+#include "db/SymCandidates.h"
+#include "db/SyntheticDesign.h"
 
 namespace py = pybind11;
 
 PYBIND11_MAKE_OPAQUE(std::vector<std::string>);
 
+namespace
+{
+    /// @brief a read-only numpy view of an array of the pin shapes, keeping them alive. The shapes are never changed after being resolved
+    template<typename T>
+    py::array_t<T> shapeArrayView(const std::vector<T> &vec, py::handle owner, py::ssize_t numCols = 1)
+    {
+        py::ssize_t numRows = static_cast<py::ssize_t>(vec.size()) / numCols;
+        py::array_t<T> view = numCols == 1
+            ? py::array_t<T>({numRows}, {static_cast<py::ssize_t>(sizeof(T))}, vec.data(), owner)
+            : py::array_t<T>({numRows, numCols}, {static_cast<py::ssize_t>(numCols * sizeof(T)), static_cast<py::ssize_t>(sizeof(T))}, vec.data(), owner);
+        view.attr("setflags")(py::arg("write") = false);
+        return view;
+    }
+}
+
 void initDesignDBAPI(py::module &m)
 {
+    py::class_<PROJECT_NAMESPACE::DeviceLayoutCache>(m , "DeviceLayoutCache")
+        .def("setCacheDir", &PROJECT_NAMESPACE::DeviceLayoutCache::setCacheDir, "Persist the entries in a directory. Empty for memory only")
+        .def("cacheDir", &PROJECT_NAMESPACE::DeviceLayoutCache::cacheDir)
+        .def("numEntries", &PROJECT_NAMESPACE::DeviceLayoutCache::numEntries)
+        .def("numHits", &PROJECT_NAMESPACE::DeviceLayoutCache::numHits)
+        .def("numMisses", &PROJECT_NAMESPACE::DeviceLayoutCache::numMisses)
+        .def("clear", &PROJECT_NAMESPACE::DeviceLayoutCache::clear, "Remove the entries in memory");
+    py::class_<PROJECT_NAMESPACE::StdCellLibrary>(m , "StdCellLibrary")
+        .def("setup", &PROJECT_NAMESPACE::StdCellLibrary::setup, py::call_guard<py::gil_scoped_release>(),
+                "Set up a standard cell circuit from its .dumb pin file and its GDSII layout, loaded on the first circuit of the cell and shared by the others",
+                py::arg("ckt"), py::arg("pinFile"), py::arg("gdsFile"))
+        .def("hasCell", &PROJECT_NAMESPACE::StdCellLibrary::hasCell)
+        .def("numCells", &PROJECT_NAMESPACE::StdCellLibrary::numCells)
+        .def("numHits", &PROJECT_NAMESPACE::StdCellLibrary::numHits)
+        .def("numLoads", &PROJECT_NAMESPACE::StdCellLibrary::numLoads)
+        .def("clear", &PROJECT_NAMESPACE::StdCellLibrary::clear, "Remove the cells. The circuits keep their layouts");
+    py::class_<PROJECT_NAMESPACE::CktHierarchy>(m , "CktHierarchy")
+        .def("numCkts", &PROJECT_NAMESPACE::CktHierarchy::numCkts)
+        .def("numLevels", &PROJECT_NAMESPACE::CktHierarchy::numLevels)
+        .def("level", &PROJECT_NAMESPACE::CktHierarchy::level, "Get the level of a circuit. 0 if it instantiates no sub circuit")
+        .def("bottomUpOrder", &PROJECT_NAMESPACE::CktHierarchy::bottomUpOrder, "Get the circuits sorted by level")
+        .def("levelCkts", &PROJECT_NAMESPACE::CktHierarchy::levelCkts, "Get the circuits of a level")
+        .def("numChildren", &PROJECT_NAMESPACE::CktHierarchy::numChildren)
+        .def("children", &PROJECT_NAMESPACE::CktHierarchy::children, "Get the distinct sub circuits of a circuit, in the order of their first node")
+        .def("numParents", &PROJECT_NAMESPACE::CktHierarchy::numParents)
+        .def("parents", &PROJECT_NAMESPACE::CktHierarchy::parents, "Get the distinct circuits instantiating a circuit")
+        .def("roots", &PROJECT_NAMESPACE::CktHierarchy::roots, "Get the circuits that no circuit instantiates")
+        .def("isAcyclic", &PROJECT_NAMESPACE::CktHierarchy::isAcyclic);
+    using NetPinShapes = PROJECT_NAMESPACE::NetPinShapes;
+    py::class_<NetPinShapes, std::shared_ptr<NetPinShapes>>(m , "NetPinShapes")
+        .def("numNets", &NetPinShapes::numNets)
+        .def("signature", &NetPinShapes::signature, "The digest of the placement the shapes were resolved with")
+        .def("numShapes", py::overload_cast<>(&NetPinShapes::numShapes, py::const_))
+        .def("shapeStartArray", [](py::object self) { return shapeArrayView(self.cast<const NetPinShapes &>().shapeStartArray(), self); },
+                "The offsets of the shapes of each net, one more than the nets")
+        .def("rectArray", [](py::object self) { return shapeArrayView(self.cast<const NetPinShapes &>().rectArray(), self, 4); },
+                "The shapes as an N x 4 array of xLo, yLo, xHi, yHi")
+        .def("layerArray", [](py::object self) { return shapeArrayView(self.cast<const NetPinShapes &>().layerArray(), self); },
+                "The metal layers of the shapes")
+        .def("pinIdArray", [](py::object self) { return shapeArrayView(self.cast<const NetPinShapes &>().pinIdArray(), self); },
+                "The positions of the pins of the shapes in their nets")
+        .def("powerStripeArray", [](const NetPinShapes &shapes)
+                {
+                    py::array_t<bool> flags(static_cast<py::ssize_t>(shapes.numShapes()));
+                    auto out = flags.mutable_unchecked<1>();
+                    for (py::ssize_t idx = 0; idx < flags.shape(0); ++idx) { out(idx) = shapes.isPowerStripe(idx); }
+                    return flags;
+                },
+                "A copy of whether the first io shape of the sub circuit net of each shape is a power stripe")
+        .def("subNetIoArray", [](const NetPinShapes &shapes)
+                {
+                    py::array_t<bool> flags(static_cast<py::ssize_t>(shapes.numShapes()));
+                    auto out = flags.mutable_unchecked<1>();
+                    for (py::ssize_t idx = 0; idx < flags.shape(0); ++idx) { out(idx) = shapes.isSubNetIo(idx); }
+                    return flags;
+                },
+                "A copy of whether the sub circuit net of each shape is an io of the sub circuit")
+        .def("grPinCountArray", [](py::object self) { return shapeArrayView(self.cast<const NetPinShapes &>().grPinCountArray(), self); },
+                "The number of pins of each net for the global router")
+        .def("hasPsub", &NetPinShapes::hasPsub, "Whether a net connects a substrate pin")
+        .def("hasNwell", &NetPinShapes::hasNwell, "Whether a net connects a nwell pin");
+    py::enum_<PROJECT_NAMESPACE::NetLengthMetric>(m, "NetLengthMetric")
+        .value("HPWL", PROJECT_NAMESPACE::NetLengthMetric::HPWL)
+        .value("MAX_EXTENT", PROJECT_NAMESPACE::NetLengthMetric::MAX_EXTENT)
+        .value("STAR", PROJECT_NAMESPACE::NetLengthMetric::STAR);
+    using NetLengthEstimator = PROJECT_NAMESPACE::NetLengthEstimator;
+    py::class_<NetLengthEstimator>(m , "NetLengthEstimator")
+        .def(py::init([](std::shared_ptr<NetPinShapes> shapes) { return new NetLengthEstimator(std::move(shapes)); }), py::arg("netPinShapes"))
+        .def("setSubShape", [](NetLengthEstimator &estimator, PROJECT_NAMESPACE::LocType xLo, PROJECT_NAMESPACE::LocType yLo, PROJECT_NAMESPACE::LocType xHi, PROJECT_NAMESPACE::LocType yHi)
+                { estimator.setSubShape(PROJECT_NAMESPACE::Box<PROJECT_NAMESPACE::LocType>(xLo, yLo, xHi, yHi)); },
+                "Add a shape to every net connecting a substrate pin")
+        .def("setWeights", &NetLengthEstimator::setWeights, "Set the weights of the nets for the weighted totals")
+        .def("evaluate", &NetLengthEstimator::evaluate, py::call_guard<py::gil_scoped_release>(), "Evaluate the bounding boxes and the lengths of all the nets")
+        .def("numNets", &NetLengthEstimator::numNets)
+        .def("hasShape", &NetLengthEstimator::hasShape)
+        .def("bbox", &NetLengthEstimator::bbox, py::return_value_policy::copy)
+        .def("length", &NetLengthEstimator::length, "The length of a net in database units", py::arg("netIdx"), py::arg("metric") = PROJECT_NAMESPACE::NetLengthMetric::HPWL)
+        .def("lengthArray", [](const NetLengthEstimator &estimator, PROJECT_NAMESPACE::NetLengthMetric metric)
+                {
+                    std::vector<PROJECT_NAMESPACE::RealType> lengths = estimator.lengths(metric);
+                    return py::array_t<PROJECT_NAMESPACE::RealType>(static_cast<py::ssize_t>(lengths.size()), lengths.data());
+                },
+                "A copy of the lengths of all the nets in database units", py::arg("metric") = PROJECT_NAMESPACE::NetLengthMetric::HPWL)
+        .def("totalLength", &NetLengthEstimator::totalLength, py::arg("metric") = PROJECT_NAMESPACE::NetLengthMetric::HPWL)
+        .def("weightedLength", &NetLengthEstimator::weightedLength, py::arg("metric") = PROJECT_NAMESPACE::NetLengthMetric::HPWL);
+    py::enum_<PROJECT_NAMESPACE::FloorplanSource>(m, "FloorplanSource")
+        .value("NONE", PROJECT_NAMESPACE::FloorplanSource::NONE)
+        .value("LAYOUT", PROJECT_NAMESPACE::FloorplanSource::LAYOUT)
+        .value("CACHE", PROJECT_NAMESPACE::FloorplanSource::CACHE)
+        .value("MODEL", PROJECT_NAMESPACE::FloorplanSource::MODEL)
+        .value("HIERARCHY", PROJECT_NAMESPACE::FloorplanSource::HIERARCHY)
+        .value("FLOORPLAN", PROJECT_NAMESPACE::FloorplanSource::FLOORPLAN);
+    using FloorplanEstimator = PROJECT_NAMESPACE::FloorplanEstimator;
+    py::class_<FloorplanEstimator>(m , "FloorplanEstimator")
+        .def(py::init<PROJECT_NAMESPACE::DesignDB &>(), py::keep_alive<1, 2>(), py::arg("designDB"))
+        .def("setUtilization", &FloorplanEstimator::setUtilization, "Set the fraction of the area of a circuit the nodes fill")
+        .def("setAspectRatio", &FloorplanEstimator::setAspectRatio, "Set the target ratio of the width to the height of the circuits")
+        .def("setDeviceModel", &FloorplanEstimator::setDeviceModel, "Set the area factor and the minimum size of the devices without any layout",
+                py::arg("areaFactor"), py::arg("minSize"))
+        .def("estimate", &FloorplanEstimator::estimate, "Estimate all the circuits under a top circuit bottom-up. Return the number of circuits estimated")
+        .def("estimateCkt", &FloorplanEstimator::estimateCkt, "Estimate one circuit from the current estimates of its sub circuits")
+        .def("setSize", &FloorplanEstimator::setSize, "Set the size of a circuit, such as the extent of its floorplan", py::arg("cktIdx"), py::arg("width"), py::arg("height"))
+        .def("numCkts", &FloorplanEstimator::numCkts)
+        .def("width", &FloorplanEstimator::width)
+        .def("height", &FloorplanEstimator::height)
+        .def("area", &FloorplanEstimator::area)
+        .def("boundary", &FloorplanEstimator::boundary, py::return_value_policy::copy)
+        .def("source", &FloorplanEstimator::source);
+    using SymCandidates = PROJECT_NAMESPACE::SymCandidates;
+    py::class_<SymCandidates>(m , "SymCandidates")
+        .def(py::init<const PROJECT_NAMESPACE::DesignDB &>(), py::keep_alive<1, 2>(), py::arg("designDB"))
+        .def("find", &SymCandidates::find, py::call_guard<py::gil_scoped_release>(),
+                "Find the node pairs of a circuit with the same structural signature", py::arg("cktIdx"), py::arg("ignoredNets"), py::arg("matchDevices") = true)
+        .def("numNodes", &SymCandidates::numNodes)
+        .def("signature", &SymCandidates::signature)
+        .def("numPairs", &SymCandidates::numPairs)
+        .def("pairArray", [](const SymCandidates &candidates)
+                {
+                    const auto &pairs = candidates.pairArray();
+                    return py::array_t<PROJECT_NAMESPACE::IndexType>({static_cast<py::ssize_t>(candidates.numPairs()), static_cast<py::ssize_t>(2)}, pairs.data());
+                },
+                "A copy of the candidate pairs as an N x 2 array, sorted as itertools.combinations");
+    using PrimarySym = PROJECT_NAMESPACE::PrimarySym;
+    py::class_<PrimarySym>(m , "PrimarySym")
+        .def(py::init<const PROJECT_NAMESPACE::DesignDB &>(), py::keep_alive<1, 2>(), py::arg("designDB"))
+        .def("isPrimary", &PrimarySym::isPrimary, "Whether all the nodes of a circuit are devices")
+        .def("generate", &PrimarySym::generate, py::call_guard<py::gil_scoped_release>(),
+                "Generate the symmetry constraints of a primary circuit", py::arg("cktIdx"), py::arg("powerNets"))
+        .def("apply", &PrimarySym::apply, "Replace the symmetry constraints of the circuit by the generated ones", py::arg("constraint"))
+        .def("numDevices", &PrimarySym::numDevices)
+        .def("deviceType", &PrimarySym::deviceType)
+        .def("deviceSizes", &PrimarySym::deviceSizes, "The width, the length and the fingers of a device")
+        .def("symPairArray", [](const PrimarySym &primarySym)
+                {
+                    const auto &pairs = primarySym.symPairArray();
+                    return py::array_t<PROJECT_NAMESPACE::IndexType>({static_cast<py::ssize_t>(pairs.size() / 2), static_cast<py::ssize_t>(2)}, pairs.data());
+                },
+                "A copy of the symmetric node pairs as an N x 2 array")
+        .def("selfSymArray", &PrimarySym::selfSymArray)
+        .def("symNetPairArray", [](const PrimarySym &primarySym)
+                {
+                    const auto &pairs = primarySym.symNetPairArray();
+                    return py::array_t<PROJECT_NAMESPACE::IndexType>({static_cast<py::ssize_t>(pairs.size() / 2), static_cast<py::ssize_t>(2)}, pairs.data());
+                },
+                "A copy of the symmetric net pairs as an N x 2 array")
+        .def("selfSymNetArray", &PrimarySym::selfSymNetArray);
+    py::enum_<PROJECT_NAMESPACE::SimCenterType>(m, "SimCenterType")
+        .value("PAGERANK", PROJECT_NAMESPACE::SimCenterType::PAGERANK)
+        .value("JORDAN", PROJECT_NAMESPACE::SimCenterType::JORDAN)
+        .value("EIGEN", PROJECT_NAMESPACE::SimCenterType::EIGEN);
+    using SpectralSim = PROJECT_NAMESPACE::SpectralSim;
+    py::class_<SpectralSim>(m , "SpectralSim")
+        .def(py::init<const PROJECT_NAMESPACE::DesignDB &>(), py::keep_alive<1, 2>(), py::arg("designDB"))
+        .def("build", &SpectralSim::build, py::call_guard<py::gil_scoped_release>(),
+                "Flatten a circuit and drop the caches", py::arg("cktIdx"), py::arg("ignoredNets"))
+        .def("score", &SpectralSim::score, py::call_guard<py::gil_scoped_release>(),
+                "The spectral similarity of two nodes, as GraphSim.specSimScore", py::arg("nodeIdxA"), py::arg("nodeIdxB"), py::arg("centerType") = PROJECT_NAMESPACE::SimCenterType::PAGERANK)
+        .def("scores", [](SpectralSim &sim, const std::vector<PROJECT_NAMESPACE::IndexType> &pairs, PROJECT_NAMESPACE::SimCenterType centerType)
+                {
+                    std::vector<PROJECT_NAMESPACE::RealType> values;
+                    {
+                        py::gil_scoped_release release;
+                        values = sim.scores(pairs, centerType);
+                    }
+                    return py::array_t<PROJECT_NAMESPACE::RealType>(static_cast<py::ssize_t>(values.size()), values.data());
+                },
+                "The scores of the pairs, two node indices each", py::arg("pairs"), py::arg("centerType") = PROJECT_NAMESPACE::SimCenterType::PAGERANK)
+        .def("center", &SpectralSim::center, "The center vertex of a node and its radius", py::arg("nodeIdx"), py::arg("centerType") = PROJECT_NAMESPACE::SimCenterType::PAGERANK)
+        .def("eccentricity", &SpectralSim::eccentricity)
+        .def("distance", &SpectralSim::distance)
+        .def("ball", &SpectralSim::ball, "The vertices at a distance smaller than the radius, as GraphSim.BFSSub")
+        .def("spectrum", &SpectralSim::spectrum, "The cached Laplacian spectrum of a ball")
+        .def("numCachedSpectra", &SpectralSim::numCachedSpectra)
+        .def("numVertices", [](const SpectralSim &sim) { return sim.graph().numVertices(); })
+        .def_static("ksPValue", &SpectralSim::ksPValue, "The p-value of scipy.stats.ks_2samp");
+    using CktContentHash = PROJECT_NAMESPACE::CktContentHash;
+    py::class_<CktContentHash>(m , "CktContentHash")
+        .def(py::init<const PROJECT_NAMESPACE::DesignDB &>(), py::keep_alive<1, 2>(), py::arg("designDB"))
+        .def("build", &CktContentHash::build, py::call_guard<py::gil_scoped_release>(), "Compute the digests of all the circuits", py::arg("salt") = 0)
+        .def("hash", &CktContentHash::hash)
+        .def("hashString", &CktContentHash::hashString, "The digest of a circuit as 16 hexadecimal digits")
+        .def_static("localHash", &CktContentHash::localHash, "The digest of a circuit without its sub circuits")
+        .def_static("stringHash", &CktContentHash::stringHash, "The digest of a string, for the salts")
+        .def_static("fileHash", &CktContentHash::fileHash, py::call_guard<py::gil_scoped_release>(), "The digest of the contents of a file, for the salts. 0 if the file cannot be read");
+    using SyntheticSpec = PROJECT_NAMESPACE::SyntheticSpec;
+    py::class_<SyntheticSpec>(m , "SyntheticSpec")
+        .def(py::init<>())
+        .def_readwrite("depth", &SyntheticSpec::depth)
+        .def_readwrite("fanOut", &SyntheticSpec::fanOut)
+        .def_readwrite("numMasters", &SyntheticSpec::numMasters)
+        .def_readwrite("devicesPerLeaf", &SyntheticSpec::devicesPerLeaf)
+        .def_readwrite("nchWeight", &SyntheticSpec::nchWeight)
+        .def_readwrite("pchWeight", &SyntheticSpec::pchWeight)
+        .def_readwrite("resWeight", &SyntheticSpec::resWeight)
+        .def_readwrite("capWeight", &SyntheticSpec::capWeight)
+        .def_readwrite("numSignalIos", &SyntheticSpec::numSignalIos)
+        .def_readwrite("meanNetDegree", &SyntheticSpec::meanNetDegree)
+        .def_readwrite("maxNetDegree", &SyntheticSpec::maxNetDegree)
+        .def_readwrite("rectsPerDevice", &SyntheticSpec::rectsPerDevice)
+        .def_readwrite("seed", &SyntheticSpec::seed);
+    using SyntheticDesign = PROJECT_NAMESPACE::SyntheticDesign;
+    py::class_<SyntheticDesign>(m , "SyntheticDesign")
+        .def(py::init<PROJECT_NAMESPACE::DesignDB &>(), py::keep_alive<1, 2>(), py::arg("designDB"))
+        .def("generate", &SyntheticDesign::generate, py::call_guard<py::gil_scoped_release>(),
+                "Generate a hierarchical design into the database and return its top circuit", py::arg("spec"))
+        .def("numDeviceInstances", &SyntheticDesign::numDeviceInstances)
+        .def("numGeneratedCkts", &SyntheticDesign::numGeneratedCkts);
+    using InstanceView = PROJECT_NAMESPACE::InstanceView;
+    py::class_<InstanceView>(m , "InstanceView")
+        .def(py::init<const PROJECT_NAMESPACE::CktGraph &, const PROJECT_NAMESPACE::CktNode &>(), py::keep_alive<1, 2>(), py::arg("child"), py::arg("node"))
+        .def_static("mirrored", &InstanceView::mirrored, py::keep_alive<0, 1>(), "The view of a circuit mirrored about x = axis, without flipping its io shapes")
+        .def("child", &InstanceView::child, py::return_value_policy::reference)
+        .def("offset", &InstanceView::offset)
+        .def("orient", &InstanceView::orient)
+        .def("flipVertFlag", &InstanceView::flipVertFlag)
+        .def("boundary", &InstanceView::boundary, "The boundary of the sub layout in the parent")
+        .def("toParentCoord", &InstanceView::toParentCoord)
+        .def("toParentBox", &InstanceView::toParentBox)
+        .def("numRects", &InstanceView::numRects)
+        .def("rect", &InstanceView::rect, "A rectangle of the sub layout in the parent")
+        .def("numIoPins", &InstanceView::numIoPins)
+        .def("ioLayer", &InstanceView::ioLayer)
+        .def("ioShape", &InstanceView::ioShape, "An io shape of a net of the sub circuit in the parent")
+        .def("materialize", py::overload_cast<PROJECT_NAMESPACE::Layout &, bool>(&InstanceView::materialize, py::const_),
+                "Append the transformed sub layout to a layout", py::arg("layout"), py::arg("copyTexts") = true)
+        .def("materialize", py::overload_cast<>(&InstanceView::materialize, py::const_), "The transformed sub layout as a flat layout");
+    py::enum_<PROJECT_NAMESPACE::DrcViolationType>(m, "DrcViolationType")
+        .value("MIN_WIDTH", PROJECT_NAMESPACE::DrcViolationType::MIN_WIDTH)
+        .value("MIN_SPACING", PROJECT_NAMESPACE::DrcViolationType::MIN_SPACING)
+        .value("MIN_AREA", PROJECT_NAMESPACE::DrcViolationType::MIN_AREA);
+    using DrcScreen = PROJECT_NAMESPACE::DrcScreen;
+    py::class_<DrcScreen>(m , "DrcScreen")
+        .def(py::init<const PROJECT_NAMESPACE::TechDB &>(), py::keep_alive<1, 2>(), py::arg("techDB"))
+        .def("check", &DrcScreen::check, py::call_guard<py::gil_scoped_release>(), "Check all the layers of a layout. Return the number of violations", py::arg("layout"))
+        .def("recheck", py::overload_cast<const PROJECT_NAMESPACE::Layout &, PROJECT_NAMESPACE::IndexType, const std::vector<PROJECT_NAMESPACE::IndexType> &>(&DrcScreen::recheck),
+                py::call_guard<py::gil_scoped_release>(), "Check again the shapes of a layer touched by the moved and the appended rectangles",
+                py::arg("layout"), py::arg("layerIdx"), py::arg("rectIndices"))
+        .def("recheck", py::overload_cast<const PROJECT_NAMESPACE::Layout &, const std::vector<std::vector<PROJECT_NAMESPACE::IndexType>> &>(&DrcScreen::recheck),
+                py::call_guard<py::gil_scoped_release>(), "Check again the shapes touched by the moved rectangles of each layer and the appended ones",
+                py::arg("layout"), py::arg("rectIndices"))
+        .def("numViolations", py::overload_cast<>(&DrcScreen::numViolations, py::const_))
+        .def("numViolationsOf", py::overload_cast<PROJECT_NAMESPACE::DrcViolationType>(&DrcScreen::numViolations, py::const_), "The number of violations of a type")
+        .def("type", &DrcScreen::type)
+        .def("layer", &DrcScreen::layer)
+        .def("rect", &DrcScreen::rect)
+        .def("otherRect", &DrcScreen::otherRect)
+        .def("measured", &DrcScreen::measured)
+        .def("required", &DrcScreen::required)
+        .def("typeArray", [](const DrcScreen &screen) { return py::array_t<PROJECT_NAMESPACE::IndexType>(static_cast<py::ssize_t>(screen.numViolations()), screen.typeArray().data()); },
+                "A copy of the types of all the violations, as DrcViolationType values")
+        .def("layerArray", [](const DrcScreen &screen) { return py::array_t<PROJECT_NAMESPACE::IndexType>(static_cast<py::ssize_t>(screen.numViolations()), screen.layerArray().data()); },
+                "A copy of the layers of all the violations")
+        .def("rectArray", [](const DrcScreen &screen) { return py::array_t<PROJECT_NAMESPACE::IndexType>(static_cast<py::ssize_t>(screen.numViolations()), screen.rectArray().data()); },
+                "A copy of the rectangles of all the violations")
+        .def("otherRectArray", [](const DrcScreen &screen) { return py::array_t<PROJECT_NAMESPACE::IndexType>(static_cast<py::ssize_t>(screen.numViolations()), screen.otherRectArray().data()); },
+                "A copy of the other rectangles of the spacing violations")
+        .def("measuredArray", [](const DrcScreen &screen) { return py::array_t<std::int64_t>(static_cast<py::ssize_t>(screen.numViolations()), screen.measuredArray().data()); },
+                "A copy of the measured values of all the violations")
+        .def("requiredArray", [](const DrcScreen &screen) { return py::array_t<std::int64_t>(static_cast<py::ssize_t>(screen.numViolations()), screen.requiredArray().data()); },
+                "A copy of the required values of all the violations");
+    using LayoutConnectivity = PROJECT_NAMESPACE::LayoutConnectivity;
+    py::class_<LayoutConnectivity>(m , "LayoutConnectivity")
+        .def(py::init<const PROJECT_NAMESPACE::TechDB &>(), py::keep_alive<1, 2>(), py::arg("techDB"))
+        .def("setUseTexts", &LayoutConnectivity::setUseTexts, "Set whether the texts naming a net label the components")
+        .def("check", py::overload_cast<const PROJECT_NAMESPACE::DesignDB &, PROJECT_NAMESPACE::IndexType>(&LayoutConnectivity::check),
+                py::call_guard<py::gil_scoped_release>(), "Extract the layout of a circuit and compare it with its nets. Return the number of opens and shorts",
+                py::arg("designDB"), py::arg("cktIdx"))
+        .def("checkCkt", py::overload_cast<const PROJECT_NAMESPACE::CktGraph &, const PROJECT_NAMESPACE::NetPinShapes *>(&LayoutConnectivity::check),
+                py::call_guard<py::gil_scoped_release>(), "Extract the layout of a circuit labeled by the io shapes, the texts and optionally the pin shapes",
+                py::arg("ckt"), py::arg("netPinShapes") = nullptr)
+        .def("numComponents", &LayoutConnectivity::numComponents)
+        .def("component", &LayoutConnectivity::component, "The component of a rectangle", py::arg("layerIdx"), py::arg("rectIdx"))
+        .def("componentNet", &LayoutConnectivity::componentNet, "The smallest net labeling a component")
+        .def("numOpens", &LayoutConnectivity::numOpens)
+        .def("openNet", &LayoutConnectivity::openNet)
+        .def("openNumComponents", &LayoutConnectivity::openNumComponents)
+        .def("numShorts", &LayoutConnectivity::numShorts)
+        .def("shortNet", &LayoutConnectivity::shortNet)
+        .def("shortOtherNet", &LayoutConnectivity::shortOtherNet)
+        .def("shortLayer", &LayoutConnectivity::shortLayer)
+        .def("shortRect", &LayoutConnectivity::shortRect)
+        .def("openNetArray", [](const LayoutConnectivity &conn) { return py::array_t<PROJECT_NAMESPACE::IndexType>(static_cast<py::ssize_t>(conn.numOpens()), conn.openNetArray().data()); },
+                "A copy of the open nets")
+        .def("openNumComponentsArray", [](const LayoutConnectivity &conn) { return py::array_t<PROJECT_NAMESPACE::IndexType>(static_cast<py::ssize_t>(conn.numOpens()), conn.openNumComponentsArray().data()); },
+                "A copy of the number of components of each open net")
+        .def("shortNetArray", [](const LayoutConnectivity &conn) { return py::array_t<PROJECT_NAMESPACE::IndexType>(static_cast<py::ssize_t>(conn.numShorts()), conn.shortNetArray().data()); },
+                "A copy of the smallest nets of the shorts")
+        .def("shortOtherNetArray", [](const LayoutConnectivity &conn) { return py::array_t<PROJECT_NAMESPACE::IndexType>(static_cast<py::ssize_t>(conn.numShorts()), conn.shortOtherNetArray().data()); },
+                "A copy of the other nets of the shorts")
+        .def("shortLayerArray", [](const LayoutConnectivity &conn) { return py::array_t<PROJECT_NAMESPACE::IndexType>(static_cast<py::ssize_t>(conn.numShorts()), conn.shortLayerArray().data()); },
+                "A copy of the layers of the shorts")
+        .def("shortRectArray", [](const LayoutConnectivity &conn) { return py::array_t<PROJECT_NAMESPACE::IndexType>(static_cast<py::ssize_t>(conn.numShorts()), conn.shortRectArray().data()); },
+                "A copy of the rectangles of the shorts");
+    using ShapeBuffer = PROJECT_NAMESPACE::ShapeBuffer;
+    py::class_<ShapeBuffer>(m , "ShapeBuffer")
+        .def(py::init<>())
+        .def_static("fromCkt", &ShapeBuffer::fromCkt, py::call_guard<py::gil_scoped_release>(), "Export the placed layout of a circuit", py::arg("designDB"), py::arg("cktIdx"))
+        .def("addLayout", &ShapeBuffer::addLayout, "Append all the rectangles and the texts of a layout")
+        .def("addShape", &ShapeBuffer::addShape, "Append a rectangle", py::arg("layer"), py::arg("datatype"), py::arg("rect"), py::arg("netIdx") = PROJECT_NAMESPACE::INDEX_TYPE_MAX)
+        .def("addShapes", [](ShapeBuffer &buffer, py::array_t<PROJECT_NAMESPACE::IndexType, py::array::c_style | py::array::forcecast> layers,
+                    py::array_t<PROJECT_NAMESPACE::IndexType, py::array::c_style | py::array::forcecast> datatypes,
+                    py::array_t<PROJECT_NAMESPACE::LocType, py::array::c_style | py::array::forcecast> rects,
+                    py::array_t<PROJECT_NAMESPACE::IndexType, py::array::c_style | py::array::forcecast> nets)
+                {
+                    auto toVector = [](const auto &array) { return std::vector<typename std::decay_t<decltype(array)>::value_type>(array.data(), array.data() + array.size()); };
+                    buffer.addShapes(toVector(layers), toVector(datatypes), toVector(rects), toVector(nets));
+                },
+                "Append rectangles from numpy arrays: the layers, the datatypes, an N x 4 array of xLo, yLo, xHi, yHi and the nets, which may be empty",
+                py::arg("layers"), py::arg("datatypes"), py::arg("rects"), py::arg("nets") = py::array_t<PROJECT_NAMESPACE::IndexType>(0))
+        .def("addText", &ShapeBuffer::addText, "Append a text", py::arg("layer"), py::arg("text"), py::arg("coord"))
+        .def("setBoundary", &ShapeBuffer::setBoundary)
+        .def("applyTo", &ShapeBuffer::applyTo, py::call_guard<py::gil_scoped_release>(), "Append the rectangles and the texts into a layout")
+        .def("clear", &ShapeBuffer::clear)
+        .def("numShapes", &ShapeBuffer::numShapes)
+        .def("shape", &ShapeBuffer::shape)
+        .def("layer", &ShapeBuffer::layer)
+        .def("datatype", &ShapeBuffer::datatype)
+        .def("net", &ShapeBuffer::net)
+        .def("rectArray", [](py::object self) { return shapeArrayView(self.cast<const ShapeBuffer &>().rectArray(), self, 4); },
+                "Read-only numpy view of the rectangles as an N x 4 array of xLo, yLo, xHi, yHi, valid until the buffer is changed")
+        .def("layerArray", [](py::object self) { return shapeArrayView(self.cast<const ShapeBuffer &>().layerArray(), self); },
+                "Read-only numpy view of the database layers of the rectangles, valid until the buffer is changed")
+        .def("datatypeArray", [](py::object self) { return shapeArrayView(self.cast<const ShapeBuffer &>().datatypeArray(), self); },
+                "Read-only numpy view of the datatypes of the rectangles, valid until the buffer is changed")
+        .def("netArray", [](py::object self) { return shapeArrayView(self.cast<const ShapeBuffer &>().netArray(), self); },
+                "Read-only numpy view of the nets of the rectangles, valid until the buffer is changed")
+        .def("pdkLayerArray", [](const ShapeBuffer &buffer, const PROJECT_NAMESPACE::TechDB &techDB)
+                {
+                    const auto layers = buffer.pdkLayerArray(techDB);
+                    return py::array_t<PROJECT_NAMESPACE::IndexType>(static_cast<py::ssize_t>(layers.size()), layers.data());
+                },
+                "A copy of the GDSII layers of the rectangles")
+        .def("numTexts", &ShapeBuffer::numTexts)
+        .def("text", &ShapeBuffer::text, py::return_value_policy::reference_internal)
+        .def("textLayer", &ShapeBuffer::textLayer)
+        .def("boundary", &ShapeBuffer::boundary);
+    using PowerGeometryRule = PROJECT_NAMESPACE::PowerGeometryRule;
+    py::class_<PowerGeometryRule>(m , "PowerGeometryRule")
+        .def(py::init<>())
+        .def_static("fromTech", &PowerGeometryRule::fromTech, "The default rules, with the CO, VIA1, OD and M1 rules of the technology")
+        .def_readwrite("contactSize", &PowerGeometryRule::contactSize)
+        .def_readwrite("contactSpacing", &PowerGeometryRule::contactSpacing)
+        .def_readwrite("contactEnclosure", &PowerGeometryRule::contactEnclosure)
+        .def_readwrite("ringWidth", &PowerGeometryRule::ringWidth)
+        .def_readwrite("implantEnclosure", &PowerGeometryRule::implantEnclosure)
+        .def_readwrite("wellEnclosure", &PowerGeometryRule::wellEnclosure)
+        .def_readwrite("viaSize", &PowerGeometryRule::viaSize)
+        .def_readwrite("viaSpacing", &PowerGeometryRule::viaSpacing)
+        .def_readwrite("viaEnclosure", &PowerGeometryRule::viaEnclosure);
+    using PowerGeometry = PROJECT_NAMESPACE::PowerGeometry;
+    py::class_<PowerGeometry>(m , "PowerGeometry")
+        .def(py::init<const PROJECT_NAMESPACE::TechDB &>(), py::keep_alive<1, 2>())
+        .def("setRule", &PowerGeometry::setRule)
+        .def("rule", &PowerGeometry::rule, py::return_value_policy::copy)
+        .def("addGuardRing", &PowerGeometry::addGuardRing, "Add a guard ring around a boundary, returning the M1 of its bottom, right, top and left sides",
+                py::arg("inner"), py::arg("isNwell"), py::arg("out"), py::arg("netIdx") = PROJECT_NAMESPACE::INDEX_TYPE_MAX)
+        .def("addPowerStripe", &PowerGeometry::addPowerStripe, "Add a power stripe on a metal layer", py::arg("stripe"), py::arg("metalLayer"), py::arg("out"), py::arg("netIdx") = PROJECT_NAMESPACE::INDEX_TYPE_MAX)
+        .def("addViaStack", &PowerGeometry::addViaStack, "Add the metals and the vias stacking a pin shape between two metal layers",
+                py::arg("shape"), py::arg("fromMetal"), py::arg("toMetal"), py::arg("out"), py::arg("netIdx") = PROJECT_NAMESPACE::INDEX_TYPE_MAX)
+        .def_static("metalLayer", &PowerGeometry::metalLayer, "The metal layer of a db layer named Mk, 0 for the other layers")
+        .def_static("insertIoPinNode", &PowerGeometry::insertIoPinNode, "Connect shapes to a net as a new io pin cell, returning the new node",
+                py::arg("designDB"), py::arg("cktIdx"), py::arg("netIdx"), py::arg("shapes"), py::arg("isPowerStripe"), py::arg("gridStep"));
+    using PcellRule = PROJECT_NAMESPACE::PcellRule;
+    py::class_<PcellRule>(m , "PcellRule")
+        .def(py::init<>())
+        .def_static("fromTech", &PcellRule::fromTech, "The default rules, with the CO, VIA1 and M1 rules of the technology")
+        .def_readwrite("contactSize", &PcellRule::contactSize)
+        .def_readwrite("contactSpacing", &PcellRule::contactSpacing)
+        .def_readwrite("contactEnclosure", &PcellRule::contactEnclosure)
+        .def_readwrite("metalToGate", &PcellRule::metalToGate)
+        .def_readwrite("polyExtension", &PcellRule::polyExtension)
+        .def_readwrite("metalWidth", &PcellRule::metalWidth)
+        .def_readwrite("metalSpacing", &PcellRule::metalSpacing)
+        .def_readwrite("viaSize", &PcellRule::viaSize)
+        .def_readwrite("viaSpacing", &PcellRule::viaSpacing)
+        .def_readwrite("viaEnclosure", &PcellRule::viaEnclosure)
+        .def_readwrite("implantEnclosure", &PcellRule::implantEnclosure)
+        .def_readwrite("wellEnclosure", &PcellRule::wellEnclosure)
+        .def_readwrite("rpoExtension", &PcellRule::rpoExtension);
+    using PcellShapes = PROJECT_NAMESPACE::PcellShapes;
+    py::class_<PcellShapes>(m , "PcellShapes")
+        .def(py::init<>())
+        .def_readonly("shapes", &PcellShapes::shapes)
+        .def_readonly("pins", &PcellShapes::pins)
+        .def_readonly("pinMetals", &PcellShapes::pinMetals);
+    using PcellGenerator = PROJECT_NAMESPACE::PcellGenerator;
+    py::class_<PcellGenerator>(m , "PcellGenerator")
+        .def(py::init<PROJECT_NAMESPACE::DesignDB &>(), py::keep_alive<1, 2>())
+        .def("setRule", &PcellGenerator::setRule)
+        .def("rule", &PcellGenerator::rule, py::return_value_policy::copy)
+        .def("canGenerate", &PcellGenerator::canGenerate, "Whether a circuit is a device with the properties its layout needs")
+        .def("build", &PcellGenerator::build, "Generate the shapes and the terminals of a device, without touching the circuit", py::arg("cktIdx"), py::arg("flipCell"), py::arg("out"))
+        .def("generate", &PcellGenerator::generate, "Generate the layout, the boundary and the io pins of a device into its circuit", py::arg("cktIdx"), py::arg("flipCell"))
+        .def("generateAll", &PcellGenerator::generateAll, py::call_guard<py::gil_scoped_release>(),
+                "Generate many devices in parallel, returning the number generated", py::arg("cktIdxs"), py::arg("flipCells"));
+    using MemoryStat = PROJECT_NAMESPACE::MemoryStat;
+    py::class_<MemoryStat>(m , "MemoryStat")
+        .def(py::init<>())
+        .def_readonly("bytes", &MemoryStat::bytes)
+        .def_readonly("count", &MemoryStat::count);
+    using MemoryUsage = PROJECT_NAMESPACE::MemoryUsage;
+    py::class_<MemoryUsage>(m , "MemoryUsage")
+        .def(py::init<>())
+        .def_static("ofCkt", &MemoryUsage::ofCkt, "The memory footprint of one circuit")
+        .def_static("ofSubtree", &MemoryUsage::ofSubtree, py::call_guard<py::gil_scoped_release>(), "The memory footprint of a circuit and the circuits below it")
+        .def_static("ofDesign", &MemoryUsage::ofDesign, py::call_guard<py::gil_scoped_release>(), "The memory footprint of a design, with the names, the technology and the arena")
+        .def_readonly("circuits", &MemoryUsage::circuits)
+        .def_readonly("nodes", &MemoryUsage::nodes)
+        .def_readonly("pins", &MemoryUsage::pins)
+        .def_readonly("nets", &MemoryUsage::nets)
+        .def_readonly("ioInterfaces", &MemoryUsage::ioInterfaces)
+        .def_readonly("connectivity", &MemoryUsage::connectivity)
+        .def_readonly("constraint", &MemoryUsage::constraint)
+        .def_readonly("gdsData", &MemoryUsage::gdsData)
+        .def_readonly("layout", &MemoryUsage::layout)
+        .def_readonly("layers", &MemoryUsage::layers)
+        .def_readonly("names", &MemoryUsage::names)
+        .def_readonly("techDB", &MemoryUsage::techDB)
+        .def_readonly("arena", &MemoryUsage::arena)
+        .def("layoutTotal", &MemoryUsage::layoutTotal)
+        .def("totalBytes", &MemoryUsage::totalBytes)
+        .def("summary", &MemoryUsage::summary, "The table of the components and the non-empty layers", py::arg("techDB") = nullptr)
+        .def("trace", &MemoryUsage::trace, "Record the bytes of the components as samples of the tracer");
     py::class_<PROJECT_NAMESPACE::DesignDB>(m , "DesignDB")
         .def(py::init<>())
         .def("numCkts", &PROJECT_NAMESPACE::DesignDB::numCkts)
-        .def("subCkt", &PROJECT_NAMESPACE::DesignDB::subCkt, py::return_value_policy::reference)
+        .def("subCkt", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::DesignDB::subCkt), py::return_value_policy::reference)
         .def("resizeSubCkts", &PROJECT_NAMESPACE::DesignDB::resizeSubCkts, "resize the sub circuits")
         .def("rootCktIdx", &PROJECT_NAMESPACE::DesignDB::rootCktIdx)
         .def("allocateCkt", &PROJECT_NAMESPACE::DesignDB::allocateCkt)
         .def("findRootCkt", &PROJECT_NAMESPACE::DesignDB::findRootCkt)
+        .def("hierarchy", &PROJECT_NAMESPACE::DesignDB::hierarchy, py::return_value_policy::reference_internal, "Get the cached levelized hierarchy")
+        .def("invalidateHierarchy", &PROJECT_NAMESPACE::DesignDB::invalidateHierarchy, "Drop the cached levelized hierarchy")
+        .def("compactConnectivity", &PROJECT_NAMESPACE::DesignDB::compactConnectivity, "Pack the pin lists of the nodes and the nets of all the circuits")
+        .def("saveCheckpoint", &PROJECT_NAMESPACE::DesignDB::saveCheckpoint, py::call_guard<py::gil_scoped_release>(), "Write a binary snapshot of the design")
+        .def("loadCheckpoint", &PROJECT_NAMESPACE::DesignDB::loadCheckpoint, py::call_guard<py::gil_scoped_release>(), "Read a binary snapshot into an empty design")
+        .def("saveSubDesignCheckpoint", &PROJECT_NAMESPACE::DesignDB::saveSubDesignCheckpoint, py::call_guard<py::gil_scoped_release>(),
+                "Write a circuit and the circuits under it as a design checkpoint of their own, rooted at the circuit", py::arg("cktIdx"), py::arg("fileName"))
+        .def("saveSubtreeCheckpoint", &PROJECT_NAMESPACE::DesignDB::saveSubtreeCheckpoint, py::call_guard<py::gil_scoped_release>(),
+                "Write the implementation of a circuit and the circuits under it", py::arg("cktIdx"), py::arg("fileName"))
+        .def("loadSubtreeCheckpoint", &PROJECT_NAMESPACE::DesignDB::loadSubtreeCheckpoint, py::call_guard<py::gil_scoped_release>(),
+                "Restore the implementation of a circuit and the circuits under it. Return whether it is found and matches", py::arg("cktIdx"), py::arg("fileName"))
+        .def("setTechDB", [](PROJECT_NAMESPACE::DesignDB &designDB, std::shared_ptr<PROJECT_NAMESPACE::TechDB> techDB) { designDB.setTechDB(techDB); },
+                "Set the technology database shared by all the circuits")
+        .def("instanceView", &PROJECT_NAMESPACE::DesignDB::instanceView, py::keep_alive<0, 1>(), "The view of a node on its sub circuit, valid until a circuit is added",
+                py::arg("cktIdx"), py::arg("nodeIdx"))
+        .def("instanceViews", &PROJECT_NAMESPACE::DesignDB::instanceViews, py::keep_alive<0, 1>(), "The views of the nodes of a circuit on their sub circuits",
+                py::arg("cktIdx"))
+        .def("insertSubLayouts", &PROJECT_NAMESPACE::DesignDB::insertSubLayouts, "Insert the layouts of all the sub circuits into the layout of a circuit",
+                py::arg("cktIdx"), py::arg("copyTexts") = true)
         .def_readwrite("power", &PROJECT_NAMESPACE::DesignDB::power)
         .def_readwrite("ground", &PROJECT_NAMESPACE::DesignDB::power)
-        .def("phyPropDB", &PROJECT_NAMESPACE::DesignDB::phyPropDB, py::return_value_policy::reference, "Get physical property DB");
+        .def("netPinShapes", [](const PROJECT_NAMESPACE::DesignDB &designDB, PROJECT_NAMESPACE::IndexType cktIdx)
+                { return std::const_pointer_cast<NetPinShapes>(designDB.netPinShapes(cktIdx)); },
+                py::call_guard<py::gil_scoped_release>(), "The io pin shapes of the sub circuits connected by the nets of a circuit in its coordinates, cached until the placement changes")
+        .def("invalidateNetPinShapes", &PROJECT_NAMESPACE::DesignDB::invalidateNetPinShapes, "Drop the cached pin shapes of a circuit")
+        .def("phyPropDB", py::overload_cast<>(&PROJECT_NAMESPACE::DesignDB::phyPropDB), py::return_value_policy::reference, "Get physical property DB")
+        .def("deviceLayoutCache", &PROJECT_NAMESPACE::DesignDB::deviceLayoutCache, py::return_value_policy::reference_internal, "Get the cache of the device layouts")
+        .def("stdCellLibrary", &PROJECT_NAMESPACE::DesignDB::stdCellLibrary, py::return_value_policy::reference_internal, "Get the standard cells shared by the standard cell circuits")
+        .def("restoreDeviceLayout", &PROJECT_NAMESPACE::DesignDB::restoreDeviceLayout, "Restore the layout of a device circuit from the cache. Return whether it is found",
+                py::arg("cktIdx"), py::arg("flipCell"))
+        .def("cacheDeviceLayout", &PROJECT_NAMESPACE::DesignDB::cacheDeviceLayout, "Put the layout of a device circuit into the cache",
+                py::arg("cktIdx"), py::arg("flipCell"));
 }
@@ -16,7 +16,7 @@ void initGraphComponentsAPI(py::module &m)
     py::class_<PROJECT_NAMESPACE::GdsData>(m, "GdsData")
         .def(py::init<>())
         .def_property("gdsFile", &PROJECT_NAMESPACE::GdsData::gdsFile, &PROJECT_NAMESPACE::GdsData::setGdsFile)
-        .def("bbox", &PROJECT_NAMESPACE::GdsData::bbox, py::return_value_policy::reference)
+        .def("bbox", py::overload_cast<>(&PROJECT_NAMESPACE::GdsData::bbox), py::return_value_policy::reference)
         .def("setBBox", &PROJECT_NAMESPACE::GdsData::setBBox);
 
     py::class_<PROJECT_NAMESPACE::CktNode>(m , "CktNode")
@@ -28,13 +28,13 @@ void initGraphComponentsAPI(py::module &m)
         .def_property("isImpl", &PROJECT_NAMESPACE::CktNode::isImpl, &PROJECT_NAMESPACE::CktNode::setIsImpl)
         .def_property("flipVertFlag", &PROJECT_NAMESPACE::CktNode::flipVertFlag, &PROJECT_NAMESPACE::CktNode::setFlipVertFlag)
         .def("isLeaf", &PROJECT_NAMESPACE::CktNode::isLeaf)
-        .def("offset", &PROJECT_NAMESPACE::CktNode::offset, py::return_value_policy::reference)
+        .def("offset", py::overload_cast<>(&PROJECT_NAMESPACE::CktNode::offset), py::return_value_policy::reference)
         .def("setOffset", &PROJECT_NAMESPACE::CktNode::setOffset)
         .def_property("implType", &PROJECT_NAMESPACE::CktNode::implType, &PROJECT_NAMESPACE::CktNode::setImplType)
         .def_property("refName", &PROJECT_NAMESPACE::CktNode::refName, &PROJECT_NAMESPACE::CktNode::setRefName)
         .def_property("name", &PROJECT_NAMESPACE::CktNode::name, &PROJECT_NAMESPACE::CktNode::setName)
         .def("setOrient", &PROJECT_NAMESPACE::CktNode::setOrient)
-        .def("orient", &PROJECT_NAMESPACE::CktNode::orient, py::return_value_policy::reference);
+        .def("orient", py::overload_cast<>(&PROJECT_NAMESPACE::CktNode::orient), py::return_value_policy::reference);
 
     py::class_<PROJECT_NAMESPACE::Net>(m, "Net")
         .def(py::init<>())
@@ -52,7 +52,7 @@ void initGraphComponentsAPI(py::module &m)
         .def_property("ioLayer", &PROJECT_NAMESPACE::Net::ioLayer, &PROJECT_NAMESPACE::Net::setIoLayer)
         .def("addIoPin", &PROJECT_NAMESPACE::Net::addIoPin, " Add a new io pin shape to the net")
         .def("numIoPins", &PROJECT_NAMESPACE::Net::numIoPins, "Get the number of IO pin shapes in this net")
-        .def("ioPinShape", &PROJECT_NAMESPACE::Net::ioPinShape, py::return_value_policy::reference, "Similar to ioShape(), but instead of returnning the first io pin shape, this is returning by the index of io pin shape")
+        .def("ioPinShape", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::Net::ioPinShape), py::return_value_policy::reference, "Similar to ioShape(), but instead of returnning the first io pin shape, this is returning by the index of io pin shape")
         .def("ioPinMetalLayer", &PROJECT_NAMESPACE::Net::ioPinMetalLayer, "Similar to .ioLayer, but instead of returnning the first io pin shape, this is returning by the index of io pin shape")
         .def("isIoPowerStripe", &PROJECT_NAMESPACE::Net::isIoPowerStripe, "Get whether the io shape is a power stripe")
         .def("markIoPowerStripe", &PROJECT_NAMESPACE::Net::markIoPowerStripe, "Mark a io shape as power stripe")
@@ -7,10 +7,53 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 #include "db/Layout.h"
+#include "util/Polygon2Rect.h"
 
 namespace py = pybind11;
 
+namespace
+{
+    /// @brief a read-only numpy view of an array of a layer, without copying. Valid until the layer is changed
+    template<typename T>
+    py::array_t<T> layerArrayView(const std::vector<T> &vec, py::handle owner)
+    {
+        py::array_t<T> view({static_cast<py::ssize_t>(vec.size())}, {static_cast<py::ssize_t>(sizeof(T))}, vec.data(), owner);
+        view.attr("setflags")(py::arg("write") = false);
+        return view;
+    }
+    /// @brief the rectangles of a layer as an N x 4 array of xLo, yLo, xHi, yHi
+    py::array_t<PROJECT_NAMESPACE::LocType> rectArray(const PROJECT_NAMESPACE::LayoutLayer &layer)
+    {
+        py::ssize_t numRects = layer.numRects();
+        py::array_t<PROJECT_NAMESPACE::LocType> rects({numRects, static_cast<py::ssize_t>(4)});
+        auto out = rects.mutable_unchecked<2>();
+        for (py::ssize_t idx = 0; idx < numRects; ++idx)
+        {
+            out(idx, 0) = layer.xLoArray()[idx];
+            out(idx, 1) = layer.yLoArray()[idx];
+            out(idx, 2) = layer.xHiArray()[idx];
+            out(idx, 3) = layer.yHiArray()[idx];
+        }
+        return rects;
+    }
+    /// @brief the vertices of a polygon of a layer as an N x 2 array of x, y
+    py::array_t<PROJECT_NAMESPACE::LocType> polygonArray(const PROJECT_NAMESPACE::LayoutLayer &layer, PROJECT_NAMESPACE::IndexType polyIdx)
+    {
+        py::ssize_t numPts = layer.numPolygonPoints(polyIdx);
+        py::array_t<PROJECT_NAMESPACE::LocType> pts({numPts, static_cast<py::ssize_t>(2)});
+        auto out = pts.mutable_unchecked<2>();
+        for (py::ssize_t idx = 0; idx < numPts; ++idx)
+        {
+            const auto pt = layer.polygonPoint(polyIdx, static_cast<PROJECT_NAMESPACE::IndexType>(idx));
+            out(idx, 0) = pt.x();
+            out(idx, 1) = pt.y();
+        }
+        return pts;
+    }
+}
+
 void initLayoutAPI(py::module &m)
 {
     py::class_<PROJECT_NAMESPACE::LayoutObject> layoutObject(m, "LayoutObject");
@@ -19,8 +62,8 @@ void initLayoutAPI(py::module &m)
 
     py::class_<PROJECT_NAMESPACE::TextLayout>(m , "TextLayout", layoutObject)
         .def(py::init<>())
-        .def_property("text", &PROJECT_NAMESPACE::TextLayout::text, &PROJECT_NAMESPACE::TextLayout::setText)
-        .def("coord", &PROJECT_NAMESPACE::TextLayout::coord, py::return_value_policy::reference, "The coordinate of the text in the layout");
+        .def_property("text", py::overload_cast<>(&PROJECT_NAMESPACE::TextLayout::text, py::const_), &PROJECT_NAMESPACE::TextLayout::setText)
+        .def("coord", py::overload_cast<>(&PROJECT_NAMESPACE::TextLayout::coord), py::return_value_policy::reference, "The coordinate of the text in the layout");
 
     py::class_<PROJECT_NAMESPACE::RectLayout>(m , "RectLayout", layoutObject)
         .def(py::init<>())
@@ -28,20 +71,55 @@ void initLayoutAPI(py::module &m)
 
     py::class_<PROJECT_NAMESPACE::LayoutLayer>(m , "LayoutLayer", layoutObject)
         .def(py::init<>())
-        .def("rect", &PROJECT_NAMESPACE::LayoutLayer::rect, py::return_value_policy::reference, "The rectangle representing the geometry");
+        .def("rect", &PROJECT_NAMESPACE::LayoutLayer::rect, "A copy of the rectangle object")
+        .def("numRects", &PROJECT_NAMESPACE::LayoutLayer::numRects, "The number of rectangles in the layer")
+        .def("box", &PROJECT_NAMESPACE::LayoutLayer::box, "The geometry of one rectangle")
+        .def("datatype", &PROJECT_NAMESPACE::LayoutLayer::datatype, "The datatype of one rectangle")
+        .def("rectArray", &rectArray, "A copy of all the rectangles as an N x 4 numpy array of xLo, yLo, xHi, yHi")
+        .def("xLoArray", [](py::object self) { return layerArrayView(self.cast<const PROJECT_NAMESPACE::LayoutLayer &>().xLoArray(), self); },
+                "Read-only numpy view of the xLo of all the rectangles, valid until the layer is changed")
+        .def("yLoArray", [](py::object self) { return layerArrayView(self.cast<const PROJECT_NAMESPACE::LayoutLayer &>().yLoArray(), self); },
+                "Read-only numpy view of the yLo of all the rectangles, valid until the layer is changed")
+        .def("xHiArray", [](py::object self) { return layerArrayView(self.cast<const PROJECT_NAMESPACE::LayoutLayer &>().xHiArray(), self); },
+                "Read-only numpy view of the xHi of all the rectangles, valid until the layer is changed")
+        .def("yHiArray", [](py::object self) { return layerArrayView(self.cast<const PROJECT_NAMESPACE::LayoutLayer &>().yHiArray(), self); },
+                "Read-only numpy view of the yHi of all the rectangles, valid until the layer is changed")
+        .def("datatypeArray", [](py::object self) { return layerArrayView(self.cast<const PROJECT_NAMESPACE::LayoutLayer &>().datatypeArray(), self); },
+                "Read-only numpy view of the datatypes of all the rectangles, valid until the layer is changed")
+        .def("numPolygons", &PROJECT_NAMESPACE::LayoutLayer::numPolygons, "The number of rectilinear polygons in the layer, kept apart from the rectangles")
+        .def("polygonDatatype", &PROJECT_NAMESPACE::LayoutLayer::polygonDatatype, "The datatype of one polygon")
+        .def("polygon", &polygonArray, "A copy of the vertices of one polygon as an N x 2 numpy array of x, y")
+        .def("polygonRectRange", &PROJECT_NAMESPACE::LayoutLayer::polygonRectRange, "The [begin, end) range of the rectangles sliced from one polygon");
 
     py::class_<PROJECT_NAMESPACE::Layout>(m, "Layout")
         .def(py::init())
         .def("init", &PROJECT_NAMESPACE::Layout::init)
         .def("clear", &PROJECT_NAMESPACE::Layout::clear)
-        .def("text", &PROJECT_NAMESPACE::Layout::text, py::return_value_policy::reference)
+        .def("text", py::overload_cast<PROJECT_NAMESPACE::IndexType, PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::Layout::text), py::return_value_policy::reference)
         .def("numLayers", &PROJECT_NAMESPACE::Layout::numLayers, py::return_value_policy::reference)
         .def("numRects", &PROJECT_NAMESPACE::Layout::numRects, py::return_value_policy::reference)
+        .def("numPolygons", &PROJECT_NAMESPACE::Layout::numPolygons, "The number of rectilinear polygons in a layer")
         .def("boundary", &PROJECT_NAMESPACE::Layout::boundary, py::return_value_policy::reference)
         .def("setBoundary", &PROJECT_NAMESPACE::Layout::setBoundary, py::return_value_policy::reference)
-        .def("rect", &PROJECT_NAMESPACE::Layout::rect, py::return_value_policy::reference)
-        .def("insertLayout", &PROJECT_NAMESPACE::Layout::insertLayout)
+        .def("rect", &PROJECT_NAMESPACE::Layout::rect, "A copy of the rectangle object")
+        .def("layer", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::Layout::layer, py::const_), py::return_value_policy::reference, "Get one layer of the layout")
+        .def("rectArray", [](const PROJECT_NAMESPACE::Layout &layout, PROJECT_NAMESPACE::IndexType layerIdx) { return rectArray(layout.layer(layerIdx)); },
+                "A copy of all the rectangles in a layer as an N x 4 numpy array of xLo, yLo, xHi, yHi")
+        .def("datatypeArray", [](py::object self, PROJECT_NAMESPACE::IndexType layerIdx)
+                { return layerArrayView(self.cast<const PROJECT_NAMESPACE::Layout &>().layer(layerIdx).datatypeArray(), self); },
+                "Read-only numpy view of the datatypes of all the rectangles in a layer, valid until the layer is changed")
+        .def("insertLayout", py::overload_cast<PROJECT_NAMESPACE::Layout &, PROJECT_NAMESPACE::LocType, PROJECT_NAMESPACE::LocType, bool>
+                (&PROJECT_NAMESPACE::Layout::insertLayout), "Insert a sub layout with an offset and optional vertical flip")
+        .def("insertLayout", py::overload_cast<const PROJECT_NAMESPACE::Layout &, const PROJECT_NAMESPACE::XY<PROJECT_NAMESPACE::LocType> &, PROJECT_NAMESPACE::OriType, bool, bool>
+                (&PROJECT_NAMESPACE::Layout::insertLayout), "Insert a sub layout under an orientation",
+                py::arg("layout"), py::arg("offset"), py::arg("orient"), py::arg("flipVertFlag"), py::arg("copyTexts") = true)
         .def("setRectDatatype", &PROJECT_NAMESPACE::Layout::setRectDatatype)
+        .def("mergeRects", &PROJECT_NAMESPACE::Layout::mergeRects, py::call_guard<py::gil_scoped_release>(),
+                "Merge the abutting and overlapping rectangles of the same datatype in every layer. Return the number of rectangles removed")
+        .def("queryOverlap", &PROJECT_NAMESPACE::Layout::queryOverlap, "Find the indices of rectangles in a layer overlapping with a box",
+                py::arg("layerIdx"), py::arg("box"), py::arg("touch") = false)
+        .def("queryWindow", &PROJECT_NAMESPACE::Layout::queryWindow, "Find the indices of rectangles in a layer inside a window")
+        .def("queryNearest", &PROJECT_NAMESPACE::Layout::queryNearest, "Find the indices of the k nearest rectangles in a layer to a point")
         .def("insertText", py::overload_cast<PROJECT_NAMESPACE::IndexType, const PROJECT_NAMESPACE::TextLayout &>(&PROJECT_NAMESPACE::Layout::insertText), "Insert a text object in the layout")
         .def("insertText", py::overload_cast<PROJECT_NAMESPACE::IndexType, const std::string &, const PROJECT_NAMESPACE::XY<PROJECT_NAMESPACE::LocType> &>
                 (&PROJECT_NAMESPACE::Layout::insertText), "Insert a text object in the layout")
@@ -54,5 +132,17 @@ void initLayoutAPI(py::module &m)
         .def("insertRect", py::overload_cast<PROJECT_NAMESPACE::IndexType, const PROJECT_NAMESPACE::XY<PROJECT_NAMESPACE::LocType> &, const PROJECT_NAMESPACE::XY<PROJECT_NAMESPACE::LocType> &>
                 (&PROJECT_NAMESPACE::Layout::insertRect), "Insert a rectangle object in the layout")
         .def("insertRect", py::overload_cast<PROJECT_NAMESPACE::IndexType, PROJECT_NAMESPACE::LocType, PROJECT_NAMESPACE::LocType, PROJECT_NAMESPACE::LocType, PROJECT_NAMESPACE::LocType>
-                (&PROJECT_NAMESPACE::Layout::insertRect), "Insert a rectangle object in the layout");
+                (&PROJECT_NAMESPACE::Layout::insertRect), "Insert a rectangle object in the layout")
+        .def("insertPolygon", [](PROJECT_NAMESPACE::Layout &layout, PROJECT_NAMESPACE::IndexType layerIdx, const std::vector<PROJECT_NAMESPACE::XY<PROJECT_NAMESPACE::LocType>> &pts, PROJECT_NAMESPACE::IndexType datatype)
+                {
+                    std::vector<PROJECT_NAMESPACE::XY<PROJECT_NAMESPACE::LocType>> simple(pts);
+                    if (!::klib::simplifyRectilinear(simple))
+                    {
+                        WRN("Layout.insertPolygon: the polygon is not rectilinear \n");
+                        return PROJECT_NAMESPACE::INDEX_TYPE_MAX;
+                    }
+                    return layout.insertPolygon(layerIdx, simple.begin(), simple.end(), datatype);
+                },
+                py::arg("layerIdx"), py::arg("pts"), py::arg("datatype") = 0,
+                "Insert a rectilinear polygon in a layer and slice it into rectangles. Returns INDEX_TYPE_MAX if it is not rectilinear");
 }
@@ -8,6 +8,8 @@
 #include <pybind11/pybind11.h>
 #include "global/global.h"
 #include "db/TechDB.h"
+#include "parser/ParseNetlist.h"
+#include "parser/GdsMappedLibrary.h"
 
 namespace py = pybind11;
 
@@ -15,4 +17,10 @@ namespace py = pybind11;
 void initParseAPI(py::module &m)
 {
     m.def("parseSimpleTechFile", &PROJECT_NAMESPACE::PARSE::parseSimpleTechFile, "Parse simple tech file");
+    m.def("parseSimpleTechRules", &PROJECT_NAMESPACE::PARSE::parseSimpleTechRules,
+            "Parse the layer rules of a LEF-like simple tech file. The existing layers are matched by TECHLAYER", py::arg("file"), py::arg("techDB"));
+    m.def("parseNetlist", &PROJECT_NAMESPACE::PARSE::parseNetlist, py::call_guard<py::gil_scoped_release>(),
+            "Parse a hspice (isHspice=True) or spectre netlist into the design database", py::arg("file"), py::arg("designDB"), py::arg("isHspice"));
+    m.def("closeGdsLibraries", &PROJECT_NAMESPACE::GdsMappedLibrary::closeAll, "Unmap the GDSII libraries kept mapped by CktGraph.parseGDSCell");
+    m.def("numGdsLibraries", &PROJECT_NAMESPACE::GdsMappedLibrary::numOpen, "The number of GDSII libraries kept mapped");
 }
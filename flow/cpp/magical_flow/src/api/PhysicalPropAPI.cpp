@@ -6,22 +6,74 @@
  */
 
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 #include "db/PhysicalProp.h"
 
 namespace py = pybind11;
 
+namespace
+{
+    /// @brief a read-only numpy view of an array of the classes, without copying. The owner, holding the classes, is kept alive as long as the view
+    template<typename T>
+    py::array_t<T> classArrayView(const std::vector<T> &vec, py::handle owner, py::ssize_t numCols = 1)
+    {
+        std::vector<py::ssize_t> shape = {static_cast<py::ssize_t>(numCols == 0 ? 0 : vec.size() / numCols)}, strides = {static_cast<py::ssize_t>(numCols * sizeof(T))};
+        if (numCols > 1)
+        {
+            shape.emplace_back(numCols);
+            strides.emplace_back(sizeof(T));
+        }
+        py::array_t<T> view(shape, strides, vec.data(), owner);
+        view.attr("setflags")(py::arg("write") = false);
+        return view;
+    }
+}
+
 void initPhysicalPropAPI(py::module &m)
 {
     py::class_<PROJECT_NAMESPACE::PhyPropDB>(m, "PhyPropDB")
         .def(py::init<>())
-        .def("nch", &PROJECT_NAMESPACE::PhyPropDB::nch, py::return_value_policy::reference, "Get a nch device property")
+        .def("nch", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::PhyPropDB::nch, py::const_), py::return_value_policy::copy, "Get a copy of a nch device property")
+        .def("mutableNch", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::PhyPropDB::nch), py::return_value_policy::reference_internal,
+                "Get a nch device property to set. The classes of the nch devices are rebuilt on the next query")
         .def("allocateNch", &PROJECT_NAMESPACE::PhyPropDB::allocateNch, "Allocate a new nch device")
-        .def("pch", &PROJECT_NAMESPACE::PhyPropDB::pch, py::return_value_policy::reference, "Get a pch device property")
+        .def("pch", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::PhyPropDB::pch, py::const_), py::return_value_policy::copy, "Get a copy of a pch device property")
+        .def("mutablePch", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::PhyPropDB::pch), py::return_value_policy::reference_internal,
+                "Get a pch device property to set. The classes of the pch devices are rebuilt on the next query")
         .def("allocatePch", &PROJECT_NAMESPACE::PhyPropDB::allocatePch, "Allocate a new pch device")
-        .def("resistor", &PROJECT_NAMESPACE::PhyPropDB::resister, py::return_value_policy::reference, "Get a resistor device property")
+        .def("resistor", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::PhyPropDB::resister, py::const_), py::return_value_policy::copy, "Get a copy of a resistor device property")
+        .def("mutableResistor", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::PhyPropDB::resister), py::return_value_policy::reference_internal,
+                "Get a resistor device property to set. The classes of the resistors are rebuilt on the next query")
         .def("allocateRes", &PROJECT_NAMESPACE::PhyPropDB::allocateRes, "Get a resistor device property")
-        .def("capacitor", &PROJECT_NAMESPACE::PhyPropDB::capacitor, py::return_value_policy::reference, "Get a capacitor device property")
-        .def("allocateCap", &PROJECT_NAMESPACE::PhyPropDB::allocateCap, "Allocate a capacitor devices");
+        .def("capacitor", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::PhyPropDB::capacitor, py::const_), py::return_value_policy::copy, "Get a copy of a capacitor device property")
+        .def("mutableCapacitor", py::overload_cast<PROJECT_NAMESPACE::IndexType>(&PROJECT_NAMESPACE::PhyPropDB::capacitor), py::return_value_policy::reference_internal,
+                "Get a capacitor device property to set. The classes of the capacitors are rebuilt on the next query")
+        .def("allocateCap", &PROJECT_NAMESPACE::PhyPropDB::allocateCap, "Allocate a capacitor devices")
+        .def("propClasses", [](const PROJECT_NAMESPACE::PhyPropDB &props, PROJECT_NAMESPACE::ImplType implType)
+                {
+                    return std::const_pointer_cast<PROJECT_NAMESPACE::PhyPropClasses>(props.propClasses(implType));
+                }, "Get the equivalence classes of the devices of an implementation type with identical parameters, as a snapshot unchanged by later changes of the properties")
+        .def("propClassIdx", &PROJECT_NAMESPACE::PhyPropDB::propClassIdx, "Get the equivalence class of a device", py::arg("implType"), py::arg("propIdx"))
+        .def("numPropClasses", &PROJECT_NAMESPACE::PhyPropDB::numPropClasses, "Get the number of equivalence classes of an implementation type");
+
+    using PhyPropClasses = PROJECT_NAMESPACE::PhyPropClasses;
+    py::class_<PhyPropClasses, std::shared_ptr<PhyPropClasses>>(m, "PhyPropClasses")
+        .def("numClasses", &PhyPropClasses::numClasses)
+        .def("numParams", &PhyPropClasses::numParams)
+        .def("classIdx", &PhyPropClasses::classIdx, "Get the class of a device")
+        .def("numMembers", &PhyPropClasses::numMembers)
+        .def("members", &PhyPropClasses::members, "Get the devices of a class, in increasing order")
+        .def("classIdxArray", [](py::object self) { return classArrayView(self.cast<const PhyPropClasses &>().classIdxArray(), self); }, "The class of each device")
+        .def("memberStartArray", [](py::object self) { return classArrayView(self.cast<const PhyPropClasses &>().memberStartArray(), self); },
+                "The devices of class c are memberArray()[memberStartArray()[c], memberStartArray()[c + 1])")
+        .def("memberArray", [](py::object self) { return classArrayView(self.cast<const PhyPropClasses &>().memberArray(), self); })
+        .def("paramArray", [](py::object self)
+                {
+                    const auto &classes = self.cast<const PhyPropClasses &>();
+                    return classArrayView(classes.paramArray(), self, classes.numParams());
+                }, "The parameters of the classes, one row per class")
+        .def("string", &PhyPropClasses::string, "Get a string parameter of paramArray");
 
     py::class_<PROJECT_NAMESPACE::MosProp>(m , "MosProp")
         .def(py::init<>())
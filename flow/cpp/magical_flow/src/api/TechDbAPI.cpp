@@ -17,11 +17,35 @@ void initTechDbAPI(py::module &m)
         .def(py::init())
         .def_property("dbu", &PROJECT_NAMESPACE::TechUnit::dbu, &PROJECT_NAMESPACE::TechUnit::setDbu);
 
-    py::class_<PROJECT_NAMESPACE::TechDB>(m, "TechDB")
+    using LayerRule = PROJECT_NAMESPACE::LayerRule;
+    py::class_<LayerRule>(m, "LayerRule")
         .def(py::init())
-        .def("units", &PROJECT_NAMESPACE::TechDB::units, py::return_value_policy::reference, "Get units for techDB")
+        .def_property("minWidth", &LayerRule::minWidth, &LayerRule::setMinWidth)
+        .def_property("minSpacing", &LayerRule::minSpacing, &LayerRule::setMinSpacing)
+        .def_property("minArea", &LayerRule::minArea, &LayerRule::setMinArea)
+        .def("hasSpacingTable", &LayerRule::hasSpacingTable)
+        .def("empty", &LayerRule::empty, "Whether no rule is checked")
+        .def("spacing", &LayerRule::spacing, "The required spacing for the width of the wider shape and the parallel run length", py::arg("width"), py::arg("parallelRun"))
+        .def("maxSpacing", &LayerRule::maxSpacing)
+        .def("setSpacingTable", &LayerRule::setSpacingTable, "Set the spacings, row major, for the widths of the rows and the parallel run lengths of the columns",
+                py::arg("widths"), py::arg("lengths"), py::arg("spacings"));
+
+    py::class_<PROJECT_NAMESPACE::TechDB, std::shared_ptr<PROJECT_NAMESPACE::TechDB>>(m, "TechDB")
+        .def(py::init())
+        .def("units", py::overload_cast<>(&PROJECT_NAMESPACE::TechDB::units), py::return_value_policy::reference, "Get units for techDB")
         .def("numLayers", &PROJECT_NAMESPACE::TechDB::numLayers, "Get the number of layers")
         .def("dbLayerToPdk", &PROJECT_NAMESPACE::TechDB::dbLayerToPdk, "Convert db layer index to pdk layer ID")
         .def("pdkLayerToDb", &PROJECT_NAMESPACE::TechDB::pdkLayerToDb, "Convert PDK layer ID to db layer index")
-        .def("layerNameToIdx", &PROJECT_NAMESPACE::TechDB::layerNameToIdx, "Convert layer name to db layer index");
+        .def("layerNameToIdx", &PROJECT_NAMESPACE::TechDB::layerNameToIdx, "Convert layer name to db layer index")
+        .def("layerName", &PROJECT_NAMESPACE::TechDB::layerName, "Get the name of a db layer")
+        .def("layerRule", &PROJECT_NAMESPACE::TechDB::layerRule, py::return_value_policy::reference_internal, "Get the width, spacing and area rules of a db layer")
+        .def("setLayerRule", &PROJECT_NAMESPACE::TechDB::setLayerRule, "Set the rules of a db layer")
+        .def("hasLayerRules", &PROJECT_NAMESPACE::TechDB::hasLayerRules, "Whether any layer has a rule to check")
+        .def("metalLayerToDb", &PROJECT_NAMESPACE::TechDB::metalLayerToDb, "Convert a metal layer, n for Mn, to db layer index")
+        .def("isCutLayer", &PROJECT_NAMESPACE::TechDB::isCutLayer, "Whether a db layer is a cut layer connecting other layers")
+        .def("hasLayerStack", &PROJECT_NAMESPACE::TechDB::hasLayerStack, "Whether any cut layer connects other layers")
+        .def("cutConnections", &PROJECT_NAMESPACE::TechDB::cutConnections, "Get the db layers a cut layer connects")
+        .def("addCutConnection", &PROJECT_NAMESPACE::TechDB::addCutConnection, "Connect a db layer by a cut layer", py::arg("cutLayerIdx"), py::arg("layerIdx"))
+        .def("gateLayer", &PROJECT_NAMESPACE::TechDB::gateLayer, "Get the gate layer splitting a diffusion db layer")
+        .def("setGateLayer", &PROJECT_NAMESPACE::TechDB::setGateLayer, "Split a diffusion db layer at the rectangles of a gate layer", py::arg("diffLayerIdx"), py::arg("gateLayerIdx"));
 }
@@ -7,11 +7,25 @@
 
 
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 #include "util/XY.h"
 #include "global/global.h"
+#include "util/Tracer.h"
+#include "util/MsgPrinter.h"
 
 namespace py = pybind11;
 
+namespace
+{
+    /// @brief a timed event of the Python flow, as a context manager: with TraceScope("ota", "place"): ...
+    struct TraceScope
+    {
+        std::string name; ///< The name of the event
+        std::string category; ///< The category of the event
+        std::int64_t start = -1; ///< The start time, -1 if the tracer was disabled on enter
+    };
+}
+
 void initUtilAPI(py::module &m)
 {
     py::class_<PROJECT_NAMESPACE::XY<PROJECT_NAMESPACE::LocType>>(m , "XYLoc")
@@ -32,4 +46,53 @@ void initUtilAPI(py::module &m)
         .def_property("yHi", &PROJECT_NAMESPACE::Box<PROJECT_NAMESPACE::LocType>::yHi, &PROJECT_NAMESPACE::Box<PROJECT_NAMESPACE::LocType>::setYHi)
         .def("xLen", &PROJECT_NAMESPACE::Box<PROJECT_NAMESPACE::LocType>::xLen)
         .def("yLen", &PROJECT_NAMESPACE::Box<PROJECT_NAMESPACE::LocType>::yLen);
+
+    py::class_<PROJECT_NAMESPACE::Tracer>(m, "Tracer")
+        .def_static("enable", &PROJECT_NAMESPACE::Tracer::enable)
+        .def_static("enabled", &PROJECT_NAMESPACE::Tracer::enabled)
+        .def_static("now", &PROJECT_NAMESPACE::Tracer::now)
+        .def_static("addEvent", &PROJECT_NAMESPACE::Tracer::addEvent)
+        .def_static("count", static_cast<void (*)(const std::string &, std::int64_t)>(&PROJECT_NAMESPACE::Tracer::count), py::arg("name"), py::arg("delta") = 1)
+        .def_static("counter", &PROJECT_NAMESPACE::Tracer::counter)
+        .def_static("sample", &PROJECT_NAMESPACE::Tracer::sample, "Record the value of a quantity at this time")
+        .def_static("lastSample", &PROJECT_NAMESPACE::Tracer::lastSample)
+        .def_static("numEvents", &PROJECT_NAMESPACE::Tracer::numEvents)
+        .def_static("enableMemoryTracking", &PROJECT_NAMESPACE::Tracer::enableMemoryTracking, "Sample the resident memory peaks of the parsing, flattening and writing")
+        .def_static("memoryTrackingEnabled", &PROJECT_NAMESPACE::Tracer::memoryTrackingEnabled)
+        .def_static("residentBytes", &PROJECT_NAMESPACE::Tracer::residentBytes)
+        .def_static("peakResidentBytes", &PROJECT_NAMESPACE::Tracer::peakResidentBytes)
+        .def_static("resetPeakResident", &PROJECT_NAMESPACE::Tracer::resetPeakResident)
+        .def_static("writeChromeTrace", &PROJECT_NAMESPACE::Tracer::writeChromeTrace)
+        .def_static("summary", &PROJECT_NAMESPACE::Tracer::summary)
+        .def_static("clear", &PROJECT_NAMESPACE::Tracer::clear);
+
+    py::enum_<PROJECT_NAMESPACE::MsgType>(m, "MsgType")
+        .value("INF", PROJECT_NAMESPACE::MsgType::INF)
+        .value("WRN", PROJECT_NAMESPACE::MsgType::WRN)
+        .value("ERR", PROJECT_NAMESPACE::MsgType::ERR)
+        .value("DBG", PROJECT_NAMESPACE::MsgType::DBG);
+
+    py::class_<PROJECT_NAMESPACE::MsgPrinter>(m, "MsgPrinter")
+        .def_static("setMinType", &PROJECT_NAMESPACE::MsgPrinter::setMinType)
+        .def_static("minType", &PROJECT_NAMESPACE::MsgPrinter::minType)
+        .def_static("screenOn", &PROJECT_NAMESPACE::MsgPrinter::screenOn)
+        .def_static("screenOff", &PROJECT_NAMESPACE::MsgPrinter::screenOff)
+        .def_static("openLogFile", &PROJECT_NAMESPACE::MsgPrinter::openLogFile)
+        .def_static("closeLogFile", &PROJECT_NAMESPACE::MsgPrinter::closeLogFile)
+        .def_static("startAsync", &PROJECT_NAMESPACE::MsgPrinter::startAsync, py::arg("ringCapacity") = 1024)
+        .def_static("stopAsync", &PROJECT_NAMESPACE::MsgPrinter::stopAsync, py::call_guard<py::gil_scoped_release>())
+        .def_static("isAsync", &PROJECT_NAMESPACE::MsgPrinter::isAsync)
+        .def_static("flush", &PROJECT_NAMESPACE::MsgPrinter::flush, py::call_guard<py::gil_scoped_release>());
+
+    py::class_<TraceScope>(m, "TraceScope")
+        .def(py::init([](const std::string &name, const std::string &category) { return TraceScope{name, category}; }), py::arg("name"), py::arg("category") = "flow")
+        .def("__enter__", [](TraceScope &scope) { scope.start = PROJECT_NAMESPACE::Tracer::enabled() ? PROJECT_NAMESPACE::Tracer::now() : -1; return &scope; }, py::return_value_policy::reference)
+        .def("__exit__", [](TraceScope &scope, py::args)
+                {
+                    if (scope.start >= 0)
+                    {
+                        PROJECT_NAMESPACE::Tracer::addEvent(scope.name, scope.category, scope.start, PROJECT_NAMESPACE::Tracer::now() - scope.start);
+                    }
+                    return false;
+                });
 }
@@ -6,13 +6,38 @@
  */
 
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 #include "global/global.h"
 #include "writer/GdsWriter.h"
+#include "writer/GdsBatchWriter.h"
+#include "writer/GdsStreamWriter.h"
+#include "writer/OasisWriter.h"
 
 namespace py = pybind11;
 
 
 void initWriterAPI(py::module &m)
 {
-    m.def("writeGdsLayout", &PROJECT_NAMESPACE::WRITER::writeGdsLayout, "write the layout for circuit to GDSII");
+    m.def("writeGdsLayout", &PROJECT_NAMESPACE::WRITER::writeGdsLayout, "write the layout for circuit to GDSII. A file name ending with .gz is gzip compressed. Returns whether successful",
+            py::arg("cktIdx"), py::arg("filename"), py::arg("designDB"), py::arg("techDB"), py::arg("hierarchical") = false,
+            py::arg("compressionLevel") = PROJECT_NAMESPACE::MfGzip::DEFAULT_LEVEL);
+    m.def("writeGdsLayoutStreaming", &PROJECT_NAMESPACE::WRITER::writeGdsLayoutStreaming, py::call_guard<py::gil_scoped_release>(),
+            "write the layout for circuit to GDSII by streaming records directly from the layout. A file name ending with .gz is gzip compressed",
+            py::arg("cktIdx"), py::arg("filename"), py::arg("designDB"), py::arg("techDB"), py::arg("hierarchical") = false,
+            py::arg("compressionLevel") = PROJECT_NAMESPACE::MfGzip::DEFAULT_LEVEL);
+    m.def("writeGdsLayouts", &PROJECT_NAMESPACE::WRITER::writeGdsLayouts, py::call_guard<py::gil_scoped_release>(),
+            "write the layout of each circuit into its own GDSII file, encoded in parallel while the encoded files are being written. Returns the number of files written",
+            py::arg("cktIdxs"), py::arg("filenames"), py::arg("designDB"), py::arg("techDB"), py::arg("hierarchical") = false,
+            py::arg("compressionLevel") = PROJECT_NAMESPACE::MfGzip::DEFAULT_LEVEL);
+    m.def("writeMergedGdsLibrary", &PROJECT_NAMESPACE::WRITER::writeMergedGdsLibrary, py::call_guard<py::gil_scoped_release>(),
+            "write one GDSII library with every distinct cell of the circuits, encoded in parallel",
+            py::arg("cktIdxs"), py::arg("filename"), py::arg("designDB"), py::arg("techDB"), py::arg("hierarchical") = true,
+            py::arg("compressionLevel") = PROJECT_NAMESPACE::MfGzip::DEFAULT_LEVEL);
+    m.def("writeOasisLayout", &PROJECT_NAMESPACE::WRITER::writeOasisLayout, py::call_guard<py::gil_scoped_release>(),
+            "write the layout for circuit to OASIS, the regular arrays of identical rectangles as repetitions and the cells as CBLOCKs",
+            py::arg("cktIdx"), py::arg("filename"), py::arg("designDB"), py::arg("techDB"), py::arg("hierarchical") = false,
+            py::arg("compressionLevel") = PROJECT_NAMESPACE::MfGzip::DEFAULT_LEVEL);
+    m.def("writeLayoutFile", &PROJECT_NAMESPACE::WRITER::writeLayoutFile, py::call_guard<py::gil_scoped_release>(),
+            "write the layout for circuit in the format of the file extension: OASIS for .oas, else GDSII",
+            py::arg("cktIdx"), py::arg("filename"), py::arg("designDB"), py::arg("techDB"), py::arg("hierarchical") = false);
 }
@@ -5,144 +5,272 @@
  * @date 03/30/2020
  */
 
+#include <algorithm>
 #include <queue>
 #include <set>
 
 #include "CSFlow.h"
+#include "util/Tracer.h"
 
 PROJECT_NAMESPACE_BEGIN
 
+std::vector<std::string> CSFlowResult::currentPinPath(const IndexType i) const {
+  AssertMsg(_db != nullptr and _ckt != nullptr, "CSFlowResult: the names of a default constructed result are unknown \n");
+  std::vector<std::string> names;
+  names.reserve(pathLength(i));
+  for (IndexType k = _pathStart.at(i); k < _pathStart.at(i + 1); ++k)
+    names.emplace_back(_db->subCkt(ckt().node(_nodes[k]).subgraphIdx()).net(_intNets[k]).name());
+  return names;
+}
+
+std::vector<std::string> CSFlowResult::currentCellPath(const IndexType i) const {
+  AssertMsg(_db != nullptr and _ckt != nullptr, "CSFlowResult: the names of a default constructed result are unknown \n");
+  std::vector<std::string> names;
+  names.reserve(pathLength(i));
+  for (IndexType k = _pathStart.at(i); k < _pathStart.at(i + 1); ++k)
+    names.emplace_back(ckt().node(_nodes[k]).name());
+  return names;
+}
+
+std::vector<std::vector<std::string>> CSFlowResult::currentPinPaths() const {
+  std::vector<std::vector<std::string>> paths;
+  paths.reserve(numCurrentPaths());
+  for (IndexType i = 0; i < numCurrentPaths(); ++i)
+    paths.emplace_back(currentPinPath(i));
+  return paths;
+}
+
+std::vector<std::vector<std::string>> CSFlowResult::currentCellPaths() const {
+  std::vector<std::vector<std::string>> paths;
+  paths.reserve(numCurrentPaths());
+  for (IndexType i = 0; i < numCurrentPaths(); ++i)
+    paths.emplace_back(currentCellPath(i));
+  return paths;
+}
+
 void CSFlow::computeCurrentFlow(CktGraph& ckt) {
-  for (IndexType i = 0; i < ckt.numPins(); ++i) {
-    Pin& pin1 = ckt.pin(i);
-    Net& net1 = ckt.net(pin1.netIdx());
-    CktNode& node1 = ckt.node(pin1.nodeIdx());
-
-    ImplType implType1 = getCktNodeImplType(node1);
-    
-    if (implType1 == ImplType::PCELL_Pch
-        and i == node1.pinIdx(2)
-        and net1.isVdd()) {
-      for (IndexType j = 0; j < ckt.numPins(); ++j) {
-        Pin& pin2 = ckt.pin(j);
-        Net& net2 = ckt.net(pin2.netIdx());
-        CktNode& node2 = ckt.node(pin2.nodeIdx());
-        ImplType implType2 = getCktNodeImplType(node2);
-        if (implType2 == ImplType::PCELL_Nch
-            and j == node2.pinIdx(2)
-            and net2.isVss()) {
-          std::vector<std::string> pinNames;
-          std::vector<std::string> cellNames;
-          std::vector<unsigned char> visited(ckt.numPins(), 0);
-          currentDFS(ckt, i, j, visited, pinNames, cellNames);
-        }
-      }
-    }
-  }
-  //for (auto& vec : _currentCellPaths) {
-    //for (auto pinIdx : vec) {
-      //std::cerr << pinIdx << " ";
-    //}
-    //std::cerr << std::endl;
-  //}
+  _result = CSFlowResult(_db, ckt, INDEX_TYPE_MAX);
+  enumerateCurrentPaths(ckt, _result);
 }
 
-void CSFlow::currentDFS(CktGraph& ckt, const IndexType sPinIdx, const IndexType tPinIdx, std::vector<unsigned char>& visited, std::vector<std::string>& pinNames, std::vector<std::string>& cellNames) {
-  Pin& pin = ckt.pin(sPinIdx);
-  Net& net = ckt.net(pin.netIdx());
-  CktNode& node = ckt.node(pin.nodeIdx());
+CSFlowResult CSFlow::currentFlow(const IndexType cktIdx) const {
+  const DesignDB& db = _db;
+  CSFlowResult result(db, db.subCkt(cktIdx), cktIdx);
+  ScopedTimer timer("currentFlow ", db.subCkt(cktIdx).name(), "csflow");
+  enumerateCurrentPaths(db.subCkt(cktIdx), result);
+  Tracer::count("current paths enumerated", result.numCurrentPaths());
+  return result;
+}
 
-  const auto &pinName = _db.subCkt(node.subgraphIdx()).net(pin.intNetIdx()).name();
-  
-  visited[sPinIdx] = 1;
-  pinNames.emplace_back(pinName);
-  cellNames.emplace_back(node.name());
-
-  if (sPinIdx == tPinIdx) {
-    _currentPinPaths.emplace_back(pinNames);
-    _currentCellPaths.emplace_back(cellNames);
-    visited[sPinIdx] = 0;
-    pinNames.pop_back();
-    cellNames.pop_back();
-    return;
+std::vector<CSFlowResult> CSFlow::computeAllCurrentFlows() const {
+  const DesignDB& db = _db;
+  std::vector<IndexType> cktIndices;
+  for (IndexType cktIdx = 0; cktIdx < db.numCkts(); ++cktIdx) {
+    if (db.subCkt(cktIdx).implType() == ImplType::UNSET)
+      cktIndices.emplace_back(cktIdx);
   }
+  std::vector<CSFlowResult> results(cktIndices.size());
+  // The circuits are independent and the DesignDB is only read
+  #pragma omp parallel for schedule(dynamic)
+  for (IndexType i = 0; i < cktIndices.size(); ++i)
+    results[i] = currentFlow(cktIndices[i]);
+  return results;
+}
 
+void CSFlow::enumerateCurrentPaths(const CktGraph& ckt, CSFlowResult& result) const {
+  CSFlowGraph graph;
+  graph.build(_db, ckt);
 
-  std::vector<IndexType> adjPins;
- 
-  ImplType implType = getCktNodeImplType(node);
+  std::vector<IndexType> sources, sinks;
+  for (IndexType i = 0; i < graph.numPins(); ++i) {
+    if (graph.isCurrentSource(i))
+      sources.emplace_back(i);
+    else if (graph.isCurrentSink(i))
+      sinks.emplace_back(i);
+  }
 
-  switch (implType) {
-    case ImplType::PCELL_Pch:
-    {
-        
-      // source -> drain
-      if (sPinIdx == node.pinIdx(2)) {
-        if (!visited[node.pinIdx(0)])
-          adjPins.emplace_back(node.pinIdx(0));
-      }
-      // drain -> other
-      else if (sPinIdx == node.pinIdx(0)) {
-        for (IndexType pinIdx : net.pinIdxArray()) {
-          if (!visited[pinIdx]) {
-            CktNode& adjNode = ckt.node(ckt.pin(pinIdx).nodeIdx());
-            ImplType adjNodeImpl = getCktNodeImplType(adjNode);
-            if ((adjNodeImpl == ImplType::PCELL_Pch and pinIdx == adjNode.pinIdx(2))
-                or (adjNodeImpl == ImplType::PCELL_Nch and pinIdx == adjNode.pinIdx(0)))
-              adjPins.emplace_back(pinIdx);
-          }
-        }  
-      }
-      // gate or body
-      else {
+  // reach[k][p]: whether sink k can be reached from pin p. One backward traversal per sink serves all the sources,
+  // and the DFS never descends into a subgraph without a path to the sink
+  std::vector<std::vector<unsigned char>> reach(sinks.size());
+  for (IndexType k = 0; k < sinks.size(); ++k)
+    graph.markReaching(sinks[k], reach[k]);
+
+  IndexType numPaths = 0;
+  for (IndexType i : sources) {
+    for (IndexType k = 0; k < sinks.size(); ++k) {
+      if (!reach[k][i])
+        continue;
+      numPaths += currentDFS(graph, i, sinks[k], reach[k], _maxCurrentPaths - numPaths, result);
+      if (numPaths >= _maxCurrentPaths) {
+        result.setTruncated(true);
+        WRN("CSFlow: stop enumerating the current paths of %s at the limit of %u \n", ckt.name().c_str(), _maxCurrentPaths);
+        return;
       }
-      break;
     }
-    case ImplType::PCELL_Nch:
-    {
-      // drain -> source
-      if (sPinIdx == node.pinIdx(0)) {
-        if (!visited[node.pinIdx(2)])
-          adjPins.emplace_back(node.pinIdx(2));
-      }
-      // source -> other
-      else if (sPinIdx == node.pinIdx(2)) {
-        for (IndexType pinIdx : net.pinIdxArray()) {
-          if (!net.isVss() and !visited[pinIdx]) {
-            CktNode& adjNode = ckt.node(ckt.pin(pinIdx).nodeIdx());
-            ImplType adjNodeImpl = getCktNodeImplType(adjNode);
-            if (adjNodeImpl == ImplType::PCELL_Nch and pinIdx == adjNode.pinIdx(0))
-              adjPins.emplace_back(pinIdx);
-          }
-        }
+  }
+}
+
+IndexType CSFlow::currentDFS(const CSFlowGraph& graph, const IndexType sPinIdx, const IndexType tPinIdx, const std::vector<unsigned char>& reach,
+                             const IndexType maxPaths, CSFlowResult& result) const {
+  // Iterative DFS. stack[d] is the d-th pin on the path and cursor[d] the next edge of it to try
+  std::vector<IndexType> stack, cursor;
+  std::vector<IndexType> nodes, intNets;
+  std::vector<unsigned char> visited(graph.numPins(), 0);
+  IndexType numPaths = 0;
+  stack.emplace_back(sPinIdx);
+  cursor.emplace_back(0);
+  visited[sPinIdx] = 1;
+  while (!stack.empty()) {
+    const IndexType pinIdx = stack.back();
+    if (pinIdx == tPinIdx) {
+      nodes.clear();
+      intNets.clear();
+      for (IndexType p : stack) {
+        nodes.emplace_back(graph.nodeIdx(p));
+        intNets.emplace_back(graph.intNetIdx(p));
       }
-      // gate or body
-      else {
+      result.addCurrentPath(nodes, intNets);
+      if (++numPaths >= maxPaths)
+        return numPaths;
+    }
+    else {
+      const IndexType* adj = graph.adjBegin(pinIdx);
+      const IndexType numAdj = graph.adjEnd(pinIdx) - adj;
+      IndexType& next = cursor.back();
+      while (next < numAdj and (visited[adj[next]] or !reach[adj[next]]))
+        ++next;
+      if (next < numAdj) {
+        const IndexType adjPinIdx = adj[next++];
+        visited[adjPinIdx] = 1;
+        stack.emplace_back(adjPinIdx);
+        cursor.emplace_back(0);
+        continue;
       }
-      break;
     }
-    default:
-      break;
+    visited[pinIdx] = 0;
+    stack.pop_back();
+    cursor.pop_back();
   }
+  return numPaths;
+}
 
+void CSFlow::computeSignalFlow(CktGraph& ckt) {
+  _signalResult = SignalFlowResult();
+  enumerateSignalPaths(ckt, _signalResult);
+}
 
-  for (IndexType pinIdx : adjPins) {
-    assert(!visited[pinIdx]);
-    currentDFS(ckt, pinIdx, tPinIdx, visited, pinNames, cellNames);
+SignalFlowResult CSFlow::signalFlow(const IndexType cktIdx) {
+  AssertMsg(cktIdx < _db.numCkts(), "CSFlow::signalFlow: circuit %u out of range \n", cktIdx);
+  std::lock_guard<std::mutex> lock(_signalCacheMutex);
+  if (_signalCache.size() < _db.numCkts())
+    _signalCache.resize(_db.numCkts());
+  const CktGraph& ckt = _db.subCkt(cktIdx);
+  SignalFlowCache& cache = _signalCache[cktIdx];
+  const std::size_t signature = signalFlowSignature(ckt);
+  if (!cache.valid or cache.signature != signature) {
+    cache.result = SignalFlowResult(cktIdx);
+    ScopedTimer timer("signalFlow ", ckt.name(), "csflow");
+    enumerateSignalPaths(ckt, cache.result);
+    Tracer::count("signal paths enumerated", cache.result.numSignalPaths());
+    cache.signature = signature;
+    cache.valid = true;
   }
+  return cache.result;
+}
 
-  visited[sPinIdx] = 0;
-  pinNames.pop_back();
-  cellNames.pop_back();
+void CSFlow::invalidateSignalFlow(const IndexType cktIdx) {
+  std::lock_guard<std::mutex> lock(_signalCacheMutex);
+  if (cktIdx < _signalCache.size())
+    _signalCache[cktIdx].valid = false;
 }
 
-void CSFlow::computeSignalFlow(CktGraph& ckt) {
-  
+std::size_t CSFlow::signalFlowSignature(const CktGraph& ckt) const {
+  std::size_t h = 0;
+  auto combine = [&h](const std::size_t v) { h ^= v + static_cast<std::size_t>(0x9e3779b9) + (h << 6) + (h >> 2); };
+  combine(_maxSignalDepth);
+  combine(_maxSignalFanout);
+  combine(_maxSignalPaths);
+  combine(ckt.numNodes());
+  combine(ckt.numPins());
+  combine(ckt.numNets());
+  for (IndexType nodeIdx = 0; nodeIdx < ckt.numNodes(); ++nodeIdx) {
+    const CktNode& node = ckt.node(nodeIdx);
+    combine(node.isLeaf() ? INDEX_TYPE_MAX : static_cast<std::size_t>(_db.subCkt(node.subgraphIdx()).implType()));
+    combine(node.numPins());
+    for (IndexType i = 0; i < node.numPins(); ++i)
+      combine(node.pinIdx(i));
+  }
+  for (IndexType pinIdx = 0; pinIdx < ckt.numPins(); ++pinIdx)
+    combine(ckt.pin(pinIdx).nodeIdx());
+  // The order of the pins of a net decides which gates are within the fan-out bound
+  for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx) {
+    const Net& net = ckt.net(netIdx);
+    combine((net.isIo() ? 4 : 0) | (net.isVdd() ? 2 : 0) | (net.isVss() ? 1 : 0));
+    combine(net.numPins());
+    for (IndexType pinIdx : net.pinIdxArray())
+      combine(pinIdx);
+  }
+  return h;
 }
 
-ImplType CSFlow::getCktNodeImplType(const CktNode& node) {
-  const CktGraph& nodeSubGraph = _db.subCkt(node.subgraphIdx());
-  return nodeSubGraph.implType();
+void CSFlow::enumerateSignalPaths(const CktGraph& ckt, SignalFlowResult& result) const {
+  result.clear();
+  if (_maxSignalDepth == 0)
+    return;
+  CSFlowGraph graph;
+  graph.build(_db, ckt);
+
+  // Iterative DFS from each input gate. stack alternates gate and drain pins, cursor[d] is the next edge of stack[d] to try
+  // and extended[d] whether the path has been extended beyond stack[d]
+  std::vector<unsigned char> visited(graph.numPins(), 0);
+  std::vector<IndexType> stack, cursor;
+  std::vector<unsigned char> extended;
+  IndexType numPaths = 0;
+  for (IndexType sPinIdx = 0; sPinIdx < graph.numPins(); ++sPinIdx) {
+    if (!graph.isSignalInput(sPinIdx))
+      continue;
+    stack.assign(1, sPinIdx);
+    cursor.assign(1, 0);
+    extended.assign(1, 0);
+    visited[sPinIdx] = 1;
+    while (!stack.empty()) {
+      const IndexType pinIdx = stack.back();
+      const IndexType* adj = graph.signalAdjBegin(pinIdx);
+      IndexType numAdj = graph.signalAdjEnd(pinIdx) - adj;
+      const bool atDrain = stack.size() % 2 == 0;
+      if (atDrain) {
+        if (graph.isSignalOutput(pinIdx) or stack.size() / 2 >= _maxSignalDepth)
+          numAdj = 0;
+        numAdj = std::min(numAdj, _maxSignalFanout);
+      }
+      IndexType& next = cursor.back();
+      while (next < numAdj and visited[adj[next]])
+        ++next;
+      if (next < numAdj) {
+        const IndexType adjPinIdx = adj[next++];
+        extended.back() = 1;
+        visited[adjPinIdx] = 1;
+        stack.emplace_back(adjPinIdx);
+        cursor.emplace_back(0);
+        extended.emplace_back(0);
+        continue;
+      }
+      // A maximal path ends at a drain
+      if (atDrain and !extended.back()) {
+        if (numPaths >= _maxSignalPaths) {
+          result.setTruncated(true);
+          WRN("CSFlow: stop enumerating the signal paths of %s at the limit of %u \n", ckt.name().c_str(), _maxSignalPaths);
+          return;
+        }
+        result.addSignalPath(stack);
+        ++numPaths;
+      }
+      visited[pinIdx] = 0;
+      stack.pop_back();
+      cursor.pop_back();
+      extended.pop_back();
+    }
+  }
 }
 
 PROJECT_NAMESPACE_END
@@ -8,36 +8,189 @@
 #ifndef _CSFLOW_H_
 #define _CSFLOW_H_
 
+#include <mutex>
 #include "db/DesignDB.h"
+#include "CSFlowGraph.h"
 
 PROJECT_NAMESPACE_BEGIN
 
+/// @class MAGICAL_FLOW::CSFlowResult
+/// @brief The current paths of one circuit.
+/// The paths are stored as flat index arrays: pin j of path i is at position k in [pathStartArray()[i], pathStartArray()[i + 1]),
+/// belonging to node nodeArray()[k] of the circuit and connected to the internal net intNetArray()[k] of the node's sub circuit.
+/// The names are resolved from the DesignDB on request
+class CSFlowResult {
+ public:
+  CSFlowResult() = default;
+  CSFlowResult(const DesignDB& db, const CktGraph& ckt, const IndexType cktIdx) : _db(&db), _ckt(&ckt), _cktIdx(cktIdx) {}
+
+  /* Get */
+  IndexType                                     cktIdx()                            const { return _cktIdx; }
+  IndexType                                     numCurrentPaths()                   const { return _pathStart.size() - 1; }
+  /// @brief the number of pins on a path
+  IndexType                                     pathLength(const IndexType i)       const { return _pathStart.at(i + 1) - _pathStart.at(i); }
+  const std::vector<IndexType>&                 nodeArray()                         const { return _nodes; }
+  const std::vector<IndexType>&                 intNetArray()                       const { return _intNets; }
+  const std::vector<IndexType>&                 pathStartArray()                    const { return _pathStart; }
+  /// @brief whether the enumeration stopped at CSFlow::maxCurrentPaths
+  bool                                          truncated()                         const { return _truncated; }
+
+  /* Names */
+  /// @brief the internal net names of the pins on a path
+  std::vector<std::string>                      currentPinPath(const IndexType i)   const;
+  /// @brief the node names of the pins on a path
+  std::vector<std::string>                      currentCellPath(const IndexType i)  const;
+  std::vector<std::vector<std::string>>         currentPinPaths()                   const;
+  std::vector<std::vector<std::string>>         currentCellPaths()                  const;
+
+  /* Set */
+  void                                          clear()                                   { _nodes.clear(); _intNets.clear(); _pathStart.assign(1, 0); _truncated = false; }
+  void                                          addCurrentPath(const std::vector<IndexType>& nodes, const std::vector<IndexType>& intNets) {
+    Assert(nodes.size() == intNets.size());
+    _nodes.insert(_nodes.end(), nodes.begin(), nodes.end());
+    _intNets.insert(_intNets.end(), intNets.begin(), intNets.end());
+    _pathStart.emplace_back(_nodes.size());
+  }
+  void                                          setTruncated(const bool truncated)        { _truncated = truncated; }
+
+ private:
+  const DesignDB* _db = nullptr;
+  const CktGraph* _ckt = nullptr; // only used if _cktIdx is unset, since allocating circuits moves them
+
+  const CktGraph& ckt() const { return _cktIdx != INDEX_TYPE_MAX ? _db->subCkt(_cktIdx) : *_ckt; }
+
+  IndexType _cktIdx = INDEX_TYPE_MAX;
+  std::vector<IndexType> _nodes;
+  std::vector<IndexType> _intNets;
+  std::vector<IndexType> _pathStart = std::vector<IndexType>(1, 0);
+  bool _truncated = false;
+};
+
+/// @class MAGICAL_FLOW::SignalFlowResult
+/// @brief The signal paths of one circuit, as pin indices of the CktGraph in compressed form.
+/// A path steps through transistors from gate to drain: gate0, drain0, gate1, drain1, ...
+class SignalFlowResult {
+ public:
+  /// @brief the role of a pin on a signal path
+  enum class StepType : unsigned char { GATE, DRAIN };
+
+  SignalFlowResult() = default;
+  explicit SignalFlowResult(const IndexType cktIdx) : _cktIdx(cktIdx) {}
+
+  /* Get */
+  IndexType                     cktIdx()                              const { return _cktIdx; }
+  IndexType                     numSignalPaths()                      const { return _pathStart.size() - 1; }
+  /// @brief the number of pins on a path
+  IndexType                     pathLength(const IndexType i)         const { return _pathStart.at(i + 1) - _pathStart.at(i); }
+  /// @brief the pins of path i are [pathBegin(i), pathEnd(i))
+  const IndexType*              pathBegin(const IndexType i)          const { return _pins.data() + _pathStart.at(i); }
+  const IndexType*              pathEnd(const IndexType i)            const { return _pins.data() + _pathStart.at(i + 1); }
+  /// @brief a copy of the pin indices of a path
+  std::vector<IndexType>        signalPath(const IndexType i)         const { return std::vector<IndexType>(pathBegin(i), pathEnd(i)); }
+  /// @brief the role of the j-th pin on a path
+  static StepType               stepType(const IndexType j)                 { return j % 2 == 0 ? StepType::GATE : StepType::DRAIN; }
+  /// @brief the pins of all the paths, path i in [pathStartArray()[i], pathStartArray()[i + 1])
+  const std::vector<IndexType>& pinArray()                            const { return _pins; }
+  const std::vector<IndexType>& pathStartArray()                      const { return _pathStart; }
+  /// @brief whether the enumeration stopped at CSFlow::maxSignalPaths
+  bool                          truncated()                           const { return _truncated; }
+
+  /* Set */
+  void                          clear()                                     { _pins.clear(); _pathStart.assign(1, 0); _truncated = false; }
+  void                          addSignalPath(const std::vector<IndexType>& pins) {
+    _pins.insert(_pins.end(), pins.begin(), pins.end());
+    _pathStart.emplace_back(_pins.size());
+  }
+  void                          setTruncated(const bool truncated)          { _truncated = truncated; }
+
+ private:
+  IndexType _cktIdx = INDEX_TYPE_MAX;
+  std::vector<IndexType> _pins;
+  std::vector<IndexType> _pathStart = std::vector<IndexType>(1, 0);
+  bool _truncated = false;
+};
+
 class CSFlow {
  public:
   CSFlow(DesignDB& db) : _db(db) {}
   ~CSFlow() {}
 
+  /// @brief enumerate the current paths from the PMOS sources on VDD to the NMOS sources on VSS.
+  /// The paths are ordered by (source pin, sink pin, DFS order). The result replaces the one of the previous call
   void computeCurrentFlow(CktGraph& ckt);
+  /// @brief enumerate the signal paths starting from the transistor gates on the IO nets.
+  /// A path follows gate -> drain inside a transistor and drain -> gate along a non-power net,
+  /// and stops at a drain on an IO net, at maxSignalDepth transistors or when it cannot be extended.
+  /// At most maxSignalFanout gates are followed from one drain. The result replaces the one of the previous call
   void computeSignalFlow(CktGraph& ckt);
+  /// @brief the signal paths of a circuit, recomputed only if the circuit or the bounds have changed since the last call.
+  /// The calls may run concurrently, so that one CSFlow serves all the placers of a design
+  /// @param the index of the circuit in the DesignDB
+  /// @return a copy of the cached result
+  SignalFlowResult signalFlow(const IndexType cktIdx);
+  /// @brief force the recomputation of the signal paths of a circuit in the next signalFlow call
+  void invalidateSignalFlow(const IndexType cktIdx);
+  /// @brief enumerate the current paths of a circuit into an independent result. Only reads the DesignDB
+  /// @param the index of the circuit in the DesignDB
+  /// @return the current paths of the circuit
+  CSFlowResult currentFlow(const IndexType cktIdx) const;
+  /// @brief enumerate the current paths of all the ImplType::UNSET circuits of the DesignDB in parallel
+  /// @return one result per circuit, in the order of the circuit indices
+  std::vector<CSFlowResult> computeAllCurrentFlows() const;
+
+  /* Set */
+  /// @brief stop the enumeration after this number of current paths in one circuit. Unlimited by default
+  void                                          setMaxCurrentPaths(const IndexType n)     { _maxCurrentPaths = n; }
+  /// @brief the maximum number of transistors on one signal path. 8 by default
+  void                                          setMaxSignalDepth(const IndexType n)      { _maxSignalDepth = n; }
+  /// @brief the maximum number of gates followed from one drain. 8 by default
+  void                                          setMaxSignalFanout(const IndexType n)     { _maxSignalFanout = n; }
+  /// @brief stop the enumeration after this number of signal paths in one circuit. 10000 by default
+  void                                          setMaxSignalPaths(const IndexType n)      { _maxSignalPaths = n; }
 
   /* Get */
-  const IntType                                 numCurrentPaths()                   const { return _currentPinPaths.size(); }
-  const std::vector<std::string>&               currentPinPath(const IndexType i)   const { return _currentPinPaths.at(i); }
-  const std::vector<std::string>&               currentCellPath(const IndexType i)  const { return _currentCellPaths.at(i); }
-  const std::vector<std::vector<std::string>>&  currentPinPaths()                   const { return _currentPinPaths; }
-  const std::vector<std::vector<std::string>>&  currentCellPaths()                  const { return _currentCellPaths; }
+  const IntType                                 numCurrentPaths()                   const { return _result.numCurrentPaths(); }
+  std::vector<std::string>                      currentPinPath(const IndexType i)   const { return _result.currentPinPath(i); }
+  std::vector<std::string>                      currentCellPath(const IndexType i)  const { return _result.currentCellPath(i); }
+  std::vector<std::vector<std::string>>         currentPinPaths()                   const { return _result.currentPinPaths(); }
+  std::vector<std::vector<std::string>>         currentCellPaths()                  const { return _result.currentCellPaths(); }
+  /// @brief the result of the last computeCurrentFlow call
+  const CSFlowResult&                           currentFlowResult()                 const { return _result; }
+  IndexType                                     maxCurrentPaths()                   const { return _maxCurrentPaths; }
+  /// @brief the result of the last computeSignalFlow call
+  const SignalFlowResult&                       signalFlowResult()                  const { return _signalResult; }
+  IndexType                                     maxSignalDepth()                    const { return _maxSignalDepth; }
+  IndexType                                     maxSignalFanout()                   const { return _maxSignalFanout; }
+  IndexType                                     maxSignalPaths()                    const { return _maxSignalPaths; }
 
  private:
 
   DesignDB& _db;
 
-  std::vector<std::vector<std::string>> _currentPinPaths; // pin's net names
-  std::vector<std::vector<std::string>> _currentCellPaths; // cell names
+  CSFlowResult _result; // the result of the last computeCurrentFlow
+  IndexType _maxCurrentPaths = INDEX_TYPE_MAX;
 
-  
-  void currentDFS(CktGraph& ckt, const IndexType sPinIdx, const IndexType tPinIdx, std::vector<unsigned char>& visited, std::vector<std::string>& pinNames, std::vector<std::string>& cellNames);
+  SignalFlowResult _signalResult; // the result of the last computeSignalFlow
+  IndexType _maxSignalDepth = 8;
+  IndexType _maxSignalFanout = 8;
+  IndexType _maxSignalPaths = 10000;
+  /// @brief the signal paths of a circuit, with the signature of the circuit and bounds they were computed on
+  struct SignalFlowCache {
+    bool valid = false;
+    std::size_t signature = 0;
+    SignalFlowResult result;
+  };
+  std::vector<SignalFlowCache> _signalCache; // indexed by circuit
+  std::mutex _signalCacheMutex; // guards _signalCache
 
-  ImplType    getCktNodeImplType(const CktNode& node);
+  void enumerateCurrentPaths(const CktGraph& ckt, CSFlowResult& result) const;
+  /// @brief enumerate the simple paths from sPinIdx to tPinIdx, only stepping on the pins which can reach tPinIdx
+  /// @return the number of paths added
+  IndexType currentDFS(const CSFlowGraph& graph, const IndexType sPinIdx, const IndexType tPinIdx, const std::vector<unsigned char>& reach,
+                       const IndexType maxPaths, CSFlowResult& result) const;
+  void enumerateSignalPaths(const CktGraph& ckt, SignalFlowResult& result) const;
+  /// @brief a hash of everything the signal paths depend on: the connectivity, the net flags, the transistor types and the bounds
+  std::size_t signalFlowSignature(const CktGraph& ckt) const;
 
 }; 
 
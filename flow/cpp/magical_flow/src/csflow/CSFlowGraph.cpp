@@ -0,0 +1,147 @@
+/**
+ * @file CSFlowGraph.cpp
+ * @brief Compiled pin graph of a CktGraph for current flow enumeration
+ * @date 10/14/2026
+ */
+
+#include "CSFlowGraph.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+void CSFlowGraph::build(const DesignDB& db, const CktGraph& ckt) {
+  const IndexType numPins = ckt.numPins();
+  _implTypes.assign(numPins, ImplType::UNSET);
+  _roles.assign(numPins, Role::OTHER);
+  _nodeIndices.resize(numPins);
+  _intNetIndices.resize(numPins);
+
+  // Cache the implementation types, which are looked up through the sub circuits
+  std::vector<ImplType> nodeImplTypes(ckt.numNodes(), ImplType::UNSET);
+  for (IndexType nodeIdx = 0; nodeIdx < ckt.numNodes(); ++nodeIdx) {
+    const CktNode& node = ckt.node(nodeIdx);
+    if (!node.isLeaf())
+      nodeImplTypes[nodeIdx] = db.subCkt(node.subgraphIdx()).implType();
+  }
+  for (IndexType pinIdx = 0; pinIdx < numPins; ++pinIdx) {
+    const Pin& pin = ckt.pin(pinIdx);
+    const CktNode& node = ckt.node(pin.nodeIdx());
+    const ImplType implType = nodeImplTypes[pin.nodeIdx()];
+    _implTypes[pinIdx] = implType;
+    _nodeIndices[pinIdx] = pin.nodeIdx();
+    _intNetIndices[pinIdx] = pin.intNetIdx();
+    if (implType == ImplType::PCELL_Pch or implType == ImplType::PCELL_Nch) {
+      const Net& net = ckt.net(pin.netIdx());
+      if (implType == ImplType::PCELL_Pch and pinIdx == node.pinIdx(2) and net.isVdd())
+        _roles[pinIdx] = Role::SOURCE;
+      else if (implType == ImplType::PCELL_Nch and pinIdx == node.pinIdx(2) and net.isVss())
+        _roles[pinIdx] = Role::SINK;
+      else if (pinIdx == node.pinIdx(1) and net.isIo() and !net.isPower())
+        _roles[pinIdx] = Role::SIGNAL_INPUT;
+      else if (pinIdx == node.pinIdx(0) and net.isIo() and !net.isPower())
+        _roles[pinIdx] = Role::SIGNAL_OUTPUT;
+    }
+  }
+
+  // Edges
+  _adjStart.assign(numPins + 1, 0);
+  _adj.clear();
+  for (IndexType pinIdx = 0; pinIdx < numPins; ++pinIdx) {
+    const Pin& pin = ckt.pin(pinIdx);
+    const CktNode& node = ckt.node(pin.nodeIdx());
+    const Net& net = ckt.net(pin.netIdx());
+    switch (_implTypes[pinIdx]) {
+      case ImplType::PCELL_Pch:
+      {
+        // source -> drain
+        if (pinIdx == node.pinIdx(2)) {
+          _adj.emplace_back(node.pinIdx(0));
+        }
+        // drain -> other
+        else if (pinIdx == node.pinIdx(0)) {
+          for (IndexType adjPinIdx : net.pinIdxArray()) {
+            const CktNode& adjNode = ckt.node(ckt.pin(adjPinIdx).nodeIdx());
+            const ImplType adjNodeImpl = _implTypes[adjPinIdx];
+            if ((adjNodeImpl == ImplType::PCELL_Pch and adjPinIdx == adjNode.pinIdx(2))
+                or (adjNodeImpl == ImplType::PCELL_Nch and adjPinIdx == adjNode.pinIdx(0)))
+              _adj.emplace_back(adjPinIdx);
+          }
+        }
+        break;
+      }
+      case ImplType::PCELL_Nch:
+      {
+        // drain -> source
+        if (pinIdx == node.pinIdx(0)) {
+          _adj.emplace_back(node.pinIdx(2));
+        }
+        // source -> other
+        else if (pinIdx == node.pinIdx(2) and !net.isVss()) {
+          for (IndexType adjPinIdx : net.pinIdxArray()) {
+            const CktNode& adjNode = ckt.node(ckt.pin(adjPinIdx).nodeIdx());
+            if (_implTypes[adjPinIdx] == ImplType::PCELL_Nch and adjPinIdx == adjNode.pinIdx(0))
+              _adj.emplace_back(adjPinIdx);
+          }
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    _adjStart[pinIdx + 1] = _adj.size();
+  }
+
+  // Signal edges
+  _sigAdjStart.assign(numPins + 1, 0);
+  _sigAdj.clear();
+  for (IndexType pinIdx = 0; pinIdx < numPins; ++pinIdx) {
+    const ImplType implType = _implTypes[pinIdx];
+    if (implType == ImplType::PCELL_Pch or implType == ImplType::PCELL_Nch) {
+      const CktNode& node = ckt.node(ckt.pin(pinIdx).nodeIdx());
+      const Net& net = ckt.net(ckt.pin(pinIdx).netIdx());
+      // gate -> drain
+      if (pinIdx == node.pinIdx(1)) {
+        _sigAdj.emplace_back(node.pinIdx(0));
+      }
+      // drain -> the gates driven
+      else if (pinIdx == node.pinIdx(0) and !net.isPower()) {
+        for (IndexType adjPinIdx : net.pinIdxArray()) {
+          const ImplType adjNodeImpl = _implTypes[adjPinIdx];
+          if ((adjNodeImpl == ImplType::PCELL_Pch or adjNodeImpl == ImplType::PCELL_Nch)
+              and adjPinIdx == ckt.node(ckt.pin(adjPinIdx).nodeIdx()).pinIdx(1))
+            _sigAdj.emplace_back(adjPinIdx);
+        }
+      }
+    }
+    _sigAdjStart[pinIdx + 1] = _sigAdj.size();
+  }
+
+  // Reverse edges, by counting sort on the heads
+  _radjStart.assign(numPins + 1, 0);
+  for (IndexType head : _adj)
+    ++_radjStart[head + 1];
+  for (IndexType pinIdx = 0; pinIdx < numPins; ++pinIdx)
+    _radjStart[pinIdx + 1] += _radjStart[pinIdx];
+  _radj.resize(_adj.size());
+  std::vector<IndexType> fill(_radjStart.begin(), _radjStart.end() - 1);
+  for (IndexType pinIdx = 0; pinIdx < numPins; ++pinIdx)
+    for (const IndexType* it = adjBegin(pinIdx); it != adjEnd(pinIdx); ++it)
+      _radj[fill[*it]++] = pinIdx;
+}
+
+void CSFlowGraph::markReaching(const IndexType tPinIdx, std::vector<unsigned char>& reach) const {
+  reach.assign(numPins(), 0);
+  std::vector<IndexType> queue;
+  queue.emplace_back(tPinIdx);
+  reach[tPinIdx] = 1;
+  for (IndexType head = 0; head < queue.size(); ++head) {
+    const IndexType pinIdx = queue[head];
+    for (IndexType i = _radjStart[pinIdx]; i < _radjStart[pinIdx + 1]; ++i) {
+      if (!reach[_radj[i]]) {
+        reach[_radj[i]] = 1;
+        queue.emplace_back(_radj[i]);
+      }
+    }
+  }
+}
+
+PROJECT_NAMESPACE_END
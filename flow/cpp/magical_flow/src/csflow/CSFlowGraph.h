@@ -0,0 +1,76 @@
+/**
+ * @file CSFlowGraph.h
+ * @brief Compiled pin graph of a CktGraph for current flow enumeration
+ * @date 10/14/2026
+ */
+
+#ifndef _CSFLOW_GRAPH_H_
+#define _CSFLOW_GRAPH_H_
+
+#include "db/DesignDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::CSFlowGraph
+/// @brief The directed pin graph along which current may flow, in compressed sparse row form.
+/// Pin p has an edge to pin q if a current path can step from p to q:
+/// PMOS source -> drain, PMOS drain -> PMOS sources / NMOS drains on the same net,
+/// NMOS drain -> source, NMOS source -> NMOS drains on the same non-VSS net.
+/// The edges of a pin keep the order of Net::pinIdxArray, so that a DFS on the graph visits the paths in the same order as a DFS on the CktGraph.
+/// A second graph holds the signal edges: transistor gate -> drain of the same transistor, drain -> gates of the transistors on the same non-power net
+class CSFlowGraph {
+ public:
+  CSFlowGraph() = default;
+
+  /// @brief compile a circuit
+  /// @param first: the design database, for the implementation types of the sub circuits
+  /// @param second: the circuit
+  void build(const DesignDB& db, const CktGraph& ckt);
+
+  /* Get */
+  IndexType           numPins()                           const { return _implTypes.size(); }
+  IndexType           numEdges()                          const { return _adj.size(); }
+  /// @brief the implementation type of the node the pin belongs to
+  ImplType            implType(const IndexType pinIdx)    const { return _implTypes[pinIdx]; }
+  /// @brief whether the pin is the source of a PMOS on a VDD net, where current paths start
+  bool                isCurrentSource(const IndexType pinIdx) const { return _roles[pinIdx] == Role::SOURCE; }
+  /// @brief whether the pin is the source of an NMOS on a VSS net, where current paths end
+  bool                isCurrentSink(const IndexType pinIdx) const { return _roles[pinIdx] == Role::SINK; }
+  /// @brief whether the pin is the gate of a transistor on a non-power IO net, where signal paths start
+  bool                isSignalInput(const IndexType pinIdx) const { return _roles[pinIdx] == Role::SIGNAL_INPUT; }
+  /// @brief whether the pin is the drain of a transistor on a non-power IO net, where signal paths end
+  bool                isSignalOutput(const IndexType pinIdx) const { return _roles[pinIdx] == Role::SIGNAL_OUTPUT; }
+  /// @brief the edges of a pin are [adjBegin, adjEnd)
+  const IndexType*    adjBegin(const IndexType pinIdx)    const { return _adj.data() + _adjStart[pinIdx]; }
+  const IndexType*    adjEnd(const IndexType pinIdx)      const { return _adj.data() + _adjStart[pinIdx + 1]; }
+  /// @brief the signal edges of a pin are [signalAdjBegin, signalAdjEnd)
+  const IndexType*    signalAdjBegin(const IndexType pinIdx) const { return _sigAdj.data() + _sigAdjStart[pinIdx]; }
+  const IndexType*    signalAdjEnd(const IndexType pinIdx) const { return _sigAdj.data() + _sigAdjStart[pinIdx + 1]; }
+  /// @brief the node the pin belongs to
+  IndexType           nodeIdx(const IndexType pinIdx)     const { return _nodeIndices[pinIdx]; }
+  /// @brief the internal net of the pin in the sub circuit of its node
+  IndexType           intNetIdx(const IndexType pinIdx)   const { return _intNetIndices[pinIdx]; }
+
+  /// @brief mark the pins from which a target pin can be reached
+  /// @param first: the target pin
+  /// @param second: output reach[pin] = 1 if there is a path from pin to the target
+  void markReaching(const IndexType tPinIdx, std::vector<unsigned char>& reach) const;
+
+ private:
+  enum class Role : unsigned char { OTHER, SOURCE, SINK, SIGNAL_INPUT, SIGNAL_OUTPUT };
+
+  std::vector<IndexType>          _adjStart; // _adj[_adjStart[p], _adjStart[p + 1]) are the successors of p
+  std::vector<IndexType>          _adj;
+  std::vector<IndexType>          _radjStart; // the same for the predecessors
+  std::vector<IndexType>          _radj;
+  std::vector<IndexType>          _sigAdjStart; // the signal edges
+  std::vector<IndexType>          _sigAdj;
+  std::vector<ImplType>           _implTypes;
+  std::vector<Role>               _roles;
+  std::vector<IndexType>          _nodeIndices;
+  std::vector<IndexType>          _intNetIndices;
+};
+
+PROJECT_NAMESPACE_END
+
+#endif /// _CSFLOW_GRAPH_H_
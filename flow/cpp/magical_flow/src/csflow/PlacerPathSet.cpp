@@ -0,0 +1,172 @@
+/**
+ * @file PlacerPathSet.cpp
+ * @brief The signal and current paths of a circuit, compiled into the cell and pin indices of the placer
+ * @date 10/14/2026
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+
+#include "PlacerPathSet.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace {
+/// @brief the highest io layer of a net with a placer pin, as in Placer.placeParsePin
+constexpr IndexType MAX_PIN_LAYER = 10;
+}
+
+void PlacerPathSet::addConstraintPaths(const CktConstraint& con) {
+  for (IndexType i = 0; i < con.numSignalPaths(); ++i) {
+    RawPath path;
+    path.isPower = con.isSignalPathPower(i);
+    for (IndexType pos = 0; pos < con.signalPathLength(i); ++pos) {
+      path.nodes.emplace_back(con.signalPathNode(i, pos));
+      path.intNets.emplace_back(con.signalPathIntNet(i, pos));
+    }
+    _raw.emplace_back(std::move(path));
+  }
+}
+
+void PlacerPathSet::addSignalPaths(const SignalFlowResult& result) {
+  const CktGraph& ckt = _db.subCkt(_cktIdx);
+  for (IndexType i = 0; i < result.numSignalPaths(); ++i) {
+    RawPath path;
+    for (const IndexType* it = result.pathBegin(i); it != result.pathEnd(i); ++it) {
+      const Pin& pin = ckt.pin(*it);
+      path.nodes.emplace_back(pin.nodeIdx());
+      path.intNets.emplace_back(pin.intNetIdx());
+    }
+    _raw.emplace_back(std::move(path));
+  }
+}
+
+void PlacerPathSet::addCurrentPaths(const CSFlowResult& result) {
+  const auto& nodes = result.nodeArray();
+  const auto& intNets = result.intNetArray();
+  const auto& pathStart = result.pathStartArray();
+  for (IndexType i = 0; i < result.numCurrentPaths(); ++i) {
+    RawPath path;
+    path.isPower = true;
+    path.nodes.assign(nodes.begin() + pathStart[i], nodes.begin() + pathStart[i + 1]);
+    path.intNets.assign(intNets.begin() + pathStart[i], intNets.begin() + pathStart[i + 1]);
+    _raw.emplace_back(std::move(path));
+  }
+}
+
+RealType PlacerPathSet::pathStrength(const RawPath& path) const {
+  const CktGraph& ckt = _db.subCkt(_cktIdx);
+  const PhyPropDB& props = _db.phyPropDB();
+  RealType strength = REAL_TYPE_MAX;
+  for (IndexType nodeIdx : path.nodes) {
+    const CktNode& node = ckt.node(nodeIdx);
+    if (node.isLeaf())
+      continue;
+    const CktGraph& sub = _db.subCkt(node.subgraphIdx());
+    const MosProp* mos = nullptr;
+    if (sub.implType() == ImplType::PCELL_Nch && sub.implIdx() < props.numNch())
+      mos = &props.nch(sub.implIdx());
+    else if (sub.implType() == ImplType::PCELL_Pch && sub.implIdx() < props.numPch())
+      mos = &props.pch(sub.implIdx());
+    if (mos == nullptr or !mos->widthValid() or !mos->lengthValid() or mos->length() <= 0)
+      continue;
+    strength = std::min(strength, static_cast<RealType>(mos->width()) * std::max(mos->mult(), 1) / mos->length());
+  }
+  return strength == REAL_TYPE_MAX ? 0 : strength;
+}
+
+void PlacerPathSet::compile() {
+  const CktGraph& ckt = _db.subCkt(_cktIdx);
+  _cells.clear();
+  _pins.clear();
+  _intNets.clear();
+  _pathStart.assign(1, 0);
+  _categories.clear();
+  _pathWeights.clear();
+  _numRedundant = 0;
+  _numUnmapped = 0;
+
+  // The placer pin of each (node, internal net)
+  std::vector<IndexType> pinStart(1, 0), nodePins;
+  for (const auto& node : ckt.nodeArray()) {
+    if (!node.isLeaf()) {
+      const CktGraph& sub = _db.subCkt(node.subgraphIdx());
+      for (IndexType netIdx = 0; netIdx < sub.numNets(); ++netIdx)
+        nodePins.emplace_back(sub.net(netIdx).ioLayer() > MAX_PIN_LAYER ? INDEX_TYPE_MAX : 0);
+    }
+    pinStart.emplace_back(nodePins.size());
+  }
+  IndexType numPlacerPins = 0;
+  for (auto& pin : nodePins)
+    if (pin != INDEX_TYPE_MAX)
+      pin = numPlacerPins++;
+
+  // Convert the paths
+  std::vector<std::vector<IndexType>> pathPins(_raw.size()), pathPos(_raw.size()); // The placer pins kept and their positions on the paths
+  for (IndexType i = 0; i < _raw.size(); ++i) {
+    const RawPath& raw = _raw[i];
+    for (IndexType k = 0; k < raw.nodes.size(); ++k) {
+      const IndexType nodeIdx = raw.nodes[k];
+      if (nodeIdx >= ckt.numNodes() or raw.intNets[k] >= pinStart[nodeIdx + 1] - pinStart[nodeIdx]
+          or nodePins[pinStart[nodeIdx] + raw.intNets[k]] == INDEX_TYPE_MAX) {
+        ++_numUnmapped;
+        continue;
+      }
+      pathPins[i].emplace_back(nodePins[pinStart[nodeIdx] + raw.intNets[k]]);
+      pathPos[i].emplace_back(k);
+    }
+  }
+
+  // Longer paths first, so that the paths inside them are seen after them
+  std::vector<IndexType> order(_raw.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](IndexType a, IndexType b) { return pathPins[a].size() > pathPins[b].size(); });
+  std::set<std::vector<IndexType>> covered[2]; // The contiguous parts of the kept paths, of the signal and the power kinds
+  std::vector<char> keep(_raw.size(), 0);
+  for (IndexType i : order) {
+    const auto& pins = pathPins[i];
+    if (pins.size() < 2)
+      continue;
+    auto& parts = covered[_raw[i].isPower ? 1 : 0];
+    if (parts.count(pins)) {
+      ++_numRedundant;
+      continue;
+    }
+    keep[i] = 1;
+    for (IndexType first = 0; first + 1 < pins.size(); ++first)
+      for (IndexType last = first + 2; last <= pins.size(); ++last)
+        parts.emplace(pins.begin() + first, pins.begin() + last);
+  }
+
+  // Categories by the strength relative to the strongest current path
+  std::vector<RealType> strength(_raw.size(), 0);
+  RealType maxStrength = 0;
+  for (IndexType i = 0; i < _raw.size(); ++i) {
+    if (keep[i] and _raw[i].isPower) {
+      strength[i] = pathStrength(_raw[i]);
+      maxStrength = std::max(maxStrength, strength[i]);
+    }
+  }
+  for (IndexType i = 0; i < _raw.size(); ++i) {
+    if (!keep[i])
+      continue;
+    Category category = Category::SIGNAL;
+    if (_raw[i].isPower) {
+      // Without the sizes of the transistors, the current paths are all taken as high
+      const RealType ratio = maxStrength > 0 ? strength[i] / maxStrength : 1;
+      category = ratio >= _highRatio ? Category::HIGH_CURRENT : ratio >= _mediumRatio ? Category::MEDIUM_CURRENT : Category::LOW_CURRENT;
+    }
+    for (IndexType k = 0; k < pathPins[i].size(); ++k) {
+      _cells.emplace_back(_raw[i].nodes[pathPos[i][k]]);
+      _pins.emplace_back(pathPins[i][k]);
+      _intNets.emplace_back(_raw[i].intNets[pathPos[i][k]]);
+    }
+    _pathStart.emplace_back(_pins.size());
+    _categories.emplace_back(static_cast<IndexType>(category));
+    _pathWeights.emplace_back(categoryWeight(category));
+  }
+  _raw.clear();
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,104 @@
+/**
+ * @file PlacerPathSet.h
+ * @brief The signal and current paths of a circuit, compiled into the cell and pin indices of the placer
+ * @date 10/14/2026
+ */
+
+#ifndef _PLACER_PATH_SET_H_
+#define _PLACER_PATH_SET_H_
+
+#include "CSFlow.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::PlacerPathSet
+/// @brief The signal paths and the power current paths of one circuit, as the placer takes them.
+/// The paths are collected from the constraint store, the signal flow and the current flow as (node, internal net) pins, then compile():
+/// - maps every pin to the placer: the cell of node i is i, and the pins of a cell are the nets of its sub circuit with an io layer, in net order, as Placer.placeParsePin allocates them.
+///   The pins without a placer pin are dropped, and so are the paths left with fewer than two pins
+/// - drops the paths which repeat another path of the same kind, or lie inside a longer one as a contiguous part
+/// - weights each path by its category. The current paths are sorted by the strength of their weakest transistor, width times multiplier over length,
+///   relative to the strongest current path of the circuit, as an estimate of the current they carry
+/// The result is stored as flat arrays: pin k of path i is at position k in [pathStartArray()[i], pathStartArray()[i + 1])
+class PlacerPathSet {
+ public:
+  /// @brief the category of a path
+  enum class Category : unsigned char { SIGNAL, LOW_CURRENT, MEDIUM_CURRENT, HIGH_CURRENT };
+
+  /// @param first: the design database
+  /// @param second: the index of the circuit
+  PlacerPathSet(const DesignDB& db, const IndexType cktIdx) : _db(db), _cktIdx(cktIdx) {}
+
+  /* Input */
+  /// @brief add the signal paths of the constraint store, the power ones as current paths
+  void                          addConstraintPaths(const CktConstraint& con);
+  /// @brief add the signal paths of CSFlow::signalFlow
+  void                          addSignalPaths(const SignalFlowResult& result);
+  /// @brief add the current paths of CSFlow::currentFlow, as power paths
+  void                          addCurrentPaths(const CSFlowResult& result);
+  /// @brief convert, deduplicate and weight the added paths. The result replaces the one of the previous call
+  void                          compile();
+
+  /* Set */
+  /// @brief set the weight of a category. 1 for the signal paths and the low current paths, 2 for the medium and 4 for the high by default
+  void                          setCategoryWeight(const Category category, const IntType weight) { _weights[static_cast<IndexType>(category)] = weight; }
+  /// @brief set the strength a current path needs relative to the strongest one to be medium and high. 1/8 and 1/2 by default
+  void                          setCategoryRatios(const RealType medium, const RealType high)    { _mediumRatio = medium; _highRatio = high; }
+
+  /* Get */
+  IndexType                     cktIdx()                                const { return _cktIdx; }
+  IntType                       categoryWeight(const Category category) const { return _weights[static_cast<IndexType>(category)]; }
+  IndexType                     numPaths()                              const { return _pathStart.size() - 1; }
+  /// @brief the number of pins on a compiled path
+  IndexType                     pathLength(const IndexType i)           const { return _pathStart.at(i + 1) - _pathStart.at(i); }
+  bool                          isPower(const IndexType i)              const { return category(i) != Category::SIGNAL; }
+  Category                      category(const IndexType i)             const { return static_cast<Category>(_categories.at(i)); }
+  IntType                       weight(const IndexType i)               const { return _pathWeights.at(i); }
+  /// @brief the placer cells of the pins of all the paths
+  const std::vector<IndexType>& cellArray()                             const { return _cells; }
+  /// @brief the placer pins of the pins of all the paths
+  const std::vector<IndexType>& pinArray()                              const { return _pins; }
+  /// @brief the internal nets of the pins of all the paths in the sub circuits of their nodes, for naming the pins
+  const std::vector<IndexType>& intNetArray()                           const { return _intNets; }
+  const std::vector<IndexType>& pathStartArray()                        const { return _pathStart; }
+  /// @brief the Category of each path
+  const std::vector<IndexType>& categoryArray()                         const { return _categories; }
+  const std::vector<IntType>&   weightArray()                           const { return _pathWeights; }
+  /// @brief the number of paths added since the last compile
+  IndexType                     numAddedPaths()                         const { return _raw.size(); }
+  /// @brief the number of paths the last compile dropped as repeated or contained
+  IndexType                     numRedundantPaths()                     const { return _numRedundant; }
+  /// @brief the number of pins the last compile dropped for having no placer pin
+  IndexType                     numUnmappedPins()                       const { return _numUnmapped; }
+
+ private:
+  /// @brief an added path
+  struct RawPath {
+    std::vector<IndexType> nodes;
+    std::vector<IndexType> intNets;
+    bool isPower = false;
+  };
+  /// @brief the strength of the weakest transistor on a path. 0 if the path has no transistor
+  RealType                      pathStrength(const RawPath& path) const;
+
+  const DesignDB& _db;
+  IndexType _cktIdx = INDEX_TYPE_MAX;
+  std::vector<RawPath> _raw; // added since the last compile
+
+  IntType _weights[4] = {1, 1, 2, 4};
+  RealType _mediumRatio = 0.125;
+  RealType _highRatio = 0.5;
+
+  std::vector<IndexType> _cells;
+  std::vector<IndexType> _pins;
+  std::vector<IndexType> _intNets;
+  std::vector<IndexType> _pathStart = std::vector<IndexType>(1, 0);
+  std::vector<IndexType> _categories;
+  std::vector<IntType> _pathWeights;
+  IndexType _numRedundant = 0;
+  IndexType _numUnmapped = 0;
+};
+
+PROJECT_NAMESPACE_END
+
+#endif /// _PLACER_PATH_SET_H_
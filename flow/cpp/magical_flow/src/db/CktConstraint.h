@@ -0,0 +1,149 @@
+/**
+ * @file CktConstraint.h
+ * @brief The placement constraints of one circuit, exchanged between the constraint generation and the placer
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_CKT_CONSTRAINT_H_
+#define MAGICAL_FLOW_CKT_CONSTRAINT_H_
+
+#include <utility>
+#include "global/global.h"
+#include "util/HeapBytes.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::CktConstraint
+/// @brief The constraints of a CktGraph in terms of its indices: symmetric node pairs, self-symmetric nodes,
+/// symmetric net pairs, self-symmetric nets and signal paths.
+/// A signal path is a sequence of pins, each given by the node and the internal net of the node's sub circuit
+class CktConstraint
+{
+    public:
+        /// @brief default constructor
+        explicit CktConstraint() = default;
+        /*------------------------------*/
+        /* Symmetry                     */
+        /*------------------------------*/
+        /// @brief whether the symmetry constraints have been generated. An empty set of generated constraints is still generated
+        /// @return whether the symmetry constraints have been generated
+        bool isSymGenerated() const { return _symGenerated; }
+        /// @brief mark the symmetry constraints as generated
+        void markSymGenerated() { _symGenerated = true; }
+        /// @brief get the heap bytes of the constraints, beyond sizeof(CktConstraint)
+        std::size_t heapBytes() const
+        {
+            return HeapBytes::of(_symPairs) + HeapBytes::of(_selfSyms) + HeapBytes::of(_symNetPairs) + HeapBytes::of(_selfSymNets)
+                + HeapBytes::of(_pathNodes) + HeapBytes::of(_pathIntNets) + HeapBytes::of(_pathStart) + HeapBytes::of(_pathIsPower);
+        }
+        /// @brief remove all the symmetry constraints and the generated flag
+        void clearSym()
+        {
+            _symPairs.clear();
+            _selfSyms.clear();
+            _symNetPairs.clear();
+            _selfSymNets.clear();
+            _symGenerated = false;
+        }
+        /// @brief add a pair of symmetric nodes
+        /// @param first: a node
+        /// @param second: the other node
+        void addSymPair(IndexType nodeA, IndexType nodeB) { _symPairs.emplace_back(nodeA, nodeB); }
+        /// @brief get the number of symmetric node pairs
+        /// @return the number of symmetric node pairs
+        IndexType numSymPairs() const { return _symPairs.size(); }
+        /// @brief get a symmetric node pair
+        /// @param the index of the pair
+        /// @return the two nodes
+        const std::pair<IndexType, IndexType> & symPair(IndexType idx) const { return _symPairs.at(idx); }
+        /// @brief add a self-symmetric node
+        /// @param the node
+        void addSelfSym(IndexType nodeIdx) { _selfSyms.emplace_back(nodeIdx); }
+        /// @brief get the number of self-symmetric nodes
+        /// @return the number of self-symmetric nodes
+        IndexType numSelfSyms() const { return _selfSyms.size(); }
+        /// @brief get a self-symmetric node
+        /// @param the index in the self-symmetric nodes
+        /// @return the node
+        IndexType selfSym(IndexType idx) const { return _selfSyms.at(idx); }
+        /// @brief add a pair of symmetric nets
+        /// @param first: a net
+        /// @param second: the other net
+        void addSymNetPair(IndexType netA, IndexType netB) { _symNetPairs.emplace_back(netA, netB); }
+        /// @brief get the number of symmetric net pairs
+        /// @return the number of symmetric net pairs
+        IndexType numSymNetPairs() const { return _symNetPairs.size(); }
+        /// @brief get a symmetric net pair
+        /// @param the index of the pair
+        /// @return the two nets
+        const std::pair<IndexType, IndexType> & symNetPair(IndexType idx) const { return _symNetPairs.at(idx); }
+        /// @brief add a self-symmetric net
+        /// @param the net
+        void addSelfSymNet(IndexType netIdx) { _selfSymNets.emplace_back(netIdx); }
+        /// @brief get the number of self-symmetric nets
+        /// @return the number of self-symmetric nets
+        IndexType numSelfSymNets() const { return _selfSymNets.size(); }
+        /// @brief get a self-symmetric net
+        /// @param the index in the self-symmetric nets
+        /// @return the net
+        IndexType selfSymNet(IndexType idx) const { return _selfSymNets.at(idx); }
+        /*------------------------------*/
+        /* Signal paths                 */
+        /*------------------------------*/
+        /// @brief remove all the signal paths
+        void clearSignalPaths() { _pathNodes.clear(); _pathIntNets.clear(); _pathStart.assign(1, 0); _pathIsPower.clear(); }
+        /// @brief start a new signal path. The pins are added to the last path
+        /// @param whether the path is a power current path
+        /// @return the index of the path
+        IndexType allocateSignalPath(bool isPower)
+        {
+            _pathStart.emplace_back(_pathNodes.size());
+            _pathIsPower.emplace_back(isPower);
+            return _pathIsPower.size() - 1;
+        }
+        /// @brief append a pin to the last signal path
+        /// @param first: the node of the pin
+        /// @param second: the internal net of the pin in the sub circuit of the node
+        void addPinToSignalPath(IndexType nodeIdx, IndexType intNetIdx)
+        {
+            AssertMsg(!_pathIsPower.empty(), "CktConstraint::addPinToSignalPath: no signal path allocated \n");
+            _pathNodes.emplace_back(nodeIdx);
+            _pathIntNets.emplace_back(intNetIdx);
+            ++_pathStart.back();
+        }
+        /// @brief get the number of signal paths
+        /// @return the number of signal paths
+        IndexType numSignalPaths() const { return _pathIsPower.size(); }
+        /// @brief get whether a signal path is a power current path
+        /// @param the index of the path
+        /// @return whether the path is a power current path
+        bool isSignalPathPower(IndexType pathIdx) const { return _pathIsPower.at(pathIdx); }
+        /// @brief get the number of pins on a signal path
+        /// @param the index of the path
+        /// @return the number of pins
+        IndexType signalPathLength(IndexType pathIdx) const { return _pathStart.at(pathIdx + 1) - _pathStart.at(pathIdx); }
+        /// @brief get the node of a pin on a signal path
+        /// @param first: the index of the path
+        /// @param second: the position of the pin on the path
+        /// @return the node of the pin
+        IndexType signalPathNode(IndexType pathIdx, IndexType pos) const { Assert(pos < signalPathLength(pathIdx)); return _pathNodes[_pathStart[pathIdx] + pos]; }
+        /// @brief get the internal net of a pin on a signal path
+        /// @param first: the index of the path
+        /// @param second: the position of the pin on the path
+        /// @return the internal net of the pin in the sub circuit of its node
+        IndexType signalPathIntNet(IndexType pathIdx, IndexType pos) const { Assert(pos < signalPathLength(pathIdx)); return _pathIntNets[_pathStart[pathIdx] + pos]; }
+    private:
+        bool _symGenerated = false; ///< Whether the symmetry constraints have been generated
+        std::vector<std::pair<IndexType, IndexType>> _symPairs; ///< The symmetric node pairs
+        std::vector<IndexType> _selfSyms; ///< The self-symmetric nodes
+        std::vector<std::pair<IndexType, IndexType>> _symNetPairs; ///< The symmetric net pairs
+        std::vector<IndexType> _selfSymNets; ///< The self-symmetric nets
+        std::vector<IndexType> _pathNodes; ///< The nodes of the pins of all the signal paths
+        std::vector<IndexType> _pathIntNets; ///< The internal nets of the pins of all the signal paths
+        std::vector<IndexType> _pathStart = std::vector<IndexType>(1, 0); ///< Path i is [_pathStart[i], _pathStart[i + 1]) of the pin arrays
+        std::vector<bool> _pathIsPower; ///< Whether each signal path is a power current path
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_CKT_CONSTRAINT_H_
@@ -0,0 +1,159 @@
+/**
+ * @file CktContentHash.cpp
+ * @brief The content digests of the circuits, for reusing the layouts of the unchanged sub circuits across runs
+ * @date 10/14/2026
+ */
+
+#include "db/CktContentHash.h"
+#include <cstdio>
+#include <fstream>
+#include "db/DeviceLayoutCache.h"
+#include "util/Hash.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief fold the constraints of a circuit into a digest
+    void mixConstraint(std::uint64_t &digest, const CktConstraint &con)
+    {
+        MfHash::mix(digest, con.numSymPairs());
+        for (IndexType idx = 0; idx < con.numSymPairs(); ++idx)
+        {
+            MfHash::mix(digest, con.symPair(idx).first);
+            MfHash::mix(digest, con.symPair(idx).second);
+        }
+        MfHash::mix(digest, con.numSelfSyms());
+        for (IndexType idx = 0; idx < con.numSelfSyms(); ++idx)
+        {
+            MfHash::mix(digest, con.selfSym(idx));
+        }
+        MfHash::mix(digest, con.numSymNetPairs());
+        for (IndexType idx = 0; idx < con.numSymNetPairs(); ++idx)
+        {
+            MfHash::mix(digest, con.symNetPair(idx).first);
+            MfHash::mix(digest, con.symNetPair(idx).second);
+        }
+        MfHash::mix(digest, con.numSelfSymNets());
+        for (IndexType idx = 0; idx < con.numSelfSymNets(); ++idx)
+        {
+            MfHash::mix(digest, con.selfSymNet(idx));
+        }
+        MfHash::mix(digest, con.numSignalPaths());
+        for (IndexType pathIdx = 0; pathIdx < con.numSignalPaths(); ++pathIdx)
+        {
+            MfHash::mix(digest, con.isSignalPathPower(pathIdx));
+            MfHash::mix(digest, con.signalPathLength(pathIdx));
+            for (IndexType pos = 0; pos < con.signalPathLength(pathIdx); ++pos)
+            {
+                MfHash::mix(digest, con.signalPathNode(pathIdx, pos));
+                MfHash::mix(digest, con.signalPathIntNet(pathIdx, pos));
+            }
+        }
+    }
+}
+
+std::uint64_t CktContentHash::localHash(const DesignDB &designDB, IndexType cktIdx)
+{
+    const auto &ckt = designDB.subCkt(cktIdx);
+    std::uint64_t digest = MfHash::FNV_OFFSET;
+    MfHash::mix(digest, ckt.name());
+    MfHash::mix(digest, static_cast<std::uint64_t>(ckt.implType()));
+    if (MfUtil::isImplTypeDevice(ckt.implType()) && ckt.implIdx() != INDEX_TYPE_MAX)
+    {
+        MfHash::mix(digest, DeviceLayoutCache::deviceKey(designDB.phyPropDB(), ckt, false));
+    }
+    MfHash::mix(digest, ckt.numNodes());
+    for (const auto &node : ckt.nodeArray())
+    {
+        MfHash::mix(digest, node.name());
+        MfHash::mix(digest, node.refName());
+        MfHash::mix(digest, static_cast<std::uint64_t>(node.implType()));
+        MfHash::mix(digest, node.numPins());
+        for (IndexType pinIdx : node.pinIdxArray())
+        {
+            const auto &pin = ckt.pin(pinIdx);
+            MfHash::mix(digest, static_cast<std::uint64_t>(pin.pinType()));
+            MfHash::mix(digest, pin.intNetIdx());
+            MfHash::mix(digest, pin.netIdx());
+            MfHash::mix(digest, pin.valid());
+        }
+    }
+    MfHash::mix(digest, ckt.numNets());
+    for (const auto &net : ckt.netArray())
+    {
+        MfHash::mix(digest, net.name());
+        MfHash::mix(digest, net.ioPos());
+        MfHash::mix(digest, (net.isVdd() ? 1 : 0) | (net.isVss() ? 2 : 0) | (net.isDigital() ? 4 : 0) | (net.isAnalog() ? 8 : 0));
+    }
+    MfHash::mix(digest, ckt.hasConstraint());
+    if (ckt.hasConstraint())
+    {
+        mixConstraint(digest, ckt.constraint());
+    }
+    return digest;
+}
+
+void CktContentHash::build(std::uint64_t salt)
+{
+    const auto &hierarchy = _designDB.hierarchy();
+    _hashes.assign(_designDB.numCkts(), 0);
+    for (IndexType cktIdx : hierarchy.bottomUpOrder())
+    {
+        std::uint64_t digest = localHash(_designDB, cktIdx);
+        MfHash::mix(digest, salt);
+        // The nodes in order, as a node instantiating another circuit is another circuit
+        for (const auto &node : _designDB.subCkt(cktIdx).nodeArray())
+        {
+            MfHash::mix(digest, node.isLeaf() ? 0 : _hashes[node.subgraphIdx()]);
+        }
+        _hashes[cktIdx] = digest;
+    }
+}
+
+std::string CktContentHash::hashString(IndexType cktIdx) const
+{
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(this->hash(cktIdx)));
+    return std::string(buf);
+}
+
+std::uint64_t CktContentHash::stringHash(const std::string &str)
+{
+    std::uint64_t digest = MfHash::FNV_OFFSET;
+    MfHash::mix(digest, str);
+    return digest;
+}
+
+std::uint64_t CktContentHash::fileHash(const std::string &filename)
+{
+    std::ifstream is(filename, std::ios::binary);
+    if (!is.good())
+    {
+        WRN("CktContentHash: cannot read %s \n", filename.c_str());
+        return 0;
+    }
+    std::uint64_t digest = MfHash::FNV_OFFSET;
+    std::uint64_t size = 0;
+    std::vector<char> buf(1 << 16);
+    while (is)
+    {
+        is.read(buf.data(), buf.size());
+        const std::streamsize count = is.gcount();
+        for (std::streamsize idx = 0; idx < count; ++idx)
+        {
+            digest ^= static_cast<unsigned char>(buf[idx]);
+            digest *= MfHash::FNV_PRIME;
+        }
+        size += count;
+    }
+    if (is.bad())
+    {
+        WRN("CktContentHash: cannot read %s \n", filename.c_str());
+        return 0;
+    }
+    MfHash::mix(digest, size);
+    return digest;
+}
+
+PROJECT_NAMESPACE_END
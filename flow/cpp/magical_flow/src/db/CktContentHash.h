@@ -0,0 +1,57 @@
+/**
+ * @file CktContentHash.h
+ * @brief The content digests of the circuits, for reusing the layouts of the unchanged sub circuits across runs
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_CKT_CONTENT_HASH_H_
+#define MAGICAL_FLOW_CKT_CONTENT_HASH_H_
+
+#include <cstdint>
+#include "DesignDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::CktContentHash
+/// @brief the digest of everything a circuit is implemented from: its name, type and physical properties, its nodes and their pins,
+/// its nets with their io positions and power flags, its constraints if any, and the digests of the circuits its nodes instantiate.
+/// The results of the flow, such as the placement and the layouts, are not part of it, so that a circuit keeps its digest once implemented.
+/// Two circuits with the same digest, in two runs, are implemented the same as long as the flow itself is the same, which the salt stands for
+class CktContentHash
+{
+    public:
+        /// @brief constructor
+        /// @param the design database. Should outlive this
+        explicit CktContentHash(const DesignDB &designDB) : _designDB(designDB) {}
+        /// @brief compute the digests of all the circuits, bottom-up along the hierarchy
+        /// @param the salt folded into every digest, such as a digest of the parameters and the technology of the flow
+        void build(std::uint64_t salt = 0);
+        /// @brief get the digest of a circuit
+        /// @param the index of the circuit
+        /// @return the digest. 0 for the circuits on a cycle of the hierarchy
+        std::uint64_t hash(IndexType cktIdx) const { AssertMsg(cktIdx < _hashes.size(), "%s: circuit %u out of %lu, not built? \n", __FUNCTION__, cktIdx, _hashes.size()); return _hashes[cktIdx]; }
+        /// @brief get the digest of a circuit as 16 hexadecimal digits, for naming the files
+        /// @param the index of the circuit
+        /// @return the digest
+        std::string hashString(IndexType cktIdx) const;
+        /// @brief get the digest of a circuit without its sub circuits
+        /// @param first: the design database
+        /// @param second: the index of the circuit
+        /// @return the digest
+        static std::uint64_t localHash(const DesignDB &designDB, IndexType cktIdx);
+        /// @brief get the digest of a string, for the salts
+        /// @param the string
+        /// @return the digest
+        static std::uint64_t stringHash(const std::string &str);
+        /// @brief get the digest of the contents of a file, for the salts, such as of the netlist and the technology files the flow reads
+        /// @param the name of the file
+        /// @return the digest. 0 if the file cannot be read
+        static std::uint64_t fileHash(const std::string &filename);
+    private:
+        const DesignDB &_designDB; ///< The design database
+        std::vector<std::uint64_t> _hashes; ///< The digest of each circuit
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_CKT_CONTENT_HASH_H_
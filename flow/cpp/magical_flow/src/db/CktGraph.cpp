@@ -0,0 +1,74 @@
+/**
+ * @file CktGraph.cpp
+ * @brief A graph for the implementation of circuit at one level of hierarchy
+ * @date 10/14/2026
+ */
+
+#include "db/CktGraph.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief pack the lists into one array. The views are set after the array stops growing
+    template<typename Objects, typename GetList>
+    void packLists(Objects &objs, GetList getList, std::vector<IndexType> &start, std::vector<IndexType> &packed)
+    {
+        std::vector<IndexType> newStart;
+        std::vector<IndexType> newPacked;
+        newStart.reserve(objs.size() + 1);
+        newStart.emplace_back(0);
+        IndexType total = 0;
+        for (auto &obj : objs)
+        {
+            total += getList(obj).size();
+        }
+        newPacked.reserve(total);
+        for (auto &obj : objs)
+        {
+            IndexSpan span = getList(obj).span();
+            newPacked.insert(newPacked.end(), span.begin(), span.end());
+            newStart.emplace_back(newPacked.size());
+        }
+        // The old packed array may still be viewed until here
+        for (IndexType idx = 0; idx < objs.size(); ++idx)
+        {
+            getList(objs[idx]).setView(newPacked.data() + newStart[idx], newStart[idx + 1] - newStart[idx]);
+        }
+        start.swap(newStart);
+        packed.swap(newPacked);
+    }
+}
+
+void CktGraph::compactConnectivity()
+{
+    packLists(_nodeArray, [](CktNode &node) -> IndexList & { return node._pinIdxArray; }, _nodePinStart, _nodePins);
+    packLists(_netArray, [](Net &net) -> IndexList & { return net._pinIdxArray; }, _netPinStart, _netPins);
+    packLists(_netArray, [](Net &net) -> IndexList & { return net._subIdxArray; }, _netSubStart, _netSubs);
+}
+
+void CktGraph::assignConnectivity(std::vector<IndexType> nodePinStart, std::vector<IndexType> nodePins,
+                                  std::vector<IndexType> netPinStart, std::vector<IndexType> netPins,
+                                  std::vector<IndexType> netSubStart, std::vector<IndexType> netSubs)
+{
+    AssertMsg(nodePinStart.size() == _nodeArray.size() + 1 && nodePinStart.back() == nodePins.size(), "%s: bad node pin offsets for %s \n", __FUNCTION__, _name.c_str());
+    AssertMsg(netPinStart.size() == _netArray.size() + 1 && netPinStart.back() == netPins.size(), "%s: bad net pin offsets for %s \n", __FUNCTION__, _name.c_str());
+    AssertMsg(netSubStart.size() == _netArray.size() + 1 && netSubStart.back() == netSubs.size(), "%s: bad net substrate offsets for %s \n", __FUNCTION__, _name.c_str());
+    _nodePinStart.swap(nodePinStart);
+    _nodePins.swap(nodePins);
+    _netPinStart.swap(netPinStart);
+    _netPins.swap(netPins);
+    _netSubStart.swap(netSubStart);
+    _netSubs.swap(netSubs);
+    for (IndexType nodeIdx = 0; nodeIdx < _nodeArray.size(); ++nodeIdx)
+    {
+        _nodeArray[nodeIdx]._pinIdxArray.setView(_nodePins.data() + _nodePinStart[nodeIdx], _nodePinStart[nodeIdx + 1] - _nodePinStart[nodeIdx]);
+    }
+    for (IndexType netIdx = 0; netIdx < _netArray.size(); ++netIdx)
+    {
+        _netArray[netIdx]._pinIdxArray.setView(_netPins.data() + _netPinStart[netIdx], _netPinStart[netIdx + 1] - _netPinStart[netIdx]);
+        _netArray[netIdx]._subIdxArray.setView(_netSubs.data() + _netSubStart[netIdx], _netSubStart[netIdx + 1] - _netSubStart[netIdx]);
+    }
+}
+
+PROJECT_NAMESPACE_END
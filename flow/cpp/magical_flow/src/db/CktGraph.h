@@ -8,36 +8,63 @@
 #ifndef MAGICAL_FLOW_CKTGRAPH_H_
 #define MAGICAL_FLOW_CKTGRAPH_H_
 
+#include <memory>
 #include "GraphComponents.h"
-#include "parser/ParseGDS.h"
+#include "parser/GdsMappedLibrary.h"
+#include "parser/OasisReader.h"
 #include "Layout.h"
 #include "TechDB.h"
+#include "CktConstraint.h"
+#include "util/Arena.h"
+#include "util/GzipStream.h"
 
 PROJECT_NAMESPACE_BEGIN
 
 /// @class MAGICAL_FLOW::CktGraph
-/// @brief each CktGraph represent a level of circuit in the hierarchical flow
+/// @brief each CktGraph represent a level of circuit in the hierarchical flow.
+/// The layout and the constraints are allocated on the first non-const access, since most of the circuits are leaf devices only reading them.
+/// The node, pin and net arrays may draw from a PoolArena shared by the circuits of a design.
+/// Once the netlist is read, compactConnectivity packs the pin lists of the nodes and the nets into compressed arrays owned by the circuit
 class CktGraph
 {
     public:
         /// @brief default construtor
         explicit CktGraph() = default; 
-        void setTechDB(TechDB & techDB) { _techDB = techDB; }
+        /// @brief construct with the arena for the node, pin and net arrays
+        /// @param the arena. Should outlive the circuit
+        explicit CktGraph(PoolArena *arena)
+            : _nodeArray(ArenaAllocator<CktNode>(arena)), _pinArray(ArenaAllocator<Pin>(arena)), _netArray(ArenaAllocator<Net>(arena)) {}
+        /// @brief copy constructor. The copy draws from the same arena
+        CktGraph(const CktGraph &other);
+        CktGraph(CktGraph &&other) = default;
+        /// @brief copy assignment
+        CktGraph & operator=(const CktGraph &other);
+        CktGraph & operator=(CktGraph &&other) = default;
+        /// @brief set the technology database. It is shared with the DesignDB and the other circuits, not copied
+        /// @param the shared technology database
+        void setTechDB(std::shared_ptr<const TechDB> techDB) { _techDB = std::move(techDB); }
+        /// @brief whether the technology database has been set
+        /// @return whether the technology database has been set
+        bool hasTechDB() const { return _techDB != nullptr; }
+        /// @brief get the technology database
+        /// @return the technology database
+        const TechDB & techDB() const { AssertMsg(_techDB != nullptr, "CktGraph::techDB: the technology database of %s is not set \n", _name.c_str()); return *_techDB; }
         /*------------------------------*/ 
         /* Getters                      */
         /*------------------------------*/ 
         /// @brief get the array of circuit nodes
         /// @return the array of circuit nodes
-        const std::vector<CktNode> &                                nodeArray() const                                   { return _nodeArray; }
+        const ArenaVector<CktNode> &                                nodeArray() const                                   { return _nodeArray; }
         /// @brief get the array of circuit nodes
         /// @return the array of circuit nodes
-        std::vector<CktNode> &                                      nodeArray()                                         { return _nodeArray; }
+        ArenaVector<CktNode> &                                      nodeArray()                                         { return _nodeArray; }
         /// @brief resize the number of nodes
         /// @param the number of nodes
         void resizeNodeArray(IndexType numNodes)
         {
             AssertMsg(numNodes <= _nodeArray.size(), "Try resize nodes from size %u to %u", _nodeArray.size(), numNodes);
             _nodeArray.resize(numNodes);
+            ++_nodeRevision;
         }
         /// @brief get the number of nodes
         /// @return the number of nodes this graph has
@@ -45,17 +72,17 @@ class CktGraph
         /// @brief get a circuit node of this graph
         /// @param the index of node
         /// @return the circuit node
-        //const CktNode &                                             node(IndexType nodeIdx) const                       { return _nodeArray.at(nodeIdx); }
+        const CktNode &                                             node(IndexType nodeIdx) const                       { return _nodeArray.at(nodeIdx); }
         /// @brief get a circuit node of this graph
         /// @param the index of node
         /// @return the circuit node
         CktNode &                                                   node(IndexType nodeIdx)                             { return _nodeArray.at(nodeIdx); }
         /// @brief get the array of pins
         /// @return the array of pins
-        const std::vector<Pin> &                                    pinArray() const                                    { return _pinArray; }
+        const ArenaVector<Pin> &                                    pinArray() const                                    { return _pinArray; }
         /// @brief get the array of pins
         /// @return the array of pins
-        std::vector<Pin> &                                          pinArray()                                          { return _pinArray; }
+        ArenaVector<Pin> &                                          pinArray()                                          { return _pinArray; }
         /// @brief get the number of pins
         /// @return the number of pins
         IndexType                                                   numPins() const                                     { return _pinArray.size(); }
@@ -68,24 +95,24 @@ class CktGraph
         /// @brief get a pin of this graph
         /// @param the index of the pin of this graph
         /// @return the pin object
-        //const Pin &                                                 pin(IndexType pinIdx) const                         { return _pinArray.at(pinIdx); }
+        const Pin &                                                 pin(IndexType pinIdx) const                         { return _pinArray.at(pinIdx); }
         /// @brief get a pin of this graph
         /// @param the index of the pin of this graph
         /// @return the pin object
         Pin &                                                       pin(IndexType pinIdx)                               { return _pinArray.at(pinIdx); }
         /// @brief get the array of nets of this graph
         /// @return the array of nets of this graph
-        const std::vector<Net> &                                    netArray() const                                    { return _netArray; }
+        const ArenaVector<Net> &                                    netArray() const                                    { return _netArray; }
         /// @brief get the array of nets of this graph
         /// @return the array of nets of this graph
-        std::vector<Net> &                                          netArray()                                          { return _netArray; }
+        ArenaVector<Net> &                                          netArray()                                          { return _netArray; }
         /// @brief get the number of nets this graph contains
         /// @return the number of nets this graph contains
         IndexType                                                   numNets() const                                     { return _netArray.size(); }
         /// @brief get a net of this graph
         /// @param the index of net in this graph
         /// @return a net
-        //const Net &                                                 net(IndexType netIdx) const                         { return _netArray.at(netIdx); }
+        const Net &                                                 net(IndexType netIdx) const                         { return _netArray.at(netIdx); }
         /// @brief get a net of this graph
         /// @param the index of net in this graph
         /// @return a net
@@ -98,15 +125,43 @@ class CktGraph
         /// @param the index of a nwell net
         /// @return a net
         Net &                                                       nwell(IndexType nwellIdx)                            { return _netArray.at(_nwellIdxArray.at(nwellIdx)); }
+        /// @brief get the net index of a psub
+        /// @param the index of a psub net
+        /// @return the index of the net in this graph
+        IndexType                                                   psubIdx(IndexType psubIdx) const                    { return _psubIdxArray.at(psubIdx); }
+        /// @brief get the net index of a nwell
+        /// @param the index of a nwell net
+        /// @return the index of the net in this graph
+        IndexType                                                   nwellIdx(IndexType nwellIdx) const                  { return _nwellIdxArray.at(nwellIdx); }
         /// @brief get the name of this circuit graph
         /// @return the name of this circuit
         const std::string &                                         name() const                                        { return _name; }
         /// @brief set the name of this circuit
         /// @param the name of this circuit
         void                                                        setName(const std::string &name)                    { _name = name; }
+        /// @brief get the layout of this circuit. A shared layout is copied first
+        /// @param the layout implementation of this circuit
+        Layout &                                                    layout()                                            { return _layout.get(); }
         /// @brief get the layout of this circuit
         /// @param the layout implementation of this circuit
-        Layout &                                                    layout()                                            { return _layout; }
+        const Layout &                                              layout() const                                      { return _layout.get(); }
+        /// @brief whether the layout has been allocated
+        /// @return whether the layout has been allocated. If not, layout() const returns an empty layout
+        bool                                                        hasLayout() const                                   { return _layout.has(); }
+        /// @brief share a read-only layout, such as the one of a standard cell, instead of owning a copy. The non-const layout() copies it on the first modification
+        /// @param the shared layout
+        void                                                        shareLayout(std::shared_ptr<const Layout> layout)   { _layout.share(std::move(layout)); }
+        /// @brief whether the layout is shared and not copied yet
+        bool                                                        isLayoutShared() const                              { return _layout.isShared(); }
+        /// @brief get the placement constraints of this circuit
+        /// @return the constraints of this circuit
+        CktConstraint &                                             constraint()                                        { return _constraint.get(); }
+        /// @brief get the placement constraints of this circuit
+        /// @return the constraints of this circuit
+        const CktConstraint &                                       constraint() const                                  { return _constraint.get(); }
+        /// @brief whether the constraints have been allocated
+        /// @return whether the constraints have been allocated. If not, constraint() const returns empty constraints
+        bool                                                        hasConstraint() const                               { return _constraint.has(); }
         /// @brief get the implementation type of this circuit
         /// @return the implementation type of this circuit
         ImplType implType() const { return _implType; }
@@ -122,16 +177,27 @@ class CktGraph
         /// @brief get GdsData 
         /// @return GdsData reference
         GdsData & gdsData() { return _gdsData; }
+        /// @brief get GdsData 
+        /// @return GdsData reference
+        const GdsData & gdsData() const { return _gdsData; }
         /// @brief is Net Io shape has been flipped vertically
         /// @return boolean
         bool flipVertFlag() const { return _flipVertFlag; }
+        /// @brief set whether Net Io shape has been flipped vertically, without flipping it
+        /// @param boolean
+        void setFlipVertFlag(bool flipVertFlag) { _flipVertFlag = flipVertFlag; }
 
         /*------------------------------*/ 
         /* Vector operation             */
         /*------------------------------*/ 
         /// @brief allocate a new node
         /// @return the index of the new node
-        IndexType allocateNode() { _nodeArray.emplace_back(CktNode()); return _nodeArray.size() - 1;}
+        IndexType allocateNode() { _nodeArray.emplace_back(CktNode()); ++_nodeRevision; return _nodeArray.size() - 1;}
+        /// @brief get the number of changes to the node array, for detecting stale hierarchy caches
+        /// @return the revision of the node array
+        IndexType nodeRevision() const { return _nodeRevision; }
+        /// @brief mark the node array as changed, after changing the sub circuit of a node in place
+        void touchNodes() { ++_nodeRevision; }
         /// @brief allocate a new pin
         /// @return the index of a new pin
         IndexType allocatePin() { _pinArray.emplace_back(Pin()); return _pinArray.size() - 1; }
@@ -150,16 +216,63 @@ class CktGraph
         /// @brief add a existing net index as nwell net
         /// @param the net index of exising net
         void addNwellIdx(IndexType netIdx) { _nwellIdxArray.push_back(netIdx); }
+        /// @brief pack the pin lists of all the nodes and the nets into compressed sparse row arrays, and turn the lists into views of them.
+        /// The order of the pins in each list is kept. Appending to a list afterwards detaches it, and calling this again packs it back
+        void compactConnectivity();
+        /// @brief replace the pin lists of all the nodes and the nets with packed arrays, for example read from a file
+        /// @param first, second: the offsets of the pins of each node, and the pins of the nodes
+        /// @param third, fourth: the offsets of the pins of each net, and the pins of the nets
+        /// @param fifth, sixth: the offsets of the substrate pins of each net, and the substrate pins of the nets
+        void assignConnectivity(std::vector<IndexType> nodePinStart, std::vector<IndexType> nodePins,
+                                std::vector<IndexType> netPinStart, std::vector<IndexType> netPins,
+                                std::vector<IndexType> netSubStart, std::vector<IndexType> netSubs);
+        /// @brief get the number of pins in the packed arrays of the nodes and the nets
+        std::size_t numPackedPins() const { return _nodePins.size() + _netPins.size() + _netSubs.size(); }
+        /// @brief get the heap bytes of the packed pin arrays and the substrate net indices
+        std::size_t connectivityHeapBytes() const
+        {
+            return HeapBytes::of(_nodePinStart) + HeapBytes::of(_nodePins) + HeapBytes::of(_netPinStart) + HeapBytes::of(_netPins)
+                + HeapBytes::of(_netSubStart) + HeapBytes::of(_netSubs) + HeapBytes::of(_psubIdxArray) + HeapBytes::of(_nwellIdxArray);
+        }
         bool isImpl() const { return _isImplemented; }
         void setIsImpl(bool impl) { _isImplemented = impl; }
-        /// @brief readin GDSII file into _layout
-        /// @param GDSII filename
-        void parseGDS(const std::string & fileName) { Parser parse(fileName, _layout, _techDB); }
+        /// @brief readin GDSII file into _layout. A file with the .oas extension is read as OASIS.
+        /// A plain GDSII file is mapped for the reading only, and a .gz file is streamed
+        /// @param GDSII or OASIS filename
+        void parseGDS(const std::string & fileName)
+        {
+            if (OASIS::isOasisFileName(fileName))
+            {
+                OasisReader reader(this->layout(), this->techDB());
+                reader.read(fileName);
+                return;
+            }
+            if (!MfGzip::isGzipFileName(fileName))
+            {
+                GdsMappedLibrary library(fileName);
+                if (library.valid() && library.numCells() > 0)
+                {
+                    library.readCell(library.topCellName(), this->layout(), this->techDB());
+                    return;
+                }
+            }
+            GdsStreamReader reader(this->layout(), this->techDB());
+            reader.read(fileName);
+        }
+        /// @brief readin one cell of a GDSII library into _layout, with the cells it references. The library stays mapped for the following calls, see GdsMappedLibrary::open
+        /// @param first: the GDSII library, not compressed
+        /// @param second: the name of the cell
+        /// @return whether the cell is read
+        bool parseGDSCell(const std::string & fileName, const std::string & cellName)
+        {
+            auto library = GdsMappedLibrary::open(fileName);
+            return library != nullptr && library->readCell(cellName, this->layout(), this->techDB());
+        }
 
         /*------------------------------*/ 
         /* Integration                  */
         /*------------------------------*/ 
-        /// @brief flip all net Io shape according to vertical axis
+        /// @brief flip all net Io shape according to vertical axis. InstanceView::mirrored gives the flipped shapes without changing them
         /// @param symmetry vertical axis x=axis
         void flipVert(LocType axis)
         {
@@ -172,18 +285,66 @@ class CktGraph
         
 
     private:
-        TechDB _techDB;
-        std::vector<CktNode> _nodeArray; ///< The circuit nodes of this graph
-        std::vector<Pin> _pinArray; ///< The pins of the circuit
-        std::vector<Net> _netArray; ///< The nets of the circuit
-        std::vector<IndexType> _psubIdxArray; ///< The index of substrate nets in _netArray
-        std::vector<IndexType> _nwellIdxArray; ///< The index of nwell nets in _netArray
-        std::string _name = ""; ///< The name of this circuit
-        Layout _layout; ///< The layout implementation for this circuit
+        /// @brief a member allocated on the first non-const access. The const access before that sees a shared default object.
+        /// The member may also view a read-only object shared with others, which is copied on the first non-const access
+        template<typename T>
+        class LazyMember
+        {
+            public:
+                LazyMember() = default;
+                LazyMember(const LazyMember &other) : _ptr(other.copyPtr()), _shared(other._shared) {}
+                LazyMember(LazyMember &&other) noexcept : _ptr(std::move(other._ptr)), _shared(other._shared) { other._shared = false; }
+                LazyMember & operator=(const LazyMember &other) { _ptr = other.copyPtr(); _shared = other._shared; return *this; }
+                LazyMember & operator=(LazyMember &&other) noexcept { _ptr = std::move(other._ptr); _shared = other._shared; other._shared = false; return *this; }
+                bool has() const { return _ptr != nullptr; }
+                bool isShared() const { return _shared; }
+                T & get()
+                {
+                    if (!_ptr)
+                    {
+                        _ptr = std::make_shared<T>();
+                    }
+                    else if (_shared)
+                    {
+                        _ptr = std::make_shared<T>(*_ptr);
+                        _shared = false;
+                    }
+                    return *_ptr;
+                }
+                const T & get() const { return _ptr ? *_ptr : defaultValue(); }
+                /// @brief view a shared object. It is never modified through this member
+                void share(std::shared_ptr<const T> ptr) { _ptr = std::const_pointer_cast<T>(std::move(ptr)); _shared = _ptr != nullptr; }
+            private:
+                static const T & defaultValue() { static const T value; return value; }
+                /// @brief the pointer of a copy: the same shared object, or a copy of the owned one
+                std::shared_ptr<T> copyPtr() const { return _shared ? _ptr : (_ptr ? std::make_shared<T>(*_ptr) : nullptr); }
+                std::shared_ptr<T> _ptr;
+                bool _shared = false; ///< Whether _ptr is shared and read-only
+        };
+    private:
+        /* Read by every traversal of the hierarchy */
         ImplType _implType = ImplType::UNSET; ///< The implementation set of this circuit
         IndexType _implIdx = INDEX_TYPE_MAX; ///< The index of this implementation type configuration in the database
+        IndexType _nodeRevision = 0; ///< Incremented whenever the node array changes
         bool _isImplemented = false; 
         bool _flipVertFlag = false; ///< Flag indicating that net Io shape has been flipped vertically
+        ArenaVector<CktNode> _nodeArray; ///< The circuit nodes of this graph
+        ArenaVector<Pin> _pinArray; ///< The pins of the circuit
+        ArenaVector<Net> _netArray; ///< The nets of the circuit
+        std::vector<IndexType> _psubIdxArray; ///< The index of substrate nets in _netArray
+        std::vector<IndexType> _nwellIdxArray; ///< The index of nwell nets in _netArray
+        std::string _name = ""; ///< The name of this circuit
+        std::shared_ptr<const TechDB> _techDB; ///< The shared technology database
+        /* The packed pin lists, viewed by the nodes and the nets */
+        std::vector<IndexType> _nodePinStart; ///< The offsets of the pins of each node into _nodePins
+        std::vector<IndexType> _nodePins; ///< The pins of the nodes
+        std::vector<IndexType> _netPinStart; ///< The offsets of the pins of each net into _netPins
+        std::vector<IndexType> _netPins; ///< The pins of the nets
+        std::vector<IndexType> _netSubStart; ///< The offsets of the substrate pins of each net into _netSubs
+        std::vector<IndexType> _netSubs; ///< The substrate pins of the nets
+        /* Allocated on demand */
+        LazyMember<Layout> _layout; ///< The layout implementation for this circuit
+        LazyMember<CktConstraint> _constraint; ///< The placement constraints of this circuit
         /*------------------------------*/ 
         /* Integration                  */
         /*------------------------------*/ 
@@ -191,6 +352,30 @@ class CktGraph
 
 };
 
+inline CktGraph::CktGraph(const CktGraph &other)
+    : _implType(other._implType), _implIdx(other._implIdx), _nodeRevision(other._nodeRevision),
+      _isImplemented(other._isImplemented), _flipVertFlag(other._flipVertFlag),
+      _nodeArray(other._nodeArray), _pinArray(other._pinArray), _netArray(other._netArray),
+      _psubIdxArray(other._psubIdxArray), _nwellIdxArray(other._nwellIdxArray), _name(other._name), _techDB(other._techDB),
+      _layout(other._layout), _constraint(other._constraint), _gdsData(other._gdsData)
+{
+    // The copied lists still view the packed arrays of other
+    if (!other._nodePinStart.empty() || !other._netPinStart.empty())
+    {
+        this->compactConnectivity();
+    }
+}
+
+inline CktGraph & CktGraph::operator=(const CktGraph &other)
+{
+    if (this != &other)
+    {
+        CktGraph copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
 PROJECT_NAMESPACE_END
 
 #endif //MAGICAL_FLOW_CKTGRAPH_H_
@@ -0,0 +1,112 @@
+/**
+ * @file CktHierarchy.cpp
+ * @brief The levelized order and the adjacency of the circuit hierarchy
+ * @date 10/14/2026
+ */
+
+#include "db/CktHierarchy.h"
+#include <algorithm>
+
+PROJECT_NAMESPACE_BEGIN
+
+bool CktHierarchy::build(const std::vector<CktGraph> &ckts)
+{
+    const IndexType numCkts = ckts.size();
+    // Distinct sub circuits of each circuit
+    _childStart.assign(1, 0);
+    _childStart.reserve(numCkts + 1);
+    _children.clear();
+    std::vector<IndexType> lastParent(numCkts, INDEX_TYPE_MAX); ///< The last circuit adding each child, for removing the duplicates
+    std::vector<IndexType> numParents(numCkts, 0);
+    for (IndexType cktIdx = 0; cktIdx < numCkts; ++cktIdx)
+    {
+        for (const auto &node : ckts[cktIdx].nodeArray())
+        {
+            if (node.isLeaf())
+            {
+                continue;
+            }
+            IndexType childIdx = node.subgraphIdx();
+            AssertMsg(childIdx < numCkts, "CktHierarchy: a node of circuit %s refers to the circuit %u out of %u \n", ckts[cktIdx].name().c_str(), childIdx, numCkts);
+            if (lastParent[childIdx] == cktIdx)
+            {
+                continue;
+            }
+            lastParent[childIdx] = cktIdx;
+            _children.emplace_back(childIdx);
+            ++numParents[childIdx];
+        }
+        _childStart.emplace_back(_children.size());
+    }
+    // Parents by counting sort, so that each list is in index order
+    _parentStart.assign(numCkts + 1, 0);
+    for (IndexType cktIdx = 0; cktIdx < numCkts; ++cktIdx)
+    {
+        _parentStart[cktIdx + 1] = _parentStart[cktIdx] + numParents[cktIdx];
+    }
+    _parents.resize(_children.size());
+    std::vector<IndexType> fill(_parentStart.begin(), _parentStart.end() - 1);
+    for (IndexType cktIdx = 0; cktIdx < numCkts; ++cktIdx)
+    {
+        for (IndexType idx = _childStart[cktIdx]; idx < _childStart[cktIdx + 1]; ++idx)
+        {
+            _parents[fill[_children[idx]]++] = cktIdx;
+        }
+    }
+    // Levelize bottom-up: a circuit is finished once all its sub circuits are
+    _level.assign(numCkts, INDEX_TYPE_MAX);
+    std::vector<IndexType> numPending(numCkts);
+    std::vector<IndexType> frontier;
+    for (IndexType cktIdx = 0; cktIdx < numCkts; ++cktIdx)
+    {
+        numPending[cktIdx] = _childStart[cktIdx + 1] - _childStart[cktIdx];
+        if (numPending[cktIdx] == 0)
+        {
+            frontier.emplace_back(cktIdx);
+        }
+    }
+    _order.clear();
+    _order.reserve(numCkts);
+    _levelStart.assign(1, 0);
+    std::vector<IndexType> next;
+    for (IndexType level = 0; !frontier.empty(); ++level)
+    {
+        std::sort(frontier.begin(), frontier.end());
+        next.clear();
+        for (IndexType cktIdx : frontier)
+        {
+            _level[cktIdx] = level;
+            _order.emplace_back(cktIdx);
+            for (IndexType idx = _parentStart[cktIdx]; idx < _parentStart[cktIdx + 1]; ++idx)
+            {
+                if (--numPending[_parents[idx]] == 0)
+                {
+                    next.emplace_back(_parents[idx]);
+                }
+            }
+        }
+        _levelStart.emplace_back(_order.size());
+        frontier.swap(next);
+    }
+    if (!this->isAcyclic())
+    {
+        ERR("CktHierarchy: the circuit hierarchy is cyclic. %u circuits out of %u are not levelized \n", numCkts - static_cast<IndexType>(_order.size()), numCkts);
+        return false;
+    }
+    return true;
+}
+
+std::vector<IndexType> CktHierarchy::roots() const
+{
+    std::vector<IndexType> roots;
+    for (IndexType cktIdx = 0; cktIdx < this->numCkts(); ++cktIdx)
+    {
+        if (this->numParents(cktIdx) == 0)
+        {
+            roots.emplace_back(cktIdx);
+        }
+    }
+    return roots;
+}
+
+PROJECT_NAMESPACE_END
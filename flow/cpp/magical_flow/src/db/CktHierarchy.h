@@ -0,0 +1,100 @@
+/**
+ * @file CktHierarchy.h
+ * @brief The levelized order and the adjacency of the circuit hierarchy
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_CKT_HIERARCHY_H_
+#define MAGICAL_FLOW_CKT_HIERARCHY_H_
+
+#include "CktGraph.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::CktHierarchy
+/// @brief The circuits instantiated by each circuit, the circuits instantiating it, and a bottom-up levelization.
+/// A circuit at level 0 instantiates no sub circuit. Otherwise its level is one more than the highest level of its sub circuits,
+/// so that all the circuits of a level can be implemented independently once the lower levels are done.
+/// The adjacency is stored in compressed arrays: the children of circuit i are children()[childStart(i), childStart(i + 1))
+class CktHierarchy
+{
+    public:
+        /// @brief default constructor
+        explicit CktHierarchy() = default;
+        /// @brief build from the circuits
+        /// @param the circuits of the design
+        /// @return false if the hierarchy is cyclic. The circuits on a cycle are left out of the levels
+        bool build(const std::vector<CktGraph> &ckts);
+        /// @brief get the number of circuits
+        /// @return the number of circuits
+        IndexType numCkts() const { return _level.size(); }
+        /// @brief get the number of levels
+        /// @return the number of levels
+        IndexType numLevels() const { return _levelStart.empty() ? 0 : _levelStart.size() - 1; }
+        /// @brief get the level of a circuit
+        /// @param the index of the circuit
+        /// @return the level of the circuit. INDEX_TYPE_MAX if it is on a cycle
+        IndexType level(IndexType cktIdx) const { return _level.at(cktIdx); }
+        /// @brief get the bottom-up order: the circuits of level 0, then level 1, and so on. The circuits in a level are in index order
+        /// @return the bottom-up order of the circuits
+        const std::vector<IndexType> & bottomUpOrder() const { return _order; }
+        /// @brief get the circuits of a level
+        /// @param the level
+        /// @return the circuits of the level
+        std::vector<IndexType> levelCkts(IndexType level) const
+        {
+            return std::vector<IndexType>(_order.begin() + _levelStart.at(level), _order.begin() + _levelStart.at(level + 1));
+        }
+        /// @brief get the number of distinct sub circuits of a circuit
+        /// @param the index of the circuit
+        /// @return the number of distinct sub circuits
+        IndexType numChildren(IndexType cktIdx) const { return _childStart.at(cktIdx + 1) - _childStart.at(cktIdx); }
+        /// @brief get the distinct sub circuits of a circuit, in the order of their first node
+        /// @param the index of the circuit
+        /// @return the sub circuits
+        std::vector<IndexType> children(IndexType cktIdx) const
+        {
+            return std::vector<IndexType>(_children.begin() + _childStart.at(cktIdx), _children.begin() + _childStart.at(cktIdx + 1));
+        }
+        /// @brief get the number of distinct circuits instantiating a circuit
+        /// @param the index of the circuit
+        /// @return the number of distinct parent circuits
+        IndexType numParents(IndexType cktIdx) const { return _parentStart.at(cktIdx + 1) - _parentStart.at(cktIdx); }
+        /// @brief get the distinct circuits instantiating a circuit, in index order
+        /// @param the index of the circuit
+        /// @return the parent circuits
+        std::vector<IndexType> parents(IndexType cktIdx) const
+        {
+            return std::vector<IndexType>(_parents.begin() + _parentStart.at(cktIdx), _parents.begin() + _parentStart.at(cktIdx + 1));
+        }
+        /// @brief get the flat array of the sub circuits, indexed by childStart
+        /// @return the flat array of the sub circuits
+        const std::vector<IndexType> & childArray() const { return _children; }
+        /// @brief get the offsets of the sub circuits of each circuit into childArray. The size is numCkts() + 1
+        /// @return the offsets
+        const std::vector<IndexType> & childStartArray() const { return _childStart; }
+        /// @brief get the flat array of the parent circuits, indexed by parentStart
+        /// @return the flat array of the parent circuits
+        const std::vector<IndexType> & parentArray() const { return _parents; }
+        /// @brief get the offsets of the parents of each circuit into parentArray. The size is numCkts() + 1
+        /// @return the offsets
+        const std::vector<IndexType> & parentStartArray() const { return _parentStart; }
+        /// @brief get the circuits that no circuit instantiates, in index order
+        /// @return the root circuits
+        std::vector<IndexType> roots() const;
+        /// @brief whether the hierarchy is acyclic
+        /// @return whether the hierarchy is acyclic
+        bool isAcyclic() const { return _order.size() == _level.size(); }
+    private:
+        std::vector<IndexType> _childStart; ///< The offsets into _children
+        std::vector<IndexType> _children; ///< The distinct sub circuits of each circuit
+        std::vector<IndexType> _parentStart; ///< The offsets into _parents
+        std::vector<IndexType> _parents; ///< The distinct parent circuits of each circuit
+        std::vector<IndexType> _level; ///< The level of each circuit
+        std::vector<IndexType> _order; ///< The circuits sorted by level
+        std::vector<IndexType> _levelStart; ///< The offsets of each level into _order
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_CKT_HIERARCHY_H_
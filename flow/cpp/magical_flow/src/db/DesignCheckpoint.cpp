@@ -0,0 +1,1186 @@
+/**
+ * @file DesignCheckpoint.cpp
+ * @brief Binary snapshot of the DesignDB, for resuming the flow after a stage
+ * @date 10/14/2026
+ */
+
+#include "db/DesignCheckpoint.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "db/DesignDB.h"
+#include "util/MappedFile.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the first bytes of a checkpoint, followed by the version and a byte order mark
+    constexpr char CHECKPOINT_MAGIC[8] = {'M', 'F', 'D', 'E', 'S', 'I', 'G', 'N'};
+    /// @brief the first bytes of a subtree snapshot, followed by the version and a byte order mark
+    constexpr char SUBTREE_MAGIC[8] = {'M', 'F', 'S', 'U', 'B', 'T', 'R', 'E'};
+    constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    /// @brief the alignment of the arrays in the file
+    constexpr std::size_t ARRAY_ALIGN = 8;
+    /// @brief the fewest bytes of the records of a list, to bound the counts read from a file by the bytes left
+    constexpr std::size_t MIN_NAME_BYTES = 4; ///< A string
+    constexpr std::size_t MIN_MOS_BYTES = 28; ///< A MosProp
+    constexpr std::size_t MIN_RES_BYTES = 22; ///< A ResProp
+    constexpr std::size_t MIN_CAP_BYTES = 36; ///< A CapProp
+    constexpr std::size_t MIN_PATH_BYTES = 9; ///< A signal path
+    constexpr std::size_t MIN_LAYER_BYTES = 56; ///< A layer of a layout
+    constexpr std::size_t MIN_TEXT_BYTES = 12; ///< A text
+    constexpr std::size_t MIN_CKT_BYTES = 80; ///< A circuit
+    constexpr std::size_t MIN_NODE_BYTES = 30; ///< A node of a circuit
+    constexpr std::size_t MIN_PIN_BYTES = 21; ///< A pin of a circuit
+    constexpr std::size_t MIN_NET_BYTES = 16; ///< A net of a circuit
+    constexpr std::size_t MIN_IO_BYTES = 24; ///< An io pin of a net
+    constexpr std::size_t MIN_NODE_IMPL_BYTES = 14; ///< The placement of a node in a subtree snapshot
+
+    typedef std::vector<std::pair<IndexType, IndexType>> RangeVector;
+
+    /// @brief sequential writer of the checkpoint records
+    class CheckpointWriter
+    {
+        public:
+            explicit CheckpointWriter(std::ofstream &os) : _os(os) {}
+            template<typename T>
+            void pod(const T &value) { this->bytes(&value, sizeof(T)); }
+            void flag(bool value) { this->pod(static_cast<std::uint8_t>(value)); }
+            void str(const std::string &value)
+            {
+                this->pod(static_cast<std::uint32_t>(value.size()));
+                this->bytes(value.data(), value.size());
+            }
+            void box(const Box<LocType> &value)
+            {
+                this->pod(value.xLo());
+                this->pod(value.yLo());
+                this->pod(value.xHi());
+                this->pod(value.yHi());
+            }
+            /// @brief the size, then the padding to ARRAY_ALIGN, then the elements
+            template<typename T>
+            void array(const T *data, std::size_t size)
+            {
+                this->pod(static_cast<std::uint32_t>(size));
+                static const char zeros[ARRAY_ALIGN] = {};
+                this->bytes(zeros, (ARRAY_ALIGN - _offset % ARRAY_ALIGN) % ARRAY_ALIGN);
+                this->bytes(data, size * sizeof(T));
+            }
+            template<typename T>
+            void array(const std::vector<T> &values) { this->array(values.data(), values.size()); }
+            void ranges(const RangeVector &values)
+            {
+                std::vector<IndexType> flat;
+                flat.reserve(2 * values.size());
+                for (const auto &range : values)
+                {
+                    flat.emplace_back(range.first);
+                    flat.emplace_back(range.second);
+                }
+                this->array(flat);
+            }
+            bool good() const { return static_cast<bool>(_os); }
+        private:
+            void bytes(const void *data, std::size_t size)
+            {
+                _os.write(static_cast<const char *>(data), size);
+                _offset += size;
+            }
+            std::ofstream &_os;
+            std::size_t _offset = 0; ///< The offset in the file, for aligning the arrays
+    };
+
+    /// @brief sequential reader over the mapped checkpoint. Every read is bound checked, and a failed read fails the following ones
+    class CheckpointReader
+    {
+        public:
+            explicit CheckpointReader(const char *begin, std::size_t size) : _begin(begin), _cur(begin), _end(begin + size) {}
+            template<typename T>
+            T pod()
+            {
+                T value = T();
+                if (this->require(sizeof(T)))
+                {
+                    std::memcpy(&value, _cur, sizeof(T));
+                    _cur += sizeof(T);
+                }
+                return value;
+            }
+            bool flag() { return this->pod<std::uint8_t>() != 0; }
+            std::string str()
+            {
+                std::uint32_t size = this->pod<std::uint32_t>();
+                if (!this->require(size))
+                {
+                    return "";
+                }
+                std::string value(_cur, size);
+                _cur += size;
+                return value;
+            }
+            Box<LocType> box()
+            {
+                LocType xLo = this->pod<LocType>();
+                LocType yLo = this->pod<LocType>();
+                LocType xHi = this->pod<LocType>();
+                LocType yHi = this->pod<LocType>();
+                return Box<LocType>(xLo, yLo, xHi, yHi);
+            }
+            /// @brief get the elements of an array in place
+            /// @param the number of elements, set by the call
+            /// @return a pointer into the mapped file. nullptr on failure
+            template<typename T>
+            const T * array(std::uint32_t &size)
+            {
+                size = this->pod<std::uint32_t>();
+                std::size_t pad = (ARRAY_ALIGN - (_cur - _begin) % ARRAY_ALIGN) % ARRAY_ALIGN;
+                if (!this->require(pad) || !this->require(pad + static_cast<std::size_t>(size) * sizeof(T)))
+                {
+                    size = 0;
+                    return nullptr;
+                }
+                _cur += pad;
+                const T *data = reinterpret_cast<const T *>(_cur);
+                _cur += static_cast<std::size_t>(size) * sizeof(T);
+                return data;
+            }
+            template<typename T>
+            std::vector<T> vector()
+            {
+                std::uint32_t size = 0;
+                const T *data = this->array<T>(size);
+                return data == nullptr ? std::vector<T>() : std::vector<T>(data, data + size);
+            }
+            RangeVector ranges()
+            {
+                std::vector<IndexType> flat = this->vector<IndexType>();
+                RangeVector values;
+                values.reserve(flat.size() / 2);
+                for (std::size_t idx = 0; idx + 1 < flat.size(); idx += 2)
+                {
+                    values.emplace_back(flat[idx], flat[idx + 1]);
+                }
+                return values;
+            }
+            /// @brief read the number of records of a list, bound by the bytes left
+            /// @param the fewest bytes of a record
+            /// @return the number of records. 0 if the records cannot fit in the rest of the file, which fails the following reads
+            std::uint32_t count(std::size_t recordBytes)
+            {
+                std::uint32_t size = this->pod<std::uint32_t>();
+                if (_good && static_cast<std::size_t>(_end - _cur) / recordBytes < size)
+                {
+                    _good = false;
+                }
+                return _good ? size : 0;
+            }
+            /// @brief fail the reader on an inconsistent record, so that the records after it are not misparsed
+            void fail() { _good = false; }
+            bool good() const { return _good; }
+        private:
+            bool require(std::size_t size)
+            {
+                if (_good && static_cast<std::size_t>(_end - _cur) < size)
+                {
+                    _good = false;
+                }
+                return _good;
+            }
+            const char *_begin;
+            const char *_cur;
+            const char *_end;
+            bool _good = true;
+    };
+
+    void writeMos(CheckpointWriter &out, const MosProp &mos)
+    {
+        out.pod(mos.length());
+        out.pod(mos.width());
+        out.pod(mos.mult());
+        out.pod(mos.numFingers());
+        out.str(mos.attr());
+        out.str(mos.pinConType());
+        std::vector<IndexType> bulkCon;
+        for (IndexType idx = 0; idx < mos.numBulkCon(); ++idx)
+        {
+            bulkCon.emplace_back(mos.bulkCon(idx));
+        }
+        out.array(bulkCon);
+    }
+
+    void readMos(CheckpointReader &in, MosProp &mos)
+    {
+        mos.setLength(in.pod<IntType>());
+        mos.setWidth(in.pod<IntType>());
+        mos.setMult(in.pod<IntType>());
+        mos.setNumFingers(in.pod<IntType>());
+        mos.setAttr(in.str());
+        mos.setPinConType(in.str());
+        for (IndexType pin : in.vector<IndexType>())
+        {
+            mos.appendBulkCon(pin);
+        }
+    }
+
+    /// @brief the selection of the circuits and the physical properties written into a sub design, with their indices in it
+    struct SubDesignMap
+    {
+        std::vector<IndexType> ckts; ///< The circuits written, in their order
+        std::vector<IndexType> cktIdx; ///< The index in the sub design of each circuit of the design. INDEX_TYPE_MAX if not written
+        std::vector<IndexType> props[4]; ///< The properties of each PhyPropDB::propKind used by the written circuits, in their order
+        std::vector<IndexType> propIdx[4]; ///< The index in the sub design of each property of the design
+
+        /// @brief get the index written for the implementation of a circuit
+        IndexType implIdx(const CktGraph &ckt) const
+        {
+            IntType kind = PhyPropDB::propKind(ckt.implType());
+            if (kind < 0 || ckt.implIdx() >= propIdx[kind].size())
+            {
+                return ckt.implIdx();
+            }
+            return propIdx[kind][ckt.implIdx()];
+        }
+    };
+
+    void writeRes(CheckpointWriter &out, const ResProp &res)
+    {
+        out.pod(res.lr());
+        out.pod(res.wr());
+        out.flag(res.series());
+        out.flag(res.parallel());
+        out.pod(res.segNum());
+        out.pod(res.segSpace());
+        out.str(res.attr());
+    }
+
+    void writeCap(CheckpointWriter &out, const CapProp &cap)
+    {
+        out.pod(cap.numFingers());
+        out.pod(cap.lr());
+        out.pod(cap.w());
+        out.pod(cap.spacing());
+        out.pod(cap.stm());
+        out.pod(cap.spm());
+        out.pod(cap.multi());
+        out.pod(cap.ftip());
+        out.str(cap.attr());
+    }
+
+    void writePhyProps(CheckpointWriter &out, const PhyPropDB &props)
+    {
+        out.pod(static_cast<std::uint32_t>(props.numNch()));
+        for (IndexType idx = 0; idx < props.numNch(); ++idx)
+        {
+            writeMos(out, props.nch(idx));
+        }
+        out.pod(static_cast<std::uint32_t>(props.numPch()));
+        for (IndexType idx = 0; idx < props.numPch(); ++idx)
+        {
+            writeMos(out, props.pch(idx));
+        }
+        out.pod(static_cast<std::uint32_t>(props.numRes()));
+        for (IndexType idx = 0; idx < props.numRes(); ++idx)
+        {
+            writeRes(out, props.resister(idx));
+        }
+        out.pod(static_cast<std::uint32_t>(props.numCap()));
+        for (IndexType idx = 0; idx < props.numCap(); ++idx)
+        {
+            writeCap(out, props.capacitor(idx));
+        }
+    }
+
+    /// @brief write the selected properties only, in the same records as writePhyProps
+    void writePhyProps(CheckpointWriter &out, const PhyPropDB &props, const SubDesignMap &map)
+    {
+        out.pod(static_cast<std::uint32_t>(map.props[0].size()));
+        for (IndexType idx : map.props[0])
+        {
+            writeMos(out, props.nch(idx));
+        }
+        out.pod(static_cast<std::uint32_t>(map.props[1].size()));
+        for (IndexType idx : map.props[1])
+        {
+            writeMos(out, props.pch(idx));
+        }
+        out.pod(static_cast<std::uint32_t>(map.props[2].size()));
+        for (IndexType idx : map.props[2])
+        {
+            writeRes(out, props.resister(idx));
+        }
+        out.pod(static_cast<std::uint32_t>(map.props[3].size()));
+        for (IndexType idx : map.props[3])
+        {
+            writeCap(out, props.capacitor(idx));
+        }
+    }
+
+    void readPhyProps(CheckpointReader &in, PhyPropDB &props)
+    {
+        std::uint32_t num = in.count(MIN_MOS_BYTES);
+        for (std::uint32_t idx = 0; idx < num && in.good(); ++idx)
+        {
+            readMos(in, props.nch(props.allocateNch()));
+        }
+        num = in.count(MIN_MOS_BYTES);
+        for (std::uint32_t idx = 0; idx < num && in.good(); ++idx)
+        {
+            readMos(in, props.pch(props.allocatePch()));
+        }
+        num = in.count(MIN_RES_BYTES);
+        for (std::uint32_t idx = 0; idx < num && in.good(); ++idx)
+        {
+            ResProp &res = props.resister(props.allocateRes());
+            res.setLr(in.pod<IntType>());
+            res.setWr(in.pod<IntType>());
+            res.setSeries(in.flag());
+            res.setParallel(in.flag());
+            res.setSegNum(in.pod<IntType>());
+            res.setSegSpace(in.pod<IntType>());
+            res.setAttr(in.str());
+        }
+        num = in.count(MIN_CAP_BYTES);
+        for (std::uint32_t idx = 0; idx < num && in.good(); ++idx)
+        {
+            CapProp &cap = props.capacitor(props.allocateCap());
+            cap.setNumFingers(in.pod<IntType>());
+            cap.setLr(in.pod<IntType>());
+            cap.setW(in.pod<IntType>());
+            cap.setSpacing(in.pod<IntType>());
+            cap.setStm(in.pod<IntType>());
+            cap.setSpm(in.pod<IntType>());
+            cap.setMulti(in.pod<IntType>());
+            cap.setFtip(in.pod<IntType>());
+            cap.setAttr(in.str());
+        }
+    }
+
+    void writeConstraint(CheckpointWriter &out, const CktConstraint &con)
+    {
+        out.flag(con.isSymGenerated());
+        RangeVector pairs;
+        for (IndexType idx = 0; idx < con.numSymPairs(); ++idx)
+        {
+            pairs.emplace_back(con.symPair(idx));
+        }
+        out.ranges(pairs);
+        std::vector<IndexType> selfSyms;
+        for (IndexType idx = 0; idx < con.numSelfSyms(); ++idx)
+        {
+            selfSyms.emplace_back(con.selfSym(idx));
+        }
+        out.array(selfSyms);
+        pairs.clear();
+        for (IndexType idx = 0; idx < con.numSymNetPairs(); ++idx)
+        {
+            pairs.emplace_back(con.symNetPair(idx));
+        }
+        out.ranges(pairs);
+        std::vector<IndexType> selfSymNets;
+        for (IndexType idx = 0; idx < con.numSelfSymNets(); ++idx)
+        {
+            selfSymNets.emplace_back(con.selfSymNet(idx));
+        }
+        out.array(selfSymNets);
+        out.pod(static_cast<std::uint32_t>(con.numSignalPaths()));
+        for (IndexType pathIdx = 0; pathIdx < con.numSignalPaths(); ++pathIdx)
+        {
+            out.flag(con.isSignalPathPower(pathIdx));
+            std::vector<IndexType> nodes, intNets;
+            for (IndexType pos = 0; pos < con.signalPathLength(pathIdx); ++pos)
+            {
+                nodes.emplace_back(con.signalPathNode(pathIdx, pos));
+                intNets.emplace_back(con.signalPathIntNet(pathIdx, pos));
+            }
+            out.array(nodes);
+            out.array(intNets);
+        }
+    }
+
+    void readConstraint(CheckpointReader &in, CktConstraint &con)
+    {
+        if (in.flag())
+        {
+            con.markSymGenerated();
+        }
+        for (const auto &pair : in.ranges())
+        {
+            con.addSymPair(pair.first, pair.second);
+        }
+        for (IndexType nodeIdx : in.vector<IndexType>())
+        {
+            con.addSelfSym(nodeIdx);
+        }
+        for (const auto &pair : in.ranges())
+        {
+            con.addSymNetPair(pair.first, pair.second);
+        }
+        for (IndexType netIdx : in.vector<IndexType>())
+        {
+            con.addSelfSymNet(netIdx);
+        }
+        std::uint32_t numPaths = in.count(MIN_PATH_BYTES);
+        for (std::uint32_t pathIdx = 0; pathIdx < numPaths && in.good(); ++pathIdx)
+        {
+            con.allocateSignalPath(in.flag());
+            std::vector<IndexType> nodes = in.vector<IndexType>();
+            std::vector<IndexType> intNets = in.vector<IndexType>();
+            for (IndexType pos = 0; pos < std::min(nodes.size(), intNets.size()); ++pos)
+            {
+                con.addPinToSignalPath(nodes[pos], intNets[pos]);
+            }
+        }
+    }
+
+    void writeLayout(CheckpointWriter &out, const Layout &layout)
+    {
+        out.pod(static_cast<std::uint32_t>(layout.numLayers()));
+        out.box(layout.boundary());
+        for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); ++layerIdx)
+        {
+            const LayoutLayer &layer = layout.layer(layerIdx);
+            out.array(layer.xLoArray());
+            out.array(layer.yLoArray());
+            out.array(layer.xHiArray());
+            out.array(layer.yHiArray());
+            out.array(layer.datatypeArray());
+            out.pod(static_cast<std::uint32_t>(layer.textList().size()));
+            for (const auto &text : layer.textList())
+            {
+                out.str(text.text());
+                out.pod(text.coord().x());
+                out.pod(text.coord().y());
+            }
+            out.ranges(layer.flattenedRectRanges());
+            out.ranges(layer.flattenedTextRanges());
+            // The polygons are sliced when inserted, so their slices are in the rectangle arrays
+            out.array(layer.polygonXArray());
+            out.array(layer.polygonYArray());
+            out.array(layer.polygonStartArray());
+            out.array(layer.polygonDatatypeArray());
+            out.ranges(layer.slicedRectRanges());
+            out.ranges(layer.flattenedPolygonRanges());
+        }
+    }
+
+    void readLayout(CheckpointReader &in, Layout &layout)
+    {
+        std::uint32_t numLayers = in.count(MIN_LAYER_BYTES);
+        Box<LocType> boundary = in.box();
+        if (!in.good())
+        {
+            return;
+        }
+        layout.init(numLayers);
+        for (IndexType layerIdx = 0; layerIdx < numLayers && in.good(); ++layerIdx)
+        {
+            std::uint32_t numXLo = 0, numYLo = 0, numXHi = 0, numYHi = 0, numDatatypes = 0;
+            const LocType *xLo = in.array<LocType>(numXLo);
+            const LocType *yLo = in.array<LocType>(numYLo);
+            const LocType *xHi = in.array<LocType>(numXHi);
+            const LocType *yHi = in.array<LocType>(numYHi);
+            const IndexType *datatype = in.array<IndexType>(numDatatypes);
+            if (numXLo != numYLo || numXLo != numXHi || numXLo != numYHi || numXLo != numDatatypes)
+            {
+                ERR("DesignCheckpoint: inconsistent rectangle arrays on layer %u \n", layerIdx);
+                in.fail();
+                return;
+            }
+            LayoutLayer &layer = layout.layer(layerIdx);
+            if (numXLo > 0)
+            {
+                layer.assignRects(numXLo, xLo, yLo, xHi, yHi, datatype);
+            }
+            std::uint32_t numTexts = in.count(MIN_TEXT_BYTES);
+            layer.reserveTexts(numTexts);
+            for (std::uint32_t textIdx = 0; textIdx < numTexts && in.good(); ++textIdx)
+            {
+                std::string text = in.str();
+                LocType x = in.pod<LocType>();
+                LocType y = in.pod<LocType>();
+                layer.insertText(text, x, y);
+            }
+            RangeVector rectRanges = in.ranges();
+            RangeVector textRanges = in.ranges();
+            layer.setFlattenedRanges(rectRanges, textRanges);
+            std::uint32_t numPolyX = 0, numPolyY = 0, numStarts = 0, numPolyDatatypes = 0;
+            const LocType *polyX = in.array<LocType>(numPolyX);
+            const LocType *polyY = in.array<LocType>(numPolyY);
+            const IndexType *polyStart = in.array<IndexType>(numStarts);
+            const IndexType *polyDatatype = in.array<IndexType>(numPolyDatatypes);
+            RangeVector slicedRanges = in.ranges();
+            RangeVector polyRanges = in.ranges();
+            bool consistent = numPolyX == numPolyY && numStarts == numPolyDatatypes && slicedRanges.size() <= numStarts;
+            for (IndexType polyIdx = 0; consistent && polyIdx < numStarts; ++polyIdx)
+            {
+                IndexType polyEnd = polyIdx + 1 < numStarts ? polyStart[polyIdx + 1] : numPolyX;
+                consistent = polyStart[polyIdx] + 4 <= polyEnd && polyEnd <= numPolyX;
+            }
+            for (const auto &range : slicedRanges)
+            {
+                consistent = consistent && range.first <= range.second && range.second <= numXLo;
+            }
+            if (!consistent)
+            {
+                ERR("DesignCheckpoint: inconsistent polygon arrays on layer %u \n", layerIdx);
+                in.fail();
+                return;
+            }
+            if (numStarts > 0)
+            {
+                layer.assignPolygons(numPolyX, polyX, polyY, numStarts, polyStart, polyDatatype, slicedRanges);
+                layer.setFlattenedPolygonRanges(polyRanges);
+            }
+        }
+        layout.setBoundary(boundary.xLo(), boundary.yLo(), boundary.xHi(), boundary.yHi());
+    }
+
+    /// @brief write a circuit
+    /// @param first: the writer
+    /// @param second: the circuit
+    /// @param third: the indices in the sub design written, for remapping the sub circuits and the properties. nullptr to keep them
+    void writeCkt(CheckpointWriter &out, const CktGraph &ckt, const SubDesignMap *map = nullptr)
+    {
+        out.str(ckt.name());
+        out.pod(static_cast<std::uint32_t>(ckt.implType()));
+        out.pod(map != nullptr ? map->implIdx(ckt) : ckt.implIdx());
+        out.flag(ckt.isImpl());
+        out.flag(ckt.flipVertFlag());
+        out.str(ckt.gdsData().gdsFile());
+        out.box(ckt.gdsData().bbox());
+        // Nodes, with their pins packed after them
+        std::vector<IndexType> start(1, 0), packed;
+        out.pod(static_cast<std::uint32_t>(ckt.numNodes()));
+        for (const auto &node : ckt.nodeArray())
+        {
+            out.pod(map != nullptr && !node.isLeaf() ? map->cktIdx.at(node.subgraphIdx()) : node.subgraphIdx());
+            out.pod(node.offset().x());
+            out.pod(node.offset().y());
+            out.pod(static_cast<std::uint32_t>(node.orient()));
+            out.flag(node.isImpl());
+            out.flag(node.flipVertFlag());
+            out.pod(static_cast<std::uint32_t>(node.implType()));
+            out.str(node.refName());
+            out.str(node.name());
+            packed.insert(packed.end(), node.pinIdxArray().begin(), node.pinIdxArray().end());
+            start.emplace_back(packed.size());
+        }
+        out.array(start);
+        out.array(packed);
+        // Pins
+        out.pod(static_cast<std::uint32_t>(ckt.numPins()));
+        for (const auto &pin : ckt.pinArray())
+        {
+            out.pod(static_cast<std::uint32_t>(pin.pinType()));
+            out.pod(pin.nodeIdx());
+            out.pod(pin.intNetIdx());
+            out.pod(pin.netIdx());
+            out.flag(pin.valid());
+            std::vector<IndexType> rects;
+            for (IndexType idx = 0; idx < pin.numLayoutRects(); ++idx)
+            {
+                rects.emplace_back(pin.layoutRectIdx(idx));
+            }
+            out.array(rects);
+        }
+        // Nets, with their pins and substrate pins packed after them
+        std::vector<IndexType> subStart(1, 0), subPacked;
+        start.assign(1, 0);
+        packed.clear();
+        out.pod(static_cast<std::uint32_t>(ckt.numNets()));
+        for (const auto &net : ckt.netArray())
+        {
+            out.str(net.name());
+            out.pod(net.ioPos());
+            out.flag(net.isVdd());
+            out.flag(net.isVss());
+            out.flag(net.isDigital());
+            out.flag(net.isAnalog());
+            std::vector<IoPinConfigure> ios = net.ioInterfaces();
+            out.pod(static_cast<std::uint32_t>(ios.size()));
+            for (const auto &io : ios)
+            {
+                out.box(io.shape);
+                out.pod(io.layer);
+                out.pod(io.isPowerStripe);
+            }
+            packed.insert(packed.end(), net.pinIdxArray().begin(), net.pinIdxArray().end());
+            start.emplace_back(packed.size());
+            subPacked.insert(subPacked.end(), net.subIdxArray().begin(), net.subIdxArray().end());
+            subStart.emplace_back(subPacked.size());
+        }
+        out.array(start);
+        out.array(packed);
+        out.array(subStart);
+        out.array(subPacked);
+        std::vector<IndexType> psubs, nwells;
+        for (IndexType idx = 0; idx < ckt.numPsubs(); ++idx)
+        {
+            psubs.emplace_back(ckt.psubIdx(idx));
+        }
+        for (IndexType idx = 0; idx < ckt.numNwells(); ++idx)
+        {
+            nwells.emplace_back(ckt.nwellIdx(idx));
+        }
+        out.array(psubs);
+        out.array(nwells);
+        // The lazily allocated members are saved only if allocated
+        out.flag(ckt.hasConstraint());
+        if (ckt.hasConstraint())
+        {
+            writeConstraint(out, ckt.constraint());
+        }
+        out.flag(ckt.hasLayout());
+        if (ckt.hasLayout())
+        {
+            writeLayout(out, ckt.layout());
+        }
+    }
+
+    void readCkt(CheckpointReader &in, CktGraph &ckt)
+    {
+        ckt.setName(in.str());
+        ckt.setImplType(static_cast<ImplType>(in.pod<std::uint32_t>()));
+        ckt.setImplIdx(in.pod<IndexType>());
+        ckt.setIsImpl(in.flag());
+        ckt.setFlipVertFlag(in.flag());
+        ckt.gdsData().setGdsFile(in.str());
+        Box<LocType> bbox = in.box();
+        ckt.gdsData().setBBox(bbox.xLo(), bbox.yLo(), bbox.xHi(), bbox.yHi());
+        // Nodes
+        std::uint32_t numNodes = in.count(MIN_NODE_BYTES);
+        ckt.nodeArray().reserve(numNodes);
+        for (std::uint32_t nodeIdx = 0; nodeIdx < numNodes && in.good(); ++nodeIdx)
+        {
+            CktNode &node = ckt.node(ckt.allocateNode());
+            node.setSubgraphIdx(in.pod<IndexType>());
+            LocType x = in.pod<LocType>();
+            LocType y = in.pod<LocType>();
+            node.setOffset(x, y);
+            node.setOrient(static_cast<OriType>(in.pod<std::uint32_t>()));
+            node.setIsImpl(in.flag());
+            node.setFlipVertFlag(in.flag());
+            node.setImplType(static_cast<ImplType>(in.pod<std::uint32_t>()));
+            node.setRefName(in.str());
+            node.setName(in.str());
+        }
+        std::vector<IndexType> nodePinStart = in.vector<IndexType>();
+        std::vector<IndexType> nodePins = in.vector<IndexType>();
+        // Pins
+        std::uint32_t numPins = in.count(MIN_PIN_BYTES);
+        ckt.pinArray().reserve(numPins);
+        for (std::uint32_t pinIdx = 0; pinIdx < numPins && in.good(); ++pinIdx)
+        {
+            Pin &pin = ckt.pin(ckt.allocatePin());
+            pin.setPinType(static_cast<PinType>(in.pod<std::uint32_t>()));
+            pin.setNodeIdx(in.pod<IndexType>());
+            pin.setIntNetIdx(in.pod<IndexType>());
+            pin.setNetIdx(in.pod<IndexType>());
+            pin.setValid(in.flag());
+            for (IndexType rectIdx : in.vector<IndexType>())
+            {
+                pin.addLayoutRectIdx(rectIdx);
+            }
+        }
+        // Nets
+        std::uint32_t numNets = in.count(MIN_NET_BYTES);
+        ckt.netArray().reserve(numNets);
+        for (std::uint32_t netIdx = 0; netIdx < numNets && in.good(); ++netIdx)
+        {
+            Net &net = ckt.net(ckt.allocateNet());
+            net.setName(in.str());
+            net.setIoPos(in.pod<IndexType>());
+            if (in.flag()) { net.markVddFlag(); }
+            if (in.flag()) { net.markVssFlag(); }
+            if (in.flag()) { net.markDigitalFlag(); }
+            if (in.flag()) { net.markAnalogFlag(); }
+            std::vector<IoPinConfigure> ios(in.count(MIN_IO_BYTES));
+            for (auto &io : ios)
+            {
+                io.shape = in.box();
+                io.layer = in.pod<IndexType>();
+                io.isPowerStripe = in.pod<IntType>();
+            }
+            if (!ios.empty())
+            {
+                net.setIoInterfaces(ios);
+            }
+        }
+        std::vector<IndexType> netPinStart = in.vector<IndexType>();
+        std::vector<IndexType> netPins = in.vector<IndexType>();
+        std::vector<IndexType> netSubStart = in.vector<IndexType>();
+        std::vector<IndexType> netSubs = in.vector<IndexType>();
+        for (IndexType netIdx : in.vector<IndexType>())
+        {
+            ckt.addPsubIdx(netIdx);
+        }
+        for (IndexType netIdx : in.vector<IndexType>())
+        {
+            ckt.addNwellIdx(netIdx);
+        }
+        if (!in.good())
+        {
+            return;
+        }
+        if (nodePinStart.size() != ckt.numNodes() + 1 || nodePinStart.back() != nodePins.size()
+            || netPinStart.size() != ckt.numNets() + 1 || netPinStart.back() != netPins.size()
+            || netSubStart.size() != ckt.numNets() + 1 || netSubStart.back() != netSubs.size())
+        {
+            ERR("DesignCheckpoint: inconsistent connectivity of circuit %s \n", ckt.name().c_str());
+            in.fail();
+            return;
+        }
+        ckt.assignConnectivity(std::move(nodePinStart), std::move(nodePins), std::move(netPinStart), std::move(netPins),
+                std::move(netSubStart), std::move(netSubs));
+        if (in.flag())
+        {
+            readConstraint(in, ckt.constraint());
+        }
+        if (in.flag())
+        {
+            readLayout(in, ckt.layout());
+        }
+    }
+
+    /// @brief the implementation of a circuit in a subtree snapshot, read in full before any circuit is changed
+    struct CktImpl
+    {
+        /// @brief the placement of a node
+        struct NodeImpl
+        {
+            XY<LocType> offset;
+            OriType orient = OriType::N;
+            bool isImpl = false;
+            bool flipVertFlag = false;
+        };
+        std::string name;
+        std::uint32_t numNodes = 0;
+        std::uint32_t numPins = 0;
+        std::uint32_t numNets = 0;
+        bool isImpl = false;
+        bool flipVertFlag = false;
+        std::string gdsFile;
+        Box<LocType> bbox;
+        std::vector<NodeImpl> nodes;
+        std::vector<std::vector<IndexType>> pinRects;
+        std::vector<std::vector<IoPinConfigure>> netIos;
+        bool hasConstraint = false;
+        CktConstraint constraint;
+        bool hasLayout = false;
+        Layout layout;
+    };
+
+    void writeCktImpl(CheckpointWriter &out, const CktGraph &ckt)
+    {
+        out.str(ckt.name());
+        out.pod(static_cast<std::uint32_t>(ckt.numNodes()));
+        out.pod(static_cast<std::uint32_t>(ckt.numPins()));
+        out.pod(static_cast<std::uint32_t>(ckt.numNets()));
+        out.flag(ckt.isImpl());
+        out.flag(ckt.flipVertFlag());
+        out.str(ckt.gdsData().gdsFile());
+        out.box(ckt.gdsData().bbox());
+        for (const auto &node : ckt.nodeArray())
+        {
+            out.pod(node.offset().x());
+            out.pod(node.offset().y());
+            out.pod(static_cast<std::uint32_t>(node.orient()));
+            out.flag(node.isImpl());
+            out.flag(node.flipVertFlag());
+        }
+        for (const auto &pin : ckt.pinArray())
+        {
+            std::vector<IndexType> rects;
+            for (IndexType idx = 0; idx < pin.numLayoutRects(); ++idx)
+            {
+                rects.emplace_back(pin.layoutRectIdx(idx));
+            }
+            out.array(rects);
+        }
+        for (const auto &net : ckt.netArray())
+        {
+            std::vector<IoPinConfigure> ios = net.ioInterfaces();
+            out.pod(static_cast<std::uint32_t>(ios.size()));
+            for (const auto &io : ios)
+            {
+                out.box(io.shape);
+                out.pod(io.layer);
+                out.pod(io.isPowerStripe);
+            }
+        }
+        out.flag(ckt.hasConstraint());
+        if (ckt.hasConstraint())
+        {
+            writeConstraint(out, ckt.constraint());
+        }
+        out.flag(ckt.hasLayout());
+        if (ckt.hasLayout())
+        {
+            writeLayout(out, ckt.layout());
+        }
+    }
+
+    void readCktImpl(CheckpointReader &in, CktImpl &impl)
+    {
+        impl.name = in.str();
+        impl.numNodes = in.count(MIN_NODE_IMPL_BYTES);
+        impl.numPins = in.count(MIN_NAME_BYTES);
+        impl.numNets = in.count(MIN_NAME_BYTES);
+        impl.isImpl = in.flag();
+        impl.flipVertFlag = in.flag();
+        impl.gdsFile = in.str();
+        impl.bbox = in.box();
+        impl.nodes.resize(in.good() ? impl.numNodes : 0);
+        for (auto &node : impl.nodes)
+        {
+            LocType x = in.pod<LocType>();
+            LocType y = in.pod<LocType>();
+            node.offset = XY<LocType>(x, y);
+            node.orient = static_cast<OriType>(in.pod<std::uint32_t>());
+            node.isImpl = in.flag();
+            node.flipVertFlag = in.flag();
+        }
+        impl.pinRects.resize(in.good() ? impl.numPins : 0);
+        for (auto &rects : impl.pinRects)
+        {
+            rects = in.vector<IndexType>();
+        }
+        impl.netIos.resize(in.good() ? impl.numNets : 0);
+        for (auto &ios : impl.netIos)
+        {
+            ios.resize(in.count(MIN_IO_BYTES));
+            for (auto &io : ios)
+            {
+                io.shape = in.box();
+                io.layer = in.pod<IndexType>();
+                io.isPowerStripe = in.pod<IntType>();
+            }
+        }
+        impl.hasConstraint = in.flag();
+        if (impl.hasConstraint)
+        {
+            readConstraint(in, impl.constraint);
+        }
+        impl.hasLayout = in.flag();
+        if (impl.hasLayout)
+        {
+            readLayout(in, impl.layout);
+        }
+    }
+
+    void applyCktImpl(CktImpl &impl, CktGraph &ckt)
+    {
+        ckt.setIsImpl(impl.isImpl);
+        ckt.setFlipVertFlag(impl.flipVertFlag);
+        ckt.gdsData().setGdsFile(impl.gdsFile);
+        ckt.gdsData().setBBox(impl.bbox.xLo(), impl.bbox.yLo(), impl.bbox.xHi(), impl.bbox.yHi());
+        for (IndexType nodeIdx = 0; nodeIdx < ckt.numNodes(); ++nodeIdx)
+        {
+            CktNode &node = ckt.node(nodeIdx);
+            const auto &nodeImpl = impl.nodes[nodeIdx];
+            node.setOffset(nodeImpl.offset.x(), nodeImpl.offset.y());
+            node.setOrient(nodeImpl.orient);
+            node.setIsImpl(nodeImpl.isImpl);
+            node.setFlipVertFlag(nodeImpl.flipVertFlag);
+        }
+        for (IndexType pinIdx = 0; pinIdx < ckt.numPins(); ++pinIdx)
+        {
+            Pin &pin = ckt.pin(pinIdx);
+            pin.clearLayoutRectIdx();
+            for (IndexType rectIdx : impl.pinRects[pinIdx])
+            {
+                pin.addLayoutRectIdx(rectIdx);
+            }
+        }
+        for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+        {
+            if (!impl.netIos[netIdx].empty())
+            {
+                ckt.net(netIdx).setIoInterfaces(impl.netIos[netIdx]);
+            }
+        }
+        if (impl.hasConstraint)
+        {
+            ckt.constraint() = std::move(impl.constraint);
+        }
+        if (impl.hasLayout)
+        {
+            ckt.layout() = std::move(impl.layout);
+        }
+    }
+
+    /// @brief write a file through a temporary one, renamed when complete
+    /// @param first: the file name
+    /// @param second: the first bytes of the file
+    /// @param third: the version of the format
+    /// @param fourth: the writer of the records after the header
+    /// @return whether successful
+    template<typename Body>
+    bool writeFile(const std::string &fileName, const char (&magic)[8], std::uint32_t version, Body body)
+    {
+        std::string tmpName = fileName + ".tmp";
+        {
+            std::ofstream os(tmpName, std::ios::binary);
+            if (!os)
+            {
+                ERR("DesignCheckpoint: cannot write %s \n", tmpName.c_str());
+                return false;
+            }
+            CheckpointWriter out(os);
+            for (char c : magic)
+            {
+                out.pod(c);
+            }
+            out.pod(version);
+            out.pod(BYTE_ORDER_MARK);
+            body(out);
+            if (!out.good())
+            {
+                ERR("DesignCheckpoint: failed to write %s \n", tmpName.c_str());
+                std::remove(tmpName.c_str());
+                return false;
+            }
+        }
+        if (std::rename(tmpName.c_str(), fileName.c_str()) != 0)
+        {
+            ERR("DesignCheckpoint: cannot rename %s to %s \n", tmpName.c_str(), fileName.c_str());
+            std::remove(tmpName.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /// @brief check the header of a mapped file and skip it
+    /// @param first: the reader at the beginning of the file
+    /// @param second: the file name, for the messages
+    /// @param third: the expected first bytes
+    /// @param fourth: the expected version
+    /// @param fifth: the kind of the file, for the messages
+    /// @return whether the header matches
+    bool readHeader(CheckpointReader &in, const std::string &fileName, const char (&magic)[8], std::uint32_t version, const char *kind)
+    {
+        for (char c : magic)
+        {
+            if (in.pod<char>() != c)
+            {
+                ERR("DesignCheckpoint: %s is not a %s \n", fileName.c_str(), kind);
+                return false;
+            }
+        }
+        std::uint32_t fileVersion = in.pod<std::uint32_t>();
+        std::uint32_t byteOrder = in.pod<std::uint32_t>();
+        if (fileVersion != version || byteOrder != BYTE_ORDER_MARK)
+        {
+            ERR("DesignCheckpoint: %s has version %u, expecting %u on a machine of the same byte order \n", fileName.c_str(), fileVersion, version);
+            return false;
+        }
+        return true;
+    }
+}
+
+constexpr std::uint32_t DesignCheckpoint::VERSION;
+constexpr std::uint32_t DesignCheckpoint::SUBTREE_VERSION;
+
+bool DesignCheckpoint::save(const DesignDB &designDB, const std::string &fileName)
+{
+    return writeFile(fileName, CHECKPOINT_MAGIC, VERSION, [&](CheckpointWriter &out)
+    {
+        out.pod(static_cast<std::uint32_t>(designDB.rootCktIdx()));
+        out.pod(static_cast<std::uint32_t>(designDB.power.size()));
+        for (const auto &name : designDB.power)
+        {
+            out.str(name);
+        }
+        out.pod(static_cast<std::uint32_t>(designDB.ground.size()));
+        for (const auto &name : designDB.ground)
+        {
+            out.str(name);
+        }
+        writePhyProps(out, designDB.phyPropDB());
+        out.pod(static_cast<std::uint32_t>(designDB.numCkts()));
+        for (const auto &ckt : designDB.ckts())
+        {
+            writeCkt(out, ckt);
+        }
+    });
+}
+
+bool DesignCheckpoint::load(DesignDB &designDB, const std::string &fileName)
+{
+    const PhyPropDB &props = designDB.phyPropDB();
+    if (designDB.numCkts() != 0 || props.numNch() + props.numPch() + props.numRes() + props.numCap() != 0)
+    {
+        ERR("DesignCheckpoint: loading %s into a design which is not empty \n", fileName.c_str());
+        return false;
+    }
+    MappedFile file(fileName);
+    if (file.data() == nullptr)
+    {
+        ERR("DesignCheckpoint: cannot map %s \n", fileName.c_str());
+        return false;
+    }
+    CheckpointReader in(file.data(), file.size());
+    if (!readHeader(in, fileName, CHECKPOINT_MAGIC, VERSION, "design checkpoint"))
+    {
+        return false;
+    }
+    in.pod<std::uint32_t>(); // The root is found again below
+    std::vector<std::string> power(in.count(MIN_NAME_BYTES));
+    for (auto &name : power)
+    {
+        name = in.str();
+    }
+    std::vector<std::string> ground(in.count(MIN_NAME_BYTES));
+    for (auto &name : ground)
+    {
+        name = in.str();
+    }
+    readPhyProps(in, designDB.phyPropDB());
+    std::uint32_t numCkts = in.count(MIN_CKT_BYTES);
+    for (std::uint32_t cktIdx = 0; cktIdx < numCkts && in.good(); ++cktIdx)
+    {
+        readCkt(in, designDB.subCkt(designDB.allocateCkt()));
+    }
+    if (!in.good())
+    {
+        ERR("DesignCheckpoint: %s is truncated or inconsistent \n", fileName.c_str());
+        // Back to the empty design it was
+        designDB.resizeSubCkts(0);
+        designDB.phyPropDB().clear();
+        return false;
+    }
+    designDB.power = std::move(power);
+    designDB.ground = std::move(ground);
+    designDB.findRootCkt();
+    return true;
+}
+
+std::vector<IndexType> DesignCheckpoint::subtree(const DesignDB &designDB, IndexType cktIdx)
+{
+    const auto &hierarchy = designDB.hierarchy();
+    std::vector<IndexType> order;
+    std::vector<char> visited(designDB.numCkts(), 0);
+    std::vector<IndexType> stack(1, cktIdx);
+    while (!stack.empty())
+    {
+        IndexType curIdx = stack.back();
+        stack.pop_back();
+        if (visited[curIdx])
+        {
+            continue;
+        }
+        visited[curIdx] = 1;
+        order.emplace_back(curIdx);
+        const auto children = hierarchy.children(curIdx);
+        stack.insert(stack.end(), children.rbegin(), children.rend());
+    }
+    return order;
+}
+
+bool DesignCheckpoint::saveSubDesign(const DesignDB &designDB, IndexType cktIdx, const std::string &fileName)
+{
+    SubDesignMap map;
+    map.ckts = subtree(designDB, cktIdx);
+    map.cktIdx.assign(designDB.numCkts(), INDEX_TYPE_MAX);
+    for (IndexType pos = 0; pos < map.ckts.size(); ++pos)
+    {
+        map.cktIdx[map.ckts[pos]] = pos;
+    }
+    const PhyPropDB &props = designDB.phyPropDB();
+    map.propIdx[0].assign(props.numNch(), INDEX_TYPE_MAX);
+    map.propIdx[1].assign(props.numPch(), INDEX_TYPE_MAX);
+    map.propIdx[2].assign(props.numRes(), INDEX_TYPE_MAX);
+    map.propIdx[3].assign(props.numCap(), INDEX_TYPE_MAX);
+    for (IndexType subIdx : map.ckts)
+    {
+        const CktGraph &ckt = designDB.subCkt(subIdx);
+        IntType kind = PhyPropDB::propKind(ckt.implType());
+        if (kind < 0 || ckt.implIdx() >= map.propIdx[kind].size() || map.propIdx[kind][ckt.implIdx()] != INDEX_TYPE_MAX)
+        {
+            continue;
+        }
+        map.propIdx[kind][ckt.implIdx()] = map.props[kind].size();
+        map.props[kind].emplace_back(ckt.implIdx());
+    }
+    return writeFile(fileName, CHECKPOINT_MAGIC, VERSION, [&](CheckpointWriter &out)
+    {
+        out.pod(static_cast<std::uint32_t>(0));
+        out.pod(static_cast<std::uint32_t>(designDB.power.size()));
+        for (const auto &name : designDB.power)
+        {
+            out.str(name);
+        }
+        out.pod(static_cast<std::uint32_t>(designDB.ground.size()));
+        for (const auto &name : designDB.ground)
+        {
+            out.str(name);
+        }
+        writePhyProps(out, props, map);
+        out.pod(static_cast<std::uint32_t>(map.ckts.size()));
+        for (IndexType subIdx : map.ckts)
+        {
+            writeCkt(out, designDB.subCkt(subIdx), &map);
+        }
+    });
+}
+
+bool DesignCheckpoint::saveSubtree(const DesignDB &designDB, IndexType cktIdx, const std::string &fileName)
+{
+    const auto order = subtree(designDB, cktIdx);
+    return writeFile(fileName, SUBTREE_MAGIC, SUBTREE_VERSION, [&](CheckpointWriter &out)
+    {
+        out.pod(static_cast<std::uint32_t>(order.size()));
+        for (IndexType subIdx : order)
+        {
+            writeCktImpl(out, designDB.subCkt(subIdx));
+        }
+    });
+}
+
+bool DesignCheckpoint::loadSubtree(DesignDB &designDB, IndexType cktIdx, const std::string &fileName)
+{
+    MappedFile file(fileName);
+    if (file.data() == nullptr)
+    {
+        return false; // A miss is not an error
+    }
+    CheckpointReader in(file.data(), file.size());
+    if (!readHeader(in, fileName, SUBTREE_MAGIC, SUBTREE_VERSION, "subtree snapshot"))
+    {
+        return false;
+    }
+    const auto order = subtree(designDB, cktIdx);
+    if (in.count(MIN_NAME_BYTES) != order.size())
+    {
+        WRN("DesignCheckpoint: %s has another hierarchy under circuit %s \n", fileName.c_str(), designDB.subCkt(cktIdx).name().c_str());
+        return false;
+    }
+    std::vector<CktImpl> impls(order.size());
+    for (IndexType pos = 0; pos < order.size() && in.good(); ++pos)
+    {
+        readCktImpl(in, impls[pos]);
+        const auto &ckt = designDB.subCkt(order[pos]);
+        const auto &impl = impls[pos];
+        if (in.good() && (impl.name != ckt.name() || impl.numNodes != ckt.numNodes() || impl.numPins != ckt.numPins() || impl.numNets != ckt.numNets()))
+        {
+            WRN("DesignCheckpoint: %s has another circuit %s in place of %s \n", fileName.c_str(), impl.name.c_str(), ckt.name().c_str());
+            return false;
+        }
+    }
+    if (!in.good())
+    {
+        ERR("DesignCheckpoint: %s is truncated \n", fileName.c_str());
+        return false;
+    }
+    for (IndexType pos = 0; pos < order.size(); ++pos)
+    {
+        applyCktImpl(impls[pos], designDB.subCkt(order[pos]));
+        designDB.invalidateNetPinShapes(order[pos]);
+    }
+    return true;
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,71 @@
+/**
+ * @file DesignCheckpoint.h
+ * @brief Binary snapshot of the DesignDB, for resuming the flow after a stage
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_DESIGN_CHECKPOINT_H_
+#define MAGICAL_FLOW_DESIGN_CHECKPOINT_H_
+
+#include <string>
+#include <vector>
+#include "global/global.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+class DesignDB;
+
+/// @class MAGICAL_FLOW::DesignCheckpoint
+/// @brief Save and load the circuits, nodes, pins, nets, io interfaces, constraints, layouts and physical properties of a DesignDB.
+/// The arrays are stored as they are in memory and aligned in the file, so that loading maps the file and copies them in bulk:
+/// the connectivity as the packed arrays of CktGraph::compactConnectivity, and the rectangles and the polygons as the coordinate arrays of each layer.
+/// The technology database and the device layout cache are not saved: set the technology again after loading.
+/// A subtree snapshot keeps only the results of implementing a circuit and the circuits under it, for restoring them into the same circuits of another run:
+/// the implemented flags, the placement of the nodes, the io pins of the nets, the constraints and the layouts.
+/// A sub design is a checkpoint of the subtree of a circuit alone, for implementing it in another process: the circuits of the subtree and the physical properties they use, renumbered from the circuit as the root.
+/// The implementation of its root is returned as a subtree snapshot, which loadSubtree merges back into the circuit of the full design
+class DesignCheckpoint
+{
+    public:
+        /// @brief the format version. Files of other versions are rejected
+        static constexpr std::uint32_t VERSION = 2;
+        /// @brief the format version of the subtree snapshots. Files of other versions are rejected
+        static constexpr std::uint32_t SUBTREE_VERSION = 2;
+        /// @brief write a snapshot of a design
+        /// @param first: the design
+        /// @param second: the file name. Written into a temporary file first, and renamed when complete
+        /// @return whether successful
+        static bool save(const DesignDB &designDB, const std::string &fileName);
+        /// @brief read a snapshot into a design
+        /// @param first: the design. Should have no circuits and no physical properties
+        /// @param second: the file name
+        /// @return whether successful. A truncated or inconsistent file fails the load, and the design is left empty
+        static bool load(DesignDB &designDB, const std::string &fileName);
+        /// @brief get the circuits of the subtree of a circuit: the circuit, then the distinct circuits under it in the depth-first pre-order
+        /// @param first: the design
+        /// @param second: the index of the circuit
+        /// @return the circuits
+        static std::vector<IndexType> subtree(const DesignDB &designDB, IndexType cktIdx);
+        /// @brief write the subtree of a circuit as a design checkpoint of its own, readable by load
+        /// @param first: the design
+        /// @param second: the index of the circuit, which is the circuit 0 and the root of the sub design
+        /// @param third: the file name. Written into a temporary file first, and renamed when complete
+        /// @return whether successful
+        static bool saveSubDesign(const DesignDB &designDB, IndexType cktIdx, const std::string &fileName);
+        /// @brief write the implementation of the subtree of a circuit
+        /// @param first: the design
+        /// @param second: the index of the circuit
+        /// @param third: the file name. Written into a temporary file first, and renamed when complete
+        /// @return whether successful
+        static bool saveSubtree(const DesignDB &designDB, IndexType cktIdx, const std::string &fileName);
+        /// @brief read the implementation of the subtree of a circuit. The circuits are checked to have the same names, nodes, pins and nets as when saved
+        /// @param first: the design
+        /// @param second: the index of the circuit
+        /// @param third: the file name
+        /// @return whether successful. On failure, the design is not changed
+        static bool loadSubtree(DesignDB &designDB, IndexType cktIdx, const std::string &fileName);
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_DESIGN_CHECKPOINT_H_
@@ -5,6 +5,8 @@
  */
 
 #include "db/DesignDB.h"
+#include "db/DesignCheckpoint.h"
+#include "util/Tracer.h"
 #include <unordered_map>
 
 PROJECT_NAMESPACE_BEGIN
@@ -59,7 +61,145 @@ bool DesignDB::findRootCkt()
     }
 
     _rootCkt = sortStack.top();
+    // The nodes are usually connected to their sub circuits in place before this call
+    this->invalidateHierarchy();
     return true;
 }
 
+const CktHierarchy & DesignDB::hierarchy() const
+{
+    std::uint64_t revision = 0;
+    for (const auto &ckt : _ckts)
+    {
+        revision += ckt.nodeRevision();
+    }
+    if (!_hierarchyValid || revision != _hierarchyRevision)
+    {
+        _hierarchy.build(_ckts);
+        _hierarchyRevision = revision;
+        _hierarchyValid = true;
+    }
+    return _hierarchy;
+}
+
+std::shared_ptr<const NetPinShapes> DesignDB::netPinShapes(IndexType cktIdx) const
+{
+    AssertMsg(cktIdx < _ckts.size(), "%s: circuit %u does not exist \n", __FUNCTION__, cktIdx);
+    std::uint64_t signature = NetPinShapes::placementSignature(_ckts, cktIdx);
+    std::lock_guard<std::mutex> lock(_netPinShapesMutex);
+    if (_netPinShapes.size() < _ckts.size())
+    {
+        _netPinShapes.resize(_ckts.size());
+    }
+    auto &cached = _netPinShapes[cktIdx];
+    if (!cached || cached->signature() != signature)
+    {
+        auto shapes = std::make_shared<NetPinShapes>();
+        shapes->resolve(_ckts, cktIdx);
+        cached = std::move(shapes);
+    }
+    return cached;
+}
+
+void DesignDB::invalidateNetPinShapes(IndexType cktIdx)
+{
+    std::lock_guard<std::mutex> lock(_netPinShapesMutex);
+    if (cktIdx < _netPinShapes.size())
+    {
+        _netPinShapes[cktIdx].reset();
+    }
+}
+
+bool DesignDB::saveCheckpoint(const std::string &fileName) const
+{
+    ScopedTimer timer("saveCheckpoint", "checkpoint");
+    return DesignCheckpoint::save(*this, fileName);
+}
+
+bool DesignDB::loadCheckpoint(const std::string &fileName)
+{
+    ScopedTimer timer("loadCheckpoint", "checkpoint");
+    return DesignCheckpoint::load(*this, fileName);
+}
+
+bool DesignDB::saveSubDesignCheckpoint(IndexType cktIdx, const std::string &fileName) const
+{
+    ScopedTimer timer("saveSubDesignCheckpoint", "checkpoint");
+    return DesignCheckpoint::saveSubDesign(*this, cktIdx, fileName);
+}
+
+bool DesignDB::saveSubtreeCheckpoint(IndexType cktIdx, const std::string &fileName) const
+{
+    return DesignCheckpoint::saveSubtree(*this, cktIdx, fileName);
+}
+
+bool DesignDB::loadSubtreeCheckpoint(IndexType cktIdx, const std::string &fileName)
+{
+    return DesignCheckpoint::loadSubtree(*this, cktIdx, fileName);
+}
+
+InstanceView DesignDB::instanceView(IndexType cktIdx, IndexType nodeIdx) const
+{
+    const auto &node = this->subCkt(cktIdx).node(nodeIdx);
+    AssertMsg(!node.isLeaf(), "%s: node %u of circuit %u is a leaf \n", __FUNCTION__, nodeIdx, cktIdx);
+    AssertMsg(node.subgraphIdx() != cktIdx, "%s: circuit %s instantiates itself \n", __FUNCTION__, this->subCkt(cktIdx).name().c_str());
+    return InstanceView(this->subCkt(node.subgraphIdx()), node);
+}
+
+std::vector<InstanceView> DesignDB::instanceViews(IndexType cktIdx) const
+{
+    const auto &ckt = this->subCkt(cktIdx);
+    std::vector<InstanceView> views;
+    views.reserve(ckt.numNodes());
+    for (IndexType nodeIdx = 0; nodeIdx < ckt.numNodes(); ++nodeIdx)
+    {
+        if (!ckt.node(nodeIdx).isLeaf())
+        {
+            views.emplace_back(this->instanceView(cktIdx, nodeIdx));
+        }
+    }
+    return views;
+}
+
+void DesignDB::insertSubLayouts(IndexType cktIdx, bool copyTexts)
+{
+    auto &ckt = this->subCkt(cktIdx);
+    ScopedTimer timer("insertSubLayouts ", ckt.name(), "layout");
+    ScopedMemoryPeak memory("insertSubLayouts");
+    std::vector<LayoutPlacement> placements;
+    placements.reserve(ckt.numNodes());
+    for (const auto &view : this->instanceViews(cktIdx))
+    {
+        placements.emplace_back(view.placement());
+    }
+    ckt.layout().insertLayouts(placements, copyTexts);
+}
+
+bool DesignDB::restoreDeviceLayout(IndexType cktIdx, bool flipCell)
+{
+    auto &ckt = this->subCkt(cktIdx);
+    std::string key = DeviceLayoutCache::deviceKey(_phyPropDB, ckt, flipCell);
+    if (key.empty())
+    {
+        return false;
+    }
+    return _deviceLayoutCache.restore(key, ckt);
+}
+
+void DesignDB::cacheDeviceLayout(IndexType cktIdx, bool flipCell)
+{
+    const auto &ckt = this->subCkt(cktIdx);
+    _deviceLayoutCache.store(DeviceLayoutCache::deviceKey(_phyPropDB, ckt, flipCell), ckt);
+}
+
+bool DesignDB::cachedDeviceBoundary(IndexType cktIdx, bool flipCell, Box<LocType> &boundary)
+{
+    std::string key = DeviceLayoutCache::deviceKey(_phyPropDB, this->subCkt(cktIdx), flipCell);
+    if (key.empty())
+    {
+        return false;
+    }
+    return _deviceLayoutCache.findBoundary(key, boundary);
+}
+
 PROJECT_NAMESPACE_END
@@ -8,9 +8,16 @@
 #ifndef MAGICAL_FLOW_DESIGN_DB_H_
 #define MAGICAL_FLOW_DESIGN_DB_H_
 
+#include <memory>
+#include <mutex>
 #include "GraphComponents.h"
 #include "CktGraph.h"
+#include "InstanceView.h"
+#include "NetPinShapes.h"
 #include "PhysicalProp.h"
+#include "DeviceLayoutCache.h"
+#include "StdCellLibrary.h"
+#include "CktHierarchy.h"
 
 PROJECT_NAMESPACE_BEGIN
 
@@ -38,23 +45,68 @@ class DesignDB
         IndexType numCkts() const { return _ckts.size(); }
         /// @brief resize the sub ckts
         /// @param the size of the resulting vector
-        void resizeSubCkts(IndexType numCkts) { Assert(numCkts <= _ckts.size()); _ckts.resize(numCkts); }
+        void resizeSubCkts(IndexType numCkts)
+        {
+            Assert(numCkts <= _ckts.size());
+            _ckts.resize(numCkts);
+            this->invalidateHierarchy();
+            std::lock_guard<std::mutex> lock(_netPinShapesMutex);
+            if (_netPinShapes.size() > numCkts)
+            {
+                _netPinShapes.resize(numCkts);
+            }
+        }
         /// @brief get a sub circuit
         /// @param the index of the sub circuit
         /// @return the sub circuit in the hierarchical tree
         CktGraph & subCkt(IndexType idx) { return _ckts.at(idx); }
+        /// @brief get a sub circuit
+        /// @param the index of the sub circuit
+        /// @return the sub circuit in the hierarchical tree
+        const CktGraph & subCkt(IndexType idx) const { return _ckts.at(idx); }
         /// @brief get the index of the root node
         /// @return the index of the root node
         IndexType rootCktIdx() const { return _rootCkt; }
+        /// @brief whether the technology database has been set
+        /// @return whether the technology database has been set
+        bool hasTechDB() const { return _techDB != nullptr; }
+        /// @brief get the technology database
+        /// @return the technology database
+        const TechDB & techDB() const { AssertMsg(_techDB != nullptr, "DesignDB::techDB: the technology database is not set \n"); return *_techDB; }
         /// @brief get PhyPropDB
         /// @return the physical property DB
         PhyPropDB & phyPropDB() { return _phyPropDB; }
+        /// @brief get PhyPropDB
+        /// @return the physical property DB
+        const PhyPropDB & phyPropDB() const { return _phyPropDB; }
+        /// @brief get the cache of the device layouts
+        /// @return the cache of the device layouts
+        DeviceLayoutCache & deviceLayoutCache() { return _deviceLayoutCache; }
+        /// @brief get the standard cells shared by the standard cell circuits
+        /// @return the standard cells
+        StdCellLibrary & stdCellLibrary() { return _stdCellLibrary; }
+        /// @brief get the arena of the node, pin and net arrays of the circuits
+        /// @return the arena
+        const PoolArena & arena() const { return _arena; }
         /*------------------------------*/ 
         /* Vector operation             */
         /*------------------------------*/ 
         /// @brief allocate a new sub circuit 
         /// @return the index of the new sub circuit
-        IndexType allocateCkt() { _ckts.emplace_back(CktGraph()); return _ckts.size() - 1; }
+        IndexType allocateCkt() { _ckts.emplace_back(&_arena); _ckts.back().setTechDB(_techDB); this->invalidateHierarchy(); return _ckts.size() - 1; }
+        /*------------------------------*/ 
+        /* Setters                      */
+        /*------------------------------*/ 
+        /// @brief set the technology database shared by all the circuits. It should not be modified afterwards
+        /// @param the technology database
+        void setTechDB(std::shared_ptr<const TechDB> techDB)
+        {
+            _techDB = std::move(techDB);
+            for (auto &ckt : _ckts)
+            {
+                ckt.setTechDB(_techDB);
+            }
+        }
         
         /*------------------------------*/ 
         /* Maintainence of the hierarch */
@@ -62,6 +114,80 @@ class DesignDB
         /// @brief topological sort of the hierarchical tree. The top level therefore is surely placed at the first level
         /// @return if successful
         bool findRootCkt();
+        /// @brief get the levelized hierarchy, rebuilt if a circuit or a node array has changed since the last call.
+        /// Changing the sub circuit of an existing node is not detected: call CktGraph::touchNodes or invalidateHierarchy afterwards
+        /// @return the levelized hierarchy
+        const CktHierarchy & hierarchy() const;
+        /// @brief drop the cached levelized hierarchy
+        void invalidateHierarchy() { _hierarchyValid = false; }
+        /// @brief pack the pin lists of the nodes and the nets of every circuit, see CktGraph::compactConnectivity
+        void compactConnectivity() { for (auto &ckt : _ckts) { ckt.compactConnectivity(); } }
+        /*------------------------------*/ 
+        /* Checkpoint                   */
+        /*------------------------------*/ 
+        /// @brief write a binary snapshot of this design, see DesignCheckpoint
+        /// @param the file name
+        /// @return whether successful
+        bool saveCheckpoint(const std::string &fileName) const;
+        /// @brief read a binary snapshot into this design, which should be empty. The technology database is not part of it
+        /// @param the file name
+        /// @return whether successful
+        bool loadCheckpoint(const std::string &fileName);
+        /// @brief write a circuit and the circuits under it as a design of their own, see DesignCheckpoint::saveSubDesign
+        /// @param first: the index of the circuit
+        /// @param second: the file name
+        /// @return whether successful
+        bool saveSubDesignCheckpoint(IndexType cktIdx, const std::string &fileName) const;
+        /// @brief write the implementation of a circuit and the circuits under it, see DesignCheckpoint::saveSubtree
+        /// @param first: the index of the circuit
+        /// @param second: the file name
+        /// @return whether successful
+        bool saveSubtreeCheckpoint(IndexType cktIdx, const std::string &fileName) const;
+        /// @brief restore the implementation of a circuit and the circuits under it, see DesignCheckpoint::loadSubtree
+        /// @param first: the index of the circuit
+        /// @param second: the file name
+        /// @return whether successful. The design is not changed otherwise
+        bool loadSubtreeCheckpoint(IndexType cktIdx, const std::string &fileName);
+        /*------------------------------*/ 
+        /* Layout                       */
+        /*------------------------------*/ 
+        /// @brief get the view of a node on its sub circuit, which transforms the geometry of the sub circuit on demand
+        /// @param first: the index of the circuit
+        /// @param second: the index of a node instantiating a sub circuit
+        /// @return the view. Valid until a circuit is added
+        InstanceView instanceView(IndexType cktIdx, IndexType nodeIdx) const;
+        /// @brief get the views of all the nodes of a circuit instantiating a sub circuit, in the order of the nodes
+        /// @param the index of the circuit
+        /// @return the views. Valid until a circuit is added
+        std::vector<InstanceView> instanceViews(IndexType cktIdx) const;
+        /// @brief insert the layouts of all the sub circuits of a circuit into its layout in one batch
+        /// Each node is placed with its offset, orientation and flip vertical flag, as in CktNode::toParentCoord. This materializes instanceViews(cktIdx)
+        /// @param first: the index of the circuit
+        /// @param second: whether to copy the texts of the sub layouts
+        void insertSubLayouts(IndexType cktIdx, bool copyTexts = true);
+        /// @brief get the io pin shapes connected by the nets of a circuit in its coordinates, resolved again if the placement of the circuit has changed since the last call.
+        /// Changing the io shapes of the sub circuits other than by CktGraph::flipVert is not detected: call invalidateNetPinShapes afterwards
+        /// @param the index of the circuit
+        /// @return the pin shapes. The returned object is not changed by the later calls
+        std::shared_ptr<const NetPinShapes> netPinShapes(IndexType cktIdx) const;
+        /// @brief drop the cached pin shapes of a circuit
+        /// @param the index of the circuit
+        void invalidateNetPinShapes(IndexType cktIdx);
+        /// @brief restore the layout of a device circuit from the device layout cache
+        /// @param first: the index of the device circuit
+        /// @param second: whether the device is flipped
+        /// @return whether the layout is found in the cache
+        bool restoreDeviceLayout(IndexType cktIdx, bool flipCell);
+        /// @brief put the layout of a device circuit into the device layout cache
+        /// @param first: the index of the device circuit
+        /// @param second: whether the device is flipped
+        void cacheDeviceLayout(IndexType cktIdx, bool flipCell);
+        /// @brief get the boundary of the cached layout of a device circuit, without restoring it
+        /// @param first: the index of the device circuit
+        /// @param second: whether the device is flipped
+        /// @param third: output the boundary
+        /// @return whether the layout is found in the cache
+        bool cachedDeviceBoundary(IndexType cktIdx, bool flipCell, Box<LocType> &boundary);
         /*------------------------------*/ 
         /* Exposed public python memory */
         /*------------------------------*/ 
@@ -72,9 +198,18 @@ class DesignDB
         /// @return exposed vector of ground names for pybind
         std::vector<std::string> ground;
     private:
+        PoolArena _arena; ///< The node, pin and net arrays of the circuits. Declared first, to be destroyed after the circuits
         std::vector<CktGraph> _ckts; ///< The hierarchical tree of the circuits. Each circuit is represented as a graph.
         IndexType _rootCkt = INDEX_TYPE_MAX; ///< The root node of the hierarchy. Should have only one.
         PhyPropDB _phyPropDB; ///< Store the property of each specific devices
+        DeviceLayoutCache _deviceLayoutCache; ///< The layouts of the devices, shared by the devices with the same properties
+        StdCellLibrary _stdCellLibrary; ///< The layouts of the standard cells, shared by the circuits of a cell
+        std::shared_ptr<const TechDB> _techDB; ///< The technology database shared by all the circuits
+        mutable CktHierarchy _hierarchy; ///< The cached levelized hierarchy
+        mutable bool _hierarchyValid = false; ///< Whether _hierarchy is up to date with _hierarchyRevision
+        mutable std::uint64_t _hierarchyRevision = 0; ///< The sum of the node revisions of the circuits when _hierarchy was built
+        mutable std::vector<std::shared_ptr<const NetPinShapes>> _netPinShapes; ///< The cached pin shapes of the circuits
+        mutable std::mutex _netPinShapesMutex; ///< The circuits may be placed and routed from several threads
 };
 
 PROJECT_NAMESPACE_END
@@ -0,0 +1,402 @@
+/**
+ * @file DeviceLayoutCache.cpp
+ * @brief Cache of the generated device layouts, keyed by the device properties
+ * @date 10/14/2026
+ */
+
+#include "db/DeviceLayoutCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "util/Hash.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the first bytes of a cache entry file, followed by the format version
+    constexpr char ENTRY_MAGIC[8] = {'M', 'F', 'D', 'E', 'V', 'L', 'O', 'C'};
+    constexpr std::uint32_t ENTRY_VERSION = 2;
+
+    /// @brief append a string field to a key. The length prefix keeps the fields unambiguous
+    void appendKeyString(std::ostringstream &oss, const std::string &str)
+    {
+        oss << str.size() << ':' << str << ';';
+    }
+
+    /// @brief the key fields shared by the nch and pch properties
+    void appendMosKey(std::ostringstream &oss, const MosProp &mos)
+    {
+        oss << mos.width() << ';' << mos.length() << ';' << mos.numFingers() << ';' << mos.mult() << ';';
+        appendKeyString(oss, mos.attr());
+        appendKeyString(oss, mos.pinConType());
+        oss << mos.numBulkCon() << ';';
+        for (IndexType idx = 0; idx < mos.numBulkCon(); ++idx)
+        {
+            oss << mos.bulkCon(idx) << ';';
+        }
+    }
+
+    template<typename T>
+    void writePod(std::ostream &os, const T &value) { os.write(reinterpret_cast<const char *>(&value), sizeof(T)); }
+    template<typename T>
+    bool readPod(std::istream &is, T &value) { return static_cast<bool>(is.read(reinterpret_cast<char *>(&value), sizeof(T))); }
+    void writeString(std::ostream &os, const std::string &str)
+    {
+        writePod(os, static_cast<std::uint32_t>(str.size()));
+        os.write(str.data(), str.size());
+    }
+    bool readString(std::istream &is, std::string &str)
+    {
+        std::uint32_t size = 0;
+        if (!readPod(is, size))
+        {
+            return false;
+        }
+        str.resize(size);
+        return size == 0 || static_cast<bool>(is.read(&str[0], size));
+    }
+    void writeBox(std::ostream &os, const Box<LocType> &box)
+    {
+        writePod(os, box.xLo());
+        writePod(os, box.yLo());
+        writePod(os, box.xHi());
+        writePod(os, box.yHi());
+    }
+    bool readBox(std::istream &is, Box<LocType> &box)
+    {
+        LocType xLo, yLo, xHi, yHi;
+        if (!readPod(is, xLo) || !readPod(is, yLo) || !readPod(is, xHi) || !readPod(is, yHi))
+        {
+            return false;
+        }
+        box = Box<LocType>(xLo, yLo, xHi, yHi);
+        return true;
+    }
+}
+
+std::string DeviceLayoutCache::deviceKey(const PhyPropDB &phyPropDB, const CktGraph &ckt, bool flipCell)
+{
+    std::ostringstream oss;
+    switch (ckt.implType())
+    {
+        case ImplType::PCELL_Nch:
+        {
+            oss << "nch;";
+            appendMosKey(oss, phyPropDB.nch(ckt.implIdx()));
+            break;
+        }
+        case ImplType::PCELL_Pch:
+        {
+            oss << "pch;";
+            appendMosKey(oss, phyPropDB.pch(ckt.implIdx()));
+            break;
+        }
+        case ImplType::PCELL_Res:
+        {
+            const ResProp &res = phyPropDB.resister(ckt.implIdx());
+            oss << "res;" << res.wr() << ';' << res.lr() << ';' << res.series() << ';' << res.parallel() << ';' << res.segNum() << ';' << res.segSpace() << ';';
+            appendKeyString(oss, res.attr());
+            break;
+        }
+        case ImplType::PCELL_Cap:
+        {
+            const CapProp &cap = phyPropDB.capacitor(ckt.implIdx());
+            oss << "cap;" << cap.w() << ';' << cap.spacing() << ';' << cap.numFingers() << ';' << cap.lr() << ';' << cap.stm() << ';' << cap.spm()
+                << ';' << cap.multi() << ';' << cap.ftip() << ';';
+            appendKeyString(oss, cap.attr());
+            break;
+        }
+        default: return "";
+    }
+    oss << "flip=" << flipCell;
+    return oss.str();
+}
+
+bool DeviceLayoutCache::restore(const std::string &key, CktGraph &ckt)
+{
+    auto it = _entries.find(key);
+    if (it == _entries.end() && !_cacheDir.empty())
+    {
+        Entry entry;
+        if (this->readEntry(key, entry))
+        {
+            it = _entries.emplace(key, std::move(entry)).first;
+        }
+    }
+    if (it == _entries.end())
+    {
+        ++_numMisses;
+        return false;
+    }
+    const Entry &entry = it->second;
+    if (entry.netNames.size() != ckt.numNets() || entry.layout.numLayers() != ckt.layout().numLayers())
+    {
+        ++_numMisses;
+        return false;
+    }
+    for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+    {
+        if (entry.netNames[netIdx] != ckt.net(netIdx).name())
+        {
+            ++_numMisses;
+            return false;
+        }
+    }
+    ckt.layout() = entry.layout;
+    const Box<LocType> &bbox = entry.bbox;
+    ckt.gdsData().setBBox(bbox.xLo(), bbox.yLo(), bbox.xHi(), bbox.yHi());
+    ckt.gdsData().setGdsFile(entry.gdsFile);
+    for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+    {
+        ckt.net(netIdx).setIoInterfaces(entry.netIos[netIdx]);
+    }
+    ++_numHits;
+    return true;
+}
+
+bool DeviceLayoutCache::findBoundary(const std::string &key, Box<LocType> &boundary)
+{
+    auto it = _entries.find(key);
+    if (it == _entries.end() && !_cacheDir.empty())
+    {
+        Entry entry;
+        if (this->readEntry(key, entry))
+        {
+            it = _entries.emplace(key, std::move(entry)).first;
+        }
+    }
+    if (it == _entries.end())
+    {
+        return false;
+    }
+    const Entry &entry = it->second;
+    boundary = entry.layout.boundary().valid() ? entry.layout.boundary() : entry.bbox;
+    return boundary.valid();
+}
+
+void DeviceLayoutCache::store(const std::string &key, const CktGraph &ckt)
+{
+    if (key.empty())
+    {
+        return;
+    }
+    Entry entry;
+    entry.layout = ckt.layout();
+    entry.bbox = ckt.gdsData().bbox();
+    entry.gdsFile = ckt.gdsData().gdsFile();
+    entry.netNames.reserve(ckt.numNets());
+    entry.netIos.reserve(ckt.numNets());
+    for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+    {
+        entry.netNames.emplace_back(ckt.net(netIdx).name());
+        entry.netIos.emplace_back(ckt.net(netIdx).ioInterfaces());
+    }
+    if (!_cacheDir.empty())
+    {
+        this->writeEntry(key, entry);
+    }
+    _entries[key] = std::move(entry);
+}
+
+std::string DeviceLayoutCache::entryFile(const std::string &key) const
+{
+    // The FNV-1a digest of the key names the entry file
+    std::uint64_t digest = MfHash::FNV_OFFSET;
+    MfHash::mix(digest, key);
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.devlayout", static_cast<unsigned long long>(digest));
+    std::string dir = _cacheDir;
+    if (!dir.empty() && dir.back() != '/')
+    {
+        dir += '/';
+    }
+    return dir + name;
+}
+
+bool DeviceLayoutCache::readEntry(const std::string &key, Entry &entry) const
+{
+    std::ifstream is(this->entryFile(key), std::ios::binary);
+    if (!is)
+    {
+        return false;
+    }
+    char magic[8];
+    std::uint32_t version = 0;
+    if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), ENTRY_MAGIC) || !readPod(is, version) || version != ENTRY_VERSION)
+    {
+        WRN("DeviceLayoutCache: %s is not a device layout cache file \n", this->entryFile(key).c_str());
+        return false;
+    }
+    // A different key with the same hash is a miss
+    std::string fileKey;
+    if (!readString(is, fileKey) || fileKey != key)
+    {
+        return false;
+    }
+    std::uint32_t numLayers = 0, numNets = 0;
+    if (!readBox(is, entry.bbox) || !readString(is, entry.gdsFile) || !readPod(is, numLayers))
+    {
+        return false;
+    }
+    Box<LocType> boundary;
+    if (!readBox(is, boundary))
+    {
+        return false;
+    }
+    entry.layout.init(numLayers);
+    for (IndexType layerIdx = 0; layerIdx < numLayers; ++layerIdx)
+    {
+        std::uint32_t numRects = 0;
+        if (!readPod(is, numRects))
+        {
+            return false;
+        }
+        for (IndexType rectIdx = 0; rectIdx < numRects; ++rectIdx)
+        {
+            Box<LocType> rect;
+            IndexType datatype = 0;
+            if (!readBox(is, rect) || !readPod(is, datatype))
+            {
+                return false;
+            }
+            entry.layout.insertRect(layerIdx, rect);
+            if (datatype != 0)
+            {
+                entry.layout.setRectDatatype(layerIdx, rectIdx, datatype);
+            }
+        }
+        std::uint32_t numPolygons = 0;
+        if (!readPod(is, numPolygons))
+        {
+            return false;
+        }
+        std::vector<XY<LocType>> pts;
+        for (IndexType polyIdx = 0; polyIdx < numPolygons; ++polyIdx)
+        {
+            IndexType datatype = 0;
+            std::uint32_t numPts = 0;
+            if (!readPod(is, datatype) || !readPod(is, numPts) || numPts < 4)
+            {
+                return false;
+            }
+            pts.resize(numPts);
+            for (auto &pt : pts)
+            {
+                LocType x = 0, y = 0;
+                if (!readPod(is, x) || !readPod(is, y))
+                {
+                    return false;
+                }
+                pt = XY<LocType>(x, y);
+            }
+            entry.layout.layer(layerIdx).insertPolygon(pts.begin(), pts.end(), datatype);
+        }
+    }
+    entry.layout.setBoundary(boundary.xLo(), boundary.yLo(), boundary.xHi(), boundary.yHi());
+    if (!readPod(is, numNets))
+    {
+        return false;
+    }
+    entry.netNames.resize(numNets);
+    entry.netIos.resize(numNets);
+    for (IndexType netIdx = 0; netIdx < numNets; ++netIdx)
+    {
+        std::uint32_t numIos = 0;
+        if (!readString(is, entry.netNames[netIdx]) || !readPod(is, numIos) || numIos == 0)
+        {
+            return false;
+        }
+        entry.netIos[netIdx].resize(numIos);
+        for (auto &io : entry.netIos[netIdx])
+        {
+            if (!readBox(is, io.shape) || !readPod(is, io.layer) || !readPod(is, io.isPowerStripe))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void DeviceLayoutCache::writeEntry(const std::string &key, const Entry &entry) const
+{
+    // Write into a temporary file and rename, so that a concurrent run never reads a partial entry
+    std::string fileName = this->entryFile(key);
+    std::string tmpName = fileName + ".tmp";
+    {
+        std::ofstream os(tmpName, std::ios::binary);
+        if (!os)
+        {
+            WRN("DeviceLayoutCache: cannot write %s \n", tmpName.c_str());
+            return;
+        }
+        os.write(ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+        writePod(os, ENTRY_VERSION);
+        writeString(os, key);
+        writeBox(os, entry.bbox);
+        writeString(os, entry.gdsFile);
+        const Layout &layout = entry.layout;
+        writePod(os, static_cast<std::uint32_t>(layout.numLayers()));
+        writeBox(os, layout.boundary());
+        for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); ++layerIdx)
+        {
+            // The polygons are written as they are, and the rectangles sliced from them are skipped
+            const LayoutLayer &layer = layout.layer(layerIdx);
+            writePod(os, static_cast<std::uint32_t>(layer.numPlainRects()));
+            const auto skipped = layer.skippedRectRanges(false);
+            auto rangeIter = skipped.begin();
+            for (IndexType rectIdx = 0; rectIdx < layer.numStoredRects(); ++rectIdx)
+            {
+                while (rangeIter != skipped.end() && rangeIter->second <= rectIdx)
+                {
+                    ++rangeIter;
+                }
+                if (rangeIter != skipped.end() && rangeIter->first <= rectIdx)
+                {
+                    rectIdx = rangeIter->second - 1;
+                    continue;
+                }
+                writeBox(os, layer.box(rectIdx));
+                writePod(os, layer.datatype(rectIdx));
+            }
+            writePod(os, static_cast<std::uint32_t>(layer.numPolygons()));
+            for (IndexType polyIdx = 0; polyIdx < layer.numPolygons(); ++polyIdx)
+            {
+                writePod(os, layer.polygonDatatype(polyIdx));
+                writePod(os, static_cast<std::uint32_t>(layer.numPolygonPoints(polyIdx)));
+                for (IndexType ptIdx = 0; ptIdx < layer.numPolygonPoints(polyIdx); ++ptIdx)
+                {
+                    const XY<LocType> pt = layer.polygonPoint(polyIdx, ptIdx);
+                    writePod(os, pt.x());
+                    writePod(os, pt.y());
+                }
+            }
+        }
+        writePod(os, static_cast<std::uint32_t>(entry.netNames.size()));
+        for (IndexType netIdx = 0; netIdx < entry.netNames.size(); ++netIdx)
+        {
+            writeString(os, entry.netNames[netIdx]);
+            writePod(os, static_cast<std::uint32_t>(entry.netIos[netIdx].size()));
+            for (const auto &io : entry.netIos[netIdx])
+            {
+                writeBox(os, io.shape);
+                writePod(os, io.layer);
+                writePod(os, io.isPowerStripe);
+            }
+        }
+        if (!os)
+        {
+            WRN("DeviceLayoutCache: failed to write %s \n", tmpName.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmpName.c_str(), fileName.c_str()) != 0)
+    {
+        WRN("DeviceLayoutCache: cannot rename %s to %s \n", tmpName.c_str(), fileName.c_str());
+        std::remove(tmpName.c_str());
+    }
+}
+
+PROJECT_NAMESPACE_END
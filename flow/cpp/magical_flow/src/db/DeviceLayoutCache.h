@@ -0,0 +1,90 @@
+/**
+ * @file DeviceLayoutCache.h
+ * @brief Cache of the generated device layouts, keyed by the device properties
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_DEVICE_LAYOUT_CACHE_H_
+#define MAGICAL_FLOW_DEVICE_LAYOUT_CACHE_H_
+
+#include <unordered_map>
+#include "CktGraph.h"
+#include "PhysicalProp.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::DeviceLayoutCache
+/// @brief The parsed layouts of the pcell devices, shared by the devices with the same implementation type, physical properties and flip flag.
+/// An entry keeps the layout, the bounding box, the GDSII file and the io pins of the nets of a device circuit.
+/// If a cache directory is set, the entries are also written there, one file per key, and read back on a miss in later runs
+class DeviceLayoutCache
+{
+    public:
+        /// @brief default constructor
+        explicit DeviceLayoutCache() = default;
+        /// @brief get the key of a device circuit
+        /// @param first: the physical properties
+        /// @param second: the device circuit
+        /// @param third: whether the device is flipped
+        /// @return the key. Empty if the circuit is not a device
+        static std::string deviceKey(const PhyPropDB &phyPropDB, const CktGraph &ckt, bool flipCell);
+        /// @brief restore the layout of a device from the cache
+        /// @param first: the key
+        /// @param second: the device circuit
+        /// @return whether the key is found. The circuit is not changed on a miss
+        bool restore(const std::string &key, CktGraph &ckt);
+        /// @brief put the current layout of a device into the cache
+        /// @param first: the key
+        /// @param second: the device circuit
+        void store(const std::string &key, const CktGraph &ckt);
+        /// @brief get the boundary of a cached device layout without restoring it, as the abstract of the device
+        /// @param first: the key
+        /// @param second: output the boundary of the layout, or the bounding box of its GdsData if the layout has no boundary
+        /// @return whether the key is found. The persisted entry is loaded into memory, but the hits and misses are not counted
+        bool findBoundary(const std::string &key, Box<LocType> &boundary);
+        /// @brief set the directory for persisting the entries. Empty for keeping them in memory only
+        /// @param the directory. Should exist
+        void setCacheDir(const std::string &dir) { _cacheDir = dir; }
+        /// @brief get the directory for persisting the entries
+        /// @return the directory
+        const std::string & cacheDir() const { return _cacheDir; }
+        /// @brief get the number of entries in memory
+        /// @return the number of entries in memory
+        IndexType numEntries() const { return _entries.size(); }
+        /// @brief get the number of cache hits
+        /// @return the number of cache hits
+        IndexType numHits() const { return _numHits; }
+        /// @brief get the number of cache misses
+        /// @return the number of cache misses
+        IndexType numMisses() const { return _numMisses; }
+        /// @brief get the file of a key in the cache directory
+        /// @param the key
+        /// @return the file name
+        std::string entryFile(const std::string &key) const;
+        /// @brief remove the entries in memory. The persisted entries are kept
+        void clear() { _entries.clear(); _numHits = 0; _numMisses = 0; }
+    private:
+        /// @brief a cached device layout
+        struct Entry
+        {
+            Layout layout; ///< The layout
+            Box<LocType> bbox; ///< The bounding box of GdsData
+            std::string gdsFile; ///< The GDSII file of the layout
+            std::vector<std::string> netNames; ///< The names of the nets, for checking that the device has the same nets
+            std::vector<std::vector<IoPinConfigure>> netIos; ///< The io pins of each net
+        };
+        /// @brief read an entry from the cache directory
+        /// @return whether the entry is found and valid
+        bool readEntry(const std::string &key, Entry &entry) const;
+        /// @brief write an entry into the cache directory
+        void writeEntry(const std::string &key, const Entry &entry) const;
+    private:
+        std::unordered_map<std::string, Entry> _entries; ///< The entries in memory
+        std::string _cacheDir = ""; ///< The directory for persisting the entries
+        IndexType _numHits = 0; ///< The number of hits
+        IndexType _numMisses = 0; ///< The number of misses
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_DEVICE_LAYOUT_CACHE_H_
@@ -0,0 +1,378 @@
+/**
+ * @file DrcScreen.cpp
+ * @brief Screen a layout against the width, spacing and area rules of the technology
+ * @date 10/14/2026
+ */
+
+#include "db/DrcScreen.h"
+#include <numeric>
+#include <tuple>
+
+PROJECT_NAMESPACE_BEGIN
+
+constexpr IndexType DrcScreen::PARALLEL_CHECK_THRESHOLD;
+
+IndexType DrcScreen::check(const Layout &layout)
+{
+    _states.assign(layout.numLayers(), LayerState());
+    IndexType totalRects = 0;
+    for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); ++layerIdx)
+    {
+        totalRects += layout.numRects(layerIdx);
+    }
+    // Each layer has its own spatial index and state
+    #pragma omp parallel for schedule(dynamic, 1) if (totalRects >= PARALLEL_CHECK_THRESHOLD)
+    for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); ++layerIdx)
+    {
+        this->checkLayer(layout.layer(layerIdx), layerIdx, nullptr);
+    }
+    this->gather();
+    return this->numViolations();
+}
+
+IndexType DrcScreen::recheck(const Layout &layout, IndexType layerIdx, const std::vector<IndexType> &rectIndices)
+{
+    AssertMsg(layerIdx < layout.numLayers(), "%s: layer %u out of range %u \n", __FUNCTION__, layerIdx, layout.numLayers());
+    _states.resize(layout.numLayers());
+    this->checkLayer(layout.layer(layerIdx), layerIdx, &rectIndices);
+    this->gather();
+    return this->numViolations();
+}
+
+IndexType DrcScreen::recheck(const Layout &layout, const std::vector<std::vector<IndexType>> &rectIndices)
+{
+    _states.resize(layout.numLayers());
+    const std::vector<IndexType> noRects;
+    IndexType totalRects = 0;
+    for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); ++layerIdx)
+    {
+        totalRects += layout.numRects(layerIdx);
+    }
+    #pragma omp parallel for schedule(dynamic, 1) if (totalRects >= PARALLEL_CHECK_THRESHOLD)
+    for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); ++layerIdx)
+    {
+        this->checkLayer(layout.layer(layerIdx), layerIdx, layerIdx < rectIndices.size() ? &rectIndices[layerIdx] : &noRects);
+    }
+    this->gather();
+    return this->numViolations();
+}
+
+void DrcScreen::checkLayer(const LayoutLayer &layer, IndexType layerIdx, const std::vector<IndexType> *moved)
+{
+    static const LayerRule noRule;
+    const LayerRule &rule = layerIdx < _techDB.numLayers() ? _techDB.layerRule(layerIdx) : noRule;
+    auto &state = _states[layerIdx];
+    const IndexType numRects = layer.numRects();
+    if (moved != nullptr && state.checked && state.numRects == numRects && moved->empty())
+    {
+        // Nothing touched
+        return;
+    }
+    if (moved != nullptr && (!state.checked || state.numRects > numRects))
+    {
+        moved = nullptr;
+    }
+    if (moved == nullptr)
+    {
+        state = LayerState();
+    }
+    if (rule.empty())
+    {
+        state.checked = true;
+        state.numRects = numRects;
+        state.shapes.assign(numRects, INDEX_TYPE_MAX);
+        state.violations = LayerViolations();
+        return;
+    }
+    // The rectangles to check again: the moved and the appended ones, the other rectangles of their shapes before the update, and then the shapes they are in now
+    std::vector<char> inScope(numRects, moved == nullptr ? 1 : 0);
+    std::vector<IndexType> seeds;
+    if (moved != nullptr)
+    {
+        std::vector<char> touchedShape(state.numShapes, 0);
+        auto addSeed = [&](IndexType rectIdx)
+        {
+            if (!inScope[rectIdx])
+            {
+                inScope[rectIdx] = 1;
+                seeds.emplace_back(rectIdx);
+            }
+        };
+        for (IndexType rectIdx : *moved)
+        {
+            AssertMsg(rectIdx < numRects, "%s: rectangle %u out of range %u on layer %u \n", __FUNCTION__, rectIdx, numRects, layerIdx);
+            addSeed(rectIdx);
+            if (rectIdx < state.numRects)
+            {
+                touchedShape[state.shapes[rectIdx]] = 1;
+            }
+        }
+        for (IndexType rectIdx = state.numRects; rectIdx < numRects; ++rectIdx)
+        {
+            addSeed(rectIdx);
+        }
+        for (IndexType rectIdx = 0; rectIdx < state.numRects; ++rectIdx)
+        {
+            if (touchedShape[state.shapes[rectIdx]])
+            {
+                addSeed(rectIdx);
+            }
+        }
+    }
+    state.shapes.resize(numRects, INDEX_TYPE_MAX);
+    // Label the shapes in the scope by searching the touching rectangles. scope[shapeStart[k], shapeStart[k + 1]) are the rectangles of the k-th shape
+    const LayerIndex &index = layer.spatialIndex();
+    std::vector<char> visited(numRects, 0);
+    std::vector<IndexType> scope, shapeStart, buffer;
+    auto labelShape = [&](IndexType start)
+    {
+        const IndexType label = state.numShapes++;
+        const IndexType begin = scope.size();
+        shapeStart.emplace_back(begin);
+        visited[start] = 1;
+        scope.emplace_back(start);
+        for (IndexType head = begin; head < scope.size(); ++head)
+        {
+            const IndexType rectIdx = scope[head];
+            state.shapes[rectIdx] = label;
+            inScope[rectIdx] = 1;
+            index.queryOverlap(layer, layer.box(rectIdx), true, buffer);
+            for (IndexType other : buffer)
+            {
+                if (!visited[other])
+                {
+                    visited[other] = 1;
+                    scope.emplace_back(other);
+                }
+            }
+        }
+    };
+    if (moved == nullptr)
+    {
+        for (IndexType rectIdx = 0; rectIdx < numRects; ++rectIdx)
+        {
+            if (!visited[rectIdx])
+            {
+                labelShape(rectIdx);
+            }
+        }
+    }
+    else
+    {
+        for (IndexType rectIdx : seeds)
+        {
+            if (!visited[rectIdx])
+            {
+                labelShape(rectIdx);
+            }
+        }
+    }
+    shapeStart.emplace_back(scope.size());
+    // Drop the old violations in the scope. The shapes outside are untouched, so that a spacing violation involves the scope if and only if one of its rectangles is in it
+    LayerViolations kept;
+    const auto &old = state.violations;
+    for (IndexType idx = 0; idx < old.size(); ++idx)
+    {
+        if (inScope[old.rects[idx]] || (old.otherRects[idx] != INDEX_TYPE_MAX && inScope[old.otherRects[idx]]))
+        {
+            continue;
+        }
+        kept.add(static_cast<DrcViolationType>(old.types[idx]), old.rects[idx], old.otherRects[idx], old.measured[idx], old.required[idx]);
+    }
+    auto &violations = state.violations;
+    violations = std::move(kept);
+    // Width
+    if (rule.minWidth() > 0)
+    {
+        for (IndexType rectIdx : scope)
+        {
+            LocType width = extendedWidth(layer, rectIdx, rule.minWidth(), buffer);
+            if (width < rule.minWidth())
+            {
+                violations.add(DrcViolationType::MIN_WIDTH, rectIdx, INDEX_TYPE_MAX, width, rule.minWidth());
+            }
+        }
+    }
+    // Area
+    if (rule.minArea() > 0)
+    {
+        std::vector<IndexType> rects;
+        for (IndexType shapeIdx = 0; shapeIdx + 1 < shapeStart.size(); ++shapeIdx)
+        {
+            rects.assign(scope.begin() + shapeStart[shapeIdx], scope.begin() + shapeStart[shapeIdx + 1]);
+            // A single large enough rectangle is enough, which skips the union of the large shapes
+            std::int64_t maxArea = 0;
+            for (IndexType rectIdx : rects)
+            {
+                maxArea = std::max(maxArea, static_cast<std::int64_t>(layer.box(rectIdx).xLen()) * layer.box(rectIdx).yLen());
+            }
+            if (maxArea >= rule.minArea())
+            {
+                continue;
+            }
+            std::int64_t area = unionArea(layer, rects);
+            if (area < rule.minArea())
+            {
+                violations.add(DrcViolationType::MIN_AREA, *std::min_element(rects.begin(), rects.end()), INDEX_TYPE_MAX, area, rule.minArea());
+            }
+        }
+    }
+    // Spacing, once per pair of rectangles of different shapes
+    const LocType maxSpacing = rule.maxSpacing();
+    if (maxSpacing > 0)
+    {
+        std::vector<IndexType> others;
+        std::vector<LocType> spacings, widths, runs;
+        for (IndexType rectIdx : scope)
+        {
+            const Box<LocType> box = layer.box(rectIdx);
+            Box<LocType> range = box;
+            range.enlargeBy(maxSpacing);
+            index.queryOverlap(layer, range, false, buffer);
+            others.clear();
+            for (IndexType other : buffer)
+            {
+                if (state.shapes[other] != state.shapes[rectIdx] && !(inScope[other] && other < rectIdx))
+                {
+                    others.emplace_back(other);
+                }
+            }
+            // Measure the pairs in a batch, as klib::boxSpacing, klib::boxWidth and klib::boxParallelRun would
+            spacings.resize(others.size());
+            widths.resize(others.size());
+            runs.resize(others.size());
+            RectKernel::spacing(layer.xLoArray().data(), layer.yLoArray().data(), layer.xHiArray().data(), layer.yHiArray().data(),
+                    others.data(), others.size(), box, spacings.data(), widths.data(), runs.data());
+            for (IndexType idx = 0; idx < others.size(); ++idx)
+            {
+                if (spacings[idx] <= 0)
+                {
+                    continue;
+                }
+                LocType required = rule.spacing(widths[idx], runs[idx]);
+                if (spacings[idx] < required)
+                {
+                    const IndexType other = others[idx];
+                    violations.add(DrcViolationType::MIN_SPACING, std::min(rectIdx, other), std::max(rectIdx, other), spacings[idx], required);
+                }
+            }
+        }
+    }
+    // Sort by type and rectangles, so that the result does not depend on the order of the updates
+    std::vector<IndexType> order(violations.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](IndexType lhs, IndexType rhs)
+            {
+                return std::tie(violations.types[lhs], violations.rects[lhs], violations.otherRects[lhs])
+                    < std::tie(violations.types[rhs], violations.rects[rhs], violations.otherRects[rhs]);
+            });
+    LayerViolations sorted;
+    for (IndexType idx : order)
+    {
+        sorted.add(static_cast<DrcViolationType>(violations.types[idx]), violations.rects[idx], violations.otherRects[idx], violations.measured[idx], violations.required[idx]);
+    }
+    violations = std::move(sorted);
+    state.checked = true;
+    state.numRects = numRects;
+}
+
+LocType DrcScreen::extendedWidth(const LayoutLayer &layer, IndexType rectIdx, LocType minWidth, std::vector<IndexType> &buffer)
+{
+    const Box<LocType> box = layer.box(rectIdx);
+    if (box.xLen() >= minWidth && box.yLen() >= minWidth)
+    {
+        return std::min(box.xLen(), box.yLen());
+    }
+    // The touching rectangles spanning the rectangle in one direction continue it in the other one
+    layer.spatialIndex().queryOverlap(layer, box, true, buffer);
+    LocType xLo = box.xLo(), xHi = box.xHi(), yLo = box.yLo(), yHi = box.yHi();
+    for (IndexType other : buffer)
+    {
+        const Box<LocType> otherBox = layer.box(other);
+        if (otherBox.yLo() <= box.yLo() && otherBox.yHi() >= box.yHi())
+        {
+            xLo = std::min(xLo, otherBox.xLo());
+            xHi = std::max(xHi, otherBox.xHi());
+        }
+        if (otherBox.xLo() <= box.xLo() && otherBox.xHi() >= box.xHi())
+        {
+            yLo = std::min(yLo, otherBox.yLo());
+            yHi = std::max(yHi, otherBox.yHi());
+        }
+    }
+    return std::min(xHi - xLo, yHi - yLo);
+}
+
+std::int64_t DrcScreen::unionArea(const LayoutLayer &layer, const std::vector<IndexType> &rects)
+{
+    // Sum over the slabs between the distinct x coordinates the length of the union of the y intervals
+    std::vector<LocType> xs;
+    for (IndexType rectIdx : rects)
+    {
+        xs.emplace_back(layer.box(rectIdx).xLo());
+        xs.emplace_back(layer.box(rectIdx).xHi());
+    }
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    std::int64_t area = 0;
+    std::vector<std::pair<LocType, LocType>> intervals;
+    for (IndexType slab = 0; slab + 1 < xs.size(); ++slab)
+    {
+        intervals.clear();
+        for (IndexType rectIdx : rects)
+        {
+            const Box<LocType> box = layer.box(rectIdx);
+            if (box.xLo() <= xs[slab] && box.xHi() >= xs[slab + 1])
+            {
+                intervals.emplace_back(box.yLo(), box.yHi());
+            }
+        }
+        std::sort(intervals.begin(), intervals.end());
+        std::int64_t length = 0;
+        LocType runLo = 0, runHi = 0;
+        bool inRun = false;
+        for (const auto &interval : intervals)
+        {
+            if (inRun && interval.first <= runHi)
+            {
+                runHi = std::max(runHi, interval.second);
+                continue;
+            }
+            if (inRun)
+            {
+                length += runHi - runLo;
+            }
+            runLo = interval.first;
+            runHi = interval.second;
+            inRun = true;
+        }
+        if (inRun)
+        {
+            length += runHi - runLo;
+        }
+        area += length * (static_cast<std::int64_t>(xs[slab + 1]) - xs[slab]);
+    }
+    return area;
+}
+
+void DrcScreen::gather()
+{
+    _types.clear();
+    _layers.clear();
+    _rects.clear();
+    _otherRects.clear();
+    _measured.clear();
+    _required.clear();
+    for (IndexType layerIdx = 0; layerIdx < _states.size(); ++layerIdx)
+    {
+        const auto &violations = _states[layerIdx].violations;
+        _types.insert(_types.end(), violations.types.begin(), violations.types.end());
+        _layers.insert(_layers.end(), violations.size(), layerIdx);
+        _rects.insert(_rects.end(), violations.rects.begin(), violations.rects.end());
+        _otherRects.insert(_otherRects.end(), violations.otherRects.begin(), violations.otherRects.end());
+        _measured.insert(_measured.end(), violations.measured.begin(), violations.measured.end());
+        _required.insert(_required.end(), violations.required.begin(), violations.required.end());
+    }
+}
+
+PROJECT_NAMESPACE_END
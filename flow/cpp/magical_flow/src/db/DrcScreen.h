@@ -0,0 +1,152 @@
+/**
+ * @file DrcScreen.h
+ * @brief Screen a layout against the width, spacing and area rules of the technology
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_DRC_SCREEN_H_
+#define MAGICAL_FLOW_DRC_SCREEN_H_
+
+#include <algorithm>
+#include "db/Layout.h"
+#include "db/TechDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @brief the rule a violation breaks
+enum class DrcViolationType : IndexType
+{
+    MIN_WIDTH = 0, ///< A rectangle is narrower than the minimum width
+    MIN_SPACING = 1, ///< Two rectangles are closer than the required spacing
+    MIN_AREA = 2 ///< The connected rectangles cover less than the minimum area
+};
+
+/// @class MAGICAL_FLOW::DrcScreen
+/// @brief Fast in-flow screening of a layout against the LayerRule of the technology, before the sign-off check.
+/// The rectangles of a layer touching each other are one shape. The width of a rectangle is measured together with the rectangles of its shape spanning it, so that the fragments of a wide shape are not narrow.
+/// The spacing is checked between the rectangles of different shapes only, notches inside one shape are left to the sign-off check. The area is the area of the union of the rectangles of a shape.
+/// The layers are checked in parallel. After an update moving or appending rectangles, only the shapes touched by the update are checked again.
+/// The violations are indexed arrays sorted by layer: the type, the layer, the rectangle, the other rectangle of a spacing violation, the measured value and the required value
+class DrcScreen
+{
+    public:
+        /// @brief constructor
+        /// @param the technology database with the rules
+        explicit DrcScreen(const TechDB &techDB) : _techDB(techDB) {}
+        /// @brief check all the layers of a layout. The previous violations are replaced
+        /// @param the layout
+        /// @return the number of violations
+        IndexType check(const Layout &layout);
+        /// @brief check again the shapes of one layer touched by an update, keeping the violations elsewhere
+        /// The rectangles may have been moved or appended since the last check of the same layout. If the layer has not been checked or lost rectangles, e.g. by Layout::mergeRects, the whole layer is checked
+        /// @param first: the layout
+        /// @param second: the index of the layer
+        /// @param third: the indices of the moved rectangles. The appended ones are included implicitly
+        /// @return the number of violations
+        IndexType recheck(const Layout &layout, IndexType layerIdx, const std::vector<IndexType> &rectIndices);
+        /// @brief check again the shapes of several layers touched by an update, in parallel over the layers
+        /// @param first: the layout
+        /// @param second: the indices of the moved rectangles of each layer. The layers beyond the vector have no moved rectangle
+        /// @return the number of violations
+        IndexType recheck(const Layout &layout, const std::vector<std::vector<IndexType>> &rectIndices);
+        /*------------------------------*/
+        /* Getters                      */
+        /*------------------------------*/
+        /// @brief get the number of violations
+        /// @return the number of violations
+        IndexType numViolations() const { return _types.size(); }
+        /// @brief get the number of violations of one type
+        /// @param the type
+        /// @return the number of violations
+        IndexType numViolations(DrcViolationType type) const { return std::count(_types.begin(), _types.end(), static_cast<IndexType>(type)); }
+        /// @brief get the type of a violation
+        /// @param the index of the violation
+        DrcViolationType type(IndexType idx) const { return static_cast<DrcViolationType>(_types.at(idx)); }
+        /// @brief get the layer of a violation
+        /// @param the index of the violation
+        IndexType layer(IndexType idx) const { return _layers.at(idx); }
+        /// @brief get the rectangle of a violation. The smaller index for a spacing violation, the first rectangle of the shape for an area violation
+        /// @param the index of the violation
+        IndexType rect(IndexType idx) const { return _rects.at(idx); }
+        /// @brief get the other rectangle of a spacing violation
+        /// @param the index of the violation
+        /// @return the larger rectangle index. INDEX_TYPE_MAX for the other types
+        IndexType otherRect(IndexType idx) const { return _otherRects.at(idx); }
+        /// @brief get the measured value of a violation: the width, the spacing or the area in database units
+        /// @param the index of the violation
+        std::int64_t measured(IndexType idx) const { return _measured.at(idx); }
+        /// @brief get the value required by the rule
+        /// @param the index of the violation
+        std::int64_t required(IndexType idx) const { return _required.at(idx); }
+        /// @brief get the types of all the violations, as DrcViolationType values
+        const std::vector<IndexType> & typeArray() const { return _types; }
+        /// @brief get the layers of all the violations
+        const std::vector<IndexType> & layerArray() const { return _layers; }
+        /// @brief get the rectangles of all the violations
+        const std::vector<IndexType> & rectArray() const { return _rects; }
+        /// @brief get the other rectangles of all the violations
+        const std::vector<IndexType> & otherRectArray() const { return _otherRects; }
+        /// @brief get the measured values of all the violations
+        const std::vector<std::int64_t> & measuredArray() const { return _measured; }
+        /// @brief get the required values of all the violations
+        const std::vector<std::int64_t> & requiredArray() const { return _required; }
+    private:
+        /// @brief the violations of one layer
+        struct LayerViolations
+        {
+            std::vector<IndexType> types;
+            std::vector<IndexType> rects;
+            std::vector<IndexType> otherRects;
+            std::vector<std::int64_t> measured;
+            std::vector<std::int64_t> required;
+            IndexType size() const { return types.size(); }
+            void add(DrcViolationType type, IndexType rect, IndexType otherRect, std::int64_t measuredValue, std::int64_t requiredValue)
+            {
+                types.emplace_back(static_cast<IndexType>(type));
+                rects.emplace_back(rect);
+                otherRects.emplace_back(otherRect);
+                measured.emplace_back(measuredValue);
+                required.emplace_back(requiredValue);
+            }
+        };
+        /// @brief the state of one layer kept from the last check
+        struct LayerState
+        {
+            bool checked = false; ///< Whether the layer has been checked
+            IndexType numRects = 0; ///< The number of rectangles at the last check
+            IndexType numShapes = 0; ///< The number of shape labels handed out
+            std::vector<IndexType> shapes; ///< The shape label of each rectangle
+            LayerViolations violations; ///< The violations of the layer
+        };
+        /// @brief check the shapes of one layer touched by moved or appended rectangles
+        /// @param first: the layer
+        /// @param second: the index of the layer
+        /// @param third: the moved rectangles. nullptr to check the whole layer
+        void checkLayer(const LayoutLayer &layer, IndexType layerIdx, const std::vector<IndexType> *moved);
+        /// @brief the width of a rectangle, extended along each direction by the rectangles of its shape spanning it in the other direction
+        /// @param first: the layer
+        /// @param second: the index of the rectangle
+        /// @param third: the minimum width, below which the rectangle needs the extension
+        /// @param fourth: a buffer for the query results
+        static LocType extendedWidth(const LayoutLayer &layer, IndexType rectIdx, LocType minWidth, std::vector<IndexType> &buffer);
+        /// @brief the area of the union of rectangles
+        /// @param first: the layer
+        /// @param second: the indices of the rectangles
+        static std::int64_t unionArea(const LayoutLayer &layer, const std::vector<IndexType> &rects);
+        /// @brief gather the violations of all the layers into the arrays
+        void gather();
+    private:
+        static constexpr IndexType PARALLEL_CHECK_THRESHOLD = 4096; ///< The number of rectangles to check the layers in parallel
+        const TechDB &_techDB; ///< The technology database
+        std::vector<LayerState> _states; ///< The state of each layer
+        std::vector<IndexType> _types; ///< The type of each violation
+        std::vector<IndexType> _layers; ///< The layer of each violation
+        std::vector<IndexType> _rects; ///< The rectangle of each violation
+        std::vector<IndexType> _otherRects; ///< The other rectangle of each spacing violation
+        std::vector<std::int64_t> _measured; ///< The measured value of each violation
+        std::vector<std::int64_t> _required; ///< The required value of each violation
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_DRC_SCREEN_H_
@@ -0,0 +1,155 @@
+/**
+ * @file FloorplanEstimator.cpp
+ * @brief Estimate the sizes of the circuits bottom-up before their layouts are implemented
+ * @date 10/14/2026
+ */
+
+#include "db/FloorplanEstimator.h"
+#include <algorithm>
+#include <cmath>
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief a length of the properties in database units. The properties are in e-12 and the database unit is nm
+    RealType propLength(IntType length)
+    {
+        return length > 0 ? static_cast<RealType>(length) / 1000.0 : 0.0;
+    }
+}
+
+void FloorplanEstimator::resize()
+{
+    const IndexType numCkts = _designDB.numCkts();
+    _widths.resize(numCkts, 0);
+    _heights.resize(numCkts, 0);
+    _boundaries.resize(numCkts, Box<LocType>(0, 0, 0, 0));
+    _sources.resize(numCkts, FloorplanSource::NONE);
+}
+
+RealType FloorplanEstimator::deviceArea(const CktGraph &ckt) const
+{
+    const PhyPropDB &phyPropDB = _designDB.phyPropDB();
+    switch (ckt.implType())
+    {
+        case ImplType::PCELL_Nch:
+        {
+            const MosProp &mos = phyPropDB.nch(ckt.implIdx());
+            return propLength(mos.width()) * propLength(mos.length()) * std::max<IntType>(mos.mult(), 1);
+        }
+        case ImplType::PCELL_Pch:
+        {
+            const MosProp &mos = phyPropDB.pch(ckt.implIdx());
+            return propLength(mos.width()) * propLength(mos.length()) * std::max<IntType>(mos.mult(), 1);
+        }
+        case ImplType::PCELL_Res:
+        {
+            const ResProp &res = phyPropDB.resister(ckt.implIdx());
+            return propLength(res.wr()) * propLength(res.lr()) * std::max<IntType>(res.segNum(), 1);
+        }
+        case ImplType::PCELL_Cap:
+        {
+            const CapProp &cap = phyPropDB.capacitor(ckt.implIdx());
+            return (propLength(cap.w()) + propLength(cap.spacing())) * std::max<IntType>(cap.numFingers(), 1) * propLength(cap.lr()) * std::max<IntType>(cap.multi(), 1);
+        }
+        default: return 0;
+    }
+}
+
+void FloorplanEstimator::setSize(IndexType cktIdx, LocType width, LocType height)
+{
+    AssertMsg(cktIdx < numCkts(), "%s: circuit %u out of range %u, or not estimated yet \n", __FUNCTION__, cktIdx, numCkts());
+    _widths[cktIdx] = std::max<LocType>(width, 0);
+    _heights[cktIdx] = std::max<LocType>(height, 0);
+    _boundaries[cktIdx] = Box<LocType>(0, 0, _widths[cktIdx], _heights[cktIdx]);
+    _sources[cktIdx] = FloorplanSource::FLOORPLAN;
+}
+
+void FloorplanEstimator::estimateCkt(IndexType cktIdx)
+{
+    AssertMsg(cktIdx < numCkts(), "%s: circuit %u out of range %u, or not estimated yet \n", __FUNCTION__, cktIdx, numCkts());
+    const CktGraph &ckt = _designDB.subCkt(cktIdx);
+    auto assign = [&](const Box<LocType> &boundary, FloorplanSource source)
+    {
+        _boundaries[cktIdx] = boundary;
+        _widths[cktIdx] = boundary.xLen();
+        _heights[cktIdx] = boundary.yLen();
+        _sources[cktIdx] = source;
+    };
+    if (ckt.hasLayout() && ckt.layout().boundary().valid())
+    {
+        assign(ckt.layout().boundary(), FloorplanSource::LAYOUT);
+        return;
+    }
+    if (MfUtil::isImplTypeDevice(ckt.implType()))
+    {
+        Box<LocType> boundary;
+        if (_designDB.cachedDeviceBoundary(cktIdx, false, boundary) || _designDB.cachedDeviceBoundary(cktIdx, true, boundary))
+        {
+            assign(boundary, FloorplanSource::CACHE);
+            return;
+        }
+        LocType size = static_cast<LocType>(std::ceil(std::sqrt(deviceArea(ckt) * _deviceAreaFactor)));
+        size = std::max(size, _minDeviceSize);
+        assign(Box<LocType>(0, 0, size, size), FloorplanSource::MODEL);
+        return;
+    }
+    RealType area = 0;
+    LocType maxWidth = 0, maxHeight = 0;
+    for (const auto &node : ckt.nodeArray())
+    {
+        if (node.isLeaf())
+        {
+            continue;
+        }
+        const IndexType subCktIdx = node.subgraphIdx();
+        if (_sources.at(subCktIdx) == FloorplanSource::NONE)
+        {
+            WRN("%s: sub circuit %s of %s is not estimated \n", __FUNCTION__, _designDB.subCkt(subCktIdx).name().c_str(), ckt.name().c_str());
+        }
+        area += static_cast<RealType>(this->area(subCktIdx));
+        maxWidth = std::max(maxWidth, _widths[subCktIdx]);
+        maxHeight = std::max(maxHeight, _heights[subCktIdx]);
+    }
+    area /= _utilization;
+    LocType width = std::max(static_cast<LocType>(std::ceil(std::sqrt(area * _aspectRatio))), maxWidth);
+    LocType height = width > 0 ? static_cast<LocType>(std::ceil(area / width)) : 0;
+    assign(Box<LocType>(0, 0, width, std::max(height, maxHeight)), FloorplanSource::HIERARCHY);
+}
+
+IndexType FloorplanEstimator::estimate(IndexType topCktIdx)
+{
+    this->resize();
+    AssertMsg(topCktIdx < numCkts(), "%s: circuit %u out of range %u \n", __FUNCTION__, topCktIdx, numCkts());
+    const CktHierarchy &hierarchy = _designDB.hierarchy();
+    // The circuits under the top circuit
+    std::vector<char> under(numCkts(), 0);
+    std::vector<IndexType> stack = {topCktIdx};
+    under[topCktIdx] = 1;
+    while (!stack.empty())
+    {
+        IndexType cktIdx = stack.back();
+        stack.pop_back();
+        for (IndexType childIdx : hierarchy.children(cktIdx))
+        {
+            if (!under[childIdx])
+            {
+                under[childIdx] = 1;
+                stack.emplace_back(childIdx);
+            }
+        }
+    }
+    IndexType numEstimated = 0;
+    for (IndexType cktIdx : hierarchy.bottomUpOrder())
+    {
+        if (under[cktIdx])
+        {
+            this->estimateCkt(cktIdx);
+            ++numEstimated;
+        }
+    }
+    return numEstimated;
+}
+
+PROJECT_NAMESPACE_END
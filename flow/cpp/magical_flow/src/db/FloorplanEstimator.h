@@ -0,0 +1,100 @@
+/**
+ * @file FloorplanEstimator.h
+ * @brief Estimate the sizes of the circuits bottom-up before their layouts are implemented
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_FLOORPLAN_ESTIMATOR_H_
+#define MAGICAL_FLOW_FLOORPLAN_ESTIMATOR_H_
+
+#include "db/DesignDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @brief where the estimated size of a circuit comes from
+enum class FloorplanSource
+{
+    NONE, ///< Not estimated
+    LAYOUT, ///< The boundary of its layout, implemented or generated already
+    CACHE, ///< The boundary of its layout in the device layout cache
+    MODEL, ///< The area model of its device properties
+    HIERARCHY, ///< The areas of its sub circuits
+    FLOORPLAN ///< Set by setSize, e.g. from a floorplan of its sub circuits
+};
+
+/// @class MAGICAL_FLOW::FloorplanEstimator
+/// @brief The sizes of the circuits of a design, estimated bottom-up without generating the devices or placing the real layouts.
+/// A device takes the boundary of its layout if it has one, otherwise of its cached layout, otherwise a square from its area model.
+/// A circuit with sub circuits takes the sum of the areas of its nodes divided by the utilization, shaped by the aspect ratio,
+/// and made at least as wide and as high as its widest and highest node
+class FloorplanEstimator
+{
+    public:
+        /// @brief constructor
+        /// @param the design. The device layout cache is looked up but no circuit is changed
+        explicit FloorplanEstimator(DesignDB &designDB) : _designDB(designDB) {}
+        /// @brief set the fraction of the area of a circuit the nodes fill
+        /// @param the utilization in (0, 1]. 0.6 by default
+        void setUtilization(RealType utilization) { AssertMsg(utilization > 0 && utilization <= 1, "%s: utilization %f \n", __FUNCTION__, utilization); _utilization = utilization; }
+        /// @brief set the target ratio of the width to the height of the circuits with sub circuits
+        /// @param the aspect ratio. 1 by default
+        void setAspectRatio(RealType aspectRatio) { AssertMsg(aspectRatio > 0, "%s: aspect ratio %f \n", __FUNCTION__, aspectRatio); _aspectRatio = aspectRatio; }
+        /// @brief set the area model of the devices without any layout: the gate, resistor or capacitor area times the factor
+        /// @param first: the factor. 25 by default
+        /// @param second: the minimum width and height in database units. 1000 by default
+        void setDeviceModel(RealType areaFactor, LocType minSize) { _deviceAreaFactor = areaFactor; _minDeviceSize = minSize; }
+        /// @brief estimate all the circuits under a top circuit, bottom-up. The arrays are sized to the circuits of the design here only,
+        /// so that estimateCkt() and setSize() on distinct circuits do not move the estimates of the others
+        /// @param the top circuit
+        /// @return the number of circuits estimated
+        IndexType estimate(IndexType topCktIdx);
+        /// @brief estimate one circuit from the current estimates of its sub circuits. After estimate()
+        /// @param the circuit
+        void estimateCkt(IndexType cktIdx);
+        /// @brief set the size of a circuit, such as the extent of a fast floorplan of its sub circuits. The parents see it once they are estimated. After estimate()
+        /// @param first: the circuit
+        /// @param second: the width
+        /// @param third: the height
+        void setSize(IndexType cktIdx, LocType width, LocType height);
+        /*------------------------------*/
+        /* Getters                      */
+        /*------------------------------*/
+        /// @brief get the number of circuits
+        IndexType numCkts() const { return _widths.size(); }
+        /// @brief get the estimated width of a circuit
+        /// @param the circuit
+        LocType width(IndexType cktIdx) const { return _widths.at(cktIdx); }
+        /// @brief get the estimated height of a circuit
+        /// @param the circuit
+        LocType height(IndexType cktIdx) const { return _heights.at(cktIdx); }
+        /// @brief get the estimated area of a circuit
+        /// @param the circuit
+        std::int64_t area(IndexType cktIdx) const { return static_cast<std::int64_t>(width(cktIdx)) * height(cktIdx); }
+        /// @brief get the boundary of a circuit: its layout boundary for LAYOUT and CACHE, otherwise a box of the estimated size at the origin
+        /// @param the circuit
+        const Box<LocType> & boundary(IndexType cktIdx) const { return _boundaries.at(cktIdx); }
+        /// @brief get where the estimate of a circuit comes from
+        /// @param the circuit
+        FloorplanSource source(IndexType cktIdx) const { return _sources.at(cktIdx); }
+    private:
+        /// @brief resize the arrays to the circuits of the design
+        void resize();
+        /// @brief the area of a device by its properties, before the model factor
+        /// @param the device circuit
+        /// @return the area in database units. 0 if the properties are not set
+        RealType deviceArea(const CktGraph &ckt) const;
+    private:
+        DesignDB &_designDB; ///< The design
+        RealType _utilization = 0.6; ///< The fraction of the area of a circuit the nodes fill
+        RealType _aspectRatio = 1.0; ///< The target width over height
+        RealType _deviceAreaFactor = 25.0; ///< The device area over its gate, resistor or capacitor area
+        LocType _minDeviceSize = 1000; ///< The minimum width and height of a device from the model
+        std::vector<LocType> _widths; ///< The estimated width of each circuit
+        std::vector<LocType> _heights; ///< The estimated height of each circuit
+        std::vector<Box<LocType>> _boundaries; ///< The boundary of each circuit
+        std::vector<FloorplanSource> _sources; ///< Where the estimate of each circuit comes from
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_FLOORPLAN_ESTIMATOR_H_
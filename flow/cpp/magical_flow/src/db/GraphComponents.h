@@ -9,6 +9,9 @@
 #define MAGICAL_FLOW_GRAPH_COMPONENTS_H_
 
 #include "global/global.h"
+#include "util/HeapBytes.h"
+#include "util/IndexList.h"
+#include "util/StringPool.h"
 
 PROJECT_NAMESPACE_BEGIN
 
@@ -21,24 +24,31 @@ class GdsData
         /// @brief get the bounding box
         /// @return the reference to the bounding box
         Box<LocType> & bbox() { return _bbox; }
+        /// @brief get the bounding box
+        /// @return the bounding box
+        const Box<LocType> & bbox() const { return _bbox; }
         /// @brief set the bounding box
         /// @param xlo ylo xhi yhi
         void setBBox(LocType xLo, LocType yLo, LocType xHi, LocType yHi) { _bbox = Box<LocType>(xLo, yLo, xHi, yHi); }
         /// @brief get the gds filename
         /// @return gds filename
-        std::string gdsFile() { return _gdsFile; }
+        std::string gdsFile() const { return _gdsFile; }
         /// @breif set gds filename
         /// @param gds filename
         void setGdsFile(const std::string &filename) { _gdsFile = filename; }
+        /// @brief get the heap bytes of the file name, beyond sizeof(GdsData)
+        std::size_t heapBytes() const { return HeapBytes::of(_gdsFile); }
     private:
         std::string _gdsFile = ""; ///< Filename for GDSII layout
         Box<LocType> _bbox; ///< The bounding box of the layout
 };
 
 /// @class MAGICAL_FLOW::CktNode
-/// @brief the abstracted node concepts for representing the physical components circuits
+/// @brief the abstracted node concepts for representing the physical components circuits.
+/// The names are interned, and the pin indices may view the packed arrays of the CktGraph, see CktGraph::compactConnectivity
 class CktNode 
 {
+    friend class CktGraph;
     public:
         /// @brief default constructor
         explicit CktNode() = default; 
@@ -49,11 +59,8 @@ class CktNode
         /// @return the subgraph graph index
         IndexType subgraphIdx() const { return _graphIdx; }
         /// @brief get the array of pin indices this node has (at the current level of graph)
-        /// @return the array of pin indices
-        std::vector<IndexType> & pinIdxArray() { return _pinIdxArray; }
-        /// @brief get the array of pin indices this node has (at the current level of graph)
-        /// @return the array of pin indices
-        const std::vector<IndexType> & pinIdxArray() const { return _pinIdxArray; }
+        /// @return a view of the array of pin indices
+        IndexSpan pinIdxArray() const { return _pinIdxArray.span(); }
         /// @brief get the number of pins this CktNode contains
         /// @return the number of pins this CktNode contains
         IndexType numPins() const { return _pinIdxArray.size(); }
@@ -62,10 +69,10 @@ class CktNode
         IndexType pinIdx(IndexType nth) const { return _pinIdxArray.at(nth); }
         /// @brief get the reference name
         /// @return the reference name of the node
-        const std::string & refName() const { return _refName; }
+        const std::string & refName() const { return *_refName; }
         /// @brief get the name of the node
         /// @return the name of node
-        const std::string & name() const { return _name; }
+        const std::string & name() const { return *_name; }
         /// @brief get if the node should be flipped
         /// @return the flip vert flag
         bool flipVertFlag() const { return _flipVertFlag; }
@@ -81,10 +88,10 @@ class CktNode
         void setIsImpl(bool isImpl)  {_implPhy = isImpl; }
         /// @brief set the reference name of this node
         /// @param the reference name of the node
-        void setRefName(const std::string &refName) { _refName = refName; }
+        void setRefName(const std::string &refName) { _refName = &StringPool::names().intern(refName); }
         /// @brief set the name of this node
         /// @param the name of the node
-        void setName(const std::string &name) { _name = name; }
+        void setName(const std::string &name) { _name = &StringPool::names().intern(name); }
         /// @brief set the coordinate offset of this node
         /// @set the offset of this node
         void setOffset(LocType x, LocType y) { _offset = XY<LocType>(x, y); }
@@ -97,13 +104,13 @@ class CktNode
         /*------------------------------*/ 
         /// @brief get the coordinate offset of this node
         /// @return the offset of this node
-        //const XY<LocType> & offset() const { return _offset; }
+        const XY<LocType> & offset() const { return _offset; }
         /// @brief get the coordinate offset of this node
         /// @return the offset of this node
         XY<LocType> & offset() { return _offset; }
         /// @brief get the orientation of this node
         /// @return the orientation of this node
-        //const OriType & orient() const { return _orient; }
+        const OriType & orient() const { return _orient; }
         /// @brief get the orientation of this node
         /// @return the orientation of this node
         OriType & orient() { return _orient; }
@@ -124,23 +131,42 @@ class CktNode
         /*------------------------------*/ 
         /// @brief append a pinIdx to the pinIdxArray
         /// @param a pinIdx
-        void appendPinIdx(IndexType pinIdx) { _pinIdxArray.emplace_back(pinIdx); }
+        void appendPinIdx(IndexType pinIdx) { _pinIdxArray.append(pinIdx); }
         /*------------------------------*/ 
         /* Graph Properties             */
         /*------------------------------*/ 
         /// @brief if this node is a leaf node
         /// @return whether this node is a leaf node in the graph. If not, it represents a subgraph
         bool isLeaf() const { return _graphIdx == INDEX_TYPE_MAX; }
+        /// @brief get the heap bytes of the pin list, beyond sizeof(CktNode). The interned names are counted by their pool
+        std::size_t heapBytes() const { return _pinIdxArray.heapBytes(); }
+        /*------------------------------*/ 
+        /* Geometry                     */
+        /*------------------------------*/ 
+        /// @brief convert a coordinate in the sub circuit into the coordinate system of the parent circuit
+        /// The flip vertical flag mirrors the sub circuit about the center of its bounding box as in Layout::insertLayout, and the orientation and offset are then applied as in MfUtil::orientConv
+        /// @param first: the coordinate in the sub circuit
+        /// @param second: the bounding box of the sub circuit layout
+        /// @return the coordinate in the parent circuit
+        XY<LocType> toParentCoord(const XY<LocType> &coord, const Box<LocType> &bbox) const
+        {
+            XY<LocType> pt = coord;
+            if (_flipVertFlag)
+            {
+                pt.setX(bbox.xLo() + bbox.xHi() - pt.x());
+            }
+            return MfUtil::orientConv(pt, _orient, _offset, bbox);
+        }
     private:
         IndexType _graphIdx = INDEX_TYPE_MAX; ///< The index of the sub graph this node corresponding to. If INDEX_TYPE_MAX, then this is a leaf node
-        std::vector<IndexType> _pinIdxArray; ///< The pins this node containing
         XY<LocType> _offset = XY<LocType>(0, 0); ///< The offset of the location
         OriType _orient = OriType::N; ///< The orientation of this node
         bool _implPhy = false; ///< Whether this node has been implemented physically
         bool _flipVertFlag = false; ///< Whether this node should be fliped due to symmetry constraint
         ImplType _implType = ImplType::UNSET; ///< what is the implementation type of the node 
-        std::string _refName = ""; ///< The reference name of this node
-        std::string _name = ""; ///< The name of this node
+        IndexList _pinIdxArray; ///< The pins this node containing
+        const std::string *_refName = &StringPool::empty(); ///< The reference name of this node, interned
+        const std::string *_name = &StringPool::empty(); ///< The name of this node, interned
 };
 
 /// @brief the IO pin shape configuration
@@ -154,23 +180,24 @@ struct IoPinConfigure
 };
 
 /// @class MAGICAL_FLOW::Net
-/// @brief the abstracted net concepts for representing the connectivity of the circuits
+/// @brief the abstracted net concepts for representing the connectivity of the circuits.
+/// The name is interned, and the pin indices may view the packed arrays of the CktGraph, see CktGraph::compactConnectivity.
+/// A net always has at least one io interface. The first one is stored inline
 class Net
 {
+    friend class CktGraph;
     public:
         /// @brief default constructor
-        explicit Net() 
-        {
-            _ioInterfaces.resize(1);
-            Assert(_ioInterfaces.at(0).layer == INDEX_TYPE_MAX);
-            Assert(_ioInterfaces.at(0).isPowerStripe == 0);
-        }
+        explicit Net() = default;
         /*------------------------------*/ 
         /* Getters                      */
         /*------------------------------*/ 
         /// @brief get the array of pin indices that the net connecting
-        /// @return the array of pin indices that the net connecting
-        std::vector<IndexType> & pinIdxArray() { return _pinIdxArray; }
+        /// @return a view of the array of pin indices that the net connecting
+        IndexSpan pinIdxArray() const { return _pinIdxArray.span(); }
+        /// @brief get the array of device substrate pin indices that the net connecting
+        /// @return a view of the array of substrate pin indices
+        IndexSpan subIdxArray() const { return _subIdxArray.span(); }
         /// @brief get the number of pins this net is connecting
         /// @return the number of pins this net is connecting
         IndexType numPins() const { return _pinIdxArray.size(); }
@@ -182,7 +209,7 @@ class Net
         IndexType pinIdx(IndexType nth) const { return _pinIdxArray.at(nth); }
         /// @brief get the name of the net
         /// @return the name of the net
-        const std::string & name() const { return _name; }
+        const std::string & name() const { return *_name; }
         /// @brief get the index of io
         /// @return index of the net io
         IndexType ioPos() const { return _ioPos; }
@@ -201,7 +228,7 @@ class Net
         /*------------------------------*/ 
         /// @brief set the name for the net
         /// @param the name for the net
-        void setName(const std::string &name) { _name = name; }
+        void setName(const std::string &name) { _name = &StringPool::names().intern(name); }
         /// @brief set pos of io
         /// @param the index pos of io
         void setIoPos(IndexType ioPos) { _ioPos = ioPos; }
@@ -222,19 +249,19 @@ class Net
         /*------------------------------*/ 
         /// @brief check if the net is io
         /// @param return true if net is io
-        bool isIo() { return _ioPos != INDEX_TYPE_MAX; }
+        bool isIo() const { return _ioPos != INDEX_TYPE_MAX; }
         /// @brief return true if net is a substrate net
         /// @return true if a substrate net
-        bool isSub() { return _subIdxArray.empty(); }
+        bool isSub() { return _subIdxArray.size() == 0; }
         /*------------------------------*/ 
         /* Vector operation             */
         /*------------------------------*/ 
         /// @brief append a pinIdx to the pinIdxArray
         /// @param a pinIdx
-        void appendPinIdx(IndexType pinIdx) { _pinIdxArray.emplace_back(pinIdx); }
+        void appendPinIdx(IndexType pinIdx) { _pinIdxArray.append(pinIdx); }
         /// @brief append a pinIdx to the subIdxArray
         /// @param a pinIdx
-        void appendSubIdx(IndexType pinIdx) { _subIdxArray.emplace_back(pinIdx); }
+        void appendSubIdx(IndexType pinIdx) { _subIdxArray.append(pinIdx); }
         /*------------------------------*/ 
         /* Integration                  */
         /*------------------------------*/ 
@@ -243,19 +270,25 @@ class Net
         /// @param second: ylo
         /// @param third: xhi
         /// @param fourth: yhi
-        void setIoShape(LocType xLo, LocType yLo, LocType xHi, LocType yHi) { _ioInterfaces.at(0).shape = Box<LocType>(xLo, yLo, xHi, yHi); }
+        void setIoShape(LocType xLo, LocType yLo, LocType xHi, LocType yHi) { _firstIo.shape = Box<LocType>(xLo, yLo, xHi, yHi); }
         /// @brief get the pin shape of this net for external accessing
         /// @return the pin shape as rectangle
-        Box<LocType> & ioShape() { return _ioInterfaces.at(0).shape; }
+        Box<LocType> & ioShape() { return _firstIo.shape; }
         /// @brief get io shape layer. Metal layer
         /// @return IO shape layer, metal layer
-        IndexType ioLayer() const { return _ioInterfaces.at(0).layer; }
+        IndexType ioLayer() const { return _firstIo.layer; }
         /// @brief set IO shape layer. Metal layer
         /// @param metal layer
-        void setIoLayer(IndexType ioLayer) { _ioInterfaces.at(0).layer = ioLayer; }
+        void setIoLayer(IndexType ioLayer) { _firstIo.layer = ioLayer; }
         /// @brief get the number of io pins
         /// @return the number of io pins
-        IndexType numIoPins() const { return _ioInterfaces.size(); }
+        IndexType numIoPins() const { return 1 + _moreIos.size(); }
+        /// @brief get the number of io pins which are set, unlike numIoPins the first one only if it has a layer
+        IndexType numSetIoPins() const { return (_firstIo.layer == INDEX_TYPE_MAX ? 0 : 1) + _moreIos.size(); }
+        /// @brief get the heap bytes of the pin lists, beyond sizeof(Net). The interned name is counted by its pool
+        std::size_t heapBytes() const { return _pinIdxArray.heapBytes() + _subIdxArray.heapBytes(); }
+        /// @brief get the heap bytes of the io interfaces after the first one, which is kept in the net
+        std::size_t ioHeapBytes() const { return HeapBytes::of(_moreIos); }
         /// @brief add a io pin
         /// @param first: io pin shape xLo 
         /// @param second: io pin shape yLo 
@@ -264,41 +297,63 @@ class Net
         /// @param fifth: metal layer 
         void addIoPin(LocType xLo, LocType yLo, LocType xHi, LocType yHi, IndexType metalLayer)
         {
-            if (_ioInterfaces.at(0).layer == INDEX_TYPE_MAX)
+            if (_firstIo.layer == INDEX_TYPE_MAX)
             {
-                _ioInterfaces[0].shape = Box<LocType>(xLo, yLo, xHi, yHi);
-                _ioInterfaces[0].layer = metalLayer;
+                _firstIo.shape = Box<LocType>(xLo, yLo, xHi, yHi);
+                _firstIo.layer = metalLayer;
             }
             else
             {
-                _ioInterfaces.emplace_back(IoPinConfigure());
-                _ioInterfaces.back().shape = Box<LocType>(xLo, yLo, xHi, yHi);
-                _ioInterfaces.back().layer = metalLayer;
+                _moreIos.emplace_back(IoPinConfigure());
+                _moreIos.back().shape = Box<LocType>(xLo, yLo, xHi, yHi);
+                _moreIos.back().layer = metalLayer;
             }
         }
         /// @brief get whether a io shape is power stripe
         /// @param the index of the io interface
-        bool isIoPowerStripe(IndexType ioIdx) const { return _ioInterfaces.at(ioIdx).isPowerStripe == 1; }
+        bool isIoPowerStripe(IndexType ioIdx) const { return this->io(ioIdx).isPowerStripe == 1; }
         /// @brief mark a io shape as power stripe
         /// @param the index of the io interface
-        void markIoPowerStripe(IndexType ioIdx) { _ioInterfaces.at(ioIdx).isPowerStripe = 1; }
+        void markIoPowerStripe(IndexType ioIdx) { this->io(ioIdx).isPowerStripe = 1; }
         /// @brief mark the last io shape as power stripe
-        void markLastIoPowerStripe() { _ioInterfaces.back().isPowerStripe = 1; }
+        void markLastIoPowerStripe() { this->io(this->numIoPins() - 1).isPowerStripe = 1; }
         /// @brief get the io pin shape
         /// @param the index 
         /// @return the shape
-        Box<LocType> & ioPinShape(IndexType idx) { return _ioInterfaces.at(idx).shape; }
+        Box<LocType> & ioPinShape(IndexType idx) { return this->io(idx).shape; }
+        /// @brief get the io pin shape
+        /// @param the index 
+        /// @return the shape
+        const Box<LocType> & ioPinShape(IndexType idx) const { return this->io(idx).shape; }
         /// @brief get the io pin metal layer
         /// @param the index
         /// @return the metal layer
-        IndexType ioPinMetalLayer(IndexType idx) { return _ioInterfaces.at(idx).layer; }
+        IndexType ioPinMetalLayer(IndexType idx) const { return this->io(idx).layer; }
+        /// @brief get all the io interfaces
+        /// @return a copy of the io interfaces
+        std::vector<IoPinConfigure> ioInterfaces() const
+        {
+            std::vector<IoPinConfigure> ios;
+            ios.reserve(this->numIoPins());
+            ios.emplace_back(_firstIo);
+            ios.insert(ios.end(), _moreIos.begin(), _moreIos.end());
+            return ios;
+        }
+        /// @brief replace all the io interfaces
+        /// @param the io interfaces. Should not be empty
+        void setIoInterfaces(const std::vector<IoPinConfigure> &ioInterfaces)
+        {
+            Assert(!ioInterfaces.empty());
+            _firstIo = ioInterfaces.front();
+            _moreIos.assign(ioInterfaces.begin() + 1, ioInterfaces.end());
+        }
         /// @brief flip io shape according to vertical axis
         /// @param symmetry vertical axis x=axis
         void flipVert(LocType axis) 
         { 
-            for (auto &io : _ioInterfaces)
+            for (IndexType ioIdx = 0; ioIdx < this->numIoPins(); ++ioIdx)
             {
-                auto & ioshape = io.shape;
+                auto & ioshape = this->io(ioIdx).shape;
                 LocType xLo = ioshape.xLo();    
                 ioshape.setXLo(2 * axis - ioshape.xHi());
                 ioshape.setXHi(2 * axis - xLo);
@@ -306,9 +361,14 @@ class Net
         }
 
     private:
-        std::vector<IndexType> _pinIdxArray; ///< The indices of pins this nets connecting to (includes sub pins)
-        std::vector<IndexType> _subIdxArray; ///< The indices of device substrate pins this nets connecting to
-        std::string _name = ""; ///< The name of this net
+        /// @brief get an io interface
+        IoPinConfigure & io(IndexType ioIdx) { return ioIdx == 0 ? _firstIo : _moreIos.at(ioIdx - 1); }
+        /// @brief get an io interface
+        const IoPinConfigure & io(IndexType ioIdx) const { return ioIdx == 0 ? _firstIo : _moreIos.at(ioIdx - 1); }
+    private:
+        IndexList _pinIdxArray; ///< The indices of pins this nets connecting to (includes sub pins)
+        IndexList _subIdxArray; ///< The indices of device substrate pins this nets connecting to
+        const std::string *_name = &StringPool::empty(); ///< The name of this net, interned
         IndexType _ioPos = INDEX_TYPE_MAX; ///< The index of net if it is IO.
         bool _isVdd = false; ///< Whether this net is a VDD net
         bool _isVss = false; ///< Whether this net is a VSS net
@@ -317,7 +377,8 @@ class Net
         /*------------------------------*/ 
         /* For higher hierarchy         */
         /*------------------------------*/ 
-        std::vector<IoPinConfigure> _ioInterfaces; ///< The shape for pin for accessing from external
+        IoPinConfigure _firstIo; ///< The first shape for pin for accessing from external
+        std::vector<IoPinConfigure> _moreIos; ///< The other shapes for pin for accessing from external
 };
 
 /// @class MAGICAL_FLOW::Pin
@@ -356,6 +417,8 @@ class Pin
         /// @brief get if pin is valid
         /// @return return true if pin is valid
         bool valid() const { return _valid; }
+        /// @brief get the heap bytes of the layout rectangle indices, beyond sizeof(Pin)
+        std::size_t heapBytes() const { return HeapBytes::of(_layoutRectIdx); }
         /*------------------------------*/ 
         /* Setters                      */
         /*------------------------------*/ 
@@ -381,6 +444,8 @@ class Pin
         /// @param An index of rectangle in Layout
         /// @return the index of the new rectangle
         IndexType addLayoutRectIdx(IndexType rectIdx) { _layoutRectIdx.emplace_back(rectIdx); return _layoutRectIdx.size() - 1; }
+        /// @brief remove all the rectangle indices
+        void clearLayoutRectIdx() { _layoutRectIdx.clear(); }
     private:
         PinType _pinType = PinType::UNSET; ///< The pin is a substrate pin psub/nwell
         IndexType _nodeIdx = INDEX_TYPE_MAX; ///< The node index of the pin
@@ -0,0 +1,106 @@
+/**
+ * @file InstanceShapes.cpp
+ * @brief The shapes of the sub circuits placed in a circuit, for the hierarchical writers
+ * @date 10/14/2026
+ */
+
+#include "db/InstanceShapes.h"
+#include <algorithm>
+
+PROJECT_NAMESPACE_BEGIN
+
+InstanceShapes::InstanceShapes(const DesignDB &designDB, IndexType cktIdx)
+{
+    const IndexType numLayers = designDB.subCkt(cktIdx).layout().numLayers();
+    _rects.resize(numLayers);
+    _polygons.resize(numLayers);
+    _texts.resize(numLayers);
+    std::vector<XY<LocType>> pts;
+    for (const auto &view : designDB.instanceViews(cktIdx))
+    {
+        const auto &subLayout = view.child().layout();
+        for (IndexType layerIdx = 0; layerIdx < std::min(numLayers, subLayout.numLayers()); ++layerIdx)
+        {
+            const auto &layer = subLayout.layer(layerIdx);
+            // The slices of the polygons are compared as the polygons
+            const auto skipped = layer.skippedRectRanges(false);
+            auto rangeIter = skipped.begin();
+            for (IndexType rectIdx = 0; rectIdx < layer.numStoredRects(); ++rectIdx)
+            {
+                while (rangeIter != skipped.end() && rangeIter->second <= rectIdx)
+                {
+                    ++rangeIter;
+                }
+                if (rangeIter != skipped.end() && rangeIter->first <= rectIdx)
+                {
+                    rectIdx = rangeIter->second - 1;
+                    continue;
+                }
+                const Box<LocType> rect = view.rect(layerIdx, rectIdx);
+                _rects[layerIdx].push_back({rect.xLo(), rect.yLo(), rect.xHi(), rect.yHi(), static_cast<LocType>(layer.datatype(rectIdx))});
+            }
+            for (IndexType polyIdx = 0; polyIdx < layer.numPolygons(); ++polyIdx)
+            {
+                pts.clear();
+                for (IndexType ptIdx = 0; ptIdx < layer.numPolygonPoints(polyIdx); ++ptIdx)
+                {
+                    pts.emplace_back(view.toParentCoord(layer.polygonPoint(polyIdx, ptIdx)));
+                }
+                _polygons[layerIdx].emplace_back(polygonKey(pts, layer.polygonDatatype(polyIdx)));
+            }
+            view.forEachText(layerIdx, [&](const std::string &str, const XY<LocType> &coord) { _texts[layerIdx].emplace_back(str, coord.x(), coord.y()); });
+        }
+    }
+    for (IndexType layerIdx = 0; layerIdx < numLayers; ++layerIdx)
+    {
+        std::sort(_rects[layerIdx].begin(), _rects[layerIdx].end());
+        std::sort(_polygons[layerIdx].begin(), _polygons[layerIdx].end());
+        std::sort(_texts[layerIdx].begin(), _texts[layerIdx].end());
+    }
+}
+
+InstanceShapes::PolygonKey InstanceShapes::polygonKey(std::vector<XY<LocType>> &pts, IndexType datatype)
+{
+    // The transforms may reverse or rotate the order of the vertices, but keep the set of them
+    std::sort(pts.begin(), pts.end(), [](const XY<LocType> &lhs, const XY<LocType> &rhs) { return lhs.x() < rhs.x() || (lhs.x() == rhs.x() && lhs.y() < rhs.y()); });
+    PolygonKey key;
+    key.reserve(2 * pts.size() + 1);
+    key.emplace_back(static_cast<LocType>(datatype));
+    for (const auto &pt : pts)
+    {
+        key.emplace_back(pt.x());
+        key.emplace_back(pt.y());
+    }
+    return key;
+}
+
+bool InstanceShapes::coversRect(IndexType layerIdx, const Box<LocType> &rect, IndexType datatype) const
+{
+    if (layerIdx >= _rects.size())
+    {
+        return false;
+    }
+    const RectKey key = {rect.xLo(), rect.yLo(), rect.xHi(), rect.yHi(), static_cast<LocType>(datatype)};
+    return std::binary_search(_rects[layerIdx].begin(), _rects[layerIdx].end(), key);
+}
+
+bool InstanceShapes::coversPolygon(IndexType layerIdx, const LayoutLayer &layer, IndexType polyIdx) const
+{
+    if (layerIdx >= _polygons.size() || _polygons[layerIdx].empty())
+    {
+        return false;
+    }
+    std::vector<XY<LocType>> pts = layer.polygon(polyIdx);
+    return std::binary_search(_polygons[layerIdx].begin(), _polygons[layerIdx].end(), polygonKey(pts, layer.polygonDatatype(polyIdx)));
+}
+
+bool InstanceShapes::coversText(IndexType layerIdx, const TextLayout &text) const
+{
+    if (layerIdx >= _texts.size())
+    {
+        return false;
+    }
+    return std::binary_search(_texts[layerIdx].begin(), _texts[layerIdx].end(), TextKey(text.text(), text.coord().x(), text.coord().y()));
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,61 @@
+/**
+ * @file InstanceShapes.h
+ * @brief The shapes of the sub circuits placed in a circuit, for the hierarchical writers
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_INSTANCE_SHAPES_H_
+#define MAGICAL_FLOW_INSTANCE_SHAPES_H_
+
+#include <array>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "DesignDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::InstanceShapes
+/// @brief the rectangles, polygons and texts of the sub circuits instantiated by the nodes of a circuit, in the coordinates of the circuit, read through the instance views.
+/// A hierarchical writer references the sub circuits, so a shape of the circuit equal to one of these, on the same layer with the same datatype, is already drawn by a reference and is not written again.
+/// This is decided from the nodes and the current sub layouts, whichever way the shapes were copied into the circuit and whatever was done to the layout afterwards
+class InstanceShapes
+{
+    public:
+        /// @brief default constructor. Covers no shape, as for a flat write
+        explicit InstanceShapes() = default;
+        /// @brief collect the shapes of the sub circuits of a circuit
+        /// @param first: the design database
+        /// @param second: the index of the circuit
+        explicit InstanceShapes(const DesignDB &designDB, IndexType cktIdx);
+        /// @brief whether a rectangle of the circuit is a rectangle of one of its instances
+        /// @param first: the layer
+        /// @param second: the rectangle
+        /// @param third: the datatype
+        bool coversRect(IndexType layerIdx, const Box<LocType> &rect, IndexType datatype) const;
+        /// @brief whether a polygon of the circuit is a polygon of one of its instances, with the same vertices in any order
+        /// @param first: the layer
+        /// @param second: the layer of the circuit layout
+        /// @param third: the index of the polygon in the layer
+        bool coversPolygon(IndexType layerIdx, const LayoutLayer &layer, IndexType polyIdx) const;
+        /// @brief whether a text of the circuit is a text of one of its instances
+        /// @param first: the layer
+        /// @param second: the text
+        bool coversText(IndexType layerIdx, const TextLayout &text) const;
+    private:
+        typedef std::array<LocType, 5> RectKey; ///< The corners and the datatype
+        typedef std::vector<LocType> PolygonKey; ///< The datatype and the sorted vertices
+        typedef std::tuple<std::string, LocType, LocType> TextKey; ///< The string and the coordinate
+        /// @brief get the key of a polygon
+        /// @param first: the vertices
+        /// @param second: the datatype
+        static PolygonKey polygonKey(std::vector<XY<LocType>> &pts, IndexType datatype);
+    private:
+        std::vector<std::vector<RectKey>> _rects; ///< The sorted rectangles of each layer
+        std::vector<std::vector<PolygonKey>> _polygons; ///< The sorted polygons of each layer
+        std::vector<std::vector<TextKey>> _texts; ///< The sorted texts of each layer
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_INSTANCE_SHAPES_H_
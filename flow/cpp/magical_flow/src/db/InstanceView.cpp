@@ -0,0 +1,26 @@
+/**
+ * @file InstanceView.cpp
+ * @brief A sub circuit seen through the transform of one of its instances, without copying its geometry
+ * @date 10/14/2026
+ */
+
+#include "db/InstanceView.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+InstanceView InstanceView::mirrored(const CktGraph &ckt, LocType axis)
+{
+    // Mirroring about the center of the boundary, then shifting the center onto the mirror image of the axis
+    const auto &bbox = ckt.layout().boundary();
+    return InstanceView(ckt, XY<LocType>(2 * axis - bbox.xLo() - bbox.xHi(), 0), OriType::N, true);
+}
+
+Layout InstanceView::materialize() const
+{
+    Layout layout;
+    layout.init(_child->layout().numLayers());
+    this->materialize(layout, true);
+    return layout;
+}
+
+PROJECT_NAMESPACE_END
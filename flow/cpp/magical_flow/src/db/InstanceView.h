@@ -0,0 +1,147 @@
+/**
+ * @file InstanceView.h
+ * @brief A sub circuit seen through the transform of one of its instances, without copying its geometry
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_INSTANCE_VIEW_H_
+#define MAGICAL_FLOW_INSTANCE_VIEW_H_
+
+#include "CktGraph.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::InstanceView
+/// @brief a (sub circuit, transform) pair. The rectangles, the texts and the io shapes of the sub circuit are transformed on demand,
+/// with the semantics of CktNode::toParentCoord: the flip vertical flag mirrors about the center of the boundary of the sub layout, then the orientation and the offset apply.
+/// Every instance of a sub circuit reads the same geometry, which is copied only by materialize().
+/// The transform is read against the current boundary of the sub layout.
+/// A view refers to the sub circuit: adding circuits to the design database invalidates it, as it invalidates the references to the circuits
+class InstanceView
+{
+    public:
+        /// @brief constructor
+        /// @param first: the sub circuit
+        /// @param second: the offset
+        /// @param third: the orientation
+        /// @param fourth: whether to mirror about the vertical center line of the sub layout before the orientation
+        explicit InstanceView(const CktGraph &child, const XY<LocType> &offset, OriType orient, bool flipVertFlag)
+            : _child(&child), _offset(offset), _orient(orient), _flipVertFlag(flipVertFlag) {}
+        /// @brief constructor
+        /// @param first: the sub circuit
+        /// @param second: the node instantiating it
+        explicit InstanceView(const CktGraph &child, const CktNode &node)
+            : InstanceView(child, node.offset(), node.orient(), node.flipVertFlag()) {}
+        /// @brief the view of a circuit mirrored about a vertical axis, as CktGraph::flipVert would leave its io shapes, without changing the circuit
+        /// @param first: the circuit
+        /// @param second: the axis x = axis
+        /// @return the view
+        static InstanceView mirrored(const CktGraph &ckt, LocType axis);
+        /*------------------------------*/
+        /* Getters                      */
+        /*------------------------------*/
+        /// @brief get the sub circuit
+        const CktGraph & child() const { return *_child; }
+        /// @brief get the offset
+        const XY<LocType> & offset() const { return _offset; }
+        /// @brief get the orientation
+        OriType orient() const { return _orient; }
+        /// @brief get whether the sub layout is mirrored before the orientation
+        bool flipVertFlag() const { return _flipVertFlag; }
+        /// @brief get the placement of the sub layout, for Layout::insertLayouts
+        LayoutPlacement placement() const { return LayoutPlacement(&_child->layout(), _offset, _orient, _flipVertFlag); }
+        /*------------------------------*/
+        /* Transforms                   */
+        /*------------------------------*/
+        /// @brief convert a coordinate of the sub circuit into the parent
+        /// @param the coordinate in the sub circuit
+        /// @return the coordinate in the parent
+        XY<LocType> toParentCoord(const XY<LocType> &coord) const { return this->toParentCoord(coord, _child->layout().boundary()); }
+        /// @brief convert a box of the sub circuit into the parent
+        /// @param the box in the sub circuit
+        /// @return the box in the parent, with its corners in order
+        Box<LocType> toParentBox(const Box<LocType> &box) const { return this->toParentBox(box, _child->layout().boundary()); }
+        /// @brief get the boundary of the sub layout in the parent
+        Box<LocType> boundary() const { const auto &bbox = _child->layout().boundary(); return this->toParentBox(bbox, bbox); }
+        /*------------------------------*/
+        /* Layout                       */
+        /*------------------------------*/
+        /// @brief get the number of rectangles of the sub layout in one layer
+        IndexType numRects(IndexType layerIdx) const { return _child->layout().numRects(layerIdx); }
+        /// @brief get a rectangle of the sub layout in the parent
+        /// @param first: the layer
+        /// @param second: the index of the rectangle in the layer
+        /// @return the rectangle in the parent
+        Box<LocType> rect(IndexType layerIdx, IndexType rectIdx) const { return this->toParentBox(_child->layout().layer(layerIdx).box(rectIdx)); }
+        /// @brief visit the rectangles of the sub layout in one layer, in the parent
+        /// @param first: the layer
+        /// @param second: called with the rectangle in the parent and its datatype
+        template<typename Visitor>
+        void forEachRect(IndexType layerIdx, Visitor &&visit) const
+        {
+            const auto &layer = _child->layout().layer(layerIdx);
+            const auto bbox = _child->layout().boundary();
+            for (IndexType rectIdx = 0; rectIdx < layer.numRects(); ++rectIdx)
+            {
+                visit(this->toParentBox(layer.box(rectIdx), bbox), layer.datatype(rectIdx));
+            }
+        }
+        /// @brief visit the texts of the sub layout in one layer, in the parent
+        /// @param first: the layer
+        /// @param second: called with the string and the coordinate in the parent
+        template<typename Visitor>
+        void forEachText(IndexType layerIdx, Visitor &&visit) const
+        {
+            const auto bbox = _child->layout().boundary();
+            for (const auto &text : _child->layout().layer(layerIdx).textList())
+            {
+                visit(text.text(), this->toParentCoord(text.coord(), bbox));
+            }
+        }
+        /// @brief append the transformed layout to a layout, as Layout::insertLayout. This is the only copy of the geometry
+        /// @param first: the layout to append to
+        /// @param second: whether to copy the texts
+        void materialize(Layout &layout, bool copyTexts = true) const { layout.insertLayout(_child->layout(), _offset, _orient, _flipVertFlag, copyTexts); }
+        /// @brief get the transformed layout as a flat layout of its own
+        /// @return the layout, with the layers of the sub layout
+        Layout materialize() const;
+        /*------------------------------*/
+        /* Io shapes                    */
+        /*------------------------------*/
+        /// @brief get the number of io shapes of a net of the sub circuit
+        IndexType numIoPins(IndexType netIdx) const { return _child->net(netIdx).numIoPins(); }
+        /// @brief get the metal layer of an io shape of a net of the sub circuit. INDEX_TYPE_MAX if the net has no io shape
+        IndexType ioLayer(IndexType netIdx, IndexType ioIdx) const { return _child->net(netIdx).ioPinMetalLayer(ioIdx); }
+        /// @brief get an io shape of a net of the sub circuit in the parent
+        /// @param first: the net of the sub circuit
+        /// @param second: the index of the io shape of the net
+        /// @return the io shape in the parent
+        Box<LocType> ioShape(IndexType netIdx, IndexType ioIdx) const { return this->toParentBox(_child->net(netIdx).ioPinShape(ioIdx)); }
+    private:
+        /// @brief convert a coordinate against a boundary of the sub layout read once by the caller
+        XY<LocType> toParentCoord(const XY<LocType> &coord, const Box<LocType> &bbox) const
+        {
+            XY<LocType> pt = coord;
+            if (_flipVertFlag)
+            {
+                pt.setX(bbox.xLo() + bbox.xHi() - pt.x());
+            }
+            return MfUtil::orientConv(pt, _orient, _offset, bbox);
+        }
+        /// @brief convert a box against a boundary of the sub layout read once by the caller
+        Box<LocType> toParentBox(const Box<LocType> &box, const Box<LocType> &bbox) const
+        {
+            XY<LocType> ll = this->toParentCoord(box.ll(), bbox);
+            XY<LocType> ur = this->toParentCoord(box.ur(), bbox);
+            return Box<LocType>(std::min(ll.x(), ur.x()), std::min(ll.y(), ur.y()), std::max(ll.x(), ur.x()), std::max(ll.y(), ur.y()));
+        }
+    private:
+        const CktGraph *_child = nullptr; ///< The sub circuit
+        XY<LocType> _offset = XY<LocType>(0, 0); ///< The offset
+        OriType _orient = OriType::N; ///< The orientation, applied as in MfUtil::orientConv
+        bool _flipVertFlag = false; ///< Whether to mirror about the vertical center line of the sub layout before the orientation
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_INSTANCE_VIEW_H_
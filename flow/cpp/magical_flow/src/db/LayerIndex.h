@@ -0,0 +1,282 @@
+/**
+ * @file LayerIndex.h
+ * @brief Uniform bin grid spatial index for the rectangles of one layout layer
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_LAYER_INDEX_H_
+#define MAGICAL_FLOW_LAYER_INDEX_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "global/global.h"
+#include "util/HeapBytes.h"
+#include "util/RectKernels.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::LayerIndex
+/// @brief Uniform bin grid over the rectangles of one layer.
+/// The grid only stores the rectangle indices. The rectangles are passed to the queries, so the index stays valid as long as the rectangles are not changed.
+/// The rectangle source can be any class providing numRects(), box(idx) returning Box<LocType>, rectBoundingBox() and the coordinate arrays xLoArray() to yHiArray(), e.g. LayoutLayer
+class LayerIndex
+{
+    public:
+        /// @brief default constructor
+        explicit LayerIndex() = default;
+        /// @brief whether the index has been built and is up to date
+        /// @return whether the index is valid
+        bool valid() const { return _valid; }
+        /// @brief get the heap bytes of the bins, beyond sizeof(LayerIndex)
+        std::size_t heapBytes() const { return HeapBytes::of(_binStart) + HeapBytes::of(_binRects); }
+        /// @brief invalidate the index
+        void invalidate() { _valid = false; _binStart.clear(); _binRects.clear(); }
+        /// @brief build the index
+        /// @param the rectangles
+        template<typename RectSource>
+        void build(const RectSource &rects);
+        /// @brief find the rectangles overlapping with a box
+        /// @param first: the rectangles the index has been built on
+        /// @param second: the query box
+        /// @param third: if true, rectangles touching the box are included (Box::intersect). Otherwise only the ones sharing area (Box::overlap)
+        /// @param fourth: output the sorted indices of rectangles
+        template<typename RectSource>
+        void queryOverlap(const RectSource &rects, const Box<LocType> &box, bool touch, std::vector<IndexType> &result) const;
+        /// @brief find the rectangles inside a window
+        /// @param first: the rectangles the index has been built on
+        /// @param second: the query window
+        /// @param third: output the sorted indices of rectangles
+        template<typename RectSource>
+        void queryWindow(const RectSource &rects, const Box<LocType> &window, std::vector<IndexType> &result) const;
+        /// @brief find the k nearest rectangles to a point. The distance is the Euclidean distance from the point to the rectangle, 0 if the point is inside
+        /// @param first: the rectangles the index has been built on
+        /// @param second: the query point
+        /// @param third: the number of rectangles to find
+        /// @param fourth: output the indices of rectangles, sorted by the distance
+        template<typename RectSource>
+        void queryNearest(const RectSource &rects, const XY<LocType> &pt, IndexType k, std::vector<IndexType> &result) const;
+    private:
+        /// @brief the column of the bin containing x, clamped into the grid
+        IndexType binX(LocType x) const
+        {
+            if (x <= _extent.xLo())
+            {
+                return 0;
+            }
+            IndexType idx = static_cast<IndexType>((static_cast<std::int64_t>(x) - _extent.xLo()) / _binWidth);
+            return std::min(idx, _numX - 1);
+        }
+        /// @brief the row of the bin containing y, clamped into the grid
+        IndexType binY(LocType y) const
+        {
+            if (y <= _extent.yLo())
+            {
+                return 0;
+            }
+            IndexType idx = static_cast<IndexType>((static_cast<std::int64_t>(y) - _extent.yLo()) / _binHeight);
+            return std::min(idx, _numY - 1);
+        }
+        /// @brief collect the rectangles of the bins covering a box, may contain duplicates
+        void collect(const Box<LocType> &box, std::vector<IndexType> &candidates) const
+        {
+            IndexType xLo = binX(box.xLo()), xHi = binX(box.xHi());
+            IndexType yLo = binY(box.yLo()), yHi = binY(box.yHi());
+            for (IndexType y = yLo; y <= yHi; ++y)
+            {
+                for (IndexType x = xLo; x <= xHi; ++x)
+                {
+                    IndexType bin = y * _numX + x;
+                    candidates.insert(candidates.end(), _binRects.begin() + _binStart[bin], _binRects.begin() + _binStart[bin + 1]);
+                }
+            }
+        }
+        /// @brief squared distance from a point to a box
+        static std::int64_t squareDistance(const Box<LocType> &box, const XY<LocType> &pt)
+        {
+            std::int64_t dx = std::max<std::int64_t>({static_cast<std::int64_t>(box.xLo()) - pt.x(), 0, static_cast<std::int64_t>(pt.x()) - box.xHi()});
+            std::int64_t dy = std::max<std::int64_t>({static_cast<std::int64_t>(box.yLo()) - pt.y(), 0, static_cast<std::int64_t>(pt.y()) - box.yHi()});
+            return dx * dx + dy * dy;
+        }
+    private:
+        static constexpr IndexType MAX_BINS_PER_DIM = 1024; ///< Upper bound of the number of bins in each dimension
+        bool _valid = false; ///< Whether the index is up to date
+        Box<LocType> _extent; ///< The bounding box of all the rectangles
+        std::int64_t _binWidth = 1; ///< The width of a bin
+        std::int64_t _binHeight = 1; ///< The height of a bin
+        IndexType _numX = 0; ///< The number of bin columns
+        IndexType _numY = 0; ///< The number of bin rows
+        std::vector<IndexType> _binStart; ///< _binRects[_binStart[bin], _binStart[bin + 1]) are the rectangles in the bin
+        std::vector<IndexType> _binRects; ///< The rectangle indices grouped by bins
+};
+
+template<typename RectSource>
+inline void LayerIndex::build(const RectSource &rects)
+{
+    _binStart.clear();
+    _binRects.clear();
+    _valid = true;
+    if (rects.numRects() == 0)
+    {
+        _numX = _numY = 0;
+        return;
+    }
+    _extent = rects.rectBoundingBox();
+    // Target about one rectangle per bin, with the bins roughly square
+    std::int64_t width = std::max<std::int64_t>(static_cast<std::int64_t>(_extent.xLen()), 1);
+    std::int64_t height = std::max<std::int64_t>(static_cast<std::int64_t>(_extent.yLen()), 1);
+    RealType numBins = static_cast<RealType>(rects.numRects());
+    RealType aspect = static_cast<RealType>(width) / static_cast<RealType>(height);
+    _numX = static_cast<IndexType>(std::ceil(std::sqrt(numBins * aspect)));
+    _numY = static_cast<IndexType>(std::ceil(std::sqrt(numBins / aspect)));
+    _numX = std::max<IndexType>(1, std::min(_numX, static_cast<IndexType>(MAX_BINS_PER_DIM)));
+    _numY = std::max<IndexType>(1, std::min(_numY, static_cast<IndexType>(MAX_BINS_PER_DIM)));
+    _binWidth = std::max<std::int64_t>(1, (width + _numX - 1) / _numX);
+    _binHeight = std::max<std::int64_t>(1, (height + _numY - 1) / _numY);
+    // Counting sort the rectangles into bins
+    _binStart.assign(_numX * _numY + 1, 0);
+    for (IndexType idx = 0; idx < rects.numRects(); ++idx)
+    {
+        const auto rect = rects.box(idx);
+        for (IndexType y = binY(rect.yLo()); y <= binY(rect.yHi()); ++y)
+        {
+            for (IndexType x = binX(rect.xLo()); x <= binX(rect.xHi()); ++x)
+            {
+                ++_binStart[y * _numX + x + 1];
+            }
+        }
+    }
+    for (IndexType bin = 0; bin < _numX * _numY; ++bin)
+    {
+        _binStart[bin + 1] += _binStart[bin];
+    }
+    _binRects.resize(_binStart.back());
+    std::vector<IndexType> fill(_binStart.begin(), _binStart.end() - 1);
+    for (IndexType idx = 0; idx < rects.numRects(); ++idx)
+    {
+        const auto rect = rects.box(idx);
+        for (IndexType y = binY(rect.yLo()); y <= binY(rect.yHi()); ++y)
+        {
+            for (IndexType x = binX(rect.xLo()); x <= binX(rect.xHi()); ++x)
+            {
+                _binRects[fill[y * _numX + x]++] = idx;
+            }
+        }
+    }
+}
+
+template<typename RectSource>
+inline void LayerIndex::queryOverlap(const RectSource &rects, const Box<LocType> &box, bool touch, std::vector<IndexType> &result) const
+{
+    Assert(_valid);
+    result.clear();
+    if (_numX == 0 || !box.intersect(_extent))
+    {
+        return;
+    }
+    std::vector<IndexType> candidates;
+    this->collect(box, candidates);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    // Refine the candidates in place with the batched box test
+    IndexType numResult = RectKernel::filterOverlap(rects.xLoArray().data(), rects.yLoArray().data(), rects.xHiArray().data(), rects.yHiArray().data(),
+            candidates.data(), candidates.size(), box, touch, candidates.data());
+    result.assign(candidates.begin(), candidates.begin() + numResult);
+}
+
+template<typename RectSource>
+inline void LayerIndex::queryWindow(const RectSource &rects, const Box<LocType> &window, std::vector<IndexType> &result) const
+{
+    Assert(_valid);
+    result.clear();
+    if (_numX == 0 || !window.intersect(_extent))
+    {
+        return;
+    }
+    std::vector<IndexType> candidates;
+    this->collect(window, candidates);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (IndexType idx : candidates)
+    {
+        if (window.contain(rects.box(idx)))
+        {
+            result.emplace_back(idx);
+        }
+    }
+}
+
+template<typename RectSource>
+inline void LayerIndex::queryNearest(const RectSource &rects, const XY<LocType> &pt, IndexType k, std::vector<IndexType> &result) const
+{
+    Assert(_valid);
+    result.clear();
+    if (_numX == 0 || k == 0)
+    {
+        return;
+    }
+    k = std::min<IndexType>(k, rects.numRects());
+    // Search the rings of bins around the bin of the point. Any rectangle outside the first r rings is at least r bins away
+    std::vector<std::pair<std::int64_t, IndexType>> found; // (squared distance, rect index)
+    std::vector<IndexType> visited;
+    IntType cx = static_cast<IntType>(binX(pt.x()));
+    IntType cy = static_cast<IntType>(binY(pt.y()));
+    IntType maxRing = static_cast<IntType>(std::max(_numX, _numY));
+    std::int64_t minBin = std::min(_binWidth, _binHeight);
+    for (IntType ring = 0; ring <= maxRing; ++ring)
+    {
+        for (IntType y = cy - ring; y <= cy + ring; ++y)
+        {
+            if (y < 0 || y >= static_cast<IntType>(_numY))
+            {
+                continue;
+            }
+            bool onRow = (y == cy - ring || y == cy + ring);
+            for (IntType x = cx - ring; x <= cx + ring; x += (onRow ? 1 : 2 * ring))
+            {
+                if (x >= 0 && x < static_cast<IntType>(_numX))
+                {
+                    IndexType bin = y * _numX + x;
+                    visited.insert(visited.end(), _binRects.begin() + _binStart[bin], _binRects.begin() + _binStart[bin + 1]);
+                }
+                if (ring == 0)
+                {
+                    break;
+                }
+            }
+        }
+        std::sort(visited.begin(), visited.end());
+        visited.erase(std::unique(visited.begin(), visited.end()), visited.end());
+        if (visited.size() >= k)
+        {
+            found.clear();
+            for (IndexType idx : visited)
+            {
+                found.emplace_back(squareDistance(rects.box(idx), pt), idx);
+            }
+            std::nth_element(found.begin(), found.begin() + (k - 1), found.end());
+            std::int64_t bound = ring * minBin;
+            if (found[k - 1].first <= bound * bound)
+            {
+                break;
+            }
+        }
+    }
+    if (found.size() < k)
+    {
+        found.clear();
+        for (IndexType idx : visited)
+        {
+            found.emplace_back(squareDistance(rects.box(idx), pt), idx);
+        }
+    }
+    std::sort(found.begin(), found.end());
+    for (IndexType idx = 0; idx < k && idx < found.size(); ++idx)
+    {
+        result.emplace_back(found[idx].second);
+    }
+}
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_LAYER_INDEX_H_
@@ -6,34 +6,388 @@
  */
 
 #include "db/Layout.h"
+#include "util/Polygon2Rect.h"
+#include "util/Tracer.h"
  
 PROJECT_NAMESPACE_BEGIN
 
-void Layout::insertLayout(Layout & layout, LocType x_offset, LocType y_offset, bool flipVertFlag)
+namespace
 {
-    for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); layerIdx++)
+    /// @brief the minimum number of rectangles in a batch for processing the layers in parallel
+    constexpr IndexType PARALLEL_INSERT_THRESHOLD = 4096;
+
+    /// @brief whether an orientation exchanges the x and y coordinates
+    bool isOrientSwapXY(OriType orient)
+    {
+        return orient == OriType::W || orient == OriType::E || orient == OriType::FW || orient == OriType::FE;
+    }
+
+    /// @brief transform shapes copied from a sub layout into the parent coordinates
+    /// The shapes are expected to be copied with their x and y exchanged if isOrientSwapXY(orient)
+    /// @param first: the placement of the sub layout
+    /// @param second: mirror the copied shapes about a vertical line, given the sum of the coordinates
+    /// @param third: mirror the copied shapes about a horizontal line, given the sum of the coordinates
+    /// @param fourth: translate the copied shapes
+    template<typename MirrorX, typename MirrorY, typename Translate>
+    void transformShapes(const LayoutPlacement &placement, MirrorX mirrorX, MirrorY mirrorY, Translate translate)
     {
-        for (IndexType recIdx = 0; recIdx < layout.numRects(layerIdx); recIdx++)
+        const Box<LocType> &bbox = placement.layout->boundary();
+        bool swapXY = isOrientSwapXY(placement.orient);
+        if (placement.flipVertFlag)
         {
-            RectLayout rect = layout.rect(layerIdx, recIdx);
-            LocType xlo, xhi, ylo, yhi;
-            if (flipVertFlag)
+            // The x coordinates of the sub layout are in the y arrays if they are exchanged
+            if (swapXY)
             {
-                LocType axis = layout.boundary().xLo() + layout.boundary().xHi();
-                xlo = axis - rect.rect().xHi() + x_offset;
-                xhi = axis - rect.rect().xLo() + x_offset;
+                mirrorY(bbox.xLo() + bbox.xHi());
             }
             else
             {
-                xlo = rect.rect().xLo() + x_offset;
-                xhi = rect.rect().xHi() + x_offset;
+                mirrorX(bbox.xLo() + bbox.xHi());
+            }
+        }
+        // Same as MfUtil::orientConv on the two corners
+        switch (placement.orient)
+        {
+            case OriType::N: break;
+            case OriType::S: mirrorX(bbox.xLen()); mirrorY(bbox.yLen()); break;
+            case OriType::W: mirrorX(bbox.yLen()); break;
+            case OriType::E: mirrorY(bbox.xLen()); break;
+            case OriType::FN: mirrorX(bbox.xLen()); break;
+            case OriType::FS: mirrorY(bbox.yLen()); break;
+            case OriType::FW: break;
+            case OriType::FE: mirrorX(bbox.yLen()); mirrorY(bbox.xLen()); break;
+        }
+        translate(placement.offset.x(), placement.offset.y());
+    }
+
+    /// @brief transform a range of rectangles copied from a sub layout into the parent coordinates
+    /// The rectangles are expected to be appended with LayoutLayer::appendRects(layer, isOrientSwapXY(orient))
+    /// @param first: the layer
+    /// @param second: the index of the first rectangle
+    /// @param third: the index after the last rectangle
+    /// @param fourth: the placement of the sub layout
+    void transformRects(LayoutLayer &layer, IndexType begin, IndexType end, const LayoutPlacement &placement)
+    {
+        transformShapes(placement,
+                [&](LocType sum) { layer.mirrorRectsX(begin, end, sum); },
+                [&](LocType sum) { layer.mirrorRectsY(begin, end, sum); },
+                [&](LocType dx, LocType dy) { layer.translateRects(begin, end, dx, dy); });
+    }
+
+    /// @brief transform a range of polygons copied from a sub layout into the parent coordinates
+    /// The polygons are expected to be appended with LayoutLayer::appendPolygons(layer, isOrientSwapXY(orient))
+    /// @param first: the layer
+    /// @param second: the index of the first polygon
+    /// @param third: the index after the last polygon
+    /// @param fourth: the placement of the sub layout
+    void transformPolygons(LayoutLayer &layer, IndexType begin, IndexType end, const LayoutPlacement &placement)
+    {
+        transformShapes(placement,
+                [&](LocType sum) { layer.mirrorPolygonsX(begin, end, sum); },
+                [&](LocType sum) { layer.mirrorPolygonsY(begin, end, sum); },
+                [&](LocType dx, LocType dy) { layer.translatePolygons(begin, end, dx, dy); });
+    }
+
+    /// @brief transform a text coordinate of a sub layout into the parent coordinates
+    XY<LocType> transformCoord(const XY<LocType> &coord, const LayoutPlacement &placement)
+    {
+        const Box<LocType> &bbox = placement.layout->boundary();
+        XY<LocType> pt = coord;
+        if (placement.flipVertFlag)
+        {
+            pt.setX(bbox.xLo() + bbox.xHi() - pt.x());
+        }
+        return MfUtil::orientConv(pt, placement.orient, placement.offset, bbox);
+    }
+}
+
+void Layout::insertLayouts(const std::vector<LayoutPlacement> &placements, bool copyTexts)
+{
+    IndexType totalRects = 0;
+    for (const auto &placement : placements)
+    {
+        AssertMsg(placement.layout != nullptr && placement.layout != this, "%s: invalid sub layout \n", __FUNCTION__);
+        AssertMsg(placement.layout->numLayers() <= this->numLayers(), "%s: sub layout has %u layers, more than %u \n", __FUNCTION__,
+                placement.layout->numLayers(), this->numLayers());
+        for (IndexType layerIdx = 0; layerIdx < placement.layout->numLayers(); ++layerIdx)
+        {
+            // The polygons are copied as they are, without their slices, and sliced again
+            totalRects += placement.layout->layer(layerIdx).numPlainRects() + placement.layout->numPolygons(layerIdx);
+        }
+    }
+    Tracer::count("rects inserted", totalRects);
+    // The layers are independent, so each thread owns whole layers. The boundary is reduced afterwards
+    const Box<LocType> emptyBox(std::numeric_limits<LocType>::max(), std::numeric_limits<LocType>::max(), std::numeric_limits<LocType>::min(), std::numeric_limits<LocType>::min());
+    std::vector<Box<LocType>> layerBoxes(this->numLayers(), emptyBox);
+    #pragma omp parallel for schedule(dynamic, 16) if (totalRects >= PARALLEL_INSERT_THRESHOLD)
+    for (IndexType layerIdx = 0; layerIdx < this->numLayers(); ++layerIdx)
+    {
+        IndexType numRectsToAdd = 0, numPolygonsToAdd = 0, numTextsToAdd = 0;
+        for (const auto &placement : placements)
+        {
+            if (layerIdx < placement.layout->numLayers())
+            {
+                numRectsToAdd += placement.layout->layer(layerIdx).numPlainRects();
+                numPolygonsToAdd += placement.layout->numPolygons(layerIdx);
+                numTextsToAdd += placement.layout->numTexts(layerIdx);
+            }
+        }
+        if (!copyTexts)
+        {
+            numTextsToAdd = 0;
+        }
+        if (numRectsToAdd == 0 && numPolygonsToAdd == 0 && numTextsToAdd == 0)
+        {
+            continue;
+        }
+        auto &layer = _layers[layerIdx];
+        IndexType firstRect = layer.numRects();
+        IndexType firstPolygon = layer.numPolygons();
+        layer.reserveRects(firstRect + numRectsToAdd);
+        layer.reserveTexts(layer.textList().size() + numTextsToAdd);
+        for (const auto &placement : placements)
+        {
+            if (layerIdx >= placement.layout->numLayers())
+            {
+                continue;
+            }
+            const auto &other = placement.layout->layer(layerIdx);
+            if (other.numPlainRects() > 0)
+            {
+                // Bulk copy the coordinate arrays, then transform the appended range in place
+                IndexType beginIdx = layer.appendRects(other, isOrientSwapXY(placement.orient));
+                IndexType endIdx = beginIdx + other.numPlainRects();
+                transformRects(layer, beginIdx, endIdx, placement);
+                layer.markFlattenedRects(beginIdx, endIdx);
+            }
+            if (other.numPolygons() > 0)
+            {
+                IndexType beginIdx = layer.appendPolygons(other, isOrientSwapXY(placement.orient));
+                IndexType endIdx = layer.numPolygons();
+                transformPolygons(layer, beginIdx, endIdx, placement);
+                layer.markFlattenedPolygons(beginIdx, endIdx);
+            }
+            if (copyTexts && !other.textList().empty())
+            {
+                IndexType beginIdx = layer.textList().size();
+                for (const auto &text : other.textList())
+                {
+                    layer.insertText(text.text(), transformCoord(text.coord(), placement));
+                }
+                layer.markFlattenedTexts(beginIdx, layer.textList().size());
             }
-            ylo = rect.rect().yLo() + y_offset;
-            yhi = rect.rect().yHi() + y_offset;
-            IndexType newRectIdx = insertRect(layerIdx, xlo, ylo, xhi, yhi);
-            setRectDatatype(layerIdx, newRectIdx, rect.datatype());
         }
+        // The rectangles are appended after the ones of firstRect. The appended polygons are sliced once transformed, after the rectangles
+        layerBoxes[layerIdx] = layer.rectBoundingBox(firstRect, firstRect + numRectsToAdd);
+        layerBoxes[layerIdx].unionBox(layer.polygonBoundingBox(firstPolygon, layer.numPolygons()));
+        layer.slicePolygons();
+    }
+    for (const auto &box : layerBoxes)
+    {
+        _boundary.unionBox(box);
+    }
+}
+
+IndexType LayoutLayer::appendRects(const LayoutLayer &other, bool swapXY)
+{
+    _index.invalidate();
+    IndexType begin = _xLo.size();
+    const auto &xLo = swapXY ? other._yLo : other._xLo;
+    const auto &yLo = swapXY ? other._xLo : other._yLo;
+    const auto &xHi = swapXY ? other._yHi : other._xHi;
+    const auto &yHi = swapXY ? other._xHi : other._yHi;
+    auto appendRange = [&](IndexType from, IndexType to)
+    {
+        _xLo.insert(_xLo.end(), xLo.begin() + from, xLo.begin() + to);
+        _yLo.insert(_yLo.end(), yLo.begin() + from, yLo.begin() + to);
+        _xHi.insert(_xHi.end(), xHi.begin() + from, xHi.begin() + to);
+        _yHi.insert(_yHi.end(), yHi.begin() + from, yHi.begin() + to);
+        _datatype.insert(_datatype.end(), other._datatype.begin() + from, other._datatype.begin() + to);
+    };
+    // Copy the rectangles between the slices of the polygons
+    IndexType from = 0;
+    for (const auto &range : other._polyRects)
+    {
+        appendRange(from, range.first);
+        from = std::max(from, range.second);
+    }
+    appendRange(from, other._xLo.size());
+    return begin;
+}
+
+void LayoutLayer::slicePendingPolygons()
+{
+    const IndexType firstPolygon = _polyRects.size();
+    ::klib::Polygon2RectBatch<LocType> batch;
+    std::vector<XY<LocType>> pts;
+    for (IndexType polyIdx = firstPolygon; polyIdx < numPolygons(); ++polyIdx)
+    {
+        pts = this->polygon(polyIdx);
+        batch.addPolygon(pts.begin(), pts.end());
+    }
+    if (!batch.run())
+    {
+        WRN("%s: failed to slice some polygons into rectangles \n", __FUNCTION__);
+    }
+    _index.invalidate();
+    IndexType numSliced = 0;
+    for (IndexType polyIdx = firstPolygon; polyIdx < numPolygons(); ++polyIdx)
+    {
+        const auto &rects = batch.rects(polyIdx - firstPolygon);
+        IndexType begin = _xLo.size();
+        for (const auto &rect : rects)
+        {
+            _xLo.emplace_back(rect.xLo());
+            _yLo.emplace_back(rect.yLo());
+            _xHi.emplace_back(rect.xHi());
+            _yHi.emplace_back(rect.yHi());
+            _datatype.emplace_back(_polyDatatype[polyIdx]);
+        }
+        _polyRects.emplace_back(begin, _xLo.size());
+        numSliced += rects.size();
+    }
+    _numSlicedRects += numSliced;
+    Tracer::count("polygon slices", numSliced);
+}
+
+void LayoutLayer::releaseSlicedRects()
+{
+    if (_polyRects.empty())
+    {
+        return;
+    }
+    _index.invalidate();
+    // The new index of each old rectangle index, for moving the flattened ranges
+    std::vector<IndexType> newIdx(_xLo.size() + 1, 0);
+    IndexType numKept = 0;
+    auto range = _polyRects.begin();
+    for (IndexType rectIdx = 0; rectIdx < _xLo.size(); ++rectIdx)
+    {
+        newIdx[rectIdx] = numKept;
+        while (range != _polyRects.end() && range->second <= rectIdx)
+        {
+            ++range;
+        }
+        if (range != _polyRects.end() && range->first <= rectIdx)
+        {
+            continue;
+        }
+        _xLo[numKept] = _xLo[rectIdx];
+        _yLo[numKept] = _yLo[rectIdx];
+        _xHi[numKept] = _xHi[rectIdx];
+        _yHi[numKept] = _yHi[rectIdx];
+        _datatype[numKept] = _datatype[rectIdx];
+        ++numKept;
+    }
+    newIdx[_xLo.size()] = numKept;
+    _xLo.resize(numKept);
+    _yLo.resize(numKept);
+    _xHi.resize(numKept);
+    _yHi.resize(numKept);
+    _datatype.resize(numKept);
+    for (auto &flattened : _flattenedRanges)
+    {
+        flattened.first = newIdx[flattened.first];
+        flattened.second = newIdx[flattened.second];
+    }
+    _polyRects.clear();
+    _numSlicedRects = 0;
+}
+
+std::vector<std::pair<IndexType, IndexType>> LayoutLayer::skippedRectRanges(bool skipFlattened) const
+{
+    std::vector<std::pair<IndexType, IndexType>> ranges;
+    for (const auto &range : _polyRects)
+    {
+        if (range.first < range.second)
+        {
+            ranges.emplace_back(range);
+        }
+    }
+    if (skipFlattened)
+    {
+        ranges.insert(ranges.end(), _flattenedRanges.begin(), _flattenedRanges.end());
+    }
+    // The polygons may be sliced in any order, so the slices are not kept sorted
+    std::sort(ranges.begin(), ranges.end());
+    // The slices and the flattened rectangles do not overlap, but may be adjacent
+    std::vector<std::pair<IndexType, IndexType>> merged;
+    for (const auto &range : ranges)
+    {
+        if (!merged.empty() && merged.back().second >= range.first)
+        {
+            merged.back().second = std::max(merged.back().second, range.second);
+        }
+        else
+        {
+            merged.emplace_back(range);
+        }
+    }
+    return merged;
+}
+
+IndexType LayoutLayer::mergeRects()
+{
+    // The polygons are kept, and sliced again after merging the other rectangles
+    this->releaseSlicedRects();
+    const IndexType numBefore = _xLo.size();
+    if (numBefore < 2)
+    {
+        this->slicePolygons();
+        return 0;
+    }
+    // Bucket the rectangles by datatype, keeping the datatypes in their first-seen order
+    std::vector<IndexType> datatypes;
+    std::vector<std::vector<Box<LocType>>> buckets;
+    for (IndexType rectIdx = 0; rectIdx < numBefore; ++rectIdx)
+    {
+        IndexType datatype = _datatype[rectIdx];
+        auto found = std::find(datatypes.begin(), datatypes.end(), datatype);
+        IndexType bucketIdx = found - datatypes.begin();
+        if (found == datatypes.end())
+        {
+            datatypes.emplace_back(datatype);
+            buckets.emplace_back();
+        }
+        buckets[bucketIdx].emplace_back(this->box(rectIdx));
+    }
+    std::vector<LocType> xLo, yLo, xHi, yHi;
+    std::vector<IndexType> datatype;
+    xLo.reserve(numBefore); yLo.reserve(numBefore); xHi.reserve(numBefore); yHi.reserve(numBefore); datatype.reserve(numBefore);
+    for (IndexType bucketIdx = 0; bucketIdx < buckets.size(); ++bucketIdx)
+    {
+        auto &rects = buckets[bucketIdx];
+        klib::boxUnionRectangles(rects);
+        for (const auto &rect : rects)
+        {
+            xLo.emplace_back(rect.xLo());
+            yLo.emplace_back(rect.yLo());
+            xHi.emplace_back(rect.xHi());
+            yHi.emplace_back(rect.yHi());
+            datatype.emplace_back(datatypes[bucketIdx]);
+        }
+    }
+    this->assignRects(xLo.size(), xLo.data(), yLo.data(), xHi.data(), yHi.data(), datatype.data());
+    _flattenedRanges.clear();
+    return numBefore - _xLo.size();
+}
+
+IndexType Layout::mergeRects()
+{
+    ScopedTimer timer("mergeRects");
+    IndexType totalRects = 0;
+    for (IndexType layerIdx = 0; layerIdx < this->numLayers(); ++layerIdx)
+    {
+        totalRects += _layers[layerIdx].numPlainRects();
+    }
+    IndexType numRemoved = 0;
+    #pragma omp parallel for schedule(dynamic, 1) reduction(+ : numRemoved) if (totalRects >= PARALLEL_INSERT_THRESHOLD)
+    for (IndexType layerIdx = 0; layerIdx < this->numLayers(); ++layerIdx)
+    {
+        numRemoved += _layers[layerIdx].mergeRects();
     }
+    Tracer::count("rects merged away", numRemoved);
+    return numRemoved;
 }
 
 // void RectLayout::shift(LocType x_offset, LocType y_offset)
@@ -11,6 +11,8 @@
 #include <utility> // std::forward
 #include <limits> // std::numeric_limits
 #include "global/global.h"
+#include "db/LayerIndex.h"
+#include "util/RectKernels.h"
 
 PROJECT_NAMESPACE_BEGIN
 
@@ -58,9 +60,15 @@ class TextLayout : public LayoutObject
         /// @brief get the text of this layout object
         /// @return the text of this layout object
         std::string & text() { return _text; }
+        /// @brief get the text of this layout object
+        /// @return the text of this layout object
+        const std::string & text() const { return _text; }
         /// @brief get the coordinate of the text object
         /// @return the reference to the text object
         XY<LocType> & coord() { return _coord; }
+        /// @brief get the coordinate of the text object
+        /// @return the reference to the text object
+        const XY<LocType> & coord() const { return _coord; }
         /*------------------------------*/ 
         /* Setters                      */
         /*------------------------------*/ 
@@ -99,7 +107,9 @@ class RectLayout : public LayoutObject
         /// @return the rectangle shape of the object
         Box<LocType> & rect() { return _rect; }
         const Box<LocType> & rect() const { return _rect; }
-        IndexType datatype() { return _datatype; }
+        /// @brief get the datatype of the shape
+        /// @return the datatype of the shape
+        IndexType datatype() const { return _datatype; }
         /// @brief set the datatype of the shape, default is 0
         void setDatatype(IndexType datatype) { _datatype = datatype; }
     private:
@@ -109,6 +119,10 @@ class RectLayout : public LayoutObject
 
 /// @class MAGICAL_FLOW::LayoutLayer
 /// @brief Data structure for one layer of the layout
+/// The rectangles are stored as structure of arrays, one array per coordinate, so that transforms and reductions over a layer are vectorized.
+/// The rectilinear polygons are kept as they are, their vertices pooled in two coordinate arrays. They are sliced into rectangles when they are inserted,
+/// and the slices are appended to the rectangles. The writers skip the slices and write the polygons instead.
+/// The const getters do not change the layer, except for building the spatial index, so a layer shared by several circuits can be read from multiple threads
 class LayoutLayer
 {
     public:
@@ -122,18 +136,138 @@ class LayoutLayer
         /// @brief get the text vector
         /// @return the text vector
         std::vector<TextLayout> & textList() { return _texts; }
-        /// @brief get the rectangle vector
-        /// @return the rectangle vector
-        const std::vector<RectLayout> & rectList() const { return _rects; }
-        /// @brief get the rectangle vector
-        /// @return the rectangle vector
-        std::vector<RectLayout> & rectList() { return _rects; }
         /// @brief get one text object
         /// @param the index of the text object
         TextLayout & text(IndexType textIdx) { return _texts.at(textIdx); }
-        /// @brief get one rectangle object
+        /// @brief get one text object
+        /// @param the index of the text object
+        const TextLayout & text(IndexType textIdx) const { return _texts.at(textIdx); }
+        /// @brief get the number of rectangles, including the ones sliced from the polygons
+        /// @return the number of rectangles
+        IndexType numRects() const { return _xLo.size(); }
+        /// @brief get the number of rectangles inserted as rectangles, without the slices of the polygons
+        IndexType numPlainRects() const { return _xLo.size() - _numSlicedRects; }
+        /// @brief get the number of rectangles stored, the same as numRects(). For going through the rectangles with skippedRectRanges(), as the writers do
+        IndexType numStoredRects() const { return _xLo.size(); }
+        /// @brief get the number of polygon vertices
+        IndexType numPolygonVertices() const { return _polyX.size(); }
+        /// @brief get the heap bytes of the layer, beyond sizeof(LayoutLayer): the texts, the rectangles with the slices, the polygons, the spatial index and the flattened ranges
+        std::size_t heapBytes() const
+        {
+            std::size_t bytes = HeapBytes::of(_texts);
+            for (const auto &text : _texts)
+            {
+                bytes += HeapBytes::of(text.text());
+            }
+            bytes += HeapBytes::of(_xLo) + HeapBytes::of(_yLo) + HeapBytes::of(_xHi) + HeapBytes::of(_yHi) + HeapBytes::of(_datatype);
+            bytes += HeapBytes::of(_polyX) + HeapBytes::of(_polyY) + HeapBytes::of(_polyStart) + HeapBytes::of(_polyDatatype) + HeapBytes::of(_polyRects);
+            bytes += _index.heapBytes();
+            bytes += HeapBytes::of(_flattenedRanges) + HeapBytes::of(_flattenedTextRanges) + HeapBytes::of(_flattenedPolyRanges);
+            return bytes;
+        }
+        /// @brief get one rectangle object. The rectangles are stored as coordinate arrays, so this is a copy
+        /// @param the index of the rectangle object
+        /// @return a copy of the rectangle object
+        RectLayout rect(IndexType rectIdx) const
+        {
+            RectLayout rect(this->box(rectIdx));
+            rect.setDatatype(_datatype[rectIdx]);
+            return rect;
+        }
+        /// @brief get the geometry of one rectangle
         /// @param the index of the rectangle object
-        RectLayout & rect(IndexType rectIdx) { return _rects.at(rectIdx); }
+        /// @return the box of the rectangle
+        Box<LocType> box(IndexType rectIdx) const
+        {
+            AssertMsg(rectIdx < _xLo.size(), "%s: rectangle index %u out of range %u \n", __FUNCTION__, rectIdx, static_cast<IndexType>(_xLo.size()));
+            return Box<LocType>(_xLo[rectIdx], _yLo[rectIdx], _xHi[rectIdx], _yHi[rectIdx]);
+        }
+        /// @brief get the datatype of one rectangle
+        /// @param the index of the rectangle object
+        /// @return the datatype of the rectangle
+        IndexType datatype(IndexType rectIdx) const { return _datatype.at(rectIdx); }
+        /// @brief get the lower x coordinates of all the rectangles
+        const std::vector<LocType> & xLoArray() const { return _xLo; }
+        /// @brief get the lower y coordinates of all the rectangles
+        const std::vector<LocType> & yLoArray() const { return _yLo; }
+        /// @brief get the upper x coordinates of all the rectangles
+        const std::vector<LocType> & xHiArray() const { return _xHi; }
+        /// @brief get the upper y coordinates of all the rectangles
+        const std::vector<LocType> & yHiArray() const { return _yHi; }
+        /// @brief get the datatypes of all the rectangles
+        const std::vector<IndexType> & datatypeArray() const { return _datatype; }
+        /// @brief get the bounding box of the rectangles
+        /// @return the bounding box. Inverted if the layer has no rectangle
+        Box<LocType> rectBoundingBox() const { return this->rectBoundingBox(0, numRects()); }
+        /*------------------------------*/ 
+        /* Polygons                     */
+        /*------------------------------*/ 
+        /// @brief get the number of polygons
+        IndexType numPolygons() const { return _polyStart.size(); }
+        /// @brief get the number of vertices of a polygon
+        /// @param the index of the polygon
+        IndexType numPolygonPoints(IndexType polyIdx) const { return this->polygonEnd(polyIdx) - _polyStart.at(polyIdx); }
+        /// @brief get a vertex of a polygon
+        /// @param first: the index of the polygon
+        /// @param second: the index of the vertex
+        XY<LocType> polygonPoint(IndexType polyIdx, IndexType ptIdx) const
+        {
+            IndexType idx = _polyStart.at(polyIdx) + ptIdx;
+            return XY<LocType>(_polyX[idx], _polyY[idx]);
+        }
+        /// @brief get the vertices of a polygon. The points are stored as coordinate arrays, so this is a copy
+        /// @param the index of the polygon
+        /// @return the vertices, without repeating the first one. The edges are alternately horizontal and vertical
+        std::vector<XY<LocType>> polygon(IndexType polyIdx) const
+        {
+            std::vector<XY<LocType>> pts;
+            pts.reserve(this->numPolygonPoints(polyIdx));
+            for (IndexType idx = _polyStart.at(polyIdx); idx < this->polygonEnd(polyIdx); ++idx)
+            {
+                pts.emplace_back(_polyX[idx], _polyY[idx]);
+            }
+            return pts;
+        }
+        /// @brief get the datatype of a polygon
+        /// @param the index of the polygon
+        IndexType polygonDatatype(IndexType polyIdx) const { return _polyDatatype.at(polyIdx); }
+        /// @brief get the x coordinates of the vertices of all the polygons
+        const std::vector<LocType> & polygonXArray() const { return _polyX; }
+        /// @brief get the y coordinates of the vertices of all the polygons
+        const std::vector<LocType> & polygonYArray() const { return _polyY; }
+        /// @brief get the index of the first vertex of each polygon in the coordinate arrays
+        const std::vector<IndexType> & polygonStartArray() const { return _polyStart; }
+        /// @brief get the datatypes of all the polygons
+        const std::vector<IndexType> & polygonDatatypeArray() const { return _polyDatatype; }
+        /// @brief get the rectangles sliced from a polygon
+        /// @param the index of the polygon
+        /// @return the [begin, end) range of the rectangles
+        std::pair<IndexType, IndexType> polygonRectRange(IndexType polyIdx) const { return _polyRects.at(polyIdx); }
+        /// @brief get the rectangles sliced from the polygons
+        /// @return the [begin, end) range of the rectangles of each polygon. Shorter than the polygons only between appendPolygons() and slicePolygons()
+        const std::vector<std::pair<IndexType, IndexType>> & slicedRectRanges() const { return _polyRects; }
+        /// @brief get the bounding box of a range of polygons
+        /// @param first: the index of the first polygon
+        /// @param second: the index after the last polygon
+        /// @return the bounding box. Inverted if the range is empty
+        Box<LocType> polygonBoundingBox(IndexType begin, IndexType end) const
+        {
+            IndexType first = begin < end ? _polyStart.at(begin) : 0;
+            IndexType last = begin < end ? this->polygonEnd(end - 1) : 0;
+            return RectKernel::boundingBox(_polyX.data() + first, _polyY.data() + first, _polyX.data() + first, _polyY.data() + first, last - first);
+        }
+        /// @brief get the ranges of rectangles skipped by the writers: the slices of the polygons, which are written as polygons, and optionally the rectangles copied from sub layouts.
+        /// @param whether to also skip the rectangles copied from sub layouts
+        /// @return the sorted vector of non-empty [begin, end) ranges of rectangle indices
+        std::vector<std::pair<IndexType, IndexType>> skippedRectRanges(bool skipFlattened) const;
+        /// @brief get the bounding box of a range of rectangles
+        /// @param first: the index of the first rectangle
+        /// @param second: the index after the last rectangle
+        /// @return the bounding box. Inverted if the range is empty
+        Box<LocType> rectBoundingBox(IndexType begin, IndexType end) const
+        {
+            return RectKernel::boundingBox(_xLo.data() + begin, _yLo.data() + begin, _xHi.data() + begin, _yHi.data() + begin, end - begin);
+        }
         /*------------------------------*/ 
         /* Add items                    */
         /*------------------------------*/ 
@@ -149,12 +283,357 @@ class LayoutLayer
         /// @brief insert rectangle object
         /// @param the RectLayout want to insert
         /// @return the index of the object inserted
-        IndexType insertRect(const RectLayout &rect) { _rects.emplace_back(rect); return _rects.size() - 1; }
+        IndexType insertRect(const RectLayout &rect)
+        {
+            _index.invalidate();
+            _xLo.emplace_back(rect.rect().xLo());
+            _yLo.emplace_back(rect.rect().yLo());
+            _xHi.emplace_back(rect.rect().xHi());
+            _yHi.emplace_back(rect.rect().yHi());
+            _datatype.emplace_back(rect.datatype());
+            return _xLo.size() - 1;
+        }
         /// @brief insert rectangle object
         /// @param paramters forward to Rectangle constructors
         /// @return the index of the object inserted
         template<typename... T>
-        IndexType insertRect(T&&... params) { _rects.emplace_back(RectLayout(std::forward<T>(params)...)); return _rects.size() - 1; }
+        IndexType insertRect(T&&... params) { const RectLayout rect(std::forward<T>(params)...); return this->insertRect(rect); }
+        /// @brief insert a rectilinear polygon and slice it into rectangles
+        /// @param first: the first vertex
+        /// @param second: past the last vertex. The vertices need x() and y(), without repeating the first one, and the edges are alternately horizontal and vertical as after klib::simplifyRectilinear
+        /// @param third: the datatype
+        /// @return the index of the polygon inserted
+        template<typename Iterator>
+        IndexType insertPolygon(Iterator first, Iterator last, IndexType datatype = 0)
+        {
+            _polyStart.emplace_back(_polyX.size());
+            for (; first != last; ++first)
+            {
+                _polyX.emplace_back(first->x());
+                _polyY.emplace_back(first->y());
+            }
+            AssertMsg(_polyX.size() - _polyStart.back() >= 4, "%s: a rectilinear polygon has at least 4 vertices \n", __FUNCTION__);
+            _polyDatatype.emplace_back(datatype);
+            this->slicePolygons();
+            return _polyStart.size() - 1;
+        }
+        /// @brief reserve the storage for texts
+        /// @param the total number of texts expected
+        void reserveTexts(IndexType numTexts) { _texts.reserve(numTexts); }
+        /// @brief reserve the storage for rectangles
+        /// @param the total number of rectangles expected
+        void reserveRects(IndexType numRects)
+        {
+            _xLo.reserve(numRects);
+            _yLo.reserve(numRects);
+            _xHi.reserve(numRects);
+            _yHi.reserve(numRects);
+            _datatype.reserve(numRects);
+        }
+        /// @brief replace all the rectangles with the given arrays, copied in bulk. The slices of the polygons are dropped, and the polygons are sliced again after the new rectangles
+        /// @param first: the number of rectangles
+        /// @param second to fifth: the lower x, lower y, upper x and upper y coordinates
+        /// @param sixth: the datatypes
+        void assignRects(IndexType numRects, const LocType *xLo, const LocType *yLo, const LocType *xHi, const LocType *yHi, const IndexType *datatype)
+        {
+            _index.invalidate();
+            _xLo.assign(xLo, xLo + numRects);
+            _yLo.assign(yLo, yLo + numRects);
+            _xHi.assign(xHi, xHi + numRects);
+            _yHi.assign(yHi, yHi + numRects);
+            _datatype.assign(datatype, datatype + numRects);
+            _polyRects.clear();
+            _numSlicedRects = 0;
+            this->slicePolygons();
+        }
+        /// @brief append the rectangles of another layer that are not sliced from its polygons, without slicing them. The coordinates are copied as they are
+        /// @param first: the layer to copy the rectangles from
+        /// @param second: if true, the x and y coordinates are exchanged, which is the first step of the 90 degree orientations
+        /// @return the index of the first rectangle appended
+        IndexType appendRects(const LayoutLayer &other, bool swapXY = false);
+        /// @brief append all the polygons of another layer. The coordinates are copied as they are, and the polygons are not sliced: transform them, then call slicePolygons()
+        /// @param first: the layer to copy the polygons from
+        /// @param second: if true, the x and y coordinates are exchanged
+        /// @return the index of the first polygon appended
+        IndexType appendPolygons(const LayoutLayer &other, bool swapXY = false)
+        {
+            IndexType begin = numPolygons();
+            IndexType offset = _polyX.size();
+            _polyX.insert(_polyX.end(), (swapXY ? other._polyY : other._polyX).begin(), (swapXY ? other._polyY : other._polyX).end());
+            _polyY.insert(_polyY.end(), (swapXY ? other._polyX : other._polyY).begin(), (swapXY ? other._polyX : other._polyY).end());
+            for (IndexType start : other._polyStart)
+            {
+                _polyStart.emplace_back(start + offset);
+            }
+            _polyDatatype.insert(_polyDatatype.end(), other._polyDatatype.begin(), other._polyDatatype.end());
+            return begin;
+        }
+        /// @brief slice the polygons appended since the last slicing and append their rectangles
+        void slicePolygons()
+        {
+            if (_polyRects.size() < _polyStart.size())
+            {
+                this->slicePendingPolygons();
+            }
+        }
+        /// @brief set the geometry of a rectangle
+        /// @param first: the index of the rectangle, not sliced from a polygon
+        /// @param second: the new box of the rectangle
+        void setRect(IndexType rectIdx, const Box<LocType> &box)
+        {
+            AssertMsg(!this->isSlicedRect(rectIdx), "%s: rectangle %u is sliced from a polygon \n", __FUNCTION__, rectIdx);
+            _index.invalidate();
+            _xLo.at(rectIdx) = box.xLo();
+            _yLo.at(rectIdx) = box.yLo();
+            _xHi.at(rectIdx) = box.xHi();
+            _yHi.at(rectIdx) = box.yHi();
+        }
+        /// @brief set the datatype of a rectangle. The datatype does not affect the spatial index
+        /// @param first: the index of the rectangle, not sliced from a polygon
+        /// @param second: the datatype
+        void setRectDatatype(IndexType rectIdx, IndexType datatype)
+        {
+            AssertMsg(!this->isSlicedRect(rectIdx), "%s: rectangle %u is sliced from a polygon \n", __FUNCTION__, rectIdx);
+            _datatype.at(rectIdx) = datatype;
+        }
+        /// @brief replace the polygons with the rectangles sliced from them, so that the rectangles can be changed. The rectangle indices are kept
+        void dissolvePolygons()
+        {
+            this->slicePolygons();
+            _polyX.clear();
+            _polyY.clear();
+            _polyStart.clear();
+            _polyDatatype.clear();
+            _polyRects.clear();
+            _flattenedPolyRanges.clear();
+            _numSlicedRects = 0;
+        }
+        /// @brief replace all the polygons with the given arrays, copied in bulk, as saved from the array getters
+        /// @param first: the number of vertices
+        /// @param second, third: the x and y coordinates of the vertices
+        /// @param fourth: the number of polygons
+        /// @param fifth: the index of the first vertex of each polygon
+        /// @param sixth: the datatype of each polygon
+        /// @param seventh: the rectangles already sliced from the first polygons, as slicedRectRanges(). They must be in the rectangles. The other polygons are sliced
+        void assignPolygons(IndexType numPts, const LocType *xs, const LocType *ys, IndexType numPolygons, const IndexType *start, const IndexType *datatype,
+                const std::vector<std::pair<IndexType, IndexType>> &slicedRanges)
+        {
+            Assert(slicedRanges.size() <= numPolygons);
+            _polyX.assign(xs, xs + numPts);
+            _polyY.assign(ys, ys + numPts);
+            _polyStart.assign(start, start + numPolygons);
+            _polyDatatype.assign(datatype, datatype + numPolygons);
+            _polyRects = slicedRanges;
+            _numSlicedRects = 0;
+            for (const auto &range : _polyRects)
+            {
+                Assert(range.first <= range.second && range.second <= _xLo.size());
+                _numSlicedRects += range.second - range.first;
+            }
+            this->slicePolygons();
+        }
+        /*------------------------------*/ 
+        /* Transforms                   */
+        /*------------------------------*/ 
+        /// @brief translate a range of rectangles, none of them sliced from a polygon
+        /// @param first: the index of the first rectangle
+        /// @param second: the index after the last rectangle
+        /// @param third: the x offset
+        /// @param fourth: the y offset
+        void translateRects(IndexType begin, IndexType end, LocType dx, LocType dy)
+        {
+            Assert(begin <= end && end <= _xLo.size() && !this->hasSlicedRect(begin, end));
+            _index.invalidate();
+            RectKernel::translate(_xLo.data() + begin, _yLo.data() + begin, _xHi.data() + begin, _yHi.data() + begin, end - begin, dx, dy);
+        }
+        /// @brief mirror a range of rectangles about a vertical line: x -> sum - x. None of them may be sliced from a polygon
+        /// @param first: the index of the first rectangle
+        /// @param second: the index after the last rectangle
+        /// @param third: twice the x coordinate of the mirror axis
+        void mirrorRectsX(IndexType begin, IndexType end, LocType sum)
+        {
+            Assert(begin <= end && end <= _xLo.size() && !this->hasSlicedRect(begin, end));
+            _index.invalidate();
+            RectKernel::mirror(_xLo.data() + begin, _xHi.data() + begin, end - begin, sum);
+        }
+        /// @brief mirror a range of rectangles about a horizontal line: y -> sum - y. None of them may be sliced from a polygon
+        /// @param first: the index of the first rectangle
+        /// @param second: the index after the last rectangle
+        /// @param third: twice the y coordinate of the mirror axis
+        void mirrorRectsY(IndexType begin, IndexType end, LocType sum)
+        {
+            Assert(begin <= end && end <= _xLo.size() && !this->hasSlicedRect(begin, end));
+            _index.invalidate();
+            RectKernel::mirror(_yLo.data() + begin, _yHi.data() + begin, end - begin, sum);
+        }
+        /// @brief translate a range of polygons. None of them may be sliced yet, as after appendPolygons()
+        /// @param first: the index of the first polygon
+        /// @param second: the index after the last polygon
+        /// @param third: the x offset
+        /// @param fourth: the y offset
+        void translatePolygons(IndexType begin, IndexType end, LocType dx, LocType dy)
+        {
+            Assert(begin >= _polyRects.size());
+            IndexType first = 0, last = 0;
+            this->polygonPointRange(begin, end, first, last);
+            RectKernel::shift(_polyX.data() + first, last - first, dx);
+            RectKernel::shift(_polyY.data() + first, last - first, dy);
+        }
+        /// @brief mirror a range of polygons about a vertical line: x -> sum - x. None of them may be sliced yet, as after appendPolygons()
+        /// @param first: the index of the first polygon
+        /// @param second: the index after the last polygon
+        /// @param third: twice the x coordinate of the mirror axis
+        void mirrorPolygonsX(IndexType begin, IndexType end, LocType sum)
+        {
+            Assert(begin >= _polyRects.size());
+            IndexType first = 0, last = 0;
+            this->polygonPointRange(begin, end, first, last);
+            RectKernel::reflect(_polyX.data() + first, last - first, sum);
+        }
+        /// @brief mirror a range of polygons about a horizontal line: y -> sum - y. None of them may be sliced yet, as after appendPolygons()
+        /// @param first: the index of the first polygon
+        /// @param second: the index after the last polygon
+        /// @param third: twice the y coordinate of the mirror axis
+        void mirrorPolygonsY(IndexType begin, IndexType end, LocType sum)
+        {
+            Assert(begin >= _polyRects.size());
+            IndexType first = 0, last = 0;
+            this->polygonPointRange(begin, end, first, last);
+            RectKernel::reflect(_polyY.data() + first, last - first, sum);
+        }
+        /// @brief replace the rectangles of each datatype with disjoint rectangles covering the same union, as klib::boxUnionRectangles.
+        /// The rectangle indices change and the rectangles are no longer marked as flattened.
+        /// The polygons are kept and not merged with the rectangles: their slices are dropped and sliced again after the merged rectangles
+        /// @return the number of rectangles removed
+        IndexType mergeRects();
+        /*------------------------------*/ 
+        /* Spatial queries              */
+        /*------------------------------*/ 
+        /// @brief get the spatial index of the rectangles. It is built lazily at the first query after the rectangles change
+        /// Building is not thread safe: build the index before querying the same layer from multiple threads
+        /// @return the spatial index
+        const LayerIndex & spatialIndex() const
+        {
+            if (!_index.valid())
+            {
+                _index.build(*this);
+            }
+            return _index;
+        }
+        /// @brief find the rectangles overlapping with a box
+        /// @param first: the query box
+        /// @param second: whether rectangles only touching the box are included
+        /// @return the sorted indices of the rectangles
+        std::vector<IndexType> queryOverlap(const Box<LocType> &box, bool touch) const
+        {
+            std::vector<IndexType> result;
+            this->spatialIndex().queryOverlap(*this, box, touch, result);
+            return result;
+        }
+        /// @brief find the rectangles inside a window
+        /// @param the query window
+        /// @return the sorted indices of the rectangles
+        std::vector<IndexType> queryWindow(const Box<LocType> &window) const
+        {
+            std::vector<IndexType> result;
+            this->spatialIndex().queryWindow(*this, window, result);
+            return result;
+        }
+        /// @brief find the k nearest rectangles to a point
+        /// @param first: the query point
+        /// @param second: the number of rectangles
+        /// @return the indices of the rectangles, sorted by the distance to the point
+        std::vector<IndexType> queryNearest(const XY<LocType> &pt, IndexType k) const
+        {
+            std::vector<IndexType> result;
+            this->spatialIndex().queryNearest(*this, pt, k, result);
+            return result;
+        }
+        /*------------------------------*/ 
+        /* Flattened instances          */
+        /*------------------------------*/ 
+        /// The marks record where Layout::insertLayout copied sub layouts, and are kept by the checkpoints. What a hierarchical writer skips is decided by InstanceShapes
+        /// @brief mark a range of rectangles as copied from a sub layout
+        /// @param first: the index of the first rectangle
+        /// @param second: the index after the last rectangle
+        void markFlattenedRects(IndexType begin, IndexType end) { markRange(_flattenedRanges, begin, end); }
+        /// @brief get the ranges of rectangles copied from sub layouts
+        /// @return the sorted vector of [begin, end) ranges of rectangle indices
+        const std::vector<std::pair<IndexType, IndexType>> & flattenedRectRanges() const { return _flattenedRanges; }
+        /// @brief mark a range of texts as copied from a sub layout
+        /// @param first: the index of the first text
+        /// @param second: the index after the last text
+        void markFlattenedTexts(IndexType begin, IndexType end) { markRange(_flattenedTextRanges, begin, end); }
+        /// @brief get the ranges of texts copied from sub layouts
+        /// @return the sorted vector of [begin, end) ranges of text indices
+        const std::vector<std::pair<IndexType, IndexType>> & flattenedTextRanges() const { return _flattenedTextRanges; }
+        /// @brief mark a range of polygons as copied from a sub layout
+        /// @param first: the index of the first polygon
+        /// @param second: the index after the last polygon
+        void markFlattenedPolygons(IndexType begin, IndexType end) { markRange(_flattenedPolyRanges, begin, end); }
+        /// @brief get the ranges of polygons copied from sub layouts
+        /// @return the sorted vector of [begin, end) ranges of polygon indices
+        const std::vector<std::pair<IndexType, IndexType>> & flattenedPolygonRanges() const { return _flattenedPolyRanges; }
+        /// @brief replace the ranges of polygons copied from sub layouts
+        /// @param the sorted [begin, end) ranges of polygon indices
+        void setFlattenedPolygonRanges(const std::vector<std::pair<IndexType, IndexType>> &polyRanges) { _flattenedPolyRanges = polyRanges; }
+        /// @brief replace the ranges of rectangles and texts copied from sub layouts
+        /// @param first: the sorted [begin, end) ranges of rectangle indices
+        /// @param second: the sorted [begin, end) ranges of text indices
+        void setFlattenedRanges(const std::vector<std::pair<IndexType, IndexType>> &rectRanges, const std::vector<std::pair<IndexType, IndexType>> &textRanges)
+        {
+            _flattenedRanges = rectRanges;
+            _flattenedTextRanges = textRanges;
+        }
+    private:
+        /// @brief slice the polygons without rectangles yet
+        void slicePendingPolygons();
+        /// @brief drop the rectangles sliced from the polygons, before merging the other rectangles. The indices of the rectangles after the slices change
+        void releaseSlicedRects();
+        /// @brief get the index after the last vertex of a polygon
+        IndexType polygonEnd(IndexType polyIdx) const { return polyIdx + 1 < _polyStart.size() ? _polyStart[polyIdx + 1] : _polyX.size(); }
+        /// @brief get the vertices of a range of polygons
+        void polygonPointRange(IndexType begin, IndexType end, IndexType &first, IndexType &last) const
+        {
+            Assert(begin <= end && end <= numPolygons());
+            first = begin < end ? _polyStart[begin] : 0;
+            last = begin < end ? this->polygonEnd(end - 1) : 0;
+        }
+        /// @brief whether a rectangle is sliced from a polygon
+        bool isSlicedRect(IndexType rectIdx) const { return this->hasSlicedRect(rectIdx, rectIdx + 1); }
+        /// @brief whether any rectangle of a range is sliced from a polygon
+        bool hasSlicedRect(IndexType begin, IndexType end) const
+        {
+            if (_numSlicedRects == 0 || begin >= end)
+            {
+                return false;
+            }
+            // The slices are sorted by the first rectangle
+            auto it = std::lower_bound(_polyRects.begin(), _polyRects.end(), begin, [](const std::pair<IndexType, IndexType> &range, IndexType idx) { return range.second <= idx; });
+            for (; it != _polyRects.end() && it->first < end; ++it)
+            {
+                if (it->first < it->second)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+        /// @brief append a [begin, end) range, merging it with the last one if they are adjacent
+        static void markRange(std::vector<std::pair<IndexType, IndexType>> &ranges, IndexType begin, IndexType end)
+        {
+            if (begin >= end)
+            {
+                return;
+            }
+            if (!ranges.empty() && ranges.back().second == begin)
+            {
+                ranges.back().second = end;
+                return;
+            }
+            ranges.emplace_back(begin, end);
+        }
+    public:
 #if 0
         /// @brief insert text object
         /// @param first: string for text
@@ -179,7 +658,35 @@ class LayoutLayer
 #endif
     private:
         std::vector<TextLayout> _texts; ///< vector of text objects
-        std::vector<RectLayout> _rects; ///< vector of rectangle objects
+        std::vector<LocType> _xLo; ///< The lower x coordinates of the rectangles, followed by the slices of each polygon when it is inserted
+        std::vector<LocType> _yLo; ///< The lower y coordinates of the rectangles
+        std::vector<LocType> _xHi; ///< The upper x coordinates of the rectangles
+        std::vector<LocType> _yHi; ///< The upper y coordinates of the rectangles
+        std::vector<IndexType> _datatype; ///< The datatypes of the rectangles
+        std::vector<LocType> _polyX; ///< The x coordinates of the vertices of the polygons
+        std::vector<LocType> _polyY; ///< The y coordinates of the vertices of the polygons
+        std::vector<IndexType> _polyStart; ///< The index of the first vertex of each polygon
+        std::vector<IndexType> _polyDatatype; ///< The datatypes of the polygons
+        std::vector<std::pair<IndexType, IndexType>> _polyRects; ///< The [begin, end) rectangles sliced from each polygon
+        IndexType _numSlicedRects = 0; ///< The number of rectangles sliced from the polygons
+        mutable LayerIndex _index; ///< The lazily built spatial index of the rectangles
+        std::vector<std::pair<IndexType, IndexType>> _flattenedRanges; ///< The [begin, end) ranges of rectangles which are copied from sub layouts through Layout::insertLayout
+        std::vector<std::pair<IndexType, IndexType>> _flattenedTextRanges; ///< The [begin, end) ranges of texts which are copied from sub layouts through Layout::insertLayout
+        std::vector<std::pair<IndexType, IndexType>> _flattenedPolyRanges; ///< The [begin, end) ranges of polygons which are copied from sub layouts through Layout::insertLayout
+};
+
+class Layout;
+
+/// @brief The placement of a sub layout inserted into a layout, with the same semantics as CktNode::toParentCoord
+struct LayoutPlacement
+{
+    explicit LayoutPlacement() = default;
+    explicit LayoutPlacement(const Layout *layout_, const XY<LocType> &offset_, OriType orient_, bool flipVertFlag_)
+        : layout(layout_), offset(offset_), orient(orient_), flipVertFlag(flipVertFlag_) {}
+    const Layout *layout = nullptr; ///< The sub layout
+    XY<LocType> offset = XY<LocType>(0, 0); ///< The offset
+    OriType orient = OriType::N; ///< The orientation, applied as in MfUtil::orientConv
+    bool flipVertFlag = false; ///< Whether to mirror the sub layout about the vertical center line of its boundary before the orientation
 };
 
 /// @class MAGICAL_FLOW::Layout
@@ -201,6 +708,8 @@ class Layout
         /// @param the number of layers
         void init(IndexType numLayers) { 
             _numLayers = numLayers; 
+            // Drop the capacity for the layers of the default constructor, so that the many small device layouts stay small
+            std::vector<LayoutLayer>(numLayers).swap(_layers);
             this->clear(); 
         }
         /*------------------------------*/ 
@@ -211,11 +720,24 @@ class Layout
         /// @param second: the index of the text in that layer
         /// @return the requested text layout object
         TextLayout & text(IndexType layerIdx, IndexType textIdx) { return _layers.at(layerIdx).text(textIdx); }
+        /// @brief get one text layout object
+        /// @param first: the index of layer
+        /// @param second: the index of the text in that layer
+        /// @return the requested text layout object
+        const TextLayout & text(IndexType layerIdx, IndexType textIdx) const { return _layers.at(layerIdx).text(textIdx); }
         /// @brief get one rect layout object
         /// @param first: the index of layer
         /// @param second: the index of the text in that layer
-        /// @return the requested rect layout object
-        RectLayout & rect(IndexType layerIdx, IndexType rectIdx) { return _layers.at(layerIdx).rect(rectIdx); }
+        /// @return a copy of the requested rect layout object
+        RectLayout rect(IndexType layerIdx, IndexType rectIdx) const { return _layers.at(layerIdx).rect(rectIdx); }
+        /// @brief get one layer of the layout
+        /// @param the index of layer
+        /// @return the layer
+        const LayoutLayer & layer(IndexType layerIdx) const { return _layers.at(layerIdx); }
+        /// @brief get one layer of the layout. Changing the rectangles through the layer does not update the boundary
+        /// @param the index of layer
+        /// @return the layer
+        LayoutLayer & layer(IndexType layerIdx) { return _layers.at(layerIdx); }
         /// @brief get the number of layers
         /// @return the number of layers
         IndexType numLayers() const { return _numLayers; }
@@ -226,7 +748,21 @@ class Layout
         /// @brief get the number of rectangles in one layer
         /// @param the index of one layer
         /// @return the number of rectangles in the layer
-        IndexType numRects(IndexType layerIdx) const { return _layers.at(layerIdx).rectList().size(); }
+        IndexType numRects(IndexType layerIdx) const { return _layers.at(layerIdx).numRects(); }
+        /// @brief get the number of polygons in one layer
+        /// @param the index of one layer
+        /// @return the number of polygons in the layer
+        IndexType numPolygons(IndexType layerIdx) const { return _layers.at(layerIdx).numPolygons(); }
+        /// @brief get the heap bytes of the layout, beyond sizeof(Layout): the layer array and the heap bytes of the layers
+        std::size_t heapBytes() const
+        {
+            std::size_t bytes = HeapBytes::of(_layers);
+            for (const auto &layer : _layers)
+            {
+                bytes += layer.heapBytes();
+            }
+            return bytes;
+        }
         /// @brief get the boundary box of layout
         /// @return boundary box
         Box<LocType> boundary() const { return _boundary; }
@@ -287,17 +823,70 @@ class Layout
             _boundary.unionBox(Box<LocType>(xLo, yLo, xHi, yHi));
             return _layers.at(layerIdx).insertRect(xLo, yLo, xHi, yHi); 
             } 
+        /// @brief insert a rectilinear polygon, as LayoutLayer::insertPolygon
+        /// @param first: layer index
+        /// @param second: the first vertex
+        /// @param third: past the last vertex
+        /// @param fourth: the datatype
+        /// @return the index of the polygon inserted
+        template<typename Iterator>
+        IndexType insertPolygon(IndexType layerIdx, Iterator first, Iterator last, IndexType datatype = 0)
+        {
+            auto &layer = _layers.at(layerIdx);
+            IndexType polyIdx = layer.insertPolygon(first, last, datatype);
+            _boundary.unionBox(layer.polygonBoundingBox(polyIdx, polyIdx + 1));
+            return polyIdx;
+        }
         /// @brief insert a Layout
         /// @param first: layout to be inserted
         /// @param second: x_offset
         /// @param third: y_offset
         /// @param fourth: boolean if to flip vertically
-        void insertLayout(Layout & layout, LocType x_offset, LocType y_offset, bool flipVertFlag);
+        /// The inserted rectangles are marked as flattened. The hierarchical writers do not rely on the marks: they compare the shapes with the instances, see InstanceShapes
+        void insertLayout(Layout & layout, LocType x_offset, LocType y_offset, bool flipVertFlag) { this->insertLayout(layout, XY<LocType>(x_offset, y_offset), OriType::N, flipVertFlag, false); }
+        /// @brief insert a Layout under an orientation
+        /// @param first: layout to be inserted
+        /// @param second: the offset
+        /// @param third: the orientation
+        /// @param fourth: whether to flip vertically before the orientation
+        /// @param fifth: whether to copy the texts
+        void insertLayout(const Layout &layout, const XY<LocType> &offset, OriType orient, bool flipVertFlag, bool copyTexts = true)
+        {
+            this->insertLayouts(std::vector<LayoutPlacement>(1, LayoutPlacement(&layout, offset, orient, flipVertFlag)), copyTexts);
+        }
+        /// @brief insert a batch of Layouts. The storage of each layer is reserved once for the whole batch and the layers are processed in parallel
+        /// @param first: the placements of the sub layouts. A sub layout may not be this layout
+        /// @param second: whether to copy the texts
+        void insertLayouts(const std::vector<LayoutPlacement> &placements, bool copyTexts = true);
+        /// @brief merge the abutting and overlapping rectangles of the same datatype in every layer, as LayoutLayer::mergeRects. The layers are processed in parallel.
+        /// Call it on a layout about to be written or routed: the rectangle indices change. The boundary is kept
+        /// @return the number of rectangles removed
+        IndexType mergeRects();
         /// @brief set the datatype of a rectangle
         /// @param first: layer index
         /// @param second: the rect index in the layer
         /// @param third: the datatype of the object
-        void setRectDatatype(IndexType layerIdx, IndexType rectIdx, IndexType datatype) {_layers.at(layerIdx).rect(rectIdx).setDatatype(datatype); }
+        void setRectDatatype(IndexType layerIdx, IndexType rectIdx, IndexType datatype) {_layers.at(layerIdx).setRectDatatype(rectIdx, datatype); }
+        /*------------------------------*/ 
+        /* Spatial queries              */
+        /*------------------------------*/ 
+        /// @brief find the rectangles overlapping with a box in one layer
+        /// @param first: layer index
+        /// @param second: the query box
+        /// @param third: whether rectangles only touching the box are included
+        /// @return the sorted indices of the rectangles in the layer
+        std::vector<IndexType> queryOverlap(IndexType layerIdx, const Box<LocType> &box, bool touch = false) const { return _layers.at(layerIdx).queryOverlap(box, touch); }
+        /// @brief find the rectangles inside a window in one layer
+        /// @param first: layer index
+        /// @param second: the query window
+        /// @return the sorted indices of the rectangles in the layer
+        std::vector<IndexType> queryWindow(IndexType layerIdx, const Box<LocType> &window) const { return _layers.at(layerIdx).queryWindow(window); }
+        /// @brief find the k nearest rectangles to a point in one layer
+        /// @param first: layer index
+        /// @param second: the query point
+        /// @param third: the number of rectangles
+        /// @return the indices of the rectangles in the layer, sorted by the distance to the point
+        std::vector<IndexType> queryNearest(IndexType layerIdx, const XY<LocType> &pt, IndexType k) const { return _layers.at(layerIdx).queryNearest(pt, k); }
         /// @brief set the boundary box of layout
         /// @param boundary box
         void setBoundary(LocType xLo, LocType yLo, LocType xHi, LocType yHi) { _boundary.set(xLo, yLo, xHi, yHi); }
@@ -0,0 +1,395 @@
+/**
+ * @file LayoutConnectivity.cpp
+ * @brief Extract the connected rectangles of a layout and compare them with the nets of the circuit
+ * @date 10/14/2026
+ */
+
+#include "db/LayoutConnectivity.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include "util/UnionFind.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+constexpr IndexType LayoutConnectivity::PARALLEL_EXTRACT_THRESHOLD;
+
+namespace
+{
+    /// @brief split a diffusion rectangle into the pieces outside the gates overlapping it
+    /// @param first: the diffusion rectangle
+    /// @param second: the gate layer, with its spatial index built
+    /// @param third: a buffer for the queries
+    /// @param fourth: output the disjoint pieces. Only the pieces not separated by a gate touch
+    void splitAtGates(const Box<LocType> &diffusion, const LayoutLayer &gates, std::vector<IndexType> &buffer, std::vector<Box<LocType>> &pieces)
+    {
+        pieces.assign(1, diffusion);
+        gates.spatialIndex().queryOverlap(gates, diffusion, false, buffer);
+        std::vector<Box<LocType>> remains;
+        for (IndexType gateIdx : buffer)
+        {
+            const Box<LocType> gate = gates.box(gateIdx);
+            remains.clear();
+            for (const auto &piece : pieces)
+            {
+                if (!piece.overlap(gate))
+                {
+                    remains.emplace_back(piece);
+                    continue;
+                }
+                // The full height strips on the left and the right, then the strips below and above the gate between them
+                if (piece.xLo() < gate.xLo())
+                {
+                    remains.emplace_back(piece.xLo(), piece.yLo(), gate.xLo(), piece.yHi());
+                }
+                if (gate.xHi() < piece.xHi())
+                {
+                    remains.emplace_back(gate.xHi(), piece.yLo(), piece.xHi(), piece.yHi());
+                }
+                const LocType xLo = std::max(piece.xLo(), gate.xLo());
+                const LocType xHi = std::min(piece.xHi(), gate.xHi());
+                if (piece.yLo() < gate.yLo())
+                {
+                    remains.emplace_back(xLo, piece.yLo(), xHi, gate.yLo());
+                }
+                if (gate.yHi() < piece.yHi())
+                {
+                    remains.emplace_back(xLo, gate.yHi(), xHi, piece.yHi());
+                }
+            }
+            pieces.swap(remains);
+        }
+    }
+}
+
+void LayoutConnectivity::collectLabels(const CktGraph &ckt, const NetPinShapes *pinShapes, std::vector<Label> &labels) const
+{
+    const IndexType numLayers = ckt.layout().numLayers();
+    auto addLabel = [&](IndexType netIdx, IndexType metalLayer, const Box<LocType> &shape)
+    {
+        IndexType layer = metalLayer == INDEX_TYPE_MAX ? INDEX_TYPE_MAX : _techDB.metalLayerToDb(metalLayer);
+        if (layer < numLayers && shape.xLo() <= shape.xHi() && shape.yLo() <= shape.yHi())
+        {
+            labels.push_back(Label{netIdx, layer, shape});
+        }
+    };
+    for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+    {
+        const auto &net = ckt.net(netIdx);
+        for (IndexType ioIdx = 0; ioIdx < net.numIoPins(); ++ioIdx)
+        {
+            addLabel(netIdx, net.ioPinMetalLayer(ioIdx), net.ioPinShape(ioIdx));
+        }
+    }
+    if (pinShapes != nullptr)
+    {
+        AssertMsg(pinShapes->numNets() == ckt.numNets(), "%s: pin shapes of %u nets for %u nets \n", __FUNCTION__, pinShapes->numNets(), ckt.numNets());
+        for (IndexType netIdx = 0; netIdx < pinShapes->numNets(); ++netIdx)
+        {
+            const IndexType begin = pinShapes->shapeStart(netIdx);
+            for (IndexType shapeIdx = begin; shapeIdx < begin + pinShapes->numShapes(netIdx); ++shapeIdx)
+            {
+                addLabel(netIdx, pinShapes->layer(shapeIdx), pinShapes->shape(shapeIdx));
+            }
+        }
+    }
+    if (_useTexts)
+    {
+        std::unordered_map<std::string, IndexType> netByName;
+        for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+        {
+            netByName.emplace(ckt.net(netIdx).name(), netIdx);
+        }
+        for (IndexType layerIdx = 0; layerIdx < numLayers; ++layerIdx)
+        {
+            for (const auto &text : ckt.layout().layer(layerIdx).textList())
+            {
+                auto found = netByName.find(text.text());
+                if (found != netByName.end())
+                {
+                    labels.push_back(Label{found->second, layerIdx, Box<LocType>(text.coord())});
+                }
+            }
+        }
+    }
+}
+
+IndexType LayoutConnectivity::check(const CktGraph &ckt, const NetPinShapes *pinShapes)
+{
+    const Layout &layout = ckt.layout();
+    const IndexType numLayers = layout.numLayers();
+    // The layers carrying the connections
+    const bool hasStack = _techDB.hasLayerStack();
+    std::vector<char> conducting(numLayers, hasStack ? 0 : 1);
+    for (IndexType layerIdx = 0; hasStack && layerIdx < std::min(numLayers, _techDB.numLayers()); ++layerIdx)
+    {
+        if (_techDB.isCutLayer(layerIdx))
+        {
+            conducting[layerIdx] = 1;
+            for (IndexType other : _techDB.cutConnections(layerIdx))
+            {
+                if (other < numLayers)
+                {
+                    conducting[other] = 1;
+                }
+            }
+        }
+    }
+    // The diffusion layers split at their gates
+    std::vector<IndexType> gateLayers(numLayers, INDEX_TYPE_MAX);
+    std::vector<char> indexed(conducting);
+    for (IndexType layerIdx = 0; hasStack && layerIdx < std::min(numLayers, _techDB.numLayers()); ++layerIdx)
+    {
+        if (conducting[layerIdx] && _techDB.gateLayer(layerIdx) < numLayers)
+        {
+            gateLayers[layerIdx] = _techDB.gateLayer(layerIdx);
+            indexed[gateLayers[layerIdx]] = 1;
+        }
+    }
+    _layerStart.assign(numLayers + 1, 0);
+    for (IndexType layerIdx = 0; layerIdx < numLayers; ++layerIdx)
+    {
+        _layerStart[layerIdx + 1] = _layerStart[layerIdx] + layout.numRects(layerIdx);
+    }
+    const IndexType numRects = _layerStart.back();
+    std::vector<Label> labels;
+    this->collectLabels(ckt, pinShapes, labels);
+    // The spatial indices are built lazily and not thread safe: build them first, one thread per layer
+    #pragma omp parallel for schedule(dynamic, 1) if (numRects >= PARALLEL_EXTRACT_THRESHOLD)
+    for (IndexType layerIdx = 0; layerIdx < numLayers; ++layerIdx)
+    {
+        if (indexed[layerIdx])
+        {
+            layout.layer(layerIdx).spatialIndex();
+        }
+    }
+    // The pieces of the diffusion rectangles outside the gates, in the order of the rectangles
+    std::vector<IndexType> diffusionRects;
+    for (IndexType layerIdx = 0; layerIdx < numLayers; ++layerIdx)
+    {
+        if (gateLayers[layerIdx] != INDEX_TYPE_MAX)
+        {
+            for (IndexType globalIdx = _layerStart[layerIdx]; globalIdx < _layerStart[layerIdx + 1]; ++globalIdx)
+            {
+                diffusionRects.emplace_back(globalIdx);
+            }
+        }
+    }
+    std::vector<std::vector<Box<LocType>>> rectPieces(diffusionRects.size());
+    #pragma omp parallel if (diffusionRects.size() >= PARALLEL_EXTRACT_THRESHOLD)
+    {
+        std::vector<IndexType> buffer;
+        #pragma omp for schedule(dynamic, 256)
+        for (IndexType idx = 0; idx < diffusionRects.size(); ++idx)
+        {
+            const IndexType globalIdx = diffusionRects[idx];
+            const IndexType layerIdx = static_cast<IndexType>(std::upper_bound(_layerStart.begin(), _layerStart.end(), globalIdx) - _layerStart.begin()) - 1;
+            splitAtGates(layout.layer(layerIdx).box(globalIdx - _layerStart[layerIdx]), layout.layer(gateLayers[layerIdx]), buffer, rectPieces[idx]);
+        }
+    }
+    std::vector<IndexType> pieceStart(numRects + 1, 0); // The offset of the pieces of each rectangle, CSR
+    for (IndexType idx = 0; idx < diffusionRects.size(); ++idx)
+    {
+        pieceStart[diffusionRects[idx] + 1] = rectPieces[idx].size();
+    }
+    std::partial_sum(pieceStart.begin(), pieceStart.end(), pieceStart.begin());
+    std::vector<Box<LocType>> pieces;
+    std::vector<IndexType> pieceRects; // The rectangle of each piece
+    pieces.reserve(pieceStart.back());
+    pieceRects.reserve(pieceStart.back());
+    for (IndexType idx = 0; idx < diffusionRects.size(); ++idx)
+    {
+        pieces.insert(pieces.end(), rectPieces[idx].begin(), rectPieces[idx].end());
+        pieceRects.insert(pieceRects.end(), rectPieces[idx].size(), diffusionRects[idx]);
+    }
+    rectPieces.clear();
+    rectPieces.shrink_to_fit();
+    const IndexType pieceBegin = numRects + labels.size(); // The first piece in the union-find
+    // Unite the touching rectangles of a layer and the rectangles overlapping the cuts
+    ConcurrentUnionFind sets(pieceBegin + pieces.size());
+    // Unite a rectangle, or the pieces of a diffusion rectangle, with the sets of a shape overlapping it
+    auto uniteOverlap = [&](IndexType element, IndexType layerIdx, IndexType rectIdx, const Box<LocType> &shape, bool touch)
+    {
+        const IndexType globalIdx = _layerStart[layerIdx] + rectIdx;
+        if (gateLayers[layerIdx] == INDEX_TYPE_MAX)
+        {
+            sets.unite(element, globalIdx);
+            return;
+        }
+        for (IndexType pieceIdx = pieceStart[globalIdx]; pieceIdx < pieceStart[globalIdx + 1]; ++pieceIdx)
+        {
+            if (touch ? pieces[pieceIdx].intersect(shape) : pieces[pieceIdx].overlap(shape))
+            {
+                sets.unite(element, pieceBegin + pieceIdx);
+            }
+        }
+    };
+    #pragma omp parallel if (numRects >= PARALLEL_EXTRACT_THRESHOLD)
+    {
+        std::vector<IndexType> buffer;
+        #pragma omp for schedule(dynamic, 256)
+        for (IndexType globalIdx = 0; globalIdx < numRects; ++globalIdx)
+        {
+            const IndexType layerIdx = static_cast<IndexType>(std::upper_bound(_layerStart.begin(), _layerStart.end(), globalIdx) - _layerStart.begin()) - 1;
+            if (!conducting[layerIdx])
+            {
+                continue;
+            }
+            const IndexType rectIdx = globalIdx - _layerStart[layerIdx];
+            const LayoutLayer &layer = layout.layer(layerIdx);
+            const Box<LocType> box = layer.box(rectIdx);
+            layer.spatialIndex().queryOverlap(layer, box, true, buffer);
+            if (gateLayers[layerIdx] != INDEX_TYPE_MAX)
+            {
+                // The touching pieces of the diffusion, and the rectangle in the set of its first piece
+                const IndexType begin = pieceStart[globalIdx];
+                const IndexType end = pieceStart[globalIdx + 1];
+                for (IndexType pieceIdx = begin; pieceIdx < end; ++pieceIdx)
+                {
+                    for (IndexType otherIdx = pieceIdx + 1; otherIdx < end; ++otherIdx)
+                    {
+                        if (pieces[pieceIdx].intersect(pieces[otherIdx]))
+                        {
+                            sets.unite(pieceBegin + pieceIdx, pieceBegin + otherIdx);
+                        }
+                    }
+                    for (IndexType other : buffer)
+                    {
+                        if (other > rectIdx)
+                        {
+                            uniteOverlap(pieceBegin + pieceIdx, layerIdx, other, pieces[pieceIdx], true);
+                        }
+                    }
+                }
+                if (begin < end)
+                {
+                    sets.unite(globalIdx, pieceBegin + begin);
+                }
+                continue;
+            }
+            for (IndexType other : buffer)
+            {
+                if (other > rectIdx)
+                {
+                    sets.unite(globalIdx, _layerStart[layerIdx] + other);
+                }
+            }
+            if (!hasStack || layerIdx >= _techDB.numLayers())
+            {
+                continue;
+            }
+            for (IndexType otherLayerIdx : _techDB.cutConnections(layerIdx))
+            {
+                if (otherLayerIdx >= numLayers)
+                {
+                    continue;
+                }
+                const LayoutLayer &otherLayer = layout.layer(otherLayerIdx);
+                otherLayer.spatialIndex().queryOverlap(otherLayer, box, false, buffer);
+                for (IndexType other : buffer)
+                {
+                    uniteOverlap(globalIdx, otherLayerIdx, other, box, false);
+                }
+            }
+        }
+    }
+    // A label connects the rectangles it overlaps
+    std::vector<IndexType> buffer;
+    for (IndexType labelIdx = 0; labelIdx < labels.size(); ++labelIdx)
+    {
+        const auto &label = labels[labelIdx];
+        if (!conducting[label.layer])
+        {
+            continue;
+        }
+        const LayoutLayer &layer = layout.layer(label.layer);
+        layer.spatialIndex().queryOverlap(layer, label.shape, true, buffer);
+        for (IndexType other : buffer)
+        {
+            uniteOverlap(numRects + labelIdx, label.layer, other, label.shape, true);
+        }
+    }
+    // Number the components by their roots, the smallest element of each
+    _components.assign(sets.size(), INDEX_TYPE_MAX);
+    _numComponents = 0;
+    std::vector<IndexType> componentRects; // The first rectangle of each component, or the rectangle of its first piece
+    for (IndexType idx = 0; idx < sets.size(); ++idx)
+    {
+        const IndexType layerIdx = idx < numRects ? static_cast<IndexType>(std::upper_bound(_layerStart.begin(), _layerStart.end(), idx) - _layerStart.begin()) - 1 : INDEX_TYPE_MAX;
+        if (idx < numRects && !conducting[layerIdx])
+        {
+            continue;
+        }
+        const IndexType root = sets.find(idx);
+        if (root == idx)
+        {
+            _components[idx] = _numComponents++;
+            componentRects.emplace_back(INDEX_TYPE_MAX);
+        }
+        else
+        {
+            _components[idx] = _components[root];
+        }
+        IndexType &componentRect = componentRects[_components[idx]];
+        if (componentRect == INDEX_TYPE_MAX)
+        {
+            componentRect = idx < numRects ? idx : (idx >= pieceBegin ? pieceRects[idx - pieceBegin] : INDEX_TYPE_MAX);
+        }
+    }
+    // The nets of the components, and the components of the nets
+    std::vector<std::pair<IndexType, IndexType>> netComponents; // (net, component)
+    for (IndexType labelIdx = 0; labelIdx < labels.size(); ++labelIdx)
+    {
+        if (_components[numRects + labelIdx] != INDEX_TYPE_MAX)
+        {
+            netComponents.emplace_back(labels[labelIdx].net, _components[numRects + labelIdx]);
+        }
+    }
+    std::sort(netComponents.begin(), netComponents.end());
+    netComponents.erase(std::unique(netComponents.begin(), netComponents.end()), netComponents.end());
+    _openNets.clear();
+    _openNumComponents.clear();
+    for (IndexType begin = 0, end = 0; begin < netComponents.size(); begin = end)
+    {
+        while (end < netComponents.size() && netComponents[end].first == netComponents[begin].first)
+        {
+            ++end;
+        }
+        if (end - begin > 1)
+        {
+            _openNets.emplace_back(netComponents[begin].first);
+            _openNumComponents.emplace_back(end - begin);
+        }
+    }
+    for (auto &netComponent : netComponents)
+    {
+        std::swap(netComponent.first, netComponent.second);
+    }
+    std::sort(netComponents.begin(), netComponents.end());
+    _componentNets.assign(_numComponents, INDEX_TYPE_MAX);
+    _shortNets.clear();
+    _shortOtherNets.clear();
+    _shortLayers.clear();
+    _shortRects.clear();
+    for (IndexType idx = 0; idx < netComponents.size(); ++idx)
+    {
+        const IndexType compIdx = netComponents[idx].first;
+        const IndexType netIdx = netComponents[idx].second;
+        if (_componentNets[compIdx] == INDEX_TYPE_MAX)
+        {
+            _componentNets[compIdx] = netIdx;
+            continue;
+        }
+        // Only the rectangles and the pieces connect different labels, so that a short component has one
+        const IndexType rectIdx = componentRects[compIdx];
+        Assert(rectIdx < numRects);
+        const IndexType layerIdx = static_cast<IndexType>(std::upper_bound(_layerStart.begin(), _layerStart.end(), rectIdx) - _layerStart.begin()) - 1;
+        _shortNets.emplace_back(_componentNets[compIdx]);
+        _shortOtherNets.emplace_back(netIdx);
+        _shortLayers.emplace_back(layerIdx);
+        _shortRects.emplace_back(rectIdx - _layerStart[layerIdx]);
+    }
+    return this->numOpens() + this->numShorts();
+}
+
+PROJECT_NAMESPACE_END
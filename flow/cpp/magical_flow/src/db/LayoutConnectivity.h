@@ -0,0 +1,117 @@
+/**
+ * @file LayoutConnectivity.h
+ * @brief Extract the connected rectangles of a layout and compare them with the nets of the circuit
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_LAYOUT_CONNECTIVITY_H_
+#define MAGICAL_FLOW_LAYOUT_CONNECTIVITY_H_
+
+#include "db/DesignDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::LayoutConnectivity
+/// @brief A quick connectivity check of a routed layout before LVS.
+/// The rectangles of a layer touching each other are connected, and the rectangles of a cut layer connect the rectangles they overlap on the layers of TechDB::cutConnections.
+/// If the technology has no layer stack, only the rectangles of one layer are connected. Otherwise the layers neither cut nor connected by a cut, such as the implants, are skipped.
+/// A diffusion layer of TechDB::gateLayer does not conduct under its gates: its rectangles are split into the pieces outside the gates crossing them,
+/// so that the contacts on the source and the drain of a MOS stay apart. The component of a diffusion rectangle is that of its first piece.
+/// The components are labeled with the nets by the io shapes of the nets, the pin shapes of NetPinShapes and the texts naming a net. A label connects all the rectangles it overlaps on its layer.
+/// A net labeling more than one component is open, and a component labeled by more than one net is a short
+class LayoutConnectivity
+{
+    public:
+        /// @brief constructor
+        /// @param the technology database with the layer stack
+        explicit LayoutConnectivity(const TechDB &techDB) : _techDB(techDB) {}
+        /// @brief set whether the texts label the components. The texts of the sub layouts may name the nets of the sub circuits
+        /// @param whether to use the texts. true by default
+        void setUseTexts(bool useTexts) { _useTexts = useTexts; }
+        /// @brief extract the layout of a circuit and compare it with the nets
+        /// @param first: the circuit
+        /// @param second: the pin shapes of the nets. nullptr for the io shapes and the texts only
+        /// @return the number of opens and shorts
+        IndexType check(const CktGraph &ckt, const NetPinShapes *pinShapes);
+        /// @brief extract the layout of a circuit and compare it with the nets, labeled by the pin shapes of the design
+        /// @param first: the design
+        /// @param second: the index of the circuit
+        /// @return the number of opens and shorts
+        IndexType check(const DesignDB &designDB, IndexType cktIdx) { return this->check(designDB.subCkt(cktIdx), designDB.netPinShapes(cktIdx).get()); }
+        /*------------------------------*/
+        /* Getters                      */
+        /*------------------------------*/
+        /// @brief get the number of connected components, including the unconnected labels
+        IndexType numComponents() const { return _numComponents; }
+        /// @brief get the component of a rectangle
+        /// @param first: the index of the layer
+        /// @param second: the index of the rectangle
+        /// @return the component. INDEX_TYPE_MAX for the skipped layers
+        IndexType component(IndexType layerIdx, IndexType rectIdx) const { return _components.at(_layerStart.at(layerIdx) + rectIdx); }
+        /// @brief get the net of a component
+        /// @param the index of the component
+        /// @return the smallest net labeling the component. INDEX_TYPE_MAX if not labeled
+        IndexType componentNet(IndexType compIdx) const { return _componentNets.at(compIdx); }
+        /// @brief get the number of open nets
+        IndexType numOpens() const { return _openNets.size(); }
+        /// @brief get an open net
+        /// @param the index of the open
+        IndexType openNet(IndexType openIdx) const { return _openNets.at(openIdx); }
+        /// @brief get the number of components an open net labels
+        /// @param the index of the open
+        IndexType openNumComponents(IndexType openIdx) const { return _openNumComponents.at(openIdx); }
+        /// @brief get the number of shorts, one per extra net of a component
+        IndexType numShorts() const { return _shortNets.size(); }
+        /// @brief get the smallest net of a short component
+        /// @param the index of the short
+        IndexType shortNet(IndexType shortIdx) const { return _shortNets.at(shortIdx); }
+        /// @brief get the other net of a short
+        /// @param the index of the short
+        IndexType shortOtherNet(IndexType shortIdx) const { return _shortOtherNets.at(shortIdx); }
+        /// @brief get the layer of a rectangle of a short component
+        /// @param the index of the short
+        IndexType shortLayer(IndexType shortIdx) const { return _shortLayers.at(shortIdx); }
+        /// @brief get a rectangle of a short component, the first one of its lowest layer
+        /// @param the index of the short
+        IndexType shortRect(IndexType shortIdx) const { return _shortRects.at(shortIdx); }
+        /// @brief get the open nets
+        const std::vector<IndexType> & openNetArray() const { return _openNets; }
+        /// @brief get the number of components of each open net
+        const std::vector<IndexType> & openNumComponentsArray() const { return _openNumComponents; }
+        /// @brief get the smallest nets of the shorts
+        const std::vector<IndexType> & shortNetArray() const { return _shortNets; }
+        /// @brief get the other nets of the shorts
+        const std::vector<IndexType> & shortOtherNetArray() const { return _shortOtherNets; }
+        /// @brief get the layers of the shorts
+        const std::vector<IndexType> & shortLayerArray() const { return _shortLayers; }
+        /// @brief get the rectangles of the shorts
+        const std::vector<IndexType> & shortRectArray() const { return _shortRects; }
+    private:
+        /// @brief a label of a net
+        struct Label
+        {
+            IndexType net; ///< The net
+            IndexType layer; ///< The db layer
+            Box<LocType> shape; ///< The shape, a point for a text
+        };
+        /// @brief collect the labels of the nets
+        void collectLabels(const CktGraph &ckt, const NetPinShapes *pinShapes, std::vector<Label> &labels) const;
+    private:
+        static constexpr IndexType PARALLEL_EXTRACT_THRESHOLD = 4096; ///< The number of rectangles to extract in parallel
+        const TechDB &_techDB; ///< The technology database
+        bool _useTexts = true; ///< Whether the texts label the components
+        std::vector<IndexType> _layerStart; ///< The offset of the rectangles of each layer in _components, one more than the layers
+        std::vector<IndexType> _components; ///< The component of each rectangle of all the layers, then of each label, then of each diffusion piece
+        IndexType _numComponents = 0; ///< The number of components
+        std::vector<IndexType> _componentNets; ///< The smallest net of each component
+        std::vector<IndexType> _openNets; ///< The open nets
+        std::vector<IndexType> _openNumComponents; ///< The number of components of each open net
+        std::vector<IndexType> _shortNets; ///< The smallest net of each short
+        std::vector<IndexType> _shortOtherNets; ///< The other net of each short
+        std::vector<IndexType> _shortLayers; ///< The layer of each short
+        std::vector<IndexType> _shortRects; ///< The rectangle of each short
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_LAYOUT_CONNECTIVITY_H_
@@ -0,0 +1,258 @@
+/**
+ * @file MemoryUsage.cpp
+ * @brief The memory footprint of the circuits, per component and per layout layer, for a circuit, a sub hierarchy or a design
+ * @date 10/14/2026
+ */
+
+#include "db/MemoryUsage.h"
+#include <cstdio>
+#include <unordered_set>
+#include "util/Tracer.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the objects shared by the circuits which are already counted
+    struct SharedSeen
+    {
+        std::unordered_set<const void *> layouts;
+        std::unordered_set<const void *> constraints;
+    };
+
+    /// @brief the bytes of the elements of an array by its capacity, and of the heap blocks they own
+    template<typename Array>
+    MemoryStat arrayStat(const Array &array)
+    {
+        MemoryStat stat;
+        stat.count = array.size();
+        stat.bytes = HeapBytes::of(array);
+        for (const auto &elem : array)
+        {
+            stat.bytes += elem.heapBytes();
+        }
+        return stat;
+    }
+
+    /// @brief add the footprint of a circuit
+    /// @param first: the circuit
+    /// @param second: the objects already counted. nullptr to count them regardless
+    /// @param third: the footprint
+    void addCkt(const CktGraph &ckt, SharedSeen *seen, MemoryUsage &usage)
+    {
+        usage.circuits.bytes += sizeof(CktGraph) + HeapBytes::of(ckt.name());
+        usage.circuits.count += 1;
+        usage.nodes += arrayStat(ckt.nodeArray());
+        usage.pins += arrayStat(ckt.pinArray());
+        usage.nets += arrayStat(ckt.netArray());
+        for (const auto &net : ckt.netArray())
+        {
+            usage.ioInterfaces.bytes += net.ioHeapBytes();
+            usage.ioInterfaces.count += net.numSetIoPins();
+        }
+        usage.connectivity.bytes += ckt.connectivityHeapBytes();
+        usage.connectivity.count += ckt.numPackedPins();
+        if (!ckt.gdsData().gdsFile().empty())
+        {
+            usage.gdsData.count += 1;
+        }
+        usage.gdsData.bytes += ckt.gdsData().heapBytes();
+        if (ckt.hasConstraint() && (seen == nullptr || seen->constraints.insert(&ckt.constraint()).second))
+        {
+            usage.constraint.bytes += sizeof(CktConstraint) + ckt.constraint().heapBytes();
+            usage.constraint.count += 1;
+        }
+        if (!ckt.hasLayout() || (seen != nullptr && !seen->layouts.insert(&ckt.layout()).second))
+        {
+            return;
+        }
+        const Layout &layout = ckt.layout();
+        if (usage.layers.size() < layout.numLayers())
+        {
+            usage.layers.resize(layout.numLayers());
+        }
+        std::size_t layerBytes = 0;
+        for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); ++layerIdx)
+        {
+            const LayoutLayer &layer = layout.layer(layerIdx);
+            MemoryStat &stat = usage.layers[layerIdx];
+            stat.bytes += sizeof(LayoutLayer) + layer.heapBytes();
+            stat.count += layer.textList().size() + layer.numStoredRects() + layer.numPolygons();
+            layerBytes += sizeof(LayoutLayer) + layer.heapBytes();
+        }
+        // The layer array holds the layers. The slack of its capacity stays with the layout
+        usage.layout.bytes += sizeof(Layout) + layout.heapBytes() - layerBytes;
+        usage.layout.count += 1;
+    }
+
+    /// @brief get the name of a db layer
+    std::string layerName(const TechDB *techDB, IndexType layerIdx)
+    {
+        if (techDB != nullptr && layerIdx < techDB->numLayers() && !techDB->layerName(layerIdx).empty())
+        {
+            return techDB->layerName(layerIdx);
+        }
+        return std::to_string(layerIdx);
+    }
+}
+
+MemoryStat MemoryUsage::layoutTotal() const
+{
+    MemoryStat stat = layout;
+    for (const auto &layer : layers)
+    {
+        stat.bytes += layer.bytes;
+    }
+    return stat;
+}
+
+std::size_t MemoryUsage::totalBytes() const
+{
+    return circuits.bytes + nodes.bytes + pins.bytes + nets.bytes + ioInterfaces.bytes + connectivity.bytes + constraint.bytes + gdsData.bytes
+        + layoutTotal().bytes + names.bytes + techDB.bytes;
+}
+
+MemoryUsage & MemoryUsage::operator+=(const MemoryUsage &rhs)
+{
+    circuits += rhs.circuits;
+    nodes += rhs.nodes;
+    pins += rhs.pins;
+    nets += rhs.nets;
+    ioInterfaces += rhs.ioInterfaces;
+    connectivity += rhs.connectivity;
+    constraint += rhs.constraint;
+    gdsData += rhs.gdsData;
+    layout += rhs.layout;
+    if (layers.size() < rhs.layers.size())
+    {
+        layers.resize(rhs.layers.size());
+    }
+    for (IndexType layerIdx = 0; layerIdx < rhs.layers.size(); ++layerIdx)
+    {
+        layers[layerIdx] += rhs.layers[layerIdx];
+    }
+    names += rhs.names;
+    techDB += rhs.techDB;
+    arena += rhs.arena;
+    return *this;
+}
+
+std::string MemoryUsage::summary(const TechDB *techDB) const
+{
+    std::string table;
+    char line[256];
+    auto addRow = [&](const std::string &component, const MemoryStat &stat)
+    {
+        std::snprintf(line, sizeof(line), "%-24s %12zu %16zu %10.3f\n", component.c_str(), stat.count, stat.bytes, stat.bytes / 1048576.0);
+        table += line;
+    };
+    std::snprintf(line, sizeof(line), "%-24s %12s %16s %10s\n", "component", "count", "bytes", "MB");
+    table += line;
+    addRow("circuits", circuits);
+    addRow("nodes", nodes);
+    addRow("pins", pins);
+    addRow("nets", nets);
+    addRow("io interfaces", ioInterfaces);
+    addRow("connectivity", connectivity);
+    addRow("constraint", constraint);
+    addRow("gds data", gdsData);
+    addRow("layout", layout);
+    for (IndexType layerIdx = 0; layerIdx < layers.size(); ++layerIdx)
+    {
+        if (layers[layerIdx].count > 0)
+        {
+            addRow("  layer " + layerName(techDB, layerIdx), layers[layerIdx]);
+        }
+    }
+    addRow("names", names);
+    addRow("tech db", this->techDB);
+    MemoryStat total;
+    total.bytes = totalBytes();
+    addRow("total", total);
+    addRow("arena (overlapping)", arena);
+    return table;
+}
+
+void MemoryUsage::trace(const std::string &name) const
+{
+    if (!Tracer::enabled())
+    {
+        return;
+    }
+    const std::string prefix = "memory " + name + " ";
+    Tracer::sample(prefix + "circuits", circuits.bytes);
+    Tracer::sample(prefix + "nodes", nodes.bytes);
+    Tracer::sample(prefix + "pins", pins.bytes);
+    Tracer::sample(prefix + "nets", nets.bytes);
+    Tracer::sample(prefix + "io interfaces", ioInterfaces.bytes);
+    Tracer::sample(prefix + "connectivity", connectivity.bytes);
+    Tracer::sample(prefix + "constraint", constraint.bytes);
+    Tracer::sample(prefix + "gds data", gdsData.bytes);
+    Tracer::sample(prefix + "layout", layoutTotal().bytes);
+    for (IndexType layerIdx = 0; layerIdx < layers.size(); ++layerIdx)
+    {
+        if (layers[layerIdx].count > 0)
+        {
+            Tracer::sample(prefix + "layer " + std::to_string(layerIdx), layers[layerIdx].bytes);
+        }
+    }
+    Tracer::sample(prefix + "names", names.bytes);
+    Tracer::sample(prefix + "tech db", techDB.bytes);
+    Tracer::sample(prefix + "total", totalBytes());
+}
+
+MemoryUsage MemoryUsage::ofCkt(const CktGraph &ckt)
+{
+    MemoryUsage usage;
+    addCkt(ckt, nullptr, usage);
+    return usage;
+}
+
+MemoryUsage MemoryUsage::ofSubtree(const DesignDB &designDB, IndexType cktIdx)
+{
+    AssertMsg(cktIdx < designDB.numCkts(), "MemoryUsage::ofSubtree: circuit %u out of %u \n", cktIdx, designDB.numCkts());
+    MemoryUsage usage;
+    SharedSeen seen;
+    std::vector<bool> visited(designDB.numCkts(), false);
+    std::vector<IndexType> stack(1, cktIdx);
+    visited[cktIdx] = true;
+    while (!stack.empty())
+    {
+        const CktGraph &ckt = designDB.subCkt(stack.back());
+        stack.pop_back();
+        addCkt(ckt, &seen, usage);
+        for (const auto &node : ckt.nodeArray())
+        {
+            const IndexType subIdx = node.subgraphIdx();
+            if (!node.isLeaf() && subIdx < visited.size() && !visited[subIdx])
+            {
+                visited[subIdx] = true;
+                stack.emplace_back(subIdx);
+            }
+        }
+    }
+    return usage;
+}
+
+MemoryUsage MemoryUsage::ofDesign(const DesignDB &designDB)
+{
+    MemoryUsage usage;
+    SharedSeen seen;
+    for (const auto &ckt : designDB.ckts())
+    {
+        addCkt(ckt, &seen, usage);
+    }
+    usage.circuits.bytes += (designDB.ckts().capacity() - designDB.numCkts()) * sizeof(CktGraph);
+    usage.names.bytes = StringPool::names().heapBytes();
+    usage.names.count = StringPool::names().size();
+    if (designDB.hasTechDB())
+    {
+        usage.techDB.bytes = sizeof(TechDB) + designDB.techDB().heapBytes();
+        usage.techDB.count = designDB.techDB().numLayers();
+    }
+    usage.arena.bytes = designDB.arena().reservedBytes();
+    usage.arena.count = designDB.arena().numChunks();
+    return usage;
+}
+
+PROJECT_NAMESPACE_END
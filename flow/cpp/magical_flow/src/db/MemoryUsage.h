@@ -0,0 +1,70 @@
+/**
+ * @file MemoryUsage.h
+ * @brief The memory footprint of the circuits, per component and per layout layer, for a circuit, a sub hierarchy or a design
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_MEMORY_USAGE_H_
+#define MAGICAL_FLOW_MEMORY_USAGE_H_
+
+#include "DesignDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::MemoryStat
+/// @brief the bytes and the number of elements of a component
+struct MemoryStat
+{
+    std::size_t bytes = 0; ///< The bytes of the elements, by the capacities of their arrays, and of the heap blocks they own
+    std::size_t count = 0; ///< The number of elements
+    /// @brief add the bytes and the elements of another one
+    MemoryStat & operator+=(const MemoryStat &rhs) { bytes += rhs.bytes; count += rhs.count; return *this; }
+};
+
+/// @class MAGICAL_FLOW::MemoryUsage
+/// @brief The memory footprint of circuits, per component. The bytes of an array are counted by its capacity, so the slack of the growth shows.
+/// A layout or a constraint shared by several circuits is counted once in a sub hierarchy and in a design, each circuit once however many times it is instantiated.
+/// The interned names of the nodes and the nets, the technology and the arena are shared by the whole design, and counted by ofDesign only
+struct MemoryUsage
+{
+    MemoryStat circuits; ///< The circuit graphs with their names, and the slack of the circuit array of the design
+    MemoryStat nodes; ///< The nodes and their own pin lists
+    MemoryStat pins; ///< The pins and their layout rectangle indices
+    MemoryStat nets; ///< The nets and their own pin lists, with the first io interface of each
+    MemoryStat ioInterfaces; ///< The io interfaces of the nets, counting the first ones, whose bytes are in nets
+    MemoryStat connectivity; ///< The packed pin arrays and the substrate net indices, count is the number of packed pins
+    MemoryStat constraint; ///< The placement constraints, count is the number of allocated constraints
+    MemoryStat gdsData; ///< The GDSII file names and bounding boxes, count is the number of circuits with a file
+    MemoryStat layout; ///< The layout objects and their layer arrays, count is the number of allocated layouts. The layers are in layers
+    std::vector<MemoryStat> layers; ///< The layout layers by their db layers, count is the number of texts, rectangles and polygons
+    MemoryStat names; ///< The pool of the interned names of the nodes and the nets, count is the number of names
+    MemoryStat techDB; ///< The technology, count is the number of layers
+    MemoryStat arena; ///< The chunks of the arena of the node, pin and net arrays, count is the number of chunks. Overlaps nodes, pins and nets, so not in totalBytes
+    /// @brief get the layouts with their layers
+    MemoryStat layoutTotal() const;
+    /// @brief get the bytes of all the components but the arena
+    std::size_t totalBytes() const;
+    /// @brief add another footprint, component by component
+    MemoryUsage & operator+=(const MemoryUsage &rhs);
+    /// @brief get the table of the components and the non-empty layers
+    /// @param the technology naming the layers, nullptr for the layer indices
+    /// @return the table
+    std::string summary(const TechDB *techDB = nullptr) const;
+    /// @brief record the bytes of the components as samples of the tracer, named "memory <name> <component>", and one per non-empty layer
+    /// @param the name of the footprint, such as the circuit
+    void trace(const std::string &name) const;
+    /// @brief get the footprint of one circuit
+    /// @param the circuit
+    static MemoryUsage ofCkt(const CktGraph &ckt);
+    /// @brief get the footprint of a circuit and all the circuits below it
+    /// @param first: the design database
+    /// @param second: the index of the top circuit
+    static MemoryUsage ofSubtree(const DesignDB &designDB, IndexType cktIdx);
+    /// @brief get the footprint of all the circuits of a design, with the names, the technology and the arena
+    /// @param the design database
+    static MemoryUsage ofDesign(const DesignDB &designDB);
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_MEMORY_USAGE_H_
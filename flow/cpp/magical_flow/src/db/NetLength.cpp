@@ -0,0 +1,139 @@
+/**
+ * @file NetLength.cpp
+ * @brief Estimate the wire lengths of the nets of a circuit from their pin shapes
+ * @date 10/14/2026
+ */
+
+#include "db/NetLength.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+PROJECT_NAMESPACE_BEGIN
+
+constexpr IndexType NetLengthEstimator::PARALLEL_EVALUATE_THRESHOLD;
+
+NetLengthEstimator::NetLengthEstimator(std::shared_ptr<const NetPinShapes> shapes)
+    : _shapes(std::move(shapes))
+{
+    AssertMsg(_shapes != nullptr, "%s: no pin shapes \n", __FUNCTION__);
+    _weights.assign(_shapes->numNets(), 1.0);
+}
+
+void NetLengthEstimator::setWeights(std::vector<RealType> weights)
+{
+    AssertMsg(weights.size() == _shapes->numNets(), "%s: %lu weights for %u nets \n", __FUNCTION__, weights.size(), _shapes->numNets());
+    _weights.swap(weights);
+}
+
+void NetLengthEstimator::evaluate()
+{
+    const IndexType numNets = _shapes->numNets();
+    const Box<LocType> emptyBox(std::numeric_limits<LocType>::max(), std::numeric_limits<LocType>::max(), std::numeric_limits<LocType>::min(), std::numeric_limits<LocType>::min());
+    _bboxes.assign(numNets, emptyBox);
+    _hasShape.assign(numNets, 0);
+    _stars.assign(numNets, 0.0);
+    // Each net is independent
+    #pragma omp parallel for schedule(static) if (numNets >= PARALLEL_EVALUATE_THRESHOLD)
+    for (IndexType netIdx = 0; netIdx < numNets; ++netIdx)
+    {
+        const IndexType begin = _shapes->shapeStart(netIdx);
+        const IndexType end = begin + _shapes->numShapes(netIdx);
+        const bool withSub = _hasSubShape && _shapes->hasPsub(netIdx);
+        IndexType numShapes = end - begin + (withSub ? 1 : 0);
+        if (numShapes == 0)
+        {
+            continue;
+        }
+        Box<LocType> bbox = emptyBox;
+        // The sums of the doubled centers, to stay in integers
+        std::int64_t sumX = 0, sumY = 0;
+        auto addShape = [&](const Box<LocType> &shape)
+        {
+            bbox.unionBox(shape);
+            sumX += static_cast<std::int64_t>(shape.xLo()) + shape.xHi();
+            sumY += static_cast<std::int64_t>(shape.yLo()) + shape.yHi();
+        };
+        for (IndexType shapeIdx = begin; shapeIdx < end; ++shapeIdx)
+        {
+            addShape(_shapes->shape(shapeIdx));
+        }
+        if (withSub)
+        {
+            addShape(_subShape);
+        }
+        RealType centroidX = static_cast<RealType>(sumX) / (2.0 * numShapes);
+        RealType centroidY = static_cast<RealType>(sumY) / (2.0 * numShapes);
+        RealType star = 0.0;
+        auto addStar = [&](const Box<LocType> &shape)
+        {
+            star += std::abs((static_cast<RealType>(shape.xLo()) + shape.xHi()) / 2.0 - centroidX);
+            star += std::abs((static_cast<RealType>(shape.yLo()) + shape.yHi()) / 2.0 - centroidY);
+        };
+        for (IndexType shapeIdx = begin; shapeIdx < end; ++shapeIdx)
+        {
+            addStar(_shapes->shape(shapeIdx));
+        }
+        if (withSub)
+        {
+            addStar(_subShape);
+        }
+        _bboxes[netIdx] = bbox;
+        _hasShape[netIdx] = 1;
+        _stars[netIdx] = star;
+    }
+}
+
+RealType NetLengthEstimator::length(IndexType netIdx, NetLengthMetric metric) const
+{
+    AssertMsg(_bboxes.size() == _shapes->numNets(), "%s: the lengths are not evaluated \n", __FUNCTION__);
+    if (!_hasShape.at(netIdx))
+    {
+        return 0.0;
+    }
+    const auto &bbox = _bboxes[netIdx];
+    if (metric == NetLengthMetric::HPWL)
+    {
+        return static_cast<RealType>(bbox.xHi()) - bbox.xLo() + static_cast<RealType>(bbox.yHi()) - bbox.yLo();
+    }
+    else if (metric == NetLengthMetric::MAX_EXTENT)
+    {
+        return std::max(static_cast<RealType>(bbox.xHi()) - bbox.xLo(), static_cast<RealType>(bbox.yHi()) - bbox.yLo());
+    }
+    else
+    {
+        return _stars[netIdx];
+    }
+}
+
+std::vector<RealType> NetLengthEstimator::lengths(NetLengthMetric metric) const
+{
+    std::vector<RealType> values(this->numNets());
+    for (IndexType netIdx = 0; netIdx < this->numNets(); ++netIdx)
+    {
+        values[netIdx] = this->length(netIdx, metric);
+    }
+    return values;
+}
+
+RealType NetLengthEstimator::totalLength(NetLengthMetric metric) const
+{
+    RealType total = 0.0;
+    for (IndexType netIdx = 0; netIdx < this->numNets(); ++netIdx)
+    {
+        total += this->length(netIdx, metric);
+    }
+    return total;
+}
+
+RealType NetLengthEstimator::weightedLength(NetLengthMetric metric) const
+{
+    RealType total = 0.0;
+    for (IndexType netIdx = 0; netIdx < this->numNets(); ++netIdx)
+    {
+        total += _weights[netIdx] * this->length(netIdx, metric);
+    }
+    return total;
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,83 @@
+/**
+ * @file NetLength.h
+ * @brief Estimate the wire lengths of the nets of a circuit from their pin shapes
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_NET_LENGTH_H_
+#define MAGICAL_FLOW_NET_LENGTH_H_
+
+#include <memory>
+#include "NetPinShapes.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @brief the wire length metric of a net
+enum class NetLengthMetric
+{
+    HPWL, ///< The half perimeter of the bounding box of the pin shapes
+    MAX_EXTENT, ///< The larger of the width and the height of the bounding box, as PnR.calcNetLength
+    STAR ///< The sum of the Manhattan distances from the centers of the pin shapes to their centroid
+};
+
+/// @class MAGICAL_FLOW::NetLengthEstimator
+/// @brief the bounding boxes and the wire lengths of all the nets of a circuit, evaluated at once from the resolved pin shapes.
+/// The nets without any shape have an empty bounding box and zero lengths
+class NetLengthEstimator
+{
+    public:
+        /// @brief constructor
+        /// @param the pin shapes of the nets. Kept alive by the estimator
+        explicit NetLengthEstimator(std::shared_ptr<const NetPinShapes> shapes);
+        /// @brief add a shape to every net connecting a substrate pin, such as the guard ring. Should be set before evaluate
+        /// @param the substrate shape in the coordinates of the circuit
+        void setSubShape(const Box<LocType> &subShape) { _subShape = subShape; _hasSubShape = true; }
+        /// @brief set the weights of the nets for the weighted totals. The weights are 1 by default
+        /// @param the weights, one per net
+        void setWeights(std::vector<RealType> weights);
+        /// @brief evaluate the bounding boxes and the lengths of all the nets, in parallel for the large circuits
+        void evaluate();
+        /*------------------------------*/
+        /* Getters                      */
+        /*------------------------------*/
+        /// @brief get the number of nets
+        /// @return the number of nets
+        IndexType numNets() const { return _shapes->numNets(); }
+        /// @brief get whether a net has any shape
+        /// @param the index of the net
+        bool hasShape(IndexType netIdx) const { return _hasShape.at(netIdx); }
+        /// @brief get the bounding box of the shapes of a net
+        /// @param the index of the net
+        /// @return the bounding box
+        const Box<LocType> & bbox(IndexType netIdx) const { return _bboxes.at(netIdx); }
+        /// @brief get the length of a net
+        /// @param first: the index of the net
+        /// @param second: the metric
+        /// @return the length in database units
+        RealType length(IndexType netIdx, NetLengthMetric metric) const;
+        /// @brief get the lengths of all the nets
+        /// @param the metric
+        /// @return the lengths in database units
+        std::vector<RealType> lengths(NetLengthMetric metric) const;
+        /// @brief get the sum of the lengths of all the nets
+        /// @param the metric
+        /// @return the total length in database units
+        RealType totalLength(NetLengthMetric metric) const;
+        /// @brief get the sum of the lengths of all the nets multiplied by their weights
+        /// @param the metric
+        /// @return the weighted total length in database units
+        RealType weightedLength(NetLengthMetric metric) const;
+    private:
+        static constexpr IndexType PARALLEL_EVALUATE_THRESHOLD = 512; ///< The number of nets to evaluate in parallel
+        std::shared_ptr<const NetPinShapes> _shapes; ///< The pin shapes of the nets
+        Box<LocType> _subShape; ///< The substrate shape
+        bool _hasSubShape = false; ///< Whether the substrate shape is set
+        std::vector<RealType> _weights; ///< The weights of the nets
+        std::vector<Box<LocType>> _bboxes; ///< The bounding boxes of the nets
+        std::vector<char> _hasShape; ///< Whether each net has any shape. Not vector<bool>, as it is written in parallel
+        std::vector<RealType> _stars; ///< The star lengths of the nets
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_NET_LENGTH_H_
@@ -0,0 +1,128 @@
+/**
+ * @file NetPinShapes.cpp
+ * @brief The io pin shapes connected by the nets of a circuit, in the coordinates of the circuit
+ * @date 10/14/2026
+ */
+
+#include "db/NetPinShapes.h"
+#include <algorithm>
+#include <string>
+#include "db/InstanceView.h"
+#include "util/Hash.h"
+#include "util/Tracer.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+std::uint64_t NetPinShapes::placementSignature(const std::vector<CktGraph> &ckts, IndexType cktIdx)
+{
+    const auto &ckt = ckts.at(cktIdx);
+    std::uint64_t digest = MfHash::FNV_OFFSET;
+    MfHash::mix(digest, ckt.nodeRevision());
+    MfHash::mix(digest, ckt.numPins());
+    MfHash::mix(digest, ckt.numNets());
+    for (const auto &node : ckt.nodeArray())
+    {
+        MfHash::mix(digest, node.subgraphIdx());
+        MfHash::mix(digest, static_cast<std::uint32_t>(node.offset().x()));
+        MfHash::mix(digest, static_cast<std::uint32_t>(node.offset().y()));
+        MfHash::mix(digest, static_cast<std::uint64_t>(node.orient()) << 1 | node.flipVertFlag());
+        if (node.isLeaf())
+        {
+            continue;
+        }
+        const auto &subCkt = ckts.at(node.subgraphIdx());
+        const auto &bbox = subCkt.layout().boundary();
+        MfHash::mix(digest, static_cast<std::uint32_t>(bbox.xLo()));
+        MfHash::mix(digest, static_cast<std::uint32_t>(bbox.yLo()));
+        MfHash::mix(digest, static_cast<std::uint32_t>(bbox.xHi()));
+        MfHash::mix(digest, static_cast<std::uint32_t>(bbox.yHi()));
+        MfHash::mix(digest, subCkt.flipVertFlag());
+    }
+    return digest;
+}
+
+void NetPinShapes::resolve(const std::vector<CktGraph> &ckts, IndexType cktIdx)
+{
+    const auto &ckt = ckts.at(cktIdx);
+    ScopedTimer timer("resolveNetPinShapes ", ckt.name(), "layout");
+    _signature = placementSignature(ckts, cktIdx);
+    _shapeStart.assign(1, 0);
+    _shapeStart.reserve(ckt.numNets() + 1);
+    _rects.clear();
+    _layers.clear();
+    _pinIds.clear();
+    _flags.clear();
+    _netFlags.assign(ckt.numNets(), 0);
+    _grPinCounts.assign(ckt.numNets(), 0);
+    IndexType numPinsWithoutShape = 0;
+    std::string firstNetWithoutShape;
+    for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+    {
+        const auto &net = ckt.net(netIdx);
+        for (IndexType pinId = 0; pinId < net.numPins(); ++pinId)
+        {
+            const auto &pin = ckt.pin(net.pinIdx(pinId));
+            if (pin.pinType() == PinType::PSUB)
+            {
+                _netFlags[netIdx] |= HAS_PSUB;
+            }
+            else
+            {
+                if (pin.pinType() == PinType::NWELL)
+                {
+                    _netFlags[netIdx] |= HAS_NWELL;
+                }
+                ++_grPinCounts[netIdx];
+            }
+            const auto &node = ckt.node(pin.nodeIdx());
+            if (!pin.valid() || node.isLeaf())
+            {
+                continue;
+            }
+            const auto &subCkt = ckts.at(node.subgraphIdx());
+            if (pin.pinType() == PinType::PSUB && subCkt.implType() != ImplType::PCELL_Cap)
+            {
+                continue;
+            }
+            const auto &subNet = subCkt.net(pin.intNetIdx());
+            std::uint8_t flags = (subNet.isIoPowerStripe(0) ? POWER_STRIPE : 0) | (subNet.isIo() ? SUB_NET_IO : 0);
+            const InstanceView view(subCkt, node);
+            const IndexType numShapes = _layers.size();
+            for (IndexType ioIdx = 0; ioIdx < subNet.numIoPins(); ++ioIdx)
+            {
+                if (subNet.ioPinMetalLayer(ioIdx) == INDEX_TYPE_MAX)
+                {
+                    // The sub net has no io shape
+                    continue;
+                }
+                const Box<LocType> ioShape = view.ioShape(pin.intNetIdx(), ioIdx);
+                _rects.emplace_back(ioShape.xLo());
+                _rects.emplace_back(ioShape.yLo());
+                _rects.emplace_back(ioShape.xHi());
+                _rects.emplace_back(ioShape.yHi());
+                _layers.emplace_back(subNet.ioPinMetalLayer(ioIdx));
+                _pinIds.emplace_back(pinId);
+                _flags.emplace_back(flags);
+            }
+            if (_layers.size() == numShapes)
+            {
+                if (numPinsWithoutShape++ == 0)
+                {
+                    firstNetWithoutShape = net.name();
+                }
+            }
+        }
+        if (_netFlags[netIdx] & HAS_PSUB)
+        {
+            ++_grPinCounts[netIdx];
+        }
+        _shapeStart.emplace_back(_layers.size());
+    }
+    if (numPinsWithoutShape > 0)
+    {
+        WRN("NetPinShapes: %u pins of circuit %s, the first on net %s, connect a sub circuit net without io shape and have no shape to route \n",
+                numPinsWithoutShape, ckt.name().c_str(), firstNetWithoutShape.c_str());
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,127 @@
+/**
+ * @file NetPinShapes.h
+ * @brief The io pin shapes connected by the nets of a circuit, in the coordinates of the circuit
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_NET_PIN_SHAPES_H_
+#define MAGICAL_FLOW_NET_PIN_SHAPES_H_
+
+#include <cstdint>
+#include <vector>
+#include "CktGraph.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::NetPinShapes
+/// @brief the io pin shapes of the sub circuits connected by each net of a circuit, moved into the coordinates of the circuit with the offsets, orientations and flips of the nodes.
+/// Unlike PnR.adjustIoShape in Python, which only applies the offsets and the flips, the orientations of the nodes are applied too, as CktNode::toParentCoord does.
+/// The pins are walked as PnR.iterateNetPinShapes does: the invalid pins are skipped, and the substrate pins are kept only on the capacitors.
+/// A pin whose sub circuit net has no io shape contributes no shape; resolve() warns with the number of such pins.
+/// The shapes of a net are contiguous, in the order of its pins. The substrate shapes of the guard rings are not part of the circuit and are left to the caller.
+/// Built by DesignDB::netPinShapes, which keeps it until the placement changes
+class NetPinShapes
+{
+    public:
+        /// @brief the flags of a shape
+        enum ShapeFlag : std::uint8_t
+        {
+            POWER_STRIPE = 1, ///< The first io shape of the sub circuit net is a power stripe
+            SUB_NET_IO = 2 ///< The sub circuit net is an io of the sub circuit
+        };
+        /// @brief the flags of a net
+        enum NetFlag : std::uint8_t
+        {
+            HAS_PSUB = 1, ///< The net connects a substrate pin
+            HAS_NWELL = 2 ///< The net connects a nwell pin
+        };
+        /// @brief default constructor
+        explicit NetPinShapes() = default;
+        /// @brief resolve the pin shapes of all the nets of a circuit
+        /// @param first: the circuits of the design
+        /// @param second: the index of the circuit
+        void resolve(const std::vector<CktGraph> &ckts, IndexType cktIdx);
+        /// @brief a digest of the placement of the nodes of a circuit and of the boundaries of their sub circuits. Any change of it invalidates the shapes
+        /// @param first: the circuits of the design
+        /// @param second: the index of the circuit
+        /// @return the digest
+        static std::uint64_t placementSignature(const std::vector<CktGraph> &ckts, IndexType cktIdx);
+        /*------------------------------*/
+        /* Getters                      */
+        /*------------------------------*/
+        /// @brief get the placement digest the shapes were resolved with
+        /// @return the placement digest
+        std::uint64_t signature() const { return _signature; }
+        /// @brief get the number of nets
+        /// @return the number of nets
+        IndexType numNets() const { return _netFlags.size(); }
+        /// @brief get the number of shapes of all the nets
+        /// @return the number of shapes
+        IndexType numShapes() const { return _layers.size(); }
+        /// @brief get the number of shapes of a net
+        /// @param the index of the net
+        /// @return the number of shapes of the net
+        IndexType numShapes(IndexType netIdx) const { return _shapeStart.at(netIdx + 1) - _shapeStart.at(netIdx); }
+        /// @brief get the index of the first shape of a net
+        /// @param the index of the net
+        /// @return the index of the first shape of the net
+        IndexType shapeStart(IndexType netIdx) const { return _shapeStart.at(netIdx); }
+        /// @brief get a shape
+        /// @param the index of the shape
+        /// @return the shape in the coordinates of the circuit
+        Box<LocType> shape(IndexType shapeIdx) const
+        {
+            const LocType *rect = &_rects.at(4 * shapeIdx);
+            return Box<LocType>(rect[0], rect[1], rect[2], rect[3]);
+        }
+        /// @brief get the metal layer of a shape
+        /// @param the index of the shape
+        /// @return the metal layer, as Net::ioPinMetalLayer
+        IndexType layer(IndexType shapeIdx) const { return _layers.at(shapeIdx); }
+        /// @brief get the pin of a shape
+        /// @param the index of the shape
+        /// @return the position of the pin in the pins of the net
+        IndexType pinId(IndexType shapeIdx) const { return _pinIds.at(shapeIdx); }
+        /// @brief get whether a shape is from a power stripe
+        /// @param the index of the shape
+        bool isPowerStripe(IndexType shapeIdx) const { return _flags.at(shapeIdx) & POWER_STRIPE; }
+        /// @brief get whether a shape is from an io net of the sub circuit
+        /// @param the index of the shape
+        bool isSubNetIo(IndexType shapeIdx) const { return _flags.at(shapeIdx) & SUB_NET_IO; }
+        /// @brief get whether a net connects a substrate pin
+        /// @param the index of the net
+        bool hasPsub(IndexType netIdx) const { return _netFlags.at(netIdx) & HAS_PSUB; }
+        /// @brief get whether a net connects a nwell pin
+        /// @param the index of the net
+        bool hasNwell(IndexType netIdx) const { return _netFlags.at(netIdx) & HAS_NWELL; }
+        /// @brief get the number of pins of a net for the global router, as PnR.netPinCount: the pins other than substrate, plus one for the substrate
+        /// @param the index of the net
+        IndexType grPinCount(IndexType netIdx) const { return _grPinCounts.at(netIdx); }
+        /// @brief get the offsets of the shapes of each net, one more than the nets
+        const std::vector<IndexType> & shapeStartArray() const { return _shapeStart; }
+        /// @brief get the shapes as xLo, yLo, xHi, yHi of each
+        const std::vector<LocType> & rectArray() const { return _rects; }
+        /// @brief get the metal layers of the shapes
+        const std::vector<IndexType> & layerArray() const { return _layers; }
+        /// @brief get the pins of the shapes, as the positions in the pins of the nets
+        const std::vector<IndexType> & pinIdArray() const { return _pinIds; }
+        /// @brief get the flags of the shapes, of ShapeFlag
+        const std::vector<std::uint8_t> & flagArray() const { return _flags; }
+        /// @brief get the flags of the nets, of NetFlag
+        const std::vector<std::uint8_t> & netFlagArray() const { return _netFlags; }
+        /// @brief get the number of pins of each net for the global router
+        const std::vector<IndexType> & grPinCountArray() const { return _grPinCounts; }
+    private:
+        std::uint64_t _signature = 0; ///< The placement digest when resolved
+        std::vector<IndexType> _shapeStart; ///< The offsets of the shapes of each net
+        std::vector<LocType> _rects; ///< The shapes, four coordinates each
+        std::vector<IndexType> _layers; ///< The metal layers of the shapes
+        std::vector<IndexType> _pinIds; ///< The position of the pin of each shape in its net
+        std::vector<std::uint8_t> _flags; ///< The ShapeFlag of the shapes
+        std::vector<std::uint8_t> _netFlags; ///< The NetFlag of the nets
+        std::vector<IndexType> _grPinCounts; ///< The number of pins of each net for the global router
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_NET_PIN_SHAPES_H_
@@ -0,0 +1,395 @@
+/**
+ * @file PcellGenerator.cpp
+ * @brief The layouts of the MOS, resistor and capacitor devices, generated from their physical properties straight into the circuits
+ * @date 10/14/2026
+ */
+
+#include "db/PcellGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "util/Tracer.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the minimum width and spacing of a layer, if the technology defines it with the rules
+    const LayerRule * ruleOf(const TechDB &techDB, const std::string &layerName)
+    {
+        IndexType layer = techDB.layerNameToIdx(layerName);
+        return layer == INDEX_TYPE_MAX ? nullptr : &techDB.layerRule(layer);
+    }
+
+    /// @brief the terminal a net stands for, as Device_generator.writeDB matches the integer net names
+    /// @return the terminal, or INDEX_TYPE_MAX if the name is not an integer
+    IndexType terminalOf(const std::string &netName)
+    {
+        if (netName.empty() || !std::all_of(netName.begin(), netName.end(), [](char c) { return c >= '0' && c <= '9'; }))
+        {
+            return INDEX_TYPE_MAX;
+        }
+        return static_cast<IndexType>(std::strtoul(netName.c_str(), nullptr, 10));
+    }
+
+    /// @brief whether a circuit has a net standing for a terminal
+    bool hasTerminal(const CktGraph &ckt, IndexType terminal)
+    {
+        return std::any_of(ckt.netArray().begin(), ckt.netArray().end(), [&](const Net &net) { return terminalOf(net.name()) == terminal; });
+    }
+
+    /// @brief mirror a box about the vertical axis x = axis2 / 2
+    Box<LocType> mirrorX(const Box<LocType> &box, LocType axis2)
+    {
+        return Box<LocType>(axis2 - box.xHi(), box.yLo(), axis2 - box.xLo(), box.yHi());
+    }
+}
+
+PcellRule PcellRule::fromTech(const TechDB &techDB)
+{
+    PcellRule rule;
+    if (const LayerRule *co = ruleOf(techDB, "CO"))
+    {
+        rule.contactSize = co->minWidth() > 0 ? co->minWidth() : rule.contactSize;
+        rule.contactSpacing = co->minSpacing() > 0 ? co->minSpacing() : rule.contactSpacing;
+    }
+    if (const LayerRule *via = ruleOf(techDB, "VIA1"))
+    {
+        rule.viaSize = via->minWidth() > 0 ? via->minWidth() : rule.viaSize;
+        rule.viaSpacing = via->minSpacing() > 0 ? via->minSpacing() : rule.viaSpacing;
+    }
+    if (const LayerRule *m1 = ruleOf(techDB, "M1"))
+    {
+        rule.metalWidth = std::max(rule.metalWidth, m1->minWidth());
+        rule.metalSpacing = std::max(rule.metalSpacing, m1->minSpacing());
+    }
+    // The gates pass the source and drain M1 on their way to the bars, which are a metal spacing away from the diffusion
+    rule.polyExtension = std::max(rule.polyExtension, rule.metalSpacing);
+    return rule;
+}
+
+LocType PcellGenerator::toDbu(IntType length) const
+{
+    return static_cast<LocType>(std::llround(static_cast<double>(length) * _designDB.techDB().units().dbu() / 1e6));
+}
+
+void PcellGenerator::addRect(const std::string &layerName, const Box<LocType> &rect, PcellShapes &out) const
+{
+    IndexType layer = _designDB.techDB().layerNameToIdx(layerName);
+    if (layer != INDEX_TYPE_MAX)
+    {
+        out.shapes.addShape(layer, 0, rect);
+    }
+}
+
+void PcellGenerator::addCuts(const std::string &layerName, const Box<LocType> &box, LocType size, LocType spacing, LocType enclosure, PcellShapes &out) const
+{
+    IndexType layer = _designDB.techDB().layerNameToIdx(layerName);
+    if (layer != INDEX_TYPE_MAX)
+    {
+        PowerGeometry::addCutArray(box, layer, size, spacing, enclosure, out.shapes);
+    }
+}
+
+bool PcellGenerator::canGenerate(IndexType cktIdx) const
+{
+    if (cktIdx >= _designDB.numCkts() || !_designDB.hasTechDB())
+    {
+        return false;
+    }
+    const CktGraph &ckt = _designDB.subCkt(cktIdx);
+    const PhyPropDB &propDB = _designDB.phyPropDB();
+    const IndexType implIdx = ckt.implIdx();
+    switch (ckt.implType())
+    {
+        case ImplType::PCELL_Nch:
+        case ImplType::PCELL_Pch:
+        {
+            const bool isNch = ckt.implType() == ImplType::PCELL_Nch;
+            if (implIdx >= (isNch ? propDB.numNch() : propDB.numPch()))
+            {
+                return false;
+            }
+            const MosProp &mos = isNch ? static_cast<const MosProp &>(propDB.nch(implIdx)) : static_cast<const MosProp &>(propDB.pch(implIdx));
+            return mos.lengthValid() && mos.widthValid() && mos.length() > 0 && mos.width() > 0;
+        }
+        case ImplType::PCELL_Res:
+        {
+            if (implIdx >= propDB.numRes())
+            {
+                return false;
+            }
+            const ResProp &res = propDB.resister(implIdx);
+            return res.lrValid() && res.wrValid() && res.lr() > 0 && res.wr() > 0;
+        }
+        case ImplType::PCELL_Cap:
+        {
+            if (implIdx >= propDB.numCap())
+            {
+                return false;
+            }
+            const CapProp &cap = propDB.capacitor(implIdx);
+            return cap.lrValid() && cap.wValid() && cap.lr() > 0 && cap.w() > 0;
+        }
+        default: return false;
+    }
+}
+
+bool PcellGenerator::build(IndexType cktIdx, bool flipCell, PcellShapes &out) const
+{
+    out = PcellShapes();
+    if (!this->canGenerate(cktIdx))
+    {
+        return false;
+    }
+    const CktGraph &ckt = _designDB.subCkt(cktIdx);
+    const PhyPropDB &propDB = _designDB.phyPropDB();
+    switch (ckt.implType())
+    {
+        case ImplType::PCELL_Nch: this->buildMos(propDB.nch(ckt.implIdx()), true, hasTerminal(ckt, 3), out); break;
+        case ImplType::PCELL_Pch: this->buildMos(propDB.pch(ckt.implIdx()), false, hasTerminal(ckt, 3), out); break;
+        case ImplType::PCELL_Res: this->buildRes(propDB.resister(ckt.implIdx()), out); break;
+        default: this->buildCap(propDB.capacitor(ckt.implIdx()), out); break;
+    }
+    if (flipCell)
+    {
+        const Box<LocType> &boundary = out.shapes.boundary();
+        const LocType axis2 = boundary.xLo() + boundary.xHi();
+        ShapeBuffer mirrored;
+        for (IndexType shapeIdx = 0; shapeIdx < out.shapes.numShapes(); ++shapeIdx)
+        {
+            mirrored.addShape(out.shapes.layer(shapeIdx), out.shapes.datatype(shapeIdx), mirrorX(out.shapes.shape(shapeIdx), axis2));
+        }
+        out.shapes = std::move(mirrored);
+        for (auto &pin : out.pins)
+        {
+            pin = mirrorX(pin, axis2);
+        }
+    }
+    return true;
+}
+
+void PcellGenerator::buildMos(const MosProp &mos, bool isNch, bool hasBulk, PcellShapes &out) const
+{
+    const IndexType numFingers = static_cast<IndexType>(std::max(mos.numFingers(), 1) * std::max(mos.mult(), 1));
+    const LocType gateLen = std::max(this->toDbu(mos.length()), 1);
+    const LocType fingerWidth = std::max(this->toDbu(mos.width()) * std::max(mos.mult(), 1) / static_cast<LocType>(numFingers), 1);
+    // The source and drain columns: an M1 column over the contacts, a gate spacing to each side
+    const LocType colWidth = std::max(_rule.contactSize + 2 * _rule.contactEnclosure, _rule.viaSize + 2 * _rule.viaEnclosure);
+    const LocType sdLen = colWidth + 2 * _rule.metalToGate;
+    const LocType pitch = sdLen + gateLen;
+    const LocType odLen = static_cast<LocType>(numFingers + 1) * sdLen + static_cast<LocType>(numFingers) * gateLen;
+    const Box<LocType> od(0, 0, odLen, fingerWidth);
+    const LocType barHeight = std::max(_rule.metalWidth, _rule.viaSize + 2 * _rule.viaEnclosure);
+    const LocType gateBarHeight = _rule.contactSize + 2 * _rule.contactEnclosure;
+    const LocType gateYHi = fingerWidth + _rule.polyExtension;
+    const LocType gateYLo = -_rule.polyExtension;
+    // The drain bar crosses the diffusion at its middle. The drain columns reach it even past a narrow diffusion
+    const Box<LocType> drainBar(sdLen + gateLen + _rule.metalToGate, fingerWidth / 2 - barHeight / 2,
+            odLen - (numFingers % 2 == 0 ? pitch : 0) - _rule.metalToGate, fingerWidth / 2 - barHeight / 2 + barHeight);
+    const Box<LocType> sourceBar(0, gateYLo - barHeight, odLen, gateYLo);
+    const Box<LocType> gateBar(sdLen, gateYHi, odLen - sdLen, gateYHi + gateBarHeight);
+
+    this->addRect("OD", od, out);
+    for (IndexType gate = 0; gate < numFingers; ++gate)
+    {
+        const LocType xLo = sdLen + static_cast<LocType>(gate) * pitch;
+        this->addRect("PO", Box<LocType>(xLo, gateYLo, xLo + gateLen, gateYHi), out);
+    }
+    this->addRect("PO", gateBar, out);
+    this->addCuts("CO", gateBar, _rule.contactSize, _rule.contactSpacing, _rule.contactEnclosure, out);
+    this->addRect("M1", gateBar, out);
+    for (IndexType col = 0; col <= numFingers; ++col)
+    {
+        const LocType xLo = static_cast<LocType>(col) * pitch + _rule.metalToGate;
+        const Box<LocType> contacts(xLo, 0, xLo + colWidth, fingerWidth);
+        this->addCuts("CO", contacts, _rule.contactSize, _rule.contactSpacing, _rule.contactEnclosure, out);
+        if (col % 2 == 0)
+        {
+            // A source, down to the source bar
+            this->addRect("M1", Box<LocType>(xLo, sourceBar.yHi(), xLo + colWidth, fingerWidth), out);
+        }
+        else
+        {
+            const Box<LocType> column(xLo, std::min(0, drainBar.yLo()), xLo + colWidth, std::max(fingerWidth, drainBar.yHi()));
+            this->addRect("M1", column, out);
+            this->addCuts("VIA1", Box<LocType>(xLo, drainBar.yLo(), xLo + colWidth, drainBar.yHi()), _rule.viaSize, _rule.viaSpacing, _rule.viaEnclosure, out);
+        }
+    }
+    this->addRect("M1", sourceBar, out);
+    this->addRect("M2", drainBar, out);
+    Box<LocType> implant = od;
+    implant.enlargeBy(_rule.implantEnclosure);
+    this->addRect(isNch ? "NP" : "PP", implant, out);
+    // The threshold voltage and the thick oxide flavors named in the attributes that select the device in the PDK
+    if (mos.attr().find("lvt") != std::string::npos)
+    {
+        this->addRect(isNch ? "VTL_N" : "VTL_P", implant, out);
+    }
+    if (mos.attr().find("25") != std::string::npos)
+    {
+        this->addRect("OD_25", implant, out);
+    }
+    out.addPin(drainBar, 2);
+    out.addPin(gateBar, 1);
+    out.addPin(sourceBar, 1);
+    if (hasBulk)
+    {
+        // A substrate tap for an NMOS, a well tap for a PMOS, below the source bar
+        const LocType tapHeight = std::max(_rule.metalWidth, _rule.contactSize + 2 * _rule.contactEnclosure);
+        const Box<LocType> tap(0, sourceBar.yLo() - _rule.metalSpacing - tapHeight, odLen, sourceBar.yLo() - _rule.metalSpacing);
+        this->addRect("OD", tap, out);
+        this->addCuts("CO", tap, _rule.contactSize, _rule.contactSpacing, _rule.contactEnclosure, out);
+        this->addRect("M1", tap, out);
+        Box<LocType> tapImplant = tap;
+        tapImplant.enlargeBy(_rule.implantEnclosure);
+        this->addRect(isNch ? "PP" : "NP", tapImplant, out);
+        out.addPin(tap, 1);
+    }
+    if (!isNch)
+    {
+        Box<LocType> well = out.shapes.boundary();
+        well.enlargeBy(_rule.wellEnclosure);
+        this->addRect("NW", well, out);
+    }
+}
+
+void PcellGenerator::buildRes(const ResProp &res, PcellShapes &out) const
+{
+    const IndexType numSegs = static_cast<IndexType>(std::max(res.segNum(), 1));
+    const LocType width = std::max(this->toDbu(res.wr()), 1);
+    const LocType length = std::max(this->toDbu(res.lr()), 1);
+    const LocType space = res.segSpace() > 0 ? this->toDbu(res.segSpace()) : _rule.metalSpacing;
+    const LocType headLen = _rule.contactSize + 2 * _rule.contactEnclosure;
+    const LocType pitch = width + space;
+    const LocType yHi = 2 * headLen + length;
+    const LocType xHi = static_cast<LocType>(numSegs) * pitch - space;
+    auto head = [&](IndexType seg, bool top)
+    {
+        const LocType xLo = static_cast<LocType>(seg) * pitch;
+        return top ? Box<LocType>(xLo, yHi - headLen, xLo + width, yHi) : Box<LocType>(xLo, 0, xLo + width, headLen);
+    };
+    for (IndexType seg = 0; seg < numSegs; ++seg)
+    {
+        const LocType xLo = static_cast<LocType>(seg) * pitch;
+        this->addRect("PO", Box<LocType>(xLo, 0, xLo + width, yHi), out);
+        this->addRect("RPO", Box<LocType>(xLo - _rule.rpoExtension, headLen, xLo + width + _rule.rpoExtension, yHi - headLen), out);
+        for (bool top : {false, true})
+        {
+            this->addCuts("CO", head(seg, top), _rule.contactSize, _rule.contactSpacing, _rule.contactEnclosure, out);
+            this->addRect("M1", head(seg, top), out);
+        }
+    }
+    if (res.series() || !res.parallel())
+    {
+        // A snake: segment seg joins the next at the top if seg is even, at the bottom if odd
+        for (IndexType seg = 0; seg + 1 < numSegs; ++seg)
+        {
+            Box<LocType> strap = head(seg, seg % 2 == 0);
+            strap.unionBox(head(seg + 1, seg % 2 == 0));
+            this->addRect("M1", strap, out);
+        }
+        out.addPin(head(0, false), 1);
+        out.addPin(head(numSegs - 1, numSegs % 2 == 1), 1);
+    }
+    else
+    {
+        const Box<LocType> bottom(0, 0, xHi, headLen);
+        const Box<LocType> top(0, yHi - headLen, xHi, yHi);
+        this->addRect("M1", bottom, out);
+        this->addRect("M1", top, out);
+        out.addPin(bottom, 1);
+        out.addPin(top, 1);
+    }
+}
+
+void PcellGenerator::buildCap(const CapProp &cap, PcellShapes &out) const
+{
+    const IndexType numFingers = static_cast<IndexType>(std::max(cap.numFingers(), 2) * std::max(cap.multi(), 1));
+    const LocType width = std::max(this->toDbu(cap.w()), 1);
+    const LocType length = std::max(this->toDbu(cap.lr()), 1);
+    const LocType space = cap.spacingValid() && cap.spacing() > 0 ? this->toDbu(cap.spacing()) : _rule.metalSpacing;
+    const LocType tip = cap.ftipValid() && cap.ftip() > 0 ? this->toDbu(cap.ftip()) : space;
+    const IndexType startMetal = static_cast<IndexType>(cap.stmValid() && cap.stm() > 0 ? cap.stm() : 1);
+    const IndexType stopMetal = std::max(startMetal, static_cast<IndexType>(cap.spmValid() && cap.spm() > 0 ? cap.spm() : startMetal));
+    const LocType xHi = static_cast<LocType>(numFingers) * (width + space) - space;
+    const LocType yHi = 2 * width + length + tip;
+    // The even fingers hang from the top bus, the odd ones stand on the bottom bus
+    const Box<LocType> topBus(0, yHi - width, xHi, yHi);
+    const Box<LocType> bottomBus(0, 0, xHi, width);
+    for (IndexType metal = startMetal; metal <= stopMetal; ++metal)
+    {
+        const std::string metalName = "M" + std::to_string(metal);
+        this->addRect(metalName, topBus, out);
+        this->addRect(metalName, bottomBus, out);
+        for (IndexType finger = 0; finger < numFingers; ++finger)
+        {
+            const LocType xLo = static_cast<LocType>(finger) * (width + space);
+            const bool fromTop = finger % 2 == 0;
+            this->addRect(metalName, Box<LocType>(xLo, fromTop ? width + tip : width, xLo + width, fromTop ? yHi - width : yHi - width - tip), out);
+        }
+        if (metal < stopMetal)
+        {
+            const std::string viaName = "VIA" + std::to_string(metal);
+            this->addCuts(viaName, topBus, _rule.viaSize, _rule.viaSpacing, _rule.viaEnclosure, out);
+            this->addCuts(viaName, bottomBus, _rule.viaSize, _rule.viaSpacing, _rule.viaEnclosure, out);
+        }
+    }
+    out.addPin(topBus, startMetal);
+    out.addPin(bottomBus, startMetal);
+}
+
+bool PcellGenerator::generate(IndexType cktIdx, bool flipCell)
+{
+    PcellShapes cell;
+    if (!this->build(cktIdx, flipCell, cell))
+    {
+        return false;
+    }
+    CktGraph &ckt = _designDB.subCkt(cktIdx);
+    const Box<LocType> &boundary = cell.shapes.boundary();
+    Layout &layout = ckt.layout();
+    layout.clear();
+    cell.shapes.applyTo(layout);
+    layout.setBoundary(boundary.xLo(), boundary.yLo(), boundary.xHi(), boundary.yHi());
+    ckt.gdsData().setBBox(boundary.xLo(), boundary.yLo(), boundary.xHi(), boundary.yHi());
+    // The terminals beyond the nets of the circuit are omitted, as Device_generator.writeDB does for the bulk
+    for (auto &net : ckt.netArray())
+    {
+        const IndexType terminal = terminalOf(net.name());
+        if (terminal < cell.pins.size())
+        {
+            const Box<LocType> &pin = cell.pins[terminal];
+            net.setIoShape(pin.xLo(), pin.yLo(), pin.xHi(), pin.yHi());
+            net.setIoLayer(cell.pinMetals[terminal]);
+        }
+    }
+    return true;
+}
+
+IndexType PcellGenerator::generateAll(const std::vector<IndexType> &cktIdxs, const std::vector<bool> &flipCells)
+{
+    AssertMsg(flipCells.empty() || flipCells.size() == cktIdxs.size(), "PcellGenerator::generateAll: %lu flips for %lu circuits \n", flipCells.size(), cktIdxs.size());
+    ScopedTimer timer("generatePcells", "device");
+    {
+        // Each circuit is written by one thread only
+        std::vector<bool> seen(_designDB.numCkts(), false);
+        for (IndexType cktIdx : cktIdxs)
+        {
+            AssertMsg(cktIdx >= seen.size() || !seen[cktIdx], "PcellGenerator::generateAll: circuit %u listed twice \n", cktIdx);
+            if (cktIdx < seen.size())
+            {
+                seen[cktIdx] = true;
+            }
+        }
+    }
+    std::vector<Byte> generated(cktIdxs.size(), 0);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (IndexType idx = 0; idx < cktIdxs.size(); ++idx)
+    {
+        generated[idx] = this->generate(cktIdxs[idx], !flipCells.empty() && flipCells[idx]) ? 1 : 0;
+    }
+    return static_cast<IndexType>(std::count(generated.begin(), generated.end(), 1));
+}
+
+PROJECT_NAMESPACE_END
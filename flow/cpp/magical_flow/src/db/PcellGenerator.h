@@ -0,0 +1,111 @@
+/**
+ * @file PcellGenerator.h
+ * @brief The layouts of the MOS, resistor and capacitor devices, generated from their physical properties straight into the circuits
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_PCELL_GENERATOR_H_
+#define MAGICAL_FLOW_PCELL_GENERATOR_H_
+
+#include "PowerGeometry.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::PcellRule
+/// @brief The dimensions of the generated devices, in database units.
+/// The defaults suit the mock PDK. fromTech replaces them by the rules of the technology where it has them
+struct PcellRule
+{
+    LocType contactSize = 40; ///< The width of a CO cut
+    LocType contactSpacing = 40; ///< The spacing between the CO cuts
+    LocType contactEnclosure = 10; ///< The enclosure of the CO cuts by the diffusion, the poly and the M1
+    LocType metalToGate = 20; ///< The spacing between a source or drain M1 column and the gates beside it
+    LocType polyExtension = 100; ///< The extension of the gates beyond the diffusion, up to the gate contact bar and down to the source bar
+    LocType metalWidth = 100; ///< The width of the source, drain and tap bars
+    LocType metalSpacing = 100; ///< The spacing between the bars, the taps and the fingers of the devices
+    LocType viaSize = 50; ///< The width of a VIAk cut
+    LocType viaSpacing = 50; ///< The spacing between the VIAk cuts
+    LocType viaEnclosure = 10; ///< The enclosure of the VIAk cuts by the metals
+    LocType implantEnclosure = 40; ///< The enclosure of the diffusion by its PP or NP implant, and by the threshold voltage and thick oxide layers
+    LocType wellEnclosure = 200; ///< The enclosure of a PMOS by the NW
+    LocType rpoExtension = 40; ///< The extension of the RPO beyond the sides of a resistor body
+    /// @brief the defaults, with the minimum width and spacing of the CO, VIA1 and M1 layers of a technology in place of the defaults where the technology has them
+    /// @param the technology
+    static PcellRule fromTech(const TechDB &techDB);
+};
+
+/// @class MAGICAL_FLOW::PcellShapes
+/// @brief the rectangles of a generated device, with the shapes and the metal layers of its terminals.
+/// The terminals are in the order of the nets of the device circuits: drain, gate, source and bulk for a MOS, the two ends for a resistor or a capacitor
+struct PcellShapes
+{
+    ShapeBuffer shapes; ///< The rectangles
+    std::vector<Box<LocType>> pins; ///< The shape of each terminal
+    std::vector<IndexType> pinMetals; ///< The metal layer of each terminal, 1 for M1
+    /// @brief add a terminal
+    void addPin(const Box<LocType> &shape, IndexType metal) { pins.emplace_back(shape); pinMetals.emplace_back(metal); }
+};
+
+/// @class MAGICAL_FLOW::PcellGenerator
+/// @brief Generate the layouts of the PCELL_Nch, PCELL_Pch, PCELL_Res and PCELL_Cap circuits from their properties in the PhyPropDB and the layers of the technology,
+/// in place of Device_generator.py: the layout, the boundary, the GdsData bounding box and the io pins of the nets named by the terminals are set directly,
+/// without a GDSII file in between.
+/// A MOS has its fingers side by side, the sources joined by an M1 bar below the diffusion, the drains by an M2 bar across it, the gates by a contacted poly bar above it,
+/// and a substrate or well tap below the sources if the circuit has a bulk net. Its fingers are its fingers times its multiplier, together as wide as its width times its multiplier.
+/// A resistor has its poly segments in a row, under RPO, strapped in series or in parallel by M1 at their contacted heads.
+/// A capacitor is a pair of interleaved finger combs on each metal from its start to its stop metal, the buses stacked with vias.
+/// The layers the technology does not define are skipped
+class PcellGenerator
+{
+    public:
+        /// @brief constructor, with the rules of the technology of the design
+        /// @param the design database. Should outlive this
+        explicit PcellGenerator(DesignDB &designDB) : _designDB(designDB), _rule(PcellRule::fromTech(designDB.techDB())) {}
+        /// @brief replace the rules
+        void setRule(const PcellRule &rule) { _rule = rule; }
+        /// @brief get the rules
+        const PcellRule & rule() const { return _rule; }
+        /// @brief whether a circuit is a device with the properties its layout needs
+        /// @param the index of the circuit
+        bool canGenerate(IndexType cktIdx) const;
+        /// @brief generate the rectangles and the terminals of a device, without touching the circuit
+        /// @param first: the index of the circuit
+        /// @param second: whether to mirror the device about the vertical axis through the center of its boundary, as Device_generator.generateDevice(flipCell)
+        /// @param third: output the shapes
+        /// @return whether the circuit is a device with the properties its layout needs
+        bool build(IndexType cktIdx, bool flipCell, PcellShapes &out) const;
+        /// @brief generate the layout of a device into its circuit. The previous layout is replaced
+        /// @param first: the index of the circuit
+        /// @param second: whether to mirror the device
+        /// @return whether generated
+        bool generate(IndexType cktIdx, bool flipCell);
+        /// @brief generate the layouts of many devices in parallel
+        /// @param first: the indices of the circuits. Should be distinct
+        /// @param second: whether to mirror each device
+        /// @return the number of devices generated
+        IndexType generateAll(const std::vector<IndexType> &cktIdxs, const std::vector<bool> &flipCells);
+    private:
+        /// @brief generate a MOS
+        /// @param first: the properties
+        /// @param second: whether an NMOS. Otherwise a PMOS in an NW
+        /// @param third: whether to add the bulk tap
+        /// @param fourth: output the shapes
+        void buildMos(const MosProp &mos, bool isNch, bool hasBulk, PcellShapes &out) const;
+        /// @brief generate a poly resistor
+        void buildRes(const ResProp &res, PcellShapes &out) const;
+        /// @brief generate a metal finger capacitor
+        void buildCap(const CapProp &cap, PcellShapes &out) const;
+        /// @brief add a rectangle if the technology defines the layer
+        void addRect(const std::string &layerName, const Box<LocType> &rect, PcellShapes &out) const;
+        /// @brief add an array of cuts if the technology defines the layer
+        void addCuts(const std::string &layerName, const Box<LocType> &box, LocType size, LocType spacing, LocType enclosure, PcellShapes &out) const;
+        /// @brief convert a length of the properties, in 1e-12 m, into database units
+        LocType toDbu(IntType length) const;
+    private:
+        DesignDB &_designDB; ///< The design
+        PcellRule _rule; ///< The dimensions
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_PCELL_GENERATOR_H_
@@ -0,0 +1,154 @@
+/**
+ * @file PhysicalProp.cpp
+ * @brief The equivalence classes of the physical properties
+ * @date 10/14/2026
+ */
+
+#include "db/PhysicalProp.h"
+#include <algorithm>
+#include <unordered_map>
+#include "util/Hash.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the strings of the parameters of one kind, numbered in the order of their first use
+    class StringTable
+    {
+        public:
+            IntType intern(const std::string &str)
+            {
+                auto it = _idx.emplace(str, static_cast<IntType>(_strings.size()));
+                if (it.second)
+                {
+                    _strings.emplace_back(str);
+                }
+                return it.first->second;
+            }
+            std::vector<std::string> & strings() { return _strings; }
+        private:
+            std::unordered_map<std::string, IntType> _idx;
+            std::vector<std::string> _strings;
+    };
+
+    /// @brief the parameters shared by the nch and pch properties
+    template<typename Mos>
+    void appendMosParams(const std::vector<Mos> &array, StringTable &strings, std::vector<IntType> &params)
+    {
+        std::string bulkCon;
+        for (const auto &mos : array)
+        {
+            bulkCon.clear();
+            for (IndexType idx = 0; idx < mos.numBulkCon(); ++idx)
+            {
+                bulkCon += (idx == 0 ? "" : ",") + std::to_string(mos.bulkCon(idx));
+            }
+            params.insert(params.end(), {mos.width(), mos.length(), mos.numFingers(), mos.mult(), strings.intern(mos.attr()), strings.intern(mos.pinConType()), strings.intern(bulkCon)});
+        }
+    }
+
+    /// @brief the hash of a parameter tuple, as a view into the parameter array
+    struct TupleHash
+    {
+        const std::vector<IntType> *params;
+        IndexType numParams;
+        std::size_t operator()(IndexType tupleIdx) const
+        {
+            std::uint64_t hash = MfHash::FNV_OFFSET;
+            for (IndexType idx = 0; idx < numParams; ++idx)
+            {
+                MfHash::mix(hash, static_cast<std::uint32_t>((*params)[tupleIdx * numParams + idx]));
+            }
+            return static_cast<std::size_t>(hash);
+        }
+    };
+    struct TupleEqual
+    {
+        const std::vector<IntType> *params;
+        IndexType numParams;
+        bool operator()(IndexType a, IndexType b) const
+        {
+            return std::equal(params->begin() + a * numParams, params->begin() + (a + 1) * numParams, params->begin() + b * numParams);
+        }
+    };
+}
+
+void PhyPropClasses::build(const std::vector<IntType> &deviceParams, IndexType numParams, std::vector<std::string> strings)
+{
+    const IndexType numDevices = numParams == 0 ? 0 : deviceParams.size() / numParams;
+    _numParams = numParams;
+    _strings = std::move(strings);
+    _classIdx.assign(numDevices, INDEX_TYPE_MAX);
+    _params.clear();
+    // The first device of each class stands for its tuple
+    std::unordered_map<IndexType, IndexType, TupleHash, TupleEqual> classOf(numDevices, TupleHash{&deviceParams, numParams}, TupleEqual{&deviceParams, numParams});
+    std::vector<IndexType> numMembers;
+    for (IndexType devIdx = 0; devIdx < numDevices; ++devIdx)
+    {
+        auto it = classOf.emplace(devIdx, static_cast<IndexType>(numMembers.size()));
+        if (it.second)
+        {
+            numMembers.emplace_back(0);
+            _params.insert(_params.end(), deviceParams.begin() + devIdx * numParams, deviceParams.begin() + (devIdx + 1) * numParams);
+        }
+        _classIdx[devIdx] = it.first->second;
+        ++numMembers[it.first->second];
+    }
+    // Counting sort of the devices by class
+    _memberStart.assign(numMembers.size() + 1, 0);
+    for (IndexType classIdx = 0; classIdx < numMembers.size(); ++classIdx)
+    {
+        _memberStart[classIdx + 1] = _memberStart[classIdx] + numMembers[classIdx];
+    }
+    _members.resize(numDevices);
+    std::vector<IndexType> next(_memberStart.begin(), _memberStart.end() - 1);
+    for (IndexType devIdx = 0; devIdx < numDevices; ++devIdx)
+    {
+        _members[next[_classIdx[devIdx]]++] = devIdx;
+    }
+}
+
+std::shared_ptr<const PhyPropClasses> PhyPropDB::propClasses(ImplType implType) const
+{
+    IntType kind = propKind(implType);
+    AssertMsg(kind >= 0, "PhyPropDB::propClasses: not a device type \n");
+    std::lock_guard<std::mutex> lock(_classMutex);
+    if (_classes[kind] != nullptr && _classRevisions[kind] == _revisions[kind])
+    {
+        return _classes[kind];
+    }
+    StringTable strings;
+    std::vector<IntType> params;
+    IndexType numParams = 0;
+    switch (kind)
+    {
+        case 0: numParams = 7; appendMosParams(_nchArray, strings, params); break;
+        case 1: numParams = 7; appendMosParams(_pchArray, strings, params); break;
+        case 2:
+        {
+            numParams = 7;
+            for (const auto &res : _resArray)
+            {
+                params.insert(params.end(), {res.wr(), res.lr(), static_cast<IntType>(res.series()), static_cast<IntType>(res.parallel()), res.segNum(), res.segSpace(), strings.intern(res.attr())});
+            }
+            break;
+        }
+        default:
+        {
+            numParams = 9;
+            for (const auto &cap : _capArray)
+            {
+                params.insert(params.end(), {cap.w(), cap.spacing(), cap.numFingers(), cap.lr(), cap.stm(), cap.spm(), cap.multi(), cap.ftip(), strings.intern(cap.attr())});
+            }
+            break;
+        }
+    }
+    auto classes = std::make_shared<PhyPropClasses>();
+    classes->build(params, numParams, std::move(strings.strings()));
+    _classes[kind] = classes;
+    _classRevisions[kind] = _revisions[kind];
+    return _classes[kind];
+}
+
+PROJECT_NAMESPACE_END
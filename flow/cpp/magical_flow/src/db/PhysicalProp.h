@@ -9,7 +9,11 @@
 #define MAGICAL_FLOW_PHYSICAL_PROP_H_
 
 #include "global/global.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 PROJECT_NAMESPACE_BEGIN
 
@@ -51,13 +55,13 @@ class MosProp
         void setNumFingers(IntType numFingers) { _numFingers = numFingers; }
         /// @brief whether _numFingers is set
         /// @return whether _numFingers is set
-        std::string attr() const { return _attributes; }
+        const std::string & attr() const { return _attributes; }
         /// @brief set _attribute string
         /// @param the attribute string
         void setAttr(std::string attributes) { _attributes = attributes; }
         /// @brief set _attribute string
         /// @param the attribute string
-        std::string pinConType() const { return _pinConType; }
+        const std::string & pinConType() const { return _pinConType; }
         /// @brief get pinConType string
         /// @param the type string: 'GS', 'DG', 'DS' for self connection
         void setPinConType(std::string type) { _pinConType = type; }
@@ -67,11 +71,11 @@ class MosProp
         /// @brief append to bulkCon 
         /// @param the pinType connected to bulk: 0:D, 1:G, 2:S 
         /// Currently only valid for PMOS
-        IndexType numBulkCon() { return _bulkCon.size(); }
+        IndexType numBulkCon() const { return _bulkCon.size(); }
         /// @brief append to bulkCon 
         /// @param the pinType connected to bulk: 0:D, 1:G, 2:S 
         /// Currently only valid for PMOS
-        IndexType bulkCon(IndexType id) { return _bulkCon.at(id); }
+        IndexType bulkCon(IndexType id) const { return _bulkCon.at(id); }
         /// @brief return the bulkCon at Index
         /// @param the Index
         /// Currently only valid for PMOS
@@ -155,7 +159,7 @@ class ResProp
         void setSegSpace(IntType segSpace) { _segSpace = segSpace; } 
         /// @brief get _attribute string
         /// @param the attribute string
-        std::string attr() const { return _attributes; }
+        const std::string & attr() const { return _attributes; }
         /// @brief set _attribute string
         /// @param the attribute string
         void setAttr(std::string attributes) { _attributes = attributes; }
@@ -245,7 +249,7 @@ class CapProp
         bool ftipValid() const { return _ftip != -1; }
         /// @brief get _attribute string
         /// @param the attribute string
-        std::string attr() const { return _attributes; }
+        const std::string & attr() const { return _attributes; }
         /// @brief set _attribute string
         /// @param the attribute string
         void setAttr(std::string attributes) { _attributes = attributes; }
@@ -262,6 +266,63 @@ class CapProp
 };
 
 
+/// @class MAGICAL_FLOW::PhyPropClasses
+/// @brief The equivalence classes of the devices of one kind, the devices of a class having identical parameters.
+/// The classes are hash-consed from the parameter tuples and numbered in the order of their first device.
+/// The devices of class c are memberArray()[memberStartArray()[c], memberStartArray()[c + 1]) in index order,
+/// and its parameters are paramArray()[c * numParams(), (c + 1) * numParams()), the strings among them as indices into string()
+class PhyPropClasses
+{
+    public:
+        /// @brief default constructor
+        explicit PhyPropClasses() = default;
+        /// @brief get the number of classes
+        IndexType numClasses() const { return _memberStart.size() - 1; }
+        /// @brief get the number of parameters of a class
+        IndexType numParams() const { return _numParams; }
+        /// @brief get the class of a device
+        /// @param the index of the device property
+        IndexType classIdx(IndexType propIdx) const { return _classIdx.at(propIdx); }
+        /// @brief get the number of devices of a class
+        /// @param the index of the class
+        IndexType numMembers(IndexType classIdx) const { return _memberStart.at(classIdx + 1) - _memberStart.at(classIdx); }
+        /// @brief get the devices of a class
+        /// @param the index of the class
+        /// @return the indices of the device properties, in increasing order
+        std::vector<IndexType> members(IndexType classIdx) const
+        {
+            return std::vector<IndexType>(_members.begin() + _memberStart.at(classIdx), _members.begin() + _memberStart.at(classIdx + 1));
+        }
+        /// @brief get the class of each device
+        const std::vector<IndexType> & classIdxArray() const { return _classIdx; }
+        /// @brief get the offsets of the devices of each class into memberArray, one more than the classes
+        const std::vector<IndexType> & memberStartArray() const { return _memberStart; }
+        /// @brief get the devices of all the classes
+        const std::vector<IndexType> & memberArray() const { return _members; }
+        /// @brief get the parameters of all the classes
+        const std::vector<IntType> & paramArray() const { return _params; }
+        /// @brief get a string parameter
+        /// @param the index of the string, as in paramArray
+        const std::string & string(IndexType strIdx) const { return _strings.at(strIdx); }
+        /// @brief hash-cons the parameter tuples of the devices into classes
+        /// @param first: the parameters of each device, numParams for each
+        /// @param second: the number of parameters of a device
+        /// @param third: the strings the parameters refer to
+        void build(const std::vector<IntType> &deviceParams, IndexType numParams, std::vector<std::string> strings);
+    private:
+        IndexType _numParams = 0; ///< The number of parameters of a class
+        std::vector<IndexType> _classIdx; ///< The class of each device
+        std::vector<IndexType> _memberStart = std::vector<IndexType>(1, 0); ///< The devices of class c are _members[_memberStart[c], _memberStart[c + 1])
+        std::vector<IndexType> _members; ///< The devices of the classes
+        std::vector<IntType> _params; ///< The parameters of the classes
+        std::vector<std::string> _strings; ///< The string parameters
+};
+
+/// @class MAGICAL_FLOW::PhyPropDB
+/// @brief The device properties, addressed by the implIdx of the device circuits.
+/// The equivalence classes of each kind are rebuilt on the first query after an allocation or a mutable access to a property of the kind.
+/// A rebuild makes new classes, so the classes already handed out stay unchanged while they are held.
+/// The queries may run concurrently, but not with a change of the properties
 class PhyPropDB
 {
     public:
@@ -270,36 +331,110 @@ class PhyPropDB
         /// @brief get a nch property
         /// @param the index
         /// @return a nch property
-        NchProp & nch(IndexType idx) { return _nchArray.at(idx); }
+        NchProp & nch(IndexType idx) { ++_revisions[0]; return _nchArray.at(idx); }
+        /// @brief get a nch property
+        /// @param the index
+        /// @return a nch property
+        const NchProp & nch(IndexType idx) const { return _nchArray.at(idx); }
         /// @brief allocate a new nch property
         /// @return the index of the property
-        IndexType allocateNch() { _nchArray.emplace_back(NchProp()); return _nchArray.size() - 1; }
+        /// @brief get the number of nch properties
+        /// @return the number of nch properties
+        IndexType numNch() const { return _nchArray.size(); }
+        IndexType allocateNch() { ++_revisions[0]; _nchArray.emplace_back(NchProp()); return _nchArray.size() - 1; }
         /// @brief get a pch property
         /// @param the index
         /// @return a pch property
-        PchProp & pch(IndexType idx) { return _pchArray.at(idx); }
+        PchProp & pch(IndexType idx) { ++_revisions[1]; return _pchArray.at(idx); }
+        /// @brief get a pch property
+        /// @param the index
+        /// @return a pch property
+        const PchProp & pch(IndexType idx) const { return _pchArray.at(idx); }
         /// @brief allocate a new pch property
         /// @return the index of the pch property
-        IndexType allocatePch() { _pchArray.emplace_back(PchProp());  return _pchArray.size() - 1; }
+        /// @brief get the number of pch properties
+        /// @return the number of pch properties
+        IndexType numPch() const { return _pchArray.size(); }
+        IndexType allocatePch() { ++_revisions[1]; _pchArray.emplace_back(PchProp());  return _pchArray.size() - 1; }
+        /// @brief get a resister property
+        /// @param the index
+        /// @return a resister property
+        ResProp & resister(IndexType idx) { ++_revisions[2]; return _resArray.at(idx); }
         /// @brief get a resister property
         /// @param the index
         /// @return a resister property
-        ResProp & resister(IndexType idx) { return _resArray.at(idx); }
+        const ResProp & resister(IndexType idx) const { return _resArray.at(idx); }
         /// @brief allocate a new resister property
         /// @return the index
-        IndexType allocateRes() { _resArray.emplace_back(ResProp()); return _resArray.size() - 1; }
+        /// @brief get the number of resister properties
+        /// @return the number of resister properties
+        IndexType numRes() const { return _resArray.size(); }
+        IndexType allocateRes() { ++_revisions[2]; _resArray.emplace_back(ResProp()); return _resArray.size() - 1; }
         /// @brief get a capacitor property
         /// @param the index
         /// @return the capacitor property
-        CapProp & capacitor(IndexType idx) { return _capArray.at(idx); }
+        CapProp & capacitor(IndexType idx) { ++_revisions[3]; return _capArray.at(idx); }
+        /// @brief get the capacitor property
+        /// @param the index
+        /// @return the capacitor property
+        const CapProp & capacitor(IndexType idx) const { return _capArray.at(idx); }
         /// @brief allocate a new capacitore property
         /// @return the index
-        IndexType allocateCap() { _capArray.emplace_back(CapProp()); return _capArray.size() - 1; }
+        /// @brief get the number of capacitor properties
+        /// @return the number of capacitor properties
+        IndexType numCap() const { return _capArray.size(); }
+        IndexType allocateCap() { ++_revisions[3]; _capArray.emplace_back(CapProp()); return _capArray.size() - 1; }
+        /// @brief remove all the properties
+        void clear()
+        {
+            _nchArray.clear();
+            _pchArray.clear();
+            _resArray.clear();
+            _capArray.clear();
+            for (auto &revision : _revisions)
+            {
+                ++revision;
+            }
+        }
+        /*------------------------------*/ 
+        /* Equivalence classes          */
+        /*------------------------------*/ 
+        /// @brief get the kind of property of an implementation type
+        /// @param the implementation type
+        /// @return 0 for PCELL_Nch, 1 for PCELL_Pch, 2 for PCELL_Res, 3 for PCELL_Cap, -1 for the other types
+        static IntType propKind(ImplType implType)
+        {
+            switch (implType)
+            {
+                case ImplType::PCELL_Nch: return 0;
+                case ImplType::PCELL_Pch: return 1;
+                case ImplType::PCELL_Res: return 2;
+                case ImplType::PCELL_Cap: return 3;
+                default: return -1;
+            }
+        }
+        /// @brief get the equivalence classes of a kind of device.
+        /// The parameters of a class are: width, length, numFingers, mult, attr, pinConType and the bulk connections joined by ',' for the transistors;
+        /// wr, lr, series, parallel, segNum, segSpace and attr for the resistors; w, spacing, numFingers, lr, stm, spm, multi, ftip and attr for the capacitors
+        /// @param the implementation type of the devices
+        /// @return the classes, a snapshot of the properties of the kind at the query
+        std::shared_ptr<const PhyPropClasses> propClasses(ImplType implType) const;
+        /// @brief get the equivalence class of a device
+        /// @param first: the implementation type of the device
+        /// @param second: the index of its property
+        IndexType propClassIdx(ImplType implType, IndexType propIdx) const { return this->propClasses(implType)->classIdx(propIdx); }
+        /// @brief get the number of equivalence classes of a kind of device
+        /// @param the implementation type of the devices
+        IndexType numPropClasses(ImplType implType) const { return this->propClasses(implType)->numClasses(); }
     private:
         std::vector<NchProp> _nchArray; ///< for nch
         std::vector<PchProp> _pchArray; ///< for pch
         std::vector<ResProp> _resArray; ///< for rppolym
         std::vector<CapProp> _capArray; ///< for cfmom
+        std::uint64_t _revisions[4] = {0, 0, 0, 0}; ///< The number of changes of each kind
+        mutable std::shared_ptr<const PhyPropClasses> _classes[4]; ///< The cached equivalence classes of each kind. nullptr before the first query
+        mutable std::uint64_t _classRevisions[4] = {0, 0, 0, 0}; ///< The revision of each kind when its classes were built
+        mutable std::mutex _classMutex; ///< Guards the rebuilding of the classes
 };
 
 
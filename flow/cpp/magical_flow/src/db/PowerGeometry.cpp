@@ -0,0 +1,207 @@
+/**
+ * @file PowerGeometry.cpp
+ * @brief The guard rings, the power stripes and the power via stacks, generated from the technology into shape buffers
+ * @date 10/14/2026
+ */
+
+#include "db/PowerGeometry.h"
+#include <algorithm>
+#include <cctype>
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the minimum width and spacing of a layer, if the technology defines it with the rules
+    const LayerRule * ruleOf(const TechDB &techDB, const std::string &layerName)
+    {
+        IndexType layer = techDB.layerNameToIdx(layerName);
+        return layer == INDEX_TYPE_MAX ? nullptr : &techDB.layerRule(layer);
+    }
+
+    /// @brief round up to the next multiple of the grid step, past it if already on the grid, as Placer.upscaleBBox
+    LocType upscale(LocType len, LocType gridStep)
+    {
+        return len + gridStep - ((len % gridStep) + gridStep) % gridStep;
+    }
+}
+
+PowerGeometryRule PowerGeometryRule::fromTech(const TechDB &techDB)
+{
+    PowerGeometryRule rule;
+    if (const LayerRule *co = ruleOf(techDB, "CO"))
+    {
+        rule.contactSize = co->minWidth() > 0 ? co->minWidth() : rule.contactSize;
+        rule.contactSpacing = co->minSpacing() > 0 ? co->minSpacing() : rule.contactSpacing;
+    }
+    if (const LayerRule *via = ruleOf(techDB, "VIA1"))
+    {
+        rule.viaSize = via->minWidth() > 0 ? via->minWidth() : rule.viaSize;
+        rule.viaSpacing = via->minSpacing() > 0 ? via->minSpacing() : rule.viaSpacing;
+    }
+    // A side holds at least one row of contacts, and is as wide as the diffusion and the M1 need
+    rule.ringWidth = std::max(rule.ringWidth, rule.contactSize + 2 * rule.contactEnclosure);
+    for (const char *layerName : {"OD", "M1"})
+    {
+        if (const LayerRule *layer = ruleOf(techDB, layerName))
+        {
+            rule.ringWidth = std::max(rule.ringWidth, layer->minWidth());
+        }
+    }
+    return rule;
+}
+
+void PowerGeometry::addRect(const std::string &layerName, const Box<LocType> &rect, ShapeBuffer &out, IndexType netIdx) const
+{
+    IndexType layer = _techDB.layerNameToIdx(layerName);
+    if (layer != INDEX_TYPE_MAX)
+    {
+        out.addShape(layer, 0, rect, netIdx);
+    }
+}
+
+std::array<Box<LocType>, 4> PowerGeometry::addGuardRing(const Box<LocType> &inner, bool isNwell, ShapeBuffer &out, IndexType netIdx) const
+{
+    const LocType w = _rule.ringWidth;
+    const Box<LocType> outer(inner.xLo() - w, inner.yLo() - w, inner.xHi() + w, inner.yHi() + w);
+    // The bottom and top sides span the corners, the left and right ones lie between them
+    const std::array<Box<LocType>, 4> sides = {
+        Box<LocType>(outer.xLo(), outer.yLo(), outer.xHi(), inner.yLo()),
+        Box<LocType>(inner.xHi(), inner.yLo(), outer.xHi(), inner.yHi()),
+        Box<LocType>(outer.xLo(), inner.yHi(), outer.xHi(), outer.yHi()),
+        Box<LocType>(outer.xLo(), inner.yLo(), inner.xLo(), inner.yHi())
+    };
+    const IndexType coLayer = _techDB.layerNameToIdx("CO");
+    for (const auto &side : sides)
+    {
+        this->addRect("OD", side, out, netIdx);
+        this->addRect("M1", side, out, netIdx);
+        if (coLayer != INDEX_TYPE_MAX)
+        {
+            addCutArray(side, coLayer, _rule.contactSize, _rule.contactSpacing, _rule.contactEnclosure, out, netIdx);
+        }
+        Box<LocType> implant = side;
+        implant.enlargeBy(_rule.implantEnclosure);
+        this->addRect(isNwell ? "NP" : "PP", implant, out, netIdx);
+    }
+    if (isNwell)
+    {
+        Box<LocType> well = outer;
+        well.enlargeBy(_rule.wellEnclosure);
+        this->addRect("NW", well, out, netIdx);
+    }
+    return sides;
+}
+
+void PowerGeometry::addPowerStripe(const Box<LocType> &stripe, IndexType metalLayer, ShapeBuffer &out, IndexType netIdx) const
+{
+    this->addRect("M" + std::to_string(metalLayer), stripe, out, netIdx);
+}
+
+void PowerGeometry::addViaStack(const Box<LocType> &shape, IndexType fromMetal, IndexType toMetal, ShapeBuffer &out, IndexType netIdx) const
+{
+    for (IndexType metal = fromMetal; metal <= toMetal; ++metal)
+    {
+        this->addRect("M" + std::to_string(metal), shape, out, netIdx);
+        if (metal == toMetal)
+        {
+            break;
+        }
+        const IndexType viaLayer = _techDB.layerNameToIdx("VIA" + std::to_string(metal));
+        if (viaLayer != INDEX_TYPE_MAX)
+        {
+            addCutArray(shape, viaLayer, _rule.viaSize, _rule.viaSpacing, _rule.viaEnclosure, out, netIdx);
+        }
+    }
+}
+
+IndexType PowerGeometry::addCutArray(const Box<LocType> &box, IndexType cutLayer, LocType size, LocType spacing, LocType enclosure, ShapeBuffer &out, IndexType netIdx)
+{
+    AssertMsg(size > 0, "PowerGeometry::addCutArray: cut width %d \n", size);
+    const LocType xLen = box.xLen() - 2 * enclosure;
+    const LocType yLen = box.yLen() - 2 * enclosure;
+    if (xLen < size || yLen < size)
+    {
+        return 0;
+    }
+    const IndexType numX = (xLen + spacing) / (size + spacing);
+    const IndexType numY = (yLen + spacing) / (size + spacing);
+    // Centered in the box
+    const LocType xLo = box.xLo() + enclosure + (xLen - static_cast<LocType>(numX) * (size + spacing) + spacing) / 2;
+    const LocType yLo = box.yLo() + enclosure + (yLen - static_cast<LocType>(numY) * (size + spacing) + spacing) / 2;
+    std::vector<LocType> rects;
+    rects.reserve(4 * numX * numY);
+    for (IndexType y = 0; y < numY; ++y)
+    {
+        for (IndexType x = 0; x < numX; ++x)
+        {
+            const LocType cutXLo = xLo + static_cast<LocType>(x) * (size + spacing);
+            const LocType cutYLo = yLo + static_cast<LocType>(y) * (size + spacing);
+            rects.insert(rects.end(), {cutXLo, cutYLo, cutXLo + size, cutYLo + size});
+        }
+    }
+    const IndexType numCuts = numX * numY;
+    out.addShapes(std::vector<IndexType>(numCuts, cutLayer), std::vector<IndexType>(numCuts, 0), rects, std::vector<IndexType>(numCuts, netIdx));
+    return numCuts;
+}
+
+IndexType PowerGeometry::metalLayer(const TechDB &techDB, IndexType dbLayer)
+{
+    const std::string &name = techDB.layerName(dbLayer);
+    if (name.size() < 2 || name[0] != 'M' || !std::all_of(name.begin() + 1, name.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); }))
+    {
+        return 0;
+    }
+    return std::stoul(name.substr(1));
+}
+
+IndexType PowerGeometry::insertIoPinNode(DesignDB &designDB, IndexType cktIdx, IndexType netIdx, const ShapeBuffer &shapes, bool isPowerStripe, LocType gridStep)
+{
+    AssertMsg(gridStep > 0, "PowerGeometry::insertIoPinNode: grid step %d \n", gridStep);
+    // Allocated first, as it moves the circuits
+    const IndexType cellIdx = designDB.allocateCkt();
+    CktGraph &cell = designDB.subCkt(cellIdx);
+    CktGraph &ckt = designDB.subCkt(cktIdx);
+    const TechDB &techDB = designDB.techDB();
+    cell.setIsImpl(true);
+    Net &cellNet = cell.net(cell.allocateNet());
+    Net &net = ckt.net(netIdx);
+    shapes.applyTo(cell.layout());
+    for (IndexType shapeIdx = 0; shapeIdx < shapes.numShapes(); ++shapeIdx)
+    {
+        const IndexType metal = metalLayer(techDB, shapes.layer(shapeIdx));
+        if (metal == 0)
+        {
+            continue;
+        }
+        const Box<LocType> rect = shapes.shape(shapeIdx);
+        for (Net *ioNet : {&net, &cellNet})
+        {
+            ioNet->addIoPin(rect.xLo(), rect.yLo(), rect.xHi(), rect.yHi(), metal);
+            if (isPowerStripe)
+            {
+                ioNet->markLastIoPowerStripe();
+            }
+        }
+    }
+    const Box<LocType> bbox = cell.layout().boundary();
+    if (shapes.numShapes() > 0)
+    {
+        cell.layout().setBoundary(-upscale(-bbox.xLo(), gridStep), -upscale(-bbox.yLo(), gridStep), upscale(bbox.xHi(), gridStep), upscale(bbox.yHi(), gridStep));
+    }
+
+    const IndexType nodeIdx = ckt.allocateNode();
+    const IndexType pinIdx = ckt.allocatePin();
+    CktNode &node = ckt.node(nodeIdx);
+    node.setIsImpl(true);
+    node.setSubgraphIdx(cellIdx);
+    node.appendPinIdx(pinIdx);
+    Pin &pin = ckt.pin(pinIdx);
+    pin.setNodeIdx(nodeIdx);
+    pin.setIntNetIdx(0);
+    pin.setNetIdx(netIdx);
+    net.appendPinIdx(pinIdx);
+    return nodeIdx;
+}
+
+PROJECT_NAMESPACE_END
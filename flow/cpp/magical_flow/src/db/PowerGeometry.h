@@ -0,0 +1,103 @@
+/**
+ * @file PowerGeometry.h
+ * @brief The guard rings, the power stripes and the power via stacks, generated from the technology into shape buffers
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_POWER_GEOMETRY_H_
+#define MAGICAL_FLOW_POWER_GEOMETRY_H_
+
+#include <array>
+#include "ShapeBuffer.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::PowerGeometryRule
+/// @brief The dimensions of the generated power geometry, in database units.
+/// The defaults suit the mock PDK. fromTech replaces them by the rules of the technology where it has them
+struct PowerGeometryRule
+{
+    LocType contactSize = 40; ///< The width of a CO cut
+    LocType contactSpacing = 40; ///< The spacing between the CO cuts
+    LocType contactEnclosure = 20; ///< The enclosure of the CO cuts by the OD and the M1 of a ring
+    LocType ringWidth = 200; ///< The width of a side of a guard ring
+    LocType implantEnclosure = 40; ///< The enclosure of the ring diffusion by its PP or NP implant
+    LocType wellEnclosure = 200; ///< The enclosure of an n-well ring by the NW
+    LocType viaSize = 50; ///< The width of a VIAk cut
+    LocType viaSpacing = 50; ///< The spacing between the VIAk cuts
+    LocType viaEnclosure = 10; ///< The enclosure of the VIAk cuts by the metals
+    /// @brief the defaults, with the minimum width and spacing of the CO, VIA1 and the ring layers of a technology in place of the defaults where the technology has them
+    /// @param the technology
+    static PowerGeometryRule fromTech(const TechDB &techDB);
+};
+
+/// @class MAGICAL_FLOW::PowerGeometry
+/// @brief Generate the guard rings, the power stripes and the via stacks of the power pins as rectangles in a ShapeBuffer, on the layers the technology names
+/// OD, PP, NP, NW, CO, Mk and VIAk. The layers the technology does not define are skipped.
+/// The buffer goes into a layout with ShapeBuffer::applyTo, or into a power net as a new io pin cell with insertIoPinNode, as Placer.addIoPinToNet does
+class PowerGeometry
+{
+    public:
+        /// @brief constructor, with the rules of the technology
+        /// @param the technology. Should outlive this
+        explicit PowerGeometry(const TechDB &techDB) : _techDB(techDB), _rule(PowerGeometryRule::fromTech(techDB)) {}
+        /// @brief replace the rules
+        void setRule(const PowerGeometryRule &rule) { _rule = rule; }
+        /// @brief get the rules
+        const PowerGeometryRule & rule() const { return _rule; }
+        /// @brief add a guard ring around a boundary: the diffusion and the M1 of the four sides with the contacts between them, in their implant, and in an NW for an n-well ring
+        /// @param first: the boundary inside the ring
+        /// @param second: whether an n-well ring, contacting the NW. Otherwise a substrate ring
+        /// @param third: output the rectangles
+        /// @param fourth: the net to tag the rectangles with, INDEX_TYPE_MAX if none
+        /// @return the M1 of the bottom, right, top and left sides, the pins of the ring
+        std::array<Box<LocType>, 4> addGuardRing(const Box<LocType> &inner, bool isNwell, ShapeBuffer &out, IndexType netIdx = INDEX_TYPE_MAX) const;
+        /// @brief add a power stripe
+        /// @param first: the stripe
+        /// @param second: the metal layer, 1 for M1
+        /// @param third: output the rectangle
+        /// @param fourth: the net to tag the rectangle with, INDEX_TYPE_MAX if none
+        void addPowerStripe(const Box<LocType> &stripe, IndexType metalLayer, ShapeBuffer &out, IndexType netIdx = INDEX_TYPE_MAX) const;
+        /// @brief add the metals and the via arrays stacking a pin shape from one metal layer up to another
+        /// @param first: the pin shape
+        /// @param second: the lowest metal layer, 1 for M1
+        /// @param third: the highest metal layer
+        /// @param fourth: output the rectangles
+        /// @param fifth: the net to tag the rectangles with, INDEX_TYPE_MAX if none
+        void addViaStack(const Box<LocType> &shape, IndexType fromMetal, IndexType toMetal, ShapeBuffer &out, IndexType netIdx = INDEX_TYPE_MAX) const;
+        /// @brief add the largest centered array of square cuts fitting a box
+        /// @param first: the box
+        /// @param second: the db layer of the cuts
+        /// @param third: the width of a cut
+        /// @param fourth: the spacing between the cuts
+        /// @param fifth: the enclosure of the cuts by the box
+        /// @param sixth: output the rectangles
+        /// @param seventh: the net to tag the rectangles with, INDEX_TYPE_MAX if none
+        /// @return the number of cuts
+        static IndexType addCutArray(const Box<LocType> &box, IndexType cutLayer, LocType size, LocType spacing, LocType enclosure, ShapeBuffer &out, IndexType netIdx = INDEX_TYPE_MAX);
+        /// @brief get the metal layer of a db layer named Mk
+        /// @param first: the technology
+        /// @param second: the db layer
+        /// @return k, or 0 if the layer is not a metal layer
+        static IndexType metalLayer(const TechDB &techDB, IndexType dbLayer);
+        /// @brief connect shapes to a net of a circuit as a new io pin cell, in one call: a sub circuit of one net with the shapes as its layout,
+        /// whose metal shapes are the io pins of the net in both circuits. The boundary of the cell is aligned to the grid as Placer.upscaleBBox does
+        /// @param first: the design database
+        /// @param second: the index of the circuit
+        /// @param third: the net in the circuit
+        /// @param fourth: the shapes, in the coordinates of the circuit
+        /// @param fifth: whether the io pins are power stripes
+        /// @param sixth: the grid step of the boundary of the cell
+        /// @return the index of the new node in the circuit
+        static IndexType insertIoPinNode(DesignDB &designDB, IndexType cktIdx, IndexType netIdx, const ShapeBuffer &shapes, bool isPowerStripe, LocType gridStep);
+    private:
+        /// @brief add a rectangle if the technology defines the layer
+        void addRect(const std::string &layerName, const Box<LocType> &rect, ShapeBuffer &out, IndexType netIdx) const;
+    private:
+        const TechDB &_techDB; ///< The technology
+        PowerGeometryRule _rule; ///< The dimensions
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_POWER_GEOMETRY_H_
@@ -0,0 +1,291 @@
+/**
+ * @file PrimarySym.cpp
+ * @brief The symmetry constraints of the primary circuits, the circuits of devices only, generated in memory
+ * @date 10/14/2026
+ */
+
+#include "db/PrimarySym.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief whether the first two pins of a device are interchangeable, as THIS and THAT of ConstGen
+    bool isPassive(ImplType implType)
+    {
+        return implType == ImplType::PCELL_Res || implType == ImplType::PCELL_Cap;
+    }
+}
+
+bool PrimarySym::isPrimary(IndexType cktIdx) const
+{
+    for (const auto &node : _designDB.subCkt(cktIdx).nodeArray())
+    {
+        if (node.isLeaf() || !MfUtil::isImplTypeDevice(_designDB.subCkt(node.subgraphIdx()).implType()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<IndexType> PrimarySym::alignedNets(const Candidate &candidate) const
+{
+    std::vector<IndexType> nets = _devices[candidate.devB].nets;
+    if (candidate.swapped)
+    {
+        std::swap(nets[0], nets[1]);
+    }
+    return nets;
+}
+
+bool PrimarySym::mirrors(Candidate &candidate, bool checkMates) const
+{
+    const auto &netsA = _devices[candidate.devA].nets;
+    const auto netsB = this->alignedNets(candidate);
+    std::unordered_map<IndexType, IndexType> mates;
+    std::vector<IndexType> shared;
+    bool differs = false;
+    candidate.numShared = 0;
+    for (IndexType pos = 0; pos < netsA.size(); ++pos)
+    {
+        const IndexType netA = netsA[pos];
+        const IndexType netB = netsB[pos];
+        if (netA == netB)
+        {
+            if (this->isSignal(netA))
+            {
+                ++candidate.numShared;
+                shared.emplace_back(netA);
+            }
+            continue;
+        }
+        if (!this->isSignal(netA) || !this->isSignal(netB))
+        {
+            return false;
+        }
+        differs = true;
+        for (const auto &pair : {std::make_pair(netA, netB), std::make_pair(netB, netA)})
+        {
+            auto inserted = mates.emplace(pair.first, pair.second);
+            if (!inserted.second && inserted.first->second != pair.second)
+            {
+                return false;
+            }
+            if (checkMates && _netMates[pair.first] != INDEX_TYPE_MAX && _netMates[pair.first] != pair.second)
+            {
+                return false;
+            }
+        }
+    }
+    for (IndexType netIdx : shared)
+    {
+        if (mates.find(netIdx) != mates.end())
+        {
+            return false;
+        }
+        if (checkMates && _netMates[netIdx] != INDEX_TYPE_MAX && _netMates[netIdx] != netIdx)
+        {
+            return false;
+        }
+    }
+    return differs;
+}
+
+void PrimarySym::generate(IndexType cktIdx, const std::vector<std::string> &powerNets)
+{
+    AssertMsg(this->isPrimary(cktIdx), "%s: circuit %u has a node other than a device \n", __FUNCTION__, cktIdx);
+    const auto &ckt = _designDB.subCkt(cktIdx);
+    const auto &phyPropDB = _designDB.phyPropDB();
+    _devices.assign(ckt.numNodes(), Device());
+    for (IndexType nodeIdx = 0; nodeIdx < ckt.numNodes(); ++nodeIdx)
+    {
+        const auto &node = ckt.node(nodeIdx);
+        const auto &subCkt = _designDB.subCkt(node.subgraphIdx());
+        auto &device = _devices[nodeIdx];
+        device.type = subCkt.implType();
+        const IndexType propIdx = subCkt.implIdx();
+        if (propIdx != INDEX_TYPE_MAX)
+        {
+            if (device.type == ImplType::PCELL_Nch || device.type == ImplType::PCELL_Pch)
+            {
+                const MosProp &mos = device.type == ImplType::PCELL_Nch ? static_cast<const MosProp &>(phyPropDB.nch(propIdx)) : phyPropDB.pch(propIdx);
+                device.sizes[0] = mos.width();
+                device.sizes[1] = mos.length();
+                device.sizes[2] = mos.numFingers();
+            }
+            else if (device.type == ImplType::PCELL_Res)
+            {
+                const auto &res = phyPropDB.resister(propIdx);
+                device.sizes[0] = res.wr();
+                device.sizes[1] = res.lr();
+                device.sizes[2] = res.segNum();
+            }
+            else if (device.type == ImplType::PCELL_Cap)
+            {
+                const auto &cap = phyPropDB.capacitor(propIdx);
+                device.sizes[0] = cap.w();
+                device.sizes[1] = cap.lr();
+                device.sizes[2] = cap.numFingers();
+            }
+        }
+        for (IndexType pinIdx : node.pinIdxArray())
+        {
+            IndexType netIdx = ckt.pin(pinIdx).netIdx();
+            device.nets.emplace_back(netIdx < ckt.numNets() ? netIdx : INDEX_TYPE_MAX);
+        }
+    }
+    const std::unordered_set<std::string> power(powerNets.begin(), powerNets.end());
+    _isPower.assign(ckt.numNets(), 0);
+    for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+    {
+        _isPower[netIdx] = power.find(ckt.net(netIdx).name()) != power.end();
+    }
+    _netMates.assign(ckt.numNets(), INDEX_TYPE_MAX);
+    // The pairs of the same type and sizes whose nets mirror each other on their own
+    std::vector<Candidate> candidates;
+    for (IndexType devA = 0; devA < _devices.size(); ++devA)
+    {
+        const auto &first = _devices[devA];
+        for (IndexType devB = devA + 1; devB < _devices.size(); ++devB)
+        {
+            const auto &second = _devices[devB];
+            if (first.type != second.type || !std::equal(first.sizes, first.sizes + 3, second.sizes) || first.nets.size() != second.nets.size())
+            {
+                continue;
+            }
+            Candidate best = {devA, devB, false, 0};
+            bool found = false;
+            for (bool swapped : {false, true})
+            {
+                if (swapped && (!isPassive(first.type) || first.nets.size() < 2))
+                {
+                    continue;
+                }
+                Candidate candidate = {devA, devB, swapped, 0};
+                if (this->mirrors(candidate, false) && (!found || candidate.numShared > best.numShared))
+                {
+                    best = candidate;
+                    found = true;
+                }
+            }
+            if (found)
+            {
+                candidates.emplace_back(best);
+            }
+        }
+    }
+    // Match the pairs sharing more nets first, such as the differential pairs on their tails
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate &lhs, const Candidate &rhs) { return lhs.numShared > rhs.numShared; });
+    std::vector<char> paired(_devices.size(), 0);
+    std::vector<std::pair<IndexType, IndexType>> pairs;
+    for (auto &candidate : candidates)
+    {
+        if (paired[candidate.devA] || paired[candidate.devB] || !this->mirrors(candidate, true))
+        {
+            continue;
+        }
+        paired[candidate.devA] = 1;
+        paired[candidate.devB] = 1;
+        pairs.emplace_back(candidate.devA, candidate.devB);
+        const auto &netsA = _devices[candidate.devA].nets;
+        const auto netsB = this->alignedNets(candidate);
+        for (IndexType pos = 0; pos < netsA.size(); ++pos)
+        {
+            if (netsA[pos] == netsB[pos])
+            {
+                if (this->isSignal(netsA[pos]))
+                {
+                    _netMates[netsA[pos]] = netsA[pos];
+                }
+            }
+            else
+            {
+                _netMates[netsA[pos]] = netsB[pos];
+                _netMates[netsB[pos]] = netsA[pos];
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    _symPairs.clear();
+    for (const auto &pair : pairs)
+    {
+        _symPairs.emplace_back(pair.first);
+        _symPairs.emplace_back(pair.second);
+    }
+    // The devices the net pairs map onto themselves
+    _selfSyms.clear();
+    for (IndexType devIdx = 0; devIdx < _devices.size(); ++devIdx)
+    {
+        const auto &device = _devices[devIdx];
+        if (paired[devIdx] || device.type == ImplType::UNSET)
+        {
+            continue;
+        }
+        bool touches = false;
+        std::vector<IndexType> image(device.nets);
+        for (IndexType &netIdx : image)
+        {
+            if (this->isSignal(netIdx) && _netMates[netIdx] != INDEX_TYPE_MAX)
+            {
+                touches = true;
+                netIdx = _netMates[netIdx];
+            }
+        }
+        if (!touches)
+        {
+            continue;
+        }
+        bool isSelf = image == device.nets;
+        if (!isSelf && isPassive(device.type) && image.size() >= 2)
+        {
+            std::swap(image[0], image[1]);
+            isSelf = image == device.nets;
+        }
+        if (isSelf)
+        {
+            _selfSyms.emplace_back(devIdx);
+        }
+    }
+    _symNetPairs.clear();
+    _selfSymNets.clear();
+    for (IndexType netIdx = 0; netIdx < _netMates.size(); ++netIdx)
+    {
+        if (_netMates[netIdx] == netIdx)
+        {
+            _selfSymNets.emplace_back(netIdx);
+        }
+        else if (_netMates[netIdx] != INDEX_TYPE_MAX && _netMates[netIdx] > netIdx)
+        {
+            _symNetPairs.emplace_back(netIdx);
+            _symNetPairs.emplace_back(_netMates[netIdx]);
+        }
+    }
+}
+
+void PrimarySym::apply(CktConstraint &constraint) const
+{
+    constraint.clearSym();
+    for (IndexType idx = 0; idx + 1 < _symPairs.size(); idx += 2)
+    {
+        constraint.addSymPair(_symPairs[idx], _symPairs[idx + 1]);
+    }
+    for (IndexType nodeIdx : _selfSyms)
+    {
+        constraint.addSelfSym(nodeIdx);
+    }
+    for (IndexType idx = 0; idx + 1 < _symNetPairs.size(); idx += 2)
+    {
+        constraint.addSymNetPair(_symNetPairs[idx], _symNetPairs[idx + 1]);
+    }
+    for (IndexType netIdx : _selfSymNets)
+    {
+        constraint.addSelfSymNet(netIdx);
+    }
+    constraint.markSymGenerated();
+}
+
+PROJECT_NAMESPACE_END
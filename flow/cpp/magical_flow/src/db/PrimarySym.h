@@ -0,0 +1,100 @@
+/**
+ * @file PrimarySym.h
+ * @brief The symmetry constraints of the primary circuits, the circuits of devices only, generated in memory
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_PRIMARY_SYM_H_
+#define MAGICAL_FLOW_PRIMARY_SYM_H_
+
+#include "DesignDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::PrimarySym
+/// @brief the symmetry constraints of a primary circuit, from the devices as ConstGen.addInst and ConstGen.addInstPin take them:
+/// the type, the width, the length and the fingers of each device, and the nets on its pins in the D, G, S, B order, or THIS, THAT, OTHER for the passive devices.
+/// Two devices of the same type and sizes are a pair if their pins are on the same nets or on two signal nets,
+/// and the pairs of nets are consistent over all the pairs. The pairs sharing more nets are matched first.
+/// A device not in any pair is self-symmetric if the net pairs map its pins onto themselves, and it touches a net of a pair.
+/// The power nets are never paired
+class PrimarySym
+{
+    public:
+        /// @brief constructor
+        /// @param the design database. Should outlive this
+        explicit PrimarySym(const DesignDB &designDB) : _designDB(designDB) {}
+        /// @brief get whether all the nodes of a circuit are devices
+        /// @param the index of the circuit
+        /// @return whether the circuit is primary
+        bool isPrimary(IndexType cktIdx) const;
+        /// @brief generate the constraints of a primary circuit
+        /// @param first: the index of the circuit
+        /// @param second: the names of the power nets
+        void generate(IndexType cktIdx, const std::vector<std::string> &powerNets);
+        /// @brief replace the symmetry constraints of the circuit by the generated ones, and mark them generated
+        /// @param the constraints of the circuit
+        void apply(CktConstraint &constraint) const;
+        /*------------------------------*/
+        /* Getters                      */
+        /*------------------------------*/
+        /// @brief get the number of devices, one per node
+        /// @return the number of devices
+        IndexType numDevices() const { return _devices.size(); }
+        /// @brief get the implementation type of a device
+        /// @param the index of the device, the same as the node
+        ImplType deviceType(IndexType devIdx) const { return _devices.at(devIdx).type; }
+        /// @brief get the width, the length and the fingers of a device, as ConstGen.addInst
+        /// @param the index of the device, the same as the node
+        /// @return the three sizes. unit: e-12 for the width and the length
+        std::vector<IntType> deviceSizes(IndexType devIdx) const { return std::vector<IntType>(_devices.at(devIdx).sizes, _devices.at(devIdx).sizes + 3); }
+        /// @brief get the symmetric node pairs, two node indices each, sorted
+        const std::vector<IndexType> & symPairArray() const { return _symPairs; }
+        /// @brief get the self-symmetric nodes, sorted
+        const std::vector<IndexType> & selfSymArray() const { return _selfSyms; }
+        /// @brief get the symmetric net pairs, two net indices each, sorted
+        const std::vector<IndexType> & symNetPairArray() const { return _symNetPairs; }
+        /// @brief get the self-symmetric nets, sorted
+        const std::vector<IndexType> & selfSymNetArray() const { return _selfSymNets; }
+    private:
+        /// @brief a device of the circuit
+        struct Device
+        {
+            ImplType type = ImplType::UNSET; ///< The implementation type
+            IntType sizes[3] = {-1, -1, -1}; ///< The width, the length and the fingers
+            std::vector<IndexType> nets; ///< The nets of the pins, INDEX_TYPE_MAX if not connected
+        };
+        /// @brief a candidate pair of devices
+        struct Candidate
+        {
+            IndexType devA; ///< The first device
+            IndexType devB; ///< The second device
+            bool swapped; ///< Whether the first two pins of the second device are swapped, for the passive devices
+            IndexType numShared; ///< The number of the signal nets shared by the pins
+        };
+        /// @brief check whether the nets of two devices mirror each other
+        /// @param first: the candidate, filled but for numShared
+        /// @param second: whether the mates found so far have to be respected
+        /// @return whether they mirror each other
+        bool mirrors(Candidate &candidate, bool checkMates) const;
+        /// @brief get the nets of the second device of a candidate in the order of the first
+        /// @param the candidate
+        /// @return the nets
+        std::vector<IndexType> alignedNets(const Candidate &candidate) const;
+        /// @brief get whether a net is a signal net
+        /// @param the index of the net
+        bool isSignal(IndexType netIdx) const { return netIdx != INDEX_TYPE_MAX && !_isPower[netIdx]; }
+    private:
+        const DesignDB &_designDB; ///< The design database
+        std::vector<Device> _devices; ///< The devices, one per node
+        std::vector<char> _isPower; ///< Whether each net is a power net
+        std::vector<IndexType> _netMates; ///< The mate of each net, itself for the self-symmetric nets, INDEX_TYPE_MAX if none
+        std::vector<IndexType> _symPairs; ///< The symmetric node pairs
+        std::vector<IndexType> _selfSyms; ///< The self-symmetric nodes
+        std::vector<IndexType> _symNetPairs; ///< The symmetric net pairs
+        std::vector<IndexType> _selfSymNets; ///< The self-symmetric nets
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_PRIMARY_SYM_H_
@@ -0,0 +1,149 @@
+/**
+ * @file ShapeBuffer.cpp
+ * @brief A flat in-memory buffer of layout shapes, exchanged with the router instead of GDSII files
+ * @date 10/14/2026
+ */
+
+#include "db/ShapeBuffer.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+ShapeBuffer ShapeBuffer::fromCkt(const DesignDB &designDB, IndexType cktIdx)
+{
+    ShapeBuffer buffer;
+    const auto &ckt = designDB.subCkt(cktIdx);
+    if (ckt.hasLayout())
+    {
+        buffer.addLayout(ckt.layout());
+    }
+    return buffer;
+}
+
+void ShapeBuffer::addLayout(const Layout &layout)
+{
+    IndexType numRects = 0;
+    IndexType numTexts = 0;
+    for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); ++layerIdx)
+    {
+        numRects += layout.numRects(layerIdx);
+        numTexts += layout.numTexts(layerIdx);
+    }
+    _rects.reserve(_rects.size() + 4 * numRects);
+    _layers.reserve(_layers.size() + numRects);
+    _datatypes.reserve(_datatypes.size() + numRects);
+    _nets.reserve(_nets.size() + numRects);
+    _texts.reserve(_texts.size() + numTexts);
+    _textLayers.reserve(_textLayers.size() + numTexts);
+    for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); ++layerIdx)
+    {
+        const auto &layer = layout.layer(layerIdx);
+        const auto &xLo = layer.xLoArray();
+        const auto &yLo = layer.yLoArray();
+        const auto &xHi = layer.xHiArray();
+        const auto &yHi = layer.yHiArray();
+        for (IndexType rectIdx = 0; rectIdx < layer.numRects(); ++rectIdx)
+        {
+            _rects.insert(_rects.end(), {xLo[rectIdx], yLo[rectIdx], xHi[rectIdx], yHi[rectIdx]});
+        }
+        _layers.insert(_layers.end(), layer.numRects(), layerIdx);
+        _datatypes.insert(_datatypes.end(), layer.datatypeArray().begin(), layer.datatypeArray().end());
+        _nets.insert(_nets.end(), layer.numRects(), INDEX_TYPE_MAX);
+        _texts.insert(_texts.end(), layer.textList().begin(), layer.textList().end());
+        _textLayers.insert(_textLayers.end(), layer.textList().size(), layerIdx);
+    }
+    if (layout.boundary().valid())
+    {
+        _boundary.unionBox(layout.boundary());
+    }
+}
+
+IndexType ShapeBuffer::addShape(IndexType layer, IndexType datatype, const Box<LocType> &rect, IndexType netIdx)
+{
+    _rects.insert(_rects.end(), {rect.xLo(), rect.yLo(), rect.xHi(), rect.yHi()});
+    _layers.emplace_back(layer);
+    _datatypes.emplace_back(datatype);
+    _nets.emplace_back(netIdx);
+    _boundary.unionBox(rect);
+    return numShapes() - 1;
+}
+
+void ShapeBuffer::addShapes(const std::vector<IndexType> &layers, const std::vector<IndexType> &datatypes, const std::vector<LocType> &rects, const std::vector<IndexType> &nets)
+{
+    const IndexType numAdded = layers.size();
+    AssertMsg(datatypes.size() == numAdded && rects.size() == 4 * numAdded && (nets.empty() || nets.size() == numAdded),
+            "%s: %u layers, %lu datatypes, %lu coordinates and %lu nets do not match \n", __FUNCTION__, numAdded, datatypes.size(), rects.size(), nets.size());
+    _rects.insert(_rects.end(), rects.begin(), rects.end());
+    _layers.insert(_layers.end(), layers.begin(), layers.end());
+    _datatypes.insert(_datatypes.end(), datatypes.begin(), datatypes.end());
+    if (nets.empty())
+    {
+        _nets.insert(_nets.end(), numAdded, INDEX_TYPE_MAX);
+    }
+    else
+    {
+        _nets.insert(_nets.end(), nets.begin(), nets.end());
+    }
+    for (IndexType idx = 0; idx < numAdded; ++idx)
+    {
+        _boundary.unionBox(Box<LocType>(rects[4 * idx], rects[4 * idx + 1], rects[4 * idx + 2], rects[4 * idx + 3]));
+    }
+}
+
+IndexType ShapeBuffer::addText(IndexType layer, const std::string &text, const XY<LocType> &coord)
+{
+    _texts.emplace_back(text, coord);
+    _textLayers.emplace_back(layer);
+    return numTexts() - 1;
+}
+
+void ShapeBuffer::applyTo(Layout &layout) const
+{
+    std::vector<IndexType> numRects(layout.numLayers(), 0);
+    for (IndexType shapeIdx = 0; shapeIdx < numShapes(); ++shapeIdx)
+    {
+        AssertMsg(_layers[shapeIdx] < layout.numLayers(), "%s: layer %u of rectangle %u out of range %u \n", __FUNCTION__, _layers[shapeIdx], shapeIdx, layout.numLayers());
+        ++numRects[_layers[shapeIdx]];
+    }
+    for (IndexType layerIdx = 0; layerIdx < layout.numLayers(); ++layerIdx)
+    {
+        if (numRects[layerIdx] > 0)
+        {
+            layout.layer(layerIdx).reserveRects(layout.numRects(layerIdx) + numRects[layerIdx]);
+        }
+    }
+    for (IndexType shapeIdx = 0; shapeIdx < numShapes(); ++shapeIdx)
+    {
+        const LocType *r = &_rects[4 * shapeIdx];
+        IndexType rectIdx = layout.insertRect(_layers[shapeIdx], r[0], r[1], r[2], r[3]);
+        layout.setRectDatatype(_layers[shapeIdx], rectIdx, _datatypes[shapeIdx]);
+    }
+    for (IndexType textIdx = 0; textIdx < numTexts(); ++textIdx)
+    {
+        AssertMsg(_textLayers[textIdx] < layout.numLayers(), "%s: layer %u of text %u out of range %u \n", __FUNCTION__, _textLayers[textIdx], textIdx, layout.numLayers());
+        layout.insertText(_textLayers[textIdx], _texts[textIdx]);
+    }
+}
+
+std::vector<IndexType> ShapeBuffer::pdkLayerArray(const TechDB &techDB) const
+{
+    std::vector<IndexType> pdkLayers;
+    pdkLayers.reserve(numShapes());
+    for (IndexType layer : _layers)
+    {
+        pdkLayers.emplace_back(techDB.dbLayerToPdk(layer));
+    }
+    return pdkLayers;
+}
+
+void ShapeBuffer::clear()
+{
+    _rects.clear();
+    _layers.clear();
+    _datatypes.clear();
+    _nets.clear();
+    _texts.clear();
+    _textLayers.clear();
+    _boundary = ShapeBuffer().boundary();
+}
+
+PROJECT_NAMESPACE_END
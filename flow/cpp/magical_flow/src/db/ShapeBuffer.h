@@ -0,0 +1,112 @@
+/**
+ * @file ShapeBuffer.h
+ * @brief A flat in-memory buffer of layout shapes, exchanged with the router instead of GDSII files
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_SHAPE_BUFFER_H_
+#define MAGICAL_FLOW_SHAPE_BUFFER_H_
+
+#include <limits>
+#include "DesignDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::ShapeBuffer
+/// @brief the rectangles and the texts of a layout as flat arrays, and its boundary.
+/// The placed layout of a circuit is exported into a buffer for the router in place of the .place.gds, and the routed wires come back in a buffer
+/// appended to the layout in place of the .route.gds, so that the router and the flow do not encode and decode GDSII between them.
+/// The layers are the database layers. The rectangles may be tagged with the nets of the circuit, as the router reports its wires
+class ShapeBuffer
+{
+    public:
+        /// @brief default constructor
+        explicit ShapeBuffer() = default;
+        /// @brief export the placed layout of a circuit and its boundary
+        /// @param first: the design database
+        /// @param second: the index of the circuit
+        /// @return the buffer
+        static ShapeBuffer fromCkt(const DesignDB &designDB, IndexType cktIdx);
+        /// @brief append all the rectangles and the texts of a layout, not tagged with any net, and grow the boundary to cover the layout
+        /// @param the layout
+        void addLayout(const Layout &layout);
+        /// @brief append a rectangle
+        /// @param first: the layer
+        /// @param second: the datatype
+        /// @param third: the rectangle
+        /// @param fourth: the net of the rectangle, INDEX_TYPE_MAX if not tagged
+        /// @return the index of the rectangle
+        IndexType addShape(IndexType layer, IndexType datatype, const Box<LocType> &rect, IndexType netIdx = INDEX_TYPE_MAX);
+        /// @brief append rectangles in bulk
+        /// @param first: the layers
+        /// @param second: the datatypes
+        /// @param third: the rectangles, xLo, yLo, xHi and yHi each
+        /// @param fourth: the nets, or empty if no rectangle is tagged
+        void addShapes(const std::vector<IndexType> &layers, const std::vector<IndexType> &datatypes, const std::vector<LocType> &rects, const std::vector<IndexType> &nets);
+        /// @brief append a text
+        /// @param first: the layer
+        /// @param second: the string
+        /// @param third: the coordinate
+        /// @return the index of the text
+        IndexType addText(IndexType layer, const std::string &text, const XY<LocType> &coord);
+        /// @brief set the boundary
+        /// @param the boundary
+        void setBoundary(const Box<LocType> &boundary) { _boundary = boundary; }
+        /// @brief append the rectangles and the texts into a layout. The boundary of the layout grows to cover them
+        /// @param the layout
+        void applyTo(Layout &layout) const;
+        /// @brief remove all the rectangles and the texts, and empty the boundary
+        void clear();
+        /*------------------------------*/
+        /* Getters                      */
+        /*------------------------------*/
+        /// @brief get the number of rectangles
+        /// @return the number of rectangles
+        IndexType numShapes() const { return _layers.size(); }
+        /// @brief get a rectangle
+        /// @param the index of the rectangle
+        /// @return the rectangle
+        Box<LocType> shape(IndexType shapeIdx) const { AssertMsg(shapeIdx < numShapes(), "%s: %u out of %u \n", __FUNCTION__, shapeIdx, numShapes()); const LocType *r = &_rects[4 * shapeIdx]; return Box<LocType>(r[0], r[1], r[2], r[3]); }
+        /// @brief get the layer of a rectangle
+        IndexType layer(IndexType shapeIdx) const { return _layers.at(shapeIdx); }
+        /// @brief get the datatype of a rectangle
+        IndexType datatype(IndexType shapeIdx) const { return _datatypes.at(shapeIdx); }
+        /// @brief get the net of a rectangle, INDEX_TYPE_MAX if not tagged
+        IndexType net(IndexType shapeIdx) const { return _nets.at(shapeIdx); }
+        /// @brief get the rectangles, xLo, yLo, xHi and yHi each
+        const std::vector<LocType> & rectArray() const { return _rects; }
+        /// @brief get the layers of the rectangles
+        const std::vector<IndexType> & layerArray() const { return _layers; }
+        /// @brief get the datatypes of the rectangles
+        const std::vector<IndexType> & datatypeArray() const { return _datatypes; }
+        /// @brief get the nets of the rectangles
+        const std::vector<IndexType> & netArray() const { return _nets; }
+        /// @brief get the GDSII layers of the rectangles
+        /// @param the technology database
+        /// @return the pdk layers
+        std::vector<IndexType> pdkLayerArray(const TechDB &techDB) const;
+        /// @brief get the number of texts
+        /// @return the number of texts
+        IndexType numTexts() const { return _texts.size(); }
+        /// @brief get a text
+        /// @param the index of the text
+        const TextLayout & text(IndexType textIdx) const { return _texts.at(textIdx); }
+        /// @brief get the layer of a text
+        IndexType textLayer(IndexType textIdx) const { return _textLayers.at(textIdx); }
+        /// @brief get the boundary
+        /// @return the boundary
+        const Box<LocType> & boundary() const { return _boundary; }
+    private:
+        std::vector<LocType> _rects; ///< The rectangles, 4 coordinates each
+        std::vector<IndexType> _layers; ///< The layer of each rectangle
+        std::vector<IndexType> _datatypes; ///< The datatype of each rectangle
+        std::vector<IndexType> _nets; ///< The net of each rectangle, INDEX_TYPE_MAX if not tagged
+        std::vector<TextLayout> _texts; ///< The texts
+        std::vector<IndexType> _textLayers; ///< The layer of each text
+        Box<LocType> _boundary = Box<LocType>(std::numeric_limits<LocType>::max(), std::numeric_limits<LocType>::max(),
+                std::numeric_limits<LocType>::min(), std::numeric_limits<LocType>::min()); ///< The boundary of the layout, empty as Layout::clear
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_SHAPE_BUFFER_H_
@@ -0,0 +1,624 @@
+/**
+ * @file SpectralSim.cpp
+ * @brief The graph spectral similarity of the nodes of a circuit, as GraphSim.specSimScore
+ * @date 10/14/2026
+ */
+
+#include "db/SpectralSim.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+PROJECT_NAMESPACE_BEGIN
+
+constexpr RealType SpectralSim::ALPHA_MIN;
+constexpr RealType SpectralSim::ALPHA_MAX;
+constexpr RealType SpectralSim::MIN_SIZE;
+constexpr RealType SpectralSim::SPECTRUM_RESOLUTION;
+
+namespace
+{
+    /// @brief visit the vertices in [begin, end) reachable from a source in the breadth first order, up to a depth
+    /// @param first: the graph
+    /// @param second: the source vertex
+    /// @param third: the first vertex of the range
+    /// @param fourth: the vertex past the last one of the range
+    /// @param fifth: the largest depth to visit
+    /// @return the visited vertices with their distances to the source, in the visiting order
+    std::vector<std::pair<IndexType, IndexType>> breadthFirst(const SymGraph &graph, IndexType source, IndexType begin, IndexType end, IndexType maxDepth)
+    {
+        std::vector<char> visited(end - begin, 0);
+        std::vector<std::pair<IndexType, IndexType>> order;
+        order.emplace_back(source, 0);
+        visited[source - begin] = 1;
+        for (IndexType head = 0; head < order.size(); ++head)
+        {
+            const auto current = order[head];
+            if (current.second >= maxDepth)
+            {
+                continue;
+            }
+            for (IndexType other : graph.neighbors(current.first))
+            {
+                if (other >= begin && other < end && !visited[other - begin])
+                {
+                    visited[other - begin] = 1;
+                    order.emplace_back(other, current.second + 1);
+                }
+            }
+        }
+        return order;
+    }
+
+    /// @brief the eigenvalues of a symmetric tridiagonal matrix by the QL iterations with implicit shifts
+    /// @param first: the diagonal. Overwritten by the eigenvalues
+    /// @param second: the subdiagonal in its elements [1, n). Destroyed
+    void tridiagonalQL(std::vector<RealType> &diag, std::vector<RealType> &subDiag)
+    {
+        const IntType dim = diag.size();
+        constexpr IntType MAX_ITERATIONS = 60;
+        const RealType eps = std::numeric_limits<RealType>::epsilon();
+        for (IntType idx = 1; idx < dim; ++idx)
+        {
+            subDiag[idx - 1] = subDiag[idx];
+        }
+        subDiag[dim - 1] = 0.0;
+        for (IntType low = 0; low < dim; ++low)
+        {
+            IntType iter = 0;
+            IntType high;
+            do
+            {
+                // Look for a negligible subdiagonal element to split the matrix
+                for (high = low; high < dim - 1; ++high)
+                {
+                    RealType scale = std::abs(diag[high]) + std::abs(diag[high + 1]);
+                    if (std::abs(subDiag[high]) <= eps * scale)
+                    {
+                        break;
+                    }
+                }
+                if (high == low)
+                {
+                    break;
+                }
+                if (iter++ == MAX_ITERATIONS)
+                {
+                    WRN("%s: the QL iterations do not converge \n", __FUNCTION__);
+                    break;
+                }
+                RealType g = (diag[low + 1] - diag[low]) / (2.0 * subDiag[low]);
+                RealType r = std::hypot(g, 1.0);
+                g = diag[high] - diag[low] + subDiag[low] / (g + (g >= 0.0 ? r : -r));
+                RealType s = 1.0, c = 1.0, p = 0.0;
+                IntType idx;
+                for (idx = high - 1; idx >= low; --idx)
+                {
+                    RealType f = s * subDiag[idx];
+                    RealType b = c * subDiag[idx];
+                    r = std::hypot(f, g);
+                    subDiag[idx + 1] = r;
+                    if (r == 0.0)
+                    {
+                        // Recover from the underflow
+                        diag[idx + 1] -= p;
+                        subDiag[high] = 0.0;
+                        break;
+                    }
+                    s = f / r;
+                    c = g / r;
+                    g = diag[idx + 1] - p;
+                    r = (diag[idx] - g) * s + 2.0 * c * b;
+                    p = s * r;
+                    diag[idx + 1] = g + p;
+                    g = c * r - b;
+                }
+                if (r == 0.0 && idx >= low)
+                {
+                    continue;
+                }
+                diag[low] -= p;
+                subDiag[low] = g;
+                subDiag[high] = 0.0;
+            } while (true);
+        }
+    }
+
+    /// @brief the probability of a uniformly random monotone lattice path from (0, 0) to (m, n) to stay where |x * ng - y * mg| < h
+    /// @param first: the larger sample size m
+    /// @param second: the smaller sample size n
+    /// @param third: the greatest common divisor of m and n
+    /// @param fourth: the threshold h
+    /// @return the probability
+    RealType latticeInsideProb(IndexType m, IndexType n, IndexType g, std::int64_t h)
+    {
+        const std::int64_t mg = m / g;
+        const std::int64_t ng = n / g;
+        auto inside = [&](std::int64_t x, std::int64_t y) { return std::abs(x * ng - y * mg) < h; };
+        // A uniformly random path steps in x from (x, y) with the probability (m - x) / (m - x + n - y)
+        auto stepX = [&](IndexType x, IndexType y) { return static_cast<RealType>(m - x) / (m - x + n - y); };
+        auto stepY = [&](IndexType x, IndexType y) { return static_cast<RealType>(n - y) / (m - x + n - y); };
+        std::vector<RealType> column(n + 1, 0.0);
+        std::vector<RealType> next(n + 1, 0.0);
+        column[0] = 1.0;
+        for (IndexType y = 1; y <= n; ++y)
+        {
+            column[y] = inside(0, y) ? column[y - 1] * stepY(0, y - 1) : 0.0;
+        }
+        for (IndexType x = 1; x <= m; ++x)
+        {
+            for (IndexType y = 0; y <= n; ++y)
+            {
+                if (!inside(x, y))
+                {
+                    next[y] = 0.0;
+                    continue;
+                }
+                next[y] = column[y] * stepX(x - 1, y) + (y > 0 ? next[y - 1] * stepY(x, y - 1) : 0.0);
+            }
+            column.swap(next);
+        }
+        return column[n];
+    }
+
+    /// @brief the survival function of the Kolmogorov distribution, as scipy.stats.kstwobign.sf
+    /// @param the statistic scaled by the square root of the effective sample size
+    /// @return the probability of a larger statistic
+    RealType kolmogorovSf(RealType lambda)
+    {
+        if (lambda <= 0.0)
+        {
+            return 1.0;
+        }
+        constexpr RealType PI = 3.14159265358979323846;
+        RealType sum = 0.0;
+        if (lambda < 1.18)
+        {
+            // The theta function form converges fast for the small statistics
+            const RealType y = -PI * PI / (8.0 * lambda * lambda);
+            for (IntType k = 1; k < 100; k += 2)
+            {
+                RealType term = std::exp(k * k * y);
+                sum += term;
+                if (term < 1e-17)
+                {
+                    break;
+                }
+            }
+            return std::max(0.0, 1.0 - std::sqrt(2.0 * PI) / lambda * sum);
+        }
+        for (IntType k = 1; k < 100; ++k)
+        {
+            RealType term = std::exp(-2.0 * k * k * lambda * lambda);
+            sum += (k % 2 == 1) ? term : -term;
+            if (term < 1e-17)
+            {
+                break;
+            }
+        }
+        return std::min(1.0, std::max(0.0, 2.0 * sum));
+    }
+}
+
+void SpectralSim::build(IndexType cktIdx, const std::vector<std::string> &ignoredNets)
+{
+    _graph.build(_designDB, cktIdx, ignoredNets);
+    _eccentricities.assign(_graph.numVertices(), INDEX_TYPE_MAX);
+    _centers.clear();
+    _spectra.clear();
+}
+
+IndexType SpectralSim::eccentricity(IndexType vertex)
+{
+    AssertMsg(vertex < _eccentricities.size(), "%s: vertex %u out of %lu \n", __FUNCTION__, vertex, _eccentricities.size());
+    if (_eccentricities[vertex] == INDEX_TYPE_MAX)
+    {
+        _eccentricities[vertex] = breadthFirst(_graph, vertex, 0, _graph.numVertices(), INDEX_TYPE_MAX).back().second;
+    }
+    return _eccentricities[vertex];
+}
+
+IndexType SpectralSim::rangeEccentricity(IndexType vertex, IndexType begin, IndexType end) const
+{
+    return breadthFirst(_graph, vertex, begin, end, INDEX_TYPE_MAX).back().second;
+}
+
+IndexType SpectralSim::distance(IndexType source, IndexType target) const
+{
+    for (const auto &visit : breadthFirst(_graph, source, 0, _graph.numVertices(), INDEX_TYPE_MAX))
+    {
+        if (visit.first == target)
+        {
+            return visit.second;
+        }
+    }
+    return INDEX_TYPE_MAX;
+}
+
+std::vector<IndexType> SpectralSim::ball(IndexType center, IndexType radius) const
+{
+    std::vector<IndexType> vertices;
+    if (radius == 0)
+    {
+        return vertices;
+    }
+    for (const auto &visit : breadthFirst(_graph, center, 0, _graph.numVertices(), radius - 1))
+    {
+        vertices.emplace_back(visit.first);
+    }
+    std::sort(vertices.begin(), vertices.end());
+    return vertices;
+}
+
+std::pair<IndexType, IndexType> SpectralSim::center(IndexType nodeIdx, SimCenterType centerType)
+{
+    const std::uint64_t key = static_cast<std::uint64_t>(nodeIdx) << 2 | static_cast<std::uint64_t>(centerType);
+    auto cached = _centers.find(key);
+    if (cached != _centers.end())
+    {
+        return cached->second;
+    }
+    const IndexType begin = _graph.nodeBegin(nodeIdx);
+    const IndexType end = _graph.nodeEnd(nodeIdx);
+    const IndexType size = end - begin;
+    std::pair<IndexType, IndexType> result(INDEX_TYPE_MAX, INDEX_TYPE_MAX);
+    if (size == 1)
+    {
+        result = std::make_pair(begin, 0);
+    }
+    else if (size > 1 && centerType == SimCenterType::JORDAN)
+    {
+        // The largest connected component, the first one if tied
+        std::vector<char> assigned(size, 0);
+        std::vector<IndexType> component, largest;
+        for (IndexType vertex = begin; vertex < end; ++vertex)
+        {
+            if (assigned[vertex - begin])
+            {
+                continue;
+            }
+            component.clear();
+            for (const auto &visit : breadthFirst(_graph, vertex, begin, end, INDEX_TYPE_MAX))
+            {
+                assigned[visit.first - begin] = 1;
+                component.emplace_back(visit.first);
+            }
+            if (component.size() > largest.size())
+            {
+                largest = component;
+            }
+        }
+        std::sort(largest.begin(), largest.end());
+        for (IndexType vertex : largest)
+        {
+            IndexType ecc = this->rangeEccentricity(vertex, begin, end);
+            if (ecc < result.second)
+            {
+                result = std::make_pair(vertex, ecc);
+            }
+        }
+    }
+    else if (size > 1 && centerType == SimCenterType::EIGEN)
+    {
+        // The power iterations on the adjacency matrix plus the identity, which has the same principal eigenvector and converges on the bipartite graphs
+        constexpr IndexType MAX_ITERATIONS = 1000;
+        std::vector<RealType> vec(size, 1.0 / std::sqrt(static_cast<RealType>(size)));
+        std::vector<RealType> next(size);
+        for (IndexType iter = 0; iter < MAX_ITERATIONS; ++iter)
+        {
+            RealType norm = 0.0;
+            for (IndexType vertex = begin; vertex < end; ++vertex)
+            {
+                RealType value = vec[vertex - begin];
+                for (IndexType other : _graph.neighbors(vertex))
+                {
+                    if (other >= begin && other < end)
+                    {
+                        value += vec[other - begin];
+                    }
+                }
+                next[vertex - begin] = value;
+                norm += value * value;
+            }
+            norm = std::sqrt(norm);
+            RealType err = 0.0;
+            for (IndexType idx = 0; idx < size; ++idx)
+            {
+                next[idx] /= norm;
+                err += std::abs(next[idx] - vec[idx]);
+            }
+            vec.swap(next);
+            if (err < size * 1e-12)
+            {
+                break;
+            }
+        }
+        IndexType centerIdx = 0;
+        RealType maxSim = 0.0;
+        for (IndexType idx = 0; idx < size; ++idx)
+        {
+            if (maxSim < vec[idx])
+            {
+                centerIdx = idx;
+                maxSim = vec[idx];
+            }
+        }
+        result = std::make_pair(begin + centerIdx, this->rangeEccentricity(begin + centerIdx, begin, end));
+    }
+    else if (size > 1)
+    {
+        // nx.pagerank with its defaults: the damping 0.85, the tolerance 1e-6 and at most 100 iterations
+        constexpr RealType ALPHA = 0.85;
+        constexpr RealType TOLERANCE = 1e-6;
+        constexpr IndexType MAX_ITERATIONS = 100;
+        std::vector<IndexType> degrees(size, 0);
+        for (IndexType vertex = begin; vertex < end; ++vertex)
+        {
+            for (IndexType other : _graph.neighbors(vertex))
+            {
+                degrees[vertex - begin] += (other >= begin && other < end) ? 1 : 0;
+            }
+        }
+        std::vector<RealType> rank(size, 1.0 / size);
+        std::vector<RealType> last(size);
+        for (IndexType iter = 0; iter < MAX_ITERATIONS; ++iter)
+        {
+            rank.swap(last);
+            std::fill(rank.begin(), rank.end(), 0.0);
+            RealType dangleSum = 0.0;
+            for (IndexType idx = 0; idx < size; ++idx)
+            {
+                dangleSum += degrees[idx] == 0 ? last[idx] : 0.0;
+            }
+            dangleSum *= ALPHA;
+            for (IndexType vertex = begin; vertex < end; ++vertex)
+            {
+                const IndexType idx = vertex - begin;
+                for (IndexType other : _graph.neighbors(vertex))
+                {
+                    if (other >= begin && other < end)
+                    {
+                        rank[other - begin] += ALPHA * last[idx] / degrees[idx];
+                    }
+                }
+                rank[idx] += dangleSum / size + (1.0 - ALPHA) / size;
+            }
+            RealType err = 0.0;
+            for (IndexType idx = 0; idx < size; ++idx)
+            {
+                err += std::abs(rank[idx] - last[idx]);
+            }
+            if (err < size * TOLERANCE)
+            {
+                break;
+            }
+        }
+        // The first vertex of the lowest rank
+        IndexType centerIdx = std::min_element(rank.begin(), rank.end()) - rank.begin();
+        result = std::make_pair(begin + centerIdx, this->rangeEccentricity(begin + centerIdx, begin, end));
+    }
+    _centers[key] = result;
+    return result;
+}
+
+const std::vector<RealType> & SpectralSim::spectrum(IndexType center, IndexType radius)
+{
+    const std::uint64_t key = static_cast<std::uint64_t>(center) << 32 | radius;
+    auto cached = _spectra.find(key);
+    if (cached != _spectra.end())
+    {
+        return cached->second;
+    }
+    std::vector<IndexType> vertices = this->ball(center, radius);
+    const IndexType dim = vertices.size();
+    // The Laplacian matrix D - A of the subgraph induced by the ball
+    std::vector<RealType> laplacian(static_cast<std::size_t>(dim) * dim, 0.0);
+    for (IndexType row = 0; row < dim; ++row)
+    {
+        for (IndexType other : _graph.neighbors(vertices[row]))
+        {
+            auto found = std::lower_bound(vertices.begin(), vertices.end(), other);
+            if (found != vertices.end() && *found == other)
+            {
+                laplacian[static_cast<std::size_t>(row) * dim + (found - vertices.begin())] = -1.0;
+                laplacian[static_cast<std::size_t>(row) * dim + row] += 1.0;
+            }
+        }
+    }
+    std::vector<RealType> eigenvalues = symmetricEigenvalues(laplacian, dim);
+    for (RealType &value : eigenvalues)
+    {
+        value = std::round(value / SPECTRUM_RESOLUTION) * SPECTRUM_RESOLUTION;
+    }
+    std::sort(eigenvalues.begin(), eigenvalues.end());
+    return _spectra.emplace(key, std::move(eigenvalues)).first->second;
+}
+
+RealType SpectralSim::score(IndexType nodeIdxA, IndexType nodeIdxB, SimCenterType centerType)
+{
+    const auto centerA = this->center(nodeIdxA, centerType);
+    const auto centerB = this->center(nodeIdxB, centerType);
+    if (centerA.first == INDEX_TYPE_MAX || centerB.first == INDEX_TYPE_MAX)
+    {
+        return 0.0;
+    }
+    // The same radius for both balls, as GraphSim.dist
+    IndexType shortest = this->distance(centerA.first, centerB.first);
+    RealType dist = shortest == INDEX_TYPE_MAX ? std::numeric_limits<RealType>::infinity() : 0.5 * shortest;
+    dist = std::max({dist, ALPHA_MIN * centerA.second, ALPHA_MIN * centerB.second, MIN_SIZE});
+    dist = std::min({dist, ALPHA_MAX * centerA.second, ALPHA_MAX * centerB.second});
+    dist = std::min({dist, static_cast<RealType>(this->eccentricity(centerA.first)), static_cast<RealType>(this->eccentricity(centerB.first))});
+    const IndexType radius = static_cast<IndexType>(std::floor(dist));
+    return ksPValue(this->spectrum(centerA.first, radius), this->spectrum(centerB.first, radius));
+}
+
+std::vector<RealType> SpectralSim::scores(const std::vector<IndexType> &pairs, SimCenterType centerType)
+{
+    AssertMsg(pairs.size() % 2 == 0, "%s: %lu indices do not make pairs \n", __FUNCTION__, pairs.size());
+    std::vector<RealType> values;
+    values.reserve(pairs.size() / 2);
+    for (IndexType idx = 0; idx + 1 < pairs.size(); idx += 2)
+    {
+        values.emplace_back(this->score(pairs[idx], pairs[idx + 1], centerType));
+    }
+    return values;
+}
+
+std::vector<RealType> SpectralSim::symmetricEigenvalues(std::vector<RealType> &matrix, IndexType dim)
+{
+    AssertMsg(matrix.size() == static_cast<std::size_t>(dim) * dim, "%s: %lu elements for dimension %u \n", __FUNCTION__, matrix.size(), dim);
+    std::vector<RealType> diag(dim, 0.0);
+    std::vector<RealType> subDiag(dim, 0.0);
+    if (dim == 0)
+    {
+        return diag;
+    }
+    auto at = [&](IntType row, IntType col) -> RealType & { return matrix[static_cast<std::size_t>(row) * dim + col]; };
+    bool tridiagonal = true;
+    for (IntType row = 2; row < static_cast<IntType>(dim) && tridiagonal; ++row)
+    {
+        for (IntType col = 0; col < row - 1; ++col)
+        {
+            if (at(row, col) != 0.0)
+            {
+                tridiagonal = false;
+                break;
+            }
+        }
+    }
+    if (!tridiagonal)
+    {
+        // The Householder reduction of the lower triangle, without accumulating the transformations
+        for (IntType row = dim - 1; row > 0; --row)
+        {
+            const IntType last = row - 1;
+            RealType h = 0.0;
+            if (last > 0)
+            {
+                RealType scale = 0.0;
+                for (IntType col = 0; col <= last; ++col)
+                {
+                    scale += std::abs(at(row, col));
+                }
+                if (scale == 0.0)
+                {
+                    subDiag[row] = at(row, last);
+                }
+                else
+                {
+                    for (IntType col = 0; col <= last; ++col)
+                    {
+                        at(row, col) /= scale;
+                        h += at(row, col) * at(row, col);
+                    }
+                    RealType f = at(row, last);
+                    RealType g = f >= 0.0 ? -std::sqrt(h) : std::sqrt(h);
+                    subDiag[row] = scale * g;
+                    h -= f * g;
+                    at(row, last) = f - g;
+                    f = 0.0;
+                    for (IntType col = 0; col <= last; ++col)
+                    {
+                        g = 0.0;
+                        for (IntType k = 0; k <= col; ++k)
+                        {
+                            g += at(col, k) * at(row, k);
+                        }
+                        for (IntType k = col + 1; k <= last; ++k)
+                        {
+                            g += at(k, col) * at(row, k);
+                        }
+                        subDiag[col] = g / h;
+                        f += subDiag[col] * at(row, col);
+                    }
+                    const RealType hh = f / (h + h);
+                    for (IntType col = 0; col <= last; ++col)
+                    {
+                        f = at(row, col);
+                        g = subDiag[col] - hh * f;
+                        subDiag[col] = g;
+                        for (IntType k = 0; k <= col; ++k)
+                        {
+                            at(col, k) -= f * subDiag[k] + g * at(row, k);
+                        }
+                    }
+                }
+            }
+            else
+            {
+                subDiag[row] = at(row, last);
+            }
+        }
+        subDiag[0] = 0.0;
+    }
+    else
+    {
+        for (IntType row = 1; row < static_cast<IntType>(dim); ++row)
+        {
+            subDiag[row] = at(row, row - 1);
+        }
+    }
+    for (IntType row = 0; row < static_cast<IntType>(dim); ++row)
+    {
+        diag[row] = at(row, row);
+    }
+    tridiagonalQL(diag, subDiag);
+    std::sort(diag.begin(), diag.end());
+    return diag;
+}
+
+RealType SpectralSim::ksPValue(std::vector<RealType> sampleA, std::vector<RealType> sampleB)
+{
+    constexpr IndexType MAX_EXACT_SIZE = 10000;
+    if (sampleA.empty() || sampleB.empty())
+    {
+        return 0.0;
+    }
+    std::sort(sampleA.begin(), sampleA.end());
+    std::sort(sampleB.begin(), sampleB.end());
+    const IndexType sizeA = sampleA.size();
+    const IndexType sizeB = sampleB.size();
+    // The statistic in the units of 1 / (sizeA * sizeB), as the largest |i * sizeB - j * sizeA| over the steps of the empirical distributions
+    std::int64_t maxDiff = 0;
+    IndexType idxA = 0, idxB = 0;
+    while (idxA < sizeA && idxB < sizeB)
+    {
+        const RealType value = std::min(sampleA[idxA], sampleB[idxB]);
+        while (idxA < sizeA && sampleA[idxA] <= value)
+        {
+            ++idxA;
+        }
+        while (idxB < sizeB && sampleB[idxB] <= value)
+        {
+            ++idxB;
+        }
+        maxDiff = std::max(maxDiff, std::abs(static_cast<std::int64_t>(idxA) * sizeB - static_cast<std::int64_t>(idxB) * sizeA));
+    }
+    IndexType gcd = sizeA, rem = sizeB;
+    while (rem != 0)
+    {
+        IndexType tmp = gcd % rem;
+        gcd = rem;
+        rem = tmp;
+    }
+    // The statistic is h / lcm(sizeA, sizeB)
+    const std::int64_t h = maxDiff / gcd;
+    if (h == 0)
+    {
+        return 1.0;
+    }
+    if (std::max(sizeA, sizeB) <= MAX_EXACT_SIZE)
+    {
+        RealType prob = 1.0 - latticeInsideProb(std::max(sizeA, sizeB), std::min(sizeA, sizeB), gcd, h);
+        if (prob >= 0.0 && prob <= 1.0)
+        {
+            return prob;
+        }
+    }
+    const RealType stat = static_cast<RealType>(maxDiff) / (static_cast<RealType>(sizeA) * sizeB);
+    const RealType effective = std::sqrt(static_cast<RealType>(sizeA) * sizeB / (static_cast<RealType>(sizeA) + sizeB));
+    return kolmogorovSf(effective * stat);
+}
+
+PROJECT_NAMESPACE_END
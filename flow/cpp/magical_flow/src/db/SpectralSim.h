@@ -0,0 +1,119 @@
+/**
+ * @file SpectralSim.h
+ * @brief The graph spectral similarity of the nodes of a circuit, as GraphSim.specSimScore
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_SPECTRAL_SIM_H_
+#define MAGICAL_FLOW_SPECTRAL_SIM_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include "SymGraph.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @brief how the center of the subgraph of a node is chosen, as the centerType of GraphSim.specSimScore
+enum class SimCenterType
+{
+    PAGERANK, ///< The vertex with the lowest pagerank, the default of GraphSim
+    JORDAN, ///< The first vertex of the smallest eccentricity in the largest component
+    EIGEN ///< The vertex with the largest eigenvector centrality
+};
+
+/// @class MAGICAL_FLOW::SpectralSim
+/// @brief the similarity score of two nodes of a circuit in its flattened graph, see SymGraph.
+/// Each node gets a center and a radius in its own subgraph. Around both centers, the balls of a same radius are extracted from the flattened graph,
+/// and the score is the p-value of the two sample Kolmogorov-Smirnov test between the Laplacian spectra of the balls, as scipy.stats.ks_2samp.
+/// The eccentricities, the centers and the spectra of the balls are cached, as the pairs of a circuit share most of their balls
+class SpectralSim
+{
+    public:
+        /// @brief constructor
+        /// @param the design database. Should outlive this
+        explicit SpectralSim(const DesignDB &designDB) : _designDB(designDB) {}
+        /// @brief flatten a circuit and drop the caches
+        /// @param first: the index of the circuit
+        /// @param second: the names of the nets ignored in the graph, such as the power nets
+        void build(IndexType cktIdx, const std::vector<std::string> &ignoredNets);
+        /// @brief get the similarity score of two nodes
+        /// @param first: the index of the first node
+        /// @param second: the index of the second node
+        /// @param third: how the centers are chosen
+        /// @return the p-value in [0, 1]. 0 if a node has no device
+        RealType score(IndexType nodeIdxA, IndexType nodeIdxB, SimCenterType centerType = SimCenterType::PAGERANK);
+        /// @brief get the similarity scores of pairs of nodes
+        /// @param first: the pairs, two node indices each
+        /// @param second: how the centers are chosen
+        /// @return the scores, one per pair
+        std::vector<RealType> scores(const std::vector<IndexType> &pairs, SimCenterType centerType = SimCenterType::PAGERANK);
+        /*------------------------------*/
+        /* The steps of the score       */
+        /*------------------------------*/
+        /// @brief get the center of a node in its own subgraph and the eccentricity of the center there
+        /// @param first: the index of the node
+        /// @param second: how the center is chosen
+        /// @return the vertex of the center and the radius. INDEX_TYPE_MAX for the nodes without any vertex
+        std::pair<IndexType, IndexType> center(IndexType nodeIdx, SimCenterType centerType);
+        /// @brief get the eccentricity of a vertex in the flattened graph, within its connected component
+        /// @param the index of the vertex
+        /// @return the eccentricity
+        IndexType eccentricity(IndexType vertex);
+        /// @brief get the length of the shortest path between two vertices of the flattened graph
+        /// @param first: the index of the source vertex
+        /// @param second: the index of the target vertex
+        /// @return the length. INDEX_TYPE_MAX if they are not connected
+        IndexType distance(IndexType source, IndexType target) const;
+        /// @brief get the ball around a vertex, as GraphSim.BFSSub: the vertices at a distance smaller than the radius
+        /// @param first: the index of the center vertex
+        /// @param second: the radius
+        /// @return the vertices of the ball, sorted
+        std::vector<IndexType> ball(IndexType center, IndexType radius) const;
+        /// @brief get the Laplacian spectrum of the subgraph induced by a ball, computed once per center and radius
+        /// @param first: the index of the center vertex
+        /// @param second: the radius
+        /// @return the eigenvalues, sorted in the ascending order
+        const std::vector<RealType> & spectrum(IndexType center, IndexType radius);
+        /// @brief get the number of cached spectra
+        /// @return the number of cached spectra
+        IndexType numCachedSpectra() const { return _spectra.size(); }
+        /// @brief get the flattened graph
+        /// @return the flattened graph
+        const SymGraph & graph() const { return _graph; }
+        /*------------------------------*/
+        /* Numerical kernels            */
+        /*------------------------------*/
+        /// @brief get the eigenvalues of a real symmetric matrix, by the Householder reduction to a tridiagonal matrix and the implicit QL iterations.
+        /// The reduction is skipped if the matrix is already tridiagonal
+        /// @param first: the matrix in the row major order. Overwritten
+        /// @param second: the dimension of the matrix
+        /// @return the eigenvalues, sorted in the ascending order
+        static std::vector<RealType> symmetricEigenvalues(std::vector<RealType> &matrix, IndexType dim);
+        /// @brief get the p-value of the two-sided two sample Kolmogorov-Smirnov test, as scipy.stats.ks_2samp in its auto mode:
+        /// exact if no sample is larger than 10000, otherwise asymptotic
+        /// @param first: the first sample
+        /// @param second: the second sample
+        /// @return the p-value. 0 if a sample is empty
+        static RealType ksPValue(std::vector<RealType> sampleA, std::vector<RealType> sampleB);
+    private:
+        /// @brief get the eccentricity of a vertex in the subgraph induced by a range of vertices
+        /// @param first: the index of the vertex
+        /// @param second: the first vertex of the range
+        /// @param third: the vertex past the last one of the range
+        /// @return the eccentricity within the connected component of the vertex
+        IndexType rangeEccentricity(IndexType vertex, IndexType begin, IndexType end) const;
+    private:
+        static constexpr RealType ALPHA_MIN = 2.0; ///< The smallest ball radius relative to the radii of the nodes, as GraphSim.alpha_min
+        static constexpr RealType ALPHA_MAX = 3.0; ///< The largest ball radius relative to the radii of the nodes, as GraphSim.alpha_max
+        static constexpr RealType MIN_SIZE = 5.0; ///< The smallest ball radius, as GraphSim.min_size
+        static constexpr RealType SPECTRUM_RESOLUTION = 1e-9; ///< The eigenvalues are rounded to this, so that the equal ones compare equal
+        const DesignDB &_designDB; ///< The design database
+        SymGraph _graph; ///< The flattened circuit
+        std::vector<IndexType> _eccentricities; ///< The cached eccentricities of the vertices, INDEX_TYPE_MAX if not computed
+        std::unordered_map<std::uint64_t, std::pair<IndexType, IndexType>> _centers; ///< The cached centers, by the node and the center type
+        std::unordered_map<std::uint64_t, std::vector<RealType>> _spectra; ///< The cached spectra, by the center and the radius
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_SPECTRAL_SIM_H_
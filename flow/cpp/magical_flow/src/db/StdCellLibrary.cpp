@@ -0,0 +1,163 @@
+/**
+ * @file StdCellLibrary.cpp
+ * @brief The standard cell layouts, loaded once and shared by the standard cell circuits
+ * @date 10/14/2026
+ */
+
+#include "db/StdCellLibrary.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include "parser/GdsMappedLibrary.h"
+#include "util/GzipStream.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+bool StdCellLibrary::setup(CktGraph &ckt, const std::string &pinFile, const std::string &gdsFile)
+{
+    std::shared_ptr<const Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _cells.find(ckt.name());
+        if (it != _cells.end())
+        {
+            entry = it->second;
+        }
+    }
+    if (entry)
+    {
+        ++_numHits;
+    }
+    else
+    {
+        // Loaded out of the lock. Two circuits of a new cell set up at once load it twice, and the first one is kept
+        std::shared_ptr<Entry> loaded = std::make_shared<Entry>();
+        if (!this->load(ckt, pinFile, gdsFile, *loaded))
+        {
+            return false;
+        }
+        ++_numLoads;
+        std::lock_guard<std::mutex> lock(_mutex);
+        entry = _cells.emplace(ckt.name(), loaded).first->second;
+    }
+    if (entry->netNames.size() != ckt.numNets())
+    {
+        WRN("StdCellLibrary: %s has %u nets but the cell has %u \n", ckt.name().c_str(), ckt.numNets(), static_cast<IndexType>(entry->netNames.size()));
+        return false;
+    }
+    for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+    {
+        if (entry->netNames[netIdx] != ckt.net(netIdx).name())
+        {
+            WRN("StdCellLibrary: net %u of %s is %s but %s in the cell \n", netIdx, ckt.name().c_str(), ckt.net(netIdx).name().c_str(), entry->netNames[netIdx].c_str());
+            return false;
+        }
+    }
+    const Box<LocType> &boundary = entry->boundary;
+    ckt.gdsData().setBBox(boundary.xLo(), boundary.yLo(), boundary.xHi(), boundary.yHi());
+    ckt.shareLayout(entry->layout);
+    for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+    {
+        const IoPinConfigure &io = entry->netIos[netIdx];
+        ckt.net(netIdx).setIoShape(io.shape.xLo(), io.shape.yLo(), io.shape.xHi(), io.shape.yHi());
+        ckt.net(netIdx).setIoLayer(io.layer);
+    }
+    return true;
+}
+
+bool StdCellLibrary::load(const CktGraph &ckt, const std::string &pinFile, const std::string &gdsFile, Entry &entry) const
+{
+    std::ifstream in(pinFile);
+    std::string line;
+    if (!in.is_open() || !std::getline(in, line))
+    {
+        ERR("StdCellLibrary: failed to read %s \n", pinFile.c_str());
+        return false;
+    }
+    // The boundary may be written as a list, with brackets and commas
+    std::replace_if(line.begin(), line.end(), [](char c) { return !std::isdigit(static_cast<unsigned char>(c)) && c != '-'; }, ' ');
+    std::istringstream bboxIss(line);
+    LocType xLo, yLo, xHi, yHi;
+    if (!(bboxIss >> xLo >> yLo >> xHi >> yHi))
+    {
+        ERR("StdCellLibrary: no boundary in %s \n", pinFile.c_str());
+        return false;
+    }
+    entry.boundary = Box<LocType>(xLo, yLo, xHi, yHi);
+    while (std::getline(in, line))
+    {
+        std::istringstream iss(line);
+        std::string netName;
+        IoPinConfigure io;
+        if (!(iss >> netName))
+        {
+            continue;
+        }
+        if (!(iss >> io.layer >> xLo >> yLo >> xHi >> yHi) || xLo >= xHi)
+        {
+            ERR("StdCellLibrary: bad pin of net %s in %s \n", netName.c_str(), pinFile.c_str());
+            return false;
+        }
+        io.shape = Box<LocType>(xLo, yLo, xHi, yHi);
+        entry.netNames.emplace_back(netName);
+        entry.netIos.emplace_back(io);
+    }
+    std::shared_ptr<Layout> layout = std::make_shared<Layout>();
+    layout->setBoundary(entry.boundary.xLo(), entry.boundary.yLo(), entry.boundary.xHi(), entry.boundary.yHi());
+    bool success = false;
+    if (MfGzip::isGzipFileName(gdsFile))
+    {
+        success = GdsStreamReader(*layout, ckt.techDB()).read(gdsFile);
+    }
+    else
+    {
+        // A library of many cells is kept mapped for the other cells
+        auto library = GdsMappedLibrary::open(gdsFile);
+        if (library != nullptr)
+        {
+            // The file of a single cell may name it differently, as the _stupid variants of adc1 do
+            if (library->cellIdx(ckt.name()) != INDEX_TYPE_MAX)
+            {
+                success = library->readCell(ckt.name(), *layout, ckt.techDB());
+            }
+            else if (library->numCells() == 1)
+            {
+                success = library->readCell(library->topCellName(), *layout, ckt.techDB());
+            }
+            else
+            {
+                ERR("StdCellLibrary: no cell %s in the library %s \n", ckt.name().c_str(), gdsFile.c_str());
+            }
+        }
+    }
+    if (!success)
+    {
+        ERR("StdCellLibrary: failed to read the layout of %s from %s \n", ckt.name().c_str(), gdsFile.c_str());
+        return false;
+    }
+    entry.layout = std::move(layout);
+    return true;
+}
+
+bool StdCellLibrary::hasCell(const std::string &cellName) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _cells.find(cellName) != _cells.end();
+}
+
+IndexType StdCellLibrary::numCells() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _cells.size();
+}
+
+void StdCellLibrary::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cells.clear();
+    _numHits = 0;
+    _numLoads = 0;
+}
+
+PROJECT_NAMESPACE_END
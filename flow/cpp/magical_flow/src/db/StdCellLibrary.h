@@ -0,0 +1,69 @@
+/**
+ * @file StdCellLibrary.h
+ * @brief The standard cell layouts, loaded once and shared by the standard cell circuits
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_STD_CELL_LIBRARY_H_
+#define MAGICAL_FLOW_STD_CELL_LIBRARY_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "CktGraph.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::StdCellLibrary
+/// @brief The standard cells by name. A cell is loaded on its first setup from the .dumb file of its boundary and net io pins, and from its GDSII layout.
+/// The following circuits of the cell view the same read-only layout through CktGraph::shareLayout, and only copy the boundary and the io pins.
+/// The setups may run concurrently
+class StdCellLibrary
+{
+    public:
+        /// @brief default constructor
+        explicit StdCellLibrary() = default;
+        /// @brief set up a standard cell circuit from the library, loading the cell on a miss
+        /// @param first: the circuit, named by the cell
+        /// @param second: the .dumb file: the boundary on the first line, then "net layer xLo yLo xHi yHi" for each net in the order of the circuit
+        /// @param third: the GDSII file of the cell, or a GDSII library containing it. A library of several cells without the cell fails the setup
+        /// @return whether the cell is loaded and matches the nets of the circuit. The circuit is not changed otherwise
+        bool setup(CktGraph &ckt, const std::string &pinFile, const std::string &gdsFile);
+        /// @brief whether a cell is loaded
+        /// @param the name of the cell
+        bool hasCell(const std::string &cellName) const;
+        /// @brief get the number of loaded cells
+        IndexType numCells() const;
+        /// @brief get the number of setups served by a loaded cell
+        IndexType numHits() const { return _numHits; }
+        /// @brief get the number of cells loaded from the files
+        IndexType numLoads() const { return _numLoads; }
+        /// @brief remove the cells. The circuits keep viewing their layouts
+        void clear();
+    private:
+        /// @brief a loaded cell
+        struct Entry
+        {
+            std::shared_ptr<const Layout> layout; ///< The layout, with the boundary
+            Box<LocType> boundary; ///< The boundary
+            std::vector<std::string> netNames; ///< The names of the nets
+            std::vector<IoPinConfigure> netIos; ///< The io pin of each net
+        };
+        /// @brief load a cell
+        /// @param first: the circuit of the cell
+        /// @param second: the .dumb file
+        /// @param third: the GDSII file or library
+        /// @param fourth: output the cell
+        /// @return whether the files are read
+        bool load(const CktGraph &ckt, const std::string &pinFile, const std::string &gdsFile, Entry &entry) const;
+    private:
+        mutable std::mutex _mutex; ///< Guards _cells
+        std::unordered_map<std::string, std::shared_ptr<const Entry>> _cells; ///< The loaded cells by name
+        std::atomic<IndexType> _numHits{0}; ///< The number of setups from a loaded cell
+        std::atomic<IndexType> _numLoads{0}; ///< The number of loaded cells
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_STD_CELL_LIBRARY_H_
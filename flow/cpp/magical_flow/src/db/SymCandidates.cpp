@@ -0,0 +1,173 @@
+/**
+ * @file SymCandidates.cpp
+ * @brief The candidate node pairs for the symmetry detection, bucketed by structural signatures
+ * @date 10/14/2026
+ */
+
+#include "db/SymCandidates.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include "util/Hash.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+constexpr IndexType SymCandidates::WL_ITERATIONS;
+
+std::uint64_t SymCandidates::wlHash(const SymGraph &graph, IndexType nodeIdx)
+{
+    // Only the edges between the vertices of the node count
+    const IndexType begin = graph.nodeBegin(nodeIdx);
+    const IndexType end = graph.nodeEnd(nodeIdx);
+    IndexType numDevs = 0;
+    for (IndexType vertex = begin; vertex < end; ++vertex)
+    {
+        numDevs += graph.isDevice(vertex) ? 1 : 0;
+    }
+    std::vector<std::uint64_t> labels(end - begin, 0);
+    std::vector<std::uint64_t> newLabels(end - begin);
+    std::vector<std::uint64_t> neighbors;
+    std::vector<std::uint64_t> sorted;
+    std::uint64_t digest = MfHash::FNV_OFFSET;
+    MfHash::mix(digest, numDevs);
+    MfHash::mix(digest, end - begin);
+    for (IndexType iter = 0; iter < WL_ITERATIONS; ++iter)
+    {
+        for (IndexType vertex = begin; vertex < end; ++vertex)
+        {
+            neighbors.clear();
+            for (IndexType other : graph.neighbors(vertex))
+            {
+                if (other >= begin && other < end)
+                {
+                    neighbors.emplace_back(labels[other - begin]);
+                }
+            }
+            std::sort(neighbors.begin(), neighbors.end());
+            std::uint64_t label = MfHash::FNV_OFFSET;
+            MfHash::mix(label, labels[vertex - begin]);
+            for (std::uint64_t neighbor : neighbors)
+            {
+                MfHash::mix(label, neighbor);
+            }
+            newLabels[vertex - begin] = label;
+        }
+        labels.swap(newLabels);
+        // The multiset of the labels is independent of the vertex order
+        sorted = labels;
+        std::sort(sorted.begin(), sorted.end());
+        for (std::uint64_t label : sorted)
+        {
+            MfHash::mix(digest, label);
+        }
+    }
+    return digest;
+}
+
+void SymCandidates::find(IndexType cktIdx, const std::vector<std::string> &ignoredNets, bool matchDevices)
+{
+    const auto &ckt = _designDB.subCkt(cktIdx);
+    const std::unordered_set<std::string> ignored(ignoredNets.begin(), ignoredNets.end());
+    _signatures.assign(ckt.numNodes(), 0);
+    _pairs.clear();
+    SymGraph graph;
+    graph.build(_designDB, cktIdx, ignoredNets);
+    std::vector<char> hasSignature(ckt.numNodes(), 0);
+    std::vector<IntType> neighborTypes;
+    std::vector<char> isNeighbor(ckt.numNodes(), 0);
+    for (IndexType nodeIdx = 0; nodeIdx < ckt.numNodes(); ++nodeIdx)
+    {
+        const auto &node = ckt.node(nodeIdx);
+        if (node.isLeaf())
+        {
+            continue;
+        }
+        const auto &subCkt = _designDB.subCkt(node.subgraphIdx());
+        std::uint64_t digest = wlHash(graph, nodeIdx);
+        MfHash::mix(digest, static_cast<std::uint32_t>(subCkt.layout().boundary().xLen()));
+        MfHash::mix(digest, static_cast<std::uint32_t>(subCkt.layout().boundary().yLen()));
+        if (matchDevices)
+        {
+            MfHash::mix(digest, static_cast<std::uint64_t>(subCkt.implType()));
+            if (MfUtil::isImplTypeDevice(subCkt.implType()) && subCkt.implIdx() != INDEX_TYPE_MAX)
+            {
+                // The devices with identical parameters share their equivalence class
+                MfHash::mix(digest, static_cast<std::uint32_t>(_designDB.phyPropDB().propClassIdx(subCkt.implType(), subCkt.implIdx())));
+            }
+            // The implementation types of the nodes sharing a net other than the ignored ones
+            neighborTypes.clear();
+            for (IndexType pinIdx : node.pinIdxArray())
+            {
+                IndexType netIdx = ckt.pin(pinIdx).netIdx();
+                if (netIdx >= ckt.numNets() || ignored.find(ckt.net(netIdx).name()) != ignored.end())
+                {
+                    continue;
+                }
+                for (IndexType otherPin : ckt.net(netIdx).pinIdxArray())
+                {
+                    IndexType otherIdx = ckt.pin(otherPin).nodeIdx();
+                    if (otherIdx == nodeIdx || otherIdx >= ckt.numNodes() || isNeighbor[otherIdx])
+                    {
+                        continue;
+                    }
+                    isNeighbor[otherIdx] = 1;
+                    const auto &other = ckt.node(otherIdx);
+                    neighborTypes.emplace_back(other.isLeaf() ? -1 : static_cast<IntType>(_designDB.subCkt(other.subgraphIdx()).implType()));
+                }
+            }
+            for (IndexType pinIdx : node.pinIdxArray())
+            {
+                IndexType netIdx = ckt.pin(pinIdx).netIdx();
+                if (netIdx < ckt.numNets())
+                {
+                    for (IndexType otherPin : ckt.net(netIdx).pinIdxArray())
+                    {
+                        IndexType otherIdx = ckt.pin(otherPin).nodeIdx();
+                        if (otherIdx < ckt.numNodes())
+                        {
+                            isNeighbor[otherIdx] = 0;
+                        }
+                    }
+                }
+            }
+            std::sort(neighborTypes.begin(), neighborTypes.end());
+            MfHash::mix(digest, neighborTypes.size());
+            for (IntType type : neighborTypes)
+            {
+                MfHash::mix(digest, static_cast<std::uint32_t>(type));
+            }
+        }
+        _signatures[nodeIdx] = digest;
+        hasSignature[nodeIdx] = 1;
+    }
+    // Bucket the nodes by their signatures, and pair the nodes in each bucket
+    std::unordered_map<std::uint64_t, std::vector<IndexType>> buckets;
+    for (IndexType nodeIdx = 0; nodeIdx < ckt.numNodes(); ++nodeIdx)
+    {
+        if (hasSignature[nodeIdx])
+        {
+            buckets[_signatures[nodeIdx]].emplace_back(nodeIdx);
+        }
+    }
+    std::vector<std::pair<IndexType, IndexType>> pairs;
+    for (const auto &bucket : buckets)
+    {
+        const auto &nodes = bucket.second;
+        for (IndexType first = 0; first < nodes.size(); ++first)
+        {
+            for (IndexType second = first + 1; second < nodes.size(); ++second)
+            {
+                pairs.emplace_back(nodes[first], nodes[second]);
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    _pairs.reserve(2 * pairs.size());
+    for (const auto &pair : pairs)
+    {
+        _pairs.emplace_back(pair.first);
+        _pairs.emplace_back(pair.second);
+    }
+}
+
+PROJECT_NAMESPACE_END
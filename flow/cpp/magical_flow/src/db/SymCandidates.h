@@ -0,0 +1,65 @@
+/**
+ * @file SymCandidates.h
+ * @brief The candidate node pairs for the symmetry detection, bucketed by structural signatures
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_SYM_CANDIDATES_H_
+#define MAGICAL_FLOW_SYM_CANDIDATES_H_
+
+#include <cstdint>
+#include "SymGraph.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::SymCandidates
+/// @brief the pairs of nodes of a circuit that may be symmetric, for S3DET.systemSym to score.
+/// Each node gets a signature, and only the nodes with the same signature are paired.
+/// The signature digests the boundary of the sub circuit and a Weisfeiler-Lehman hash of the subgraph of the node in the flattened circuit, see SymGraph.
+/// The isomorphic subgraphs have the same hash, so this keeps every pair passing the boundary and nx.could_be_isomorphic checks, except the non-isomorphic ones.
+/// Matching the devices further requires the same implementation type and physical properties for the device nodes,
+/// and the same histogram of the implementation types of the neighbor nodes
+class SymCandidates
+{
+    public:
+        /// @brief constructor
+        /// @param the design database. Should outlive this
+        explicit SymCandidates(const DesignDB &designDB) : _designDB(designDB) {}
+        /// @brief find the candidate pairs among the nodes of a circuit
+        /// @param first: the index of the circuit
+        /// @param second: the names of the nets ignored in the subgraphs, such as the power nets
+        /// @param third: whether the devices of a pair should match
+        void find(IndexType cktIdx, const std::vector<std::string> &ignoredNets, bool matchDevices);
+        /*------------------------------*/
+        /* Getters                      */
+        /*------------------------------*/
+        /// @brief get the number of nodes of the circuit
+        /// @return the number of nodes
+        IndexType numNodes() const { return _signatures.size(); }
+        /// @brief get the signature of a node
+        /// @param the index of the node
+        /// @return the signature
+        std::uint64_t signature(IndexType nodeIdx) const { return _signatures.at(nodeIdx); }
+        /// @brief get the signatures of all the nodes
+        const std::vector<std::uint64_t> & signatureArray() const { return _signatures; }
+        /// @brief get the number of candidate pairs
+        /// @return the number of candidate pairs
+        IndexType numPairs() const { return _pairs.size() / 2; }
+        /// @brief get the candidate pairs, two node indices each, sorted as itertools.combinations enumerates them
+        const std::vector<IndexType> & pairArray() const { return _pairs; }
+    private:
+        /// @brief get the Weisfeiler-Lehman hash of the subgraph induced by the vertices of a node
+        /// @param first: the flattened circuit
+        /// @param second: the index of the node
+        /// @return the hash
+        static std::uint64_t wlHash(const SymGraph &graph, IndexType nodeIdx);
+    private:
+        static constexpr IndexType WL_ITERATIONS = 3; ///< The rounds of the label refinement
+        const DesignDB &_designDB; ///< The design database
+        std::vector<std::uint64_t> _signatures; ///< The signatures of the nodes
+        std::vector<IndexType> _pairs; ///< The candidate pairs
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_SYM_CANDIDATES_H_
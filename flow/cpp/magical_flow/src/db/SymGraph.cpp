@@ -0,0 +1,177 @@
+/**
+ * @file SymGraph.cpp
+ * @brief The flattened device graph of a circuit for the symmetry detection, as a compressed adjacency
+ * @date 10/14/2026
+ */
+
+#include "db/SymGraph.h"
+#include <algorithm>
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the number of pins S3DET.addInst gives a device, 0 if not a device
+    IndexType numDevicePins(ImplType implType)
+    {
+        if (implType == ImplType::PCELL_Nch || implType == ImplType::PCELL_Pch)
+        {
+            return 3;
+        }
+        if (implType == ImplType::PCELL_Res || implType == ImplType::PCELL_Cap)
+        {
+            return 2;
+        }
+        return 0;
+    }
+}
+
+IndexType SymGraph::addNet(const std::string &name)
+{
+    _netIgnored.emplace_back(_ignoredNets.find(name) != _ignoredNets.end());
+    return _netIgnored.size() - 1;
+}
+
+void SymGraph::flatten(IndexType cktIdx, const std::vector<IndexType> &ioNets)
+{
+    const auto &ckt = _designDB->subCkt(cktIdx);
+    IndexType numPins = numDevicePins(ckt.implType());
+    if (numPins > 0)
+    {
+        _isDevice.emplace_back(1);
+        _pinNets.emplace_back(INDEX_TYPE_MAX);
+        for (IndexType pinIdx = 0; pinIdx < numPins; ++pinIdx)
+        {
+            _isDevice.emplace_back(0);
+            _pinNets.emplace_back(pinIdx < ioNets.size() ? ioNets[pinIdx] : this->addNet(""));
+        }
+        return;
+    }
+    // The io nets are the nets of the instance, the others are new
+    std::vector<IndexType> netMap(ckt.numNets());
+    for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+    {
+        const auto &net = ckt.net(netIdx);
+        if (net.isIo() && net.ioPos() < ioNets.size())
+        {
+            netMap[netIdx] = ioNets[net.ioPos()];
+        }
+        else
+        {
+            netMap[netIdx] = this->addNet(net.name());
+        }
+    }
+    std::vector<IndexType> nodeIoNets;
+    for (const auto &node : ckt.nodeArray())
+    {
+        if (node.isLeaf())
+        {
+            continue;
+        }
+        nodeIoNets.clear();
+        for (IndexType pinIdx : node.pinIdxArray())
+        {
+            IndexType netIdx = ckt.pin(pinIdx).netIdx();
+            nodeIoNets.emplace_back(netIdx < ckt.numNets() ? netMap[netIdx] : this->addNet(""));
+        }
+        this->flatten(node.subgraphIdx(), nodeIoNets);
+    }
+}
+
+void SymGraph::build(const DesignDB &designDB, IndexType cktIdx, const std::vector<std::string> &ignoredNets)
+{
+    AssertMsg(designDB.hierarchy().isAcyclic(), "%s: the circuit hierarchy has a cycle \n", __FUNCTION__);
+    const auto &ckt = designDB.subCkt(cktIdx);
+    _designDB = &designDB;
+    _ignoredNets = std::unordered_set<std::string>(ignoredNets.begin(), ignoredNets.end());
+    _netIgnored.clear();
+    _pinNets.clear();
+    _isDevice.clear();
+    _nodeStart.assign(1, 0);
+    for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+    {
+        this->addNet(ckt.net(netIdx).name());
+    }
+    std::vector<IndexType> ioNets;
+    for (const auto &node : ckt.nodeArray())
+    {
+        if (!node.isLeaf())
+        {
+            ioNets.clear();
+            for (IndexType pinIdx : node.pinIdxArray())
+            {
+                IndexType netIdx = ckt.pin(pinIdx).netIdx();
+                ioNets.emplace_back(netIdx < ckt.numNets() ? netIdx : this->addNet(""));
+            }
+            this->flatten(node.subgraphIdx(), ioNets);
+        }
+        _nodeStart.emplace_back(_isDevice.size());
+    }
+    // The edges: a device to its pins, which follow it, and a clique over the pins of each net not ignored
+    const IndexType numVertices = _isDevice.size();
+    std::vector<std::vector<IndexType>> netPins(_netIgnored.size());
+    std::vector<IndexType> degrees(numVertices, 0);
+    IndexType devIdx = INDEX_TYPE_MAX;
+    for (IndexType vertex = 0; vertex < numVertices; ++vertex)
+    {
+        if (_isDevice[vertex])
+        {
+            devIdx = vertex;
+            continue;
+        }
+        ++degrees[devIdx];
+        ++degrees[vertex];
+        if (!_netIgnored[_pinNets[vertex]])
+        {
+            netPins[_pinNets[vertex]].emplace_back(vertex);
+        }
+    }
+    for (const auto &pins : netPins)
+    {
+        for (IndexType pin : pins)
+        {
+            degrees[pin] += pins.size() - 1;
+        }
+    }
+    _start.assign(numVertices + 1, 0);
+    for (IndexType vertex = 0; vertex < numVertices; ++vertex)
+    {
+        _start[vertex + 1] = _start[vertex] + degrees[vertex];
+    }
+    _adjacency.resize(_start.back());
+    std::vector<IndexType> fill(_start.begin(), _start.end() - 1);
+    auto addEdge = [&](IndexType first, IndexType second)
+    {
+        _adjacency[fill[first]++] = second;
+        _adjacency[fill[second]++] = first;
+    };
+    for (IndexType vertex = 0; vertex < numVertices; ++vertex)
+    {
+        if (_isDevice[vertex])
+        {
+            devIdx = vertex;
+        }
+        else
+        {
+            addEdge(devIdx, vertex);
+        }
+    }
+    for (const auto &pins : netPins)
+    {
+        for (IndexType first = 0; first < pins.size(); ++first)
+        {
+            for (IndexType second = first + 1; second < pins.size(); ++second)
+            {
+                addEdge(pins[first], pins[second]);
+            }
+        }
+    }
+    for (IndexType vertex = 0; vertex < numVertices; ++vertex)
+    {
+        std::sort(_adjacency.begin() + _start[vertex], _adjacency.begin() + _start[vertex + 1]);
+    }
+    _netIgnored.clear();
+    _pinNets.clear();
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,87 @@
+/**
+ * @file SymGraph.h
+ * @brief The flattened device graph of a circuit for the symmetry detection, as a compressed adjacency
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_SYM_GRAPH_H_
+#define MAGICAL_FLOW_SYM_GRAPH_H_
+
+#include <unordered_set>
+#include "DesignDB.h"
+#include "util/IndexList.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::SymGraph
+/// @brief the graph S3DET.constructGraph builds for a circuit: a vertex per device and per device pin, an edge between a device and its pins,
+/// and an edge between the pins on a same net other than the ignored power nets.
+/// The vertices of each node of the circuit are contiguous, a device followed by its pins, in the order S3DET numbers them once the net vertices are removed
+class SymGraph
+{
+    public:
+        /// @brief default constructor
+        explicit SymGraph() = default;
+        /// @brief flatten a circuit
+        /// @param first: the design database
+        /// @param second: the index of the circuit
+        /// @param third: the names of the nets without pin to pin edges, such as the power nets
+        void build(const DesignDB &designDB, IndexType cktIdx, const std::vector<std::string> &ignoredNets);
+        /*------------------------------*/
+        /* Getters                      */
+        /*------------------------------*/
+        /// @brief get the number of vertices
+        /// @return the number of vertices
+        IndexType numVertices() const { return _isDevice.size(); }
+        /// @brief get the number of edges
+        /// @return the number of edges
+        IndexType numEdges() const { return _adjacency.size() / 2; }
+        /// @brief get the neighbors of a vertex, sorted
+        /// @param the index of the vertex
+        /// @return a view of the neighbors
+        IndexSpan neighbors(IndexType vertex) const { return IndexSpan(_adjacency.data() + _start.at(vertex), _start[vertex + 1] - _start[vertex]); }
+        /// @brief get the degree of a vertex
+        /// @param the index of the vertex
+        /// @return the degree
+        IndexType degree(IndexType vertex) const { return _start.at(vertex + 1) - _start[vertex]; }
+        /// @brief get whether a vertex is a device, otherwise a device pin
+        /// @param the index of the vertex
+        bool isDevice(IndexType vertex) const { return _isDevice.at(vertex); }
+        /// @brief get the number of nodes of the circuit
+        /// @return the number of nodes
+        IndexType numNodes() const { return _nodeStart.empty() ? 0 : _nodeStart.size() - 1; }
+        /// @brief get the first vertex of a node
+        /// @param the index of the node
+        /// @return the index of the first vertex
+        IndexType nodeBegin(IndexType nodeIdx) const { return _nodeStart.at(nodeIdx); }
+        /// @brief get the vertex past the last one of a node
+        /// @param the index of the node
+        /// @return the index past the last vertex
+        IndexType nodeEnd(IndexType nodeIdx) const { return _nodeStart.at(nodeIdx + 1); }
+        /// @brief get the number of vertices of a node. Zero for the leaf nodes
+        /// @param the index of the node
+        /// @return the number of vertices
+        IndexType numNodeVertices(IndexType nodeIdx) const { return this->nodeEnd(nodeIdx) - this->nodeBegin(nodeIdx); }
+    private:
+        /// @brief add the devices of an instance, as S3DET.constructSubgraph and S3DET.addInst
+        /// @param first: the index of the instantiated circuit
+        /// @param second: the flattened nets connected to the pins of the instance
+        void flatten(IndexType cktIdx, const std::vector<IndexType> &ioNets);
+        /// @brief add a new flattened net
+        /// @param the name of the net
+        /// @return the index of the flattened net
+        IndexType addNet(const std::string &name);
+    private:
+        const DesignDB *_designDB = nullptr; ///< The design database being flattened
+        std::unordered_set<std::string> _ignoredNets; ///< The names of the ignored nets
+        std::vector<char> _netIgnored; ///< Whether each flattened net is ignored. Only used while building
+        std::vector<IndexType> _pinNets; ///< The flattened net of each pin vertex, INDEX_TYPE_MAX for the devices. Only used while building
+        std::vector<char> _isDevice; ///< Whether each vertex is a device
+        std::vector<IndexType> _start; ///< The start of the neighbors of each vertex in _adjacency, plus the end
+        std::vector<IndexType> _adjacency; ///< The neighbors of all the vertices
+        std::vector<IndexType> _nodeStart; ///< The first vertex of each node, plus the end
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_SYM_GRAPH_H_
@@ -0,0 +1,379 @@
+/**
+ * @file SyntheticDesign.cpp
+ * @brief A generator of large hierarchical designs with device layouts, for the scaling tests
+ * @date 10/14/2026
+ */
+
+#include "db/SyntheticDesign.h"
+#include <algorithm>
+
+PROJECT_NAMESPACE_BEGIN
+
+constexpr IndexType SyntheticDesign::VDD_NET;
+constexpr IndexType SyntheticDesign::VSS_NET;
+constexpr IndexType SyntheticDesign::NUM_POWER_NETS;
+
+namespace
+{
+    /// @brief the sizes drawn for the devices, few enough that the devices pair up as in real circuits
+    const IntType MOS_WIDTHS[] = {1000000, 2000000, 4000000, 8000000}; ///< unit: e-12 m
+    const IntType MOS_LENGTHS[] = {60000, 120000, 240000}; ///< unit: e-12 m
+    const IntType MOS_FINGERS[] = {1, 2, 4, 8};
+    const IntType RES_LENGTHS[] = {2000000, 5000000, 10000000}; ///< unit: e-12 m
+    const IntType RES_WIDTHS[] = {400000, 800000}; ///< unit: e-12 m
+    const IntType RES_SEGMENTS[] = {1, 2, 4};
+    const IntType CAP_FINGERS[] = {8, 16, 32};
+    const IntType CAP_LENGTHS[] = {2000000, 4000000, 8000000}; ///< unit: e-12 m
+
+    template<typename T, std::size_t N>
+    constexpr IndexType arraySize(const T (&)[N]) { return N; }
+}
+
+IndexType SyntheticDesign::generate(const SyntheticSpec &spec)
+{
+    AssertMsg(spec.fanOut > 0 && spec.devicesPerLeaf > 0, "%s: the fan-out and the devices per leaf should be positive \n", __FUNCTION__);
+    AssertMsg(spec.nchWeight + spec.pchWeight + spec.resWeight + spec.capWeight > 0, "%s: the device mix is empty \n", __FUNCTION__);
+    AssertMsg(spec.meanNetDegree >= 2 && spec.maxNetDegree >= 2, "%s: the signal nets should have two pins at least \n", __FUNCTION__);
+    _spec = spec;
+    _rng.seed(spec.seed);
+    _numGeneratedCkts = 0;
+    // The number of instances and of distinct circuits per level, the top being the level 0
+    std::vector<std::uint64_t> numMasters(spec.depth + 1, 1);
+    std::uint64_t numInstances = 1;
+    std::uint64_t numCkts = 0;
+    for (IndexType level = 0; level <= spec.depth; ++level)
+    {
+        numMasters[level] = spec.numMasters == 0 ? numInstances : std::min<std::uint64_t>(spec.numMasters, numInstances);
+        numCkts += numMasters[level];
+        if (level < spec.depth)
+        {
+            numInstances *= spec.fanOut;
+        }
+        AssertMsg(numInstances < INDEX_TYPE_MAX, "%s: %u levels of %u instances are too many \n", __FUNCTION__, spec.depth, spec.fanOut);
+    }
+    _numDeviceInstances = numInstances * spec.devicesPerLeaf;
+    numCkts += numMasters[spec.depth] * spec.devicesPerLeaf;
+    AssertMsg(_designDB.numCkts() + numCkts < INDEX_TYPE_MAX, "%s: %lu circuits are too many \n", __FUNCTION__, static_cast<unsigned long>(numCkts));
+    _designDB.ckts().reserve(_designDB.numCkts() + numCkts);
+
+    // From the last level up, so that the sub circuits exist when instantiated
+    std::vector<IndexType> masters;
+    for (IndexType master = 0; master < numMasters[spec.depth]; ++master)
+    {
+        masters.emplace_back(this->generateLeaf(spec.depth == 0 ? "SYN_TOP" : "SYN_L" + std::to_string(spec.depth) + "_" + std::to_string(master)));
+    }
+    for (IndexType level = spec.depth; level-- > 0;)
+    {
+        std::vector<IndexType> cells;
+        for (IndexType master = 0; master < numMasters[level]; ++master)
+        {
+            const std::string name = level == 0 ? "SYN_TOP" : "SYN_L" + std::to_string(level) + "_" + std::to_string(master);
+            cells.emplace_back(this->generateCell(name, masters, master * spec.fanOut));
+        }
+        masters = std::move(cells);
+    }
+    INF("SyntheticDesign: %u circuits, %lu device instances \n", _numGeneratedCkts, static_cast<unsigned long>(_numDeviceInstances));
+    return masters.front();
+}
+
+IndexType SyntheticDesign::allocateSubCkt(const std::string &name, IndexType numSignalIos)
+{
+    IndexType cktIdx = _designDB.allocateCkt();
+    ++_numGeneratedCkts;
+    auto &ckt = _designDB.subCkt(cktIdx);
+    ckt.setName(name);
+    for (IndexType netIdx = 0; netIdx < NUM_POWER_NETS + numSignalIos; ++netIdx)
+    {
+        auto &net = ckt.net(ckt.allocateNet());
+        net.setIoPos(netIdx);
+        if (netIdx == VDD_NET)
+        {
+            net.setName("VDD");
+            net.markVddFlag();
+        }
+        else if (netIdx == VSS_NET)
+        {
+            net.setName("VSS");
+            net.markVssFlag();
+        }
+        else
+        {
+            net.setName("IO" + std::to_string(netIdx - NUM_POWER_NETS));
+        }
+    }
+    return cktIdx;
+}
+
+IndexType SyntheticDesign::generateLeaf(const std::string &name)
+{
+    IndexType cktIdx = this->allocateSubCkt(name, _spec.numSignalIos);
+    std::vector<PinSlot> slots;
+    for (IndexType devIdx = 0; devIdx < _spec.devicesPerLeaf; ++devIdx)
+    {
+        auto &ckt = _designDB.subCkt(cktIdx);
+        IndexType nodeIdx = ckt.allocateNode();
+        ckt.node(nodeIdx).setName("M" + std::to_string(devIdx));
+        auto devSlots = this->generateDevice(cktIdx, nodeIdx, this->drawDeviceType());
+        slots.insert(slots.end(), devSlots.begin(), devSlots.end());
+    }
+    this->connectSignals(cktIdx, slots);
+    return cktIdx;
+}
+
+IndexType SyntheticDesign::generateCell(const std::string &name, const std::vector<IndexType> &subMasters, IndexType firstSub)
+{
+    IndexType cktIdx = this->allocateSubCkt(name, _spec.numSignalIos);
+    auto &ckt = _designDB.subCkt(cktIdx);
+    std::vector<PinSlot> slots;
+    for (IndexType instIdx = 0; instIdx < _spec.fanOut; ++instIdx)
+    {
+        IndexType subIdx = subMasters[(firstSub + instIdx) % subMasters.size()];
+        const auto &subCkt = _designDB.subCkt(subIdx);
+        IndexType nodeIdx = ckt.allocateNode();
+        auto &node = ckt.node(nodeIdx);
+        node.setName("X" + std::to_string(instIdx));
+        node.setRefName(subCkt.name());
+        node.setSubgraphIdx(subIdx);
+        // The ios are the first nets of the sub circuit
+        for (IndexType ioIdx = 0; ioIdx < NUM_POWER_NETS + _spec.numSignalIos; ++ioIdx)
+        {
+            IndexType pinIdx = ckt.allocatePin();
+            ckt.pin(pinIdx).setNodeIdx(nodeIdx);
+            ckt.pin(pinIdx).setIntNetIdx(ioIdx);
+            node.appendPinIdx(pinIdx);
+            if (ioIdx < NUM_POWER_NETS)
+            {
+                this->connect(ckt, pinIdx, ioIdx);
+            }
+            else
+            {
+                slots.push_back({nodeIdx, pinIdx});
+            }
+        }
+    }
+    this->connectSignals(cktIdx, slots);
+    return cktIdx;
+}
+
+std::vector<SyntheticDesign::PinSlot> SyntheticDesign::generateDevice(IndexType cktIdx, IndexType nodeIdx, ImplType implType)
+{
+    const bool nmos = implType == ImplType::PCELL_Nch;
+    const bool pmos = implType == ImplType::PCELL_Pch;
+    const bool passive = !nmos && !pmos;
+    const IndexType numPins = passive ? 3 : 4;
+    const char *model = nmos ? "nch" : pmos ? "pch" : implType == ImplType::PCELL_Res ? "rppoly" : "cfmom";
+    IndexType devIdx = _designDB.allocateCkt();
+    ++_numGeneratedCkts;
+    auto &ckt = _designDB.subCkt(cktIdx);
+    auto &node = ckt.node(nodeIdx);
+    const std::string instName = node.name();
+    node.setName(ckt.name() + "_" + instName);
+    node.setRefName(model);
+    node.setSubgraphIdx(devIdx);
+    auto &dev = _designDB.subCkt(devIdx);
+    dev.setName(ckt.name() + "_" + instName);
+    std::vector<PinSlot> slots;
+    for (IndexType idx = 0; idx < numPins; ++idx)
+    {
+        // D, G, S, B for the transistors, THIS, THAT, OTHER for the passive devices, as the netlist parser builds them
+        bool psub = (nmos && idx == 3) || (passive && idx == 2);
+        bool nwell = pmos && idx == 3;
+        IndexType subNetIdx = dev.allocateNet();
+        if (psub)
+        {
+            dev.addPsubIdx(subNetIdx);
+        }
+        else if (nwell)
+        {
+            dev.addNwellIdx(subNetIdx);
+        }
+        dev.net(subNetIdx).setName(std::to_string(idx));
+        IndexType subPinIdx = dev.allocatePin();
+        IndexType subNodeIdx = dev.allocateNode();
+        auto &subPin = dev.pin(subPinIdx);
+        subPin.setNodeIdx(subNodeIdx);
+        subPin.setNetIdx(subNetIdx);
+        if (psub || nwell)
+        {
+            dev.net(subNetIdx).appendSubIdx(subPinIdx);
+        }
+        else
+        {
+            dev.net(subNetIdx).appendPinIdx(subPinIdx);
+        }
+        dev.node(subNodeIdx).setRefName(model);
+        dev.node(subNodeIdx).setName(instName);
+
+        IndexType pinIdx = ckt.allocatePin();
+        auto &pin = ckt.pin(pinIdx);
+        pin.setNodeIdx(nodeIdx);
+        pin.setIntNetIdx(subNetIdx);
+        node.appendPinIdx(pinIdx);
+        if (psub || nwell)
+        {
+            PinType pinType = psub ? PinType::PSUB : PinType::NWELL;
+            subPin.setPinType(pinType);
+            pin.setPinType(pinType);
+            IndexType railIdx = psub ? VSS_NET : VDD_NET;
+            this->connect(ckt, pinIdx, railIdx);
+            ckt.net(railIdx).appendSubIdx(pinIdx);
+        }
+        else if (idx == 2 && drawUnit() < 0.5)
+        {
+            // Half of the sources sit on their rails, so that the current flows through the stacks
+            this->connect(ckt, pinIdx, nmos ? VSS_NET : VDD_NET);
+        }
+        else
+        {
+            slots.push_back({nodeIdx, pinIdx});
+        }
+    }
+
+    // The physical properties
+    auto &props = _designDB.phyPropDB();
+    LocType layoutWidth = 0;
+    IntType layoutFingers = 1;
+    if (!passive)
+    {
+        IndexType propIdx = nmos ? props.allocateNch() : props.allocatePch();
+        MosProp &mos = nmos ? static_cast<MosProp &>(props.nch(propIdx)) : static_cast<MosProp &>(props.pch(propIdx));
+        mos.setWidth(MOS_WIDTHS[drawIndex(arraySize(MOS_WIDTHS))]);
+        mos.setLength(MOS_LENGTHS[drawIndex(arraySize(MOS_LENGTHS))]);
+        mos.setNumFingers(MOS_FINGERS[drawIndex(arraySize(MOS_FINGERS))]);
+        mos.setMult(1);
+        mos.setAttr(model);
+        dev.setImplIdx(propIdx);
+        layoutWidth = mos.width();
+        layoutFingers = mos.numFingers();
+    }
+    else if (implType == ImplType::PCELL_Res)
+    {
+        IndexType propIdx = props.allocateRes();
+        ResProp &res = props.resister(propIdx);
+        res.setLr(RES_LENGTHS[drawIndex(arraySize(RES_LENGTHS))]);
+        res.setWr(RES_WIDTHS[drawIndex(arraySize(RES_WIDTHS))]);
+        res.setSeries(true);
+        res.setSegNum(RES_SEGMENTS[drawIndex(arraySize(RES_SEGMENTS))]);
+        res.setSegSpace(180000);
+        res.setAttr(model);
+        dev.setImplIdx(propIdx);
+        layoutWidth = res.lr();
+        layoutFingers = res.segNum();
+    }
+    else
+    {
+        IndexType propIdx = props.allocateCap();
+        CapProp &cap = props.capacitor(propIdx);
+        cap.setW(70000);
+        cap.setSpacing(70000);
+        cap.setNumFingers(CAP_FINGERS[drawIndex(arraySize(CAP_FINGERS))]);
+        cap.setLr(CAP_LENGTHS[drawIndex(arraySize(CAP_LENGTHS))]);
+        cap.setStm(1);
+        cap.setSpm(3);
+        cap.setFtip(140000);
+        cap.setMulti(1);
+        cap.setAttr(model);
+        dev.setImplIdx(propIdx);
+        layoutWidth = cap.lr();
+        layoutFingers = cap.numFingers();
+    }
+    dev.setImplType(implType);
+    if (_spec.rectsPerDevice > 0 && _designDB.hasTechDB())
+    {
+        // e-12 m into the database unit
+        const RealType dbuPerPico = _designDB.techDB().units().dbu() * 1e-6;
+        this->generateDeviceLayout(dev, std::max<LocType>(1, static_cast<LocType>(layoutWidth * dbuPerPico)), layoutFingers);
+    }
+    return slots;
+}
+
+void SyntheticDesign::generateDeviceLayout(CktGraph &dev, LocType width, IntType numFingers)
+{
+    const IndexType numLayers = _designDB.techDB().numLayers();
+    AssertMsg(numLayers > 0, "%s: the technology database has no layer \n", __FUNCTION__);
+    const LocType pitch = 200;
+    auto &layout = dev.layout();
+    layout.init(numLayers);
+    // The diffusion, then the fingers across it over the other layers in turn
+    layout.insertRect(0, Box<LocType>(0, 0, (numFingers + 1) * pitch, width));
+    for (IndexType rectIdx = 1; rectIdx < _spec.rectsPerDevice; ++rectIdx)
+    {
+        const IndexType layerIdx = numLayers > 1 ? 1 + (rectIdx - 1) % (numLayers - 1) : 0;
+        const LocType x = static_cast<LocType>((rectIdx - 1) % (numFingers + 1)) * pitch + pitch / 4;
+        layout.insertRect(layerIdx, Box<LocType>(x, -pitch / 2, x + pitch / 2, width + pitch / 2));
+    }
+    dev.setIsImpl(true);
+}
+
+void SyntheticDesign::connectSignals(IndexType cktIdx, std::vector<PinSlot> &slots)
+{
+    auto &ckt = _designDB.subCkt(cktIdx);
+    // Shuffle by hand, as std::shuffle differs between implementations
+    for (IndexType idx = slots.size(); idx > 1; --idx)
+    {
+        std::swap(slots[idx - 1], slots[drawIndex(idx)]);
+    }
+    const RealType stop = 1 / (_spec.meanNetDegree - 1);
+    IndexType ioIdx = NUM_POWER_NETS;
+    const IndexType numIos = NUM_POWER_NETS + _spec.numSignalIos;
+    IndexType begin = 0;
+    while (begin < slots.size())
+    {
+        IndexType degree = 2;
+        while (degree < _spec.maxNetDegree && drawUnit() >= stop)
+        {
+            ++degree;
+        }
+        IndexType remaining = slots.size() - begin;
+        // No net of a single pin, but an io may get the last one
+        degree = std::min(degree, remaining);
+        if (remaining - degree == 1)
+        {
+            ++degree;
+        }
+        IndexType netIdx = INDEX_TYPE_MAX;
+        if (ioIdx < numIos)
+        {
+            netIdx = ioIdx++;
+        }
+        else
+        {
+            netIdx = ckt.allocateNet();
+            ckt.net(netIdx).setName("n" + std::to_string(netIdx - numIos));
+        }
+        for (IndexType idx = begin; idx < begin + degree; ++idx)
+        {
+            this->connect(ckt, slots[idx].pinIdx, netIdx);
+        }
+        begin += degree;
+    }
+}
+
+void SyntheticDesign::connect(CktGraph &ckt, IndexType pinIdx, IndexType netIdx)
+{
+    ckt.pin(pinIdx).setNetIdx(netIdx);
+    ckt.net(netIdx).appendPinIdx(pinIdx);
+}
+
+ImplType SyntheticDesign::drawDeviceType()
+{
+    const RealType weights[] = {_spec.nchWeight, _spec.pchWeight, _spec.resWeight, _spec.capWeight};
+    const ImplType types[] = {ImplType::PCELL_Nch, ImplType::PCELL_Pch, ImplType::PCELL_Res, ImplType::PCELL_Cap};
+    RealType total = 0;
+    for (RealType weight : weights)
+    {
+        total += std::max<RealType>(weight, 0);
+    }
+    RealType pick = drawUnit() * total;
+    for (IndexType idx = 0; idx < 4; ++idx)
+    {
+        pick -= std::max<RealType>(weights[idx], 0);
+        if (pick < 0)
+        {
+            return types[idx];
+        }
+    }
+    return ImplType::PCELL_Nch;
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,116 @@
+/**
+ * @file SyntheticDesign.h
+ * @brief A generator of large hierarchical designs with device layouts, for the scaling tests
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_SYNTHETIC_DESIGN_H_
+#define MAGICAL_FLOW_SYNTHETIC_DESIGN_H_
+
+#include <cstdint>
+#include <random>
+#include "DesignDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @brief the parameters of a synthetic design
+struct SyntheticSpec
+{
+    IndexType depth = 2; ///< The number of levels of sub circuits under the top circuit. The circuits of the last level hold the devices
+    IndexType fanOut = 4; ///< The number of sub circuit instances in each circuit above the last level
+    IndexType numMasters = 0; ///< The number of distinct circuits per level, instantiated round-robin. 0 for one circuit per instance
+    IndexType devicesPerLeaf = 32; ///< The number of devices in each circuit of the last level
+    RealType nchWeight = 0.45; ///< The weight of the nch devices in the device mix
+    RealType pchWeight = 0.35; ///< The weight of the pch devices in the device mix
+    RealType resWeight = 0.1; ///< The weight of the resistors in the device mix
+    RealType capWeight = 0.1; ///< The weight of the capacitors in the device mix
+    IndexType numSignalIos = 4; ///< The number of signal ios of each sub circuit, beside VDD and VSS
+    RealType meanNetDegree = 3.0; ///< The mean number of pins of the signal nets. The degrees are 2 plus a geometric distribution
+    IndexType maxNetDegree = 64; ///< The largest number of pins of a signal net
+    IndexType rectsPerDevice = 8; ///< The number of rectangles in the layout of each device. 0 for no device layouts
+    std::uint32_t seed = 0; ///< The seed of the random choices. The same seed and parameters give the same design on every platform
+};
+
+/// @class MAGICAL_FLOW::SyntheticDesign
+/// @brief generate a hierarchical design into a design database, built as the netlist parser builds a parsed one:
+/// the sub circuits with VDD, VSS and the signal ios as their first nets, and one device circuit per device instance,
+/// with its physical properties, its psub and nwell nets and, optionally, an implemented layout of rectangles.
+/// The power nets are flagged as MagicalDB.markPowerNets does, so that the current flow and the placer see them
+class SyntheticDesign
+{
+    public:
+        /// @brief constructor
+        /// @param the design database. Should outlive this. The technology database should be set for the device layouts
+        explicit SyntheticDesign(DesignDB &designDB) : _designDB(designDB) {}
+        /// @brief generate a design. The circuits are appended to the database. Call DesignDB::findRootCkt afterwards, as for a parsed netlist
+        /// @param the parameters
+        /// @return the index of the top circuit
+        IndexType generate(const SyntheticSpec &spec);
+        /*------------------------------*/
+        /* Getters                      */
+        /*------------------------------*/
+        /// @brief get the number of device instances of the last generated design, counted through the hierarchy
+        /// @return the number of device instances
+        std::uint64_t numDeviceInstances() const { return _numDeviceInstances; }
+        /// @brief get the number of circuits of the last generated design, the device circuits included
+        /// @return the number of circuits
+        IndexType numGeneratedCkts() const { return _numGeneratedCkts; }
+    private:
+        /// @brief a pin slot of a circuit under construction, to be connected to a net
+        struct PinSlot
+        {
+            IndexType nodeIdx; ///< The node of the pin
+            IndexType pinIdx; ///< The pin
+        };
+        /// @brief allocate a circuit with the power nets and the signal ios
+        /// @param first: the name
+        /// @param second: the number of signal ios
+        /// @return the index of the circuit
+        IndexType allocateSubCkt(const std::string &name, IndexType numSignalIos);
+        /// @brief generate a circuit of the last level
+        /// @param the name
+        /// @return the index of the circuit
+        IndexType generateLeaf(const std::string &name);
+        /// @brief generate a circuit of a level above the last one
+        /// @param first: the name
+        /// @param second: the masters of the next level, instantiated round-robin
+        /// @param third: the master of the first instance
+        /// @return the index of the circuit
+        IndexType generateCell(const std::string &name, const std::vector<IndexType> &subMasters, IndexType firstSub);
+        /// @brief generate a device circuit for a node of a leaf, and connect its bulk pin
+        /// @param first: the index of the leaf
+        /// @param second: the index of the node
+        /// @param third: the implementation type
+        /// @return the signal pins of the node, to be connected
+        std::vector<PinSlot> generateDevice(IndexType cktIdx, IndexType nodeIdx, ImplType implType);
+        /// @brief draw the layout of a device circuit: the fingers over a diffusion, scaled by the width and the fingers
+        /// @param first: the device circuit
+        /// @param second: the width in the database unit
+        /// @param third: the number of fingers
+        void generateDeviceLayout(CktGraph &dev, LocType width, IntType numFingers);
+        /// @brief connect pin slots to the signal nets: the ios first, then new nets, with the degrees drawn from the spec
+        /// @param first: the index of the circuit
+        /// @param second: the pin slots, shuffled
+        void connectSignals(IndexType cktIdx, std::vector<PinSlot> &slots);
+        /// @brief connect a pin to a net
+        void connect(CktGraph &ckt, IndexType pinIdx, IndexType netIdx);
+        /// @brief draw an implementation type from the device mix
+        ImplType drawDeviceType();
+        /// @brief draw a uniform integer in [0, n)
+        IndexType drawIndex(IndexType n) { return static_cast<IndexType>(_rng() % n); }
+        /// @brief draw a uniform real in [0, 1)
+        RealType drawUnit() { return static_cast<RealType>(_rng() >> 5) / 134217728.0; }
+    private:
+        static constexpr IndexType VDD_NET = 0; ///< The index of VDD in each sub circuit
+        static constexpr IndexType VSS_NET = 1; ///< The index of VSS in each sub circuit
+        static constexpr IndexType NUM_POWER_NETS = 2; ///< VDD and VSS lead the ios of each sub circuit
+        DesignDB &_designDB; ///< The design database
+        SyntheticSpec _spec; ///< The parameters of the design being generated
+        std::mt19937 _rng; ///< The random engine. Only its raw outputs are used, as the distributions of the standard library differ between implementations
+        std::uint64_t _numDeviceInstances = 0; ///< The number of device instances through the hierarchy
+        IndexType _numGeneratedCkts = 0; ///< The number of generated circuits
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_SYNTHETIC_DESIGN_H_
@@ -15,5 +15,10 @@ namespace PARSE
         }
         return true;
     }
+    /// @brief parse the layers and their width, spacing and area rules
+    bool parseSimpleTechRules(const std::string &file, TechDB &techDB)
+    {
+        return ParseSimpleTech(techDB).parse(file);
+    }
 }
 PROJECT_NAMESPACE_END
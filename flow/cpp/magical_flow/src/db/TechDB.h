@@ -8,8 +8,13 @@
 #ifndef MAGICAL_FLOW_TECHDB_H_
 #define MAGICAL_FLOW_TECHDB_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
 #include <unordered_map>
 #include "global/global.h"
+#include "util/HeapBytes.h"
 
 PROJECT_NAMESPACE_BEGIN
 
@@ -44,8 +49,100 @@ class TechUnit
         IntType _gdsHeader = 600; ///< GDSII format header. usually 600 see: http://boolean.klaasholwerda.nl/interface/bnf/gdsformat.html#recordheader
 };
 
+/// @class MAGICAL_FLOW::LayerRule
+/// @brief The width, spacing and area rules of one layer, in database units. A rule of 0 is not checked
+/// The spacing may depend on the width of the wider shape and the parallel run length of the two shapes, as the LEF SPACINGTABLE PARALLELRUNLENGTH
+class LayerRule
+{
+    public:
+        /// @brief default constructor
+        explicit LayerRule() = default;
+        /*------------------------------*/ 
+        /* Getters                      */
+        /*------------------------------*/ 
+        /// @brief get the minimum width
+        /// @return the minimum width. 0 if not checked
+        LocType minWidth() const { return _minWidth; }
+        /// @brief get the minimum spacing, used without a spacing table
+        /// @return the minimum spacing. 0 if not checked
+        LocType minSpacing() const { return _minSpacing; }
+        /// @brief get the minimum area
+        /// @return the minimum area in square database units. 0 if not checked
+        std::int64_t minArea() const { return _minArea; }
+        /// @brief get the heap bytes of the spacing table, beyond sizeof(LayerRule)
+        std::size_t heapBytes() const { return HeapBytes::of(_tableWidths) + HeapBytes::of(_tableLengths) + HeapBytes::of(_tableSpacings); }
+        /// @brief whether the spacing depends on the width and the parallel run length
+        bool hasSpacingTable() const { return !_tableSpacings.empty(); }
+        /// @brief whether any rule is checked
+        bool empty() const { return _minWidth == 0 && _minSpacing == 0 && _minArea == 0 && !hasSpacingTable(); }
+        /// @brief get the required spacing between two shapes
+        /// A row of the table applies if the width is larger than the width of the row, and a column if the parallel run length is larger than its length. The first row and column always apply
+        /// @param first: the width of the wider shape
+        /// @param second: the parallel run length of the two shapes, 0 if they do not run in parallel
+        /// @return the required spacing
+        LocType spacing(LocType width, LocType parallelRun) const
+        {
+            if (!hasSpacingTable())
+            {
+                return _minSpacing;
+            }
+            IndexType row = 0, col = 0;
+            while (row + 1 < _tableWidths.size() && width > _tableWidths[row + 1])
+            {
+                ++row;
+            }
+            while (col + 1 < _tableLengths.size() && parallelRun > _tableLengths[col + 1])
+            {
+                ++col;
+            }
+            return _tableSpacings[row * _tableLengths.size() + col];
+        }
+        /// @brief get the largest spacing required on the layer, the range to search for the neighbors
+        /// @return the largest spacing
+        LocType maxSpacing() const
+        {
+            LocType result = _minSpacing;
+            for (LocType spacing : _tableSpacings)
+            {
+                result = std::max(result, spacing);
+            }
+            return result;
+        }
+        /*------------------------------*/ 
+        /* Setters                      */
+        /*------------------------------*/ 
+        /// @brief set the minimum width
+        /// @param the minimum width
+        void setMinWidth(LocType minWidth) { _minWidth = minWidth; }
+        /// @brief set the minimum spacing
+        /// @param the minimum spacing
+        void setMinSpacing(LocType minSpacing) { _minSpacing = minSpacing; }
+        /// @brief set the minimum area
+        /// @param the minimum area in square database units
+        void setMinArea(std::int64_t minArea) { _minArea = minArea; }
+        /// @brief set the spacing table
+        /// @param first: the widths of the rows, ascending
+        /// @param second: the parallel run lengths of the columns, ascending
+        /// @param third: the spacings, row major
+        void setSpacingTable(std::vector<LocType> widths, std::vector<LocType> lengths, std::vector<LocType> spacings)
+        {
+            AssertMsg(widths.size() * lengths.size() == spacings.size(), "LayerRule::setSpacingTable: %lu spacings for %lu widths and %lu lengths \n", spacings.size(), widths.size(), lengths.size());
+            _tableWidths = std::move(widths);
+            _tableLengths = std::move(lengths);
+            _tableSpacings = std::move(spacings);
+        }
+    private:
+        LocType _minWidth = 0; ///< The minimum width
+        LocType _minSpacing = 0; ///< The minimum spacing without a table
+        std::int64_t _minArea = 0; ///< The minimum area
+        std::vector<LocType> _tableWidths; ///< The widths of the rows of the spacing table
+        std::vector<LocType> _tableLengths; ///< The parallel run lengths of the columns of the spacing table
+        std::vector<LocType> _tableSpacings; ///< The spacing table, row major
+};
+
 /// @class MAGICAL_FLOW::TechDB
 /// @brief The database for needed technology information
+/// The database is built once by the parser and then shared read-only: DesignDB holds it and each CktGraph references it
 class TechDB
 {
     public:
@@ -57,48 +154,190 @@ class TechDB
         /// @brief get the units 
         /// @return the units 
         TechUnit & units() { return _units; }
+        /// @brief get the units 
+        /// @return the units 
+        const TechUnit & units() const { return _units; }
         /// @brief get the number of layers
         /// @return the number of layers
         IndexType numLayers() const { return _dbLayerToPdkLayer.size(); }
         /// @brief convert db layer to techLayer
         /// @param the index of layer in db
         /// @return the layer ID in PDK
-        IndexType dbLayerToPdk(IndexType dbLayerIdx) const { return _dbLayerToPdkLayer.at(dbLayerIdx); }
+        IndexType dbLayerToPdk(IndexType dbLayerIdx) const
+        {
+            AssertMsg(dbLayerIdx < numLayers(), "TechDB::dbLayerToPdk: db layer %u out of range %u \n", dbLayerIdx, numLayers());
+            return _dbLayerToPdkLayer[dbLayerIdx];
+        }
         /// @brief convert pdk layer to db layer
         /// @param the pdk layer
-        /// @return the db layer
-        IndexType pdkLayerToDb(IndexType pdkLayer) const { return _pdkLayerToDbLayer.at(pdkLayer); }
+        /// @return the db layer. INDEX_TYPE_MAX if the pdk layer is not defined in the tech file
+        IndexType pdkLayerToDb(IndexType pdkLayer) const { return pdkLayer < _pdkLayerToDbLayer.size() ? _pdkLayerToDbLayer[pdkLayer] : INDEX_TYPE_MAX; }
         /// @brief convert layer name to db layer
         /// @param the name of the layer
-        /// @return the corresponding layer index in the db
-        IndexType layerNameToIdx(const std::string &name) const { return _layerNameToDbLayer.at(name); }
+        /// @return the corresponding layer index in the db. INDEX_TYPE_MAX if the name is not defined in the tech file
+        IndexType layerNameToIdx(const std::string &name) const
+        {
+            if (_layerNameSlots.empty())
+            {
+                return INDEX_TYPE_MAX;
+            }
+            IndexType mask = _layerNameSlots.size() - 1;
+            for (IndexType slot = std::hash<std::string>()(name) & mask; _layerNameSlots[slot] != INDEX_TYPE_MAX; slot = (slot + 1) & mask)
+            {
+                if (_layerNames[_layerNameSlots[slot]] == name)
+                {
+                    return _layerNameSlots[slot];
+                }
+            }
+            return INDEX_TYPE_MAX;
+        }
+        /// @brief get the name of a layer
+        /// @param the index of layer in db
+        /// @return the name of the layer
+        const std::string & layerName(IndexType dbLayerIdx) const { return _layerNames.at(dbLayerIdx); }
+        /// @brief get the heap bytes of the technology, beyond sizeof(TechDB)
+        std::size_t heapBytes() const
+        {
+            std::size_t bytes = HeapBytes::of(_dbLayerToPdkLayer) + HeapBytes::of(_pdkLayerToDbLayer) + HeapBytes::of(_layerNames)
+                + HeapBytes::of(_layerRules) + HeapBytes::of(_cutConnections) + HeapBytes::of(_gateLayers) + HeapBytes::of(_layerNameSlots);
+            for (const auto &name : _layerNames)
+            {
+                bytes += HeapBytes::of(name);
+            }
+            for (const auto &rule : _layerRules)
+            {
+                bytes += rule.heapBytes();
+            }
+            for (const auto &connections : _cutConnections)
+            {
+                bytes += HeapBytes::of(connections);
+            }
+            return bytes;
+        }
+        /// @brief get the rules of a layer
+        /// @param the index of layer in db
+        /// @return the rules of the layer
+        const LayerRule & layerRule(IndexType dbLayerIdx) const { return _layerRules.at(dbLayerIdx); }
+        /// @brief get the db layer of a metal layer, such as Net::ioPinMetalLayer. The metal layers are named M1, M2... in the technology
+        /// @param the metal layer, 1 for M1
+        /// @return the db layer. INDEX_TYPE_MAX if not defined in the tech file
+        IndexType metalLayerToDb(IndexType metalLayer) const { return this->layerNameToIdx("M" + std::to_string(metalLayer)); }
+        /// @brief whether a layer is a cut layer connecting other layers
+        /// @param the index of layer in db
+        bool isCutLayer(IndexType dbLayerIdx) const { return !_cutConnections.at(dbLayerIdx).empty(); }
+        /// @brief whether the layer stack is known, i.e. some layer is a cut layer
+        bool hasLayerStack() const
+        {
+            return std::any_of(_cutConnections.begin(), _cutConnections.end(), [](const std::vector<IndexType> &layers) { return !layers.empty(); });
+        }
+        /// @brief get the layers a cut layer connects, where its rectangles overlap them
+        /// @param the index of layer in db
+        /// @return the db layers. Empty if not a cut layer
+        const std::vector<IndexType> & cutConnections(IndexType dbLayerIdx) const { return _cutConnections.at(dbLayerIdx); }
+        /// @brief get the gate layer splitting a diffusion layer. A diffusion rectangle does not conduct under the gates crossing it
+        /// @param the index of layer in db
+        /// @return the db layer of the gates. INDEX_TYPE_MAX if not a diffusion layer
+        IndexType gateLayer(IndexType dbLayerIdx) const { return _gateLayers.at(dbLayerIdx); }
+        /// @brief whether any layer has a rule to check
+        bool hasLayerRules() const
+        {
+            return std::any_of(_layerRules.begin(), _layerRules.end(), [](const LayerRule &rule) { return !rule.empty(); });
+        }
         /*------------------------------*/ 
         /* Setters                      */
         /*------------------------------*/ 
+        /// @brief set the rules of a layer
+        /// @param first: the index of layer in db
+        /// @param second: the rules
+        void setLayerRule(IndexType dbLayerIdx, const LayerRule &rule) { _layerRules.at(dbLayerIdx) = rule; }
+        /// @brief make a cut layer connect a layer
+        /// @param first: the index of the cut layer in db
+        /// @param second: the index of the connected layer in db
+        void addCutConnection(IndexType cutLayerIdx, IndexType dbLayerIdx)
+        {
+            AssertMsg(dbLayerIdx < numLayers() && dbLayerIdx != cutLayerIdx, "TechDB::addCutConnection: cannot connect layer %u to cut layer %u \n", dbLayerIdx, cutLayerIdx);
+            auto &layers = _cutConnections.at(cutLayerIdx);
+            if (std::find(layers.begin(), layers.end(), dbLayerIdx) == layers.end())
+            {
+                layers.emplace_back(dbLayerIdx);
+            }
+        }
+        /// @brief make a layer a diffusion layer split at the rectangles of a gate layer
+        /// @param first: the index of the diffusion layer in db
+        /// @param second: the index of the gate layer in db
+        void setGateLayer(IndexType diffLayerIdx, IndexType gateLayerIdx)
+        {
+            AssertMsg(gateLayerIdx < numLayers() && gateLayerIdx != diffLayerIdx, "TechDB::setGateLayer: cannot split layer %u by layer %u \n", diffLayerIdx, gateLayerIdx);
+            _gateLayers.at(diffLayerIdx) = gateLayerIdx;
+        }
         /*------------------------------*/ 
         /* Building the db              */
         /*------------------------------*/ 
-        /// @brief push back a new layer
+        /// @brief push back a new layer. The layers should be added in the ascending order of their tech layer IDs
         /// @param first: the tech layer ID
         /// @param second: the name of the layer
-        /// @return the index of the layer
+        /// @return the index of the layer. INDEX_TYPE_MAX if the tech layer ID is not larger than those of the layers already added
         IndexType addNewLayer(IndexType techID, const std::string &name)
         {
-            if (!_dbLayerToPdkLayer.empty())
+            if (techID == INDEX_TYPE_MAX || (!_dbLayerToPdkLayer.empty() && _dbLayerToPdkLayer.back() >= techID))
             {
-                AssertMsg(_dbLayerToPdkLayer.back() < techID, "TechDB::addNewLayer: the order of adding layers is wrong.");
+                ERR("TechDB::%s: layer %s of tech layer %u is out of the order of the tech layers \n", __FUNCTION__, name.c_str(), techID);
+                return INDEX_TYPE_MAX;
             }
             IndexType index = _dbLayerToPdkLayer.size(); 
             _dbLayerToPdkLayer.emplace_back(techID);
-            _pdkLayerToDbLayer.at(techID) = index;
-            _layerNameToDbLayer[name] = index;
+            _layerRules.emplace_back();
+            _cutConnections.emplace_back();
+            _gateLayers.emplace_back(INDEX_TYPE_MAX);
+            if (techID >= _pdkLayerToDbLayer.size())
+            {
+                _pdkLayerToDbLayer.resize(techID + 1, INDEX_TYPE_MAX);
+            }
+            _pdkLayerToDbLayer[techID] = index;
+            IndexType existing = this->layerNameToIdx(name);
+            _layerNames.emplace_back(name);
+            if (existing != INDEX_TYPE_MAX)
+            {
+                // The later definition wins, as the names are looked up by the slot content
+                _layerNames[existing].clear();
+            }
+            this->rehashLayerNames();
             return index;
         }
+    private:
+        /// @brief rebuild the open addressing table of the layer names. The load factor is kept at most 1/2
+        void rehashLayerNames()
+        {
+            IndexType capacity = 8;
+            while (capacity < 2 * _layerNames.size())
+            {
+                capacity *= 2;
+            }
+            _layerNameSlots.assign(capacity, INDEX_TYPE_MAX);
+            IndexType mask = capacity - 1;
+            for (IndexType layerIdx = 0; layerIdx < _layerNames.size(); ++layerIdx)
+            {
+                if (_layerNames[layerIdx].empty())
+                {
+                    continue;
+                }
+                IndexType slot = std::hash<std::string>()(_layerNames[layerIdx]) & mask;
+                while (_layerNameSlots[slot] != INDEX_TYPE_MAX)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                _layerNameSlots[slot] = layerIdx;
+            }
+        }
     private:
         TechUnit _units; ///< Units 
         std::vector<IndexType> _dbLayerToPdkLayer; ///< _dbLayerToLayerId[the index of layer in this project] = the layer ID in the PDK
-        std::vector<IndexType> _pdkLayerToDbLayer; ///< _pdkLayerToDbLayer[PDK layer ID] = the index of layer in this project. The size of the vector is const defined in "global/constant.h"
-        std::unordered_map<std::string, IndexType> _layerNameToDbLayer; ///< _layerNameToDbLayer["name of the layer"] = index of layer in db
+        std::vector<IndexType> _pdkLayerToDbLayer; ///< _pdkLayerToDbLayer[PDK layer ID] = the index of layer in this project. Sized to "global/constant.h" RESERVED_LAYERS_NUMBER and grown for larger IDs
+        std::vector<std::string> _layerNames; ///< _layerNames[index of layer in db] = name of the layer. Empty if the name is redefined by a later layer
+        std::vector<LayerRule> _layerRules; ///< _layerRules[index of layer in db] = the rules of the layer
+        std::vector<std::vector<IndexType>> _cutConnections; ///< _cutConnections[index of cut layer in db] = the layers it connects
+        std::vector<IndexType> _gateLayers; ///< _gateLayers[index of diffusion layer in db] = the gate layer splitting it. INDEX_TYPE_MAX if not a diffusion layer
+        std::vector<IndexType> _layerNameSlots; ///< Open addressing hash table with linear probing of the db layer indices, keyed by the layer names
 };
 
 namespace PARSE
@@ -106,6 +345,11 @@ namespace PARSE
     /// @brief parser layer ID
     /// @param the input file name for layers(simple techfile)
     bool parseSimpleTechFile(const std::string &file, TechDB &techDB);
+    /// @brief parse the layers and their width, spacing and area rules
+    /// If the technology already has the layers, e.g. from parseSimpleTechFile, the layers are matched by TECHLAYER and only their rules are set
+    /// @param first: the simple tech file in the LEF-like format of ParseSimpleTech::parse
+    /// @param second: the technology database
+    bool parseSimpleTechRules(const std::string &file, TechDB &techDB);
 }
 PROJECT_NAMESPACE_END
 
@@ -0,0 +1,254 @@
+/**
+ * @file NativeFlow.cpp
+ * @brief The stages of the flow run in C++, from a JSON run specification
+ * @date 10/14/2026
+ */
+
+#include "main/NativeFlow.h"
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include "db/MemoryUsage.h"
+#include "db/PcellGenerator.h"
+#include "db/PrimarySym.h"
+#include "parser/ParseNetlist.h"
+#include "util/Tracer.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the default names of the power and digital nets, as in Params.py
+    const std::vector<std::string> DEFAULT_VDD_NET_NAMES = {"VDD", "vdd", "vdda", "vddd"};
+    const std::vector<std::string> DEFAULT_VSS_NET_NAMES = {"VSS", "GND", "vss", "gnd", "vssa", "vssd"};
+    const std::vector<std::string> DEFAULT_DIGITAL_NET_NAMES = {"clk"};
+    /// @brief the power nets never paired by the constraints, S3DET.ignore_set
+    const std::vector<std::string> IGNORED_NET_NAMES = {"gnd", "vss", "vss_sub", "vrefn", "vrefnd", "avss", "dvss", "vss_d",
+        "vdd", "vdd_and", "vdd_c", "vdd_comp", "vdd_gm", "vddd", "vdda", "veld", "avdd", "vrefp", "vrefnp", "avdd_sar", "vdd_ac", "dvdd", "vdd_int", "vddac", "vdd_d"};
+
+    bool fileExists(const std::string &fileName)
+    {
+        std::ifstream in(fileName);
+        return in.good();
+    }
+}
+
+bool NativeFlow::run()
+{
+    const std::string traceFile = _spec.string("traceFile");
+    if (!traceFile.empty())
+    {
+        Tracer::enable(true);
+        Tracer::enableMemoryTracking(_spec.boolean("traceMemory", false));
+    }
+    _resultDir = _spec.string("resultDir");
+    std::string checkpoint;
+    bool success = this->parse();
+    if (success)
+    {
+        this->traceMemory("parse");
+        ScopedTimer timer("native", "flow");
+        this->markNets();
+        if (_spec.boolean("nativeConstGen", false))
+        {
+            this->genConstraints();
+        }
+        if (_spec.boolean("nativePcell", false))
+        {
+            this->generateDevices();
+        }
+        this->traceMemory("native");
+        success = this->saveCheckpoint(checkpoint);
+    }
+    if (!traceFile.empty())
+    {
+        if (!Tracer::writeChromeTrace(traceFile))
+        {
+            WRN("NativeFlow: cannot write the trace %s \n", traceFile.c_str());
+        }
+        INF("%s", Tracer::summary().c_str());
+    }
+    return success && this->runPnrCommand(checkpoint);
+}
+
+bool NativeFlow::parse()
+{
+    ScopedTimer timer("parse", "flow");
+    ScopedMemoryPeak memory("parse");
+    bool isHspice = _spec.has("hspice_netlist");
+    const std::string netlist = _spec.string(isHspice ? "hspice_netlist" : "spectre_netlist");
+    if (netlist.empty())
+    {
+        ERR("NativeFlow: no input netlist file! \n");
+        return false;
+    }
+    if (!PARSE::parseNetlist(_resultDir + netlist, _designDB, isHspice))
+    {
+        return false;
+    }
+    std::shared_ptr<TechDB> techDB = std::make_shared<TechDB>();
+    if (!PARSE::parseSimpleTechFile(_spec.string("simple_tech_file"), *techDB))
+    {
+        return false;
+    }
+    if (_spec.has("ruleTechFile") && !PARSE::parseSimpleTechRules(_spec.string("ruleTechFile"), *techDB))
+    {
+        return false;
+    }
+    _designDB.setTechDB(techDB); // Shared by all the circuits
+    if (!_designDB.findRootCkt())
+    {
+        ERR("NativeFlow: no root circuit in %s \n", netlist.c_str());
+        return false;
+    }
+    _designDB.compactConnectivity(); // The netlist is complete: pack the pin lists of the nodes and the nets
+    return true;
+}
+
+void NativeFlow::markNets()
+{
+    const std::vector<std::string> vddNames = _spec.strings("vddNetNames", DEFAULT_VDD_NET_NAMES);
+    const std::vector<std::string> vssNames = _spec.strings("vssNetNames", DEFAULT_VSS_NET_NAMES);
+    const std::vector<std::string> digitalNames = _spec.strings("digitalNetNames", DEFAULT_DIGITAL_NET_NAMES);
+    const std::set<std::string> vddSet(vddNames.begin(), vddNames.end());
+    const std::set<std::string> vssSet(vssNames.begin(), vssNames.end());
+    const std::set<std::string> digitalSet(digitalNames.begin(), digitalNames.end());
+    for (IndexType cktIdx = 0; cktIdx < _designDB.numCkts(); ++cktIdx)
+    {
+        CktGraph &ckt = _designDB.subCkt(cktIdx);
+        // Using flags from body connections
+        for (IndexType psubIdx = 0; psubIdx < ckt.numPsubs(); ++psubIdx)
+        {
+            ckt.psub(psubIdx).markVssFlag();
+        }
+        for (IndexType nwellIdx = 0; nwellIdx < ckt.numNwells(); ++nwellIdx)
+        {
+            ckt.nwell(nwellIdx).markVddFlag();
+        }
+        // Using external naming-based labeling
+        for (IndexType netIdx = 0; netIdx < ckt.numNets(); ++netIdx)
+        {
+            Net &net = ckt.net(netIdx);
+            if (vddSet.count(net.name()))
+            {
+                net.markVddFlag();
+            }
+            if (vssSet.count(net.name()))
+            {
+                net.markVssFlag();
+            }
+            if (digitalSet.count(net.name()))
+            {
+                net.markDigitalFlag();
+            }
+            else
+            {
+                net.markAnalogFlag();
+            }
+        }
+    }
+}
+
+void NativeFlow::genConstraints()
+{
+    ScopedTimer timer("constraint", "flow");
+    std::vector<std::string> powerNets = IGNORED_NET_NAMES;
+    for (const auto &names : {_spec.strings("vddNetNames", DEFAULT_VDD_NET_NAMES), _spec.strings("vssNetNames", DEFAULT_VSS_NET_NAMES)})
+    {
+        powerNets.insert(powerNets.end(), names.begin(), names.end());
+    }
+    PrimarySym primarySym(_designDB);
+    IndexType numGenerated = 0;
+    for (IndexType cktIdx = 0; cktIdx < _designDB.numCkts(); ++cktIdx)
+    {
+        CktGraph &ckt = _designDB.subCkt(cktIdx);
+        // The .sym files of the user are read by Constraint.loadSym, and the other circuits are left to S3DET
+        if (ckt.implType() != ImplType::UNSET || ckt.constraint().isSymGenerated() || !primarySym.isPrimary(cktIdx) || fileExists(_resultDir + ckt.name() + ".sym"))
+        {
+            continue;
+        }
+        primarySym.generate(cktIdx, powerNets);
+        primarySym.apply(ckt.constraint());
+        ++numGenerated;
+    }
+    INF("NativeFlow: symmetry constraints of %u primary circuits \n", numGenerated);
+}
+
+void NativeFlow::generateDevices()
+{
+    ScopedTimer timer("devices", "flow");
+    PcellGenerator generator(_designDB);
+    std::vector<IndexType> cktIdxs;
+    for (IndexType cktIdx = 0; cktIdx < _designDB.numCkts(); ++cktIdx)
+    {
+        if (generator.canGenerate(cktIdx))
+        {
+            cktIdxs.emplace_back(cktIdx);
+        }
+    }
+    // Unflipped. The placement flow regenerates the flipped instances of the symmetric pairs
+    IndexType numGenerated = generator.generateAll(cktIdxs, std::vector<bool>());
+    INF("NativeFlow: layouts of %u devices \n", numGenerated);
+}
+
+void NativeFlow::traceMemory(const std::string &stage) const
+{
+    if (Tracer::enabled() && Tracer::memoryTrackingEnabled())
+    {
+        MemoryUsage::ofDesign(_designDB).trace(stage);
+    }
+}
+
+bool NativeFlow::saveCheckpoint(std::string &checkpoint)
+{
+    ScopedMemoryPeak memory("saveCheckpoint");
+    const std::string checkpointDir = _spec.string("checkpointDir");
+    checkpoint = checkpointDir.empty() ? _resultDir + "native.mfdb" : checkpointDir + "/native.mfdb";
+    if (!_designDB.saveCheckpoint(checkpoint))
+    {
+        ERR("NativeFlow: cannot write the checkpoint %s \n", checkpoint.c_str());
+        return false;
+    }
+    INF("NativeFlow: design written to %s \n", checkpoint.c_str());
+    return true;
+}
+
+bool NativeFlow::runPnrCommand(const std::string &checkpoint)
+{
+    const std::string command = _spec.string("pnrCommand");
+    if (command.empty())
+    {
+        INF("NativeFlow: no pnrCommand, stopping before the placement \n");
+        return true;
+    }
+    // The Python flow resumes from the checkpoint, with the rest of the specification unchanged
+    RunSpec pnrSpec = _spec;
+    pnrSpec.setJson("resumeCheckpoint", RunSpec::quote(checkpoint));
+    pnrSpec.setJson("pnrCommand", "null");
+    pnrSpec.setJson("traceFile", "null");
+    const std::string pnrSpecFile = checkpoint + ".json";
+    if (!pnrSpec.write(pnrSpecFile))
+    {
+        return false;
+    }
+    std::string line = command;
+    const std::string::size_type pos = line.find("{params}");
+    if (pos == std::string::npos)
+    {
+        line += " " + pnrSpecFile;
+    }
+    else
+    {
+        line.replace(pos, 8, pnrSpecFile);
+    }
+    INF("NativeFlow: %s \n", line.c_str());
+    IntType status = std::system(line.c_str());
+    if (status != 0)
+    {
+        ERR("NativeFlow: the place and route command failed with status %d \n", status);
+        return false;
+    }
+    return true;
+}
+
+PROJECT_NAMESPACE_END
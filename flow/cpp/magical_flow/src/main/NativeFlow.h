@@ -0,0 +1,60 @@
+/**
+ * @file NativeFlow.h
+ * @brief The stages of the flow run in C++, from a JSON run specification
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_NATIVE_FLOW_H_
+#define MAGICAL_FLOW_NATIVE_FLOW_H_
+
+#include "db/DesignDB.h"
+#include "parser/RunSpec.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::NativeFlow
+/// @brief The flow of Magical.py up to the placement, without the Python interpreter:
+/// the netlist and the technology are parsed, the power and digital nets marked,
+/// and, with "nativeConstGen", the symmetry constraints of the primary circuits generated, as MagicalDB.py and Constraint.py do with the same keys of the specification.
+/// The signal and current paths are left to Placer.placeSignalPaths, so that the .sigpath files and CSFlow still feed the placer.
+/// With "nativePcell", the layouts of the devices are generated as well.
+/// The design is then written as a checkpoint. The placer, the router and the device generator of the PDK are not part of this tree:
+/// if the specification has a "pnrCommand", e.g. "python3 Magical.py {params}", it is run on a copy of the specification resuming from the checkpoint,
+/// and the Python flow places, routes and writes the GDSII. The constraints left to S3DET and the .sym files are generated there as well
+class NativeFlow
+{
+    public:
+        /// @brief constructor
+        /// @param the run specification
+        explicit NativeFlow(RunSpec spec) : _spec(std::move(spec)) {}
+        /// @brief run the stages
+        /// @return whether successful
+        bool run();
+        /// @brief get the design database
+        const DesignDB & designDB() const { return _designDB; }
+    private:
+        /// @brief parse the netlist and the technology, as MagicalDB.parse
+        bool parse();
+        /// @brief mark the power and digital nets, as MagicalDB.markPowerNets and MagicalDB.markDigitalNets
+        void markNets();
+        /// @brief generate the symmetry constraints of the primary circuits without a .sym file, as Constraint.primarySymNative
+        void genConstraints();
+        /// @brief generate the layouts of the devices with the PcellGenerator, if nativePcell is set
+        void generateDevices();
+        /// @brief sample the memory footprint of the design into the trace, if traceMemory is set
+        /// @param the stage, naming the samples
+        void traceMemory(const std::string &stage) const;
+        /// @brief write the design into checkpointDir, else resultDir, as native.mfdb
+        /// @param output the file written
+        bool saveCheckpoint(std::string &checkpoint);
+        /// @brief run the pnrCommand of the specification on the checkpoint, if any
+        bool runPnrCommand(const std::string &checkpoint);
+    private:
+        RunSpec _spec; ///< The run specification
+        DesignDB _designDB; ///< The design database
+        std::string _resultDir; ///< The resultDir of the specification
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_NATIVE_FLOW_H_
@@ -0,0 +1,31 @@
+/**
+ * @file main.cpp
+ * @brief magicalFlow_run: run the flow from a JSON run specification without the Python interpreter
+ * @date 10/14/2026
+ */
+
+#include <cstdio>
+#include "main/NativeFlow.h"
+
+int main(int argc, char **argv)
+{
+    using namespace PROJECT_NAMESPACE;
+    if (argc != 2 || std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")
+    {
+        std::fprintf(stderr, "Usage: %s <run specification.json>\n"
+                             "Parses the design, generates the primary constraints with \"nativeConstGen\", and writes <resultDir>native.mfdb.\n"
+                             "If the specification has \"pnrCommand\", e.g. \"python3 Magical.py {params}\", it is run on a copy of the specification\n"
+                             "resuming from the checkpoint, for the placement, the routing and the GDSII\n", argv[0]);
+        return argc == 2 ? 0 : 1;
+    }
+    MsgPrinter::startTimer();
+    RunSpec spec;
+    if (!spec.read(argv[1]))
+    {
+        return 1;
+    }
+    NativeFlow flow(std::move(spec));
+    bool success = flow.run();
+    MsgPrinter::flush();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,483 @@
+/**
+ * @file GdsMappedLibrary.cpp
+ * @brief A memory-mapped GDSII library which decodes the requested cells only
+ * @date 10/14/2026
+ */
+
+#include "parser/GdsMappedLibrary.h"
+#include <cmath>
+#include <mutex>
+#include "util/Tracer.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief GDSII record types. See: http://boolean.klaasholwerda.nl/interface/bnf/gdsformat.html
+    enum RecordType : std::uint8_t
+    {
+        REC_HEADER = 0x00, REC_ENDLIB = 0x04, REC_BGNSTR = 0x05, REC_STRNAME = 0x06, REC_ENDSTR = 0x07,
+        REC_BOUNDARY = 0x08, REC_PATH = 0x09, REC_SREF = 0x0A, REC_AREF = 0x0B, REC_TEXT = 0x0C,
+        REC_LAYER = 0x0D, REC_DATATYPE = 0x0E, REC_WIDTH = 0x0F, REC_XY = 0x10, REC_ENDEL = 0x11,
+        REC_SNAME = 0x12, REC_COLROW = 0x13, REC_NODE = 0x15, REC_STRANS = 0x1A, REC_MAG = 0x1B,
+        REC_ANGLE = 0x1C, REC_PATHTYPE = 0x21, REC_BOX = 0x2D
+    };
+    /// @brief the maximum depth of the cell references. Deeper references are treated as cyclic
+    constexpr IndexType MAX_REFERENCE_DEPTH = 64;
+
+    /// @brief a record in the mapping
+    struct Record
+    {
+        std::uint8_t type = 0;
+        const std::uint8_t *data = nullptr; ///< The data after the 4-byte header
+        IndexType numBytes = 0; ///< The number of bytes of the data
+        std::int16_t int16(IndexType idx) const { return static_cast<std::int16_t>((data[2 * idx] << 8) | data[2 * idx + 1]); }
+        std::int32_t int32(IndexType idx) const
+        {
+            const std::uint8_t *p = data + 4 * idx;
+            return static_cast<std::int32_t>((static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16) | (static_cast<std::uint32_t>(p[2]) << 8) | p[3]);
+        }
+        /// @brief the 8-byte real: sign bit, 7-bit excess-64 base-16 exponent, 56-bit mantissa
+        RealType real8() const
+        {
+            std::uint64_t mantissa = 0;
+            for (IndexType idx = 1; idx < 8; ++idx)
+            {
+                mantissa = (mantissa << 8) | data[idx];
+            }
+            RealType value = std::ldexp(static_cast<RealType>(mantissa), 4 * (static_cast<IntType>(data[0] & 0x7F) - 64) - 56);
+            return (data[0] & 0x80) ? -value : value;
+        }
+        /// @brief the string, without the padding
+        std::string str() const
+        {
+            IndexType len = numBytes;
+            while (len > 0 && data[len - 1] == '\0')
+            {
+                --len;
+            }
+            return std::string(reinterpret_cast<const char *>(data), len);
+        }
+    };
+
+    /// @brief walk the records of a byte range
+    class RecordCursor
+    {
+        public:
+            explicit RecordCursor(const char *begin, const char *end) : _pos(reinterpret_cast<const std::uint8_t *>(begin)), _end(reinterpret_cast<const std::uint8_t *>(end)) {}
+            /// @brief read the next record
+            /// @return false at the end of the range, or at a malformed record
+            bool next(Record &rec)
+            {
+                if (_pos == _end)
+                {
+                    return false;
+                }
+                IndexType len = (_end - _pos < 4) ? 0 : ((_pos[0] << 8) | _pos[1]);
+                if (len < 4 || len > static_cast<std::size_t>(_end - _pos))
+                {
+                    _failed = true;
+                    return false;
+                }
+                rec.type = _pos[2];
+                rec.data = _pos + 4;
+                rec.numBytes = len - 4;
+                _pos += len;
+                return true;
+            }
+            /// @brief the offset past the last read record from a base
+            std::size_t offset(const char *base) const { return reinterpret_cast<const char *>(_pos) - base; }
+            bool failed() const { return _failed; }
+        private:
+            const std::uint8_t *_pos;
+            const std::uint8_t *_end;
+            bool _failed = false;
+    };
+
+    /// @brief the libraries shared by GdsMappedLibrary::open
+    struct LibraryRegistry
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<const GdsMappedLibrary>> libraries;
+    };
+
+    LibraryRegistry & registry()
+    {
+        static LibraryRegistry reg;
+        return reg;
+    }
+
+    /// @brief get the modification time and the size of a file
+    bool fileStamp(const std::string &fileName, std::int64_t &mtime, std::size_t &size)
+    {
+        struct stat st;
+        if (::stat(fileName.c_str(), &st) != 0)
+        {
+            return false;
+        }
+        mtime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        size = st.st_size;
+        return true;
+    }
+}
+
+GdsMappedLibrary::GdsMappedLibrary(const std::string &fileName) : _fileName(fileName), _file(fileName)
+{
+    std::size_t size = 0;
+    if (!_file.valid() || !fileStamp(fileName, _mtime, size))
+    {
+        return;
+    }
+    _fileSize = _file.size();
+    _valid = this->index();
+}
+
+bool GdsMappedLibrary::index()
+{
+    ScopedTimer timer("indexGds", "gds");
+    ScopedMemoryPeak memory("indexGds");
+    RecordCursor cursor(_file.data(), _file.data() + _file.size());
+    Record rec;
+    if (!cursor.next(rec) || rec.type != REC_HEADER)
+    {
+        // Not a GDSII file, or a compressed one
+        return false;
+    }
+    bool inStruct = false;
+    while (cursor.next(rec))
+    {
+        if (rec.type == REC_ENDLIB)
+        {
+            break;
+        }
+        if (rec.type == REC_BGNSTR)
+        {
+            inStruct = true;
+        }
+        else if (rec.type == REC_STRNAME && inStruct)
+        {
+            _cellIdx[rec.str()] = _cellNames.size();
+            _cellNames.emplace_back(rec.str());
+            _cellBegin.emplace_back(cursor.offset(_file.data()));
+            _cellEnd.emplace_back(_file.size());
+        }
+        else if (rec.type == REC_ENDSTR && inStruct)
+        {
+            inStruct = false;
+            if (!_cellEnd.empty())
+            {
+                _cellEnd.back() = cursor.offset(_file.data()) - 4;
+            }
+        }
+    }
+    if (cursor.failed() || inStruct)
+    {
+        ERR("GdsMappedLibrary: %s is truncated or malformed \n", _fileName.c_str());
+        return false;
+    }
+    Tracer::count("gds cells indexed", _cellNames.size());
+    return true;
+}
+
+std::shared_ptr<const GdsMappedLibrary> GdsMappedLibrary::open(const std::string &fileName)
+{
+    std::int64_t mtime = 0;
+    std::size_t size = 0;
+    if (!fileStamp(fileName, mtime, size))
+    {
+        ERR("GdsMappedLibrary: failed to open %s \n", fileName.c_str());
+        return nullptr;
+    }
+    LibraryRegistry &reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        auto it = reg.libraries.find(fileName);
+        if (it != reg.libraries.end())
+        {
+            if (it->second->_mtime == mtime && it->second->_fileSize == size)
+            {
+                return it->second;
+            }
+            // Changed since mapped
+            reg.libraries.erase(it);
+        }
+    }
+    // Indexed out of the lock. Two threads opening the same file index it twice, and the first one is kept
+    auto library = std::make_shared<const GdsMappedLibrary>(fileName);
+    if (!library->valid())
+    {
+        ERR("GdsMappedLibrary: failed to map %s \n", fileName.c_str());
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.libraries.emplace(fileName, library).first->second;
+}
+
+void GdsMappedLibrary::closeAll()
+{
+    LibraryRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.libraries.clear();
+}
+
+IndexType GdsMappedLibrary::numOpen()
+{
+    LibraryRegistry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.libraries.size();
+}
+
+const std::string & GdsMappedLibrary::topCellName() const
+{
+    static const std::string empty;
+    return _cellNames.empty() ? empty : _cellNames.back();
+}
+
+bool GdsMappedLibrary::readCell(const std::string &cellName, Layout &layout, const TechDB &techDB) const
+{
+    ScopedTimer timer("readGdsCell", "gds");
+    IndexType topIdx = this->cellIdx(cellName);
+    if (topIdx == INDEX_TYPE_MAX)
+    {
+        ERR("GdsMappedLibrary: no cell %s in %s \n", cellName.c_str(), _fileName.c_str());
+        return false;
+    }
+    std::vector<std::unique_ptr<CellDef>> cells(this->numCells());
+    cells[topIdx].reset(new CellDef());
+    if (!this->decode(topIdx, techDB, *cells[topIdx]))
+    {
+        return false;
+    }
+    this->insert(*cells[topIdx], GdsTransform(), layout);
+    bool success = true;
+    for (const auto &ref : cells[topIdx]->refs)
+    {
+        success = this->instantiate(ref, GdsTransform(), 0, cells, techDB, layout) && success;
+    }
+    return success;
+}
+
+bool GdsMappedLibrary::decode(IndexType cellIdx, const TechDB &techDB, CellDef &cell) const
+{
+    Tracer::count("gds cells decoded");
+    RecordCursor cursor(_file.data() + _cellBegin[cellIdx], _file.data() + _cellEnd[cellIdx]);
+    ::klib::Polygon2RectBatch<LocType> polygons; // The boundaries to slice at the end of the cell
+    std::vector<IndexType> polyLayers;
+    std::vector<IndexType> polyDatatypes;
+    auto addRect = [&](IndexType layerIdx, IndexType datatype, const Box<LocType> &rect)
+    {
+        cell.layers.emplace_back(layerIdx);
+        cell.rects.emplace_back(rect);
+        cell.datatypes.emplace_back(datatype);
+    };
+    // The element being decoded
+    std::uint8_t elemType = 0;
+    IntType layer = 0, datatype = 0, pathType = 0;
+    LocType width = 0;
+    std::vector<XY<LocType>> pts, simplePts;
+    std::vector<Box<LocType>> pathRects;
+    Reference ref;
+    Record rec;
+    while (cursor.next(rec))
+    {
+        switch (rec.type)
+        {
+            case REC_BOUNDARY: case REC_PATH: case REC_SREF: case REC_AREF:
+            case REC_TEXT: case REC_NODE: case REC_BOX: elemType = rec.type; break;
+            case REC_LAYER: if (rec.numBytes >= 2) { layer = rec.int16(0); } break;
+            case REC_DATATYPE: if (rec.numBytes >= 2) { datatype = rec.int16(0); } break;
+            case REC_PATHTYPE: if (rec.numBytes >= 2) { pathType = rec.int16(0); } break;
+            case REC_WIDTH: if (rec.numBytes >= 4) { width = std::abs(rec.int32(0)); } break;
+            case REC_XY:
+            {
+                pts.clear();
+                for (IndexType idx = 0; 8 * idx + 8 <= rec.numBytes; ++idx)
+                {
+                    pts.emplace_back(rec.int32(2 * idx), rec.int32(2 * idx + 1));
+                }
+                break;
+            }
+            case REC_SNAME: ref.cellName = rec.str(); break;
+            case REC_STRANS: if (rec.numBytes >= 2) { ref.reflect = (rec.int16(0) & 0x8000) != 0; } break;
+            case REC_COLROW:
+            {
+                if (rec.numBytes >= 4)
+                {
+                    ref.cols = static_cast<IndexType>(std::max<IntType>(rec.int16(0), 1));
+                    ref.rows = static_cast<IndexType>(std::max<IntType>(rec.int16(1), 1));
+                }
+                break;
+            }
+            case REC_ANGLE:
+            {
+                if (rec.numBytes >= 8)
+                {
+                    ref.angle = static_cast<IntType>(std::lround(rec.real8()));
+                    if (ref.angle % 90 != 0)
+                    {
+                        // Marked for skipping at ENDEL
+                        ref.angle = INT_TYPE_MAX;
+                    }
+                }
+                break;
+            }
+            case REC_MAG:
+            {
+                // The magnification of a TEXT only scales its label
+                if ((elemType == REC_SREF || elemType == REC_AREF) && rec.numBytes >= 8 && std::fabs(rec.real8() - 1.0) > 1e-9)
+                {
+                    WRN("GdsMappedLibrary: magnification %f of %s is ignored \n", rec.real8(), ref.cellName.c_str());
+                }
+                break;
+            }
+            case REC_ENDEL:
+            {
+                if ((elemType == REC_BOUNDARY || elemType == REC_PATH) && !pts.empty())
+                {
+                    IndexType layerIdx = techDB.pdkLayerToDb(static_cast<IndexType>(layer));
+                    if (layerIdx == INDEX_TYPE_MAX)
+                    {
+                        // The layer is not in the tech file
+                    }
+                    else if (elemType == REC_BOUNDARY)
+                    {
+                        simplePts = pts;
+                        if (::klib::simplifyRectilinear(simplePts) && simplePts.size() > 4)
+                        {
+                            cell.polyLayers.emplace_back(layerIdx);
+                            cell.polyDatatypes.emplace_back(static_cast<IndexType>(datatype));
+                            cell.polyPts.insert(cell.polyPts.end(), simplePts.begin(), simplePts.end());
+                            cell.polyStart.emplace_back(cell.polyPts.size());
+                        }
+                        else
+                        {
+                            polygons.addPolygon(pts.begin(), pts.end());
+                            polyLayers.emplace_back(layerIdx);
+                            polyDatatypes.emplace_back(static_cast<IndexType>(datatype));
+                        }
+                    }
+                    else
+                    {
+                        pathRects.clear();
+                        if (MfGds::pathToRects(pts, width, pathType, pathRects) > 0)
+                        {
+                            WRN("GdsMappedLibrary: non-Manhattan path segment on layer %u is skipped \n", layerIdx);
+                        }
+                        for (const auto &rect : pathRects)
+                        {
+                            addRect(layerIdx, static_cast<IndexType>(datatype), rect);
+                        }
+                    }
+                }
+                else if ((elemType == REC_SREF || elemType == REC_AREF) && !pts.empty())
+                {
+                    if (ref.angle == INT_TYPE_MAX)
+                    {
+                        WRN("GdsMappedLibrary: non-Manhattan reference to %s is skipped \n", ref.cellName.c_str());
+                    }
+                    else
+                    {
+                        ref.origin = pts[0];
+                        if (elemType == REC_AREF && pts.size() >= 3)
+                        {
+                            ref.colStep = XY<LocType>((pts[1].x() - pts[0].x()) / static_cast<LocType>(ref.cols), (pts[1].y() - pts[0].y()) / static_cast<LocType>(ref.cols));
+                            ref.rowStep = XY<LocType>((pts[2].x() - pts[0].x()) / static_cast<LocType>(ref.rows), (pts[2].y() - pts[0].y()) / static_cast<LocType>(ref.rows));
+                        }
+                        else
+                        {
+                            ref.cols = ref.rows = 1;
+                        }
+                        cell.refs.emplace_back(std::move(ref));
+                    }
+                }
+                elemType = 0;
+                layer = datatype = pathType = 0;
+                width = 0;
+                pts.clear();
+                ref = Reference();
+                break;
+            }
+            default: break;
+        }
+    }
+    if (cursor.failed())
+    {
+        ERR("GdsMappedLibrary: malformed structure %s in %s \n", _cellNames[cellIdx].c_str(), _fileName.c_str());
+        return false;
+    }
+    polygons.run();
+    for (IndexType polyIdx = 0; polyIdx < polygons.numPolygons(); ++polyIdx)
+    {
+        for (const auto &rect : polygons.rects(polyIdx))
+        {
+            addRect(polyLayers[polyIdx], polyDatatypes[polyIdx], rect);
+        }
+    }
+    return true;
+}
+
+void GdsMappedLibrary::insert(const CellDef &cell, const GdsTransform &trans, Layout &layout) const
+{
+    for (IndexType idx = 0; idx < cell.rects.size(); ++idx)
+    {
+        IndexType rectIdx = layout.insertRect(cell.layers[idx], trans.apply(cell.rects[idx]));
+        if (cell.datatypes[idx] != 0)
+        {
+            layout.setRectDatatype(cell.layers[idx], rectIdx, cell.datatypes[idx]);
+        }
+    }
+    std::vector<XY<LocType>> pts;
+    for (IndexType polyIdx = 0; polyIdx < cell.polyLayers.size(); ++polyIdx)
+    {
+        pts.clear();
+        for (IndexType ptIdx = cell.polyStart[polyIdx]; ptIdx < cell.polyStart[polyIdx + 1]; ++ptIdx)
+        {
+            pts.emplace_back(trans.apply(cell.polyPts[ptIdx].x(), cell.polyPts[ptIdx].y()));
+        }
+        layout.insertPolygon(cell.polyLayers[polyIdx], pts.begin(), pts.end(), cell.polyDatatypes[polyIdx]);
+    }
+}
+
+bool GdsMappedLibrary::instantiate(const Reference &ref, const GdsTransform &parent, IndexType depth, std::vector<std::unique_ptr<CellDef>> &cells, const TechDB &techDB, Layout &layout) const
+{
+    if (depth >= MAX_REFERENCE_DEPTH)
+    {
+        ERR("GdsMappedLibrary: the references to %s are too deep or cyclic \n", ref.cellName.c_str());
+        return false;
+    }
+    IndexType cellIdx = this->cellIdx(ref.cellName);
+    if (cellIdx == INDEX_TYPE_MAX)
+    {
+        WRN("GdsMappedLibrary: referenced cell %s is not defined \n", ref.cellName.c_str());
+        return true;
+    }
+    if (!cells[cellIdx])
+    {
+        cells[cellIdx].reset(new CellDef());
+        if (!this->decode(cellIdx, techDB, *cells[cellIdx]))
+        {
+            return false;
+        }
+    }
+    const CellDef &cell = *cells[cellIdx];
+    for (IndexType col = 0; col < ref.cols; ++col)
+    {
+        for (IndexType row = 0; row < ref.rows; ++row)
+        {
+            LocType dx = ref.origin.x() + static_cast<LocType>(col) * ref.colStep.x() + static_cast<LocType>(row) * ref.rowStep.x();
+            LocType dy = ref.origin.y() + static_cast<LocType>(col) * ref.colStep.y() + static_cast<LocType>(row) * ref.rowStep.y();
+            GdsTransform trans = parent.compose(GdsTransform(dx, dy, ref.angle, ref.reflect));
+            this->insert(cell, trans, layout);
+            for (const auto &child : cell.refs)
+            {
+                if (!this->instantiate(child, trans, depth + 1, cells, techDB, layout))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,125 @@
+/**
+ * @file GdsMappedLibrary.h
+ * @brief A memory-mapped GDSII library which decodes the requested cells only
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_GDS_MAPPED_LIBRARY_H_
+#define MAGICAL_FLOW_GDS_MAPPED_LIBRARY_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "parser/GdsStreamReader.h"
+#include "util/MappedFile.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::GdsMappedLibrary
+/// @brief A GDSII file mapped into memory, for reading a few cells out of a large library such as the standard cells.
+/// On opening, only the record headers are walked to index the byte range of each structure. readCell then decodes the structure of a cell and the structures it references, straight from the mapping,
+/// and inserts their shapes flattened into a Layout, with the same element handling as GdsStreamReader: the boxes and the paths become rectangles, the other rectilinear boundaries are kept as polygons,
+/// the other boundaries are sliced, and the texts, nodes and boxes are skipped.
+/// The libraries opened by open() are kept mapped for the following calls, until closeAll(). A library is remapped if its file has changed since it was mapped.
+/// The reading is const, so that the cells of one library may be read concurrently into different layouts
+class GdsMappedLibrary
+{
+    public:
+        /// @brief map and index a file
+        /// @param the file name. A gzip compressed file can not be mapped and gives an invalid library
+        explicit GdsMappedLibrary(const std::string &fileName);
+        /// @brief get a library shared by the calls, mapping the file on the first open
+        /// @param the file name
+        /// @return the library. nullptr if the file can not be mapped or indexed
+        static std::shared_ptr<const GdsMappedLibrary> open(const std::string &fileName);
+        /// @brief unmap the shared libraries. The libraries still held by the callers stay mapped until released
+        static void closeAll();
+        /// @brief get the number of shared libraries
+        static IndexType numOpen();
+        /// @brief whether the file is mapped and indexed
+        bool valid() const { return _valid; }
+        /// @brief get the file name
+        const std::string & fileName() const { return _fileName; }
+        /// @brief get the number of cells
+        IndexType numCells() const { return _cellNames.size(); }
+        /// @brief get the name of a cell
+        /// @param the index of the cell, in the order of the file
+        const std::string & cellName(IndexType cellIdx) const { return _cellNames.at(cellIdx); }
+        /// @brief find a cell
+        /// @param the name of the cell
+        /// @return the index of the cell. INDEX_TYPE_MAX if not in the library
+        IndexType cellIdx(const std::string &cellName) const
+        {
+            auto it = _cellIdx.find(cellName);
+            return it == _cellIdx.end() ? INDEX_TYPE_MAX : it->second;
+        }
+        /// @brief get the top cell, the last cell of the file as GdsStreamReader. Empty if the library has no cell
+        const std::string & topCellName() const;
+        /// @brief insert the shapes of a cell and of the cells it references into a layout
+        /// @param first: the name of the cell
+        /// @param second: the layout
+        /// @param third: the technology database, for mapping the GDSII layers. The shapes on layers not in the technology are skipped
+        /// @return whether the cell is found and decoded
+        bool readCell(const std::string &cellName, Layout &layout, const TechDB &techDB) const;
+    private:
+        /// @brief a SREF, or an AREF of cols x rows instances
+        struct Reference
+        {
+            std::string cellName;
+            XY<LocType> origin;
+            IntType angle = 0;
+            bool reflect = false;
+            IndexType cols = 1;
+            IndexType rows = 1;
+            XY<LocType> colStep; ///< The offset between two columns of an AREF
+            XY<LocType> rowStep; ///< The offset between two rows of an AREF
+        };
+        /// @brief the decoded contents of a cell, in its own coordinates
+        struct CellDef
+        {
+            std::vector<IndexType> layers; ///< The db layer of each rectangle
+            std::vector<Box<LocType>> rects;
+            std::vector<IndexType> datatypes;
+            std::vector<IndexType> polyLayers; ///< The db layer of each polygon
+            std::vector<IndexType> polyDatatypes;
+            std::vector<IndexType> polyStart = std::vector<IndexType>(1, 0); ///< The vertices of polygon i are [polyStart[i], polyStart[i + 1])
+            std::vector<XY<LocType>> polyPts;
+            std::vector<Reference> refs;
+        };
+        /// @brief index the structures
+        /// @return whether the records are well formed up to ENDLIB or the end of the file
+        bool index();
+        /// @brief decode the structure of a cell
+        /// @param first: the index of the cell
+        /// @param second: the technology database
+        /// @param third: output the contents
+        /// @return whether the records are well formed
+        bool decode(IndexType cellIdx, const TechDB &techDB, CellDef &cell) const;
+        /// @brief insert the instances of a reference, decoding the referenced cells on the way
+        /// @param first: the reference
+        /// @param second: the transformation from the cell containing the reference to the cell read
+        /// @param third: the depth of the reference, for detecting cyclic references
+        /// @param fourth: the decoded cells, by index. nullptr for the cells not decoded yet
+        /// @param fifth: the technology database
+        /// @param sixth: the layout
+        /// @return whether the referenced cells are decoded
+        bool instantiate(const Reference &ref, const GdsTransform &parent, IndexType depth, std::vector<std::unique_ptr<CellDef>> &cells, const TechDB &techDB, Layout &layout) const;
+        /// @brief insert the contents of a cell under a transformation
+        void insert(const CellDef &cell, const GdsTransform &trans, Layout &layout) const;
+    private:
+        std::string _fileName; ///< The file name
+        MappedFile _file; ///< The mapping
+        bool _valid = false; ///< Whether the file is mapped and indexed
+        std::vector<std::string> _cellNames; ///< The cell names in the order of the file
+        std::vector<std::size_t> _cellBegin; ///< The offset of the first record after STRNAME of each cell
+        std::vector<std::size_t> _cellEnd; ///< The offset of ENDSTR of each cell
+        std::unordered_map<std::string, IndexType> _cellIdx; ///< The cells by name
+        std::int64_t _mtime = 0; ///< The modification time of the file when mapped, in nanoseconds
+        std::size_t _fileSize = 0; ///< The size of the file when mapped
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_GDS_MAPPED_LIBRARY_H_
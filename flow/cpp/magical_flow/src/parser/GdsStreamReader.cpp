@@ -0,0 +1,508 @@
+/**
+ * @file GdsStreamReader.cpp
+ * @brief Streaming GDSII reader that flattens the top cell directly into a Layout
+ * @date 10/14/2026
+ */
+
+#include "GdsStreamReader.h"
+#include <cmath>
+#include <queue>
+#include "util/GzipStream.h"
+#include "util/Tracer.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the maximum depth of the cell references. Deeper references are treated as cyclic
+    constexpr IndexType MAX_REFERENCE_DEPTH = 64;
+}
+
+IndexType MfGds::pathToRects(const std::vector<XY<LocType>> &pts, LocType width, IntType pathType, std::vector<Box<LocType>> &rects)
+{
+    LocType half = width / 2;
+    LocType endExt = (pathType == 2) ? half : 0;
+    IndexType numSkipped = 0;
+    for (IndexType idx = 0; idx + 1 < pts.size(); ++idx)
+    {
+        const XY<LocType> &from = pts[idx];
+        const XY<LocType> &to = pts[idx + 1];
+        LocType extFrom = (idx == 0) ? endExt : half;
+        LocType extTo = (idx + 2 == pts.size()) ? endExt : half;
+        if (from.y() == to.y())
+        {
+            LocType xLo = from.x() < to.x() ? from.x() - extFrom : to.x() - extTo;
+            LocType xHi = from.x() < to.x() ? to.x() + extTo : from.x() + extFrom;
+            rects.emplace_back(xLo, from.y() - half, xHi, from.y() + half);
+        }
+        else if (from.x() == to.x())
+        {
+            LocType yLo = from.y() < to.y() ? from.y() - extFrom : to.y() - extTo;
+            LocType yHi = from.y() < to.y() ? to.y() + extTo : from.y() + extFrom;
+            rects.emplace_back(from.x() - half, yLo, from.x() + half, yHi);
+        }
+        else
+        {
+            ++numSkipped;
+        }
+    }
+    return numSkipped;
+}
+
+GdsTransform::GdsTransform(LocType dx, LocType dy, IntType angle, bool reflect) : _dx(dx), _dy(dy)
+{
+    // M = R(angle) * diag(1, reflect ? -1 : 1)
+    IntType c = 1, s = 0;
+    switch (((angle % 360) + 360) % 360)
+    {
+        case 90: c = 0; s = 1; break;
+        case 180: c = -1; s = 0; break;
+        case 270: c = 0; s = -1; break;
+        default: break;
+    }
+    IntType f = reflect ? -1 : 1;
+    _xx = c;
+    _xy = -s * f;
+    _yx = s;
+    _yy = c * f;
+}
+
+GdsTransform GdsTransform::compose(const GdsTransform &other) const
+{
+    GdsTransform result;
+    result._xx = _xx * other._xx + _xy * other._yx;
+    result._xy = _xx * other._xy + _xy * other._yy;
+    result._yx = _yx * other._xx + _yy * other._yx;
+    result._yy = _yx * other._xy + _yy * other._yy;
+    XY<LocType> d = apply(other._dx, other._dy);
+    result._dx = d.x();
+    result._dy = d.y();
+    return result;
+}
+
+bool GdsStreamReader::read(const std::string &fileName)
+{
+    ScopedTimer timer("readGds", "gds");
+    ScopedMemoryPeak memory("readGds");
+    _topCellName = "";
+    _scanCells.clear();
+    _scanRefs.clear();
+    _cellIdx.clear();
+    _cells.clear();
+    _topRefs.clear();
+    _polygons.clear();
+    _polyLayers.clear();
+    _polyDatatypes.clear();
+    // The limbo parser takes a file name. A .gz file is read from a decompressed copy
+    PlainFile plain(fileName);
+    if (!plain.valid())
+    {
+        ERR("GdsStreamReader: failed to read %s \n", fileName.c_str());
+        return false;
+    }
+    // First pass: the hierarchy
+    _pass = Pass::SCAN;
+    if (!GdsParser::read(*this, plain.path()))
+    {
+        ERR("GdsStreamReader: failed to read %s \n", fileName.c_str());
+        return false;
+    }
+    this->resolveHierarchy();
+    if (_topCellName == "")
+    {
+        ERR("GdsStreamReader: no top cell in %s \n", fileName.c_str());
+        return false;
+    }
+    // Second pass: the shapes
+    _pass = Pass::READ;
+    _curCell = INDEX_TYPE_MAX;
+    _inTop = false;
+    _elemType = ElementType::NONE;
+    if (!GdsParser::read(*this, plain.path()))
+    {
+        ERR("GdsStreamReader: failed to read %s \n", fileName.c_str());
+        return false;
+    }
+    for (const auto &ref : _topRefs)
+    {
+        this->instantiate(ref, GdsTransform(), 0);
+    }
+    _cellIdx.clear();
+    _cells.clear();
+    _topRefs.clear();
+    return true;
+}
+
+void GdsStreamReader::resolveHierarchy()
+{
+    // The last cell of the file, as the GdsDB based Parser
+    _topCellName = _scanCells.empty() ? "" : _scanCells.back();
+    if (_topCellName == "")
+    {
+        return;
+    }
+    // Only the cells instantiated by the top cell are kept in the second pass
+    std::unordered_map<std::string, IndexType> scanIdx;
+    for (IndexType idx = 0; idx < _scanCells.size(); ++idx)
+    {
+        scanIdx.emplace(_scanCells[idx], idx);
+    }
+    std::queue<IndexType> queue;
+    queue.push(scanIdx.at(_topCellName));
+    while (!queue.empty())
+    {
+        IndexType idx = queue.front();
+        queue.pop();
+        for (const auto &name : _scanRefs[idx])
+        {
+            auto it = scanIdx.find(name);
+            if (it == scanIdx.end() || name == _topCellName || _cellIdx.find(name) != _cellIdx.end())
+            {
+                continue;
+            }
+            _cellIdx.emplace(name, _cells.size());
+            _cells.emplace_back();
+            queue.push(it->second);
+        }
+    }
+    _scanCells.clear();
+    _scanRefs.clear();
+}
+
+void GdsStreamReader::bit_array_cbk(GdsParser::GdsRecords::EnumType recordType, GdsParser::GdsData::EnumType, const std::vector<int> &data)
+{
+    if (recordType == GdsParser::GdsRecords::STRANS && !data.empty())
+    {
+        // Bit 0 (the most significant one) is the reflection about the x axis. The bits may come unpacked or as one 16-bit word
+        _elemRef.reflect = data.size() > 1 ? data[0] != 0 : (data[0] & 0x8000) != 0;
+    }
+}
+
+void GdsStreamReader::integer_2_cbk(GdsParser::GdsRecords::EnumType recordType, GdsParser::GdsData::EnumType, const std::vector<int> &data)
+{
+    if (_pass == Pass::SCAN || data.empty())
+    {
+        return;
+    }
+    switch (recordType)
+    {
+        case GdsParser::GdsRecords::LAYER: _elemLayer = data[0]; break;
+        case GdsParser::GdsRecords::DATATYPE: _elemDatatype = data[0]; break;
+        case GdsParser::GdsRecords::PATHTYPE: _elemPathType = data[0]; break;
+        case GdsParser::GdsRecords::COLROW:
+        {
+            if (data.size() >= 2)
+            {
+                _elemRef.cols = static_cast<IndexType>(std::max(data[0], 1));
+                _elemRef.rows = static_cast<IndexType>(std::max(data[1], 1));
+            }
+            break;
+        }
+        default: break;
+    }
+}
+
+void GdsStreamReader::integer_4_cbk(GdsParser::GdsRecords::EnumType recordType, GdsParser::GdsData::EnumType, const std::vector<int> &data)
+{
+    if (_pass == Pass::SCAN || data.empty())
+    {
+        return;
+    }
+    if (recordType == GdsParser::GdsRecords::WIDTH)
+    {
+        _elemWidth = std::abs(data[0]);
+    }
+    else if (recordType == GdsParser::GdsRecords::XY)
+    {
+        _elemPts.clear();
+        for (IndexType idx = 0; idx + 1 < data.size(); idx += 2)
+        {
+            _elemPts.emplace_back(data[idx], data[idx + 1]);
+        }
+    }
+}
+
+void GdsStreamReader::real_4_cbk(GdsParser::GdsRecords::EnumType, GdsParser::GdsData::EnumType, const std::vector<double> &)
+{
+}
+
+void GdsStreamReader::real_8_cbk(GdsParser::GdsRecords::EnumType recordType, GdsParser::GdsData::EnumType, const std::vector<double> &data)
+{
+    if (_pass == Pass::SCAN || data.empty())
+    {
+        return;
+    }
+    if (recordType == GdsParser::GdsRecords::ANGLE)
+    {
+        _elemRef.angle = static_cast<IntType>(std::lround(data[0]));
+        if (_elemRef.angle % 90 != 0)
+        {
+            // Marked for skipping in endElement
+            _elemRef.angle = INT_TYPE_MAX;
+        }
+    }
+    else if (recordType == GdsParser::GdsRecords::MAG && (_elemType == ElementType::SREF || _elemType == ElementType::AREF) && std::fabs(data[0] - 1.0) > 1e-9)
+    {
+        // The magnification of a TEXT only scales its label
+        WRN("GdsStreamReader: magnification %f of %s is ignored \n", data[0], _elemRef.cellName.c_str());
+    }
+}
+
+void GdsStreamReader::string_cbk(GdsParser::GdsRecords::EnumType recordType, GdsParser::GdsData::EnumType, const std::string &data)
+{
+    if (recordType == GdsParser::GdsRecords::STRNAME)
+    {
+        if (_pass == Pass::SCAN)
+        {
+            _scanCells.emplace_back(data);
+            _scanRefs.emplace_back();
+            return;
+        }
+        _inTop = (data == _topCellName);
+        _curCell = INDEX_TYPE_MAX;
+        auto it = _cellIdx.find(data);
+        if (!_inTop && it != _cellIdx.end())
+        {
+            _curCell = it->second;
+            _cells[_curCell].defined = true;
+        }
+    }
+    else if (recordType == GdsParser::GdsRecords::SNAME)
+    {
+        if (_pass == Pass::SCAN)
+        {
+            if (!_scanRefs.empty())
+            {
+                _scanRefs.back().emplace_back(data);
+            }
+            return;
+        }
+        _elemRef.cellName = data;
+    }
+}
+
+void GdsStreamReader::begin_end_cbk(GdsParser::GdsRecords::EnumType recordType)
+{
+    switch (recordType)
+    {
+        case GdsParser::GdsRecords::BOUNDARY: _elemType = ElementType::BOUNDARY; break;
+        case GdsParser::GdsRecords::PATH: _elemType = ElementType::PATH; break;
+        case GdsParser::GdsRecords::SREF: _elemType = ElementType::SREF; break;
+        case GdsParser::GdsRecords::AREF: _elemType = ElementType::AREF; break;
+        case GdsParser::GdsRecords::TEXT:
+        case GdsParser::GdsRecords::BOX:
+        case GdsParser::GdsRecords::NODE: _elemType = ElementType::OTHER; break;
+        case GdsParser::GdsRecords::ENDEL:
+        {
+            if (_pass == Pass::READ && (_inTop || _curCell != INDEX_TYPE_MAX))
+            {
+                this->endElement();
+            }
+            _elemType = ElementType::NONE;
+            _elemLayer = _elemDatatype = _elemPathType = 0;
+            _elemWidth = 0;
+            _elemPts.clear();
+            _elemRef = Reference();
+            break;
+        }
+        case GdsParser::GdsRecords::ENDSTR:
+        {
+            if (_pass == Pass::READ && (_inTop || _curCell != INDEX_TYPE_MAX))
+            {
+                this->flushPolygons();
+            }
+            _inTop = false;
+            _curCell = INDEX_TYPE_MAX;
+            break;
+        }
+        default: break;
+    }
+}
+
+void GdsStreamReader::endElement()
+{
+    switch (_elemType)
+    {
+        case ElementType::BOUNDARY:
+        case ElementType::PATH:
+        {
+            IndexType layerIdx = _techDB.pdkLayerToDb(static_cast<IndexType>(_elemLayer));
+            if (layerIdx == INDEX_TYPE_MAX || _elemPts.empty())
+            {
+                // The layer is not in the tech file
+                return;
+            }
+            if (_elemType == ElementType::BOUNDARY)
+            {
+                _simplePts = _elemPts;
+                if (::klib::simplifyRectilinear(_simplePts) && _simplePts.size() > 4)
+                {
+                    // Kept as a polygon, which the layout slices for its rectangles
+                    this->addPolygon(layerIdx, static_cast<IndexType>(_elemDatatype), _simplePts);
+                    break;
+                }
+                // Sliced in one batch at the end of the cell
+                _polygons.addPolygon(_elemPts.begin(), _elemPts.end());
+                _polyLayers.emplace_back(layerIdx);
+                _polyDatatypes.emplace_back(static_cast<IndexType>(_elemDatatype));
+                break;
+            }
+            std::vector<Box<LocType>> rects;
+            this->pathToRects(layerIdx, rects);
+            // Queued behind the boundaries before it, so that the rectangles keep the order of the elements
+            _polygons.addRects(rects.begin(), rects.end());
+            _polyLayers.emplace_back(layerIdx);
+            _polyDatatypes.emplace_back(static_cast<IndexType>(_elemDatatype));
+            break;
+        }
+        case ElementType::SREF:
+        case ElementType::AREF:
+        {
+            if (_elemPts.empty())
+            {
+                return;
+            }
+            if (_elemRef.angle == INT_TYPE_MAX)
+            {
+                WRN("GdsStreamReader: non-Manhattan reference to %s is skipped \n", _elemRef.cellName.c_str());
+                return;
+            }
+            _elemRef.origin = _elemPts[0];
+            if (_elemType == ElementType::AREF && _elemPts.size() >= 3)
+            {
+                _elemRef.colStep = XY<LocType>((_elemPts[1].x() - _elemPts[0].x()) / static_cast<LocType>(_elemRef.cols),
+                                               (_elemPts[1].y() - _elemPts[0].y()) / static_cast<LocType>(_elemRef.cols));
+                _elemRef.rowStep = XY<LocType>((_elemPts[2].x() - _elemPts[0].x()) / static_cast<LocType>(_elemRef.rows),
+                                               (_elemPts[2].y() - _elemPts[0].y()) / static_cast<LocType>(_elemRef.rows));
+            }
+            else
+            {
+                _elemRef.cols = _elemRef.rows = 1;
+            }
+            if (_inTop)
+            {
+                _topRefs.emplace_back(std::move(_elemRef));
+            }
+            else
+            {
+                _cells[_curCell].refs.emplace_back(std::move(_elemRef));
+            }
+            break;
+        }
+        default: break;
+    }
+}
+
+void GdsStreamReader::addRect(IndexType layerIdx, IndexType datatype, const Box<LocType> &rect)
+{
+    if (_inTop)
+    {
+        IndexType rectIdx = _layout.insertRect(layerIdx, rect);
+        if (datatype != 0)
+        {
+            _layout.setRectDatatype(layerIdx, rectIdx, datatype);
+        }
+        return;
+    }
+    CellDef &cell = _cells[_curCell];
+    cell.layers.emplace_back(layerIdx);
+    cell.rects.emplace_back(rect);
+    cell.datatypes.emplace_back(datatype);
+}
+
+void GdsStreamReader::addPolygon(IndexType layerIdx, IndexType datatype, const std::vector<XY<LocType>> &pts)
+{
+    Tracer::count("polygons kept");
+    if (_inTop)
+    {
+        _layout.insertPolygon(layerIdx, pts.begin(), pts.end(), datatype);
+        return;
+    }
+    CellDef &cell = _cells[_curCell];
+    cell.polyLayers.emplace_back(layerIdx);
+    cell.polyDatatypes.emplace_back(datatype);
+    cell.polyPts.insert(cell.polyPts.end(), pts.begin(), pts.end());
+    cell.polyStart.emplace_back(cell.polyPts.size());
+}
+
+void GdsStreamReader::flushPolygons()
+{
+    Tracer::count("polygons sliced", _polygons.numPolygons());
+    bool success = _polygons.run();
+    IndexType numFailed = 0;
+    for (IndexType polyIdx = 0; polyIdx < _polygons.numPolygons(); ++polyIdx)
+    {
+        if (!_polygons.success(polyIdx))
+        {
+            ++numFailed;
+        }
+        for (const auto &rect : _polygons.rects(polyIdx))
+        {
+            this->addRect(_polyLayers[polyIdx], _polyDatatypes[polyIdx], rect);
+        }
+    }
+    if (!success)
+    {
+        WRN("GdsStreamReader: %u boundaries could not be sliced into rectangles, their rectangles may be incomplete \n", numFailed);
+    }
+    _polygons.clear();
+    _polyLayers.clear();
+    _polyDatatypes.clear();
+}
+
+void GdsStreamReader::pathToRects(IndexType layerIdx, std::vector<Box<LocType>> &rects) const
+{
+    if (MfGds::pathToRects(_elemPts, _elemWidth, _elemPathType, rects) > 0)
+    {
+        WRN("GdsStreamReader: non-Manhattan path segment on layer %u is skipped \n", layerIdx);
+    }
+}
+
+void GdsStreamReader::instantiate(const Reference &ref, const GdsTransform &parent, IndexType depth)
+{
+    if (depth >= MAX_REFERENCE_DEPTH)
+    {
+        ERR("GdsStreamReader: the references to %s are too deep or cyclic \n", ref.cellName.c_str());
+        return;
+    }
+    auto it = _cellIdx.find(ref.cellName);
+    if (it == _cellIdx.end() || !_cells[it->second].defined)
+    {
+        WRN("GdsStreamReader: referenced cell %s is not defined \n", ref.cellName.c_str());
+        return;
+    }
+    const CellDef &cell = _cells[it->second];
+    std::vector<XY<LocType>> pts;
+    for (IndexType col = 0; col < ref.cols; ++col)
+    {
+        for (IndexType row = 0; row < ref.rows; ++row)
+        {
+            LocType dx = ref.origin.x() + static_cast<LocType>(col) * ref.colStep.x() + static_cast<LocType>(row) * ref.rowStep.x();
+            LocType dy = ref.origin.y() + static_cast<LocType>(col) * ref.colStep.y() + static_cast<LocType>(row) * ref.rowStep.y();
+            GdsTransform trans = parent.compose(GdsTransform(dx, dy, ref.angle, ref.reflect));
+            for (IndexType idx = 0; idx < cell.rects.size(); ++idx)
+            {
+                IndexType rectIdx = _layout.insertRect(cell.layers[idx], trans.apply(cell.rects[idx]));
+                if (cell.datatypes[idx] != 0)
+                {
+                    _layout.setRectDatatype(cell.layers[idx], rectIdx, cell.datatypes[idx]);
+                }
+            }
+            for (IndexType polyIdx = 0; polyIdx < cell.polyLayers.size(); ++polyIdx)
+            {
+                pts.clear();
+                for (IndexType ptIdx = cell.polyStart[polyIdx]; ptIdx < cell.polyStart[polyIdx + 1]; ++ptIdx)
+                {
+                    pts.emplace_back(trans.apply(cell.polyPts[ptIdx].x(), cell.polyPts[ptIdx].y()));
+                }
+                _layout.insertPolygon(cell.polyLayers[polyIdx], pts.begin(), pts.end(), cell.polyDatatypes[polyIdx]);
+            }
+            for (const auto &child : cell.refs)
+            {
+                this->instantiate(child, trans, depth + 1);
+            }
+        }
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,172 @@
+/**
+ * @file GdsStreamReader.h
+ * @brief Streaming GDSII reader that flattens the top cell directly into a Layout
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_GDS_STREAM_READER_H_
+#define MAGICAL_FLOW_GDS_STREAM_READER_H_
+
+#include <limbo/parsers/gdsii/stream/GdsReader.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "global/global.h"
+#include "db/Layout.h"
+#include "db/TechDB.h"
+#include "util/Polygon2Rect.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::GdsTransform
+/// @brief A Manhattan GDSII transformation: p' = M * p + (dx, dy), where M is a rotation by a multiple of 90 degree, optionally after a reflection about the x axis
+class GdsTransform
+{
+    public:
+        /// @brief the identity
+        explicit GdsTransform() = default;
+        /// @brief the transformation of a cell reference
+        /// @param first: the position of the reference
+        /// @param second: the rotation angle in degree (counterclockwise), a multiple of 90
+        /// @param third: whether to reflect about the x axis before the rotation
+        GdsTransform(LocType dx, LocType dy, IntType angle, bool reflect);
+        /// @brief apply to a point
+        XY<LocType> apply(LocType x, LocType y) const { return XY<LocType>(_xx * x + _xy * y + _dx, _yx * x + _yy * y + _dy); }
+        /// @brief apply to a box
+        Box<LocType> apply(const Box<LocType> &box) const
+        {
+            XY<LocType> lo = apply(box.xLo(), box.yLo());
+            XY<LocType> hi = apply(box.xHi(), box.yHi());
+            return Box<LocType>(std::min(lo.x(), hi.x()), std::min(lo.y(), hi.y()), std::max(lo.x(), hi.x()), std::max(lo.y(), hi.y()));
+        }
+        /// @brief the transformation applying other first and then this
+        GdsTransform compose(const GdsTransform &other) const;
+    private:
+        IntType _xx = 1; ///< The matrix entries, each in {-1, 0, 1}
+        IntType _xy = 0;
+        IntType _yx = 0;
+        IntType _yy = 1;
+        LocType _dx = 0; ///< The translation
+        LocType _dy = 0;
+};
+
+namespace MfGds
+{
+    /// @brief convert a GDSII path into rectangles, one per segment widened by half of the width.
+    /// The segments are extended by half of the width at the inner vertices to fill the corners, and at the ends for the square-ended path type 2. Other end types are treated as flush
+    /// @param first: the vertices of the path
+    /// @param second: the width
+    /// @param third: the path type
+    /// @param fourth: output the rectangles
+    /// @return the number of non-Manhattan segments, which are skipped
+    IndexType pathToRects(const std::vector<XY<LocType>> &pts, LocType width, IntType pathType, std::vector<Box<LocType>> &rects);
+}
+
+/// @class MAGICAL_FLOW::GdsStreamReader
+/// @brief Read a GDSII file into a Layout from the limbo record callbacks, without building a GdsDB.
+/// The file is read twice. The first pass only records the cell names and references, to find the top cell (the last cell of the file, as the GdsDB based Parser).
+/// In the second pass, the shapes of the top cell are inserted into the Layout. The rectilinear boundaries other than boxes are kept as polygons,
+/// and the other boundaries and the paths are converted into rectangles in one batch at the end of the cell, in the order of the elements.
+/// The shapes of the cells instantiated by the top cell are kept until the end of the file and inserted under the composed reference transformations.
+/// The cells not instantiated by the top cell are skipped, as well as texts and nodes
+class GdsStreamReader : public GdsParser::GdsDataBase
+{
+    public:
+        /// @brief constructor
+        /// @param first: the layout to insert the shapes into
+        /// @param second: the technology database, for mapping the GDSII layers. The shapes on layers not in the technology are skipped
+        explicit GdsStreamReader(Layout &layout, const TechDB &techDB) : _layout(layout), _techDB(techDB) {}
+        /// @brief read a file
+        /// @param the file name
+        /// @return whether the reading is successful
+        bool read(const std::string &fileName);
+        /// @brief the name of the top cell of the last read file
+        const std::string & topCellName() const { return _topCellName; }
+
+        /* limbo GDSII record callbacks */
+        void bit_array_cbk(GdsParser::GdsRecords::EnumType recordType, GdsParser::GdsData::EnumType dataType, const std::vector<int> &data) override;
+        void integer_2_cbk(GdsParser::GdsRecords::EnumType recordType, GdsParser::GdsData::EnumType dataType, const std::vector<int> &data) override;
+        void integer_4_cbk(GdsParser::GdsRecords::EnumType recordType, GdsParser::GdsData::EnumType dataType, const std::vector<int> &data) override;
+        void real_4_cbk(GdsParser::GdsRecords::EnumType recordType, GdsParser::GdsData::EnumType dataType, const std::vector<double> &data) override;
+        void real_8_cbk(GdsParser::GdsRecords::EnumType recordType, GdsParser::GdsData::EnumType dataType, const std::vector<double> &data) override;
+        void string_cbk(GdsParser::GdsRecords::EnumType recordType, GdsParser::GdsData::EnumType dataType, const std::string &data) override;
+        void begin_end_cbk(GdsParser::GdsRecords::EnumType recordType) override;
+
+    private:
+        /// @brief a SREF, or an AREF of cols x rows instances
+        struct Reference
+        {
+            std::string cellName;
+            XY<LocType> origin;
+            IntType angle = 0;
+            bool reflect = false;
+            IndexType cols = 1;
+            IndexType rows = 1;
+            XY<LocType> colStep; ///< The offset between two columns of an AREF
+            XY<LocType> rowStep; ///< The offset between two rows of an AREF
+        };
+        /// @brief the shapes of a cell kept for instantiation
+        struct CellDef
+        {
+            bool defined = false;
+            std::vector<IndexType> layers; ///< The db layer of each rectangle
+            std::vector<Box<LocType>> rects;
+            std::vector<IndexType> datatypes;
+            std::vector<IndexType> polyLayers; ///< The db layer of each polygon
+            std::vector<IndexType> polyDatatypes;
+            std::vector<IndexType> polyStart = std::vector<IndexType>(1, 0); ///< The vertices of polygon i are [polyStart[i], polyStart[i + 1])
+            std::vector<XY<LocType>> polyPts;
+            std::vector<Reference> refs;
+        };
+        enum class Pass { SCAN, READ };
+        enum class ElementType { NONE, BOUNDARY, PATH, SREF, AREF, OTHER };
+
+        /// @brief process the element ending at ENDEL
+        void endElement();
+        /// @brief add a rectangle to the current cell
+        void addRect(IndexType layerIdx, IndexType datatype, const Box<LocType> &rect);
+        /// @brief add a rectilinear polygon to the current cell
+        void addPolygon(IndexType layerIdx, IndexType datatype, const std::vector<XY<LocType>> &pts);
+        /// @brief convert the boundaries of the current cell into rectangles and add them to the cell with the rectangles of the paths, in the order of the elements
+        void flushPolygons();
+        /// @brief convert the current path element into rectangles
+        void pathToRects(IndexType layerIdx, std::vector<Box<LocType>> &rects) const;
+        /// @brief find the top cell and the cells it instantiates from the first pass
+        void resolveHierarchy();
+        /// @brief insert the instances of a reference
+        /// @param first: the reference
+        /// @param second: the transformation from the cell containing the reference to the top cell
+        /// @param third: the depth of the reference, for detecting cyclic references
+        void instantiate(const Reference &ref, const GdsTransform &parent, IndexType depth);
+
+    private:
+        Layout &_layout; ///< The output layout
+        const TechDB &_techDB; ///< The technology database
+        Pass _pass = Pass::SCAN; ///< The current pass
+        std::string _topCellName; ///< The top cell
+        /* First pass */
+        std::vector<std::string> _scanCells; ///< The cell names in the order of the file
+        std::vector<std::vector<std::string>> _scanRefs; ///< The names referenced by each cell
+        /* Second pass */
+        std::unordered_map<std::string, IndexType> _cellIdx; ///< The cells instantiated by the top cell
+        std::vector<CellDef> _cells;
+        std::vector<Reference> _topRefs; ///< The references in the top cell
+        ::klib::Polygon2RectBatch<LocType> _polygons; ///< The boundaries and the path rectangles of the current cell
+        std::vector<IndexType> _polyLayers; ///< The db layer of each element in the batch
+        std::vector<IndexType> _polyDatatypes; ///< The datatype of each element in the batch
+        IndexType _curCell = INDEX_TYPE_MAX; ///< The cell being read: INDEX_TYPE_MAX for a skipped cell
+        bool _inTop = false; ///< Whether the cell being read is the top cell
+        /* The element being decoded */
+        ElementType _elemType = ElementType::NONE;
+        IntType _elemLayer = 0;
+        IntType _elemDatatype = 0;
+        IntType _elemPathType = 0;
+        LocType _elemWidth = 0;
+        std::vector<XY<LocType>> _elemPts;
+        std::vector<XY<LocType>> _simplePts; ///< The simplified vertices of the current boundary
+        Reference _elemRef;
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_GDS_STREAM_READER_H_
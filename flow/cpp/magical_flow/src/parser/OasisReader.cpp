@@ -0,0 +1,912 @@
+/**
+ * @file OasisReader.cpp
+ * @brief OASIS reader that flattens the top cell into a Layout
+ * @date 10/14/2026
+ */
+
+#include "OasisReader.h"
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <zlib.h>
+#include "util/GzipStream.h"
+#include "util/Tracer.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the deepest placement nesting before the references are taken as cyclic
+    constexpr IndexType MAX_REFERENCE_DEPTH = 64;
+    /// @brief the most copies of a repetition, against corrupted counts
+    constexpr std::uint64_t MAX_REPETITION = 1 << 26;
+    /// @brief the 8 directions of the 3-deltas and the g-deltas of form 1: E, N, W, S, NE, NW, SW, SE
+    constexpr IntType DIR_X[8] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+    constexpr IntType DIR_Y[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+}
+
+/*------------------------------*/
+/* Primitives                   */
+/*------------------------------*/
+
+std::uint8_t OasisReader::Cursor::byte()
+{
+    if (pos >= end)
+    {
+        failed = true;
+        return 0;
+    }
+    return *pos++;
+}
+
+std::uint64_t OasisReader::Cursor::readUnsigned()
+{
+    std::uint64_t value = 0;
+    for (IndexType shift = 0; shift < 64; shift += 7)
+    {
+        std::uint8_t b = this->byte();
+        value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    failed = true;
+    return 0;
+}
+
+std::int64_t OasisReader::Cursor::readSigned()
+{
+    std::uint64_t value = this->readUnsigned();
+    std::int64_t magnitude = static_cast<std::int64_t>(value >> 1);
+    return (value & 1) ? -magnitude : magnitude;
+}
+
+RealType OasisReader::Cursor::readReal()
+{
+    return this->readReal(this->readUnsigned());
+}
+
+RealType OasisReader::Cursor::readReal(std::uint64_t realType)
+{
+    switch (realType)
+    {
+        case 0: return static_cast<RealType>(this->readUnsigned());
+        case 1: return -static_cast<RealType>(this->readUnsigned());
+        case 2: { RealType den = static_cast<RealType>(this->readUnsigned()); return den != 0 ? 1 / den : 0; }
+        case 3: { RealType den = static_cast<RealType>(this->readUnsigned()); return den != 0 ? -1 / den : 0; }
+        case 4:
+        case 5:
+        {
+            bool negative = realType == 5;
+            RealType num = static_cast<RealType>(this->readUnsigned());
+            RealType den = static_cast<RealType>(this->readUnsigned());
+            RealType value = den != 0 ? num / den : 0;
+            return negative ? -value : value;
+        }
+        case 6:
+        {
+            std::uint32_t bits = 0;
+            for (IndexType shift = 0; shift < 32; shift += 8)
+            {
+                bits |= static_cast<std::uint32_t>(this->byte()) << shift;
+            }
+            float value = 0;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+        case 7:
+        {
+            std::uint64_t bits = 0;
+            for (IndexType shift = 0; shift < 64; shift += 8)
+            {
+                bits |= static_cast<std::uint64_t>(this->byte()) << shift;
+            }
+            double value = 0;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+        default: failed = true; return 0;
+    }
+}
+
+std::string OasisReader::Cursor::readString()
+{
+    std::uint64_t len = this->readUnsigned();
+    if (len > static_cast<std::uint64_t>(end - pos))
+    {
+        failed = true;
+        pos = end;
+        return "";
+    }
+    std::string str(reinterpret_cast<const char *>(pos), len);
+    pos += len;
+    return str;
+}
+
+void OasisReader::Cursor::skip(std::uint64_t numBytes)
+{
+    if (numBytes > static_cast<std::uint64_t>(end - pos))
+    {
+        failed = true;
+        pos = end;
+        return;
+    }
+    pos += numBytes;
+}
+
+/*------------------------------*/
+/* Reading                      */
+/*------------------------------*/
+
+bool OasisReader::read(const std::string &fileName)
+{
+    ScopedTimer timer("readOasis", "oasis");
+    ScopedMemoryPeak memory("readOasis");
+    _topCellName = "";
+    _cellNames.clear();
+    _textStrings.clear();
+    _nextCellName = _nextTextString = 0;
+    _cells.clear();
+    _cellByName.clear();
+    _modal = Modal();
+    _ended = false;
+    // A gzip compressed file is inflated on the way, a plain one read as it is
+    GzipIFStream is(fileName);
+    if (!is.isOpen())
+    {
+        ERR("OasisReader: cannot open %s \n", fileName.c_str());
+        return false;
+    }
+    std::vector<char> bytes((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+    if (!is.valid() || bytes.size() < OASIS::MAGIC_SIZE || std::memcmp(bytes.data(), OASIS::MAGIC, OASIS::MAGIC_SIZE) != 0)
+    {
+        ERR("OasisReader: %s is not an OASIS file \n", fileName.c_str());
+        return false;
+    }
+    Tracer::count("OASIS bytes read", static_cast<std::int64_t>(bytes.size()));
+    Cursor cursor;
+    cursor.pos = reinterpret_cast<const std::uint8_t *>(bytes.data()) + OASIS::MAGIC_SIZE;
+    cursor.end = reinterpret_cast<const std::uint8_t *>(bytes.data()) + bytes.size();
+    if (!this->readRecords(cursor, false) || !_ended)
+    {
+        ERR("OasisReader: failed to read %s \n", fileName.c_str());
+        return false;
+    }
+    if (_cells.empty())
+    {
+        ERR("OasisReader: no cell in %s \n", fileName.c_str());
+        return false;
+    }
+    for (IndexType cellIdx = 0; cellIdx < _cells.size(); ++cellIdx)
+    {
+        _cellByName[this->cellName(_cells[cellIdx].refnum, _cells[cellIdx].name)] = cellIdx;
+    }
+    // The last cell of the file, as GdsStreamReader
+    _topCellName = this->cellName(_cells.back().refnum, _cells.back().name);
+    this->insertCell(_cells.back(), GdsTransform(), 0);
+    _cells.clear();
+    _cellByName.clear();
+    return true;
+}
+
+const std::string & OasisReader::cellName(IndexType refnum, const std::string &name) const
+{
+    static const std::string UNDEFINED = "";
+    if (refnum == INDEX_TYPE_MAX)
+    {
+        return name;
+    }
+    return refnum < _cellNames.size() ? _cellNames[refnum] : UNDEFINED;
+}
+
+bool OasisReader::readRecords(Cursor &cursor, bool inCBlock)
+{
+    while (!cursor.atEnd() && !cursor.failed)
+    {
+        std::uint8_t recordType = cursor.byte();
+        bool isElement = recordType == OASIS::REC_PLACEMENT || recordType == OASIS::REC_PLACEMENT_MAG || recordType == OASIS::REC_TEXT
+            || recordType == OASIS::REC_RECTANGLE || recordType == OASIS::REC_POLYGON;
+        if (isElement && _cells.empty())
+        {
+            ERR("OasisReader: element record %d outside of a cell \n", recordType);
+            return false;
+        }
+        switch (recordType)
+        {
+            case OASIS::REC_PAD: break;
+            case OASIS::REC_START:
+            {
+                if (inCBlock)
+                {
+                    ERR("OasisReader: START in a CBLOCK \n");
+                    return false;
+                }
+                cursor.readString();
+                RealType unit = cursor.readReal();
+                if (std::fabs(unit - static_cast<RealType>(_techDB.units().dbu())) > 1e-6 * unit)
+                {
+                    WRN("OasisReader: the unit %f per micron differs from the technology. The coordinates are read as database units \n", unit);
+                }
+                if (cursor.readUnsigned() == 0)
+                {
+                    // The table offsets
+                    for (IndexType idx = 0; idx < 12; ++idx)
+                    {
+                        cursor.readUnsigned();
+                    }
+                }
+                break;
+            }
+            case OASIS::REC_END:
+            {
+                // The table offsets, the padding and the validation are not checked
+                _ended = true;
+                return !cursor.failed;
+            }
+            case OASIS::REC_CELLNAME:
+            case OASIS::REC_CELLNAME_REF:
+            {
+                std::string name = cursor.readString();
+                IndexType refnum = recordType == OASIS::REC_CELLNAME ? _nextCellName++ : static_cast<IndexType>(cursor.readUnsigned());
+                if (refnum >= _cellNames.size())
+                {
+                    _cellNames.resize(refnum + 1);
+                }
+                _cellNames[refnum] = std::move(name);
+                break;
+            }
+            case OASIS::REC_TEXTSTRING:
+            case OASIS::REC_TEXTSTRING_REF:
+            {
+                std::string str = cursor.readString();
+                IndexType refnum = recordType == OASIS::REC_TEXTSTRING ? _nextTextString++ : static_cast<IndexType>(cursor.readUnsigned());
+                if (refnum >= _textStrings.size())
+                {
+                    _textStrings.resize(refnum + 1);
+                }
+                _textStrings[refnum] = std::move(str);
+                break;
+            }
+            case OASIS::REC_PROPNAME:
+            case OASIS::REC_PROPSTRING:
+            {
+                cursor.readString();
+                break;
+            }
+            case OASIS::REC_PROPNAME_REF:
+            case OASIS::REC_PROPSTRING_REF:
+            {
+                cursor.readString();
+                cursor.readUnsigned();
+                break;
+            }
+            case OASIS::REC_LAYERNAME:
+            case OASIS::REC_LAYERNAME_TEXT:
+            {
+                cursor.readString();
+                // The layer and the datatype intervals: type 0 is unbounded, 1 to 3 have one bound and 4 two
+                for (IndexType idx = 0; idx < 2; ++idx)
+                {
+                    std::uint64_t intervalType = cursor.readUnsigned();
+                    if (intervalType >= 1)
+                    {
+                        cursor.readUnsigned();
+                    }
+                    if (intervalType == 4)
+                    {
+                        cursor.readUnsigned();
+                    }
+                }
+                break;
+            }
+            case OASIS::REC_CELL_REF:
+            case OASIS::REC_CELL:
+            {
+                _cells.emplace_back();
+                if (recordType == OASIS::REC_CELL_REF)
+                {
+                    _cells.back().refnum = static_cast<IndexType>(cursor.readUnsigned());
+                }
+                else
+                {
+                    _cells.back().name = cursor.readString();
+                }
+                // The modal variables are reset and the xy mode is absolute at the start of each cell
+                _modal = Modal();
+                break;
+            }
+            case OASIS::REC_XYABSOLUTE: _modal.relative = false; break;
+            case OASIS::REC_XYRELATIVE: _modal.relative = true; break;
+            case OASIS::REC_PLACEMENT:
+            case OASIS::REC_PLACEMENT_MAG:
+            {
+                std::uint8_t info = cursor.byte();
+                if (info & OASIS::PLACE_C)
+                {
+                    if (info & OASIS::PLACE_N)
+                    {
+                        _modal.placeCell = static_cast<IndexType>(cursor.readUnsigned());
+                        _modal.placeName = "";
+                    }
+                    else
+                    {
+                        _modal.placeCell = INDEX_TYPE_MAX;
+                        _modal.placeName = cursor.readString();
+                    }
+                }
+                Placement placement;
+                placement.refnum = _modal.placeCell;
+                placement.name = _modal.placeName;
+                placement.reflect = (info & OASIS::PLACE_F) != 0;
+                bool manhattan = true;
+                if (recordType == OASIS::REC_PLACEMENT)
+                {
+                    placement.angle = ((info & OASIS::PLACE_AA) >> 1) * 90;
+                }
+                else
+                {
+                    RealType mag = (info & OASIS::PLACE_M) ? cursor.readReal() : 1.0;
+                    RealType angle = (info & OASIS::PLACE_A) ? cursor.readReal() : 0.0;
+                    if (std::fabs(mag - 1.0) > 1e-9)
+                    {
+                        WRN("OasisReader: magnification %f of a placement is ignored \n", mag);
+                    }
+                    placement.angle = static_cast<IntType>(std::lround(angle));
+                    manhattan = std::fabs(angle - placement.angle) < 1e-9 && placement.angle % 90 == 0;
+                    placement.angle = (placement.angle % 360 + 360) % 360;
+                }
+                std::int64_t x = (info & OASIS::PLACE_X) ? this->readCoord(cursor, _modal.placeX) : _modal.placeX;
+                std::int64_t y = (info & OASIS::PLACE_Y) ? this->readCoord(cursor, _modal.placeY) : _modal.placeY;
+                bool repeated = (info & OASIS::PLACE_R) != 0;
+                if (repeated)
+                {
+                    this->readRepetition(cursor, _modal.repetition);
+                }
+                if (!manhattan)
+                {
+                    WRN("OasisReader: non-Manhattan placement is skipped \n");
+                    break;
+                }
+                if (!repeated)
+                {
+                    placement.positions.emplace_back(static_cast<LocType>(x), static_cast<LocType>(y));
+                }
+                else
+                {
+                    for (const auto &offset : _modal.repetition)
+                    {
+                        placement.positions.emplace_back(static_cast<LocType>(x + offset.x()), static_cast<LocType>(y + offset.y()));
+                    }
+                }
+                _cells.back().placements.emplace_back(std::move(placement));
+                break;
+            }
+            case OASIS::REC_TEXT:
+            {
+                std::uint8_t info = cursor.byte();
+                if (info & OASIS::TEXT_C)
+                {
+                    if (info & OASIS::TEXT_N)
+                    {
+                        _modal.textRef = static_cast<IndexType>(cursor.readUnsigned());
+                        _modal.text = "";
+                    }
+                    else
+                    {
+                        _modal.textRef = INDEX_TYPE_MAX;
+                        _modal.text = cursor.readString();
+                    }
+                }
+                if (info & OASIS::TEXT_L) { _modal.textLayer = cursor.readUnsigned(); }
+                if (info & OASIS::TEXT_T) { _modal.textType = cursor.readUnsigned(); }
+                std::int64_t x = (info & OASIS::TEXT_X) ? this->readCoord(cursor, _modal.textX) : _modal.textX;
+                std::int64_t y = (info & OASIS::TEXT_Y) ? this->readCoord(cursor, _modal.textY) : _modal.textY;
+                bool repeated = (info & OASIS::TEXT_R) != 0;
+                if (repeated)
+                {
+                    this->readRepetition(cursor, _modal.repetition);
+                }
+                IndexType layerIdx = _techDB.pdkLayerToDb(static_cast<IndexType>(_modal.textLayer));
+                if (layerIdx == INDEX_TYPE_MAX)
+                {
+                    break;
+                }
+                auto addText = [&](std::int64_t tx, std::int64_t ty)
+                {
+                    CellDef &cell = _cells.back();
+                    cell.textLayers.emplace_back(layerIdx);
+                    cell.texts.emplace_back(_modal.text, static_cast<LocType>(tx), static_cast<LocType>(ty));
+                    cell.textRefs.emplace_back(_modal.textRef);
+                };
+                if (!repeated)
+                {
+                    addText(x, y);
+                }
+                else
+                {
+                    for (const auto &offset : _modal.repetition)
+                    {
+                        addText(x + offset.x(), y + offset.y());
+                    }
+                }
+                break;
+            }
+            case OASIS::REC_RECTANGLE:
+            case OASIS::REC_POLYGON:
+            {
+                std::uint8_t info = cursor.byte();
+                // The bits of L, D, X, Y and R are the same in both records
+                if (info & OASIS::RECT_L) { _modal.layer = cursor.readUnsigned(); }
+                if (info & OASIS::RECT_D) { _modal.datatype = cursor.readUnsigned(); }
+                std::vector<Box<LocType>> shapes;
+                std::vector<XY<LocType>> polygon; // The rectilinear polygon kept as a polygon, empty if sliced into shapes
+                if (recordType == OASIS::REC_RECTANGLE)
+                {
+                    if (info & OASIS::RECT_W) { _modal.width = static_cast<std::int64_t>(cursor.readUnsigned()); }
+                    if (info & OASIS::RECT_S) { _modal.height = _modal.width; }
+                    else if (info & OASIS::RECT_H) { _modal.height = static_cast<std::int64_t>(cursor.readUnsigned()); }
+                    shapes.emplace_back(0, 0, static_cast<LocType>(_modal.width), static_cast<LocType>(_modal.height));
+                }
+                else
+                {
+                    if (info & OASIS::POLY_P)
+                    {
+                        this->readPointList(cursor, _modal.polygon);
+                    }
+                    polygon = _modal.polygon;
+                    if (!::klib::simplifyRectilinear(polygon) || polygon.size() <= 4)
+                    {
+                        polygon.clear();
+                    }
+                    if (polygon.empty() && !::klib::convertPolygon2Rects(_modal.polygon, shapes))
+                    {
+                        WRN("OasisReader: a polygon on layer %lu cannot be converted into rectangles \n", static_cast<unsigned long>(_modal.layer));
+                    }
+                }
+                std::int64_t x = (info & OASIS::RECT_X) ? this->readCoord(cursor, _modal.geomX) : _modal.geomX;
+                std::int64_t y = (info & OASIS::RECT_Y) ? this->readCoord(cursor, _modal.geomY) : _modal.geomY;
+                bool repeated = (info & OASIS::RECT_R) != 0;
+                if (repeated)
+                {
+                    this->readRepetition(cursor, _modal.repetition);
+                }
+                IndexType layerIdx = _techDB.pdkLayerToDb(static_cast<IndexType>(_modal.layer));
+                if (layerIdx == INDEX_TYPE_MAX)
+                {
+                    // The layer is not in the tech file
+                    break;
+                }
+                CellDef &cell = _cells.back();
+                auto addShapes = [&](std::int64_t dx, std::int64_t dy)
+                {
+                    for (const auto &shape : shapes)
+                    {
+                        cell.layers.emplace_back(layerIdx);
+                        cell.rects.emplace_back(static_cast<LocType>(shape.xLo() + dx), static_cast<LocType>(shape.yLo() + dy),
+                                                static_cast<LocType>(shape.xHi() + dx), static_cast<LocType>(shape.yHi() + dy));
+                        cell.datatypes.emplace_back(static_cast<IndexType>(_modal.datatype));
+                    }
+                    if (!polygon.empty())
+                    {
+                        cell.polyLayers.emplace_back(layerIdx);
+                        cell.polyDatatypes.emplace_back(static_cast<IndexType>(_modal.datatype));
+                        for (const auto &pt : polygon)
+                        {
+                            cell.polyPts.emplace_back(static_cast<LocType>(pt.x() + dx), static_cast<LocType>(pt.y() + dy));
+                        }
+                        cell.polyStart.emplace_back(cell.polyPts.size());
+                    }
+                };
+                if (!repeated)
+                {
+                    addShapes(x, y);
+                }
+                else
+                {
+                    for (const auto &offset : _modal.repetition)
+                    {
+                        addShapes(x + offset.x(), y + offset.y());
+                    }
+                }
+                break;
+            }
+            case OASIS::REC_PROPERTY:
+            {
+                // Info byte UUUUVCNS: the number of values, whether to reuse the last values, whether the name follows and whether it is a reference number
+                std::uint8_t info = cursor.byte();
+                if (info & 0x04)
+                {
+                    if (info & 0x02)
+                    {
+                        cursor.readUnsigned();
+                    }
+                    else
+                    {
+                        cursor.readString();
+                    }
+                }
+                if ((info & 0x08) == 0)
+                {
+                    std::uint64_t numValues = info >> 4;
+                    if (numValues == 15)
+                    {
+                        numValues = cursor.readUnsigned();
+                    }
+                    this->skipPropertyValues(cursor, numValues);
+                }
+                break;
+            }
+            case OASIS::REC_PROPERTY_REPEAT: break;
+            case OASIS::REC_CBLOCK:
+            {
+                if (inCBlock)
+                {
+                    ERR("OasisReader: nested CBLOCK \n");
+                    return false;
+                }
+                std::uint64_t compType = cursor.readUnsigned();
+                std::uint64_t numBytes = cursor.readUnsigned();
+                std::uint64_t numCompressed = cursor.readUnsigned();
+                const std::uint8_t *compressed = cursor.pos;
+                cursor.skip(numCompressed);
+                if (cursor.failed || compType != OASIS::CBLOCK_DEFLATE)
+                {
+                    ERR("OasisReader: unsupported or truncated CBLOCK \n");
+                    return false;
+                }
+                std::vector<std::uint8_t> inflated(numBytes);
+                z_stream zs;
+                zs.zalloc = Z_NULL;
+                zs.zfree = Z_NULL;
+                zs.opaque = Z_NULL;
+                zs.next_in = const_cast<Bytef *>(compressed);
+                zs.avail_in = static_cast<uInt>(numCompressed);
+                if (inflateInit2(&zs, -15) != Z_OK)
+                {
+                    return false;
+                }
+                zs.next_out = inflated.data();
+                zs.avail_out = static_cast<uInt>(inflated.size());
+                int status = inflate(&zs, Z_FINISH);
+                bool complete = status == Z_STREAM_END && zs.total_out == numBytes;
+                inflateEnd(&zs);
+                if (!complete)
+                {
+                    ERR("OasisReader: corrupted CBLOCK \n");
+                    return false;
+                }
+                Cursor block;
+                block.pos = inflated.data();
+                block.end = inflated.data() + inflated.size();
+                if (!this->readRecords(block, true))
+                {
+                    return false;
+                }
+                if (_ended)
+                {
+                    ERR("OasisReader: END in a CBLOCK \n");
+                    return false;
+                }
+                break;
+            }
+            default:
+            {
+                ERR("OasisReader: unsupported record %d \n", recordType);
+                return false;
+            }
+        }
+    }
+    return !cursor.failed;
+}
+
+std::int64_t OasisReader::readCoord(Cursor &cursor, std::int64_t &modal)
+{
+    std::int64_t value = cursor.readSigned();
+    modal = _modal.relative ? modal + value : value;
+    return modal;
+}
+
+XY<LocType> OasisReader::readGDelta(Cursor &cursor)
+{
+    std::uint64_t value = cursor.readUnsigned();
+    if ((value & 1) == 0)
+    {
+        // Form 1: one of the 8 directions and the magnitude
+        IndexType dir = static_cast<IndexType>((value >> 1) & 7);
+        LocType mag = static_cast<LocType>(value >> 4);
+        return XY<LocType>(DIR_X[dir] * mag, DIR_Y[dir] * mag);
+    }
+    // Form 2: the x with its sign in bit 1, then the signed y
+    LocType x = static_cast<LocType>(value >> 2);
+    if (value & 2)
+    {
+        x = -x;
+    }
+    LocType y = static_cast<LocType>(cursor.readSigned());
+    return XY<LocType>(x, y);
+}
+
+void OasisReader::readRepetition(Cursor &cursor, std::vector<XY<LocType>> &offsets)
+{
+    std::uint64_t repType = cursor.readUnsigned();
+    if (repType == OASIS::REP_REUSE)
+    {
+        if (offsets.empty())
+        {
+            ERR("OasisReader: reused repetition is undefined \n");
+            cursor.failed = true;
+        }
+        return;
+    }
+    auto count = [&]()
+    {
+        std::uint64_t num = cursor.readUnsigned() + 2;
+        if (num > MAX_REPETITION)
+        {
+            cursor.failed = true;
+            return static_cast<std::uint64_t>(0);
+        }
+        return num;
+    };
+    offsets.clear();
+    switch (repType)
+    {
+        case 1:
+        {
+            std::uint64_t cols = count();
+            std::uint64_t rows = count();
+            LocType colSpace = static_cast<LocType>(cursor.readUnsigned());
+            LocType rowSpace = static_cast<LocType>(cursor.readUnsigned());
+            if (cols * rows > MAX_REPETITION)
+            {
+                cursor.failed = true;
+                return;
+            }
+            for (std::uint64_t row = 0; row < rows; ++row)
+            {
+                for (std::uint64_t col = 0; col < cols; ++col)
+                {
+                    offsets.emplace_back(static_cast<LocType>(col) * colSpace, static_cast<LocType>(row) * rowSpace);
+                }
+            }
+            break;
+        }
+        case 2:
+        case 3:
+        {
+            std::uint64_t num = count();
+            LocType space = static_cast<LocType>(cursor.readUnsigned());
+            for (std::uint64_t idx = 0; idx < num; ++idx)
+            {
+                LocType dist = static_cast<LocType>(idx) * space;
+                offsets.emplace_back(repType == 2 ? dist : 0, repType == 2 ? 0 : dist);
+            }
+            break;
+        }
+        case 4:
+        case 5:
+        case 6:
+        case 7:
+        {
+            // Individual spaces along x (4, 5) or y (6, 7), multiplied by a grid (5, 7)
+            std::uint64_t num = count();
+            LocType grid = (repType == 5 || repType == 7) ? static_cast<LocType>(cursor.readUnsigned()) : 1;
+            bool alongX = repType <= 5;
+            LocType dist = 0;
+            offsets.emplace_back(0, 0);
+            for (std::uint64_t idx = 1; idx < num && !cursor.failed; ++idx)
+            {
+                dist += static_cast<LocType>(cursor.readUnsigned()) * grid;
+                offsets.emplace_back(alongX ? dist : 0, alongX ? 0 : dist);
+            }
+            break;
+        }
+        case 8:
+        {
+            std::uint64_t numN = count();
+            std::uint64_t numM = count();
+            XY<LocType> dispN = this->readGDelta(cursor);
+            XY<LocType> dispM = this->readGDelta(cursor);
+            if (numN * numM > MAX_REPETITION)
+            {
+                cursor.failed = true;
+                return;
+            }
+            for (std::uint64_t m = 0; m < numM; ++m)
+            {
+                for (std::uint64_t n = 0; n < numN; ++n)
+                {
+                    offsets.emplace_back(static_cast<LocType>(n) * dispN.x() + static_cast<LocType>(m) * dispM.x(),
+                                         static_cast<LocType>(n) * dispN.y() + static_cast<LocType>(m) * dispM.y());
+                }
+            }
+            break;
+        }
+        case 9:
+        {
+            std::uint64_t num = count();
+            XY<LocType> disp = this->readGDelta(cursor);
+            for (std::uint64_t idx = 0; idx < num; ++idx)
+            {
+                offsets.emplace_back(static_cast<LocType>(idx) * disp.x(), static_cast<LocType>(idx) * disp.y());
+            }
+            break;
+        }
+        case 10:
+        case 11:
+        {
+            std::uint64_t num = count();
+            LocType grid = repType == 11 ? static_cast<LocType>(cursor.readUnsigned()) : 1;
+            XY<LocType> pos(0, 0);
+            offsets.emplace_back(pos);
+            for (std::uint64_t idx = 1; idx < num && !cursor.failed; ++idx)
+            {
+                XY<LocType> disp = this->readGDelta(cursor);
+                pos = XY<LocType>(pos.x() + disp.x() * grid, pos.y() + disp.y() * grid);
+                offsets.emplace_back(pos);
+            }
+            break;
+        }
+        default:
+        {
+            ERR("OasisReader: unknown repetition type %lu \n", static_cast<unsigned long>(repType));
+            cursor.failed = true;
+            break;
+        }
+    }
+}
+
+void OasisReader::readPointList(Cursor &cursor, std::vector<XY<LocType>> &pts)
+{
+    std::uint64_t listType = cursor.readUnsigned();
+    std::uint64_t num = cursor.readUnsigned();
+    if (num > static_cast<std::uint64_t>(cursor.end - cursor.pos))
+    {
+        // Every delta takes at least one byte
+        cursor.failed = true;
+        return;
+    }
+    pts.clear();
+    XY<LocType> pos(0, 0);
+    XY<LocType> delta(0, 0);
+    pts.emplace_back(pos);
+    for (std::uint64_t idx = 0; idx < num && !cursor.failed; ++idx)
+    {
+        switch (listType)
+        {
+            case 0:
+            case 1:
+            {
+                // Manhattan, alternating between horizontal and vertical, starting with horizontal for type 0
+                LocType dist = static_cast<LocType>(cursor.readSigned());
+                bool horizontal = (listType == 0) == (idx % 2 == 0);
+                pos = horizontal ? XY<LocType>(pos.x() + dist, pos.y()) : XY<LocType>(pos.x(), pos.y() + dist);
+                break;
+            }
+            case 2:
+            {
+                std::uint64_t value = cursor.readUnsigned();
+                IndexType dir = static_cast<IndexType>(value & 3);
+                LocType mag = static_cast<LocType>(value >> 2);
+                pos = XY<LocType>(pos.x() + DIR_X[dir] * mag, pos.y() + DIR_Y[dir] * mag);
+                break;
+            }
+            case 3:
+            {
+                std::uint64_t value = cursor.readUnsigned();
+                IndexType dir = static_cast<IndexType>(value & 7);
+                LocType mag = static_cast<LocType>(value >> 3);
+                pos = XY<LocType>(pos.x() + DIR_X[dir] * mag, pos.y() + DIR_Y[dir] * mag);
+                break;
+            }
+            case 4:
+            {
+                XY<LocType> disp = this->readGDelta(cursor);
+                pos = XY<LocType>(pos.x() + disp.x(), pos.y() + disp.y());
+                break;
+            }
+            case 5:
+            {
+                // Double deltas: each g-delta changes the displacement of the previous vertex
+                XY<LocType> disp = this->readGDelta(cursor);
+                delta = XY<LocType>(delta.x() + disp.x(), delta.y() + disp.y());
+                pos = XY<LocType>(pos.x() + delta.x(), pos.y() + delta.y());
+                break;
+            }
+            default:
+            {
+                ERR("OasisReader: unknown point list type %lu \n", static_cast<unsigned long>(listType));
+                cursor.failed = true;
+                return;
+            }
+        }
+        pts.emplace_back(pos);
+    }
+    if (listType <= 1)
+    {
+        // One more vertex is implied, keeping the closing edges Manhattan
+        bool horizontal = (listType == 0) == (num % 2 == 0);
+        pts.emplace_back(horizontal ? XY<LocType>(0, pos.y()) : XY<LocType>(pos.x(), 0));
+    }
+}
+
+void OasisReader::skipPropertyValues(Cursor &cursor, std::uint64_t numValues)
+{
+    for (std::uint64_t idx = 0; idx < numValues && !cursor.failed; ++idx)
+    {
+        std::uint64_t valueType = cursor.readUnsigned();
+        if (valueType <= 7)
+        {
+            cursor.readReal(valueType);
+        }
+        else if (valueType <= 9 || valueType >= 13)
+        {
+            cursor.readUnsigned();
+        }
+        else
+        {
+            cursor.readString();
+        }
+    }
+}
+
+/*------------------------------*/
+/* Flattening                   */
+/*------------------------------*/
+
+void OasisReader::insertCell(const CellDef &cell, const GdsTransform &trans, IndexType depth)
+{
+    for (IndexType idx = 0; idx < cell.rects.size(); ++idx)
+    {
+        IndexType rectIdx = _layout.insertRect(cell.layers[idx], trans.apply(cell.rects[idx]));
+        if (cell.datatypes[idx] != 0)
+        {
+            _layout.setRectDatatype(cell.layers[idx], rectIdx, cell.datatypes[idx]);
+        }
+    }
+    std::vector<XY<LocType>> pts;
+    for (IndexType polyIdx = 0; polyIdx < cell.polyLayers.size(); ++polyIdx)
+    {
+        pts.clear();
+        for (IndexType ptIdx = cell.polyStart[polyIdx]; ptIdx < cell.polyStart[polyIdx + 1]; ++ptIdx)
+        {
+            pts.emplace_back(trans.apply(cell.polyPts[ptIdx].x(), cell.polyPts[ptIdx].y()));
+        }
+        _layout.insertPolygon(cell.polyLayers[polyIdx], pts.begin(), pts.end(), cell.polyDatatypes[polyIdx]);
+    }
+    for (IndexType idx = 0; idx < cell.texts.size(); ++idx)
+    {
+        IndexType textRef = cell.textRefs[idx];
+        const std::string &str = textRef == INDEX_TYPE_MAX ? cell.texts[idx].text() : (textRef < _textStrings.size() ? _textStrings[textRef] : cell.texts[idx].text());
+        const auto &coord = cell.texts[idx].coord();
+        _layout.insertText(cell.textLayers[idx], str, trans.apply(coord.x(), coord.y()));
+    }
+    for (const auto &placement : cell.placements)
+    {
+        this->instantiate(placement, trans, depth + 1);
+    }
+}
+
+void OasisReader::instantiate(const Placement &placement, const GdsTransform &parent, IndexType depth)
+{
+    const std::string &name = this->cellName(placement.refnum, placement.name);
+    if (depth >= MAX_REFERENCE_DEPTH)
+    {
+        ERR("OasisReader: the placements of %s are too deep or cyclic \n", name.c_str());
+        return;
+    }
+    auto it = _cellByName.find(name);
+    if (it == _cellByName.end())
+    {
+        WRN("OasisReader: placed cell %s is not defined \n", name.c_str());
+        return;
+    }
+    const CellDef &cell = _cells[it->second];
+    for (const auto &pos : placement.positions)
+    {
+        this->insertCell(cell, parent.compose(GdsTransform(pos.x(), pos.y(), placement.angle, placement.reflect)), depth);
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,135 @@
+/**
+ * @file OasisReader.h
+ * @brief OASIS reader that flattens the top cell into a Layout
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_OASIS_READER_H_
+#define MAGICAL_FLOW_OASIS_READER_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "parser/GdsStreamReader.h"
+#include "util/OasisFormat.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::OasisReader
+/// @brief Read an OASIS file into a Layout. The file, or its gzip compressed form, is read into memory and the records are decoded with their modal variables, the CBLOCKs inflated on the way.
+/// As GdsStreamReader, the top cell is the last cell of the file, and the cells it places are inserted under the composed placement transformations.
+/// RECTANGLE, POLYGON, TEXT and PLACEMENT are read, with all the repetition and point list types; the names and properties are skipped.
+/// The other geometries (PATH, TRAPEZOID, CTRAPEZOID, CIRCLE and the extensions) are not supported and fail the reading
+class OasisReader
+{
+    public:
+        /// @brief constructor
+        /// @param first: the layout to insert the shapes into
+        /// @param second: the technology database, for mapping the layers. The shapes on layers not in the technology are skipped
+        explicit OasisReader(Layout &layout, const TechDB &techDB) : _layout(layout), _techDB(techDB) {}
+        /// @brief read a file
+        /// @param the file name
+        /// @return whether the reading is successful
+        bool read(const std::string &fileName);
+        /// @brief the name of the top cell of the last read file
+        const std::string & topCellName() const { return _topCellName; }
+    private:
+        /// @brief a view of the bytes being decoded. Reading past the end sets the failure flag and returns zeros
+        struct Cursor
+        {
+            const std::uint8_t *pos = nullptr;
+            const std::uint8_t *end = nullptr;
+            bool failed = false;
+            bool atEnd() const { return pos >= end; }
+            std::uint8_t byte();
+            std::uint64_t readUnsigned();
+            std::int64_t readSigned();
+            RealType readReal();
+            /// @brief read a real of a type read already
+            RealType readReal(std::uint64_t realType);
+            std::string readString();
+            void skip(std::uint64_t numBytes);
+        };
+        /// @brief a cell reference. The name is resolved at the end, as CELLNAME may follow its uses
+        struct Placement
+        {
+            IndexType refnum = INDEX_TYPE_MAX; ///< The reference number of the cell, or INDEX_TYPE_MAX if by name
+            std::string name;
+            IntType angle = 0;
+            bool reflect = false;
+            std::vector<XY<LocType>> positions; ///< The position of each copy
+        };
+        /// @brief the contents of a cell, in its own coordinates
+        struct CellDef
+        {
+            IndexType refnum = INDEX_TYPE_MAX;
+            std::string name;
+            std::vector<IndexType> layers; ///< The db layer of each rectangle
+            std::vector<Box<LocType>> rects;
+            std::vector<IndexType> datatypes;
+            std::vector<IndexType> polyLayers; ///< The db layer of each rectilinear polygon kept as a polygon
+            std::vector<IndexType> polyDatatypes;
+            std::vector<IndexType> polyStart = std::vector<IndexType>(1, 0); ///< The vertices of polygon i are [polyStart[i], polyStart[i + 1])
+            std::vector<XY<LocType>> polyPts;
+            std::vector<IndexType> textLayers; ///< The db layer of each text
+            std::vector<TextLayout> texts;
+            std::vector<IndexType> textRefs; ///< The TEXTSTRING reference number of each text, INDEX_TYPE_MAX for an inline string
+            std::vector<Placement> placements;
+        };
+        /// @brief the modal variables
+        struct Modal
+        {
+            std::uint64_t layer = 0, datatype = 0, textLayer = 0, textType = 0;
+            std::int64_t width = 0, height = 0;
+            std::int64_t geomX = 0, geomY = 0, placeX = 0, placeY = 0, textX = 0, textY = 0;
+            IndexType placeCell = INDEX_TYPE_MAX;
+            std::string placeName, text;
+            IndexType textRef = INDEX_TYPE_MAX;
+            std::vector<XY<LocType>> repetition; ///< The offsets of the last repetition
+            std::vector<XY<LocType>> polygon; ///< The last point list
+            bool relative = false;
+        };
+        /// @brief decode the records until the end of the bytes or END
+        /// @param first: the bytes
+        /// @param second: whether the bytes are the content of a CBLOCK
+        /// @return whether successful
+        bool readRecords(Cursor &cursor, bool inCBlock);
+        /// @brief decode a repetition into the offsets of the copies, the first one (0, 0)
+        void readRepetition(Cursor &cursor, std::vector<XY<LocType>> &offsets);
+        /// @brief decode a point list into the vertices of a polygon, the first one (0, 0)
+        void readPointList(Cursor &cursor, std::vector<XY<LocType>> &pts);
+        /// @brief decode a g-delta
+        XY<LocType> readGDelta(Cursor &cursor);
+        /// @brief skip a property value list of a PROPERTY record
+        void skipPropertyValues(Cursor &cursor, std::uint64_t numValues);
+        /// @brief decode a coordinate, relative to a modal variable in the relative xy mode
+        std::int64_t readCoord(Cursor &cursor, std::int64_t &modal);
+        /// @brief insert the copies of a placement
+        /// @param first: the placement
+        /// @param second: the transformation from the cell containing it to the top cell
+        /// @param third: the depth of the placement, for detecting cyclic references
+        void instantiate(const Placement &placement, const GdsTransform &parent, IndexType depth);
+        /// @brief insert the contents of a cell under a transformation
+        void insertCell(const CellDef &cell, const GdsTransform &trans, IndexType depth);
+        /// @brief get the name of a cell or a placed cell
+        /// @param first: the reference number, INDEX_TYPE_MAX if by name
+        /// @param second: the name
+        const std::string & cellName(IndexType refnum, const std::string &name) const;
+
+    private:
+        Layout &_layout; ///< The output layout
+        const TechDB &_techDB; ///< The technology database
+        std::string _topCellName; ///< The top cell
+        std::vector<std::string> _cellNames; ///< The CELLNAME of each reference number
+        std::vector<std::string> _textStrings; ///< The TEXTSTRING of each reference number
+        IndexType _nextCellName = 0; ///< The next implicit CELLNAME reference number
+        IndexType _nextTextString = 0; ///< The next implicit TEXTSTRING reference number
+        std::vector<CellDef> _cells; ///< The cells in the order of the file
+        std::unordered_map<std::string, IndexType> _cellByName; ///< The cell of each name, resolved after reading
+        Modal _modal; ///< The modal variables
+        bool _ended = false; ///< Whether END is read
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_OASIS_READER_H_
@@ -1,20 +1,26 @@
 #include "ParseGDS.h"
 #include <iostream>
+#include "util/GzipStream.h"
 
 PROJECT_NAMESPACE_BEGIN
 
 bool Parser::read(const std::string &fileName)
 {
+    PlainFile plain(fileName);
+    if (!plain.valid())
+        return false;
     GdsParser::GdsDB::GdsReader reader (_db);
-    if (!reader(fileName))
+    if (!reader(plain.path()))
         return false;
     std::string topCell = _db.cells().back().name();
     GdsCell top = _db.extractCell(topCell);
     // _layer.clear();
+    LayoutPolygons polygons;
     for (const auto &object: top.objects())
     {
-        ::GdsParser::GdsDB::GdsObjectHelpers()(object.first, object.second, ParseLayout(_layer, _techDB));
+        ::GdsParser::GdsDB::GdsObjectHelpers()(object.first, object.second, ParseLayout(polygons, _techDB));
     }
+    polygons.flush(_layer);
     return true;
 }
 
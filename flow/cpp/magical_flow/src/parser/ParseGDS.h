@@ -23,7 +23,7 @@ using GdsParser::GdsDB::GdsCellReference;
 class Parser
 {
     public:
-        explicit Parser(const std::string & fileName, Layout & layer, TechDB & techDB) : _layer(layer), _techDB(techDB)
+        explicit Parser(const std::string & fileName, Layout & layer, const TechDB & techDB) : _layer(layer), _techDB(techDB)
         {
             read(fileName);
         }
@@ -31,65 +31,117 @@ class Parser
     private:
         GdsParser::GdsDB::GdsDB _db;
         Layout & _layer;
-        TechDB & _techDB;
+        const TechDB & _techDB;
+};
+
+/// @brief the polygons of a GDSII cell. The rectilinear polygons other than boxes are kept as polygons, and the others are converted into rectangles in one batch
+struct LayoutPolygons
+{
+    /// @brief queue a polygon
+    /// @param first: the db layer
+    /// @param second: the datatype
+    /// @param third: the first point
+    /// @param fourth: past the last point
+    template<typename Iterator>
+    void add(IndexType layerIdx, IndexType datatype, Iterator first, Iterator last)
+    {
+        pts.clear();
+        for (Iterator it = first; it != last; ++it)
+        {
+            pts.emplace_back(it->x(), it->y());
+        }
+        if (::klib::simplifyRectilinear(pts) && pts.size() > 4)
+        {
+            keptLayers.emplace_back(layerIdx);
+            keptDatatypes.emplace_back(datatype);
+            keptPts.insert(keptPts.end(), pts.begin(), pts.end());
+            keptStart.emplace_back(keptPts.size());
+            return;
+        }
+        batch.addPolygon(first, last);
+        layers.emplace_back(layerIdx);
+        datatypes.emplace_back(datatype);
+    }
+    /// @brief convert the queued polygons and insert the rectangles into a layout, in the order of the polygons, then insert the kept polygons
+    /// @param the layout
+    void flush(Layout &layout)
+    {
+        if (!batch.run())
+        {
+            IndexType numFailed = 0;
+            for (IndexType polyIdx = 0; polyIdx < batch.numPolygons(); ++polyIdx)
+            {
+                numFailed += batch.success(polyIdx) ? 0 : 1;
+            }
+            WRN("Parser: %u polygons could not be sliced into rectangles, their rectangles may be incomplete \n", numFailed);
+        }
+        for (IndexType polyIdx = 0; polyIdx < batch.numPolygons(); ++polyIdx)
+        {
+            for (const auto &rect : batch.rects(polyIdx))
+            {
+                IndexType rectIdx = layout.insertRect(layers[polyIdx], rect);
+                if (datatypes[polyIdx] != 0)
+                {
+                    layout.setRectDatatype(layers[polyIdx], rectIdx, datatypes[polyIdx]);
+                }
+            }
+        }
+        for (IndexType polyIdx = 0; polyIdx < keptLayers.size(); ++polyIdx)
+        {
+            layout.insertPolygon(keptLayers[polyIdx], keptPts.begin() + keptStart[polyIdx], keptPts.begin() + keptStart[polyIdx + 1], keptDatatypes[polyIdx]);
+        }
+        batch.clear();
+        layers.clear();
+        datatypes.clear();
+        keptLayers.clear();
+        keptDatatypes.clear();
+        keptPts.clear();
+        keptStart.assign(1, 0);
+    }
+    ::klib::Polygon2RectBatch<LocType> batch; ///< The polygons to convert
+    std::vector<IndexType> layers; ///< The db layer of each polygon to convert
+    std::vector<IndexType> datatypes; ///< The datatype of each polygon to convert
+    std::vector<IndexType> keptLayers; ///< The db layer of each kept polygon
+    std::vector<IndexType> keptDatatypes; ///< The datatype of each kept polygon
+    std::vector<XY<LocType>> keptPts; ///< The vertices of the kept polygons
+    std::vector<IndexType> keptStart = std::vector<IndexType>(1, 0); ///< The vertices of kept polygon i are [keptStart[i], keptStart[i + 1])
+    std::vector<XY<LocType>> pts; ///< The buffer for simplifying a polygon
 };
 
 namespace ParseLayoutAction
 {
     /// @brief default action
     template<typename ObjectType>
-    inline void extractLayout(Layout & layer, TechDB & techDB, ::GdsParser::GdsRecords::EnumType type, ObjectType *object)
+    inline void extractLayout(LayoutPolygons & polygons, const TechDB & techDB, ::GdsParser::GdsRecords::EnumType type, ObjectType *object)
     {
     }
     /// @brief process gds rectangle
     template<>
-    inline void extractLayout(Layout & layer, TechDB& techDB, ::GdsParser::GdsRecords::EnumType type, GdsRectangle *object)
+    inline void extractLayout(LayoutPolygons & polygons, const TechDB &techDB, ::GdsParser::GdsRecords::EnumType type, GdsRectangle *object)
     {
         std::cout << "Rectangles not supported yet";
     }
 
     /// @brief process gds polygon
     template<>
-    inline void extractLayout(Layout & layer, TechDB& techDB, ::GdsParser::GdsRecords::EnumType type, GdsPolygon *object)
+    inline void extractLayout(LayoutPolygons & polygons, const TechDB &techDB, ::GdsParser::GdsRecords::EnumType type, GdsPolygon *object)
     {
-        /// Polygon shapes will be processed into rectangles
+        /// Polygon shapes will be kept or processed into rectangles
         IndexType layer_id(object->layer()), datatype(object->datatype()); 
-        IndexType rect_id;
-        std::vector<Box<LocType>> rects;
-        std::vector<XY<LocType>> pts;
         layer_id = techDB.pdkLayerToDb(layer_id);
-        for (auto pt : *object)
-        {
-            pts.emplace_back(pt.x(), pt.y());
-        }
-        ::klib::convertPolygon2Rects<LocType>(pts, rects);
-        for (auto rect : rects)
+        if (layer_id == INDEX_TYPE_MAX)
         {
-            rect_id = layer.insertRect(layer_id, rect);
-            if(datatype != 0)
-                layer.setRectDatatype(layer_id, rect_id, datatype);
+            // The layer is not in the tech file
+            return;
         }
-        // LocType x_min = std::numeric_limits<LocType>::max();
-        // LocType x_max = std::numeric_limits<LocType>::min();
-        // LocType y_min = std::numeric_limits<LocType>::max();
-        // LocType y_max = std::numeric_limits<LocType>::min();
-        // for (auto pt : *object)
-        // {
-        //     if(pt.x() < x_min) x_min = pt.x();
-        //     if(pt.x() > x_max) x_max = pt.x();
-        //     if(pt.y() < y_min) y_min = pt.y();
-        //     if(pt.y() > y_max) y_max = pt.y();
-        // }
-        // rect_id = layer.insertRect(layer_id, x_min, y_min, x_max, y_max);
-        // if(datatype != 0) 
-        //     layer.setRectDatatype(layer_id, rect_id, datatype);
+        polygons.add(layer_id, datatype, object->begin(), object->end());
     }
     /// @brief process path
     template<>
-    inline void extractLayout(Layout & layer, TechDB & techDB, ::GdsParser::GdsRecords::EnumType type, ::GdsParser::GdsDB::GdsPath *object)
+    inline void extractLayout(LayoutPolygons & polygons, const TechDB & techDB, ::GdsParser::GdsRecords::EnumType type, ::GdsParser::GdsDB::GdsPath *object)
     {
         auto polygon = object->toPolygon();
-        extractLayout(layer, techDB, type, &polygon);
+        extractLayout(polygons, techDB, type, &polygon);
     }
 
 }
@@ -97,20 +149,20 @@ namespace ParseLayoutAction
 /// @brief aution function object to process the the 
 struct ParseLayout
 {
-    /// @param first: the map between the gds layer indices to the router layers. Only care about the mapping within this map
-    /// @param second: a reference to a vector of polygons, saved the read polygons in this vector
-    ParseLayout(Layout& layer, TechDB & techDB) : _layer(layer), _techDB(techDB) {}
+    /// @param first: the polygons to convert into the layout
+    /// @param second: the technology database, for mapping the GDSII layers
+    ParseLayout(LayoutPolygons& polygons, const TechDB & techDB) : _polygons(polygons), _techDB(techDB) {}
     template<typename ObjectType>
     void operator()(::GdsParser::GdsRecords::EnumType type, ObjectType* object)
     {
-        ParseLayoutAction::extractLayout(_layer, _techDB, type, object);
+        ParseLayoutAction::extractLayout(_polygons, _techDB, type, object);
     }
     std::string message() const
     {
         return "ExtractLayout";
     }
-    Layout & _layer;
-    TechDB & _techDB;
+    LayoutPolygons & _polygons;
+    const TechDB & _techDB;
 };
 
 
@@ -0,0 +1,637 @@
+#include "ParseNetlist.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the device models, as the sets in DesignDB.py
+    const std::unordered_set<std::string> NMOS_MODELS = {"nmos", "nch", "nch_na", "nch_mac", "nch_lvt", "nch_lvt_mac", "nch_25_mac", "nch_na25_mac", "nch_hvt_mac", "nch_25ud18_mac"};
+    const std::unordered_set<std::string> PMOS_MODELS = {"pmos", "pch", "pch_mac", "pch_lvt", "pch_lvt_mac", "pch_25_mac", "pch_na25_mac", "pch_hvt_mac", "pch_25ud18_mac", "pch_hvt"};
+    const std::unordered_set<std::string> CAP_MODELS = {"cfmom", "cfmom_2t"};
+    const std::unordered_set<std::string> RES_MODELS = {"rppoly", "rppoly_m", "rppolywo_m", "rppolywo"};
+
+    bool isNmos(const std::string &model) { return NMOS_MODELS.find(model) != NMOS_MODELS.end(); }
+    bool isPmos(const std::string &model) { return PMOS_MODELS.find(model) != PMOS_MODELS.end(); }
+    bool isCap(const std::string &model) { return CAP_MODELS.find(model) != CAP_MODELS.end(); }
+    bool isRes(const std::string &model) { return RES_MODELS.find(model) != RES_MODELS.end(); }
+
+    std::string toLower(std::string str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+        return str;
+    }
+
+    /// @brief split a line on the white spaces, keeping "key=value" as one token even with spaces around the "="
+    std::vector<std::string> tokenize(const std::string &line)
+    {
+        std::string joined;
+        joined.reserve(line.size());
+        for (std::size_t idx = 0; idx < line.size(); ++idx)
+        {
+            char c = line[idx];
+            if (std::isspace(static_cast<unsigned char>(c)))
+            {
+                // Drop the spaces before and after a "="
+                std::size_t next = line.find_first_not_of(" \t\r", idx);
+                if ((next != std::string::npos && line[next] == '=') || (!joined.empty() && joined.back() == '='))
+                {
+                    continue;
+                }
+            }
+            joined.push_back(c);
+        }
+        std::vector<std::string> tokens;
+        std::istringstream iss(joined);
+        std::string token;
+        while (iss >> token)
+        {
+            tokens.emplace_back(token);
+        }
+        return tokens;
+    }
+
+    /// @brief convert a number with an optional "u" or "n" suffix into an integer of unit, as Netlist_parser.get_value
+    /// @param first: the number
+    /// @param second: the unit
+    /// @param third: the integer, truncated
+    /// @return whether the number is valid
+    bool getValue(std::string str, RealType unit, IntType &value)
+    {
+        if (str.empty())
+        {
+            return false;
+        }
+        if (str.back() == 'u')
+        {
+            str = str.substr(0, str.size() - 1) + "e-6";
+        }
+        else if (str.back() == 'n')
+        {
+            str = str.substr(0, str.size() - 1) + "e-9";
+        }
+        std::size_t pos = 0;
+        double number = 0;
+        try
+        {
+            number = std::stod(str, &pos);
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+        if (pos != str.size())
+        {
+            return false;
+        }
+        value = static_cast<IntType>(number / unit);
+        return true;
+    }
+}
+
+void ParseNetlist::splitLines(const std::string &content, NetlistFormat format, std::vector<std::pair<std::string, IndexType>> &lines) const
+{
+    std::istringstream iss(content);
+    std::string line;
+    IndexType lineNum = 0;
+    bool continued = false; // Whether the last spectre line ends with a backslash
+    while (std::getline(iss, line))
+    {
+        ++lineNum;
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        std::size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos)
+        {
+            continued = false;
+            continue;
+        }
+        if (line.compare(first, 2, "//") == 0 || (format == NetlistFormat::HSPICE && line[first] == '*'))
+        {
+            continue;
+        }
+        if (format == NetlistFormat::HSPICE && line[first] == '+')
+        {
+            if (!lines.empty())
+            {
+                lines.back().first += " " + line.substr(first + 1);
+            }
+            continue;
+        }
+        bool continues = format == NetlistFormat::SPECTRE && line.back() == '\\';
+        if (continues)
+        {
+            line.pop_back();
+        }
+        if (continued && !lines.empty())
+        {
+            lines.back().first += " " + line;
+        }
+        else
+        {
+            lines.emplace_back(line, lineNum);
+        }
+        continued = continues;
+    }
+}
+
+bool ParseNetlist::parseInst(const std::vector<std::string> &tokens, const std::string &line, NetlistFormat format, RawInst &inst) const
+{
+    if (format == NetlistFormat::SPECTRE)
+    {
+        // name (nets) reference key=value ...
+        std::size_t open = line.find('(');
+        std::size_t close = line.find(')', open);
+        if (open == std::string::npos || close == std::string::npos)
+        {
+            return false;
+        }
+        std::vector<std::string> names = tokenize(line.substr(0, open));
+        std::vector<std::string> rest = tokenize(line.substr(close + 1));
+        if (names.size() != 1 || rest.empty() || rest.front().find('=') != std::string::npos)
+        {
+            return false;
+        }
+        inst.name = names.front();
+        inst.nets = tokenize(line.substr(open + 1, close - open - 1));
+        inst.reference = rest.front();
+        for (IndexType idx = 1; idx < rest.size(); ++idx)
+        {
+            std::size_t eq = rest[idx].find('=');
+            if (eq == std::string::npos)
+            {
+                return false;
+            }
+            inst.params[rest[idx].substr(0, eq)] = rest[idx].substr(eq + 1);
+        }
+        return true;
+    }
+    // name nets... reference key=value ...
+    auto firstParam = std::find_if(tokens.begin(), tokens.end(), [](const std::string &token) { return token.find('=') != std::string::npos; });
+    if (firstParam - tokens.begin() < 2)
+    {
+        return false;
+    }
+    inst.name = tokens.front();
+    inst.nets.assign(tokens.begin() + 1, firstParam - 1);
+    inst.reference = *(firstParam - 1);
+    for (auto it = firstParam; it != tokens.end(); ++it)
+    {
+        std::size_t eq = it->find('=');
+        if (eq == std::string::npos)
+        {
+            return false;
+        }
+        inst.params[it->substr(0, eq)] = it->substr(eq + 1);
+    }
+    return true;
+}
+
+bool ParseNetlist::read(const std::string &filename, NetlistFormat format)
+{
+    std::ifstream inf(filename.c_str());
+    if (!inf.is_open())
+    {
+        ERR("Netlist parser::%s: cannot open file: %s \n", __FUNCTION__ , filename.c_str());
+        return false;
+    }
+    _filename = filename;
+    std::stringstream buffer;
+    buffer << inf.rdbuf();
+    std::vector<std::pair<std::string, IndexType>> lines;
+    splitLines(buffer.str(), format, lines);
+
+    const bool isHspice = format == NetlistFormat::HSPICE;
+    const std::string subcktKey = isHspice ? ".subckt" : "subckt";
+    const std::string topcktKey = isHspice ? ".topckt" : "topckt";
+    const std::string endsKey = isHspice ? ".ends" : "ends";
+    bool inCkt = false;
+    bool foundTop = false;
+    for (const auto &line : lines)
+    {
+        std::vector<std::string> tokens = tokenize(line.first);
+        if (tokens.empty())
+        {
+            continue;
+        }
+        std::string keyword = isHspice ? toLower(tokens.front()) : tokens.front();
+        if (keyword == subcktKey || keyword == topcktKey)
+        {
+            if (inCkt)
+            {
+                ERR("Netlist parser: %s:%u: nested sub circuit \n", filename.c_str(), line.second);
+                return false;
+            }
+            if (tokens.size() < 2)
+            {
+                ERR("Netlist parser: %s:%u: sub circuit without a name \n", filename.c_str(), line.second);
+                return false;
+            }
+            if (keyword == topcktKey)
+            {
+                if (foundTop)
+                {
+                    ERR("Netlist parser: %s:%u: a second top circuit \n", filename.c_str(), line.second);
+                    return false;
+                }
+                foundTop = true;
+            }
+            _ckts.emplace_back();
+            _ckts.back().name = tokens[1];
+            for (IndexType idx = 2; idx < tokens.size(); ++idx)
+            {
+                // The parameters of the sub circuit are not used
+                if (tokens[idx].find('=') == std::string::npos)
+                {
+                    _ckts.back().ios.emplace_back(tokens[idx]);
+                }
+            }
+            inCkt = true;
+        }
+        else if (keyword == endsKey)
+        {
+            if (!inCkt || (tokens.size() > 1 && tokens[1] != _ckts.back().name))
+            {
+                ERR("Netlist parser: %s:%u: unmatched %s \n", filename.c_str(), line.second, line.first.c_str());
+                return false;
+            }
+            inCkt = false;
+        }
+        else if (inCkt && !(isHspice && keyword.front() == '.'))
+        {
+            RawInst inst;
+            if (!parseInst(tokens, line.first, format, inst))
+            {
+                ERR("Netlist parser: %s:%u: cannot parse the instance %s \n", filename.c_str(), line.second, line.first.c_str());
+                return false;
+            }
+            _ckts.back().insts.emplace_back(std::move(inst));
+        }
+        else
+        {
+            RawInst inst;
+            if (!inCkt && !(isHspice && keyword.front() == '.') && parseInst(tokens, line.first, format, inst))
+            {
+                // Dropping it would silently lose a device
+                ERR("Netlist parser: %s:%u: instance %s outside of a sub circuit \n", filename.c_str(), line.second, inst.name.c_str());
+                return false;
+            }
+            // The control statements, such as the options and the parameters
+            WRN("Netlist parser: %s:%u: skip the unsupported statement %s \n", filename.c_str(), line.second, line.first.c_str());
+        }
+    }
+    if (inCkt)
+    {
+        ERR("Netlist parser: %s: sub circuit %s is not ended \n", filename.c_str(), _ckts.back().name.c_str());
+        return false;
+    }
+    return translate();
+}
+
+bool ParseNetlist::translate()
+{
+    IndexType cktBegin = _designDB.numCkts(); // The netlist is appended after the existing circuits
+    std::unordered_map<std::string, IndexType> cktIdxMap; // The circuit index of each sub circuit name
+    IndexType numLeaves = 0;
+    for (IndexType idx = 0; idx < _ckts.size(); ++idx)
+    {
+        cktIdxMap[_ckts[idx].name] = cktBegin + idx;
+    }
+    for (const auto &raw : _ckts)
+    {
+        for (const auto &inst : raw.insts)
+        {
+            numLeaves += cktIdxMap.find(inst.reference) == cktIdxMap.end();
+        }
+    }
+    _designDB.ckts().reserve(_designDB.numCkts() + _ckts.size() + numLeaves);
+
+    // The sub circuits, with the nets in the order of the ios and then of the first connection
+    for (const auto &raw : _ckts)
+    {
+        IndexType cktIdx = _designDB.allocateCkt();
+        auto &ckt = _designDB.subCkt(cktIdx);
+        ckt.setName(raw.name);
+        std::unordered_map<std::string, IndexType> netIdxMap;
+        std::vector<const std::string *> netNames;
+        IndexType numPins = 0;
+        for (const auto &name : raw.ios)
+        {
+            if (netIdxMap.emplace(name, netNames.size()).second)
+            {
+                netNames.emplace_back(&name);
+            }
+        }
+        IndexType numIos = netNames.size();
+        for (const auto &inst : raw.insts)
+        {
+            numPins += inst.nets.size();
+            for (const auto &name : inst.nets)
+            {
+                if (netIdxMap.emplace(name, netNames.size()).second)
+                {
+                    netNames.emplace_back(&name);
+                }
+            }
+        }
+        ckt.netArray().reserve(netNames.size());
+        ckt.nodeArray().reserve(raw.insts.size());
+        ckt.pinArray().reserve(numPins);
+        for (IndexType netIdx = 0; netIdx < netNames.size(); ++netIdx)
+        {
+            auto &net = ckt.net(ckt.allocateNet());
+            net.setName(*netNames[netIdx]);
+            if (netIdx < numIos)
+            {
+                net.setIoPos(netIdx);
+            }
+        }
+        for (const auto &inst : raw.insts)
+        {
+            IndexType nodeIdx = ckt.allocateNode();
+            auto &node = ckt.node(nodeIdx);
+            node.setRefName(inst.reference);
+            node.setName(inst.name);
+            for (const auto &name : inst.nets)
+            {
+                IndexType netIdx = netIdxMap.at(name);
+                IndexType pinIdx = ckt.allocatePin();
+                ckt.pin(pinIdx).setNodeIdx(nodeIdx);
+                ckt.pin(pinIdx).setNetIdx(netIdx);
+                ckt.net(netIdx).appendPinIdx(pinIdx);
+                node.appendPinIdx(pinIdx);
+            }
+        }
+    }
+
+    // Connect the nodes to the sub circuits, and translate the leaves into device circuits
+    for (IndexType idx = 0; idx < _ckts.size(); ++idx)
+    {
+        const auto &raw = _ckts[idx];
+        IndexType cktIdx = cktBegin + idx;
+        IndexType pinIdx = 0;
+        for (IndexType nodeIdx = 0; nodeIdx < raw.insts.size(); ++nodeIdx)
+        {
+            const auto &inst = raw.insts[nodeIdx];
+            auto subIt = cktIdxMap.find(inst.reference);
+            if (subIt == cktIdxMap.end())
+            {
+                if (!translateDevice(cktIdx, nodeIdx, pinIdx, inst))
+                {
+                    return false;
+                }
+                pinIdx += inst.nets.size();
+                continue;
+            }
+            auto &ckt = _designDB.subCkt(cktIdx);
+            IndexType numSubIos = _ckts[subIt->second - cktBegin].ios.size();
+            if (inst.nets.size() > numSubIos)
+            {
+                ERR("Netlist parser: %s: instance %s of %s has %u nets, but %s has %u ios \n", _filename.c_str(), inst.name.c_str(), raw.name.c_str(),
+                        static_cast<IndexType>(inst.nets.size()), inst.reference.c_str(), numSubIos);
+                return false;
+            }
+            ckt.node(nodeIdx).setSubgraphIdx(subIt->second);
+            for (IndexType instPinIdx = 0; instPinIdx < inst.nets.size(); ++instPinIdx)
+            {
+                // The ios are the first nets of the sub circuit
+                ckt.pin(pinIdx).setIntNetIdx(instPinIdx);
+                ++pinIdx;
+            }
+        }
+    }
+    return true;
+}
+
+bool ParseNetlist::translateDevice(IndexType cktIdx, IndexType nodeIdx, IndexType pinIdx, const RawInst &inst)
+{
+    const std::string &model = inst.reference;
+    bool nmos = isNmos(model);
+    bool pmos = isPmos(model);
+    bool passive = isCap(model) || isRes(model);
+    // The connections inside the device, as Netlist_parser.intra_devcon. The pins merged into another are invalid
+    std::vector<bool> valid(inst.nets.size(), true);
+    std::vector<IndexType> bulkCon;
+    std::string pinConType;
+    const auto &nets = inst.nets;
+    if (pmos && nets.size() >= 4)
+    {
+        for (IndexType idx = 0; idx < 3; ++idx)
+        {
+            if (nets[idx] == nets[3])
+            {
+                bulkCon.emplace_back(idx);
+                valid[idx] = false;
+            }
+        }
+    }
+    if ((nmos || pmos) && nets.size() >= 3)
+    {
+        if (nets[1] == nets[2])
+        {
+            pinConType = "GS";
+            valid[2] = false;
+        }
+        else if (nets[1] == nets[0])
+        {
+            pinConType = "GD";
+            valid[0] = false;
+        }
+        else if (nets[0] == nets[2])
+        {
+            pinConType = "SD";
+            valid[2] = false;
+        }
+    }
+
+    const std::string parentName = _designDB.subCkt(cktIdx).name();
+    IndexType devIdx = _designDB.allocateCkt();
+    auto &ckt = _designDB.subCkt(cktIdx);
+    auto &node = ckt.node(nodeIdx);
+    node.setName(parentName + "_" + node.name());
+    node.setSubgraphIdx(devIdx);
+    auto &dev = _designDB.subCkt(devIdx);
+    dev.setName(parentName + "_" + inst.name);
+    dev.netArray().reserve(nets.size());
+    dev.nodeArray().reserve(nets.size());
+    dev.pinArray().reserve(nets.size());
+    for (IndexType idx = 0; idx < nets.size(); ++idx)
+    {
+        bool psub = (nmos && idx == 3) || (passive && idx == 2);
+        bool nwell = pmos && idx == 3;
+        IndexType subNetIdx = dev.allocateNet();
+        if (psub)
+        {
+            dev.addPsubIdx(subNetIdx);
+        }
+        else if (nwell)
+        {
+            dev.addNwellIdx(subNetIdx);
+        }
+        // The nets of a device are named by their indices
+        dev.net(subNetIdx).setName(std::to_string(idx));
+        IndexType subPinIdx = dev.allocatePin();
+        IndexType subNodeIdx = dev.allocateNode();
+        auto &subPin = dev.pin(subPinIdx);
+        subPin.setNodeIdx(subNodeIdx);
+        subPin.setNetIdx(subNetIdx);
+        if (psub || nwell)
+        {
+            dev.net(subNetIdx).appendSubIdx(subPinIdx);
+        }
+        else
+        {
+            dev.net(subNetIdx).appendPinIdx(subPinIdx);
+        }
+        dev.node(subNodeIdx).setRefName(model);
+        dev.node(subNodeIdx).setName(inst.name);
+        auto &pin = ckt.pin(pinIdx + idx);
+        pin.setIntNetIdx(subNetIdx);
+        if (psub || nwell)
+        {
+            ckt.net(pin.netIdx()).appendSubIdx(pinIdx + idx);
+            PinType pinType = psub ? PinType::PSUB : PinType::NWELL;
+            subPin.setPinType(pinType);
+            pin.setPinType(pinType);
+        }
+        if (!valid[idx])
+        {
+            subPin.setValid(false);
+            pin.setValid(false);
+        }
+    }
+    return translateProp(devIdx, inst, pinConType, bulkCon);
+}
+
+bool ParseNetlist::translateProp(IndexType devIdx, const RawInst &inst, const std::string &pinConType, const std::vector<IndexType> &bulkCon)
+{
+    const std::string &model = inst.reference;
+    // Read a parameter. The required ones fail the parsing if missing
+    auto param = [&](const std::string &key, RealType unit, IntType &value) -> bool
+    {
+        auto it = inst.params.find(key);
+        if (it == inst.params.end())
+        {
+            ERR("Netlist parser: %s: instance %s of %s has no parameter %s \n", _filename.c_str(), inst.name.c_str(), model.c_str(), key.c_str());
+            return false;
+        }
+        if (!getValue(it->second, unit, value))
+        {
+            ERR("Netlist parser: %s: instance %s has an unsupported value %s=%s \n", _filename.c_str(), inst.name.c_str(), key.c_str(), it->second.c_str());
+            return false;
+        }
+        return true;
+    };
+    auto has = [&](const std::string &key) { return inst.params.find(key) != inst.params.end(); };
+    const std::string multiKey = has("m") ? "m" : "multi";
+    auto &dev = _designDB.subCkt(devIdx);
+    auto &props = _designDB.phyPropDB();
+    IntType value = 0;
+    if (isNmos(model) || isPmos(model))
+    {
+        bool nmos = isNmos(model);
+        IndexType propIdx = nmos ? props.allocateNch() : props.allocatePch();
+        MosProp &mos = nmos ? static_cast<MosProp &>(props.nch(propIdx)) : static_cast<MosProp &>(props.pch(propIdx));
+        if (!param("l", 1e-12, value)) { return false; }
+        mos.setLength(value);
+        if (!param("w", 1e-12, value)) { return false; }
+        mos.setWidth(value);
+        if (!param("nf", 1, value)) { return false; }
+        mos.setNumFingers(value);
+        if (!pinConType.empty())
+        {
+            mos.setPinConType(pinConType);
+        }
+        for (IndexType pin : bulkCon)
+        {
+            mos.appendBulkCon(pin);
+        }
+        if (has(multiKey))
+        {
+            if (!param(multiKey, 1, value)) { return false; }
+            mos.setMult(value);
+        }
+        mos.setAttr(model);
+        dev.setImplIdx(propIdx);
+        dev.setImplType(nmos ? ImplType::PCELL_Nch : ImplType::PCELL_Pch);
+    }
+    else if (isRes(model))
+    {
+        IndexType propIdx = props.allocateRes();
+        ResProp &res = props.resister(propIdx);
+        if (!param("lr", 1e-12, value)) { return false; }
+        res.setLr(value);
+        if (!param("wr", 1e-12, value)) { return false; }
+        res.setWr(value);
+        if (has("series") || has("para"))
+        {
+            const std::string segKey = has("series") ? "series" : "para";
+            if (segKey == "series")
+            {
+                res.setSeries(true);
+            }
+            else
+            {
+                res.setParallel(true);
+            }
+            if (!param(segKey, 1, value)) { return false; }
+            res.setSegNum(value);
+            if (!param("segspace", 1e-12, value)) { return false; }
+            res.setSegSpace(value);
+        }
+        else
+        {
+            res.setSegNum(1);
+            getValue("0.18e-6", 1e-12, value);
+            res.setSegSpace(value);
+        }
+        res.setAttr(model);
+        dev.setImplIdx(propIdx);
+        dev.setImplType(ImplType::PCELL_Res);
+    }
+    else if (isCap(model))
+    {
+        IndexType propIdx = props.allocateCap();
+        CapProp &cap = props.capacitor(propIdx);
+        if (!param("w", 1e-12, value)) { return false; }
+        cap.setW(value);
+        if (!param("s", 1e-12, value)) { return false; }
+        cap.setSpacing(value);
+        if (!param("nr", 1, value)) { return false; }
+        cap.setNumFingers(value);
+        if (!param("lr", 1e-12, value)) { return false; }
+        cap.setLr(value);
+        if (!param("stm", 1, value)) { return false; }
+        cap.setStm(value);
+        if (!param("spm", 1, value)) { return false; }
+        cap.setSpm(value);
+        if (!param("ftip", 1e-12, value)) { return false; }
+        cap.setFtip(value);
+        cap.setAttr(model);
+        if (has(multiKey))
+        {
+            if (!param(multiKey, 1, value)) { return false; }
+            cap.setMulti(value);
+        }
+        dev.setImplIdx(propIdx);
+        dev.setImplType(ImplType::PCELL_Cap);
+    }
+    // The other references, such as the unsupported devices, are left as circuits without implementation type
+    return true;
+}
+
+namespace PARSE
+{
+    bool parseNetlist(const std::string &file, DesignDB &designDB, bool isHspice)
+    {
+        return ParseNetlist(designDB).read(file, isHspice ? NetlistFormat::HSPICE : NetlistFormat::SPECTRE);
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,104 @@
+/**
+ * @file ParseNetlist.h
+ * @brief Parsing the hspice and spectre netlists into the DesignDB
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_PARSE_NETLIST_H_
+#define MAGICAL_FLOW_PARSE_NETLIST_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "global/global.h"
+#include "db/DesignDB.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @brief the syntax of an input netlist
+enum class NetlistFormat
+{
+    HSPICE,
+    SPECTRE
+};
+
+/// @class MAGICAL_FLOW::ParseNetlist
+/// @brief parser for the subset of the hspice and spectre netlists read by the Python Netlist_parser in DesignDB.py:
+/// .subckt/.topckt ... .ends (subckt/topckt ... ends in spectre), the instances with their nets, reference and key=value parameters,
+/// the comment lines and the continued lines. The circuits are translated as the Python parser does: one circuit per sub circuit in the order of the file,
+/// then one device circuit per leaf instance, with the physical properties of the transistors, resistors and capacitors.
+/// The other statements are skipped with a warning
+class ParseNetlist
+{
+    public:
+        /// @brief constructor
+        /// @param the design database to fill. The circuits are appended to it
+        explicit ParseNetlist(DesignDB &designDB) : _designDB(designDB) {}
+        /// @brief read a netlist
+        /// @param first: the file name of the netlist
+        /// @param second: the syntax of the netlist
+        /// @return whether the parsing is successful. An instance that cannot be parsed, or outside of the sub circuits, fails the parsing
+        bool read(const std::string &filename, NetlistFormat format);
+    private:
+        /// @brief an instance as written in the netlist
+        struct RawInst
+        {
+            std::string name;
+            std::vector<std::string> nets;
+            std::string reference;
+            std::unordered_map<std::string, std::string> params;
+        };
+        /// @brief a sub circuit as written in the netlist
+        struct RawCkt
+        {
+            std::string name;
+            std::vector<std::string> ios;
+            std::vector<RawInst> insts;
+        };
+        /// @brief split the file into logical lines: the continued lines joined, the comment lines dropped
+        /// @param first: the content of the file
+        /// @param second: the syntax of the netlist
+        /// @param third: the logical lines with the numbers of their first lines
+        void splitLines(const std::string &content, NetlistFormat format, std::vector<std::pair<std::string, IndexType>> &lines) const;
+        /// @brief read the instance of a logical line
+        /// @param first: the tokens of the line
+        /// @param second: the line itself, for the spectre nets in parentheses
+        /// @param third: the syntax of the netlist
+        /// @param fourth: the instance
+        /// @return whether the line is an instance
+        bool parseInst(const std::vector<std::string> &tokens, const std::string &line, NetlistFormat format, RawInst &inst) const;
+        /// @brief translate the sub circuits into the database
+        /// @return whether successful
+        bool translate();
+        /// @brief translate a leaf instance into a device circuit, as Netlist_parser.connect_children does
+        /// @param first: the index of the parent circuit
+        /// @param second: the index of the node in the parent circuit
+        /// @param third: the index of the first pin of the node in the parent circuit
+        /// @param fourth: the instance
+        /// @return whether successful
+        bool translateDevice(IndexType cktIdx, IndexType nodeIdx, IndexType pinIdx, const RawInst &inst);
+        /// @brief set the physical property of a device circuit
+        /// @param first: the index of the device circuit
+        /// @param second: the instance
+        /// @param third: for the transistors, the connection of gate, source and drain, and the pins connected to the bulk
+        /// @return whether successful
+        bool translateProp(IndexType devIdx, const RawInst &inst, const std::string &pinConType, const std::vector<IndexType> &bulkCon);
+    private:
+        DesignDB &_designDB; ///< The design database to fill
+        std::vector<RawCkt> _ckts; ///< The sub circuits of the netlist
+        std::string _filename; ///< The netlist file, for the messages
+};
+
+namespace PARSE
+{
+    /// @brief parse a hspice or spectre netlist into a design database
+    /// @param first: the input netlist file
+    /// @param second: the design database
+    /// @param third: whether the netlist is in hspice syntax. Otherwise spectre
+    /// @return whether the parsing is successful
+    bool parseNetlist(const std::string &file, DesignDB &designDB, bool isHspice);
+}
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_PARSE_NETLIST_H_
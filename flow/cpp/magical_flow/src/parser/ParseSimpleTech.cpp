@@ -1,4 +1,6 @@
 #include "ParseSimpleTech.h"
+#include <cmath>
+#include <iterator>
 
 PROJECT_NAMESPACE_BEGIN
 
@@ -12,22 +14,86 @@ bool ParseSimpleTech::read(const std::string &filename)
         return false;
     }
     // Read in the file
+    std::vector<TechLayer> layers;
     std::string line;
     while (std::getline(inf, line))
     {
         // Split the line into words
-        std::vector<std::string> words;
         std::istringstream iss(line);
         std::string layerName;
         IndexType gdsLayer = INDEX_TYPE_MAX;
-        iss >> layerName;
-        iss >> gdsLayer;
-        // Add to the database
-        _techDB.addNewLayer(gdsLayer, layerName);
+        if (!(iss >> layerName))
+        {
+            continue;
+        }
+        if (layers.empty() && (layerName == "DBU" || layerName == "LAYER"))
+        {
+            // The LEF-like format of parse
+            inf.close();
+            return this->parse(filename);
+        }
+        if (!(iss >> gdsLayer))
+        {
+            WRN("ParserTechSimple::%s: skip the line without a tech layer: %s \n", __FUNCTION__, line.c_str());
+            continue;
+        }
+        layers.emplace_back(layerName, gdsLayer);
+    }
+    // Add to the database in the ascending order of the tech layers
+    std::stable_sort(layers.begin(), layers.end(), [&](const TechLayer &lhs, const TechLayer &rhs) { return lhs.techLayer < rhs.techLayer; });
+    for (const auto &layer : layers)
+    {
+        if (_techDB.addNewLayer(layer.techLayer, layer.name) == INDEX_TYPE_MAX)
+        {
+            ERR("ParserTechSimple::%s: tech layer %u is defined more than once in %s \n", __FUNCTION__, layer.techLayer, filename.c_str());
+            return false;
+        }
     }
+    this->connectCutLayersByName();
     return true;
 }
 
+void ParseSimpleTech::connectCutLayersByName()
+{
+    auto connect = [&](IndexType cutLayer, const std::string &name)
+    {
+        IndexType layer = _techDB.layerNameToIdx(name);
+        if (layer != INDEX_TYPE_MAX)
+        {
+            _techDB.addCutConnection(cutLayer, layer);
+        }
+    };
+    IndexType contact = _techDB.layerNameToIdx("CO");
+    if (contact != INDEX_TYPE_MAX)
+    {
+        connect(contact, "PO");
+        connect(contact, "OD");
+        connect(contact, "M1");
+    }
+    this->splitDiffusionByName();
+    for (IndexType metal = 1; ; ++metal)
+    {
+        IndexType via = _techDB.layerNameToIdx("VIA" + std::to_string(metal));
+        if (via == INDEX_TYPE_MAX)
+        {
+            break;
+        }
+        connect(via, "M" + std::to_string(metal));
+        connect(via, "M" + std::to_string(metal + 1));
+    }
+}
+
+void ParseSimpleTech::splitDiffusionByName()
+{
+    // The sources and drains of a MOS are the OD on either side of its PO gates
+    IndexType diffusion = _techDB.layerNameToIdx("OD");
+    IndexType gate = _techDB.layerNameToIdx("PO");
+    if (diffusion != INDEX_TYPE_MAX && gate != INDEX_TYPE_MAX)
+    {
+        _techDB.setGateLayer(diffusion, gate);
+    }
+}
+
 bool ParseSimpleTech::parse(const std::string &filename)
 {
     std::ifstream inf(filename.c_str());
@@ -146,9 +212,7 @@ bool ParseSimpleTech::parseRoutingLayer(std::ifstream &inf)
     std::string name = "";
     bool hasDirection = false;
     std::string direction = "";
-    RealType spacing = 0.0;
-    bool hasWidth = false;
-    RealType width = 0.0;
+    TechLayer layer;
 
     std::string lineStr;
     while (std::getline(inf, lineStr))
@@ -159,7 +223,9 @@ bool ParseSimpleTech::parseRoutingLayer(std::ifstream &inf)
         ss >> token;
         if (token == "ENDLAYER")
         {
-            _techLayers.emplace_back(name, techLayer);
+            layer.name = name;
+            layer.techLayer = techLayer;
+            _techLayers.emplace_back(std::move(layer));
             return true;
         }
         else if (token == "NAME")
@@ -176,13 +242,24 @@ bool ParseSimpleTech::parseRoutingLayer(std::ifstream &inf)
         else if (token == "SPACING")
         {
             ss >> floatToken;
-            spacing = floatToken;
+            layer.spacing = floatToken;
         }
         else if (token == "WIDTH")
         {
             ss >> floatToken;
-            hasWidth = true;
-            width = floatToken;
+            layer.width = floatToken;
+        }
+        else if (token == "AREA")
+        {
+            ss >> floatToken;
+            layer.area = floatToken;
+        }
+        else if (token == "SPACINGTABLE")
+        {
+            if (!parseSpacingTable(inf, layer))
+            {
+                return false;
+            }
         }
         else if (token == "TECHLAYER")
         {
@@ -202,7 +279,7 @@ bool ParseSimpleTech::parseCutLayer(std::ifstream &inf)
 {
     IntType techLayer = 0;
     std::string name = "";
-    RealType spacing = 0.0;
+    TechLayer layer;
     std::string lineStr;
     while (std::getline(inf, lineStr))
     {
@@ -212,7 +289,10 @@ bool ParseSimpleTech::parseCutLayer(std::ifstream &inf)
         ss >> token;
         if (token == "ENDLAYER")
         {
-            _techLayers.emplace_back(name, techLayer);
+            layer.name = name;
+            layer.techLayer = techLayer;
+            layer.isCut = true;
+            _techLayers.emplace_back(std::move(layer));
             return true;
         }
         else if (token == "NAME")
@@ -224,7 +304,7 @@ bool ParseSimpleTech::parseCutLayer(std::ifstream &inf)
         {
             // Use one spacing to overwrite all the spacing requirements
             ss >> floatToken;
-            spacing = floatToken;
+            layer.spacing = floatToken;
         }
         else if (token == "TECHLAYER")
         {
@@ -240,6 +320,52 @@ bool ParseSimpleTech::parseCutLayer(std::ifstream &inf)
     return false;
 }
 
+bool ParseSimpleTech::parseSpacingTable(std::ifstream &inf, TechLayer &layer)
+{
+    std::string lineStr;
+    while (std::getline(inf, lineStr))
+    {
+        std::stringstream ss(lineStr);
+        std::string token;
+        RealType floatToken;
+        ss >> token;
+        if (token == "ENDSPACINGTABLE")
+        {
+            if (layer.tableLengths.empty() || layer.tableSpacings.size() != layer.tableWidths.size() * layer.tableLengths.size())
+            {
+                ERR("Simple tech parse::%s: %lu spacings for %lu widths and %lu parallel run lengths \n", __FUNCTION__,
+                        layer.tableSpacings.size(), layer.tableWidths.size(), layer.tableLengths.size());
+                return false;
+            }
+            return true;
+        }
+        else if (token == "PARALLELRUNLENGTH")
+        {
+            while (ss >> floatToken)
+            {
+                layer.tableLengths.emplace_back(floatToken);
+            }
+        }
+        else if (token == "WIDTH")
+        {
+            // The width of the row followed by one spacing per parallel run length
+            ss >> floatToken;
+            layer.tableWidths.emplace_back(floatToken);
+            while (ss >> floatToken)
+            {
+                layer.tableSpacings.emplace_back(floatToken);
+            }
+        }
+        else
+        {
+            ERR("Simple tech parse::%s: syntax error. Token %s \n", __FUNCTION__, token.c_str());
+            return false;
+        }
+    }
+    ERR("Simple tech parse::%s: syntax error. No ENDSPACINGTABLE? \n", __FUNCTION__);
+    return false;
+}
+
 bool ParseSimpleTech::parseVia(std::ifstream &inf)
 {
     return true;
@@ -247,17 +373,96 @@ bool ParseSimpleTech::parseVia(std::ifstream &inf)
 
 bool ParseSimpleTech::finish()
 {
+    // The cut layers connect the layers before and after them in the file
+    for (IndexType idx = 0; idx < _techLayers.size(); ++idx)
+    {
+        auto &cut = _techLayers[idx];
+        if (!cut.isCut)
+        {
+            continue;
+        }
+        for (IndexType below = idx; below-- > 0; )
+        {
+            if (!_techLayers[below].isCut)
+            {
+                cut.below = _techLayers[below].techLayer;
+                break;
+            }
+        }
+        for (IndexType above = idx + 1; above < _techLayers.size(); ++above)
+        {
+            if (!_techLayers[above].isCut)
+            {
+                cut.above = _techLayers[above].techLayer;
+                break;
+            }
+        }
+    }
     // Tech layers
     auto sortLayer = [&] (const TechLayer &lhs, const TechLayer &rhs)
     {
         return lhs.techLayer < rhs.techLayer;
     };
     std::sort(_techLayers.begin(), _techLayers.end(), sortLayer); // Sort by acesending layer id
+    // If the layers are there already, e.g. from read(), only set their rules
+    const bool addLayers = _techDB.numLayers() == 0;
+    const RealType dbu = static_cast<RealType>(_techDB.units().dbu());
+    auto toDbu = [&](RealType um) { return static_cast<LocType>(std::round(um * dbu)); };
     for (IndexType idx = 0; idx < _techLayers.size(); ++idx)
     {
-        IndexType returnIdx = _techDB.addNewLayer(_techLayers.at(idx).techLayer, _techLayers.at(idx).name);
-        Assert(returnIdx == idx);
+        const auto &techLayer = _techLayers.at(idx);
+        LayerRule rule;
+        rule.setMinWidth(toDbu(techLayer.width));
+        rule.setMinSpacing(toDbu(techLayer.spacing));
+        rule.setMinArea(static_cast<std::int64_t>(std::round(techLayer.area * dbu * dbu)));
+        if (!techLayer.tableSpacings.empty())
+        {
+            std::vector<LocType> widths, lengths, spacings;
+            std::transform(techLayer.tableWidths.begin(), techLayer.tableWidths.end(), std::back_inserter(widths), toDbu);
+            std::transform(techLayer.tableLengths.begin(), techLayer.tableLengths.end(), std::back_inserter(lengths), toDbu);
+            std::transform(techLayer.tableSpacings.begin(), techLayer.tableSpacings.end(), std::back_inserter(spacings), toDbu);
+            rule.setSpacingTable(std::move(widths), std::move(lengths), std::move(spacings));
+        }
+        IndexType dbLayer = INDEX_TYPE_MAX;
+        if (addLayers)
+        {
+            dbLayer = _techDB.addNewLayer(techLayer.techLayer, techLayer.name);
+            if (dbLayer == INDEX_TYPE_MAX)
+            {
+                ERR("Simple tech parse::%s: tech layer %u of layer %s is defined more than once \n", __FUNCTION__, techLayer.techLayer, techLayer.name.c_str());
+                return false;
+            }
+        }
+        else
+        {
+            dbLayer = _techDB.pdkLayerToDb(techLayer.techLayer);
+            if (dbLayer == INDEX_TYPE_MAX)
+            {
+                if (!rule.empty())
+                {
+                    WRN("Simple tech parse::%s: layer %s of tech layer %u is not in the technology. Skip its rules \n", __FUNCTION__, techLayer.name.c_str(), techLayer.techLayer);
+                }
+                continue;
+            }
+        }
+        _techDB.setLayerRule(dbLayer, rule);
+    }
+    for (const auto &cut : _techLayers)
+    {
+        IndexType cutLayer = _techDB.pdkLayerToDb(cut.techLayer);
+        if (!cut.isCut || cutLayer == INDEX_TYPE_MAX)
+        {
+            continue;
+        }
+        for (IndexType techLayer : {cut.below, cut.above})
+        {
+            if (techLayer != INDEX_TYPE_MAX && _techDB.pdkLayerToDb(techLayer) != INDEX_TYPE_MAX)
+            {
+                _techDB.addCutConnection(cutLayer, _techDB.pdkLayerToDb(techLayer));
+            }
+        }
     }
+    this->splitDiffusionByName();
     return true;
 }
 
@@ -19,6 +19,16 @@ struct TechLayer
     TechLayer(const std::string &name_, IndexType techLayer_) : name(name_), techLayer(techLayer_) {}
     std::string name;
     IndexType techLayer;
+    // The rules in um, converted to database units once DBU is known
+    RealType width = 0.0;
+    RealType spacing = 0.0;
+    RealType area = 0.0; ///< In um^2
+    std::vector<RealType> tableWidths; ///< The WIDTH of each row of the SPACINGTABLE
+    std::vector<RealType> tableLengths; ///< The PARALLELRUNLENGTH of each column of the SPACINGTABLE
+    std::vector<RealType> tableSpacings; ///< The spacings of the SPACINGTABLE, row major
+    bool isCut = false; ///< Whether a CUT layer, connecting the layers before and after it in the file
+    IndexType below = INDEX_TYPE_MAX; ///< The tech layer before a cut layer
+    IndexType above = INDEX_TYPE_MAX; ///< The tech layer after a cut layer
 };
 
 /// @class PROJECT_NAMESPACE::ParseSimpleTech
@@ -34,11 +44,16 @@ class ParseSimpleTech
         /// @param the file name of the simple tech file
         /// @return whether the parsing is successful
         bool parse(const std::string &filename);
-        /// @brief read a simple tech file, no idea what parse reads
+        /// @brief read a simple tech file of a layer name and a tech layer on each line. The layers are added in the ascending order of the tech layers.
+        /// A file in the LEF-like format of parse is parsed by parse
         /// @param the file name of the simple tech file
-        /// @return whether the parsing is successful
+        /// @return whether the parsing is successful. False if a tech layer is defined more than once
         bool read(const std::string &filename);
     private:
+        /// @brief connect the cut layers of a layer list by the names: CO connects PO, OD and M1, and VIAn connects Mn and Mn+1
+        void connectCutLayersByName();
+        /// @brief split the OD at the PO by the names, so that a contact on the source does not connect the drain
+        void splitDiffusionByName();
         /// @brief finish up the parsing
         bool finish();
         /// @brief parse information for a masterslice layer
@@ -53,6 +68,11 @@ class ParseSimpleTech
         /// @param the input file stream
         /// @return if the parsing is successful
         bool parseCutLayer(std::ifstream &inf);
+        /// @brief parse a SPACINGTABLE of a routing layer, until ENDSPACINGTABLE
+        /// @param first: the input file stream
+        /// @param second: the layer to record the table into
+        /// @return if the parsing is successful
+        bool parseSpacingTable(std::ifstream &inf, TechLayer &layer);
         /// @brief parse information for a via macro
         /// @param the input file stream
         /// @return if the parsing is successful
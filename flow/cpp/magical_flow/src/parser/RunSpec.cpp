@@ -0,0 +1,347 @@
+/**
+ * @file RunSpec.cpp
+ * @brief The JSON run specification of the flow, as Params.py reads it
+ * @date 10/14/2026
+ */
+
+#include "parser/RunSpec.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+PROJECT_NAMESPACE_BEGIN
+
+class RunSpec::Parser
+{
+    public:
+        explicit Parser(const std::string &text) : _text(text) {}
+        /// @brief parse the top-level object
+        bool parseObject(std::vector<std::string> &keys, std::unordered_map<std::string, Value> &values)
+        {
+            if (!this->expect('{'))
+            {
+                return false;
+            }
+            if (this->peek() == '}')
+            {
+                ++_pos;
+                return this->atEnd();
+            }
+            while (true)
+            {
+                std::string key;
+                Value value;
+                if (!this->skipSpace() || !this->parseString(key) || !this->expect(':') || !this->parseValue(value))
+                {
+                    return false;
+                }
+                if (values.find(key) == values.end())
+                {
+                    keys.emplace_back(key);
+                }
+                values[key] = std::move(value);
+                if (this->peek() == ',')
+                {
+                    ++_pos;
+                    continue;
+                }
+                return this->expect('}') && this->atEnd();
+            }
+        }
+        /// @brief the position of the first error, for the message
+        std::size_t pos() const { return _pos; }
+    private:
+        /// @brief skip the white space
+        /// @return whether some text is left
+        bool skipSpace()
+        {
+            while (_pos < _text.size() && std::isspace(static_cast<unsigned char>(_text[_pos])))
+            {
+                ++_pos;
+            }
+            return _pos < _text.size();
+        }
+        char peek() { return this->skipSpace() ? _text[_pos] : '\0'; }
+        bool expect(char c)
+        {
+            if (this->peek() != c)
+            {
+                return false;
+            }
+            ++_pos;
+            return true;
+        }
+        bool atEnd() { return !this->skipSpace(); }
+        /// @brief parse a string, at its opening quote
+        bool parseString(std::string &str)
+        {
+            if (_text[_pos] != '"')
+            {
+                return false;
+            }
+            for (++_pos; _pos < _text.size(); ++_pos)
+            {
+                char c = _text[_pos];
+                if (c == '"')
+                {
+                    ++_pos;
+                    return true;
+                }
+                if (c != '\\')
+                {
+                    str += c;
+                    continue;
+                }
+                if (++_pos == _text.size())
+                {
+                    return false;
+                }
+                switch (_text[_pos])
+                {
+                    case 'n': str += '\n'; break;
+                    case 't': str += '\t'; break;
+                    case 'r': str += '\r'; break;
+                    case 'b': str += '\b'; break;
+                    case 'f': str += '\f'; break;
+                    case 'u':
+                    {
+                        if (_pos + 4 >= _text.size() || !std::all_of(_text.begin() + _pos + 1, _text.begin() + _pos + 5, [](char h) { return std::isxdigit(static_cast<unsigned char>(h)); }))
+                        {
+                            return false;
+                        }
+                        unsigned code = std::strtoul(_text.substr(_pos + 1, 4).c_str(), nullptr, 16);
+                        _pos += 4;
+                        // UTF-8 of a code point of the basic plane
+                        if (code < 0x80)
+                        {
+                            str += static_cast<char>(code);
+                        }
+                        else if (code < 0x800)
+                        {
+                            str += static_cast<char>(0xC0 | (code >> 6));
+                            str += static_cast<char>(0x80 | (code & 0x3F));
+                        }
+                        else
+                        {
+                            str += static_cast<char>(0xE0 | (code >> 12));
+                            str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                            str += static_cast<char>(0x80 | (code & 0x3F));
+                        }
+                        break;
+                    }
+                    default: str += _text[_pos]; break;
+                }
+            }
+            return false;
+        }
+        /// @brief skip a value nested in an array or an object
+        bool skipValue()
+        {
+            Value value;
+            return this->parseValue(value);
+        }
+        /// @brief parse a value, keeping its text
+        bool parseValue(Value &value)
+        {
+            if (!this->skipSpace())
+            {
+                return false;
+            }
+            const std::size_t start = _pos;
+            const char c = _text[_pos];
+            bool success = true;
+            if (c == '"')
+            {
+                value.kind = Kind::STRING;
+                success = this->parseString(value.str);
+            }
+            else if (c == '[')
+            {
+                ++_pos;
+                value.kind = Kind::STRINGS;
+                if (this->peek() == ']')
+                {
+                    ++_pos;
+                }
+                else
+                {
+                    while (success)
+                    {
+                        Value item;
+                        success = this->parseValue(item);
+                        if (item.kind == Kind::STRING)
+                        {
+                            value.strs.emplace_back(std::move(item.str));
+                        }
+                        else
+                        {
+                            value.kind = Kind::OTHER;
+                        }
+                        if (success && this->peek() == ',')
+                        {
+                            ++_pos;
+                            continue;
+                        }
+                        success = success && this->expect(']');
+                        break;
+                    }
+                }
+            }
+            else if (c == '{')
+            {
+                ++_pos;
+                value.kind = Kind::OTHER;
+                if (this->peek() == '}')
+                {
+                    ++_pos;
+                }
+                else
+                {
+                    while (success)
+                    {
+                        std::string key;
+                        success = this->skipSpace() && this->parseString(key) && this->expect(':') && this->skipValue();
+                        if (success && this->peek() == ',')
+                        {
+                            ++_pos;
+                            continue;
+                        }
+                        success = success && this->expect('}');
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                // A literal or a number, up to the next delimiter
+                while (_pos < _text.size() && _text[_pos] != ',' && _text[_pos] != '}' && _text[_pos] != ']' && !std::isspace(static_cast<unsigned char>(_text[_pos])))
+                {
+                    ++_pos;
+                }
+                const std::string word = _text.substr(start, _pos - start);
+                if (word == "true" || word == "false")
+                {
+                    value.kind = Kind::BOOLEAN;
+                    value.boolean = word == "true";
+                }
+                else if (word == "null")
+                {
+                    value.kind = Kind::NUL;
+                }
+                else
+                {
+                    value.kind = Kind::NUMBER;
+                    char *end = nullptr;
+                    std::strtod(word.c_str(), &end);
+                    success = !word.empty() && *end == '\0';
+                }
+            }
+            value.json = _text.substr(start, _pos - start);
+            return success;
+        }
+    private:
+        const std::string &_text; ///< The text of the file
+        std::size_t _pos = 0; ///< The current position
+};
+
+bool RunSpec::read(const std::string &fileName)
+{
+    std::ifstream in(fileName);
+    if (!in.is_open())
+    {
+        ERR("RunSpec: cannot open %s \n", fileName.c_str());
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    const std::string text = buffer.str();
+    _keys.clear();
+    _values.clear();
+    Parser parser(text);
+    if (!parser.parseObject(_keys, _values))
+    {
+        ERR("RunSpec: %s is not a JSON object, at byte %lu \n", fileName.c_str(), static_cast<unsigned long>(parser.pos()));
+        _keys.clear();
+        _values.clear();
+        return false;
+    }
+    return true;
+}
+
+bool RunSpec::write(const std::string &fileName) const
+{
+    std::ofstream out(fileName);
+    if (!out.is_open())
+    {
+        ERR("RunSpec: cannot write %s \n", fileName.c_str());
+        return false;
+    }
+    out << "{";
+    for (IndexType idx = 0; idx < _keys.size(); ++idx)
+    {
+        out << (idx == 0 ? "\n    " : ",\n    ") << quote(_keys[idx]) << " : " << _values.at(_keys[idx]).json;
+    }
+    out << "\n}\n";
+    return out.good();
+}
+
+bool RunSpec::has(const std::string &key) const
+{
+    auto it = _values.find(key);
+    return it != _values.end() && it->second.kind != Kind::NUL;
+}
+
+std::string RunSpec::string(const std::string &key, const std::string &defaultValue) const
+{
+    auto it = _values.find(key);
+    return it != _values.end() && it->second.kind == Kind::STRING ? it->second.str : defaultValue;
+}
+
+bool RunSpec::boolean(const std::string &key, bool defaultValue) const
+{
+    auto it = _values.find(key);
+    return it != _values.end() && it->second.kind == Kind::BOOLEAN ? it->second.boolean : defaultValue;
+}
+
+std::vector<std::string> RunSpec::strings(const std::string &key, const std::vector<std::string> &defaultValue) const
+{
+    auto it = _values.find(key);
+    return it != _values.end() && it->second.kind == Kind::STRINGS ? it->second.strs : defaultValue;
+}
+
+void RunSpec::setJson(const std::string &key, const std::string &json)
+{
+    // Parsed as the only value of an object
+    const std::string text = "{\"\" : " + json + "}";
+    Parser parser(text);
+    std::vector<std::string> keys;
+    std::unordered_map<std::string, Value> values;
+    AssertMsg(parser.parseObject(keys, values), "RunSpec::setJson: %s is not a JSON value \n", json.c_str());
+    if (_values.find(key) == _values.end())
+    {
+        _keys.emplace_back(key);
+    }
+    _values[key] = std::move(values[""]);
+}
+
+std::string RunSpec::quote(const std::string &str)
+{
+    std::string result = "\"";
+    for (char c : str)
+    {
+        switch (c)
+        {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            case '\r': result += "\\r"; break;
+            default: result += c; break;
+        }
+    }
+    return result + "\"";
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,73 @@
+/**
+ * @file RunSpec.h
+ * @brief The JSON run specification of the flow, as Params.py reads it
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_RUN_SPEC_H_
+#define MAGICAL_FLOW_RUN_SPEC_H_
+
+#include <unordered_map>
+#include <vector>
+#include "global/global.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::RunSpec
+/// @brief The top-level keys of a JSON run specification, e.g. examples/ota1/ota1.json.
+/// The strings, booleans and arrays of strings are read, and every value is kept as its JSON text, so that the specification can be written back with some keys replaced
+class RunSpec
+{
+    public:
+        /// @brief default constructor
+        explicit RunSpec() = default;
+        /// @brief read a specification
+        /// @param the JSON file, an object
+        /// @return whether the file is read and valid JSON
+        bool read(const std::string &fileName);
+        /// @brief write the specification, with the keys in the order they were read then set
+        /// @param the output file
+        /// @return whether the file is written
+        bool write(const std::string &fileName) const;
+        /// @brief whether a key is set to a value other than null
+        bool has(const std::string &key) const;
+        /// @brief get a string value
+        /// @param first: the key
+        /// @param second: returned if the key is not a string
+        std::string string(const std::string &key, const std::string &defaultValue = "") const;
+        /// @brief get a boolean value
+        /// @param first: the key
+        /// @param second: returned if the key is not a boolean
+        bool boolean(const std::string &key, bool defaultValue) const;
+        /// @brief get an array of strings
+        /// @param first: the key
+        /// @param second: returned if the key is not an array of strings
+        std::vector<std::string> strings(const std::string &key, const std::vector<std::string> &defaultValue) const;
+        /// @brief set a key, replacing its value
+        /// @param first: the key
+        /// @param second: the JSON text of the value, e.g. from quote()
+        void setJson(const std::string &key, const std::string &json);
+        /// @brief quote a string as JSON
+        static std::string quote(const std::string &str);
+    private:
+        /// @brief the kind of a value
+        enum class Kind : Byte { NUL, BOOLEAN, NUMBER, STRING, STRINGS, OTHER };
+        /// @brief a top-level value
+        struct Value
+        {
+            Kind kind = Kind::NUL; ///< The kind
+            std::string json; ///< The JSON text
+            std::string str; ///< The string of a STRING
+            bool boolean = false; ///< The value of a BOOLEAN
+            std::vector<std::string> strs; ///< The strings of a STRINGS
+        };
+        /// @brief the recursive descent over the text of the file
+        class Parser;
+    private:
+        std::vector<std::string> _keys; ///< The keys in order
+        std::unordered_map<std::string, Value> _values; ///< The values by key
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_RUN_SPEC_H_
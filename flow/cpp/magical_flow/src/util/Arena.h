@@ -0,0 +1,157 @@
+/**
+ * @file Arena.h
+ * @brief A pooled arena for the many small vectors of the circuit graphs, and an allocator drawing from it
+ * @date 10/14/2026
+ */
+
+#ifndef ZKUTIL_ARENA_H_
+#define ZKUTIL_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+#include "global/namespace.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::PoolArena
+/// @brief Serve the allocations from large chunks. A block up to MAX_POOLED_BYTES is rounded up to a power of two,
+/// and a freed block is kept in the free list of its size, so that a growing vector reuses the blocks released by the others.
+/// Larger blocks go to the global heap. The memory is returned only when the arena is destroyed
+class PoolArena
+{
+    public:
+        static constexpr std::size_t MIN_BLOCK_BYTES = 16; ///< The smallest block
+        static constexpr std::size_t MAX_POOLED_BYTES = 4096; ///< The largest pooled block
+        static constexpr std::size_t CHUNK_BYTES = 1 << 20; ///< The size of a chunk
+        /// @brief default constructor
+        explicit PoolArena() = default;
+        PoolArena(const PoolArena &) = delete;
+        PoolArena & operator=(const PoolArena &) = delete;
+        /// @brief allocate a block
+        /// @param the number of bytes
+        /// @return the block, aligned for any fundamental type
+        void * allocate(std::size_t bytes)
+        {
+            if (bytes > MAX_POOLED_BYTES)
+            {
+                return ::operator new(bytes);
+            }
+            std::size_t sizeClass = classOf(bytes);
+            std::lock_guard<std::mutex> lock(_mutex);
+            FreeBlock *&head = _freeLists[sizeClass];
+            if (head != nullptr)
+            {
+                FreeBlock *block = head;
+                head = block->next;
+                return block;
+            }
+            std::size_t blockBytes = MIN_BLOCK_BYTES << sizeClass;
+            if (_chunkUsed + blockBytes > CHUNK_BYTES || _chunks.empty())
+            {
+                _chunks.emplace_back(new char[CHUNK_BYTES]);
+                _chunkUsed = 0;
+            }
+            void *block = _chunks.back().get() + _chunkUsed;
+            _chunkUsed += blockBytes;
+            _reservedBytes += blockBytes;
+            return block;
+        }
+        /// @brief release a block allocated by this arena
+        /// @param first: the block
+        /// @param second: the number of bytes it was allocated with
+        void deallocate(void *ptr, std::size_t bytes)
+        {
+            if (bytes > MAX_POOLED_BYTES)
+            {
+                ::operator delete(ptr);
+                return;
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            FreeBlock *block = static_cast<FreeBlock *>(ptr);
+            FreeBlock *&head = _freeLists[classOf(bytes)];
+            block->next = head;
+            head = block;
+        }
+        /// @brief get the number of bytes handed out from the chunks, including the blocks on the free lists
+        /// @return the number of pooled bytes
+        std::size_t reservedBytes() const { return _reservedBytes; }
+        /// @brief get the number of chunks
+        /// @return the number of chunks
+        std::size_t numChunks() const { return _chunks.size(); }
+    private:
+        struct FreeBlock { FreeBlock *next; };
+        static constexpr std::size_t NUM_CLASSES = 9; ///< 16, 32, ..., 4096 bytes
+        /// @brief the size class of a pooled block
+        static std::size_t classOf(std::size_t bytes)
+        {
+            std::size_t sizeClass = 0;
+            while ((MIN_BLOCK_BYTES << sizeClass) < bytes)
+            {
+                ++sizeClass;
+            }
+            return sizeClass;
+        }
+    private:
+        std::vector<std::unique_ptr<char[]>> _chunks; ///< The chunks
+        std::size_t _chunkUsed = 0; ///< The bytes used in the last chunk
+        std::size_t _reservedBytes = 0; ///< The bytes handed out from the chunks
+        FreeBlock *_freeLists[NUM_CLASSES] = {}; ///< The freed blocks of each size class
+        std::mutex _mutex; ///< The flow may build the circuits from several threads
+};
+
+/// @class MAGICAL_FLOW::ArenaAllocator
+/// @brief A standard allocator drawing from a PoolArena, or from the global heap if there is no arena.
+/// The arena must outlive the containers using it. It follows the containers on move and swap
+template<typename T>
+class ArenaAllocator
+{
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+        /// @brief the allocator of the global heap
+        ArenaAllocator() noexcept = default;
+        /// @brief the allocator of an arena
+        /// @param the arena. nullptr for the global heap
+        ArenaAllocator(PoolArena *arena) noexcept : _arena(arena) {}
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) noexcept : _arena(other.arena()) {}
+        T * allocate(std::size_t num)
+        {
+            if (_arena == nullptr)
+            {
+                return static_cast<T *>(::operator new(num * sizeof(T)));
+            }
+            return static_cast<T *>(_arena->allocate(num * sizeof(T)));
+        }
+        void deallocate(T *ptr, std::size_t num) noexcept
+        {
+            if (_arena == nullptr)
+            {
+                ::operator delete(ptr);
+                return;
+            }
+            _arena->deallocate(ptr, num * sizeof(T));
+        }
+        /// @brief get the arena
+        /// @return the arena. nullptr for the global heap
+        PoolArena * arena() const noexcept { return _arena; }
+    private:
+        PoolArena *_arena = nullptr; ///< The arena
+};
+
+template<typename T, typename U>
+inline bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) { return lhs.arena() == rhs.arena(); }
+template<typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) { return lhs.arena() != rhs.arena(); }
+
+/// @brief a vector allocated from an arena
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+PROJECT_NAMESPACE_END
+
+#endif //ZKUTIL_ARENA_H_
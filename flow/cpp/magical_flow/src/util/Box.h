@@ -1,8 +1,11 @@
 #ifndef __BOX_H__
 #define __BOX_H__
 
+#include <algorithm>
 #include <string>
 #include <sstream>
+#include <utility>
+#include <vector>
 #include "global/namespace.h"
 #include "XY.h"
 
@@ -250,6 +253,103 @@ namespace klib {
         }
         return false;
     }
+
+    /// @brief replace rectangles with disjoint rectangles covering the same union, usually far fewer when the rectangles abut or overlap.
+    /// Scanline: the union of each slab between two consecutive y coordinates is cut into maximal x spans,
+    /// and a span continues the rectangle of the slab below if it has exactly the same x extent, as boxUnionRectangle would merge them
+    /// @param the rectangles. The empty ones are kept as they are, after the merged ones
+    template<typename T>
+    inline void boxUnionRectangles(std::vector<Box<T>> &rects)
+    {
+        using Span = std::pair<T, T>;
+        std::vector<Box<T>> solids, empties;
+        solids.reserve(rects.size());
+        for (const auto &rect : rects)
+        {
+            if (rect.xLo() < rect.xHi() && rect.yLo() < rect.yHi()) { solids.emplace_back(rect); }
+            else { empties.emplace_back(rect); }
+        }
+        if (solids.size() < 2)
+        {
+            return;
+        }
+        std::sort(solids.begin(), solids.end(), [](const Box<T> &lhs, const Box<T> &rhs) { return lhs.yLo() < rhs.yLo(); });
+        std::vector<T> ys;
+        ys.reserve(2 * solids.size());
+        for (const auto &rect : solids)
+        {
+            ys.emplace_back(rect.yLo());
+            ys.emplace_back(rect.yHi());
+        }
+        std::sort(ys.begin(), ys.end());
+        ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+        std::vector<Box<T>> result;
+        std::vector<std::size_t> active; // The rectangles crossing the current slab
+        std::vector<Span> spans, openSpans; // The spans of the current slab, and those of the rectangles still open from the slab below
+        std::vector<T> openStarts, nextStarts; // The lower y of the open rectangles
+        std::size_t nextRect = 0;
+        for (std::size_t slabIdx = 0; slabIdx + 1 < ys.size(); ++slabIdx)
+        {
+            const T y = ys[slabIdx];
+            while (nextRect < solids.size() && solids[nextRect].yLo() <= y)
+            {
+                active.emplace_back(nextRect++);
+            }
+            active.erase(std::remove_if(active.begin(), active.end(), [&](std::size_t idx) { return solids[idx].yHi() <= y; }), active.end());
+            // The maximal spans, the touching ones joined
+            spans.clear();
+            for (std::size_t idx : active)
+            {
+                spans.emplace_back(solids[idx].xLo(), solids[idx].xHi());
+            }
+            std::sort(spans.begin(), spans.end());
+            std::size_t numSpans = 0;
+            for (const auto &span : spans)
+            {
+                if (numSpans > 0 && span.first <= spans[numSpans - 1].second)
+                {
+                    spans[numSpans - 1].second = std::max(spans[numSpans - 1].second, span.second);
+                }
+                else
+                {
+                    spans[numSpans++] = span;
+                }
+            }
+            spans.resize(numSpans);
+            // Continue the open rectangles of the same extent, and close the others at y
+            nextStarts.clear();
+            std::size_t openIdx = 0;
+            for (const auto &span : spans)
+            {
+                while (openIdx < openSpans.size() && openSpans[openIdx] < span)
+                {
+                    result.emplace_back(openSpans[openIdx].first, openStarts[openIdx], openSpans[openIdx].second, y);
+                    ++openIdx;
+                }
+                if (openIdx < openSpans.size() && openSpans[openIdx] == span)
+                {
+                    nextStarts.emplace_back(openStarts[openIdx++]);
+                }
+                else
+                {
+                    nextStarts.emplace_back(y);
+                }
+            }
+            for (; openIdx < openSpans.size(); ++openIdx)
+            {
+                result.emplace_back(openSpans[openIdx].first, openStarts[openIdx], openSpans[openIdx].second, y);
+            }
+            openSpans.swap(spans);
+            openStarts.swap(nextStarts);
+        }
+        for (std::size_t openIdx = 0; openIdx < openSpans.size(); ++openIdx)
+        {
+            result.emplace_back(openSpans[openIdx].first, openStarts[openIdx], openSpans[openIdx].second, ys.back());
+        }
+        result.insert(result.end(), empties.begin(), empties.end());
+        rects.swap(result);
+    }
 }
 
 PROJECT_NAMESPACE_END
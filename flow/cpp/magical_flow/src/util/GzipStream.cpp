@@ -0,0 +1,456 @@
+/**
+ * @file GzipStream.cpp
+ * @brief Gzip file streams which compress and decompress in a background thread
+ * @date 10/14/2026
+ */
+
+#include "util/GzipStream.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <zlib.h>
+#include "global/global.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief the largest number of chunks waiting for the background thread
+    constexpr std::size_t MAX_QUEUED_CHUNKS = 4;
+}
+
+bool MfGzip::isGzipFileName(const std::string &fileName)
+{
+    return fileName.size() > 3 && fileName.compare(fileName.size() - 3, 3, ".gz") == 0;
+}
+
+/*------------------------------*/
+/* Output                       */
+/*------------------------------*/
+
+/// @brief the put area is the chunk being filled. Full chunks are queued for the compressing thread, which hands them back for reuse
+class GzipOFStream::Buffer : public std::streambuf
+{
+    public:
+        explicit Buffer(const std::string &fileName, int level, std::size_t chunkSize) : _chunkSize(std::max<std::size_t>(chunkSize, 4096))
+        {
+            const std::string mode = "wb" + std::to_string(std::min(std::max(level, 0), 9));
+            _file = gzopen(fileName.c_str(), mode.c_str());
+            if (_file == nullptr)
+            {
+                return;
+            }
+            gzbuffer(_file, static_cast<unsigned>(_chunkSize));
+            _chunk.resize(_chunkSize);
+            this->setp(_chunk.data(), _chunk.data() + _chunk.size());
+            _worker = std::thread([this]() { this->run(); });
+        }
+        ~Buffer() override { this->close(); }
+        bool isOpen() const { return _file != nullptr; }
+        std::uint64_t numBytesIn() const { return _numBytesIn + static_cast<std::uint64_t>(this->pptr() - this->pbase()); }
+        bool close()
+        {
+            if (_file == nullptr)
+            {
+                return false;
+            }
+            this->handOver();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _closing = true;
+            }
+            _ready.notify_all();
+            _worker.join();
+            bool success = gzclose(_file) == Z_OK && !_failed;
+            _file = nullptr;
+            this->setp(nullptr, nullptr);
+            return success;
+        }
+    protected:
+        int_type overflow(int_type ch) override
+        {
+            if (_file == nullptr || _failed)
+            {
+                return traits_type::eof();
+            }
+            this->handOver();
+            if (!traits_type::eq_int_type(ch, traits_type::eof()))
+            {
+                *this->pptr() = traits_type::to_char_type(ch);
+                this->pbump(1);
+            }
+            return traits_type::not_eof(ch);
+        }
+        int sync() override
+        {
+            if (_file == nullptr)
+            {
+                return -1;
+            }
+            this->handOver();
+            std::unique_lock<std::mutex> lock(_mutex);
+            _drained.wait(lock, [&]() { return _queue.empty() && !_busy; });
+            return _failed ? -1 : 0;
+        }
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+        {
+            // Only tellp
+            if (off == 0 && dir == std::ios_base::cur && (which & std::ios_base::out))
+            {
+                return pos_type(static_cast<off_type>(this->numBytesIn()));
+            }
+            return pos_type(off_type(-1));
+        }
+    private:
+        /// @brief queue the bytes of the put area and take a spare chunk
+        void handOver()
+        {
+            std::size_t numBytes = this->pptr() - this->pbase();
+            if (numBytes == 0)
+            {
+                return;
+            }
+            _numBytesIn += numBytes;
+            _chunk.resize(numBytes);
+            std::vector<char> next;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _drained.wait(lock, [&]() { return _queue.size() < MAX_QUEUED_CHUNKS; });
+                _queue.emplace_back(std::move(_chunk));
+                if (!_spares.empty())
+                {
+                    next = std::move(_spares.back());
+                    _spares.pop_back();
+                }
+            }
+            _ready.notify_one();
+            next.resize(_chunkSize);
+            _chunk.swap(next);
+            this->setp(_chunk.data(), _chunk.data() + _chunk.size());
+        }
+        /// @brief the loop of the compressing thread
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (true)
+            {
+                _ready.wait(lock, [&]() { return _closing || !_queue.empty(); });
+                if (_queue.empty())
+                {
+                    break;
+                }
+                std::vector<char> chunk = std::move(_queue.front());
+                _queue.pop_front();
+                _busy = true;
+                lock.unlock();
+                _drained.notify_all();
+                if (!_failed && gzwrite(_file, chunk.data(), static_cast<unsigned>(chunk.size())) != static_cast<int>(chunk.size()))
+                {
+                    _failed = true;
+                }
+                lock.lock();
+                _busy = false;
+                _spares.emplace_back(std::move(chunk));
+                _drained.notify_all();
+            }
+        }
+    private:
+        gzFile _file = nullptr; ///< The gzip file
+        const std::size_t _chunkSize; ///< The bytes of a chunk
+        std::vector<char> _chunk; ///< The chunk being filled, the put area
+        std::uint64_t _numBytesIn = 0; ///< The bytes handed over
+        std::deque<std::vector<char>> _queue; ///< The chunks to compress
+        std::vector<std::vector<char>> _spares; ///< The chunks compressed, to be filled again
+        std::mutex _mutex; ///< The lock of the queue, the spares and the flags
+        std::condition_variable _ready; ///< Signaled when a chunk is queued or the stream closes
+        std::condition_variable _drained; ///< Signaled when a chunk is taken or written
+        std::thread _worker; ///< The compressing thread
+        bool _closing = false; ///< Whether the stream closes after the queued chunks
+        bool _busy = false; ///< Whether the compressing thread is writing a chunk
+        std::atomic<bool> _failed{false}; ///< Whether a write failed
+};
+
+GzipOFStream::GzipOFStream(const std::string &fileName, int level, std::size_t chunkSize)
+    : std::ostream(nullptr), _buffer(new Buffer(fileName, level, chunkSize))
+{
+    this->rdbuf(_buffer.get());
+    if (!_buffer->isOpen())
+    {
+        this->setstate(std::ios_base::failbit);
+    }
+}
+
+GzipOFStream::~GzipOFStream()
+{
+    _buffer->close();
+}
+
+bool GzipOFStream::isOpen() const
+{
+    return _buffer->isOpen();
+}
+
+bool GzipOFStream::close()
+{
+    bool success = _buffer->close();
+    if (!success)
+    {
+        this->setstate(std::ios_base::failbit);
+    }
+    return success;
+}
+
+std::uint64_t GzipOFStream::numBytesIn() const
+{
+    return _buffer->numBytesIn();
+}
+
+/*------------------------------*/
+/* Input                        */
+/*------------------------------*/
+
+/// @brief the get area is the chunk being read. The decompressing thread queues the chunks ahead of the reader, and an empty chunk at the end
+class GzipIFStream::Buffer : public std::streambuf
+{
+    public:
+        explicit Buffer(const std::string &fileName, std::size_t chunkSize) : _chunkSize(std::max<std::size_t>(chunkSize, 4096))
+        {
+            _file = gzopen(fileName.c_str(), "rb");
+            if (_file == nullptr)
+            {
+                return;
+            }
+            gzbuffer(_file, static_cast<unsigned>(_chunkSize));
+            this->setg(nullptr, nullptr, nullptr);
+            _worker = std::thread([this]() { this->run(); });
+        }
+        ~Buffer() override
+        {
+            if (_file == nullptr)
+            {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+            }
+            _taken.notify_all();
+            _worker.join();
+            if (!_closed)
+            {
+                gzclose_r(_file);
+            }
+        }
+        bool isOpen() const { return _file != nullptr; }
+        bool valid() const { return _file != nullptr && !_failed; }
+    protected:
+        int_type underflow() override
+        {
+            if (this->gptr() < this->egptr())
+            {
+                return traits_type::to_int_type(*this->gptr());
+            }
+            if (_file == nullptr || _atEnd)
+            {
+                return traits_type::eof();
+            }
+            std::vector<char> next;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _filled.wait(lock, [&]() { return !_queue.empty(); });
+                next = std::move(_queue.front());
+                _queue.pop_front();
+                if (!_chunk.empty())
+                {
+                    _spares.emplace_back(std::move(_chunk));
+                }
+            }
+            _taken.notify_one();
+            _chunk.swap(next);
+            if (_chunk.empty())
+            {
+                _atEnd = true;
+                this->setg(nullptr, nullptr, nullptr);
+                return traits_type::eof();
+            }
+            this->setg(_chunk.data(), _chunk.data(), _chunk.data() + _chunk.size());
+            return traits_type::to_int_type(*this->gptr());
+        }
+    private:
+        /// @brief the loop of the decompressing thread
+        void run()
+        {
+            while (true)
+            {
+                std::vector<char> chunk;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _taken.wait(lock, [&]() { return _stopping || _queue.size() < MAX_QUEUED_CHUNKS; });
+                    if (_stopping)
+                    {
+                        return;
+                    }
+                    if (!_spares.empty())
+                    {
+                        chunk = std::move(_spares.back());
+                        _spares.pop_back();
+                    }
+                }
+                chunk.resize(_chunkSize);
+                int numBytes = gzread(_file, chunk.data(), static_cast<unsigned>(chunk.size()));
+                // A truncated stream is not an error of gzread: it returns the bytes up to the cut and leaves Z_BUF_ERROR
+                int errnum = Z_OK;
+                gzerror(_file, &errnum);
+                if (numBytes < 0 || errnum != Z_OK)
+                {
+                    _failed = true;
+                }
+                chunk.resize(std::max(numBytes, 0));
+                bool last = numBytes <= 0 || _failed;
+                if (last)
+                {
+                    // The trailer is checked when closing
+                    _closed = true;
+                    if (gzclose_r(_file) != Z_OK)
+                    {
+                        _failed = true;
+                    }
+                }
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    bool hasBytes = !chunk.empty();
+                    _queue.emplace_back(std::move(chunk));
+                    if (last && hasBytes)
+                    {
+                        // The bytes before a failure are kept, and the empty chunk still marks the end
+                        _queue.emplace_back();
+                    }
+                }
+                _filled.notify_one();
+                if (last)
+                {
+                    return;
+                }
+            }
+        }
+    private:
+        gzFile _file = nullptr; ///< The gzip file
+        const std::size_t _chunkSize; ///< The bytes of a chunk
+        std::vector<char> _chunk; ///< The chunk being read, the get area
+        bool _atEnd = false; ///< Whether the empty chunk at the end is reached
+        std::deque<std::vector<char>> _queue; ///< The decompressed chunks
+        std::vector<std::vector<char>> _spares; ///< The chunks read, to be filled again
+        std::mutex _mutex; ///< The lock of the queue, the spares and the flags
+        std::condition_variable _filled; ///< Signaled when a chunk is queued
+        std::condition_variable _taken; ///< Signaled when a chunk is taken or the stream closes
+        std::thread _worker; ///< The decompressing thread
+        bool _stopping = false; ///< Whether the stream is destroyed
+        bool _closed = false; ///< Whether the decompressing thread closed the file at the end of the stream
+        std::atomic<bool> _failed{false}; ///< Whether the decompression failed
+};
+
+GzipIFStream::GzipIFStream(const std::string &fileName, std::size_t chunkSize)
+    : std::istream(nullptr), _buffer(new Buffer(fileName, chunkSize))
+{
+    this->rdbuf(_buffer.get());
+    if (!_buffer->isOpen())
+    {
+        this->setstate(std::ios_base::failbit);
+    }
+}
+
+GzipIFStream::~GzipIFStream() = default;
+
+bool GzipIFStream::isOpen() const
+{
+    return _buffer->isOpen();
+}
+
+bool GzipIFStream::valid() const
+{
+    return _buffer->valid();
+}
+
+/*------------------------------*/
+/* Files                        */
+/*------------------------------*/
+
+PlainFile::PlainFile(const std::string &fileName)
+{
+    if (!MfGzip::isGzipFileName(fileName))
+    {
+        _path = fileName;
+        _valid = true;
+        return;
+    }
+    GzipIFStream in(fileName);
+    if (!in.isOpen())
+    {
+        ERR("PlainFile: cannot open %s \n", fileName.c_str());
+        return;
+    }
+    _path = MfGzip::makeTempFile(".gds");
+    if (_path.empty())
+    {
+        ERR("PlainFile: cannot create a temporary file for %s \n", fileName.c_str());
+        return;
+    }
+    _isTemp = true;
+    std::ofstream out(_path, std::ios::out | std::ios::binary);
+    out << in.rdbuf();
+    out.close();
+    _valid = out.good() && in.valid();
+    if (!_valid)
+    {
+        ERR("PlainFile: cannot decompress %s \n", fileName.c_str());
+    }
+}
+
+PlainFile::~PlainFile()
+{
+    if (_isTemp)
+    {
+        std::remove(_path.c_str());
+    }
+}
+
+bool MfGzip::compressFile(const std::string &plainFileName, const std::string &gzipFileName, int level)
+{
+    std::ifstream in(plainFileName, std::ios::in | std::ios::binary);
+    if (!in.good())
+    {
+        return false;
+    }
+    GzipOFStream out(gzipFileName, level);
+    if (!out.isOpen())
+    {
+        return false;
+    }
+    out << in.rdbuf();
+    return out.close();
+}
+
+std::string MfGzip::makeTempFile(const std::string &suffix)
+{
+    const char *dir = std::getenv("TMPDIR");
+    std::string pattern = std::string(dir != nullptr && dir[0] != '\0' ? dir : "/tmp") + "/magical_XXXXXX" + suffix;
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.emplace_back('\0');
+    int fd = mkstemps(name.data(), static_cast<int>(suffix.size()));
+    if (fd < 0)
+    {
+        return "";
+    }
+    ::close(fd);
+    return std::string(name.data());
+}
+
+PROJECT_NAMESPACE_END
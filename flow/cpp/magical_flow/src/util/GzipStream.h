@@ -0,0 +1,111 @@
+/**
+ * @file GzipStream.h
+ * @brief Gzip file streams which compress and decompress in a background thread
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_GZIP_STREAM_H_
+#define MAGICAL_FLOW_GZIP_STREAM_H_
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include "global/namespace.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace MfGzip
+{
+    constexpr int DEFAULT_LEVEL = 6; ///< The default compression level of zlib
+    constexpr std::size_t DEFAULT_CHUNK_SIZE = 1 << 18; ///< The bytes handed to the background thread at once
+
+    /// @brief whether a file name has the .gz suffix
+    bool isGzipFileName(const std::string &fileName);
+}
+
+/// @class MAGICAL_FLOW::GzipOFStream
+/// @brief an output stream writing a gzip file. The written bytes are handed over in chunks to a thread which compresses and writes them,
+/// so that encoding the records and compressing them overlap. At most a few chunks are queued, which bounds the memory
+class GzipOFStream : public std::ostream
+{
+    public:
+        /// @brief constructor
+        /// @param first: the file name
+        /// @param second: the compression level, 1 to 9. 0 stores the bytes uncompressed in the gzip format
+        /// @param third: the bytes of a chunk
+        explicit GzipOFStream(const std::string &fileName, int level = MfGzip::DEFAULT_LEVEL, std::size_t chunkSize = MfGzip::DEFAULT_CHUNK_SIZE);
+        /// @brief destructor. Closes the file
+        ~GzipOFStream() override;
+        /// @brief whether the file is open
+        bool isOpen() const;
+        /// @brief write the pending bytes and close the file
+        /// @return whether all the bytes are written
+        bool close();
+        /// @brief get the number of uncompressed bytes written so far
+        std::uint64_t numBytesIn() const;
+    private:
+        class Buffer;
+        std::unique_ptr<Buffer> _buffer; ///< The stream buffer and the compressing thread
+};
+
+/// @class MAGICAL_FLOW::GzipIFStream
+/// @brief an input stream reading a gzip file, or a plain file as it is. A thread reads and decompresses the chunks ahead of the reader
+class GzipIFStream : public std::istream
+{
+    public:
+        /// @brief constructor
+        /// @param first: the file name
+        /// @param second: the bytes of a chunk
+        explicit GzipIFStream(const std::string &fileName, std::size_t chunkSize = MfGzip::DEFAULT_CHUNK_SIZE);
+        /// @brief destructor
+        ~GzipIFStream() override;
+        /// @brief whether the file is open
+        bool isOpen() const;
+        /// @brief whether the file could be decompressed up to its end: false for a corrupt or truncated stream or a bad trailer. Meaningful after reading to the end
+        bool valid() const;
+    private:
+        class Buffer;
+        std::unique_ptr<Buffer> _buffer; ///< The stream buffer and the decompressing thread
+};
+
+/// @class MAGICAL_FLOW::PlainFile
+/// @brief the plain content of a file for the readers which only take file names: the file itself, or a temporary decompressed copy of a .gz file which is removed with this object
+class PlainFile
+{
+    public:
+        /// @brief constructor
+        /// @param the file name
+        explicit PlainFile(const std::string &fileName);
+        /// @brief destructor. Removes the temporary copy
+        ~PlainFile();
+        PlainFile(const PlainFile &) = delete;
+        PlainFile & operator=(const PlainFile &) = delete;
+        /// @brief whether the plain content is available
+        bool valid() const { return _valid; }
+        /// @brief the name of the plain file to read
+        const std::string & path() const { return _path; }
+    private:
+        std::string _path; ///< The file to read
+        bool _isTemp = false; ///< Whether the file is a temporary copy
+        bool _valid = false; ///< Whether the file is available
+};
+
+namespace MfGzip
+{
+    /// @brief compress a file into a gzip file
+    /// @param first: the plain file
+    /// @param second: the gzip file
+    /// @param third: the compression level
+    /// @return whether successful
+    bool compressFile(const std::string &plainFileName, const std::string &gzipFileName, int level = DEFAULT_LEVEL);
+    /// @brief make a temporary file name
+    /// @param the suffix of the name
+    /// @return the name of a new empty file in the temporary directory, empty if it cannot be created
+    std::string makeTempFile(const std::string &suffix);
+}
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_GZIP_STREAM_H_
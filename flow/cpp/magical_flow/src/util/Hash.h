@@ -0,0 +1,49 @@
+/**
+ * @file Hash.h
+ * @brief FNV-1a digests of the values describing the circuits, for detecting changes and bucketing
+ * @date 10/14/2026
+ */
+
+#ifndef ZKUTIL_HASH_H_
+#define ZKUTIL_HASH_H_
+
+#include <cstdint>
+#include <string>
+#include "global/namespace.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace MfHash
+{
+    /// @brief the digest of nothing
+    constexpr std::uint64_t FNV_OFFSET = 14695981039346656037ull;
+    /// @brief the FNV-1a prime
+    constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+    /// @brief fold the eight bytes of a value into a digest
+    /// @param first: the digest
+    /// @param second: the value
+    inline void mix(std::uint64_t &digest, std::uint64_t value)
+    {
+        for (int byte = 0; byte < 8; ++byte)
+        {
+            digest ^= (value >> (8 * byte)) & 0xff;
+            digest *= FNV_PRIME;
+        }
+    }
+    /// @brief fold the characters of a string into a digest
+    /// @param first: the digest
+    /// @param second: the string
+    inline void mix(std::uint64_t &digest, const std::string &str)
+    {
+        for (char c : str)
+        {
+            digest ^= static_cast<unsigned char>(c);
+            digest *= FNV_PRIME;
+        }
+        mix(digest, str.size());
+    }
+}
+
+PROJECT_NAMESPACE_END
+
+#endif //ZKUTIL_HASH_H_
@@ -0,0 +1,42 @@
+/**
+ * @file HeapBytes.h
+ * @brief The heap bytes owned by the standard containers, for the memory accounting of the database
+ * @date 10/14/2026
+ */
+
+#ifndef ZKUTIL_HEAP_BYTES_H_
+#define ZKUTIL_HEAP_BYTES_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "global/namespace.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace HeapBytes
+{
+    /// @brief the bytes of the block of a vector, by its capacity. The heap blocks of the elements are not included
+    template<typename T, typename Alloc>
+    inline std::size_t of(const std::vector<T, Alloc> &vec) { return vec.capacity() * sizeof(T); }
+
+    /// @brief the bytes of the words of a vector of bools
+    template<typename Alloc>
+    inline std::size_t of(const std::vector<bool, Alloc> &vec) { return (vec.capacity() + 7) / 8; }
+
+    /// @brief the bytes of the block of a string. 0 if the characters are kept inside the string object
+    inline std::size_t of(const std::string &str)
+    {
+        const char *data = str.data();
+        const char *self = reinterpret_cast<const char *>(&str);
+        if (data >= self && data < self + sizeof(std::string))
+        {
+            return 0;
+        }
+        return str.capacity() + 1;
+    }
+}
+
+PROJECT_NAMESPACE_END
+
+#endif //ZKUTIL_HEAP_BYTES_H_
@@ -0,0 +1,100 @@
+/**
+ * @file IndexList.h
+ * @brief A list of indices either owned or viewing a slice of a compressed sparse row array
+ * @date 10/14/2026
+ */
+
+#ifndef ZKUTIL_INDEX_LIST_H_
+#define ZKUTIL_INDEX_LIST_H_
+
+#include <vector>
+#include "global/type.h"
+#include "util/Assert.h"
+#include "util/HeapBytes.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::IndexSpan
+/// @brief A read-only view of contiguous indices
+class IndexSpan
+{
+    public:
+        typedef const IndexType * const_iterator;
+        typedef const_iterator iterator;
+        typedef IndexType value_type;
+        /// @brief an empty view
+        IndexSpan() = default;
+        /// @brief a view of [data, data + size)
+        IndexSpan(const IndexType *data, IndexType size) : _data(data), _size(size) {}
+        const_iterator begin() const { return _data; }
+        const_iterator end() const { return _data + _size; }
+        IndexType size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        const IndexType * data() const { return _data; }
+        IndexType operator[](IndexType idx) const { return _data[idx]; }
+        /// @brief bound-checked access, as std::vector::at
+        IndexType at(IndexType idx) const { AssertMsg(idx < _size, "IndexSpan::at: %u out of %u \n", idx, _size); return _data[idx]; }
+        IndexType back() const { return _data[_size - 1]; }
+        /// @brief copy into a vector
+        std::vector<IndexType> toVector() const { return std::vector<IndexType>(begin(), end()); }
+    private:
+        const IndexType *_data = nullptr;
+        IndexType _size = 0;
+};
+
+/// @class MAGICAL_FLOW::IndexList
+/// @brief A list of indices, stored either in its own vector while it is being built, or as a view of a slice of a shared array
+/// after the owner packs the lists into one compressed array. Appending to a view copies the slice back into the own vector first,
+/// so the shared array is never written through a list
+class IndexList
+{
+    public:
+        /// @brief an empty owned list
+        IndexList() = default;
+        /// @brief get the indices
+        /// @return a view of the indices
+        IndexSpan span() const { return _view != nullptr ? IndexSpan(_view, _viewSize) : IndexSpan(_own.data(), _own.size()); }
+        /// @brief get the number of indices
+        IndexType size() const { return _view != nullptr ? _viewSize : static_cast<IndexType>(_own.size()); }
+        /// @brief get an index
+        IndexType at(IndexType idx) const { return this->span().at(idx); }
+        /// @brief append an index
+        void append(IndexType idx)
+        {
+            if (_view != nullptr)
+            {
+                _own.assign(_view, _view + _viewSize);
+                _view = nullptr;
+                _viewSize = 0;
+            }
+            _own.emplace_back(idx);
+        }
+        /// @brief whether the list views a shared array
+        bool isView() const { return _view != nullptr; }
+        /// @brief get the bytes of the own vector. A view owns none
+        std::size_t heapBytes() const { return HeapBytes::of(_own); }
+        /// @brief turn into a view of [data, data + size), which should hold the same indices, and release the own vector
+        void setView(const IndexType *data, IndexType size)
+        {
+            if (size == 0)
+            {
+                // Nothing to view: keep an empty owned list
+                _view = nullptr;
+                _viewSize = 0;
+            }
+            else
+            {
+                _view = data;
+                _viewSize = size;
+            }
+            std::vector<IndexType>().swap(_own);
+        }
+    private:
+        std::vector<IndexType> _own; ///< The indices while the list is owned
+        const IndexType *_view = nullptr; ///< The shared slice. nullptr if the list is owned
+        IndexType _viewSize = 0; ///< The size of the shared slice
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //ZKUTIL_INDEX_LIST_H_
@@ -0,0 +1,69 @@
+/**
+ * @file MappedFile.h
+ * @brief A read-only memory mapping of a whole file
+ * @date 10/14/2026
+ */
+
+#ifndef ZKUTIL_MAPPED_FILE_H_
+#define ZKUTIL_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "global/namespace.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::MappedFile
+/// @brief a read-only mapping of a whole file. The pages are read by the kernel on the first access, and are shared with the page cache instead of the heap.
+/// The file should not be truncated while mapped
+class MappedFile
+{
+    public:
+        /// @brief constructor
+        /// @param the file name. An empty or unreadable file gives an invalid mapping
+        explicit MappedFile(const std::string &fileName)
+        {
+            int fd = ::open(fileName.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                return;
+            }
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                void *addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED)
+                {
+                    _data = static_cast<const char *>(addr);
+                    _size = st.st_size;
+                }
+            }
+            ::close(fd);
+        }
+        ~MappedFile()
+        {
+            if (_data != nullptr)
+            {
+                ::munmap(const_cast<char *>(_data), _size);
+            }
+        }
+        MappedFile(const MappedFile &) = delete;
+        MappedFile & operator=(const MappedFile &) = delete;
+        /// @brief whether the file is mapped
+        bool valid() const { return _data != nullptr; }
+        /// @brief get the mapped bytes
+        const char * data() const { return _data; }
+        /// @brief get the number of mapped bytes
+        std::size_t size() const { return _size; }
+    private:
+        const char *_data = nullptr; ///< The first mapped byte
+        std::size_t _size = 0; ///< The number of mapped bytes
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //ZKUTIL_MAPPED_FILE_H_
@@ -3,19 +3,246 @@
 //
 
 #include "MsgPrinter.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "Assert.h"
 
 PROJECT_NAMESPACE_BEGIN
 
-std::time_t MsgPrinter::_startTime = std::time(nullptr);
-FILE* MsgPrinter::_screenOutStream = stderr;
-FILE* MsgPrinter::_logOutStream = nullptr;
+std::atomic<std::time_t> MsgPrinter::_startTime(std::time(nullptr));
+std::atomic<FILE *> MsgPrinter::_screenOutStream(stderr);
+std::atomic<FILE *> MsgPrinter::_logOutStream(nullptr);
 std::string MsgPrinter::_logFileName = "";
+std::atomic<MsgType> MsgPrinter::_minType(MsgType::DBG);
+
+namespace
+{
+    /// The severity of a message type, DBG being the lowest
+    int msgSeverity(MsgType msgType)
+    {
+        switch (msgType)
+        {
+            case MsgType::DBG: return 0;
+            case MsgType::INF: return 1;
+            case MsgType::WRN: return 2;
+            case MsgType::ERR: return 3;
+        }
+        return 3;
+    }
+
+    /// The lock of the streams, held while writing a message or swapping the log file
+    std::mutex & writeMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    /// Format the header and the message into out
+    void formatMessage(MsgType msgType, std::time_t startTime, const char *rawFormat, va_list args, std::string &out)
+    {
+        /// Local time and elapsed time. localtime_r, as the messages come from several threads
+        std::time_t now = std::time(nullptr);
+        struct tm timeInfo;
+        localtime_r(&now, &timeInfo);
+        char locTime[32];
+        strftime(locTime, 32, " %F %T ", &timeInfo);
+        char header[96];
+        int headerLength = snprintf(header, sizeof(header), "[%s%s%5.0lf sec]  ", msgTypeToStr(msgType).c_str(), locTime, difftime(now, startTime));
+        out.assign(header, headerLength > 0 ? headerLength : 0);
+
+        /// The message, formatted twice only if it does not fit the stack buffer
+        char buffer[512];
+        va_list argsCopy;
+        va_copy(argsCopy, args);
+        int length = vsnprintf(buffer, sizeof(buffer), rawFormat, argsCopy);
+        va_end(argsCopy);
+        if (length < 0)
+        {
+            return;
+        }
+        if (static_cast<std::size_t>(length) < sizeof(buffer))
+        {
+            out.append(buffer, length);
+            return;
+        }
+        std::size_t begin = out.size();
+        out.resize(begin + length + 1);
+        vsnprintf(&out[begin], length + 1, rawFormat, args);
+        out.resize(begin + length);
+    }
+}
+
+/// The asynchronous backend: one single-producer single-consumer ring of messages per thread, drained by the writer thread
+struct MsgPrinter::AsyncBackend
+{
+    /// The messages of a thread
+    struct Ring
+    {
+        explicit Ring(std::size_t capacity, std::uint64_t generation_) : slots(capacity), mask(capacity - 1), generation(generation_) {}
+        std::vector<std::string> slots; ///< The messages. A slot keeps its capacity for the next messages
+        const std::size_t mask; ///< The capacity minus 1, the capacity being a power of 2
+        const std::uint64_t generation; ///< The startAsync call the ring belongs to
+        std::atomic<std::size_t> head{0}; ///< The number of messages pushed, written by the producer
+        std::atomic<std::size_t> tail{0}; ///< The number of messages written, written by the writer thread
+    };
+
+    static AsyncBackend & instance()
+    {
+        static AsyncBackend backend;
+        return backend;
+    }
+
+    /// Push a message of the calling thread, if the backend is running
+    /// @return whether the message is pushed. Otherwise the caller prints it
+    bool tryPush(const std::string &text)
+    {
+        activeProducers.fetch_add(1);
+        if (!running.load())
+        {
+            activeProducers.fetch_sub(1);
+            return false;
+        }
+        Ring &ring = this->localRing();
+        std::size_t head = ring.head.load(std::memory_order_relaxed);
+        while (head - ring.tail.load(std::memory_order_acquire) > ring.mask)
+        {
+            // Full: the messages are never dropped, the producer waits for the writer
+            wake.notify_one();
+            std::this_thread::yield();
+        }
+        ring.slots[head & ring.mask].assign(text);
+        ring.head.store(head + 1, std::memory_order_release);
+        if (((head + 1) & (ring.mask >> 1)) == 0)
+        {
+            // Half of the ring since the last wake up
+            wake.notify_one();
+        }
+        activeProducers.fetch_sub(1);
+        return true;
+    }
+
+    /// Get the ring of the calling thread, registered on its first message after startAsync
+    Ring & localRing()
+    {
+        thread_local std::shared_ptr<Ring> ring;
+        std::uint64_t current = generation.load();
+        if (!ring || ring->generation != current)
+        {
+            ring = std::make_shared<Ring>(capacity, current);
+            std::lock_guard<std::mutex> lock(registryMutex);
+            rings.emplace_back(ring);
+        }
+        return *ring;
+    }
+
+    /// Write the pending messages of all the rings, and drop the rings of the finished threads
+    void drain()
+    {
+        std::vector<std::shared_ptr<Ring>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            snapshot = rings;
+        }
+        bool written = false;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex());
+            for (const auto &ring : snapshot)
+            {
+                std::size_t tail = ring->tail.load(std::memory_order_relaxed);
+                std::size_t head = ring->head.load(std::memory_order_acquire);
+                written = written || tail != head;
+                for (; tail != head; ++tail)
+                {
+                    const std::string &text = ring->slots[tail & ring->mask];
+                    MsgPrinter::write(text.data(), text.size());
+                }
+                ring->tail.store(tail, std::memory_order_release);
+            }
+            if (written)
+            {
+                // One flush per batch rather than per message, for the log files on slow file systems
+                FILE *log = MsgPrinter::_logOutStream.load();
+                if (log) { fflush(log); }
+                FILE *screen = MsgPrinter::_screenOutStream.load();
+                if (screen) { fflush(screen); }
+            }
+        }
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (std::size_t idx = 0; idx < rings.size();)
+        {
+            // Only the registry and the snapshot hold the ring of a finished thread
+            const auto &ring = rings[idx];
+            if (ring.use_count() <= 2 && ring->head.load() == ring->tail.load()
+                && snapshot.end() != std::find(snapshot.begin(), snapshot.end(), ring))
+            {
+                rings[idx] = rings.back();
+                rings.pop_back();
+            }
+            else
+            {
+                ++idx;
+            }
+        }
+    }
+
+    /// The loop of the writer thread
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        while (true)
+        {
+            wake.wait_for(lock, std::chrono::milliseconds(20), [&]() { return stopping || flushRequested; });
+            bool stop = stopping;
+            flushRequested = false;
+            lock.unlock();
+            this->drain();
+            lock.lock();
+            ++numPasses;
+            drained.notify_all();
+            if (stop)
+            {
+                stopped = true;
+                drained.notify_all();
+                break;
+            }
+        }
+    }
+
+    /// Wait until a whole pass of the writer has started after this call and finished
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        std::uint64_t target = numPasses + 2;
+        flushRequested = true;
+        wake.notify_one();
+        drained.wait(lock, [&]() { return numPasses >= target || stopped; });
+    }
+
+    std::atomic<bool> running{false}; ///< Whether the messages go to the rings
+    std::atomic<int> activeProducers{0}; ///< The number of threads pushing a message
+    std::atomic<std::uint64_t> generation{0}; ///< Incremented by each startAsync, so that the threads take new rings
+    std::size_t capacity = 1024; ///< The capacity of the new rings
+    std::mutex registryMutex; ///< The lock of the registry
+    std::vector<std::shared_ptr<Ring>> rings; ///< The rings of all the threads
+    std::thread writer; ///< The writer thread
+    std::mutex wakeMutex; ///< The lock of the flags below
+    std::condition_variable wake; ///< Wakes up the writer
+    std::condition_variable drained; ///< Signaled after each pass of the writer
+    bool stopping = false; ///< Whether the writer should stop after its next pass
+    bool stopped = false; ///< Whether the writer has made its last pass
+    bool flushRequested = false; ///< Whether a thread waits for a pass
+    std::uint64_t numPasses = 0; ///< The number of passes of the writer
+};
 
 /// Converting enum type to std::string
-std::string msgTypeToStr(MsgType msgType) 
+std::string msgTypeToStr(MsgType msgType)
 {
-    switch (msgType) 
+    switch (msgType)
     {
         case MsgType::INF:  return "INF"; break;
         case MsgType::WRN:  return "WRN"; break;
@@ -23,21 +250,40 @@ std::string msgTypeToStr(MsgType msgType)
         case MsgType::DBG:  return "DBG"; break;
     }
     AssertMsg(false, "Unknown MsgType. \n");
+    return "";
+}
+
+/// Whether a message type is at least as severe as another
+bool msgTypeAtLeast(MsgType msgType, MsgType minType)
+{
+    return msgSeverity(msgType) >= msgSeverity(minType);
 }
 
 /// Open a log file, all output will be stored in the log
-void MsgPrinter::openLogFile(const std::string &logFileName) 
+void MsgPrinter::openLogFile(const std::string &logFileName)
 {
-    if (_logOutStream != nullptr) 
+    flush();
+    bool replaced = false;
+    std::string replacedName;
+    FILE *stream = nullptr;
     {
-        fclose(_logOutStream);
-        wrn("Current log file %s is forcibly closed\n", _logFileName.c_str());
+        std::lock_guard<std::mutex> lock(writeMutex());
+        FILE *previous = _logOutStream.exchange(nullptr);
+        if (previous != nullptr)
+        {
+            fclose(previous);
+            replaced = true;
+            replacedName = _logFileName;
+        }
+        _logFileName = logFileName;
+        stream = fopen(logFileName.c_str(), "w");
+        _logOutStream = stream;
     }
-
-    _logFileName = logFileName;
-    _logOutStream = fopen(logFileName.c_str(), "w");
-
-    if (_logOutStream == nullptr) 
+    if (replaced)
+    {
+        wrn("Current log file %s is forcibly closed\n", replacedName.c_str());
+    }
+    if (stream == nullptr)
     {
         err("Cannot open log file %s\n", logFileName.c_str());
     }
@@ -47,20 +293,32 @@ void MsgPrinter::openLogFile(const std::string &logFileName)
 }
 
 /// Close current log file
-void MsgPrinter::closeLogFile() 
+void MsgPrinter::closeLogFile()
 {
-    if (_logOutStream == nullptr) 
+    if (_logOutStream.load() == nullptr)
     {
         wrn("No log file is opened. Call to %s is ignored.\n", __func__);
     }
-    else 
+    else
     {
-        inf("Close log file %s.\n", _logFileName.c_str());
+        std::string logFileName;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex());
+            logFileName = _logFileName;
+        }
+        inf("Close log file %s.\n", logFileName.c_str());
+        flush();
+        std::lock_guard<std::mutex> lock(writeMutex());
+        FILE *stream = _logOutStream.exchange(nullptr);
+        if (stream != nullptr)
+        {
+            fclose(stream);
+        }
     }
 }
 
 /// Print information
-void MsgPrinter::inf(const char* rawFormat, ...) 
+void MsgPrinter::inf(const char* rawFormat, ...)
 {
     va_list args;
     va_start(args, rawFormat);
@@ -69,7 +327,7 @@ void MsgPrinter::inf(const char* rawFormat, ...)
 }
 
 /// Print Warnings
-void MsgPrinter::wrn(const char* rawFormat, ...) 
+void MsgPrinter::wrn(const char* rawFormat, ...)
 {
     va_list args;
     va_start(args, rawFormat);
@@ -78,7 +336,7 @@ void MsgPrinter::wrn(const char* rawFormat, ...)
 }
 
 ///Print errors
-void MsgPrinter::err(const char* rawFormat, ...) 
+void MsgPrinter::err(const char* rawFormat, ...)
 {
     va_list args;
     va_start(args, rawFormat);
@@ -87,7 +345,7 @@ void MsgPrinter::err(const char* rawFormat, ...)
 }
 
 /// Print debugging information
-void MsgPrinter::dbg(const char* rawFormat, ...) 
+void MsgPrinter::dbg(const char* rawFormat, ...)
 {
     va_list args;
     va_start(args, rawFormat);
@@ -95,44 +353,124 @@ void MsgPrinter::dbg(const char* rawFormat, ...)
     va_end(args);
 }
 
-/// Message printing kernel
-void MsgPrinter::print(MsgType msgType, const char* rawFormat, va_list args) 
+/// Start printing from the writer thread
+void MsgPrinter::startAsync(std::size_t ringCapacity)
 {
-    /// Get the message type
-    std::string type = "[" + msgTypeToStr(msgType);
+    auto &backend = AsyncBackend::instance();
+    std::lock_guard<std::mutex> lock(backend.registryMutex);
+    if (backend.writer.joinable())
+    {
+        return;
+    }
+    std::size_t capacity = 2;
+    while (capacity < ringCapacity)
+    {
+        capacity <<= 1;
+    }
+    backend.capacity = capacity;
+    backend.generation.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> wakeLock(backend.wakeMutex);
+        backend.stopping = false;
+        backend.stopped = false;
+    }
+    backend.writer = std::thread([&backend]() { backend.run(); });
+    backend.running = true;
+    static bool atExitRegistered = false;
+    if (!atExitRegistered)
+    {
+        // The writer should be joined before the static objects are destroyed
+        std::atexit([]() { MsgPrinter::stopAsync(); });
+        atExitRegistered = true;
+    }
+}
 
-    /// Get local time and elapsed time
-    struct tm* timeInfo;
-    std::time_t now = std::time(nullptr);
-    timeInfo = localtime(&now);
-    double elapsed = difftime(now, _startTime);
+/// Stop the writer thread after writing the pending messages
+void MsgPrinter::stopAsync()
+{
+    auto &backend = AsyncBackend::instance();
+    if (!backend.running.exchange(false))
+    {
+        return;
+    }
+    // The messages being pushed land before the last pass
+    while (backend.activeProducers.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(backend.wakeMutex);
+        backend.stopping = true;
+    }
+    backend.wake.notify_one();
+    backend.writer.join();
+    std::lock_guard<std::mutex> lock(backend.registryMutex);
+    backend.rings.clear();
+}
 
-    /// Local time
-    char locTime[32];
-    strftime(locTime, 32, " %F %T ", timeInfo);
+/// Whether the writer thread is running
+bool MsgPrinter::isAsync()
+{
+    return AsyncBackend::instance().running.load();
+}
 
-    /// Elapsed time
-    char elpTime[32];
-    sprintf(elpTime, "%5.0lf sec]  ", elapsed);
+/// Wait until the messages issued so far are written
+void MsgPrinter::flush()
+{
+    auto &backend = AsyncBackend::instance();
+    if (backend.running.load())
+    {
+        backend.flush();
+        return;
+    }
+    std::lock_guard<std::mutex> lock(writeMutex());
+    FILE *log = _logOutStream.load();
+    if (log) { fflush(log); }
+    FILE *screen = _screenOutStream.load();
+    if (screen) { fflush(screen); }
+}
 
-    // Combine all the strings together
-    std::string format = type + std::string(locTime) + std::string(elpTime) + std::string(rawFormat);
+/// Write a formatted message to the log and to the screen
+void MsgPrinter::write(const char *text, std::size_t length)
+{
+    FILE *log = _logOutStream.load();
+    if (log)
+    {
+        fwrite(text, 1, length, log);
+    }
+    FILE *screen = _screenOutStream.load();
+    if (screen)
+    {
+        fwrite(text, 1, length, screen);
+    }
+}
 
-    // print to log
-    if (_logOutStream)
+/// Message printing kernel
+void MsgPrinter::print(MsgType msgType, const char* rawFormat, va_list args)
+{
+    /// Filter before formatting
+    if (!enabled(msgType))
     {
-        va_list args_copy;
-        va_copy(args_copy, args);
-        vfprintf(_logOutStream, format.c_str(), args_copy);
-        va_end(args_copy);
-        fflush(_logOutStream);
+        return;
     }
+    thread_local std::string text;
+    formatMessage(msgType, _startTime.load(), rawFormat, args, text);
 
-    // print to screen
-    if (_screenOutStream)
+    auto &backend = AsyncBackend::instance();
+    if (backend.tryPush(text))
     {
-        vfprintf(_screenOutStream, format.c_str(), args);
-        fflush(_screenOutStream);
+        if (msgType == MsgType::ERR)
+        {
+            // An error is on the disk before the caller goes on, such as Assert aborting
+            backend.flush();
+        }
+        return;
     }
+    std::lock_guard<std::mutex> lock(writeMutex());
+    write(text.data(), text.size());
+    FILE *log = _logOutStream.load();
+    if (log) { fflush(log); }
+    FILE *screen = _screenOutStream.load();
+    if (screen) { fflush(screen); }
 }
 PROJECT_NAMESPACE_END
@@ -9,6 +9,7 @@
 #ifndef ZKUTIL_MSGPRINTER_H_
 #define ZKUTIL_MSGPRINTER_H_
 
+#include <atomic>
 #include <cstdio> // FILE *, stderr
 #include <string>
 #include <ctime>
@@ -30,13 +31,23 @@ enum class MsgType
 /// Function converting enum type to std::string
 std::string msgTypeToStr(MsgType msgType);
 
-/// Message printing class
+/// Function telling whether a message type is printed when the lowest printed type is minType. DBG < INF < WRN < ERR
+bool msgTypeAtLeast(MsgType msgType, MsgType minType);
+
+/// Message printing class.
+/// The messages are printed synchronously under a lock by default. After startAsync(), each thread formats its messages into its own
+/// lock-free ring buffer and a background thread writes them, so that the callers do not wait for slow log files.
+/// The order of the messages of a thread is kept. An ERR waits until everything before it is written, and so does flush().
+/// All the functions can be called from several threads at once, such as the bindings running without the GIL
 class MsgPrinter 
 {
     public:
         static void startTimer() { _startTime = std::time(nullptr); } // Cache start time
         static void screenOn()   { _screenOutStream = stderr; }       // Turn on screen printing
         static void screenOff()  { _screenOutStream = nullptr; }      // Turn off screen printing
+        static void setMinType(MsgType minType) { _minType = minType; } // Skip the messages below this type before formatting them. Default: DBG, printing all
+        static MsgType minType() { return _minType; }             // The lowest printed message type
+        static bool enabled(MsgType msgType) { return msgTypeAtLeast(msgType, _minType); } // Whether a message type is printed
 
         static void openLogFile(const std::string &file);
         static void closeLogFile();
@@ -45,14 +56,22 @@ class MsgPrinter
         static void err(const char *rawFormat, ...);
         static void dbg(const char *rawFormat, ...);
 
+        static void startAsync(std::size_t ringCapacity = 1024); // Print from a background thread, with ringCapacity messages per producing thread
+        static void stopAsync();                                   // Write the pending messages and go back to printing synchronously
+        static bool isAsync();                                     // Whether the messages are printed by the background thread
+        static void flush();                                       // Wait until all the messages issued so far are written
+
     private:
+        struct AsyncBackend; // The ring buffers and the writer thread
         static void print(MsgType msgType, const char *rawFormat, va_list args);
+        static void write(const char *text, std::size_t length);   // Write a formatted message to the log and the screen. Called under the write lock
 
     private:
-        static std::time_t   _startTime;
-        static FILE *        _screenOutStream;  // Out stream for screen printing
-        static FILE *        _logOutStream;     // Out stream for log printing
-        static std::string   _logFileName;      // Current log file name
+        static std::atomic<std::time_t> _startTime;
+        static std::atomic<FILE *>  _screenOutStream;  // Out stream for screen printing
+        static std::atomic<FILE *>  _logOutStream;     // Out stream for log printing
+        static std::string          _logFileName;      // Current log file name. Accessed under the write lock
+        static std::atomic<MsgType> _minType;          // The lowest printed message type
 };
 
 PROJECT_NAMESPACE_END
@@ -0,0 +1,78 @@
+/**
+ * @file OasisFormat.h
+ * @brief The constants of the OASIS layout format (SEMI P39) shared by the writer and the reader
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_OASIS_FORMAT_H_
+#define MAGICAL_FLOW_OASIS_FORMAT_H_
+
+#include <cstdint>
+#include <string>
+#include "global/namespace.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace OASIS
+{
+    /// @brief the bytes at the beginning of every OASIS file
+    constexpr char MAGIC[] = "%SEMI-OASIS\r\n";
+    constexpr std::size_t MAGIC_SIZE = sizeof(MAGIC) - 1;
+    /// @brief the version written in START
+    constexpr char VERSION[] = "1.0";
+    /// @brief the END record is padded to this size
+    constexpr std::size_t END_RECORD_SIZE = 256;
+
+    /// @brief the record ids
+    enum RecordType : std::uint8_t
+    {
+        REC_PAD = 0, REC_START = 1, REC_END = 2,
+        REC_CELLNAME = 3, REC_CELLNAME_REF = 4, REC_TEXTSTRING = 5, REC_TEXTSTRING_REF = 6,
+        REC_PROPNAME = 7, REC_PROPNAME_REF = 8, REC_PROPSTRING = 9, REC_PROPSTRING_REF = 10,
+        REC_LAYERNAME = 11, REC_LAYERNAME_TEXT = 12,
+        REC_CELL_REF = 13, REC_CELL = 14, REC_XYABSOLUTE = 15, REC_XYRELATIVE = 16,
+        REC_PLACEMENT = 17, REC_PLACEMENT_MAG = 18, REC_TEXT = 19, REC_RECTANGLE = 20, REC_POLYGON = 21,
+        REC_PATH = 22, REC_TRAPEZOID = 23, REC_TRAPEZOID_A = 24, REC_TRAPEZOID_B = 25, REC_CTRAPEZOID = 26, REC_CIRCLE = 27,
+        REC_PROPERTY = 28, REC_PROPERTY_REPEAT = 29, REC_XNAME = 30, REC_XNAME_REF = 31, REC_XELEMENT = 32, REC_XGEOMETRY = 33,
+        REC_CBLOCK = 34
+    };
+
+    /// @brief the info byte bits of RECTANGLE: SWHXYRDL
+    enum RectangleBits : std::uint8_t
+    {
+        RECT_S = 0x80, RECT_W = 0x40, RECT_H = 0x20, RECT_X = 0x10, RECT_Y = 0x08, RECT_R = 0x04, RECT_D = 0x02, RECT_L = 0x01
+    };
+    /// @brief the info byte bits of PLACEMENT: CNXYRAAF, or CNXYRMAF with magnification and angle
+    enum PlacementBits : std::uint8_t
+    {
+        PLACE_C = 0x80, PLACE_N = 0x40, PLACE_X = 0x20, PLACE_Y = 0x10, PLACE_R = 0x08, PLACE_AA = 0x06, PLACE_M = 0x04, PLACE_A = 0x02, PLACE_F = 0x01
+    };
+    /// @brief the info byte bits of TEXT: 0CNXYRTL
+    enum TextBits : std::uint8_t
+    {
+        TEXT_C = 0x40, TEXT_N = 0x20, TEXT_X = 0x10, TEXT_Y = 0x08, TEXT_R = 0x04, TEXT_T = 0x02, TEXT_L = 0x01
+    };
+    /// @brief the info byte bits of POLYGON: 00PXYRDL
+    enum PolygonBits : std::uint8_t
+    {
+        POLY_P = 0x20, POLY_X = 0x10, POLY_Y = 0x08, POLY_R = 0x04, POLY_D = 0x02, POLY_L = 0x01
+    };
+    /// @brief the repetition types used by the writer. The reader decodes all of 0 to 11
+    enum RepetitionType : std::uint8_t
+    {
+        REP_REUSE = 0, REP_GRID = 1, REP_ROW = 2, REP_COLUMN = 3
+    };
+    /// @brief the compression type of CBLOCK: raw DEFLATE
+    constexpr std::uint8_t CBLOCK_DEFLATE = 0;
+
+    /// @brief whether a file name has the .oas suffix, or .oas.gz for a gzip compressed OASIS file
+    inline bool isOasisFileName(const std::string &fileName)
+    {
+        auto hasSuffix = [&](const char *suffix, std::size_t len) { return fileName.size() > len && fileName.compare(fileName.size() - len, len, suffix) == 0; };
+        return hasSuffix(".oas", 4) || hasSuffix(".oas.gz", 7);
+    }
+}
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_OASIS_FORMAT_H_
@@ -7,6 +7,9 @@
 #ifndef KLIB_POLYGON2RECT_H_
 #define KLIB_POLYGON2RECT_H_
 
+#include <algorithm>
+#include <vector>
+#include "global/type.h"
 #include "Box.h"
 #include <limbo/geometry/Polygon2Rectangle.h>
 
@@ -135,15 +138,238 @@ struct rectangle_traits<PROJECT_NAMESPACE::Box<T>>
 
 namespace klib
 {
+    /// @brief detect an axis-aligned rectangle given by its 4 corners, optionally followed by the closing point
+    /// @param first: the points of the polygon
+    /// @param second: the number of points
+    /// @param third: output the rectangle
+    /// @return whether the polygon is a non-degenerate axis-aligned rectangle
+    template<typename T>
+    inline bool isRectilinearBox(const PROJECT_NAMESPACE::XY<T> *pts, std::size_t numPts, PROJECT_NAMESPACE::Box<T> &rect)
+    {
+        if (numPts == 5 && pts[0] == pts[4])
+        {
+            numPts = 4;
+        }
+        if (numPts != 4)
+        {
+            return false;
+        }
+        // The edges alternate between horizontal and vertical, starting with either
+        bool horFirst = pts[0].y() == pts[1].y() && pts[1].x() == pts[2].x() && pts[2].y() == pts[3].y() && pts[3].x() == pts[0].x();
+        bool verFirst = pts[0].x() == pts[1].x() && pts[1].y() == pts[2].y() && pts[2].x() == pts[3].x() && pts[3].y() == pts[0].y();
+        if (!horFirst && !verFirst)
+        {
+            return false;
+        }
+        T xLo = std::min(pts[0].x(), pts[2].x());
+        T xHi = std::max(pts[0].x(), pts[2].x());
+        T yLo = std::min(pts[0].y(), pts[2].y());
+        T yHi = std::max(pts[0].y(), pts[2].y());
+        if (xLo == xHi || yLo == yHi)
+        {
+            return false;
+        }
+        rect = PROJECT_NAMESPACE::Box<T>(xLo, yLo, xHi, yHi);
+        return true;
+    }
+
+    /// @brief remove the closing point, the repeated points and the collinear points of a polygon, and check whether all its edges are horizontal or vertical.
+    /// A rectilinear polygon is left with alternating horizontal and vertical edges
+    /// @param the points of the polygon, simplified in place if it is rectilinear
+    /// @return whether the polygon is rectilinear, with at least 4 points left
+    template<typename T>
+    inline bool simplifyRectilinear(std::vector<PROJECT_NAMESPACE::XY<T>> &pts)
+    {
+        typedef typename PROJECT_NAMESPACE::XY<T> PtType;
+        std::vector<PtType> unique;
+        unique.reserve(pts.size());
+        for (const auto &pt : pts)
+        {
+            if (unique.empty() || !(unique.back() == pt))
+            {
+                unique.emplace_back(pt);
+            }
+        }
+        while (unique.size() > 1 && unique.front() == unique.back())
+        {
+            unique.pop_back();
+        }
+        for (std::size_t idx = 0; idx < unique.size(); ++idx)
+        {
+            const PtType &from = unique[idx];
+            const PtType &to = unique[(idx + 1) % unique.size()];
+            if (from.x() != to.x() && from.y() != to.y())
+            {
+                return false;
+            }
+        }
+        auto collinear = [](const PtType &a, const PtType &b, const PtType &c)
+        {
+            return (a.x() == b.x() && b.x() == c.x()) || (a.y() == b.y() && b.y() == c.y());
+        };
+        std::vector<PtType> result;
+        result.reserve(unique.size());
+        for (const auto &pt : unique)
+        {
+            while (result.size() >= 2 && collinear(result[result.size() - 2], result.back(), pt))
+            {
+                result.pop_back();
+            }
+            result.emplace_back(pt);
+        }
+        // The vertices around the wrap
+        while (result.size() >= 3)
+        {
+            if (collinear(result[result.size() - 2], result.back(), result.front()))
+            {
+                result.pop_back();
+            }
+            else if (collinear(result.back(), result.front(), result[1]))
+            {
+                result.erase(result.begin());
+            }
+            else
+            {
+                break;
+            }
+        }
+        if (result.size() < 4)
+        {
+            return false;
+        }
+        pts.swap(result);
+        return true;
+    }
+
     template<typename T>
     inline bool convertPolygon2Rects(const std::vector<PROJECT_NAMESPACE::XY<T>> &pts, std::vector<PROJECT_NAMESPACE::Box<T>> &rects)
     {
         typedef typename PROJECT_NAMESPACE::XY<T> PtType;
         typedef typename PROJECT_NAMESPACE::Box<T> RectType;
 
+        RectType rect;
+        if (isRectilinearBox<T>(pts.data(), pts.size(), rect))
+        {
+            rects.emplace_back(rect);
+            return true;
+        }
         limbo::geometry::Polygon2Rectangle<std::vector<PtType>, std::vector<RectType>> p2r(rects, pts.begin(), pts.end(), limbo::geometry::HOR_VER_SLICING);
         return p2r();
     }
+
+    /// @class klib::Polygon2RectBatch
+    /// @brief Convert many polygons into rectangles at once.
+    /// The rectangles are emitted directly when added. The other polygons are sliced in parallel by run().
+    /// The buffers are kept by clear(), so that a batch can be reused without reallocation
+    template<typename T>
+    class Polygon2RectBatch
+    {
+        typedef typename PROJECT_NAMESPACE::XY<T> PtType;
+        typedef typename PROJECT_NAMESPACE::Box<T> RectType;
+        typedef PROJECT_NAMESPACE::IndexType IndexType;
+        /// @brief the minimum number of polygons to slice for running in parallel
+        static constexpr IndexType PARALLEL_SLICING_THRESHOLD = 64;
+        public:
+            explicit Polygon2RectBatch() = default;
+            /// @brief remove the polygons, keeping the buffers
+            void clear()
+            {
+                _pts.clear();
+                _ptStart.assign(1, 0);
+                _pending.clear();
+                _numPolygons = 0;
+            }
+            /// @brief add a polygon
+            /// @param first: the first point
+            /// @param second: past the last point. The points need x() and y()
+            /// @return the index of the polygon in the batch
+            template<typename Iterator>
+            IndexType addPolygon(Iterator first, Iterator last)
+            {
+                IndexType polyIdx = _numPolygons++;
+                if (_rects.size() < _numPolygons)
+                {
+                    _rects.resize(_numPolygons);
+                    _success.resize(_numPolygons);
+                }
+                _rects[polyIdx].clear();
+                _success[polyIdx] = true;
+                IndexType begin = _pts.size();
+                for (; first != last; ++first)
+                {
+                    _pts.emplace_back(first->x(), first->y());
+                }
+                if (_pts.size() > begin + 1 && _pts[begin] == _pts.back())
+                {
+                    // The closing point repeats the first one
+                    _pts.pop_back();
+                }
+                RectType rect;
+                if (isRectilinearBox<T>(_pts.data() + begin, _pts.size() - begin, rect))
+                {
+                    _rects[polyIdx].emplace_back(rect);
+                    _pts.resize(begin);
+                }
+                else
+                {
+                    _pending.emplace_back(polyIdx);
+                }
+                _ptStart.emplace_back(_pts.size());
+                return polyIdx;
+            }
+            /// @brief add rectangles already resolved by the caller as one polygon, so that they keep their place in the order of the polygons
+            /// @param first: the first rectangle
+            /// @param second: past the last rectangle
+            /// @return the index of the polygon in the batch
+            template<typename Iterator>
+            IndexType addRects(Iterator first, Iterator last)
+            {
+                IndexType polyIdx = _numPolygons++;
+                if (_rects.size() < _numPolygons)
+                {
+                    _rects.resize(_numPolygons);
+                    _success.resize(_numPolygons);
+                }
+                _rects[polyIdx].assign(first, last);
+                _success[polyIdx] = true;
+                _ptStart.emplace_back(_pts.size());
+                return polyIdx;
+            }
+            /// @brief slice the polygons which are not rectangles
+            /// @return whether all the polygons are converted successfully
+            bool run()
+            {
+                IndexType numPending = _pending.size();
+                bool success = true;
+                #pragma omp parallel for schedule(dynamic, 8) reduction(&& : success) if (numPending >= PARALLEL_SLICING_THRESHOLD)
+                for (IndexType idx = 0; idx < numPending; ++idx)
+                {
+                    IndexType polyIdx = _pending[idx];
+                    auto begin = _pts.begin() + _ptStart[polyIdx];
+                    auto end = _pts.begin() + _ptStart[polyIdx + 1];
+                    limbo::geometry::Polygon2Rectangle<std::vector<PtType>, std::vector<RectType>> p2r(_rects[polyIdx], begin, end, limbo::geometry::HOR_VER_SLICING);
+                    _success[polyIdx] = p2r();
+                    success = success && _success[polyIdx];
+                }
+                _pending.clear();
+                return success;
+            }
+            /// @brief get the number of polygons
+            IndexType numPolygons() const { return _numPolygons; }
+            /// @brief get the rectangles of a polygon. Valid after run() for the polygons which are not rectangles
+            /// @param the index of the polygon
+            const std::vector<RectType> & rects(IndexType polyIdx) const { return _rects.at(polyIdx); }
+            /// @brief get whether a polygon is converted successfully
+            /// @param the index of the polygon
+            bool success(IndexType polyIdx) const { return _success.at(polyIdx) != 0; }
+        private:
+            std::vector<PtType> _pts; ///< The points of the polygons to slice
+            std::vector<IndexType> _ptStart = std::vector<IndexType>(1, 0); ///< The points of polygon i are [_ptStart[i], _ptStart[i + 1])
+            std::vector<std::vector<RectType>> _rects; ///< The rectangles of each polygon. May be longer than the number of polygons
+            std::vector<unsigned char> _success; ///< Whether each polygon is converted successfully
+            std::vector<IndexType> _pending; ///< The polygons to slice
+            IndexType _numPolygons = 0; ///< The number of polygons
+    };
 }
 
 #endif ///KLIB_POLYGON2RECT_H_
@@ -0,0 +1,483 @@
+/**
+ * @file RectKernels.h
+ * @brief Vectorized kernels over structure-of-arrays rectangle coordinates
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_RECT_KERNELS_H_
+#define MAGICAL_FLOW_RECT_KERNELS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "global/type.h"
+#include "util/Box.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MAGICAL_FLOW_RECT_KERNELS_AVX2
+#if defined(__AVX512F__)
+#define MAGICAL_FLOW_RECT_KERNELS_AVX512
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define MAGICAL_FLOW_RECT_KERNELS_NEON
+#endif
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @brief Kernels on the coordinate arrays of rectangles, i.e. rectangle i is (xLo[i], yLo[i], xHi[i], yHi[i]).
+/// The AVX2, AVX-512 or NEON paths are used if the compiler targets them (e.g. -march=native), otherwise the loops are left to the auto-vectorizer.
+/// All kernels work in place and the arrays may not alias each other, unless noted.
+/// The kernels over a candidate list gather the rectangles by their indices, which must be below 2^31
+namespace RectKernel
+{
+#if defined(MAGICAL_FLOW_RECT_KERNELS_AVX2) || defined(MAGICAL_FLOW_RECT_KERNELS_NEON)
+    static_assert(sizeof(LocType) == 4, "The SIMD rectangle kernels assume 32-bit coordinates");
+#endif
+
+    /// @brief add a constant to an array
+    /// @param first: the array
+    /// @param second: the length of the array
+    /// @param third: the offset
+    inline void shift(LocType *val, IndexType num, LocType offset)
+    {
+        IndexType idx = 0;
+#if defined(MAGICAL_FLOW_RECT_KERNELS_AVX2)
+        const __m256i off = _mm256_set1_epi32(offset);
+        for (; idx + 8 <= num; idx += 8)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(val + idx));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(val + idx), _mm256_add_epi32(v, off));
+        }
+#elif defined(MAGICAL_FLOW_RECT_KERNELS_NEON)
+        const int32x4_t off = vdupq_n_s32(offset);
+        for (; idx + 4 <= num; idx += 4)
+        {
+            vst1q_s32(val + idx, vaddq_s32(vld1q_s32(val + idx), off));
+        }
+#endif
+        for (; idx < num; ++idx)
+        {
+            val[idx] += offset;
+        }
+    }
+
+    /// @brief translate the rectangles
+    /// @param first to fourth: the coordinate arrays
+    /// @param fifth: the number of rectangles
+    /// @param sixth: the x offset
+    /// @param seventh: the y offset
+    inline void translate(LocType *xLo, LocType *yLo, LocType *xHi, LocType *yHi, IndexType num, LocType dx, LocType dy)
+    {
+        if (dx != 0)
+        {
+            shift(xLo, num, dx);
+            shift(xHi, num, dx);
+        }
+        if (dy != 0)
+        {
+            shift(yLo, num, dy);
+            shift(yHi, num, dy);
+        }
+    }
+
+    /// @brief mirror intervals: [lo, hi] -> [sum - hi, sum - lo]
+    /// For mirroring about the vertical line x = axis, sum = 2 * axis
+    /// @param first: the lower ends
+    /// @param second: the higher ends
+    /// @param third: the number of intervals
+    /// @param fourth: the sum of the coordinates before and after mirroring
+    inline void mirror(LocType *lo, LocType *hi, IndexType num, LocType sum)
+    {
+        IndexType idx = 0;
+#if defined(MAGICAL_FLOW_RECT_KERNELS_AVX2)
+        const __m256i s = _mm256_set1_epi32(sum);
+        for (; idx + 8 <= num; idx += 8)
+        {
+            __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lo + idx));
+            __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hi + idx));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(lo + idx), _mm256_sub_epi32(s, h));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(hi + idx), _mm256_sub_epi32(s, l));
+        }
+#elif defined(MAGICAL_FLOW_RECT_KERNELS_NEON)
+        const int32x4_t s = vdupq_n_s32(sum);
+        for (; idx + 4 <= num; idx += 4)
+        {
+            int32x4_t l = vld1q_s32(lo + idx);
+            int32x4_t h = vld1q_s32(hi + idx);
+            vst1q_s32(lo + idx, vsubq_s32(s, h));
+            vst1q_s32(hi + idx, vsubq_s32(s, l));
+        }
+#endif
+        for (; idx < num; ++idx)
+        {
+            LocType l = lo[idx];
+            lo[idx] = sum - hi[idx];
+            hi[idx] = sum - l;
+        }
+    }
+
+    /// @brief mirror coordinates: v -> sum - v, as for the vertices of polygons
+    /// @param first: the array
+    /// @param second: the length of the array
+    /// @param third: the sum of the coordinates before and after mirroring
+    inline void reflect(LocType *val, IndexType num, LocType sum)
+    {
+        IndexType idx = 0;
+#if defined(MAGICAL_FLOW_RECT_KERNELS_AVX2)
+        const __m256i s = _mm256_set1_epi32(sum);
+        for (; idx + 8 <= num; idx += 8)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(val + idx));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(val + idx), _mm256_sub_epi32(s, v));
+        }
+#elif defined(MAGICAL_FLOW_RECT_KERNELS_NEON)
+        const int32x4_t s = vdupq_n_s32(sum);
+        for (; idx + 4 <= num; idx += 4)
+        {
+            vst1q_s32(val + idx, vsubq_s32(s, vld1q_s32(val + idx)));
+        }
+#endif
+        for (; idx < num; ++idx)
+        {
+            val[idx] = sum - val[idx];
+        }
+    }
+
+    /// @brief the minimum of an array
+    /// @param first: the array
+    /// @param second: the length of the array
+    /// @return the minimum, std::numeric_limits<LocType>::max() if the array is empty
+    inline LocType minimum(const LocType *val, IndexType num)
+    {
+        LocType result = std::numeric_limits<LocType>::max();
+        IndexType idx = 0;
+#if defined(MAGICAL_FLOW_RECT_KERNELS_AVX2)
+        if (num >= 8)
+        {
+            __m256i acc = _mm256_set1_epi32(result);
+            for (; idx + 8 <= num; idx += 8)
+            {
+                acc = _mm256_min_epi32(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(val + idx)));
+            }
+            __m128i m = _mm_min_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+            m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+            m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+            result = _mm_cvtsi128_si32(m);
+        }
+#elif defined(MAGICAL_FLOW_RECT_KERNELS_NEON)
+        if (num >= 4)
+        {
+            int32x4_t acc = vdupq_n_s32(result);
+            for (; idx + 4 <= num; idx += 4)
+            {
+                acc = vminq_s32(acc, vld1q_s32(val + idx));
+            }
+            result = vminvq_s32(acc);
+        }
+#endif
+        for (; idx < num; ++idx)
+        {
+            result = std::min(result, val[idx]);
+        }
+        return result;
+    }
+
+    /// @brief the maximum of an array
+    /// @param first: the array
+    /// @param second: the length of the array
+    /// @return the maximum, std::numeric_limits<LocType>::min() if the array is empty
+    inline LocType maximum(const LocType *val, IndexType num)
+    {
+        LocType result = std::numeric_limits<LocType>::min();
+        IndexType idx = 0;
+#if defined(MAGICAL_FLOW_RECT_KERNELS_AVX2)
+        if (num >= 8)
+        {
+            __m256i acc = _mm256_set1_epi32(result);
+            for (; idx + 8 <= num; idx += 8)
+            {
+                acc = _mm256_max_epi32(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(val + idx)));
+            }
+            __m128i m = _mm_max_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+            m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+            m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+            result = _mm_cvtsi128_si32(m);
+        }
+#elif defined(MAGICAL_FLOW_RECT_KERNELS_NEON)
+        if (num >= 4)
+        {
+            int32x4_t acc = vdupq_n_s32(result);
+            for (; idx + 4 <= num; idx += 4)
+            {
+                acc = vmaxq_s32(acc, vld1q_s32(val + idx));
+            }
+            result = vmaxvq_s32(acc);
+        }
+#endif
+        for (; idx < num; ++idx)
+        {
+            result = std::max(result, val[idx]);
+        }
+        return result;
+    }
+
+    /// @brief the bounding box of the rectangles
+    /// @param first to fourth: the coordinate arrays
+    /// @param fifth: the number of rectangles
+    /// @return the bounding box. If there is no rectangle, the box is inverted (lower corner at max, upper corner at min) and can be used as the identity of Box::unionBox
+    inline Box<LocType> boundingBox(const LocType *xLo, const LocType *yLo, const LocType *xHi, const LocType *yHi, IndexType num)
+    {
+        return Box<LocType>(minimum(xLo, num), minimum(yLo, num), maximum(xHi, num), maximum(yHi, num));
+    }
+
+    /// @brief the bounds of the rectangles hitting a box, i.e. a rectangle hits if its xLo <= xHi and its xHi >= xLo, the same in y.
+    /// Box::intersect uses the box itself. Box::overlap shrinks it by one
+    /// @param first: the query box
+    /// @param second: whether the touching rectangles hit
+    /// @param third: output the bounds
+    /// @return false if no rectangle can hit
+    inline bool hitBounds(const Box<LocType> &box, bool touch, Box<LocType> &bounds)
+    {
+        if (touch)
+        {
+            bounds = box;
+            return true;
+        }
+        if (box.xLo() == std::numeric_limits<LocType>::max() || box.yLo() == std::numeric_limits<LocType>::max()
+                || box.xHi() == std::numeric_limits<LocType>::min() || box.yHi() == std::numeric_limits<LocType>::min())
+        {
+            return false;
+        }
+        bounds = Box<LocType>(box.xLo() + 1, box.yLo() + 1, box.xHi() - 1, box.yHi() - 1);
+        return true;
+    }
+
+    /// @brief whether the rectangles overlap with a box
+    /// @param first to fourth: the coordinate arrays
+    /// @param fifth: the number of rectangles
+    /// @param sixth: the query box
+    /// @param seventh: if true, the rectangles touching the box are included (Box::intersect). Otherwise only the ones sharing area (Box::overlap)
+    /// @param eighth: output 1 for the overlapping rectangles and 0 for the others, one per rectangle
+    inline void overlapMask(const LocType *xLo, const LocType *yLo, const LocType *xHi, const LocType *yHi, IndexType num,
+            const Box<LocType> &box, bool touch, unsigned char *mask)
+    {
+        Box<LocType> b;
+        if (!hitBounds(box, touch, b))
+        {
+            std::fill(mask, mask + num, 0);
+            return;
+        }
+        IndexType idx = 0;
+#if defined(MAGICAL_FLOW_RECT_KERNELS_AVX512)
+        const __m512i bxLo = _mm512_set1_epi32(b.xLo()), byLo = _mm512_set1_epi32(b.yLo());
+        const __m512i bxHi = _mm512_set1_epi32(b.xHi()), byHi = _mm512_set1_epi32(b.yHi());
+        for (; idx + 16 <= num; idx += 16)
+        {
+            __mmask16 miss = _mm512_cmpgt_epi32_mask(_mm512_loadu_si512(xLo + idx), bxHi)
+                | _mm512_cmpgt_epi32_mask(bxLo, _mm512_loadu_si512(xHi + idx))
+                | _mm512_cmpgt_epi32_mask(_mm512_loadu_si512(yLo + idx), byHi)
+                | _mm512_cmpgt_epi32_mask(byLo, _mm512_loadu_si512(yHi + idx));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(mask + idx), _mm512_mask_cvtepi32_epi8(_mm_setzero_si128(), 0xffff, _mm512_maskz_set1_epi32(static_cast<__mmask16>(~miss), 1)));
+        }
+#elif defined(MAGICAL_FLOW_RECT_KERNELS_AVX2)
+        const __m256i bxLo = _mm256_set1_epi32(b.xLo()), byLo = _mm256_set1_epi32(b.yLo());
+        const __m256i bxHi = _mm256_set1_epi32(b.xHi()), byHi = _mm256_set1_epi32(b.yHi());
+        for (; idx + 8 <= num; idx += 8)
+        {
+            __m256i miss = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(xLo + idx)), bxHi),
+                        _mm256_cmpgt_epi32(bxLo, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(xHi + idx)))),
+                    _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(yLo + idx)), byHi),
+                        _mm256_cmpgt_epi32(byLo, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(yHi + idx)))));
+            int hits = ~_mm256_movemask_ps(_mm256_castsi256_ps(miss));
+            for (IndexType lane = 0; lane < 8; ++lane)
+            {
+                mask[idx + lane] = (hits >> lane) & 1;
+            }
+        }
+#elif defined(MAGICAL_FLOW_RECT_KERNELS_NEON)
+        const int32x4_t bxLo = vdupq_n_s32(b.xLo()), byLo = vdupq_n_s32(b.yLo());
+        const int32x4_t bxHi = vdupq_n_s32(b.xHi()), byHi = vdupq_n_s32(b.yHi());
+        for (; idx + 4 <= num; idx += 4)
+        {
+            uint32x4_t hit = vandq_u32(vandq_u32(vcleq_s32(vld1q_s32(xLo + idx), bxHi), vcleq_s32(bxLo, vld1q_s32(xHi + idx))),
+                    vandq_u32(vcleq_s32(vld1q_s32(yLo + idx), byHi), vcleq_s32(byLo, vld1q_s32(yHi + idx))));
+            uint16x4_t narrow = vmovn_u32(vshrq_n_u32(hit, 31));
+            uint8x8_t bytes = vmovn_u16(vcombine_u16(narrow, narrow));
+            vst1_lane_u32(reinterpret_cast<uint32_t *>(mask + idx), vreinterpret_u32_u8(bytes), 0);
+        }
+#endif
+        for (; idx < num; ++idx)
+        {
+            mask[idx] = xLo[idx] <= b.xHi() && xHi[idx] >= b.xLo() && yLo[idx] <= b.yHi() && yHi[idx] >= b.yLo();
+        }
+    }
+
+    /// @brief select the rectangles of a candidate list overlapping with a box
+    /// @param first to fourth: the coordinate arrays
+    /// @param fifth: the indices of the candidate rectangles
+    /// @param sixth: the number of candidates
+    /// @param seventh: the query box
+    /// @param eighth: if true, the rectangles touching the box are included (Box::intersect). Otherwise only the ones sharing area (Box::overlap)
+    /// @param ninth: output the selected indices in the order of the candidates. May be the candidate array
+    /// @return the number of selected rectangles
+    inline IndexType filterOverlap(const LocType *xLo, const LocType *yLo, const LocType *xHi, const LocType *yHi,
+            const IndexType *candidates, IndexType num, const Box<LocType> &box, bool touch, IndexType *result)
+    {
+        Box<LocType> b;
+        if (!hitBounds(box, touch, b))
+        {
+            return 0;
+        }
+        IndexType idx = 0, numResult = 0;
+#if defined(MAGICAL_FLOW_RECT_KERNELS_AVX512)
+        const __m512i bxLo = _mm512_set1_epi32(b.xLo()), byLo = _mm512_set1_epi32(b.yLo());
+        const __m512i bxHi = _mm512_set1_epi32(b.xHi()), byHi = _mm512_set1_epi32(b.yHi());
+        // Gather into zeros: the unmasked gather leaves its source undefined, which GCC warns about
+        const __m512i zero = _mm512_setzero_si512();
+        for (; idx + 16 <= num; idx += 16)
+        {
+            __m512i rects = _mm512_loadu_si512(candidates + idx);
+            __mmask16 miss = _mm512_cmpgt_epi32_mask(_mm512_mask_i32gather_epi32(zero, 0xffff, rects, xLo, 4), bxHi)
+                | _mm512_cmpgt_epi32_mask(bxLo, _mm512_mask_i32gather_epi32(zero, 0xffff, rects, xHi, 4))
+                | _mm512_cmpgt_epi32_mask(_mm512_mask_i32gather_epi32(zero, 0xffff, rects, yLo, 4), byHi)
+                | _mm512_cmpgt_epi32_mask(byLo, _mm512_mask_i32gather_epi32(zero, 0xffff, rects, yHi, 4));
+            __mmask16 hits = static_cast<__mmask16>(~miss);
+            _mm512_mask_compressstoreu_epi32(result + numResult, hits, rects);
+            numResult += __builtin_popcount(hits);
+        }
+#elif defined(MAGICAL_FLOW_RECT_KERNELS_AVX2)
+        const __m256i bxLo = _mm256_set1_epi32(b.xLo()), byLo = _mm256_set1_epi32(b.yLo());
+        const __m256i bxHi = _mm256_set1_epi32(b.xHi()), byHi = _mm256_set1_epi32(b.yHi());
+        const int *xLoBase = reinterpret_cast<const int *>(xLo), *yLoBase = reinterpret_cast<const int *>(yLo);
+        const int *xHiBase = reinterpret_cast<const int *>(xHi), *yHiBase = reinterpret_cast<const int *>(yHi);
+        IndexType lanes[8];
+        for (; idx + 8 <= num; idx += 8)
+        {
+            __m256i rects = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(candidates + idx));
+            __m256i miss = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_i32gather_epi32(xLoBase, rects, 4), bxHi),
+                        _mm256_cmpgt_epi32(bxLo, _mm256_i32gather_epi32(xHiBase, rects, 4))),
+                    _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_i32gather_epi32(yLoBase, rects, 4), byHi),
+                        _mm256_cmpgt_epi32(byLo, _mm256_i32gather_epi32(yHiBase, rects, 4))));
+            int hits = ~_mm256_movemask_ps(_mm256_castsi256_ps(miss)) & 0xff;
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), rects);
+            for (; hits != 0; hits &= hits - 1)
+            {
+                result[numResult++] = lanes[__builtin_ctz(hits)];
+            }
+        }
+#endif
+        for (; idx < num; ++idx)
+        {
+            const IndexType rectIdx = candidates[idx];
+            if (xLo[rectIdx] <= b.xHi() && xHi[rectIdx] >= b.xLo() && yLo[rectIdx] <= b.yHi() && yHi[rectIdx] >= b.yLo())
+            {
+                result[numResult++] = rectIdx;
+            }
+        }
+        return numResult;
+    }
+
+    /// @brief the spacing of a box to a rectangle, as klib::boxSpacing, with the larger of klib::boxWidth and klib::boxParallelRun
+    /// @param first: the box
+    /// @param second: the rectangle
+    /// @param third: output the spacing
+    /// @param fourth: output the larger width
+    /// @param fifth: output the parallel run length
+    inline void spacing(const Box<LocType> &box, const Box<LocType> &rect, LocType &spacing, LocType &width, LocType &run)
+    {
+        const bool xSep = box.xLo() >= rect.xHi() || rect.xLo() >= box.xHi();
+        const bool ySep = box.yLo() >= rect.yHi() || rect.yLo() >= box.yHi();
+        const LocType xGap = std::max(box.xLo(), rect.xLo()) - std::min(box.xHi(), rect.xHi());
+        const LocType yGap = std::max(box.yLo(), rect.yLo()) - std::min(box.yHi(), rect.yHi());
+        if (xSep && ySep)
+        {
+            // No parallel run: the distance between the corners
+            spacing = static_cast<LocType>(std::hypot(static_cast<double>(-xGap), static_cast<double>(-yGap)));
+            width = run = 0;
+        }
+        else if (xSep)
+        {
+            spacing = xGap;
+            width = std::max(box.xLen(), rect.xLen());
+            run = -yGap;
+        }
+        else if (ySep)
+        {
+            spacing = yGap;
+            width = std::max(box.yLen(), rect.yLen());
+            run = -xGap;
+        }
+        else
+        {
+            spacing = width = run = 0;
+        }
+    }
+
+    /// @brief the spacing of a box to the rectangles of a candidate list, as klib::boxSpacing, with the larger of klib::boxWidth and klib::boxParallelRun
+    /// @param first to fourth: the coordinate arrays
+    /// @param fifth: the indices of the candidate rectangles
+    /// @param sixth: the number of candidates
+    /// @param seventh: the box
+    /// @param eighth: output the spacing to each candidate
+    /// @param ninth: output the larger width of each pair, 0 without a parallel run
+    /// @param tenth: output the parallel run length of each pair
+    inline void spacing(const LocType *xLo, const LocType *yLo, const LocType *xHi, const LocType *yHi,
+            const IndexType *candidates, IndexType num, const Box<LocType> &box, LocType *spacings, LocType *widths, LocType *runs)
+    {
+        IndexType idx = 0;
+#if defined(MAGICAL_FLOW_RECT_KERNELS_AVX2)
+        const __m256i bxLo = _mm256_set1_epi32(box.xLo()), byLo = _mm256_set1_epi32(box.yLo());
+        const __m256i bxHi = _mm256_set1_epi32(box.xHi()), byHi = _mm256_set1_epi32(box.yHi());
+        const __m256i bxLen = _mm256_set1_epi32(box.xLen()), byLen = _mm256_set1_epi32(box.yLen());
+        const int *xLoBase = reinterpret_cast<const int *>(xLo), *yLoBase = reinterpret_cast<const int *>(yLo);
+        const int *xHiBase = reinterpret_cast<const int *>(xHi), *yHiBase = reinterpret_cast<const int *>(yHi);
+        LocType xGaps[8], yGaps[8];
+        for (; idx + 8 <= num; idx += 8)
+        {
+            __m256i rects = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(candidates + idx));
+            __m256i rxLo = _mm256_i32gather_epi32(xLoBase, rects, 4), rxHi = _mm256_i32gather_epi32(xHiBase, rects, 4);
+            __m256i ryLo = _mm256_i32gather_epi32(yLoBase, rects, 4), ryHi = _mm256_i32gather_epi32(yHiBase, rects, 4);
+            // The projections overlap if they share length, as the negation of the separation of klib::boxSpacing
+            __m256i xOver = _mm256_and_si256(_mm256_cmpgt_epi32(bxHi, rxLo), _mm256_cmpgt_epi32(rxHi, bxLo));
+            __m256i yOver = _mm256_and_si256(_mm256_cmpgt_epi32(byHi, ryLo), _mm256_cmpgt_epi32(ryHi, byLo));
+            __m256i xGap = _mm256_sub_epi32(_mm256_max_epi32(bxLo, rxLo), _mm256_min_epi32(bxHi, rxHi));
+            __m256i yGap = _mm256_sub_epi32(_mm256_max_epi32(byLo, ryLo), _mm256_min_epi32(byHi, ryHi));
+            __m256i xRun = _mm256_andnot_si256(xOver, yOver); // Separated in x, running in y
+            __m256i yRun = _mm256_andnot_si256(yOver, xOver);
+            const __m256i zero = _mm256_setzero_si256();
+            __m256i sp = _mm256_or_si256(_mm256_and_si256(xRun, xGap), _mm256_and_si256(yRun, yGap));
+            __m256i run = _mm256_or_si256(_mm256_and_si256(xRun, _mm256_sub_epi32(zero, yGap)), _mm256_and_si256(yRun, _mm256_sub_epi32(zero, xGap)));
+            __m256i width = _mm256_or_si256(_mm256_and_si256(xRun, _mm256_max_epi32(bxLen, _mm256_sub_epi32(rxHi, rxLo))),
+                    _mm256_and_si256(yRun, _mm256_max_epi32(byLen, _mm256_sub_epi32(ryHi, ryLo))));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(spacings + idx), sp);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(widths + idx), width);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(runs + idx), run);
+            // The corner pairs, separated in both directions, take the Euclidean distance
+            int corners = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(xOver, yOver))) & 0xff;
+            if (corners != 0)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(xGaps), xGap);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(yGaps), yGap);
+                for (; corners != 0; corners &= corners - 1)
+                {
+                    const int lane = __builtin_ctz(corners);
+                    spacings[idx + lane] = static_cast<LocType>(std::hypot(static_cast<double>(-xGaps[lane]), static_cast<double>(-yGaps[lane])));
+                }
+            }
+        }
+#endif
+        for (; idx < num; ++idx)
+        {
+            const IndexType rectIdx = candidates[idx];
+            spacing(box, Box<LocType>(xLo[rectIdx], yLo[rectIdx], xHi[rectIdx], yHi[rectIdx]), spacings[idx], widths[idx], runs[idx]);
+        }
+    }
+}
+
+PROJECT_NAMESPACE_END
+
+#endif // MAGICAL_FLOW_RECT_KERNELS_H_
@@ -0,0 +1,65 @@
+/**
+ * @file StringPool.h
+ * @brief Interned strings for the names repeated across the circuit graphs
+ * @date 10/14/2026
+ */
+
+#ifndef ZKUTIL_STRING_POOL_H_
+#define ZKUTIL_STRING_POOL_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include "global/namespace.h"
+#include "util/HeapBytes.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::StringPool
+/// @brief Keep one copy of each distinct string. The interned strings are never moved or freed, so the references stay valid for the life of the pool
+class StringPool
+{
+    public:
+        /// @brief default constructor
+        explicit StringPool() = default;
+        StringPool(const StringPool &) = delete;
+        StringPool & operator=(const StringPool &) = delete;
+        /// @brief get the shared copy of a string
+        /// @param the string
+        /// @return the interned string
+        const std::string & intern(const std::string &str)
+        {
+            if (str.empty())
+            {
+                return empty();
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            return *_strings.insert(str).first;
+        }
+        /// @brief get the number of distinct strings
+        /// @return the number of distinct strings
+        std::size_t size() const { std::lock_guard<std::mutex> lock(_mutex); return _strings.size(); }
+        /// @brief get the heap bytes of the pool: the set nodes, assumed to hold a string, its hash and a link, with the characters, and the buckets
+        /// @return the estimated bytes
+        std::size_t heapBytes() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::size_t bytes = _strings.bucket_count() * sizeof(void *);
+            for (const auto &str : _strings)
+            {
+                bytes += sizeof(std::string) + sizeof(std::size_t) + sizeof(void *) + HeapBytes::of(str);
+            }
+            return bytes;
+        }
+        /// @brief the interned empty string
+        static const std::string & empty() { static const std::string str; return str; }
+        /// @brief the pool of the circuit names: the names of the nodes and the nets
+        static StringPool & names() { static StringPool pool; return pool; }
+    private:
+        std::unordered_set<std::string> _strings; ///< The interned strings. The set nodes are stable under rehashing
+        mutable std::mutex _mutex; ///< The names may be set from several threads
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //ZKUTIL_STRING_POOL_H_
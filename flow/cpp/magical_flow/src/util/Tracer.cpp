@@ -0,0 +1,428 @@
+/**
+ * @file Tracer.cpp
+ * @brief Scoped timers, sampled quantities and named counters, kept in per-thread buffers and flushed as a Chrome trace and a summary table
+ * @date 10/14/2026
+ */
+
+#include "util/Tracer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "global/global.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace
+{
+    /// @brief a timed event
+    struct TraceEvent
+    {
+        std::string name;
+        std::string category;
+        std::int64_t start;
+        std::int64_t duration;
+    };
+
+    /// @brief a sampled value of a quantity
+    struct TraceSample
+    {
+        std::string name;
+        std::int64_t time;
+        std::int64_t value;
+    };
+
+    /// @brief the events, the samples and the counters of one thread. The lock is only contended while flushing
+    struct ThreadBuffer
+    {
+        explicit ThreadBuffer(IndexType tid_) : tid(tid_) {}
+        IndexType tid; ///< The thread id in the trace, in the order of the first record
+        std::mutex mutex;
+        std::vector<TraceEvent> events;
+        std::vector<TraceSample> samples;
+        std::unordered_map<std::string, std::int64_t> counters;
+    };
+
+    /// @brief the buffers of all the threads. They outlive their threads, so that the events of the finished workers are kept
+    struct TraceRegistry
+    {
+        std::atomic<bool> enabled{false};
+        std::atomic<bool> memoryTracking{false};
+        std::atomic<IntType> memoryDepth{0}; ///< The number of active ScopedMemoryPeak
+        std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    };
+
+    TraceRegistry & registry()
+    {
+        static TraceRegistry reg;
+        return reg;
+    }
+
+    ThreadBuffer & threadBuffer()
+    {
+        thread_local std::shared_ptr<ThreadBuffer> buffer;
+        if (!buffer)
+        {
+            auto &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            buffer = std::make_shared<ThreadBuffer>(reg.buffers.size());
+            reg.buffers.emplace_back(buffer);
+        }
+        return *buffer;
+    }
+
+    /// @brief the snapshot of the buffers of all the threads
+    struct TraceSnapshot
+    {
+        std::vector<std::pair<IndexType, TraceEvent>> events; ///< The events with their threads, by their start times
+        std::vector<TraceSample> samples; ///< The samples, by their times
+        std::map<std::string, std::int64_t> counters; ///< The totals of the counters, by their names
+    };
+
+    TraceSnapshot snapshot()
+    {
+        TraceSnapshot snap;
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto &buffer : reg.buffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            for (const auto &event : buffer->events)
+            {
+                snap.events.emplace_back(buffer->tid, event);
+            }
+            snap.samples.insert(snap.samples.end(), buffer->samples.begin(), buffer->samples.end());
+            for (const auto &counter : buffer->counters)
+            {
+                snap.counters[counter.first] += counter.second;
+            }
+        }
+        std::stable_sort(snap.events.begin(), snap.events.end(),
+                [](const std::pair<IndexType, TraceEvent> &lhs, const std::pair<IndexType, TraceEvent> &rhs) { return lhs.second.start < rhs.second.start; });
+        std::stable_sort(snap.samples.begin(), snap.samples.end(), [](const TraceSample &lhs, const TraceSample &rhs) { return lhs.time < rhs.time; });
+        return snap;
+    }
+
+    /// @brief read a field of /proc/self/status in kB, such as "VmRSS"
+    /// @return the bytes. 0 if not found
+    std::int64_t readStatusBytes(const char *field)
+    {
+        FILE *fp = std::fopen("/proc/self/status", "r");
+        if (fp == nullptr)
+        {
+            return 0;
+        }
+        const std::size_t fieldLen = std::strlen(field);
+        std::int64_t bytes = 0;
+        char line[256];
+        while (std::fgets(line, sizeof(line), fp) != nullptr)
+        {
+            long long kb = 0;
+            if (std::strncmp(line, field, fieldLen) == 0 && line[fieldLen] == ':' && std::sscanf(line + fieldLen + 1, "%lld", &kb) == 1)
+            {
+                bytes = static_cast<std::int64_t>(kb) * 1024;
+                break;
+            }
+        }
+        std::fclose(fp);
+        return bytes;
+    }
+
+    /// @brief write a string as a JSON string literal
+    void writeJsonString(FILE *fp, const std::string &str)
+    {
+        std::fputc('"', fp);
+        for (char c : str)
+        {
+            switch (c)
+            {
+                case '"': std::fputs("\\\"", fp); break;
+                case '\\': std::fputs("\\\\", fp); break;
+                case '\n': std::fputs("\\n", fp); break;
+                case '\t': std::fputs("\\t", fp); break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        std::fprintf(fp, "\\u%04x", static_cast<unsigned>(c));
+                    }
+                    else
+                    {
+                        std::fputc(c, fp);
+                    }
+            }
+        }
+        std::fputc('"', fp);
+    }
+}
+
+void Tracer::enable(bool enabled)
+{
+    registry().enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Tracer::enabled()
+{
+    return registry().enabled.load(std::memory_order_relaxed);
+}
+
+std::int64_t Tracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - registry().epoch).count();
+}
+
+void Tracer::addEvent(const std::string &name, const std::string &category, std::int64_t start, std::int64_t duration)
+{
+    auto &buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.emplace_back(TraceEvent{name, category, start, duration});
+}
+
+void Tracer::count(const std::string &name, std::int64_t delta)
+{
+    if (!enabled())
+    {
+        return;
+    }
+    auto &buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.counters[name] += delta;
+}
+
+void Tracer::sample(const std::string &name, std::int64_t value)
+{
+    if (!enabled())
+    {
+        return;
+    }
+    const std::int64_t time = now();
+    auto &buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.samples.emplace_back(TraceSample{name, time, value});
+}
+
+std::int64_t Tracer::lastSample(const std::string &name)
+{
+    const auto snap = snapshot();
+    auto it = std::find_if(snap.samples.rbegin(), snap.samples.rend(), [&](const TraceSample &sample) { return sample.name == name; });
+    return it == snap.samples.rend() ? 0 : it->value;
+}
+
+std::int64_t Tracer::counter(const std::string &name)
+{
+    const auto snap = snapshot();
+    auto it = snap.counters.find(name);
+    return it == snap.counters.end() ? 0 : it->second;
+}
+
+std::size_t Tracer::numEvents()
+{
+    auto &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::size_t num = 0;
+    for (const auto &buffer : reg.buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        num += buffer->events.size();
+    }
+    return num;
+}
+
+void Tracer::enableMemoryTracking(bool enabled)
+{
+    registry().memoryTracking.store(enabled, std::memory_order_relaxed);
+}
+
+bool Tracer::memoryTrackingEnabled()
+{
+    return registry().memoryTracking.load(std::memory_order_relaxed);
+}
+
+std::int64_t Tracer::residentBytes()
+{
+    return readStatusBytes("VmRSS");
+}
+
+std::int64_t Tracer::peakResidentBytes()
+{
+    return readStatusBytes("VmHWM");
+}
+
+bool Tracer::resetPeakResident()
+{
+    // Writing 5 resets the peak resident set size of the process since Linux 4.0
+    FILE *fp = std::fopen("/proc/self/clear_refs", "w");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+    bool good = std::fputs("5", fp) >= 0;
+    good = std::fclose(fp) == 0 && good;
+    return good;
+}
+
+bool Tracer::writeChromeTrace(const std::string &fileName)
+{
+    const auto snap = snapshot();
+    FILE *fp = std::fopen(fileName.c_str(), "w");
+    if (fp == nullptr)
+    {
+        ERR("Tracer: cannot write %s \n", fileName.c_str());
+        return false;
+    }
+    std::fputs("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n", fp);
+    bool first = true;
+    for (const auto &pair : snap.events)
+    {
+        const auto &event = pair.second;
+        std::fputs(first ? "  " : ",\n  ", fp);
+        first = false;
+        std::fputs("{\"ph\": \"X\", \"pid\": 1, \"tid\": ", fp);
+        std::fprintf(fp, "%u, \"ts\": %lld, \"dur\": %lld, \"name\": ", pair.first, static_cast<long long>(event.start), static_cast<long long>(event.duration));
+        writeJsonString(fp, event.name);
+        std::fputs(", \"cat\": ", fp);
+        writeJsonString(fp, event.category);
+        std::fputc('}', fp);
+    }
+    for (const auto &sample : snap.samples)
+    {
+        std::fputs(first ? "  " : ",\n  ", fp);
+        first = false;
+        std::fprintf(fp, "{\"ph\": \"C\", \"pid\": 1, \"tid\": 0, \"ts\": %lld, \"name\": ", static_cast<long long>(sample.time));
+        writeJsonString(fp, sample.name);
+        std::fprintf(fp, ", \"args\": {\"value\": %lld}}", static_cast<long long>(sample.value));
+    }
+    // The counters at the time of the flush
+    const long long flushTime = static_cast<long long>(now());
+    for (const auto &counter : snap.counters)
+    {
+        std::fputs(first ? "  " : ",\n  ", fp);
+        first = false;
+        std::fprintf(fp, "{\"ph\": \"C\", \"pid\": 1, \"tid\": 0, \"ts\": %lld, \"name\": ", flushTime);
+        writeJsonString(fp, counter.first);
+        std::fputs(", \"args\": {\"value\": ", fp);
+        std::fprintf(fp, "%lld}}", static_cast<long long>(counter.second));
+    }
+    std::fputs("\n]}\n", fp);
+    bool good = std::ferror(fp) == 0;
+    good = std::fclose(fp) == 0 && good;
+    if (!good)
+    {
+        ERR("Tracer: failed to write %s \n", fileName.c_str());
+    }
+    return good;
+}
+
+std::string Tracer::summary()
+{
+    const auto snap = snapshot();
+    /// @brief the statistics of the events of a category and a name
+    struct Stat
+    {
+        std::int64_t calls = 0;
+        std::int64_t total = 0;
+        std::int64_t longest = 0;
+    };
+    std::map<std::pair<std::string, std::string>, Stat> stats;
+    for (const auto &pair : snap.events)
+    {
+        auto &stat = stats[std::make_pair(pair.second.category, pair.second.name)];
+        ++stat.calls;
+        stat.total += pair.second.duration;
+        stat.longest = std::max(stat.longest, pair.second.duration);
+    }
+    // The categories in their order, and the most expensive names first in each
+    std::vector<std::pair<std::pair<std::string, std::string>, Stat>> rows(stats.begin(), stats.end());
+    std::stable_sort(rows.begin(), rows.end(), [](const std::pair<std::pair<std::string, std::string>, Stat> &lhs, const std::pair<std::pair<std::string, std::string>, Stat> &rhs)
+            { return lhs.first.first != rhs.first.first ? lhs.first.first < rhs.first.first : lhs.second.total > rhs.second.total; });
+    std::string table;
+    char line[512];
+    std::snprintf(line, sizeof(line), "%-16s %-32s %8s %12s %12s\n", "category", "name", "calls", "total(ms)", "longest(ms)");
+    table += line;
+    for (const auto &row : rows)
+    {
+        std::snprintf(line, sizeof(line), "%-16s %-32s %8lld %12.3f %12.3f\n", row.first.first.c_str(), row.first.second.c_str(),
+                static_cast<long long>(row.second.calls), row.second.total / 1000.0, row.second.longest / 1000.0);
+        table += line;
+    }
+    // The samples of each quantity: their number, the latest and the largest
+    struct SampleStat
+    {
+        std::int64_t num = 0;
+        std::int64_t last = 0;
+        std::int64_t largest = 0;
+    };
+    std::map<std::string, SampleStat> samples;
+    for (const auto &sample : snap.samples)
+    {
+        auto &stat = samples[sample.name];
+        stat.largest = stat.num == 0 ? sample.value : std::max(stat.largest, sample.value);
+        stat.last = sample.value;
+        ++stat.num;
+    }
+    if (!samples.empty())
+    {
+        std::snprintf(line, sizeof(line), "%-16s %-32s %8s %12s %12s\n", "", "", "samples", "last", "largest");
+        table += line;
+    }
+    for (const auto &sample : samples)
+    {
+        std::snprintf(line, sizeof(line), "%-16s %-32s %8lld %12lld %12lld\n", "sample", sample.first.c_str(),
+                static_cast<long long>(sample.second.num), static_cast<long long>(sample.second.last), static_cast<long long>(sample.second.largest));
+        table += line;
+    }
+    for (const auto &counter : snap.counters)
+    {
+        std::snprintf(line, sizeof(line), "%-16s %-32s %8lld\n", "counter", counter.first.c_str(), static_cast<long long>(counter.second));
+        table += line;
+    }
+    return table;
+}
+
+void Tracer::clear()
+{
+    auto &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto &buffer : reg.buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+        buffer->samples.clear();
+        buffer->counters.clear();
+    }
+}
+
+ScopedMemoryPeak::ScopedMemoryPeak(const char *name)
+    : _active(Tracer::enabled() && Tracer::memoryTrackingEnabled())
+{
+    if (_active)
+    {
+        _name = name;
+        if (registry().memoryDepth.fetch_add(1) == 0)
+        {
+            Tracer::resetPeakResident();
+        }
+        _startBytes = Tracer::residentBytes();
+        Tracer::sample(_name + " rss", _startBytes);
+    }
+}
+
+ScopedMemoryPeak::~ScopedMemoryPeak()
+{
+    if (_active)
+    {
+        // The mark is not reset where clear_refs is not writable: the peak is then the one of the process
+        Tracer::sample(_name + " peak rss", std::max(Tracer::peakResidentBytes(), _startBytes));
+        Tracer::sample(_name + " rss", Tracer::residentBytes());
+        registry().memoryDepth.fetch_sub(1);
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,180 @@
+/**
+ * @file Tracer.h
+ * @brief Scoped timers, sampled quantities and named counters, kept in per-thread buffers and flushed as a Chrome trace and a summary table
+ * @date 10/14/2026
+ */
+
+#ifndef ZKUTIL_TRACER_H_
+#define ZKUTIL_TRACER_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include "global/namespace.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::Tracer
+/// @brief the instrumentation of the flow, next to MsgPrinter. Disabled by default, in which case recording costs one atomic load,
+/// as long as the call site builds no name: pass the names as literals, and a name made of a literal and a string as the two parts to ScopedTimer.
+/// Check enabled() before computing anything else only recorded.
+/// Each thread records its timed events and its counters into its own buffer, so that the workers of the flow do not contend.
+/// The buffers are merged when flushed: as the Chrome trace JSON of chrome://tracing or Perfetto, and as a summary table per category and name
+class Tracer
+{
+    public:
+        /// @brief turn the recording on or off. The recorded events are kept
+        /// @param whether to record
+        static void enable(bool enabled);
+        /// @brief get whether recording is on
+        static bool enabled();
+        /// @brief get the time since the first use of the tracer
+        /// @return the time in microseconds
+        static std::int64_t now();
+        /// @brief record a timed event of the calling thread
+        /// @param first: the name, such as the circuit or the step
+        /// @param second: the category, such as the stage of the flow
+        /// @param third: the start time from now()
+        /// @param fourth: the duration in microseconds
+        static void addEvent(const std::string &name, const std::string &category, std::int64_t start, std::int64_t duration);
+        /// @brief add to a named counter of the calling thread
+        /// @param first: the name, such as "rects inserted"
+        /// @param second: the increment
+        static void count(const std::string &name, std::int64_t delta = 1);
+        /// @brief add to a named counter of the calling thread, making the name only if the tracer is enabled
+        /// @param first: the name, such as "rects inserted"
+        /// @param second: the increment
+        static void count(const char *name, std::int64_t delta = 1)
+        {
+            if (enabled())
+            {
+                count(std::string(name), delta);
+            }
+        }
+        /// @brief get the total of a counter over all the threads
+        /// @param the name
+        /// @return the total. 0 if never counted
+        static std::int64_t counter(const std::string &name);
+        /// @brief record the value of a quantity at this time, such as the bytes of a component or the resident memory.
+        /// Unlike a counter, every sample is kept with its time, as a counter track of the Chrome trace
+        /// @param first: the name of the quantity
+        /// @param second: the value
+        static void sample(const std::string &name, std::int64_t value);
+        /// @brief get the latest sample of a quantity over all the threads
+        /// @param the name
+        /// @return the value. 0 if never sampled
+        static std::int64_t lastSample(const std::string &name);
+        /// @brief get the number of events over all the threads
+        static std::size_t numEvents();
+        /// @brief turn the resident memory tracking of ScopedMemoryPeak on or off. Off by default, as it resets the high-water mark of the process
+        /// @param whether to track
+        static void enableMemoryTracking(bool enabled);
+        /// @brief get whether the resident memory is tracked
+        static bool memoryTrackingEnabled();
+        /// @brief get the resident set size of the process, VmRSS of /proc/self/status
+        /// @return the bytes. 0 where not available
+        static std::int64_t residentBytes();
+        /// @brief get the high-water mark of the resident set size, VmHWM of /proc/self/status
+        /// @return the bytes. 0 where not available
+        static std::int64_t peakResidentBytes();
+        /// @brief reset the high-water mark of the resident set size to the current size, through /proc/self/clear_refs
+        /// @return whether it is reset
+        static bool resetPeakResident();
+        /// @brief write the events, the samples and the counters as Chrome trace JSON
+        /// @param the file name
+        /// @return whether successful
+        static bool writeChromeTrace(const std::string &fileName);
+        /// @brief get the table of the calls, total and longest times per category and name, followed by the latest and the largest samples and the counters
+        /// @return the table
+        static std::string summary();
+        /// @brief remove all the events, the samples and the counters
+        static void clear();
+};
+
+/// @class MAGICAL_FLOW::ScopedTimer
+/// @brief record the lifetime of a scope as an event, if the tracer is enabled when the scope begins
+class ScopedTimer
+{
+    public:
+        /// @brief start timing
+        /// @param first: the name of the event
+        /// @param second: the category of the event
+        explicit ScopedTimer(std::string name, std::string category = "flow")
+            : _active(Tracer::enabled())
+        {
+            if (_active)
+            {
+                _name = std::move(name);
+                _category = std::move(category);
+                _start = Tracer::now();
+            }
+        }
+        /// @brief start timing, making the strings only if the tracer is enabled
+        /// @param first: the name of the event
+        /// @param second: the category of the event
+        explicit ScopedTimer(const char *name, const char *category = "flow")
+            : _active(Tracer::enabled())
+        {
+            if (_active)
+            {
+                _name = name;
+                _category = category;
+                _start = Tracer::now();
+            }
+        }
+        /// @brief start timing an event named by a prefix and a suffix, such as the step and the circuit, joined only if the tracer is enabled
+        /// @param first: the prefix of the name
+        /// @param second: the suffix of the name
+        /// @param third: the category of the event
+        explicit ScopedTimer(const char *prefix, const std::string &suffix, const char *category)
+            : _active(Tracer::enabled())
+        {
+            if (_active)
+            {
+                _name = prefix;
+                _name += suffix;
+                _category = category;
+                _start = Tracer::now();
+            }
+        }
+        /// @brief stop timing and record the event
+        ~ScopedTimer()
+        {
+            if (_active)
+            {
+                Tracer::addEvent(_name, _category, _start, Tracer::now() - _start);
+            }
+        }
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer & operator=(const ScopedTimer &) = delete;
+    private:
+        bool _active; ///< Whether the tracer was enabled at the start
+        std::string _name; ///< The name of the event
+        std::string _category; ///< The category of the event
+        std::int64_t _start = 0; ///< The start time
+};
+
+/// @class MAGICAL_FLOW::ScopedMemoryPeak
+/// @brief sample the resident memory of the process at the beginning and the end of a scope, and its high-water mark during the scope,
+/// if the tracer and its memory tracking are enabled when the scope begins. The samples are named "<name> rss" and "<name> peak rss".
+/// Only the outermost of the nested scopes resets the mark, so the peak of an inner scope is the peak since the outermost one began.
+/// The memory is of the whole process, including the other threads
+class ScopedMemoryPeak
+{
+    public:
+        /// @brief reset the high-water mark and sample the resident memory
+        /// @param the name of the scope, copied only if the tracking is enabled
+        explicit ScopedMemoryPeak(const char *name);
+        /// @brief sample the resident memory and its high-water mark
+        ~ScopedMemoryPeak();
+        ScopedMemoryPeak(const ScopedMemoryPeak &) = delete;
+        ScopedMemoryPeak & operator=(const ScopedMemoryPeak &) = delete;
+    private:
+        bool _active; ///< Whether the tracking was enabled at the start
+        std::string _name; ///< The name of the scope
+        std::int64_t _startBytes = 0; ///< The resident memory at the start
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //ZKUTIL_TRACER_H_
@@ -0,0 +1,88 @@
+/**
+ * @file UnionFind.h
+ * @brief A union-find of indices that can be united from multiple threads
+ * @date 10/14/2026
+ */
+
+#ifndef ZKUTIL_UNION_FIND_H_
+#define ZKUTIL_UNION_FIND_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include "global/type.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+/// @class MAGICAL_FLOW::ConcurrentUnionFind
+/// @brief Lock-free disjoint sets over [0, size). The larger root is always linked under the smaller one with a compare-and-swap, and find halves the paths.
+/// unite and find may be called concurrently. After all the unions, the root of a set is its smallest element
+class ConcurrentUnionFind
+{
+    public:
+        /// @brief constructor
+        /// @param the number of elements, each in its own set
+        explicit ConcurrentUnionFind(IndexType size) : _size(size), _parents(new std::atomic<IndexType>[size])
+        {
+            for (IndexType idx = 0; idx < size; ++idx)
+            {
+                _parents[idx].store(idx, std::memory_order_relaxed);
+            }
+        }
+        /// @brief get the number of elements
+        IndexType size() const { return _size; }
+        /// @brief find the root of the set of an element
+        /// @param the element
+        /// @return the root
+        IndexType find(IndexType idx)
+        {
+            while (true)
+            {
+                IndexType parent = _parents[idx].load(std::memory_order_acquire);
+                if (parent == idx)
+                {
+                    return idx;
+                }
+                IndexType grand = _parents[parent].load(std::memory_order_acquire);
+                if (grand != parent)
+                {
+                    // Path halving. Losing the race is harmless, the parent only moves towards the root
+                    _parents[idx].compare_exchange_weak(parent, grand, std::memory_order_acq_rel);
+                }
+                idx = grand;
+            }
+        }
+        /// @brief unite the sets of two elements
+        /// @param first: an element
+        /// @param second: the other element
+        /// @return whether they were in different sets
+        bool unite(IndexType lhs, IndexType rhs)
+        {
+            while (true)
+            {
+                lhs = this->find(lhs);
+                rhs = this->find(rhs);
+                if (lhs == rhs)
+                {
+                    return false;
+                }
+                if (lhs < rhs)
+                {
+                    std::swap(lhs, rhs);
+                }
+                // Link the larger root, unless another thread has linked it meanwhile
+                IndexType expected = lhs;
+                if (_parents[lhs].compare_exchange_strong(expected, rhs, std::memory_order_acq_rel))
+                {
+                    return true;
+                }
+            }
+        }
+    private:
+        IndexType _size = 0; ///< The number of elements
+        std::unique_ptr<std::atomic<IndexType>[]> _parents; ///< The parent of each element, itself for a root
+};
+
+PROJECT_NAMESPACE_END
+
+#endif //ZKUTIL_UNION_FIND_H_
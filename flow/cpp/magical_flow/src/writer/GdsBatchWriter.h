@@ -0,0 +1,332 @@
+/**
+ * @file GdsBatchWriter.h
+ * @brief Write the layouts of many circuits into GDSII at once, encoded in parallel while the encoded ones are being written
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_GDS_BATCH_WRITER_H_
+#define MAGICAL_FLOW_GDS_BATCH_WRITER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "writer/GdsStreamWriter.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace WRITER
+{
+    /// @class MAGICAL_FLOW::WRITER::OrderedWriteBehind
+    /// @brief the encoded bytes of the slots of a batch, handed to a sink by a background thread in the order of the slots while the next slots are being encoded.
+    /// At most a window of slots is held ahead of the sink, which bounds the memory. Every slot should be put exactly once
+    class OrderedWriteBehind
+    {
+        public:
+            /// @brief write the bytes of a slot. Returns whether successful
+            using Sink = std::function<bool(IndexType slot, const std::string &bytes)>;
+            /// @brief constructor. Starts the background thread
+            /// @param first: the number of slots
+            /// @param second: the number of slots which may be put ahead of the sink, at least 1
+            /// @param third: the sink, called from the background thread
+            explicit OrderedWriteBehind(IndexType numSlots, IndexType window, Sink sink)
+                : _bytes(numSlots), _ready(numSlots, false), _window(std::max(window, static_cast<IndexType>(1))), _sink(std::move(sink))
+            {
+                _thread = std::thread([this]() { this->run(); });
+            }
+            /// @brief destructor. Waits for the sink
+            ~OrderedWriteBehind() { this->finish(); }
+            /// @brief hand over the bytes of a slot. Blocks while the slot is a window ahead of the sink
+            /// @param first: the slot
+            /// @param second: the bytes
+            void put(IndexType slot, std::string bytes)
+            {
+                AssertMsg(slot < _bytes.size(), "OrderedWriteBehind::put: slot %u out of %lu \n", slot, _bytes.size());
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cv.wait(lock, [&]() { return slot < _numDone + _window; });
+                _bytes[slot] = std::move(bytes);
+                _ready[slot] = true;
+                _cv.notify_all();
+            }
+            /// @brief wait until all the slots are through the sink
+            /// @return the number of slots the sink wrote successfully
+            IndexType finish()
+            {
+                if (_thread.joinable())
+                {
+                    _thread.join();
+                }
+                return _numWritten;
+            }
+        private:
+            void run()
+            {
+                for (IndexType slot = 0; slot < _bytes.size(); ++slot)
+                {
+                    std::string bytes;
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _cv.wait(lock, [&]() { return _ready[slot]; });
+                        bytes.swap(_bytes[slot]);
+                    }
+                    const bool written = _sink(slot, bytes);
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        ++_numDone;
+                        _numWritten += written ? 1 : 0;
+                    }
+                    _cv.notify_all();
+                }
+            }
+        private:
+            std::vector<std::string> _bytes; ///< The bytes of the slots put and not yet through the sink
+            std::vector<bool> _ready; ///< Whether each slot is put
+            IndexType _window; ///< The number of slots which may be put ahead of the sink
+            Sink _sink; ///< The sink
+            IndexType _numDone = 0; ///< The number of slots through the sink
+            IndexType _numWritten = 0; ///< The number of slots the sink wrote successfully
+            std::mutex _mutex;
+            std::condition_variable _cv;
+            std::thread _thread; ///< The thread calling the sink
+    };
+}
+
+/// @class MAGICAL_FLOW::GdsBatchWriter
+/// @brief Write the layouts of many circuits into GDSII in one call: the records of the circuits, or of the cells of a merged library, are encoded by the OpenMP threads
+/// into their own buffers with a GdsStreamWriter each, while a background thread writes the encoded buffers into the files in order.
+/// A .gz file is compressed by the thread of its own stream instead, so that the files are compressed in parallel.
+/// The layouts are only read, after the polygons too large for a GDSII record are sliced in the calling thread
+class GdsBatchWriter
+{
+    public:
+        /// @brief the number of encoded buffers held ahead of the file writes
+        static constexpr IndexType MAX_PENDING_BUFFERS = 16;
+        /// @brief constructor
+        /// @param first: a design database
+        /// @param second: a technology database
+        explicit GdsBatchWriter(const DesignDB &designDB, const TechDB &techDB) : _designDB(designDB), _techDB(techDB) {}
+        /// @brief write the layout of each circuit into its own GDSII file, as GdsStreamWriter::writeGdsLayout
+        /// @param first: the indices of the circuit graphs
+        /// @param second: the output file name of each circuit
+        /// @param third: whether to write each sub circuit once per file as its own structure and reference it, instead of the flattened layout
+        /// @param fourth: the compression level of the file names ending with .gz
+        /// @return the number of files written
+        IndexType writeGdsLayouts(const std::vector<IndexType> &cktIdxs, const std::vector<std::string> &filenames, bool hierarchical = false, int compressionLevel = MfGzip::DEFAULT_LEVEL);
+        /// @brief write one GDSII library with a structure for every distinct cell of the circuits, each once
+        /// @param first: the indices of the circuit graphs, the top structures of the library
+        /// @param second: the output file name
+        /// @param third: whether to write the sub circuits as their own structures and reference them. Otherwise only the circuits, flattened
+        /// @param fourth: the compression level if the file name ends with .gz
+        /// @return if successful
+        bool writeMergedLibrary(const std::vector<IndexType> &cktIdxs, const std::string &filename, bool hierarchical = true, int compressionLevel = MfGzip::DEFAULT_LEVEL);
+        /// @brief get the distinct cells written for circuits, each sub circuit before the circuits instantiating it, by their names as GdsStreamWriter
+        /// @param first: the indices of the circuit graphs
+        /// @param second: whether the sub circuits are written as their own structures
+        /// @return the indices of the circuit graphs of the cells
+        std::vector<IndexType> uniqueCells(const std::vector<IndexType> &cktIdxs, bool hierarchical) const;
+    private:
+        /// @brief add a circuit and, if hierarchical, its sub circuits to the distinct cells
+        void addUniqueCell(IndexType cktIdx, bool hierarchical, std::unordered_set<std::string> &names, std::vector<IndexType> &cells) const;
+    private:
+        const DesignDB &_designDB; ///< The design database
+        const TechDB &_techDB; ///< The technology database
+};
+
+inline std::vector<IndexType> GdsBatchWriter::uniqueCells(const std::vector<IndexType> &cktIdxs, bool hierarchical) const
+{
+    std::unordered_set<std::string> names;
+    std::vector<IndexType> cells;
+    for (IndexType cktIdx : cktIdxs)
+    {
+        this->addUniqueCell(cktIdx, hierarchical, names, cells);
+    }
+    return cells;
+}
+
+inline void GdsBatchWriter::addUniqueCell(IndexType cktIdx, bool hierarchical, std::unordered_set<std::string> &names, std::vector<IndexType> &cells) const
+{
+    const auto &cktGraph = _designDB.subCkt(cktIdx);
+    if (!names.insert(cktGraph.name()).second)
+    {
+        return;
+    }
+    if (hierarchical)
+    {
+        for (IndexType nodeIdx = 0; nodeIdx < cktGraph.numNodes(); ++nodeIdx)
+        {
+            const auto &node = cktGraph.node(nodeIdx);
+            if (!node.isLeaf())
+            {
+                this->addUniqueCell(node.subgraphIdx(), hierarchical, names, cells);
+            }
+        }
+    }
+    cells.emplace_back(cktIdx);
+}
+
+inline IndexType GdsBatchWriter::writeGdsLayouts(const std::vector<IndexType> &cktIdxs, const std::vector<std::string> &filenames, bool hierarchical, int compressionLevel)
+{
+    AssertMsg(cktIdxs.size() == filenames.size(), "GdsBatchWriter::writeGdsLayouts: %lu file names for %lu circuits \n", filenames.size(), cktIdxs.size());
+    ScopedTimer timer("writeGdsBatch", "gds");
+    ScopedMemoryPeak memory("writeGdsBatch");
+    const IndexType numFiles = cktIdxs.size();
+    // Whether each .gz file written by the encoding threads is successful
+    std::vector<Byte> written(numFiles, 0);
+    std::uint64_t numBytes = 0;
+    WRITER::OrderedWriteBehind writes(numFiles, MAX_PENDING_BUFFERS, [&](IndexType slot, const std::string &bytes)
+    {
+        if (MfGzip::isGzipFileName(filenames[slot]))
+        {
+            return written[slot] != 0;
+        }
+        std::ofstream os(filenames[slot], std::ios::out | std::ios::binary);
+        if (!os.good())
+        {
+            ERR("Flow::GdsBatchWriter:: cannot open file %s \n", filenames[slot].c_str());
+            return false;
+        }
+        os.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        os.close();
+        if (!os.good())
+        {
+            ERR("Flow::GdsBatchWriter:: cannot write file %s \n", filenames[slot].c_str());
+            return false;
+        }
+        numBytes += bytes.size();
+        INF("Flow::GdsBatchWriter:: Write circuit %s layout to %s \n", _designDB.subCkt(cktIdxs[slot]).name().c_str(), filenames[slot].c_str());
+        return true;
+    });
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (IndexType slot = 0; slot < numFiles; ++slot)
+    {
+        GdsStreamWriter writer(_designDB, _techDB);
+        if (MfGzip::isGzipFileName(filenames[slot]))
+        {
+            written[slot] = writer.writeGdsLayout(cktIdxs[slot], filenames[slot], hierarchical, compressionLevel) ? 1 : 0;
+            writes.put(slot, std::string());
+            continue;
+        }
+        std::ostringstream os(std::ios::out | std::ios::binary);
+        {
+            ScopedTimer encodeTimer("encodeGds ", _designDB.subCkt(cktIdxs[slot]).name(), "gds");
+            writer.writeGdsLayout(cktIdxs[slot], os, hierarchical);
+        }
+        writes.put(slot, os.str());
+    }
+    const IndexType numWritten = writes.finish();
+    Tracer::count("GDS bytes written", static_cast<std::int64_t>(numBytes));
+    if (numWritten < numFiles)
+    {
+        WRN("Flow::GdsBatchWriter:: %u of %u files not written \n", numFiles - numWritten, numFiles);
+    }
+    return numWritten;
+}
+
+inline bool GdsBatchWriter::writeMergedLibrary(const std::vector<IndexType> &cktIdxs, const std::string &filename, bool hierarchical, int compressionLevel)
+{
+    ScopedTimer timer("writeGdsMerged", "gds");
+    ScopedMemoryPeak memory("writeGdsMerged");
+    const std::vector<IndexType> cells = this->uniqueCells(cktIdxs, hierarchical);
+    const bool isGzip = MfGzip::isGzipFileName(filename);
+    std::unique_ptr<std::ostream> os;
+    if (isGzip)
+    {
+        std::unique_ptr<GzipOFStream> gzip(new GzipOFStream(filename, compressionLevel));
+        if (!gzip->isOpen())
+        {
+            ERR("Flow::GdsBatchWriter:: cannot open file %s \n", filename.c_str());
+            return false;
+        }
+        os = std::move(gzip);
+    }
+    else
+    {
+        os.reset(new std::ofstream(filename, std::ios::out | std::ios::binary));
+        if (!os->good())
+        {
+            ERR("Flow::GdsBatchWriter:: cannot open file %s \n", filename.c_str());
+            return false;
+        }
+    }
+    const auto &units = _techDB.units();
+    {
+        GdsStream gds(*os);
+        gds.beginLib(units.gdsHeader(), "MAGICAL", units.dbuUU(), units.dbuM());
+    }
+    std::uint64_t numBytes = 0;
+    WRITER::OrderedWriteBehind writes(cells.size(), MAX_PENDING_BUFFERS, [&](IndexType, const std::string &bytes)
+    {
+        os->write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        numBytes += bytes.size();
+        return os->good();
+    });
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (IndexType slot = 0; slot < cells.size(); ++slot)
+    {
+        std::ostringstream cell(std::ios::out | std::ios::binary);
+        {
+            GdsStream gds(cell);
+            GdsStreamWriter(_designDB, _techDB).writeStructure(gds, cells[slot], hierarchical);
+        }
+        writes.put(slot, cell.str());
+    }
+    bool success = writes.finish() == cells.size();
+    {
+        GdsStream gds(*os);
+        gds.endLib();
+    }
+    if (isGzip)
+    {
+        success = static_cast<GzipOFStream &>(*os).close() && success;
+    }
+    else
+    {
+        static_cast<std::ofstream &>(*os).close();
+        success = os->good() && success;
+    }
+    if (!success)
+    {
+        ERR("Flow::GdsBatchWriter:: cannot write file %s \n", filename.c_str());
+        return false;
+    }
+    Tracer::count("GDS bytes written", static_cast<std::int64_t>(numBytes));
+    INF("Flow::GdsBatchWriter:: Write %lu cells of %lu circuits to %s \n", cells.size(), cktIdxs.size(), filename.c_str());
+    return true;
+}
+
+namespace WRITER
+{
+    /// @brief write the layout of each circuit into its own GDSII file, encoded in parallel
+    /// @param first: circuit graph indices
+    /// @param second: output file name of each circuit
+    /// @param third: design database
+    /// @param fourth: technology database
+    /// @param fifth: whether to write the sub circuits as de-duplicated structure references
+    /// @param sixth: the compression level of the file names ending with .gz
+    /// @return the number of files written
+    inline IndexType writeGdsLayouts(const std::vector<IndexType> &cktIdxs, const std::vector<std::string> &filenames, const DesignDB &designDB, const TechDB &techDB,
+            bool hierarchical = false, int compressionLevel = MfGzip::DEFAULT_LEVEL)
+    {
+        return GdsBatchWriter(designDB, techDB).writeGdsLayouts(cktIdxs, filenames, hierarchical, compressionLevel);
+    }
+
+    /// @brief write one GDSII library with every distinct cell of the circuits, encoded in parallel
+    /// @param first: circuit graph indices
+    /// @param second: output file name
+    /// @param third: design database
+    /// @param fourth: technology database
+    /// @param fifth: whether to write the sub circuits as their own structures
+    /// @param sixth: the compression level if the file name ends with .gz
+    /// @return if successful
+    inline bool writeMergedGdsLibrary(const std::vector<IndexType> &cktIdxs, const std::string &filename, const DesignDB &designDB, const TechDB &techDB,
+            bool hierarchical = true, int compressionLevel = MfGzip::DEFAULT_LEVEL)
+    {
+        return GdsBatchWriter(designDB, techDB).writeMergedLibrary(cktIdxs, filename, hierarchical, compressionLevel);
+    }
+}
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_GDS_BATCH_WRITER_H_
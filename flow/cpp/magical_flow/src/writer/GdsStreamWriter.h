@@ -0,0 +1,517 @@
+/**
+ * @file GdsStreamWriter.h
+ * @brief Streaming GDSII writer that encodes records directly from the Layout
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_GDS_STREAM_WRITER_H_
+#define MAGICAL_FLOW_GDS_STREAM_WRITER_H_
+
+#include <ostream>
+#include <fstream>
+#include <ctime>
+#include <cmath>
+#include <cstdint>
+#include <unordered_set>
+#include "db/DesignDB.h"
+#include "db/InstanceShapes.h"
+#include "db/TechDB.h"
+#include "util/GzipStream.h"
+#include "util/Tracer.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace WRITER
+{
+    /// @brief get the GDSII transformation of a cell reference for a circuit node
+    /// @param first: the circuit node
+    /// @param second: the bounding box of the layout of the sub circuit
+    /// @param third: output position of the reference
+    /// @param fourth: output rotation angle in degree (counterclockwise)
+    /// @param fifth: output whether to reflect about the x axis before rotation
+    inline void instanceTransform(const CktNode &node, const Box<LocType> &bbox, XY<LocType> &position, RealType &angle, bool &reflect)
+    {
+        // The instance transformation is affine. Recover it from the image of the origin and the unit vectors
+        position = node.toParentCoord(XY<LocType>(0, 0), bbox);
+        XY<LocType> ex = node.toParentCoord(XY<LocType>(1, 0), bbox) - position;
+        XY<LocType> ey = node.toParentCoord(XY<LocType>(0, 1), bbox) - position;
+        reflect = ex.x() * ey.y() - ex.y() * ey.x() < 0;
+        if (ex.x() > 0)
+        {
+            angle = 0;
+        }
+        else if (ex.y() > 0)
+        {
+            angle = 90;
+        }
+        else if (ex.x() < 0)
+        {
+            angle = 180;
+        }
+        else
+        {
+            angle = 270;
+        }
+    }
+}
+
+/// @class MAGICAL_FLOW::GdsStream
+/// @brief Low-level GDSII record encoder. Records are serialized in big-endian into an internal buffer, which is flushed to the output stream in chunks.
+class GdsStream
+{
+    /// @brief GDSII record types. See: http://boolean.klaasholwerda.nl/interface/bnf/gdsformat.html
+    enum RecordType : std::uint8_t
+    {
+        REC_HEADER = 0x00, REC_BGNLIB = 0x01, REC_LIBNAME = 0x02, REC_UNITS = 0x03, REC_ENDLIB = 0x04,
+        REC_BGNSTR = 0x05, REC_STRNAME = 0x06, REC_ENDSTR = 0x07, REC_BOUNDARY = 0x08, REC_SREF = 0x0A,
+        REC_TEXT = 0x0C, REC_LAYER = 0x0D, REC_DATATYPE = 0x0E, REC_XY = 0x10, REC_ENDEL = 0x11,
+        REC_SNAME = 0x12, REC_TEXTTYPE = 0x16, REC_PRESENTATION = 0x17, REC_STRING = 0x19,
+        REC_STRANS = 0x1A, REC_MAG = 0x1B, REC_ANGLE = 0x1C
+    };
+    /// @brief GDSII data types
+    enum DataType : std::uint8_t
+    {
+        DT_NO_DATA = 0x00, DT_BIT_ARRAY = 0x01, DT_INT16 = 0x02, DT_INT32 = 0x03, DT_REAL8 = 0x05, DT_ASCII = 0x06
+    };
+    public:
+        /// @brief the number of vertices in a BOUNDARY, including the closing one, is limited by the 16-bit record length
+        static constexpr IndexType MAX_BOUNDARY_POINTS = 8191;
+        /// @brief constructor
+        /// @param the output stream. Should be opened in binary mode
+        explicit GdsStream(std::ostream &os) : _os(os) { _buffer.reserve(BUFFER_SIZE + 512); }
+        /// @brief destructor. Flush the remaining bytes
+        ~GdsStream() { this->flush(); }
+        /*------------------------------*/
+        /* Library and structures       */
+        /*------------------------------*/
+        /// @brief write HEADER, BGNLIB, LIBNAME and UNITS
+        /// @param first: GDSII version header
+        /// @param second: name of the library
+        /// @param third: user unit per database unit
+        /// @param fourth: database unit in meter
+        void beginLib(IntType header, const std::string &libName, RealType dbuUU, RealType dbuM)
+        {
+            this->writeInt16Record(REC_HEADER, static_cast<std::int16_t>(header));
+            this->writeTimeRecord(REC_BGNLIB);
+            this->writeStringRecord(REC_LIBNAME, libName);
+            this->writeRecordHeader(REC_UNITS, DT_REAL8, 16);
+            this->writeReal8(dbuUU);
+            this->writeReal8(dbuM);
+        }
+        /// @brief write ENDLIB and flush the stream
+        void endLib() { this->writeRecordHeader(REC_ENDLIB, DT_NO_DATA, 0); this->flush(); }
+        /// @brief write BGNSTR and STRNAME
+        /// @param the name of the structure
+        void beginStruct(const std::string &name)
+        {
+            this->writeTimeRecord(REC_BGNSTR);
+            this->writeStringRecord(REC_STRNAME, name);
+        }
+        /// @brief write ENDSTR
+        void endStruct() { this->writeRecordHeader(REC_ENDSTR, DT_NO_DATA, 0); }
+        /*------------------------------*/
+        /* Elements                     */
+        /*------------------------------*/
+        /// @brief write a rectangle as a BOUNDARY element
+        /// @param first: pdk layer
+        /// @param second: datatype
+        /// @param third: the rectangle
+        void writeBoundary(IntType layer, IntType datatype, const Box<LocType> &rect)
+        {
+            this->writeRecordHeader(REC_BOUNDARY, DT_NO_DATA, 0);
+            this->writeInt16Record(REC_LAYER, static_cast<std::int16_t>(layer));
+            this->writeInt16Record(REC_DATATYPE, static_cast<std::int16_t>(datatype));
+            this->writeRecordHeader(REC_XY, DT_INT32, 40);
+            this->writeInt32(rect.xLo()); this->writeInt32(rect.yLo());
+            this->writeInt32(rect.xLo()); this->writeInt32(rect.yHi());
+            this->writeInt32(rect.xHi()); this->writeInt32(rect.yHi());
+            this->writeInt32(rect.xHi()); this->writeInt32(rect.yLo());
+            this->writeInt32(rect.xLo()); this->writeInt32(rect.yLo());
+            this->writeRecordHeader(REC_ENDEL, DT_NO_DATA, 0);
+        }
+        /// @brief write a polygon as a BOUNDARY element. The first vertex is repeated to close it
+        /// @param first: pdk layer
+        /// @param second: datatype
+        /// @param third: the x coordinates of the vertices
+        /// @param fourth: the y coordinates of the vertices
+        /// @param fifth: the number of vertices, less than MAX_BOUNDARY_POINTS
+        void writeBoundary(IntType layer, IntType datatype, const LocType *xs, const LocType *ys, IndexType numPts)
+        {
+            Assert(numPts < MAX_BOUNDARY_POINTS);
+            this->writeRecordHeader(REC_BOUNDARY, DT_NO_DATA, 0);
+            this->writeInt16Record(REC_LAYER, static_cast<std::int16_t>(layer));
+            this->writeInt16Record(REC_DATATYPE, static_cast<std::int16_t>(datatype));
+            this->writeRecordHeader(REC_XY, DT_INT32, 8 * (numPts + 1));
+            for (IndexType idx = 0; idx < numPts; ++idx)
+            {
+                this->writeInt32(xs[idx]); this->writeInt32(ys[idx]);
+            }
+            this->writeInt32(xs[0]); this->writeInt32(ys[0]);
+            this->writeRecordHeader(REC_ENDEL, DT_NO_DATA, 0);
+        }
+        /// @brief write a TEXT element
+        /// @param first: pdk layer
+        /// @param second: texttype
+        /// @param third: the string
+        /// @param fourth: the coordinate of the text
+        /// @param fifth: the presentation bits
+        /// @param sixth: the magnification
+        void writeText(IntType layer, IntType texttype, const std::string &str, const XY<LocType> &coord, IntType presentation, RealType mag)
+        {
+            this->writeRecordHeader(REC_TEXT, DT_NO_DATA, 0);
+            this->writeInt16Record(REC_LAYER, static_cast<std::int16_t>(layer));
+            this->writeInt16Record(REC_TEXTTYPE, static_cast<std::int16_t>(texttype));
+            this->writeRecordHeader(REC_PRESENTATION, DT_BIT_ARRAY, 2);
+            this->writeInt16(static_cast<std::int16_t>(presentation));
+            this->writeRecordHeader(REC_STRANS, DT_BIT_ARRAY, 2);
+            this->writeInt16(0);
+            this->writeRecordHeader(REC_MAG, DT_REAL8, 8);
+            this->writeReal8(mag);
+            this->writeRecordHeader(REC_XY, DT_INT32, 8);
+            this->writeInt32(coord.x()); this->writeInt32(coord.y());
+            this->writeStringRecord(REC_STRING, str);
+            this->writeRecordHeader(REC_ENDEL, DT_NO_DATA, 0);
+        }
+        /// @brief write a SREF element
+        /// @param first: the name of the referenced structure
+        /// @param second: the position of the reference
+        /// @param third: the rotation angle in degree (counterclockwise)
+        /// @param fourth: whether to reflect about the x axis before rotation
+        void writeSref(const std::string &name, const XY<LocType> &pos, RealType angle, bool reflect)
+        {
+            this->writeRecordHeader(REC_SREF, DT_NO_DATA, 0);
+            this->writeStringRecord(REC_SNAME, name);
+            if (reflect || angle != 0)
+            {
+                this->writeRecordHeader(REC_STRANS, DT_BIT_ARRAY, 2);
+                this->writeInt16(reflect ? static_cast<std::int16_t>(0x8000) : 0);
+                if (angle != 0)
+                {
+                    this->writeRecordHeader(REC_ANGLE, DT_REAL8, 8);
+                    this->writeReal8(angle);
+                }
+            }
+            this->writeRecordHeader(REC_XY, DT_INT32, 8);
+            this->writeInt32(pos.x()); this->writeInt32(pos.y());
+            this->writeRecordHeader(REC_ENDEL, DT_NO_DATA, 0);
+        }
+        /// @brief flush the buffered bytes into the output stream
+        void flush()
+        {
+            if (!_buffer.empty())
+            {
+                _os.write(_buffer.data(), _buffer.size());
+                _buffer.clear();
+            }
+        }
+    private:
+        /*------------------------------*/
+        /* Encoding                     */
+        /*------------------------------*/
+        /// @brief write the 4-byte record header
+        /// @param first: record type
+        /// @param second: data type
+        /// @param third: the number of bytes of the data
+        void writeRecordHeader(std::uint8_t recordType, std::uint8_t dataType, IndexType dataBytes)
+        {
+            if (_buffer.size() > BUFFER_SIZE)
+            {
+                this->flush();
+            }
+            this->writeInt16(static_cast<std::int16_t>(dataBytes + 4));
+            _buffer.push_back(static_cast<char>(recordType));
+            _buffer.push_back(static_cast<char>(dataType));
+        }
+        /// @brief write a record with a single 2-byte integer
+        void writeInt16Record(std::uint8_t recordType, std::int16_t value)
+        {
+            this->writeRecordHeader(recordType, DT_INT16, 2);
+            this->writeInt16(value);
+        }
+        /// @brief write a string record. The string is padded to even length
+        void writeStringRecord(std::uint8_t recordType, const std::string &str)
+        {
+            IndexType len = str.size() + (str.size() % 2);
+            this->writeRecordHeader(recordType, DT_ASCII, len);
+            _buffer.insert(_buffer.end(), str.begin(), str.end());
+            if (str.size() % 2)
+            {
+                _buffer.push_back('\0');
+            }
+        }
+        /// @brief write BGNLIB/BGNSTR with the current time as both modification and access time
+        void writeTimeRecord(std::uint8_t recordType)
+        {
+            std::time_t now = std::time(nullptr);
+            std::tm *t = std::localtime(&now);
+            std::int16_t stamp[6] = { static_cast<std::int16_t>(t->tm_year), static_cast<std::int16_t>(t->tm_mon + 1), static_cast<std::int16_t>(t->tm_mday),
+                static_cast<std::int16_t>(t->tm_hour), static_cast<std::int16_t>(t->tm_min), static_cast<std::int16_t>(t->tm_sec) };
+            this->writeRecordHeader(recordType, DT_INT16, 24);
+            for (IndexType rep = 0; rep < 2; ++rep)
+            {
+                for (std::int16_t val : stamp)
+                {
+                    this->writeInt16(val);
+                }
+            }
+        }
+        void writeInt16(std::int16_t value)
+        {
+            std::uint16_t u = static_cast<std::uint16_t>(value);
+            _buffer.push_back(static_cast<char>((u >> 8) & 0xFF));
+            _buffer.push_back(static_cast<char>(u & 0xFF));
+        }
+        void writeInt32(std::int32_t value)
+        {
+            std::uint32_t u = static_cast<std::uint32_t>(value);
+            _buffer.push_back(static_cast<char>((u >> 24) & 0xFF));
+            _buffer.push_back(static_cast<char>((u >> 16) & 0xFF));
+            _buffer.push_back(static_cast<char>((u >> 8) & 0xFF));
+            _buffer.push_back(static_cast<char>(u & 0xFF));
+        }
+        /// @brief write a GDSII 8-byte real: sign bit, 7-bit excess-64 base-16 exponent, 56-bit mantissa
+        void writeReal8(RealType value)
+        {
+            std::uint64_t bits = 0;
+            if (value != 0)
+            {
+                std::uint64_t sign = value < 0 ? 1 : 0;
+                RealType mant = std::fabs(value);
+                IntType exponent = 64;
+                while (mant >= 1.0) { mant /= 16.0; ++exponent; }
+                while (mant < 0.0625) { mant *= 16.0; --exponent; }
+                std::uint64_t mantissa = static_cast<std::uint64_t>(std::ldexp(mant, 56) + 0.5);
+                if (mantissa >> 56)
+                {
+                    // Rounding overflowed the mantissa
+                    mantissa >>= 4;
+                    ++exponent;
+                }
+                bits = (sign << 63) | (static_cast<std::uint64_t>(exponent & 0x7F) << 56) | mantissa;
+            }
+            for (IntType shift = 56; shift >= 0; shift -= 8)
+            {
+                _buffer.push_back(static_cast<char>((bits >> shift) & 0xFF));
+            }
+        }
+    private:
+        static constexpr IndexType BUFFER_SIZE = 1 << 16; ///< The size of buffered bytes before flushing
+        std::ostream &_os; ///< The output stream
+        std::vector<char> _buffer; ///< The buffered bytes
+};
+
+/// @class MAGICAL_FLOW::GdsStreamWriter
+/// @brief Write the layout of circuits into GDSII without an intermediate GdsDB. The layout is walked by const reference.
+class GdsStreamWriter
+{
+    public:
+        /// @brief constructor
+        /// @param first: a design database
+        /// @param second: a technology database
+        explicit GdsStreamWriter(const DesignDB &designDB, const TechDB &techDB) : _designDB(designDB), _techDB(techDB) {}
+        /// @brief write the layout of a circuit into GDSII
+        /// @param first: the index of circuit graph
+        /// @param second: the output file name
+        /// @param third: whether to write each sub circuit once as its own structure and reference it, instead of the flattened layout
+        /// @param fourth: the compression level if the file name ends with .gz. The records are compressed in a background thread while being encoded
+        /// @return if successful
+        bool writeGdsLayout(IndexType cktIdx, const std::string &filename, bool hierarchical = false, int compressionLevel = MfGzip::DEFAULT_LEVEL);
+        /// @brief write the layout of a circuit into a GDSII stream
+        /// @param first: the index of circuit graph
+        /// @param second: the output stream, opened in binary mode
+        /// @param third: whether to write the sub circuits as structure references
+        void writeGdsLayout(IndexType cktIdx, std::ostream &os, bool hierarchical = false);
+        /// @brief write the layout of one circuit as a structure, without the structures of its sub circuits
+        /// @param first: the encoder
+        /// @param second: the index of circuit graph
+        /// @param third: whether to write the sub circuits as structure references, instead of their shapes flattened into the layout
+        void writeStructure(GdsStream &gds, IndexType cktIdx, bool hierarchical) const;
+    private:
+        /// @brief write the layout of a circuit as a structure
+        /// @param first: the encoder
+        /// @param second: the index of circuit graph
+        /// @param third: whether to write the sub circuits as structure references
+        void writeCktGraph(GdsStream &gds, IndexType cktIdx, bool hierarchical);
+    private:
+        const DesignDB &_designDB; ///< The design database
+        const TechDB &_techDB; ///< The technology database
+        std::unordered_set<std::string> _writtenCells; ///< The names of the structures already written
+};
+
+inline bool GdsStreamWriter::writeGdsLayout(IndexType cktIdx, const std::string &filename, bool hierarchical, int compressionLevel)
+{
+    ScopedTimer timer("writeGds ", _designDB.subCkt(cktIdx).name(), "gds");
+    ScopedMemoryPeak memory("writeGds");
+    if (MfGzip::isGzipFileName(filename))
+    {
+        GzipOFStream os(filename, compressionLevel);
+        if (!os.isOpen())
+        {
+            ERR("Flow::GdsStreamWriter:: cannot open file %s \n", filename.c_str());
+            return false;
+        }
+        this->writeGdsLayout(cktIdx, os, hierarchical);
+        if (!os.close())
+        {
+            ERR("Flow::GdsStreamWriter:: cannot write file %s \n", filename.c_str());
+            return false;
+        }
+        Tracer::count("GDS bytes written", static_cast<std::int64_t>(os.numBytesIn()));
+        INF("Flow::GdsStreamWriter:: Write circuit %s layout to %s \n", _designDB.subCkt(cktIdx).name().c_str(), filename.c_str());
+        return true;
+    }
+    std::ofstream os(filename, std::ios::out | std::ios::binary);
+    if (!os.good())
+    {
+        ERR("Flow::GdsStreamWriter:: cannot open file %s \n", filename.c_str());
+        return false;
+    }
+    this->writeGdsLayout(cktIdx, os, hierarchical);
+    const std::int64_t numBytes = static_cast<std::int64_t>(os.tellp());
+    os.close();
+    if (os.fail())
+    {
+        ERR("Flow::GdsStreamWriter:: cannot write file %s \n", filename.c_str());
+        return false;
+    }
+    Tracer::count("GDS bytes written", numBytes);
+    INF("Flow::GdsStreamWriter:: Write circuit %s layout to %s \n", _designDB.subCkt(cktIdx).name().c_str(), filename.c_str());
+    return true;
+}
+
+inline void GdsStreamWriter::writeGdsLayout(IndexType cktIdx, std::ostream &os, bool hierarchical)
+{
+    const auto &units = _techDB.units();
+    GdsStream gds(os);
+    _writtenCells.clear();
+    gds.beginLib(units.gdsHeader(), "MAGICAL", units.dbuUU(), units.dbuM());
+    this->writeCktGraph(gds, cktIdx, hierarchical);
+    gds.endLib();
+}
+
+inline void GdsStreamWriter::writeCktGraph(GdsStream &gds, IndexType cktIdx, bool hierarchical)
+{
+    const auto &cktGraph = _designDB.subCkt(cktIdx);
+    if (!_writtenCells.insert(cktGraph.name()).second)
+    {
+        // The structure has already been written
+        return;
+    }
+    if (hierarchical)
+    {
+        // Structures cannot be nested, so write the sub circuits first
+        for (IndexType nodeIdx = 0; nodeIdx < cktGraph.numNodes(); ++nodeIdx)
+        {
+            const auto &node = cktGraph.node(nodeIdx);
+            if (!node.isLeaf())
+            {
+                this->writeCktGraph(gds, node.subgraphIdx(), hierarchical);
+            }
+        }
+    }
+    this->writeStructure(gds, cktIdx, hierarchical);
+}
+
+inline void GdsStreamWriter::writeStructure(GdsStream &gds, IndexType cktIdx, bool hierarchical) const
+{
+    const auto &cktGraph = _designDB.subCkt(cktIdx);
+    const auto &cktLayout = cktGraph.layout();
+    // The shapes drawn by the structure references are not written again
+    const InstanceShapes instances = hierarchical ? InstanceShapes(_designDB, cktIdx) : InstanceShapes();
+    gds.beginStruct(cktGraph.name());
+    for (IndexType layerIdx = 0; layerIdx < cktLayout.numLayers(); ++layerIdx)
+    {
+        const auto &layer = cktLayout.layer(layerIdx);
+        if (layer.numStoredRects() == 0 && layer.numPolygons() == 0 && layer.textList().empty())
+        {
+            continue;
+        }
+        IntType pdkLayer = static_cast<IntType>(_techDB.dbLayerToPdk(layerIdx));
+        // Skip the slices of the polygons, which are written as polygons
+        const auto skipped = layer.skippedRectRanges(false);
+        auto rangeIter = skipped.begin();
+        for (IndexType rectIdx = 0; rectIdx < layer.numStoredRects(); ++rectIdx)
+        {
+            while (rangeIter != skipped.end() && rangeIter->second <= rectIdx)
+            {
+                ++rangeIter;
+            }
+            if (rangeIter != skipped.end() && rangeIter->first <= rectIdx)
+            {
+                rectIdx = rangeIter->second - 1;
+                continue;
+            }
+            if (instances.coversRect(layerIdx, layer.box(rectIdx), layer.datatype(rectIdx)))
+            {
+                continue;
+            }
+            gds.writeBoundary(pdkLayer, static_cast<IntType>(layer.datatype(rectIdx)), layer.box(rectIdx));
+        }
+        for (IndexType polyIdx = 0; polyIdx < layer.numPolygons(); ++polyIdx)
+        {
+            if (instances.coversPolygon(layerIdx, layer, polyIdx))
+            {
+                continue;
+            }
+            IntType datatype = static_cast<IntType>(layer.polygonDatatype(polyIdx));
+            IndexType numPts = layer.numPolygonPoints(polyIdx);
+            if (numPts >= GdsStream::MAX_BOUNDARY_POINTS)
+            {
+                // Too many vertices for one record: write the slices instead
+                const auto slices = layer.polygonRectRange(polyIdx);
+                for (IndexType rectIdx = slices.first; rectIdx < slices.second; ++rectIdx)
+                {
+                    gds.writeBoundary(pdkLayer, datatype, layer.box(rectIdx));
+                }
+                continue;
+            }
+            IndexType first = layer.polygonStartArray()[polyIdx];
+            gds.writeBoundary(pdkLayer, datatype, layer.polygonXArray().data() + first, layer.polygonYArray().data() + first, numPts);
+        }
+        for (const auto &text : layer.textList())
+        {
+            if (instances.coversText(layerIdx, text))
+            {
+                continue;
+            }
+            // Same convention as GdsWriter: texttype 0, presentation 5 and magnification 0.2
+            gds.writeText(pdkLayer, 0, text.text(), text.coord(), 5, 0.2);
+        }
+    }
+    if (hierarchical)
+    {
+        for (IndexType nodeIdx = 0; nodeIdx < cktGraph.numNodes(); ++nodeIdx)
+        {
+            const auto &node = cktGraph.node(nodeIdx);
+            if (node.isLeaf())
+            {
+                continue;
+            }
+            const auto &subCkt = _designDB.subCkt(node.subgraphIdx());
+            XY<LocType> position;
+            RealType angle = 0;
+            bool reflect = false;
+            WRITER::instanceTransform(node, subCkt.layout().boundary(), position, angle, reflect);
+            gds.writeSref(subCkt.name(), position, angle, reflect);
+        }
+    }
+    gds.endStruct();
+}
+
+namespace WRITER
+{
+    /// @brief write the layout for circuit to GDSII by streaming the records directly from the layout
+    /// @param first: circuit graph index
+    /// @param second: output file name
+    /// @param third: design database
+    /// @param fourth: technology database
+    /// @param fifth: whether to write the sub circuits as de-duplicated structure references
+    /// @param sixth: the compression level if the file name ends with .gz
+    /// @return if successful
+    inline bool writeGdsLayoutStreaming(IndexType cktIdx, const std::string &filename, const DesignDB &designDB, const TechDB &techDB, bool hierarchical = false, int compressionLevel = MfGzip::DEFAULT_LEVEL)
+    {
+        return GdsStreamWriter(designDB, techDB).writeGdsLayout(cktIdx, filename, hierarchical, compressionLevel);
+    }
+}
+PROJECT_NAMESPACE_END
+#endif //MAGICAL_FLOW_GDS_STREAM_WRITER_H_
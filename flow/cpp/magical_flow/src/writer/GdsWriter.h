@@ -8,9 +8,12 @@
 #ifndef MAGICAL_FLOW_GDS_WRITER_H_
 #define MAGICAL_FLOW_GDS_WRITER_H_
 
+#include <cstdio>
 #include "db/DesignDB.h"
+#include "db/InstanceShapes.h"
 #include "db/TechDB.h"
 #include "util/GdsHelper.h"
+#include "writer/GdsStreamWriter.h"
 
 PROJECT_NAMESPACE_BEGIN
 
@@ -26,17 +29,27 @@ class GdsWriter
         /// @brief write the layout of a circuit into GDSII 
         /// @param first: the index of circuit graph
         /// @param second: the output file name
-        void writeGdsLayout(IndexType cktIdx, const std::string &filename);
+        /// @param third: whether to write each sub circuit once as its own cell and reference it, instead of the flattened layout
+        /// @param fourth: the compression level if the file name ends with .gz
+        /// @return whether successful. The plain files are written by limbo, which reports no failure
+        bool writeGdsLayout(IndexType cktIdx, const std::string &filename, bool hierarchical = false, int compressionLevel = MfGzip::DEFAULT_LEVEL);
     private:
         /// @brief add CktGraph to the gdsDB
-        /// @param the index of CktGraph
-        void addCktGraph(IndexType cktGraphIdx);
+        /// @param first: the index of CktGraph
+        /// @param second: whether to add the sub circuits as cell references
+        void addCktGraph(IndexType cktGraphIdx, bool hierarchical);
         /// @brief add box to the cell
         /// @param reference to the cell
         /// @param rectangle
         /// @param db layer
         /// @param datatype
         void addRect2Cell(::GdsParser::GdsDB::GdsCell &gdsCell, const Box<LocType> &rect, IndexType dbLayer, IntType datatype);
+        /// @brief add a polygon of a layer to the cell
+        /// @param reference to the cell
+        /// @param the layer of the layout
+        /// @param the index of the polygon in the layer
+        /// @param db layer
+        void addPolygon2Cell(::GdsParser::GdsDB::GdsCell &gdsCell, const LayoutLayer &layer, IndexType polyIdx, IndexType dbLayer);
         /// @brief add text to the cell
         /// @param reference to the cell
         /// @param coordinate of the text
@@ -45,8 +58,9 @@ class GdsWriter
         void addText2Cell(::GdsParser::GdsDB::GdsCell &gdsCell, const XY<LocType> &coord, IndexType dbLayer, const std::string &str);
         /// @brief add a cellreference to a gdscell
         /// @param the reference to the gdscell
-        /// @param the CktNode want to add
-        void addCellRef2Cell(::GdsParser::GdsDB::GdsCell &gdsCell, CktNode &node);
+        /// @param second: the CktNode want to add
+        /// @param third: the sub circuit of the node
+        void addCellRef2Cell(::GdsParser::GdsDB::GdsCell &gdsCell, const CktNode &node, const CktGraph &subCkt);
         /// @brief add text to the cell
         /// @brief convert XY type to point_type
         point_type convertXY(const XY<LocType> &pt)
@@ -59,7 +73,7 @@ class GdsWriter
         TechDB &_techDB; ///< The technology database
 };
 
-inline void GdsWriter::writeGdsLayout(IndexType cktIdx, const string &filename)
+inline bool GdsWriter::writeGdsLayout(IndexType cktIdx, const std::string &filename, bool hierarchical, int compressionLevel)
 {
     // Config header and units
     _gdsDB.cells().clear();
@@ -68,15 +82,36 @@ inline void GdsWriter::writeGdsLayout(IndexType cktIdx, const string &filename)
     _gdsDB.setHeader(_techDB.units().gdsHeader());
 
     // Add layouts
-    this->addCktGraph(cktIdx);
+    this->addCktGraph(cktIdx, hierarchical);
 
-    // Write out
+    // Write out. The limbo writer takes a file name, so a .gz file is compressed from a temporary plain file
     ::GdsParser::GdsDB::GdsWriter gw (_gdsDB);
-    gw(filename.c_str());
+    if (!MfGzip::isGzipFileName(filename))
+    {
+        gw(filename.c_str());
+    }
+    else
+    {
+        std::string plainFile = MfGzip::makeTempFile(".gds");
+        if (plainFile.empty())
+        {
+            ERR("Flow::GdsWriter:: cannot create a temporary file for %s \n", filename.c_str());
+            return false;
+        }
+        gw(plainFile.c_str());
+        bool success = MfGzip::compressFile(plainFile, filename, compressionLevel);
+        std::remove(plainFile.c_str());
+        if (!success)
+        {
+            ERR("Flow::GdsWriter:: cannot write file %s \n", filename.c_str());
+            return false;
+        }
+    }
     INF("Flow::GdsWriter:: Write circuit %s layout to %s \n", _designDB.subCkt(cktIdx).name().c_str(), filename.c_str());
+    return true;
 }
 
-inline void GdsWriter::addCktGraph(IndexType cktGraphIdx)
+inline void GdsWriter::addCktGraph(IndexType cktGraphIdx, bool hierarchical)
 {
     auto &cktGraph = _designDB.subCkt(cktGraphIdx); // CktGraph
     // Check if the cell has been added to the gdsDB
@@ -87,33 +122,78 @@ inline void GdsWriter::addCktGraph(IndexType cktGraphIdx)
         // No need to add again
         return;
     }
+    if (hierarchical)
+    {
+        // Add the sub circuits first. Adding cells to the gdsDB may invalidate the reference to the cell of this circuit
+        for (IndexType nodeIdx = 0; nodeIdx < cktGraph.numNodes(); ++nodeIdx)
+        {
+            const auto &node = cktGraph.node(nodeIdx);
+            if (!node.isLeaf())
+            {
+                this->addCktGraph(node.subgraphIdx(), hierarchical);
+            }
+        }
+    }
     auto &gdsCell = _gdsDB.addCell(cktGraph.name()); // GdsCell
     
-    // Add layout
-    auto cktLayout = cktGraph.layout(); // Layout
+    // Add layout. The shapes drawn by the cell references are not added again
+    const auto &cktLayout = cktGraph.layout(); // Layout
+    const InstanceShapes instances = hierarchical ? InstanceShapes(_designDB, cktGraphIdx) : InstanceShapes();
     for (IndexType layerIdx = 0; layerIdx < cktLayout.numLayers(); ++layerIdx)
     {
-        for (IndexType rectIdx = 0; rectIdx < cktLayout.numRects(layerIdx); ++rectIdx)
+        const auto &layer = cktLayout.layer(layerIdx);
+        // Skip the slices of the polygons, which are written as polygons
+        const auto skipped = layer.skippedRectRanges(false);
+        auto rangeIter = skipped.begin();
+        for (IndexType rectIdx = 0; rectIdx < layer.numStoredRects(); ++rectIdx)
         {
-            this->addRect2Cell(gdsCell, cktLayout.rect(layerIdx, rectIdx).rect(), layerIdx, cktLayout.rect(layerIdx, rectIdx).datatype()); // FIXME For >M6 layer, need to use datatype=40
+            while (rangeIter != skipped.end() && rangeIter->second <= rectIdx)
+            {
+                ++rangeIter;
+            }
+            if (rangeIter != skipped.end() && rangeIter->first <= rectIdx)
+            {
+                rectIdx = rangeIter->second - 1;
+                continue;
+            }
+            if (instances.coversRect(layerIdx, layer.box(rectIdx), layer.datatype(rectIdx)))
+            {
+                continue;
+            }
+            this->addRect2Cell(gdsCell, layer.box(rectIdx), layerIdx, layer.datatype(rectIdx)); // FIXME For >M6 layer, need to use datatype=40
+        }
+        for (IndexType polyIdx = 0; polyIdx < layer.numPolygons(); ++polyIdx)
+        {
+            if (instances.coversPolygon(layerIdx, layer, polyIdx))
+            {
+                continue;
+            }
+            this->addPolygon2Cell(gdsCell, layer, polyIdx, layerIdx);
         }
         for (IndexType textIdx = 0; textIdx < cktLayout.numTexts(layerIdx); ++textIdx)
         {
+            if (instances.coversText(layerIdx, cktLayout.text(layerIdx, textIdx)))
+            {
+                continue;
+            }
             this->addText2Cell(gdsCell, cktLayout.text(layerIdx, textIdx).coord(), layerIdx, cktLayout.text(layerIdx, textIdx).text());
         }
     }
 
     // Add cell reference
+    if (!hierarchical)
+    {
+        return;
+    }
     for (IndexType nodeIdx = 0; nodeIdx < cktGraph.numNodes(); ++nodeIdx)
     {
-        auto & node = cktGraph.node(nodeIdx);
+        const auto & node = cktGraph.node(nodeIdx);
         if (node.isLeaf())
         {
             continue;
         }
-        // If it is not leaf, add a reference cell and recursively add the cell
-        // this->addCktGraph(node.subgraphIdx());
-        // this->addCellRef2Cell(gdsCell, node);
+        // If it is not leaf, add a reference cell. The cell itself has been added above
+        this->addCellRef2Cell(gdsCell, node, _designDB.subCkt(node.subgraphIdx()));
     }
 }
 
@@ -132,6 +212,30 @@ inline void GdsWriter::addRect2Cell(::GdsParser::GdsDB::GdsCell &gdsCell, const
 
 }
 
+inline void GdsWriter::addPolygon2Cell(::GdsParser::GdsDB::GdsCell &gdsCell, const LayoutLayer &layer, IndexType polyIdx, IndexType dbLayer)
+{
+    IntType datatype = static_cast<IntType>(layer.polygonDatatype(polyIdx));
+    // The 16-bit record length of GDSII limits a boundary to 8191 points, including the closing one
+    if (layer.numPolygonPoints(polyIdx) >= 8191)
+    {
+        const auto slices = layer.polygonRectRange(polyIdx);
+        for (IndexType rectIdx = slices.first; rectIdx < slices.second; ++rectIdx)
+        {
+            this->addRect2Cell(gdsCell, layer.box(rectIdx), dbLayer, datatype);
+        }
+        return;
+    }
+    IntType pdkLayer = static_cast<IntType>(_techDB.dbLayerToPdk(dbLayer));
+    std::vector<point_type> pts;
+    pts.reserve(layer.numPolygonPoints(polyIdx) + 1);
+    for (IndexType ptIdx = 0; ptIdx < layer.numPolygonPoints(polyIdx); ++ptIdx)
+    {
+        pts.emplace_back(this->convertXY(layer.polygonPoint(polyIdx, ptIdx)));
+    }
+    pts.emplace_back(pts.front());
+    gdsCell.addPolygon(pdkLayer, datatype, pts);
+}
+
 inline void GdsWriter::addText2Cell(::GdsParser::GdsDB::GdsCell &gdsCell, const XY<LocType> &coord, IndexType dbLayer, const std::string &str)
 {
     IntType pdkLayer = static_cast<IntType>(_techDB.dbLayerToPdk(dbLayer));
@@ -139,22 +243,12 @@ inline void GdsWriter::addText2Cell(::GdsParser::GdsDB::GdsCell &gdsCell, const
     gdsCell.addText(pdkLayer, std::numeric_limits<int>::max(), 0, str, convertXY(coord), std::numeric_limits<int>::max(), 5, 0, 0.2, 0);
 }
 
-inline void GdsWriter::addCellRef2Cell(GdsParser::GdsDB::GdsCell &gdsCell, CktNode &node)
+inline void GdsWriter::addCellRef2Cell(GdsParser::GdsDB::GdsCell &gdsCell, const CktNode &node, const CktGraph &subCkt)
 {
-    double angle = 0; 
+    XY<LocType> position;
+    RealType angle = 0; 
     bool flip = false;
-    if (node.orient() == OriType::N)
-    {
-        angle = 0;
-        flip = false;
-    }
-    else
-    {
-        angle = 0;
-        flip = true;
-        // TODO:
-        // AssertMsg(false, "GdsWriter::addCellRef2Cell. TODO: Not yet implemented. Only N orientation is supported right now. \n");
-    }
+    WRITER::instanceTransform(node, subCkt.layout().boundary(), position, angle, flip);
     int strans;
     if (flip)
     {
@@ -165,7 +259,7 @@ inline void GdsWriter::addCellRef2Cell(GdsParser::GdsDB::GdsCell &gdsCell, CktNo
         strans = 0;
     }
     // 1. reference cell name 2. angle 3. magnification 4. strans
-    gdsCell.addCellReference(node.refName(), this->convertXY(node.offset()), angle, 1, strans);
+    gdsCell.addCellReference(subCkt.name(), this->convertXY(position), angle, 1, strans);
 }
 
 
@@ -176,9 +270,12 @@ namespace WRITER
     /// @param second: output file name
     /// @param third: design database
     /// @param fourth: technology database
-    inline void writeGdsLayout(IndexType cktIdx, const std::string &filename, DesignDB &designDB, TechDB &techDB)
+    /// @param fifth: whether to write the sub circuits as de-duplicated cell references
+    /// @param sixth: the compression level if the file name ends with .gz
+    /// @return whether successful
+    inline bool writeGdsLayout(IndexType cktIdx, const std::string &filename, DesignDB &designDB, TechDB &techDB, bool hierarchical = false, int compressionLevel = MfGzip::DEFAULT_LEVEL)
     {
-        GdsWriter(designDB, techDB).writeGdsLayout(cktIdx, filename);
+        return GdsWriter(designDB, techDB).writeGdsLayout(cktIdx, filename, hierarchical, compressionLevel);
     }
 }
 PROJECT_NAMESPACE_END
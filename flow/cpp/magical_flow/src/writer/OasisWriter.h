@@ -0,0 +1,706 @@
+/**
+ * @file OasisWriter.h
+ * @brief Streaming OASIS writer that encodes records directly from the Layout
+ * @date 10/14/2026
+ */
+
+#ifndef MAGICAL_FLOW_OASIS_WRITER_H_
+#define MAGICAL_FLOW_OASIS_WRITER_H_
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <zlib.h>
+#include "util/OasisFormat.h"
+#include "writer/GdsStreamWriter.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace WRITER
+{
+    /// @brief a regular array of identical elements: cols x rows copies, the columns colSpace apart in x and the rows rowSpace apart in y
+    struct OasisArray
+    {
+        XY<LocType> origin = XY<LocType>(0, 0); ///< The position of the first copy
+        IndexType cols = 1;
+        IndexType rows = 1;
+        LocType colSpace = 0;
+        LocType rowSpace = 0;
+    };
+
+    /// @brief cover a set of positions with regular arrays. The maximal runs of uniform pitch in each row are found first, then the identical runs in rows of uniform pitch are stacked into grids
+    /// @param first: the positions of the identical elements. Sorted by this function
+    /// @param second: output arrays, every position in exactly one, sorted by their origins
+    inline void findOasisArrays(std::vector<XY<LocType>> &positions, std::vector<OasisArray> &arrays)
+    {
+        std::sort(positions.begin(), positions.end(), [](const XY<LocType> &lhs, const XY<LocType> &rhs)
+                { return lhs.y() != rhs.y() ? lhs.y() < rhs.y() : lhs.x() < rhs.x(); });
+        // (the first x, the number of copies, the pitch) of each run -> the y of the rows having it, ascending
+        std::map<std::tuple<LocType, IndexType, LocType>, std::vector<LocType>> runs;
+        std::size_t idx = 0;
+        while (idx < positions.size())
+        {
+            std::size_t end = idx + 1;
+            while (end < positions.size() && positions[end].y() == positions[idx].y())
+            {
+                ++end;
+            }
+            while (idx < end)
+            {
+                std::size_t last = idx;
+                LocType pitch = 0;
+                if (idx + 1 < end && positions[idx + 1].x() > positions[idx].x())
+                {
+                    pitch = positions[idx + 1].x() - positions[idx].x();
+                    last = idx + 1;
+                    while (last + 1 < end && positions[last + 1].x() - positions[last].x() == pitch)
+                    {
+                        ++last;
+                    }
+                }
+                runs[std::make_tuple(positions[idx].x(), static_cast<IndexType>(last - idx + 1), pitch)].emplace_back(positions[idx].y());
+                idx = last + 1;
+            }
+        }
+        arrays.clear();
+        for (const auto &run : runs)
+        {
+            const auto &ys = run.second;
+            std::size_t first = 0;
+            while (first < ys.size())
+            {
+                std::size_t last = first;
+                LocType pitch = 0;
+                if (first + 1 < ys.size() && ys[first + 1] > ys[first])
+                {
+                    pitch = ys[first + 1] - ys[first];
+                    last = first + 1;
+                    while (last + 1 < ys.size() && ys[last + 1] - ys[last] == pitch)
+                    {
+                        ++last;
+                    }
+                }
+                OasisArray array;
+                array.origin = XY<LocType>(std::get<0>(run.first), ys[first]);
+                array.cols = std::get<1>(run.first);
+                array.colSpace = std::get<2>(run.first);
+                array.rows = static_cast<IndexType>(last - first + 1);
+                array.rowSpace = pitch;
+                arrays.emplace_back(array);
+                first = last + 1;
+            }
+        }
+        std::sort(arrays.begin(), arrays.end(), [](const OasisArray &lhs, const OasisArray &rhs)
+                { return lhs.origin.y() != rhs.origin.y() ? lhs.origin.y() < rhs.origin.y() : lhs.origin.x() < rhs.origin.x(); });
+    }
+}
+
+/// @class MAGICAL_FLOW::OasisStream
+/// @brief Low-level OASIS record encoder. The coordinates are written in the relative xy mode and the repeated fields are left to the modal variables.
+/// The records of each cell may be deflated into a CBLOCK. The bytes of a cell are buffered and flushed to the output stream at the next cell
+class OasisStream
+{
+    public:
+        /// @brief constructor
+        /// @param first: the output stream. Should be opened in binary mode
+        /// @param second: the compression level of the CBLOCKs, 1 to 9. 0 for no CBLOCK
+        explicit OasisStream(std::ostream &os, int compressionLevel) : _os(os), _level(std::min(std::max(compressionLevel, 0), 9)) {}
+        /// @brief destructor. Flush the remaining bytes
+        ~OasisStream() { this->flush(); }
+        /*------------------------------*/
+        /* File and cells               */
+        /*------------------------------*/
+        /// @brief write the magic bytes and START. The name tables are not indexed
+        /// @param the database units per micron
+        void beginFile(IntType dbu)
+        {
+            // Byte by byte: the range insert into the empty buffer trips a false -Wstringop-overflow of gcc 12 at -O2
+            for (std::size_t idx = 0; idx < OASIS::MAGIC_SIZE; ++idx)
+            {
+                this->writeByte(static_cast<std::uint8_t>(OASIS::MAGIC[idx]));
+            }
+            this->writeByte(OASIS::REC_START);
+            this->writeString(OASIS::VERSION);
+            this->writeReal(static_cast<RealType>(dbu));
+            // offset-flag 0: the table offsets follow here, all of them 0
+            this->writeUnsigned(0);
+            for (IndexType idx = 0; idx < 12; ++idx)
+            {
+                this->writeUnsigned(0);
+            }
+        }
+        /// @brief write END, padded to 256 bytes, without validation, and flush the stream
+        void endFile()
+        {
+            std::size_t start = _buffer.size();
+            this->writeByte(OASIS::REC_END);
+            // The padding string, its 2-byte length and the 1-byte validation scheme fill the record
+            std::size_t padding = OASIS::END_RECORD_SIZE - 1 - 2 - 1;
+            this->writeUnsigned(padding);
+            _buffer.insert(_buffer.end(), padding, '\0');
+            this->writeUnsigned(0);
+            Assert(_buffer.size() - start == OASIS::END_RECORD_SIZE);
+            this->flush();
+        }
+        /// @brief write a CELLNAME with the next implicit reference number
+        /// @param the name of the cell
+        void writeCellName(const std::string &name)
+        {
+            this->writeByte(OASIS::REC_CELLNAME);
+            this->writeString(name);
+        }
+        /// @brief write CELL by reference number and reset the modal variables
+        /// @param the reference number of the CELLNAME
+        void beginCell(IndexType refnum)
+        {
+            this->flush();
+            if (_level > 0)
+            {
+                _cblockStart = _buffer.size();
+            }
+            this->writeByte(OASIS::REC_CELL_REF);
+            this->writeUnsigned(refnum);
+            this->writeByte(OASIS::REC_XYRELATIVE);
+            _modal = Modal();
+        }
+        /// @brief end the records of the cell. Deflates them into a CBLOCK if compressing
+        void endCell()
+        {
+            if (_cblockStart != NO_CBLOCK)
+            {
+                this->compressCBlock();
+                _cblockStart = NO_CBLOCK;
+            }
+        }
+        /*------------------------------*/
+        /* Elements                     */
+        /*------------------------------*/
+        /// @brief write an array of identical rectangles as one RECTANGLE
+        /// @param first: pdk layer
+        /// @param second: datatype
+        /// @param third, fourth: the width and the height
+        /// @param fifth: the lower left corners of the rectangles
+        void writeRectangle(IntType layer, IntType datatype, LocType width, LocType height, const WRITER::OasisArray &array)
+        {
+            std::uint8_t info = 0;
+            bool square = width == height;
+            if (square) { info |= OASIS::RECT_S; }
+            if (!_modal.layerSet || _modal.layer != layer) { info |= OASIS::RECT_L; }
+            if (!_modal.datatypeSet || _modal.datatype != datatype) { info |= OASIS::RECT_D; }
+            if (!_modal.sizeSet || _modal.width != width) { info |= OASIS::RECT_W; }
+            if (!square && (!_modal.sizeSet || _modal.height != height)) { info |= OASIS::RECT_H; }
+            if (array.origin.x() != _modal.geomX) { info |= OASIS::RECT_X; }
+            if (array.origin.y() != _modal.geomY) { info |= OASIS::RECT_Y; }
+            if (array.cols * array.rows > 1) { info |= OASIS::RECT_R; }
+            this->writeByte(OASIS::REC_RECTANGLE);
+            this->writeByte(info);
+            if (info & OASIS::RECT_L) { this->writeUnsigned(layer); }
+            if (info & OASIS::RECT_D) { this->writeUnsigned(datatype); }
+            if (info & OASIS::RECT_W) { this->writeUnsigned(width); }
+            if (info & OASIS::RECT_H) { this->writeUnsigned(height); }
+            if (info & OASIS::RECT_X) { this->writeSigned(static_cast<std::int64_t>(array.origin.x()) - _modal.geomX); }
+            if (info & OASIS::RECT_Y) { this->writeSigned(static_cast<std::int64_t>(array.origin.y()) - _modal.geomY); }
+            if (info & OASIS::RECT_R) { this->writeRepetition(array); }
+            _modal.layer = layer;
+            _modal.datatype = datatype;
+            _modal.width = width;
+            _modal.height = height;
+            _modal.layerSet = _modal.datatypeSet = _modal.sizeSet = true;
+            _modal.geomX = array.origin.x();
+            _modal.geomY = array.origin.y();
+        }
+        /// @brief write a rectilinear polygon as a POLYGON with a Manhattan point list
+        /// @param first: pdk layer
+        /// @param second: datatype
+        /// @param third: the x coordinates of the vertices
+        /// @param fourth: the y coordinates of the vertices
+        /// @param fifth: the number of vertices, even and at least 4. The edges are alternately horizontal and vertical
+        void writePolygon(IntType layer, IntType datatype, const LocType *xs, const LocType *ys, IndexType numPts)
+        {
+            Assert(numPts >= 4 && numPts % 2 == 0);
+            std::uint8_t info = OASIS::POLY_P;
+            if (!_modal.layerSet || _modal.layer != layer) { info |= OASIS::POLY_L; }
+            if (!_modal.datatypeSet || _modal.datatype != datatype) { info |= OASIS::POLY_D; }
+            if (xs[0] != _modal.geomX) { info |= OASIS::POLY_X; }
+            if (ys[0] != _modal.geomY) { info |= OASIS::POLY_Y; }
+            this->writeByte(OASIS::REC_POLYGON);
+            this->writeByte(info);
+            if (info & OASIS::POLY_L) { this->writeUnsigned(layer); }
+            if (info & OASIS::POLY_D) { this->writeUnsigned(datatype); }
+            // Type 0 starts with a horizontal edge and type 1 with a vertical one. The last vertex is implied
+            bool horizontalFirst = ys[1] == ys[0];
+            this->writeUnsigned(horizontalFirst ? 0 : 1);
+            this->writeUnsigned(numPts - 2);
+            for (IndexType idx = 0; idx + 2 < numPts; ++idx)
+            {
+                bool horizontal = horizontalFirst == (idx % 2 == 0);
+                this->writeSigned(horizontal ? static_cast<std::int64_t>(xs[idx + 1]) - xs[idx] : static_cast<std::int64_t>(ys[idx + 1]) - ys[idx]);
+            }
+            if (info & OASIS::POLY_X) { this->writeSigned(static_cast<std::int64_t>(xs[0]) - _modal.geomX); }
+            if (info & OASIS::POLY_Y) { this->writeSigned(static_cast<std::int64_t>(ys[0]) - _modal.geomY); }
+            _modal.layer = layer;
+            _modal.datatype = datatype;
+            _modal.layerSet = _modal.datatypeSet = true;
+            _modal.geomX = xs[0];
+            _modal.geomY = ys[0];
+        }
+        /// @brief write a TEXT with the string inline
+        /// @param first: pdk text layer
+        /// @param second: texttype
+        /// @param third: the string
+        /// @param fourth: the coordinate of the text
+        void writeText(IntType layer, IntType texttype, const std::string &str, const XY<LocType> &coord)
+        {
+            std::uint8_t info = 0;
+            if (!_modal.textSet || _modal.text != str) { info |= OASIS::TEXT_C; }
+            if (!_modal.textLayerSet || _modal.textLayer != layer) { info |= OASIS::TEXT_L; }
+            if (!_modal.textTypeSet || _modal.textType != texttype) { info |= OASIS::TEXT_T; }
+            if (coord.x() != _modal.textX) { info |= OASIS::TEXT_X; }
+            if (coord.y() != _modal.textY) { info |= OASIS::TEXT_Y; }
+            this->writeByte(OASIS::REC_TEXT);
+            this->writeByte(info);
+            if (info & OASIS::TEXT_C) { this->writeString(str); }
+            if (info & OASIS::TEXT_L) { this->writeUnsigned(layer); }
+            if (info & OASIS::TEXT_T) { this->writeUnsigned(texttype); }
+            if (info & OASIS::TEXT_X) { this->writeSigned(static_cast<std::int64_t>(coord.x()) - _modal.textX); }
+            if (info & OASIS::TEXT_Y) { this->writeSigned(static_cast<std::int64_t>(coord.y()) - _modal.textY); }
+            _modal.text = str;
+            _modal.textLayer = layer;
+            _modal.textType = texttype;
+            _modal.textSet = _modal.textLayerSet = _modal.textTypeSet = true;
+            _modal.textX = coord.x();
+            _modal.textY = coord.y();
+        }
+        /// @brief write an array of identical cell references as one PLACEMENT
+        /// @param first: the reference number of the CELLNAME of the placed cell
+        /// @param second: the positions of the references
+        /// @param third: the rotation angle in degree (counterclockwise), a multiple of 90
+        /// @param fourth: whether to reflect about the x axis before rotation
+        void writePlacement(IndexType refnum, const WRITER::OasisArray &array, RealType angle, bool reflect)
+        {
+            std::uint8_t info = 0;
+            if (!_modal.cellSet || _modal.cell != refnum) { info |= OASIS::PLACE_C | OASIS::PLACE_N; }
+            if (array.origin.x() != _modal.placeX) { info |= OASIS::PLACE_X; }
+            if (array.origin.y() != _modal.placeY) { info |= OASIS::PLACE_Y; }
+            if (array.cols * array.rows > 1) { info |= OASIS::PLACE_R; }
+            info |= static_cast<std::uint8_t>(((static_cast<IntType>(std::lround(angle / 90)) % 4 + 4) % 4) << 1);
+            if (reflect) { info |= OASIS::PLACE_F; }
+            this->writeByte(OASIS::REC_PLACEMENT);
+            this->writeByte(info);
+            if (info & OASIS::PLACE_C) { this->writeUnsigned(refnum); }
+            if (info & OASIS::PLACE_X) { this->writeSigned(static_cast<std::int64_t>(array.origin.x()) - _modal.placeX); }
+            if (info & OASIS::PLACE_Y) { this->writeSigned(static_cast<std::int64_t>(array.origin.y()) - _modal.placeY); }
+            if (info & OASIS::PLACE_R) { this->writeRepetition(array); }
+            _modal.cell = refnum;
+            _modal.cellSet = true;
+            _modal.placeX = array.origin.x();
+            _modal.placeY = array.origin.y();
+        }
+        /// @brief flush the buffered bytes into the output stream. Deferred inside a CBLOCK
+        void flush()
+        {
+            if (!_buffer.empty() && _cblockStart == NO_CBLOCK)
+            {
+                _os.write(_buffer.data(), _buffer.size());
+                _buffer.clear();
+            }
+        }
+    private:
+        /*------------------------------*/
+        /* Encoding                     */
+        /*------------------------------*/
+        /// @brief write the repetition of an array: a grid, a row or a column. The modal repetition is reused if it is the same
+        void writeRepetition(const WRITER::OasisArray &array)
+        {
+            auto rep = std::make_tuple(array.cols, array.rows, array.colSpace, array.rowSpace);
+            if (_modal.repSet && _modal.rep == rep)
+            {
+                this->writeUnsigned(OASIS::REP_REUSE);
+                return;
+            }
+            if (array.cols > 1 && array.rows > 1)
+            {
+                this->writeUnsigned(OASIS::REP_GRID);
+                this->writeUnsigned(array.cols - 2);
+                this->writeUnsigned(array.rows - 2);
+                this->writeUnsigned(array.colSpace);
+                this->writeUnsigned(array.rowSpace);
+            }
+            else if (array.cols > 1)
+            {
+                this->writeUnsigned(OASIS::REP_ROW);
+                this->writeUnsigned(array.cols - 2);
+                this->writeUnsigned(array.colSpace);
+            }
+            else
+            {
+                this->writeUnsigned(OASIS::REP_COLUMN);
+                this->writeUnsigned(array.rows - 2);
+                this->writeUnsigned(array.rowSpace);
+            }
+            _modal.rep = rep;
+            _modal.repSet = true;
+        }
+        /// @brief replace the bytes since the start of the cell with a CBLOCK of them deflated
+        void compressCBlock()
+        {
+            std::size_t numBytes = _buffer.size() - _cblockStart;
+            z_stream zs;
+            zs.zalloc = Z_NULL;
+            zs.zfree = Z_NULL;
+            zs.opaque = Z_NULL;
+            // Negative window bits for the raw DEFLATE stream without the zlib header
+            if (deflateInit2(&zs, _level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                return;
+            }
+            std::vector<char> compressed(deflateBound(&zs, static_cast<uLong>(numBytes)));
+            zs.next_in = reinterpret_cast<Bytef *>(_buffer.data() + _cblockStart);
+            zs.avail_in = static_cast<uInt>(numBytes);
+            zs.next_out = reinterpret_cast<Bytef *>(compressed.data());
+            zs.avail_out = static_cast<uInt>(compressed.size());
+            int status = deflate(&zs, Z_FINISH);
+            std::size_t numCompressed = compressed.size() - zs.avail_out;
+            deflateEnd(&zs);
+            if (status != Z_STREAM_END || numCompressed >= numBytes)
+            {
+                // Keep the records as they are
+                return;
+            }
+            _buffer.resize(_cblockStart);
+            this->writeByte(OASIS::REC_CBLOCK);
+            this->writeUnsigned(OASIS::CBLOCK_DEFLATE);
+            this->writeUnsigned(numBytes);
+            this->writeUnsigned(numCompressed);
+            _buffer.insert(_buffer.end(), compressed.begin(), compressed.begin() + numCompressed);
+        }
+        void writeByte(std::uint8_t value) { _buffer.push_back(static_cast<char>(value)); }
+        /// @brief write an unsigned-integer: 7 bits per byte from the least significant, the high bit telling that more bytes follow
+        void writeUnsigned(std::uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                _buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            _buffer.push_back(static_cast<char>(value));
+        }
+        /// @brief write a signed-integer: the sign in the lowest bit, then the magnitude
+        void writeSigned(std::int64_t value)
+        {
+            std::uint64_t magnitude = value < 0 ? static_cast<std::uint64_t>(-(value + 1)) + 1 : static_cast<std::uint64_t>(value);
+            this->writeUnsigned((magnitude << 1) | (value < 0 ? 1 : 0));
+        }
+        /// @brief write a string with its length
+        void writeString(const std::string &str)
+        {
+            this->writeUnsigned(str.size());
+            _buffer.insert(_buffer.end(), str.begin(), str.end());
+        }
+        /// @brief write a real: type 0 for a positive integer, else type 7, the little-endian IEEE double
+        void writeReal(RealType value)
+        {
+            if (value >= 0 && value < 9007199254740992.0 && value == std::floor(value))
+            {
+                this->writeUnsigned(0);
+                this->writeUnsigned(static_cast<std::uint64_t>(value));
+                return;
+            }
+            this->writeUnsigned(7);
+            std::uint64_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+            for (IntType shift = 0; shift < 64; shift += 8)
+            {
+                _buffer.push_back(static_cast<char>((bits >> shift) & 0xFF));
+            }
+        }
+    private:
+        /// @brief the modal variables of the elements written in a cell
+        struct Modal
+        {
+            IntType layer = 0, datatype = 0;
+            LocType width = 0, height = 0;
+            bool layerSet = false, datatypeSet = false, sizeSet = false;
+            std::int64_t geomX = 0, geomY = 0;
+            std::string text;
+            IntType textLayer = 0, textType = 0;
+            bool textSet = false, textLayerSet = false, textTypeSet = false;
+            std::int64_t textX = 0, textY = 0;
+            IndexType cell = 0;
+            bool cellSet = false;
+            std::int64_t placeX = 0, placeY = 0;
+            std::tuple<IndexType, IndexType, LocType, LocType> rep;
+            bool repSet = false;
+        };
+        static constexpr std::size_t NO_CBLOCK = static_cast<std::size_t>(-1);
+        std::ostream &_os; ///< The output stream
+        const int _level; ///< The compression level of the CBLOCKs
+        std::vector<char> _buffer; ///< The buffered bytes
+        std::size_t _cblockStart = NO_CBLOCK; ///< The offset of the current cell in the buffer, when compressing it
+        Modal _modal; ///< The modal variables
+};
+
+/// @class MAGICAL_FLOW::OasisWriter
+/// @brief Write the layout of circuits into OASIS. The identical rectangles of a layer in a regular array, as the fingers and the contacts of devices, become one RECTANGLE with a repetition.
+/// The layout is walked by const reference
+class OasisWriter
+{
+    public:
+        /// @brief constructor
+        /// @param first: a design database
+        /// @param second: a technology database
+        explicit OasisWriter(const DesignDB &designDB, const TechDB &techDB) : _designDB(designDB), _techDB(techDB) {}
+        /// @brief write the layout of a circuit into OASIS
+        /// @param first: the index of circuit graph
+        /// @param second: the output file name
+        /// @param third: whether to write each sub circuit once as its own cell and place it, instead of the flattened layout
+        /// @param fourth: the compression level of the CBLOCKs. 0 for none. For a .gz file name, the level of the whole file instead
+        /// @return if successful
+        bool writeLayout(IndexType cktIdx, const std::string &filename, bool hierarchical = false, int compressionLevel = MfGzip::DEFAULT_LEVEL);
+        /// @brief write the layout of a circuit into an OASIS stream
+        /// @param first: the index of circuit graph
+        /// @param second: the output stream, opened in binary mode
+        /// @param third: whether to write the sub circuits as placements
+        /// @param fourth: the compression level of the CBLOCKs
+        void writeLayout(IndexType cktIdx, std::ostream &os, bool hierarchical = false, int compressionLevel = MfGzip::DEFAULT_LEVEL);
+    private:
+        /// @brief order the circuits to write as cells, the sub circuits before their parents
+        void collectCells(IndexType cktIdx, bool hierarchical);
+        /// @brief write the layout of a circuit as a cell
+        void writeCktGraph(OasisStream &oas, IndexType cktIdx, bool hierarchical);
+    private:
+        const DesignDB &_designDB; ///< The design database
+        const TechDB &_techDB; ///< The technology database
+        std::vector<IndexType> _cells; ///< The circuits written as cells, in the order of their reference numbers
+        std::unordered_map<std::string, IndexType> _refnums; ///< The reference number of each cell name
+};
+
+inline bool OasisWriter::writeLayout(IndexType cktIdx, const std::string &filename, bool hierarchical, int compressionLevel)
+{
+    ScopedTimer timer("writeOasis ", _designDB.subCkt(cktIdx).name(), "oasis");
+    ScopedMemoryPeak memory("writeOasis");
+    if (MfGzip::isGzipFileName(filename))
+    {
+        // The whole file is compressed, so the CBLOCKs would not pay off
+        GzipOFStream os(filename, compressionLevel);
+        if (!os.isOpen())
+        {
+            ERR("Flow::OasisWriter:: cannot open file %s \n", filename.c_str());
+            return false;
+        }
+        this->writeLayout(cktIdx, os, hierarchical, 0);
+        if (!os.close())
+        {
+            ERR("Flow::OasisWriter:: cannot write file %s \n", filename.c_str());
+            return false;
+        }
+        Tracer::count("OASIS bytes written", static_cast<std::int64_t>(os.numBytesIn()));
+        INF("Flow::OasisWriter:: Write circuit %s layout to %s \n", _designDB.subCkt(cktIdx).name().c_str(), filename.c_str());
+        return true;
+    }
+    std::ofstream os(filename, std::ios::out | std::ios::binary);
+    if (!os.good())
+    {
+        ERR("Flow::OasisWriter:: cannot open file %s \n", filename.c_str());
+        return false;
+    }
+    this->writeLayout(cktIdx, os, hierarchical, compressionLevel);
+    Tracer::count("OASIS bytes written", static_cast<std::int64_t>(os.tellp()));
+    INF("Flow::OasisWriter:: Write circuit %s layout to %s \n", _designDB.subCkt(cktIdx).name().c_str(), filename.c_str());
+    return os.good();
+}
+
+inline void OasisWriter::writeLayout(IndexType cktIdx, std::ostream &os, bool hierarchical, int compressionLevel)
+{
+    _cells.clear();
+    _refnums.clear();
+    this->collectCells(cktIdx, hierarchical);
+    OasisStream oas(os, compressionLevel);
+    oas.beginFile(_techDB.units().dbu());
+    for (IndexType cellIdx : _cells)
+    {
+        oas.writeCellName(_designDB.subCkt(cellIdx).name());
+    }
+    for (IndexType cellIdx : _cells)
+    {
+        this->writeCktGraph(oas, cellIdx, hierarchical);
+    }
+    oas.endFile();
+}
+
+inline void OasisWriter::collectCells(IndexType cktIdx, bool hierarchical)
+{
+    const auto &cktGraph = _designDB.subCkt(cktIdx);
+    if (_refnums.find(cktGraph.name()) != _refnums.end())
+    {
+        return;
+    }
+    // Reserved before the sub circuits, so that a cyclic reference terminates
+    _refnums.emplace(cktGraph.name(), INDEX_TYPE_MAX);
+    if (hierarchical)
+    {
+        for (IndexType nodeIdx = 0; nodeIdx < cktGraph.numNodes(); ++nodeIdx)
+        {
+            const auto &node = cktGraph.node(nodeIdx);
+            if (!node.isLeaf())
+            {
+                this->collectCells(node.subgraphIdx(), hierarchical);
+            }
+        }
+    }
+    _refnums[cktGraph.name()] = _cells.size();
+    _cells.emplace_back(cktIdx);
+}
+
+inline void OasisWriter::writeCktGraph(OasisStream &oas, IndexType cktIdx, bool hierarchical)
+{
+    const auto &cktGraph = _designDB.subCkt(cktIdx);
+    const auto &cktLayout = cktGraph.layout();
+    oas.beginCell(_refnums.at(cktGraph.name()));
+    // The shapes drawn by the placements are not written again
+    const InstanceShapes instances = hierarchical ? InstanceShapes(_designDB, cktIdx) : InstanceShapes();
+    // (pdk layer, datatype, width, height) -> the lower left corners
+    std::map<std::tuple<IntType, IntType, LocType, LocType>, std::vector<XY<LocType>>> shapes;
+    for (IndexType layerIdx = 0; layerIdx < cktLayout.numLayers(); ++layerIdx)
+    {
+        const auto &layer = cktLayout.layer(layerIdx);
+        if (layer.numStoredRects() == 0)
+        {
+            continue;
+        }
+        IntType pdkLayer = static_cast<IntType>(_techDB.dbLayerToPdk(layerIdx));
+        // Skip the slices of the polygons, which are written as polygons
+        const auto skipped = layer.skippedRectRanges(false);
+        auto rangeIter = skipped.begin();
+        for (IndexType rectIdx = 0; rectIdx < layer.numStoredRects(); ++rectIdx)
+        {
+            while (rangeIter != skipped.end() && rangeIter->second <= rectIdx)
+            {
+                ++rangeIter;
+            }
+            if (rangeIter != skipped.end() && rangeIter->first <= rectIdx)
+            {
+                rectIdx = rangeIter->second - 1;
+                continue;
+            }
+            const auto &rect = layer.box(rectIdx);
+            if (instances.coversRect(layerIdx, rect, layer.datatype(rectIdx)))
+            {
+                continue;
+            }
+            auto key = std::make_tuple(pdkLayer, static_cast<IntType>(layer.datatype(rectIdx)), rect.xLen(), rect.yLen());
+            shapes[key].emplace_back(rect.ll());
+        }
+    }
+    std::vector<WRITER::OasisArray> arrays;
+    for (auto &shape : shapes)
+    {
+        WRITER::findOasisArrays(shape.second, arrays);
+        Tracer::count("OASIS rectangles repeated", static_cast<std::int64_t>(shape.second.size() - arrays.size()));
+        for (const auto &array : arrays)
+        {
+            oas.writeRectangle(std::get<0>(shape.first), std::get<1>(shape.first), std::get<2>(shape.first), std::get<3>(shape.first), array);
+        }
+    }
+    for (IndexType layerIdx = 0; layerIdx < cktLayout.numLayers(); ++layerIdx)
+    {
+        const auto &layer = cktLayout.layer(layerIdx);
+        if (layer.numPolygons() == 0)
+        {
+            continue;
+        }
+        IntType pdkLayer = static_cast<IntType>(_techDB.dbLayerToPdk(layerIdx));
+        for (IndexType polyIdx = 0; polyIdx < layer.numPolygons(); ++polyIdx)
+        {
+            if (instances.coversPolygon(layerIdx, layer, polyIdx))
+            {
+                continue;
+            }
+            IndexType first = layer.polygonStartArray()[polyIdx];
+            oas.writePolygon(pdkLayer, static_cast<IntType>(layer.polygonDatatype(polyIdx)), layer.polygonXArray().data() + first, layer.polygonYArray().data() + first,
+                    layer.numPolygonPoints(polyIdx));
+        }
+    }
+    for (IndexType layerIdx = 0; layerIdx < cktLayout.numLayers(); ++layerIdx)
+    {
+        const auto &layer = cktLayout.layer(layerIdx);
+        if (layer.textList().empty())
+        {
+            continue;
+        }
+        IntType pdkLayer = static_cast<IntType>(_techDB.dbLayerToPdk(layerIdx));
+        for (const auto &text : layer.textList())
+        {
+            if (instances.coversText(layerIdx, text))
+            {
+                continue;
+            }
+            // Texttype 0, as GdsWriter
+            oas.writeText(pdkLayer, 0, text.text(), text.coord());
+        }
+    }
+    if (hierarchical)
+    {
+        // (reference number, angle, reflection) -> the positions, so that the arrays of identical instances become one placement
+        std::map<std::tuple<IndexType, IntType, bool>, std::vector<XY<LocType>>> refs;
+        for (IndexType nodeIdx = 0; nodeIdx < cktGraph.numNodes(); ++nodeIdx)
+        {
+            const auto &node = cktGraph.node(nodeIdx);
+            if (node.isLeaf())
+            {
+                continue;
+            }
+            const auto &subCkt = _designDB.subCkt(node.subgraphIdx());
+            XY<LocType> position;
+            RealType angle = 0;
+            bool reflect = false;
+            WRITER::instanceTransform(node, subCkt.layout().boundary(), position, angle, reflect);
+            refs[std::make_tuple(_refnums.at(subCkt.name()), static_cast<IntType>(angle), reflect)].emplace_back(position);
+        }
+        for (auto &ref : refs)
+        {
+            WRITER::findOasisArrays(ref.second, arrays);
+            for (const auto &array : arrays)
+            {
+                oas.writePlacement(std::get<0>(ref.first), array, std::get<1>(ref.first), std::get<2>(ref.first));
+            }
+        }
+    }
+    oas.endCell();
+}
+
+namespace WRITER
+{
+    /// @brief write the layout for circuit to OASIS
+    /// @param first: circuit graph index
+    /// @param second: output file name
+    /// @param third: design database
+    /// @param fourth: technology database
+    /// @param fifth: whether to write the sub circuits as de-duplicated cells and placements
+    /// @param sixth: the compression level of the CBLOCKs. 0 for none
+    /// @return if successful
+    inline bool writeOasisLayout(IndexType cktIdx, const std::string &filename, const DesignDB &designDB, const TechDB &techDB, bool hierarchical = false, int compressionLevel = MfGzip::DEFAULT_LEVEL)
+    {
+        return OasisWriter(designDB, techDB).writeLayout(cktIdx, filename, hierarchical, compressionLevel);
+    }
+    /// @brief write the layout for circuit in the format of the file extension: OASIS for .oas and .oas.gz, else GDSII. Gzip compressed for .gz
+    /// @param first: circuit graph index
+    /// @param second: output file name
+    /// @param third: design database
+    /// @param fourth: technology database
+    /// @param fifth: whether to write the sub circuits as de-duplicated cells
+    /// @return if successful
+    inline bool writeLayoutFile(IndexType cktIdx, const std::string &filename, const DesignDB &designDB, const TechDB &techDB, bool hierarchical = false)
+    {
+        if (OASIS::isOasisFileName(filename))
+        {
+            return writeOasisLayout(cktIdx, filename, designDB, techDB, hierarchical);
+        }
+        return writeGdsLayoutStreaming(cktIdx, filename, designDB, techDB, hierarchical);
+    }
+}
+
+PROJECT_NAMESPACE_END
+
+#endif //MAGICAL_FLOW_OASIS_WRITER_H_
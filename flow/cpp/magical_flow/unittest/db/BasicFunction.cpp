@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 #include "global/global.h"
+#include "util/Polygon2Rect.h"
+#include "util/Tracer.h"
+#include "util/MsgPrinter.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
 
 extern std::string UNITTEST_TOP_DIR;
 
@@ -151,6 +158,227 @@ namespace unittest
         EXPECT_EQ(XY<LocType>(3, 5), ::PROJECT_NAMESPACE::MfUtil::flipEastCoordinate(ur, offset, bbox));
 
     }
+
+    TEST (Polygon2RectTest, RectilinearBox)
+    {
+        Box<LocType> rect;
+        // Closed, clockwise
+        std::vector<XY<LocType>> closed = { XY<LocType>(0, 0), XY<LocType>(0, 20), XY<LocType>(10, 20), XY<LocType>(10, 0), XY<LocType>(0, 0) };
+        EXPECT_TRUE(::klib::isRectilinearBox<LocType>(closed.data(), closed.size(), rect));
+        EXPECT_EQ(Box<LocType>(0, 0, 10, 20), rect);
+        // Open, counterclockwise
+        std::vector<XY<LocType>> open = { XY<LocType>(10, 20), XY<LocType>(-5, 20), XY<LocType>(-5, 3), XY<LocType>(10, 3) };
+        EXPECT_TRUE(::klib::isRectilinearBox<LocType>(open.data(), open.size(), rect));
+        EXPECT_EQ(Box<LocType>(-5, 3, 10, 20), rect);
+        // Skewed
+        std::vector<XY<LocType>> skewed = { XY<LocType>(0, 0), XY<LocType>(1, 20), XY<LocType>(10, 20), XY<LocType>(10, 0) };
+        EXPECT_FALSE(::klib::isRectilinearBox<LocType>(skewed.data(), skewed.size(), rect));
+        // L shape
+        std::vector<XY<LocType>> lShape = { XY<LocType>(0, 0), XY<LocType>(0, 20), XY<LocType>(5, 20), XY<LocType>(5, 10), XY<LocType>(10, 10), XY<LocType>(10, 0) };
+        EXPECT_FALSE(::klib::isRectilinearBox<LocType>(lShape.data(), lShape.size(), rect));
+        // Degenerate
+        std::vector<XY<LocType>> line = { XY<LocType>(0, 0), XY<LocType>(0, 20), XY<LocType>(0, 20), XY<LocType>(0, 0) };
+        EXPECT_FALSE(::klib::isRectilinearBox<LocType>(line.data(), line.size(), rect));
+    }
+
+    TEST (TracerTest, TimersAndCounters)
+    {
+        Tracer::clear();
+        Tracer::enable(false);
+        {
+            ScopedTimer timer("disabled");
+            ScopedTimer joined("disabled ", std::string("joined"), "test");
+            Tracer::count("disabled");
+        }
+        EXPECT_EQ(0u, Tracer::numEvents());
+        EXPECT_EQ(0, Tracer::counter("disabled"));
+
+        Tracer::enable(true);
+        {
+            ScopedTimer timer("outer", "test");
+            ScopedTimer joined("outer ", std::string("joined"), "test");
+            std::vector<std::thread> workers;
+            for (IndexType idx = 0; idx < 4; ++idx)
+            {
+                workers.emplace_back([]() { ScopedTimer inner("worker", "test"); Tracer::count("items", 10); });
+            }
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+        }
+        Tracer::enable(false);
+        EXPECT_EQ(6u, Tracer::numEvents());
+        EXPECT_EQ(40, Tracer::counter("items"));
+        const std::string summary = Tracer::summary();
+        EXPECT_NE(std::string::npos, summary.find("worker"));
+        EXPECT_NE(std::string::npos, summary.find("items"));
+
+        const std::string fileName = "tracer_test.json";
+        ASSERT_TRUE(Tracer::writeChromeTrace(fileName));
+        std::ifstream in(fileName);
+        const std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        EXPECT_NE(std::string::npos, json.find("\"traceEvents\""));
+        EXPECT_NE(std::string::npos, json.find("\"name\": \"outer\""));
+        EXPECT_NE(std::string::npos, json.find("\"name\": \"outer joined\""));
+        EXPECT_NE(std::string::npos, json.find("\"ph\": \"C\""));
+        std::remove(fileName.c_str());
+        Tracer::clear();
+        EXPECT_EQ(0u, Tracer::numEvents());
+    }
+    TEST (TracerTest, SamplesAndMemoryPeaks)
+    {
+        Tracer::clear();
+        Tracer::enable(true);
+        Tracer::sample("bytes", 3);
+        Tracer::sample("bytes", 7);
+        Tracer::sample("bytes", 5);
+        EXPECT_EQ(5, Tracer::lastSample("bytes"));
+        EXPECT_EQ(0, Tracer::lastSample("none"));
+        {
+            // Not tracked unless enabled
+            ScopedMemoryPeak memory("untracked");
+        }
+        EXPECT_EQ(0, Tracer::lastSample("untracked peak rss"));
+        Tracer::enableMemoryTracking(true);
+        {
+            ScopedMemoryPeak memory("alloc");
+            std::vector<char> block(8 << 20, 1);
+            EXPECT_EQ(1, block[block.size() / 2]);
+        }
+        Tracer::enableMemoryTracking(false);
+        Tracer::enable(false);
+        if (Tracer::residentBytes() > 0)
+        {
+            EXPECT_GE(Tracer::lastSample("alloc peak rss"), Tracer::lastSample("alloc rss"));
+            EXPECT_GE(Tracer::peakResidentBytes(), Tracer::residentBytes());
+        }
+        const std::string summary = Tracer::summary();
+        EXPECT_NE(std::string::npos, summary.find("bytes"));
+        EXPECT_NE(std::string::npos, summary.find("largest"));
+
+        const std::string fileName = "tracer_sample_test.json";
+        ASSERT_TRUE(Tracer::writeChromeTrace(fileName));
+        std::ifstream in(fileName);
+        const std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        EXPECT_NE(std::string::npos, json.find("\"name\": \"bytes\", \"args\": {\"value\": 7}"));
+        std::remove(fileName.c_str());
+        Tracer::clear();
+    }
+
+    TEST (MsgPrinterTest, AsyncAndLevels)
+    {
+        const std::string fileName = "msg_printer_test.log";
+        MsgPrinter::screenOff();
+        MsgPrinter::openLogFile(fileName);
+        // A small ring, so that the producers also wait for the writer
+        MsgPrinter::startAsync(16);
+        EXPECT_TRUE(MsgPrinter::isAsync());
+        std::vector<std::thread> workers;
+        for (IndexType idx = 0; idx < 4; ++idx)
+        {
+            workers.emplace_back([idx]()
+                    {
+                        for (IndexType msg = 0; msg < 500; ++msg)
+                        {
+                            MsgPrinter::inf("thread %u message %u\n", idx, msg);
+                        }
+                    });
+        }
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+        MsgPrinter::setMinType(MsgType::WRN);
+        EXPECT_FALSE(MsgPrinter::enabled(MsgType::INF));
+        EXPECT_TRUE(MsgPrinter::enabled(MsgType::ERR));
+        MsgPrinter::inf("filtered\n");
+        MsgPrinter::dbg("filtered\n");
+        MsgPrinter::wrn("kept\n");
+        MsgPrinter::setMinType(MsgType::DBG);
+        MsgPrinter::flush();
+        MsgPrinter::stopAsync();
+        EXPECT_FALSE(MsgPrinter::isAsync());
+        MsgPrinter::closeLogFile();
+        MsgPrinter::screenOn();
+
+        std::ifstream in(fileName);
+        std::string line;
+        IndexType numLines = 0;
+        std::vector<IndexType> nextMsg(4, 0);
+        bool ordered = true;
+        while (std::getline(in, line))
+        {
+            ++numLines;
+            EXPECT_EQ(std::string::npos, line.find("filtered"));
+            unsigned threadIdx = 0, msgIdx = 0;
+            auto pos = line.find("thread ");
+            if (pos != std::string::npos && std::sscanf(line.c_str() + pos, "thread %u message %u", &threadIdx, &msgIdx) == 2)
+            {
+                ordered = ordered && msgIdx == nextMsg[threadIdx];
+                nextMsg[threadIdx] = msgIdx + 1;
+            }
+        }
+        // Open, the 2000 messages, the warning and close
+        EXPECT_EQ(2003u, numLines);
+        EXPECT_TRUE(ordered);
+        std::remove(fileName.c_str());
+    }
+
+    TEST (MsgPrinterTest, SynchronousThreads)
+    {
+        // The warnings of the readers called without the GIL, printed synchronously while the timer is reset
+        const std::string fileName = "msg_printer_sync_test.log";
+        MsgPrinter::screenOff();
+        MsgPrinter::openLogFile(fileName);
+        EXPECT_FALSE(MsgPrinter::isAsync());
+        std::vector<std::thread> workers;
+        for (IndexType idx = 0; idx < 4; ++idx)
+        {
+            workers.emplace_back([idx]()
+                    {
+                        for (IndexType msg = 0; msg < 500; ++msg)
+                        {
+                            MsgPrinter::wrn("thread %u message %u\n", idx, msg);
+                        }
+                    });
+        }
+        for (IndexType idx = 0; idx < 100; ++idx)
+        {
+            MsgPrinter::startTimer();
+        }
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+        MsgPrinter::closeLogFile();
+        MsgPrinter::screenOn();
+
+        std::ifstream in(fileName);
+        std::string line;
+        IndexType numMessages = 0;
+        std::vector<IndexType> nextMsg(4, 0);
+        bool whole = true;
+        while (std::getline(in, line))
+        {
+            unsigned threadIdx = 0, msgIdx = 0;
+            auto pos = line.find("]  thread ");
+            if (pos == std::string::npos)
+            {
+                continue;
+            }
+            ++numMessages;
+            whole = whole && line.compare(0, 4, "[WRN") == 0 && std::sscanf(line.c_str() + pos, "]  thread %u message %u", &threadIdx, &msgIdx) == 2
+                && threadIdx < 4 && msgIdx == nextMsg[threadIdx];
+            if (threadIdx < 4)
+            {
+                nextMsg[threadIdx] = msgIdx + 1;
+            }
+        }
+        EXPECT_EQ(2000u, numMessages);
+        EXPECT_TRUE(whole);
+        std::remove(fileName.c_str());
+    }
 }
 
 PROJECT_NAMESPACE_END
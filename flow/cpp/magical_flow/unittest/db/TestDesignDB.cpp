@@ -1,6 +1,24 @@
 #include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <tuple>
 #include "db/DesignDB.h"
+#include "db/CktContentHash.h"
+#include "db/DesignCheckpoint.h"
+#include "db/FloorplanEstimator.h"
+#include "db/MemoryUsage.h"
+#include "db/NetLength.h"
+#include "db/PrimarySym.h"
+#include "db/SpectralSim.h"
+#include "db/SymCandidates.h"
+#include "db/SyntheticDesign.h"
+#include "parser/ParseNetlist.h"
+#include "writer/GdsStreamWriter.h"
+#include "util/Tracer.h"
+#include <cstdio>
+#include <fstream>
 
+extern std::string UNITTEST_TOP_DIR;
 
 PROJECT_NAMESPACE_BEGIN
 
@@ -15,6 +33,16 @@ namespace unittest
             }
             /// @brief function to init a simple db with easy node hierarchy
             void initSimpleHierarchy();
+            /// @brief add a nch device circuit with nets "0", "1" and "2"
+            /// @param the width of the transistor
+            /// @return the index of the circuit
+            IndexType addNch(IntType width);
+            /// @brief add a circuit placing two nodes of a sub circuit, the second one flipped, with two nets
+            /// @return the index of the top circuit
+            IndexType initPinShapes();
+            /// @brief add a circuit of a differential pair, its tail, a load resistor between the outputs and a diode, powered by "gnd"
+            /// @return the index of the top circuit
+            IndexType initDiffPair();
             DesignDB _db; ///< The db under test
     };
 
@@ -55,13 +83,971 @@ namespace unittest
         _db.subCkt(6).node(idx).setSubgraphIdx(4);
     }
 
+    inline IndexType DesignDBTest::addNch(IntType width)
+    {
+        IndexType cktIdx = _db.allocateCkt();
+        IndexType propIdx = _db.phyPropDB().allocateNch();
+        _db.phyPropDB().nch(propIdx).setWidth(width);
+        _db.phyPropDB().nch(propIdx).setLength(100);
+        auto &ckt = _db.subCkt(cktIdx);
+        ckt.setImplType(ImplType::PCELL_Nch);
+        ckt.setImplIdx(propIdx);
+        for (IndexType idx = 0; idx < 3; ++idx)
+        {
+            ckt.net(ckt.allocateNet()).setName(std::to_string(idx));
+        }
+        return cktIdx;
+    }
+
+    inline IndexType DesignDBTest::initPinShapes()
+    {
+        IndexType subIdx = _db.allocateCkt();
+        IndexType topIdx = _db.allocateCkt();
+        auto &sub = _db.subCkt(subIdx);
+        sub.layout().setBoundary(0, 0, 10, 20);
+        sub.net(sub.allocateNet()).addIoPin(1, 2, 3, 4, 1);
+        sub.net(0).addIoPin(5, 6, 7, 8, 2);
+        sub.net(0).markIoPowerStripe(0);
+        sub.net(sub.allocateNet()).addIoPin(2, 2, 4, 4, 1);
+        sub.net(1).setIoPos(0);
+        auto &top = _db.subCkt(topIdx);
+        for (IndexType nodeIdx = 0; nodeIdx < 2; ++nodeIdx)
+        {
+            top.node(top.allocateNode()).setSubgraphIdx(subIdx);
+        }
+        top.node(1).setOffset(100, 0);
+        top.node(1).setFlipVertFlag(true);
+        top.allocateNet();
+        top.allocateNet();
+        // net 0: sub net 0 of both nodes. net 1: sub net 1 of node 0 through an invalid pin, and of node 1
+        const IndexType pinNodes[4] = {0, 1, 0, 1};
+        const IndexType pinNets[4] = {0, 0, 1, 1};
+        for (IndexType pinIdx = 0; pinIdx < 4; ++pinIdx)
+        {
+            top.allocatePin();
+            top.pin(pinIdx).setNodeIdx(pinNodes[pinIdx]);
+            top.pin(pinIdx).setIntNetIdx(pinNets[pinIdx]);
+            top.pin(pinIdx).setNetIdx(pinNets[pinIdx]);
+            top.node(pinNodes[pinIdx]).appendPinIdx(pinIdx);
+            top.net(pinNets[pinIdx]).appendPinIdx(pinIdx);
+        }
+        top.pin(2).setValid(false);
+        return topIdx;
+    }
+
     // Test whether the find root node function
+    inline IndexType DesignDBTest::initDiffPair()
+    {
+        IndexType nchIdx = addNch(200);
+        IndexType wideNchIdx = addNch(400);
+        IndexType resIdx = _db.allocateCkt();
+        _db.subCkt(resIdx).setImplType(ImplType::PCELL_Res);
+        for (IndexType cktIdx : {nchIdx, wideNchIdx, resIdx})
+        {
+            _db.subCkt(cktIdx).layout().setBoundary(0, 0, 10, 10);
+        }
+        IndexType topIdx = _db.allocateCkt();
+        auto &top = _db.subCkt(topIdx);
+        const std::vector<std::string> netNames = {"n1", "n2", "inp", "inn", "tail", "bias", "gnd", "n3"};
+        for (const auto &name : netNames)
+        {
+            top.net(top.allocateNet()).setName(name);
+        }
+        const std::vector<std::pair<IndexType, std::vector<IndexType>>> nodes = {
+            {nchIdx, {0, 2, 4}}, {nchIdx, {1, 3, 4}}, {wideNchIdx, {4, 5, 6}}, {resIdx, {0, 1}}, {nchIdx, {7, 7, 6}}};
+        for (const auto &node : nodes)
+        {
+            IndexType nodeIdx = top.allocateNode();
+            top.node(nodeIdx).setSubgraphIdx(node.first);
+            for (IndexType netIdx : node.second)
+            {
+                IndexType pinIdx = top.allocatePin();
+                top.pin(pinIdx).setNodeIdx(nodeIdx);
+                top.pin(pinIdx).setNetIdx(netIdx);
+                top.node(nodeIdx).appendPinIdx(pinIdx);
+                top.net(netIdx).appendPinIdx(pinIdx);
+            }
+        }
+        return topIdx;
+    }
+
     TEST_F(DesignDBTest, rootNodeTest)
     {
         initSimpleHierarchy();
         _db.findRootCkt();
         EXPECT_EQ(_db.rootCktIdx(), static_cast<IndexType>(6));
     }
+
+    // Test the levelized hierarchy and its invalidation
+    TEST_F(DesignDBTest, hierarchyTest)
+    {
+        initSimpleHierarchy();
+        const CktHierarchy &hier = _db.hierarchy();
+        EXPECT_TRUE(hier.isAcyclic());
+        ASSERT_EQ(hier.numLevels(), 5);
+        EXPECT_EQ(hier.levelCkts(0), std::vector<IndexType>({0, 1}));
+        EXPECT_EQ(hier.levelCkts(1), std::vector<IndexType>({3, 4}));
+        EXPECT_EQ(hier.levelCkts(2), std::vector<IndexType>({2}));
+        EXPECT_EQ(hier.levelCkts(4), std::vector<IndexType>({6}));
+        EXPECT_EQ(hier.bottomUpOrder(), std::vector<IndexType>({0, 1, 3, 4, 2, 5, 6}));
+        EXPECT_EQ(hier.children(5), std::vector<IndexType>({2, 0}));
+        EXPECT_EQ(hier.parents(1), std::vector<IndexType>({3, 4}));
+        EXPECT_EQ(hier.roots(), std::vector<IndexType>({6}));
+        // A second instance of the same sub circuit is not a new edge
+        auto nodeIdx = _db.subCkt(5).allocateNode();
+        _db.subCkt(5).node(nodeIdx).setSubgraphIdx(0);
+        EXPECT_EQ(_db.hierarchy().children(5), std::vector<IndexType>({2, 0}));
+        // Instantiating circuit 6 in a new circuit
+        IndexType topIdx = _db.allocateCkt();
+        nodeIdx = _db.subCkt(topIdx).allocateNode();
+        _db.subCkt(topIdx).node(nodeIdx).setSubgraphIdx(6);
+        _db.subCkt(topIdx).touchNodes();
+        EXPECT_EQ(_db.hierarchy().numLevels(), 6);
+        EXPECT_EQ(_db.hierarchy().level(topIdx), 5);
+        EXPECT_EQ(_db.hierarchy().roots(), std::vector<IndexType>({topIdx}));
+    }
+
+    // Test the lazily allocated layout and the arena backed arrays
+    TEST_F(DesignDBTest, lazyCktStorageTest)
+    {
+        IndexType cktIdx = addNch(200);
+        const CktGraph &constCkt = _db.subCkt(cktIdx);
+        EXPECT_FALSE(constCkt.hasLayout());
+        EXPECT_EQ(constCkt.layout().numRects(0), 0);
+        EXPECT_FALSE(constCkt.hasLayout());
+        _db.subCkt(cktIdx).layout().insertRect(0, Box<LocType>(0, 0, 10, 10));
+        EXPECT_TRUE(constCkt.hasLayout());
+        EXPECT_GT(_db.arena().reservedBytes(), 0);
+        // The copy is deep and shares the arena
+        CktGraph copy = constCkt;
+        copy.layout().insertRect(0, Box<LocType>(0, 0, 5, 5));
+        copy.net(copy.allocateNet()).setName("3");
+        EXPECT_EQ(constCkt.layout().numRects(0), 1);
+        EXPECT_EQ(copy.layout().numRects(0), 2);
+        EXPECT_EQ(constCkt.numNets(), 3);
+        EXPECT_EQ(copy.nodeArray().get_allocator(), constCkt.nodeArray().get_allocator());
+    }
+
+    // Test packing the pin lists and interning the names
+    TEST_F(DesignDBTest, compactConnectivityTest)
+    {
+        IndexType cktIdx = _db.allocateCkt();
+        auto &ckt = _db.subCkt(cktIdx);
+        for (IndexType nodeIdx = 0; nodeIdx < 2; ++nodeIdx)
+        {
+            ckt.node(ckt.allocateNode()).setRefName("nch");
+        }
+        IndexType netIdx = ckt.allocateNet();
+        for (IndexType pinIdx = 0; pinIdx < 4; ++pinIdx)
+        {
+            ckt.allocatePin();
+            ckt.node(pinIdx % 2).appendPinIdx(pinIdx);
+            ckt.net(netIdx).appendPinIdx(3 - pinIdx);
+        }
+        ckt.net(netIdx).appendSubIdx(1);
+        _db.compactConnectivity();
+        EXPECT_EQ(ckt.node(0).pinIdxArray().toVector(), std::vector<IndexType>({0, 2}));
+        EXPECT_EQ(ckt.node(1).pinIdxArray().toVector(), std::vector<IndexType>({1, 3}));
+        EXPECT_EQ(ckt.net(netIdx).pinIdxArray().toVector(), std::vector<IndexType>({3, 2, 1, 0}));
+        EXPECT_EQ(ckt.net(netIdx).numSubs(), 1);
+        // The lists of the two nodes are adjacent in the packed array
+        EXPECT_EQ(ckt.node(0).pinIdxArray().end(), ckt.node(1).pinIdxArray().begin());
+        // Appending detaches a list without touching the others
+        ckt.node(0).appendPinIdx(3);
+        EXPECT_EQ(ckt.node(0).pinIdxArray().toVector(), std::vector<IndexType>({0, 2, 3}));
+        EXPECT_EQ(ckt.node(1).pinIdxArray().toVector(), std::vector<IndexType>({1, 3}));
+        // A copy owns its packed arrays
+        CktGraph copy = ckt;
+        ckt.compactConnectivity();
+        EXPECT_EQ(copy.node(1).pinIdxArray().toVector(), std::vector<IndexType>({1, 3}));
+        EXPECT_NE(copy.node(1).pinIdxArray().begin(), ckt.node(1).pinIdxArray().begin());
+        // The names are shared
+        EXPECT_EQ(&ckt.node(0).refName(), &ckt.node(1).refName());
+        EXPECT_EQ(ckt.node(0).refName(), "nch");
+        EXPECT_EQ(ckt.node(0).name(), "");
+        EXPECT_EQ(ckt.net(netIdx).numIoPins(), 1);
+    }
+
+    // Test the memory footprint of a circuit, of a sub hierarchy and of the design, with a layout shared by two circuits
+    TEST_F(DesignDBTest, memoryUsageTest)
+    {
+        initSimpleHierarchy();
+        auto layout = std::make_shared<Layout>();
+        for (IndexType rectIdx = 0; rectIdx < 3; ++rectIdx)
+        {
+            layout->insertRect(2, Box<LocType>(0, 0, 10, 10 + rectIdx));
+        }
+        layout->insertText(2, "vdd", 0, 0);
+        _db.subCkt(0).shareLayout(layout);
+        _db.subCkt(1).shareLayout(layout);
+        _db.subCkt(0).gdsData().setGdsFile("a_long_file_name_beyond_the_small_string.gds");
+        _db.subCkt(4).net(_db.subCkt(4).allocateNet()).addIoPin(0, 0, 10, 10, 1);
+
+        const MemoryUsage ckt = MemoryUsage::ofCkt(_db.subCkt(0));
+        EXPECT_EQ(ckt.circuits.count, 1u);
+        EXPECT_EQ(ckt.layout.count, 1u);
+        ASSERT_GT(ckt.layers.size(), 2u);
+        EXPECT_EQ(ckt.layers[2].count, 4u);
+        EXPECT_GE(ckt.layers[2].bytes, sizeof(LayoutLayer) + 3 * 4 * sizeof(LocType));
+        EXPECT_EQ(ckt.gdsData.count, 1u);
+        EXPECT_GT(ckt.gdsData.bytes, 0u);
+
+        // Circuits 4, 0 and 1, the layout counted once
+        const MemoryUsage subtree = MemoryUsage::ofSubtree(_db, 4);
+        EXPECT_EQ(subtree.circuits.count, 3u);
+        EXPECT_EQ(subtree.nodes.count, 2u);
+        EXPECT_EQ(subtree.nets.count, 1u);
+        EXPECT_EQ(subtree.ioInterfaces.count, 1u);
+        EXPECT_EQ(subtree.layout.count, 1u);
+        EXPECT_EQ(subtree.layers[2].bytes, ckt.layers[2].bytes);
+
+        const MemoryUsage design = MemoryUsage::ofDesign(_db);
+        EXPECT_EQ(design.circuits.count, 7u);
+        EXPECT_EQ(design.nodes.count, 8u);
+        EXPECT_EQ(design.layout.count, 1u);
+        EXPECT_EQ(design.techDB.bytes, 0u);
+        EXPECT_GT(design.totalBytes(), subtree.totalBytes());
+        EXPECT_NE(design.summary().find("layer 2"), std::string::npos);
+
+        // The bytes are sampled into the trace
+        Tracer::clear();
+        Tracer::enable(true);
+        design.trace("design");
+        Tracer::enable(false);
+        EXPECT_EQ(Tracer::lastSample("memory design nodes"), static_cast<std::int64_t>(design.nodes.bytes));
+        EXPECT_EQ(Tracer::lastSample("memory design total"), static_cast<std::int64_t>(design.totalBytes()));
+        EXPECT_NE(Tracer::summary().find("memory design layer 2"), std::string::npos);
+        Tracer::clear();
+    }
+
+    // Test sharing a device layout between devices with the same properties
+    TEST_F(DesignDBTest, deviceLayoutCacheTest)
+    {
+        IndexType first = addNch(200);
+        IndexType same = addNch(200);
+        IndexType other = addNch(400);
+        auto &ckt = _db.subCkt(first);
+        ckt.layout().insertRect(3, Box<LocType>(0, 0, 10, 20));
+        ckt.gdsData().setBBox(0, 0, 10, 20);
+        ckt.gdsData().setGdsFile("first.gds");
+        ckt.net(1).addIoPin(2, 3, 4, 5, 1);
+        EXPECT_FALSE(_db.restoreDeviceLayout(first, false));
+        _db.cacheDeviceLayout(first, false);
+        EXPECT_EQ(_db.deviceLayoutCache().numEntries(), static_cast<IndexType>(1));
+
+        EXPECT_TRUE(_db.restoreDeviceLayout(same, false));
+        auto &sameCkt = _db.subCkt(same);
+        ASSERT_EQ(sameCkt.layout().numRects(3), static_cast<IndexType>(1));
+        EXPECT_EQ(sameCkt.layout().rect(3, 0).rect(), Box<LocType>(0, 0, 10, 20));
+        EXPECT_EQ(sameCkt.gdsData().bbox(), Box<LocType>(0, 0, 10, 20));
+        EXPECT_EQ(sameCkt.gdsData().gdsFile(), "first.gds");
+        EXPECT_EQ(sameCkt.net(1).ioShape(), Box<LocType>(2, 3, 4, 5));
+        EXPECT_EQ(sameCkt.net(1).ioLayer(), static_cast<IndexType>(1));
+
+        // Different properties or flip flag
+        EXPECT_FALSE(_db.restoreDeviceLayout(other, false));
+        EXPECT_FALSE(_db.restoreDeviceLayout(same, true));
+        EXPECT_EQ(_db.deviceLayoutCache().numHits(), static_cast<IndexType>(1));
+    }
+
+    // Test reading back a persisted device layout
+    TEST_F(DesignDBTest, deviceLayoutCachePersistTest)
+    {
+        IndexType first = addNch(200);
+        _db.deviceLayoutCache().setCacheDir(UNITTEST_TOP_DIR);
+        auto &ckt = _db.subCkt(first);
+        ckt.layout().insertRect(3, Box<LocType>(-5, 0, 10, 20));
+        ckt.layout().setRectDatatype(3, 0, 2);
+        ckt.gdsData().setBBox(-5, 0, 10, 20);
+        ckt.net(2).addIoPin(2, 3, 4, 5, 1);
+        ckt.net(2).addIoPin(6, 7, 8, 9, 2);
+        _db.cacheDeviceLayout(first, true);
+
+        DesignDB db;
+        db.deviceLayoutCache().setCacheDir(UNITTEST_TOP_DIR);
+        IndexType cktIdx = db.allocateCkt();
+        IndexType propIdx = db.phyPropDB().allocateNch();
+        db.phyPropDB().nch(propIdx).setWidth(200);
+        db.phyPropDB().nch(propIdx).setLength(100);
+        auto &restored = db.subCkt(cktIdx);
+        restored.setImplType(ImplType::PCELL_Nch);
+        restored.setImplIdx(propIdx);
+        for (IndexType idx = 0; idx < 3; ++idx)
+        {
+            restored.net(restored.allocateNet()).setName(std::to_string(idx));
+        }
+        EXPECT_TRUE(db.restoreDeviceLayout(cktIdx, true));
+        ASSERT_EQ(restored.layout().numRects(3), static_cast<IndexType>(1));
+        EXPECT_EQ(restored.layout().rect(3, 0).rect(), Box<LocType>(-5, 0, 10, 20));
+        EXPECT_EQ(restored.layout().rect(3, 0).datatype(), static_cast<IndexType>(2));
+        EXPECT_EQ(restored.layout().boundary(), ckt.layout().boundary());
+        ASSERT_EQ(restored.net(2).numIoPins(), static_cast<IndexType>(2));
+        EXPECT_EQ(restored.net(2).ioPinShape(1), Box<LocType>(6, 7, 8, 9));
+        EXPECT_EQ(restored.net(2).ioPinMetalLayer(1), static_cast<IndexType>(2));
+
+        std::remove(_db.deviceLayoutCache().entryFile(DeviceLayoutCache::deviceKey(_db.phyPropDB(), ckt, true)).c_str());
+    }
+
+    // Test estimating the circuit sizes bottom-up from the layouts, the cache and the device model
+    TEST_F(DesignDBTest, floorplanEstimatorTest)
+    {
+        IndexType first = addNch(200);
+        IndexType same = addNch(200);
+        IndexType model = addNch(1600000);
+        _db.phyPropDB().nch(_db.subCkt(model).implIdx()).setLength(100000);
+        _db.subCkt(first).layout().insertRect(3, Box<LocType>(0, 0, 10, 20));
+        _db.cacheDeviceLayout(first, false);
+        IndexType topIdx = _db.allocateCkt();
+        for (IndexType subIdx : {first, same, model, model})
+        {
+            auto &top = _db.subCkt(topIdx);
+            top.node(top.allocateNode()).setSubgraphIdx(subIdx);
+        }
+        IndexType parentIdx = _db.allocateCkt();
+        for (IndexType nodeIdx = 0; nodeIdx < 2; ++nodeIdx)
+        {
+            auto &parent = _db.subCkt(parentIdx);
+            parent.node(parent.allocateNode()).setSubgraphIdx(topIdx);
+        }
+
+        FloorplanEstimator estimator(_db);
+        estimator.setUtilization(0.5);
+        EXPECT_EQ(estimator.estimate(topIdx), static_cast<IndexType>(4));
+        EXPECT_EQ(estimator.source(first), FloorplanSource::LAYOUT);
+        EXPECT_EQ(estimator.source(same), FloorplanSource::CACHE);
+        EXPECT_EQ(estimator.boundary(same), Box<LocType>(0, 0, 10, 20));
+        EXPECT_FALSE(_db.subCkt(same).hasLayout());
+        // 1600 nm x 100 nm gate, 25 times as large
+        EXPECT_EQ(estimator.source(model), FloorplanSource::MODEL);
+        EXPECT_EQ(estimator.width(model), 2000);
+        EXPECT_EQ(estimator.height(model), 2000);
+        // (200 + 200 + 2 * 2000^2) / 0.5 in a square
+        EXPECT_EQ(estimator.source(topIdx), FloorplanSource::HIERARCHY);
+        EXPECT_EQ(estimator.width(topIdx), 4001);
+        EXPECT_EQ(estimator.height(topIdx), 4000);
+        EXPECT_EQ(estimator.source(parentIdx), FloorplanSource::NONE);
+
+        // A floorplanned size propagates to the parents, which are at least as large as their nodes
+        estimator.setSize(topIdx, 100, 50);
+        estimator.estimateCkt(parentIdx);
+        EXPECT_EQ(estimator.width(parentIdx), 142);
+        EXPECT_EQ(estimator.height(parentIdx), 141);
+        estimator.setAspectRatio(0.01);
+        estimator.estimateCkt(parentIdx);
+        EXPECT_EQ(estimator.width(parentIdx), 100);
+        EXPECT_EQ(estimator.height(parentIdx), 200);
+    }
+
+    // Test reading back a design checkpoint
+    TEST_F(DesignDBTest, checkpointTest)
+    {
+        initSimpleHierarchy();
+        IndexType devIdx = addNch(200);
+        _db.phyPropDB().nch(0).appendBulkCon(2);
+        _db.power.emplace_back("VDD");
+        auto &top = _db.subCkt(6);
+        top.setName("top");
+        top.node(0).setName("x0");
+        top.node(0).setOffset(10, -20);
+        top.node(0).setOrient(OriType::S);
+        IndexType netIdx = top.allocateNet();
+        top.net(netIdx).setName("out");
+        top.net(netIdx).markVddFlag();
+        top.net(netIdx).addIoPin(2, 3, 4, 5, 1);
+        for (IndexType pinIdx = 0; pinIdx < 3; ++pinIdx)
+        {
+            top.allocatePin();
+            top.pin(pinIdx).setNodeIdx(pinIdx % 2);
+            top.pin(pinIdx).setNetIdx(netIdx);
+            top.node(pinIdx % 2).appendPinIdx(pinIdx);
+            top.net(netIdx).appendPinIdx(2 - pinIdx);
+        }
+        top.pin(1).addLayoutRectIdx(7);
+        top.constraint().addSymPair(0, 1);
+        top.layout().insertRect(3, Box<LocType>(-5, 0, 10, 20));
+        top.layout().insertRect(3, Box<LocType>(0, 0, 4, 4));
+        top.layout().setRectDatatype(3, 1, 2);
+        top.layout().insertText(1, TextLayout("out", 1, 2));
+        _db.subCkt(devIdx).gdsData().setGdsFile("nch.gds");
+        _db.findRootCkt();
+        _db.compactConnectivity();
+        std::string fileName = UNITTEST_TOP_DIR + "/checkpointTest.mfdb";
+        ASSERT_TRUE(_db.saveCheckpoint(fileName));
+
+        DesignDB db;
+        ASSERT_TRUE(db.loadCheckpoint(fileName));
+        EXPECT_FALSE(db.loadCheckpoint(fileName)); // Only into an empty design
+        // A truncated file, or a count beyond the end of the file, fails the load and leaves the design empty
+        {
+            std::ifstream is(fileName, std::ios::binary);
+            const std::string bytes((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+            const std::string badName = fileName + ".bad";
+            for (const std::string &bad : {bytes.substr(0, bytes.size() / 2), bytes.substr(0, 20) + std::string("\xff\xff\xff\x7f", 4) + bytes.substr(24)})
+            {
+                {
+                    std::ofstream os(badName, std::ios::binary);
+                    os << bad;
+                }
+                DesignDB broken;
+                EXPECT_FALSE(broken.loadCheckpoint(badName));
+                EXPECT_EQ(broken.numCkts(), 0u);
+                EXPECT_EQ(broken.phyPropDB().numNch(), 0u);
+                EXPECT_TRUE(broken.power.empty());
+            }
+            std::remove(badName.c_str());
+        }
+        std::remove(fileName.c_str());
+        ASSERT_EQ(db.numCkts(), _db.numCkts());
+        EXPECT_EQ(db.rootCktIdx(), _db.rootCktIdx());
+        EXPECT_EQ(db.power, std::vector<std::string>({"VDD"}));
+        EXPECT_EQ(db.phyPropDB().nch(0).width(), 200);
+        EXPECT_EQ(db.phyPropDB().nch(0).bulkCon(0), static_cast<IndexType>(2));
+        EXPECT_EQ(db.subCkt(devIdx).implType(), ImplType::PCELL_Nch);
+        EXPECT_EQ(db.subCkt(devIdx).gdsData().gdsFile(), "nch.gds");
+        EXPECT_FALSE(db.subCkt(devIdx).hasLayout());
+        auto &restored = db.subCkt(6);
+        EXPECT_EQ(restored.name(), "top");
+        EXPECT_EQ(restored.node(0).name(), "x0");
+        EXPECT_EQ(restored.node(0).offset().y(), -20);
+        EXPECT_EQ(restored.node(0).orient(), OriType::S);
+        EXPECT_EQ(restored.node(1).subgraphIdx(), static_cast<IndexType>(4));
+        EXPECT_EQ(restored.node(0).pinIdxArray().toVector(), std::vector<IndexType>({0, 2}));
+        EXPECT_EQ(restored.net(netIdx).pinIdxArray().toVector(), std::vector<IndexType>({2, 1, 0}));
+        EXPECT_EQ(restored.net(netIdx).name(), "out");
+        EXPECT_TRUE(restored.net(netIdx).isVdd());
+        EXPECT_EQ(restored.net(netIdx).ioPinShape(0), Box<LocType>(2, 3, 4, 5));
+        EXPECT_EQ(restored.pin(1).layoutRectIdx(0), static_cast<IndexType>(7));
+        EXPECT_EQ(restored.constraint().symPair(0), std::make_pair(static_cast<IndexType>(0), static_cast<IndexType>(1)));
+        ASSERT_EQ(restored.layout().numRects(3), static_cast<IndexType>(2));
+        EXPECT_EQ(restored.layout().rect(3, 0).rect(), Box<LocType>(-5, 0, 10, 20));
+        EXPECT_EQ(restored.layout().rect(3, 1).datatype(), static_cast<IndexType>(2));
+        EXPECT_EQ(restored.layout().boundary(), top.layout().boundary());
+        ASSERT_EQ(restored.layout().numTexts(1), static_cast<IndexType>(1));
+        EXPECT_EQ(restored.layout().text(1, 0).text(), "out");
+    }
+
+    // Test the content digests and restoring the implementation of a subtree
+    TEST_F(DesignDBTest, reflowTest)
+    {
+        IndexType topIdx = initDiffPair();
+        auto &top = _db.subCkt(topIdx);
+        CktContentHash hashes(_db);
+        hashes.build(CktContentHash::stringHash("flow"));
+        const std::uint64_t topHash = hashes.hash(topIdx);
+        const std::uint64_t wideHash = hashes.hash(1);
+        EXPECT_NE(hashes.hash(0), hashes.hash(1)); // The two widths
+        EXPECT_EQ(16u, hashes.hashString(topIdx).size());
+        // The implementation does not change the digests
+        top.setIsImpl(true);
+        top.node(1).setOffset(30, 0);
+        top.node(1).setFlipVertFlag(true);
+        top.layout().insertRect(2, 0, 0, 40, 10);
+        _db.subCkt(0).layout().insertRect(1, 1, 1, 9, 9);
+        hashes.build(CktContentHash::stringHash("flow"));
+        EXPECT_EQ(topHash, hashes.hash(topIdx));
+        hashes.build(CktContentHash::stringHash("another flow"));
+        EXPECT_NE(topHash, hashes.hash(topIdx));
+        // The input files are digested by their contents
+        std::string fileName = UNITTEST_TOP_DIR + "/reflowTest.mfsub";
+        {
+            std::ofstream os(fileName);
+            os << "M0 d g s b nch w=1 \n";
+        }
+        const std::uint64_t fileHash = CktContentHash::fileHash(fileName);
+        EXPECT_NE(0u, fileHash);
+        EXPECT_EQ(fileHash, CktContentHash::fileHash(fileName));
+        {
+            std::ofstream os(fileName);
+            os << "M0 d g s b nch w=2 \n";
+        }
+        EXPECT_NE(fileHash, CktContentHash::fileHash(fileName));
+        EXPECT_EQ(0u, CktContentHash::fileHash(fileName + ".missing"));
+        ASSERT_TRUE(_db.saveSubtreeCheckpoint(topIdx, fileName));
+        EXPECT_EQ(std::vector<IndexType>({topIdx, 0, 1, 2}), DesignCheckpoint::subtree(_db, topIdx));
+        // Not the same circuits
+        EXPECT_FALSE(_db.loadSubtreeCheckpoint(2, fileName));
+        EXPECT_FALSE(_db.loadSubtreeCheckpoint(topIdx, fileName + ".missing"));
+        top.setIsImpl(false);
+        top.node(1).setOffset(0, 0);
+        top.node(1).setFlipVertFlag(false);
+        top.layout().clear();
+        _db.subCkt(0).layout().clear();
+        ASSERT_TRUE(_db.loadSubtreeCheckpoint(topIdx, fileName));
+        std::remove(fileName.c_str());
+        EXPECT_TRUE(top.isImpl());
+        EXPECT_EQ(XY<LocType>(30, 0), top.node(1).offset());
+        EXPECT_TRUE(top.node(1).flipVertFlag());
+        ASSERT_EQ(1u, top.layout().numRects(2));
+        EXPECT_EQ(Box<LocType>(0, 0, 40, 10), top.layout().rect(2, 0).rect());
+        ASSERT_EQ(1u, _db.subCkt(0).layout().numRects(1));
+        // A changed device changes the circuits instantiating it only
+        _db.phyPropDB().nch(_db.subCkt(0).implIdx()).setWidth(300);
+        hashes.build(CktContentHash::stringHash("flow"));
+        EXPECT_NE(topHash, hashes.hash(topIdx));
+        EXPECT_EQ(wideHash, hashes.hash(1));
+    }
+
+    // Test implementing a subtree in a design of its own and merging it back
+    TEST_F(DesignDBTest, subDesignTest)
+    {
+        IndexType unusedIdx = addNch(50);
+        IndexType topIdx = initDiffPair();
+        _db.power.emplace_back("VDD");
+        _db.subCkt(topIdx).setName("diff");
+        _db.compactConnectivity();
+        std::string fileName = UNITTEST_TOP_DIR + "/subDesignTest.mfdb";
+        ASSERT_TRUE(_db.saveSubDesignCheckpoint(topIdx, fileName));
+        DesignDB sub;
+        ASSERT_TRUE(sub.loadCheckpoint(fileName));
+        std::remove(fileName.c_str());
+        // The subtree alone, renumbered from its root, with the properties it uses
+        ASSERT_EQ(4u, sub.numCkts());
+        EXPECT_EQ(0u, sub.rootCktIdx());
+        EXPECT_EQ("diff", sub.subCkt(0).name());
+        EXPECT_EQ(std::vector<std::string>({"VDD"}), sub.power);
+        ASSERT_EQ(2u, sub.phyPropDB().numNch());
+        EXPECT_EQ(200, sub.phyPropDB().nch(sub.subCkt(1).implIdx()).width());
+        EXPECT_EQ(400, sub.phyPropDB().nch(sub.subCkt(2).implIdx()).width());
+        EXPECT_EQ(1u, sub.subCkt(0).node(0).subgraphIdx());
+        EXPECT_EQ(3u, sub.subCkt(0).node(3).subgraphIdx());
+        EXPECT_EQ(1u, sub.subCkt(0).node(4).subgraphIdx());
+        EXPECT_EQ(_db.subCkt(topIdx).net(6).pinIdxArray().toVector(), sub.subCkt(0).net(6).pinIdxArray().toVector());
+        // The implementation in the sub design is merged into the circuits of the full design
+        auto &subTop = sub.subCkt(0);
+        subTop.setIsImpl(true);
+        subTop.node(1).setOffset(30, 0);
+        subTop.layout().insertRect(2, 0, 0, 40, 10);
+        subTop.net(0).addIoPin(1, 2, 3, 4, 2);
+        std::string resultName = UNITTEST_TOP_DIR + "/subDesignTest.mfsub";
+        ASSERT_TRUE(sub.saveSubtreeCheckpoint(0, resultName));
+        EXPECT_FALSE(_db.loadSubtreeCheckpoint(unusedIdx, resultName));
+        ASSERT_TRUE(_db.loadSubtreeCheckpoint(topIdx, resultName));
+        std::remove(resultName.c_str());
+        const auto &top = _db.subCkt(topIdx);
+        EXPECT_TRUE(top.isImpl());
+        EXPECT_EQ(XY<LocType>(30, 0), top.node(1).offset());
+        ASSERT_EQ(1u, top.layout().numRects(2));
+        ASSERT_EQ(1u, top.net(0).numIoPins());
+        EXPECT_EQ(Box<LocType>(1, 2, 3, 4), top.net(0).ioPinShape(0));
+    }
+
+    // Test the equivalence classes of the device properties
+    TEST_F(DesignDBTest, propClassTest)
+    {
+        auto &props = _db.phyPropDB();
+        for (IntType width : {200, 400, 200, 200})
+        {
+            props.nch(props.allocateNch()).setWidth(width);
+        }
+        props.nch(3).setAttr("lvt");
+        auto classes = props.propClasses(ImplType::PCELL_Nch);
+        ASSERT_EQ(3u, classes->numClasses());
+        EXPECT_EQ(7u, classes->numParams());
+        EXPECT_EQ(std::vector<IndexType>({0, 1, 0, 2}), classes->classIdxArray());
+        EXPECT_EQ(std::vector<IndexType>({0, 2}), classes->members(0));
+        EXPECT_EQ(std::vector<IndexType>({0, 2, 3, 4}), classes->memberStartArray());
+        EXPECT_EQ(400, classes->paramArray()[classes->numParams()]);
+        EXPECT_EQ("lvt", classes->string(classes->paramArray()[2 * classes->numParams() + 4]));
+        EXPECT_EQ(0u, props.numPropClasses(ImplType::PCELL_Cap));
+        // A read does not rebuild the classes
+        const PhyPropDB &constProps = props;
+        EXPECT_EQ(200, constProps.nch(0).width());
+        EXPECT_EQ(classes, props.propClasses(ImplType::PCELL_Nch));
+        // A change of a property rebuilds the classes of its kind, and the classes held are unchanged
+        props.nch(1).setWidth(200);
+        EXPECT_EQ(2u, props.numPropClasses(ImplType::PCELL_Nch));
+        EXPECT_NE(classes, props.propClasses(ImplType::PCELL_Nch));
+        EXPECT_EQ(3u, classes->numClasses());
+        EXPECT_EQ(std::vector<IndexType>({0, 1, 0, 2}), classes->classIdxArray());
+        EXPECT_EQ(props.propClassIdx(ImplType::PCELL_Nch, 0), props.propClassIdx(ImplType::PCELL_Nch, 1));
+        props.nch(0).appendBulkCon(2);
+        EXPECT_EQ(3u, props.numPropClasses(ImplType::PCELL_Nch));
+        props.resister(props.allocateRes());
+        props.resister(props.allocateRes()).setSeries(true);
+        EXPECT_EQ(2u, props.numPropClasses(ImplType::PCELL_Res));
+    }
+
+    // Test resolving the pin shapes of the nets in the parent coordinates
+    TEST_F(DesignDBTest, netPinShapesTest)
+    {
+        IndexType topIdx = initPinShapes();
+        auto &top = _db.subCkt(topIdx);
+        auto shapes = _db.netPinShapes(topIdx);
+        ASSERT_EQ(shapes->numNets(), static_cast<IndexType>(2));
+        ASSERT_EQ(shapes->numShapes(0), static_cast<IndexType>(4));
+        ASSERT_EQ(shapes->numShapes(1), static_cast<IndexType>(1));
+        EXPECT_EQ(shapes->shape(0), Box<LocType>(1, 2, 3, 4));
+        EXPECT_EQ(shapes->layer(1), static_cast<IndexType>(2));
+        // Mirrored about the center of the boundary of the sub circuit, then moved
+        EXPECT_EQ(shapes->shape(2), Box<LocType>(107, 2, 109, 4));
+        EXPECT_EQ(shapes->shape(3), Box<LocType>(103, 6, 105, 8));
+        EXPECT_EQ(shapes->pinId(3), static_cast<IndexType>(1));
+        EXPECT_TRUE(shapes->isPowerStripe(3));
+        EXPECT_FALSE(shapes->isSubNetIo(3));
+        IndexType shapeIdx = shapes->shapeStart(1);
+        EXPECT_EQ(shapes->shape(shapeIdx), Box<LocType>(106, 2, 108, 4));
+        EXPECT_EQ(shapes->pinId(shapeIdx), static_cast<IndexType>(1));
+        EXPECT_TRUE(shapes->isSubNetIo(shapeIdx));
+        EXPECT_EQ(shapes->grPinCount(1), static_cast<IndexType>(2));
+        EXPECT_FALSE(shapes->hasPsub(1));
+
+        // Kept until the placement changes
+        EXPECT_EQ(_db.netPinShapes(topIdx), shapes);
+        top.node(0).setOffset(0, 50);
+        auto moved = _db.netPinShapes(topIdx);
+        EXPECT_NE(moved, shapes);
+        EXPECT_EQ(moved->shape(0), Box<LocType>(1, 52, 3, 54));
+        EXPECT_EQ(shapes->shape(0), Box<LocType>(1, 2, 3, 4));
+        _db.invalidateNetPinShapes(topIdx);
+        EXPECT_NE(_db.netPinShapes(topIdx), moved);
+    }
+    // Test the views of the nodes on their sub circuits against the flattened layouts
+    TEST_F(DesignDBTest, instanceViewTest)
+    {
+        IndexType topIdx = initPinShapes();
+        auto &top = _db.subCkt(topIdx);
+        IndexType subIdx = top.node(0).subgraphIdx();
+        auto &sub = _db.subCkt(subIdx);
+        sub.layout().insertRect(1, 2, 3, 6, 20);
+        sub.layout().insertRect(1, 0, 0, 10, 1);
+        sub.layout().insertText(1, "A", 1, 1);
+        top.node(0).setOrient(OriType::E);
+        auto views = _db.instanceViews(topIdx);
+        ASSERT_EQ(2u, views.size());
+        EXPECT_EQ(&sub, &views[1].child());
+        // The io shapes as the resolved pin shapes, and the sub circuit is untouched
+        auto shapes = _db.netPinShapes(topIdx);
+        EXPECT_EQ(shapes->shape(3), views[1].ioShape(0, 1));
+        EXPECT_EQ(shapes->shape(0), views[0].ioShape(0, 0));
+        EXPECT_EQ(Box<LocType>(1, 2, 3, 4), sub.net(0).ioPinShape(0));
+        // The rectangles and the texts as the materialized layout
+        for (const auto &view : views)
+        {
+            Layout flat = view.materialize();
+            ASSERT_EQ(2u, flat.numRects(1));
+            IndexType rectIdx = 0;
+            view.forEachRect(1, [&](const Box<LocType> &rect, IndexType) { EXPECT_EQ(flat.rect(1, rectIdx++).rect(), rect); });
+            EXPECT_EQ(flat.rect(1, 0).rect(), view.rect(1, 0));
+            view.forEachText(1, [&](const std::string &text, const XY<LocType> &coord) { EXPECT_EQ("A", text); EXPECT_EQ(flat.text(1, 0).coord(), coord); });
+            EXPECT_EQ(flat.boundary(), view.boundary());
+        }
+        top.layout().clear();
+        _db.insertSubLayouts(topIdx);
+        EXPECT_EQ(4u, top.layout().numRects(1));
+        EXPECT_EQ(views[1].rect(1, 0), top.layout().rect(1, 2).rect());
+        // A mirrored view matches CktGraph::flipVert, which it does not apply
+        InstanceView mirrored = InstanceView::mirrored(sub, 30);
+        Box<LocType> mirroredShape = mirrored.ioShape(0, 1);
+        sub.flipVert(30);
+        EXPECT_EQ(sub.net(0).ioPinShape(1), mirroredShape);
+        sub.flipVert(30);
+    }
+    // Test the wire lengths estimated from the pin shapes
+    TEST_F(DesignDBTest, netLengthTest)
+    {
+        IndexType topIdx = initPinShapes();
+        NetLengthEstimator estimator(_db.netPinShapes(topIdx));
+        estimator.setWeights({1.0, 0.5});
+        estimator.evaluate();
+        EXPECT_EQ(estimator.bbox(0), Box<LocType>(1, 2, 109, 8));
+        EXPECT_DOUBLE_EQ(estimator.length(0, NetLengthMetric::HPWL), 114.0);
+        EXPECT_DOUBLE_EQ(estimator.length(0, NetLengthMetric::MAX_EXTENT), 108.0);
+        // The centers (2, 3), (6, 7), (108, 3) and (104, 7) around (55, 5)
+        EXPECT_DOUBLE_EQ(estimator.length(0, NetLengthMetric::STAR), 212.0);
+        EXPECT_DOUBLE_EQ(estimator.length(1, NetLengthMetric::HPWL), 4.0);
+        EXPECT_DOUBLE_EQ(estimator.length(1, NetLengthMetric::STAR), 0.0);
+        EXPECT_DOUBLE_EQ(estimator.totalLength(NetLengthMetric::HPWL), 118.0);
+        EXPECT_DOUBLE_EQ(estimator.weightedLength(NetLengthMetric::HPWL), 116.0);
+
+        // The substrate pins of the devices other than capacitors have no shape, the substrate shape is added instead
+        _db.subCkt(topIdx).pin(3).setPinType(PinType::PSUB);
+        _db.invalidateNetPinShapes(topIdx);
+        NetLengthEstimator subEstimator(_db.netPinShapes(topIdx));
+        subEstimator.setSubShape(Box<LocType>(0, 0, 10, 10));
+        subEstimator.evaluate();
+        EXPECT_EQ(subEstimator.bbox(1), Box<LocType>(0, 0, 10, 10));
+        EXPECT_DOUBLE_EQ(subEstimator.length(1, NetLengthMetric::HPWL), 20.0);
+        EXPECT_DOUBLE_EQ(subEstimator.length(0, NetLengthMetric::HPWL), 114.0);
+    }
+    // Test pairing the nodes with the same structural signatures for the symmetry detection
+    TEST_F(DesignDBTest, symCandidatesTest)
+    {
+        IndexType topIdx = initDiffPair();
+        SymCandidates candidates(_db);
+        // The diode has a pin to pin edge the others do not have
+        candidates.find(topIdx, {"gnd"}, false);
+        EXPECT_EQ(candidates.pairArray(), std::vector<IndexType>({0, 1, 0, 2, 1, 2}));
+        EXPECT_NE(candidates.signature(0), candidates.signature(4));
+        candidates.find(topIdx, {"gnd"}, true);
+        EXPECT_EQ(candidates.pairArray(), std::vector<IndexType>({0, 1}));
+    }
+
+    // Test sharing the layout of a standard cell by its circuits
+    TEST_F(DesignDBTest, stdCellLibraryTest)
+    {
+        auto techDB = std::make_shared<TechDB>();
+        techDB->addNewLayer(31, "M1");
+        _db.setTechDB(techDB);
+        const std::string pinFile = UNITTEST_TOP_DIR + "./INV.route.gds.dumb";
+        const std::string gdsFile = UNITTEST_TOP_DIR + "./INV.route.gds";
+        {
+            std::ofstream os(pinFile);
+            os << "[0, 0, 100, 200]\n" << "A 1 0 90 10 110\n" << "Z 1 90 90 100 110\n";
+        }
+        {
+            std::ofstream os(gdsFile, std::ios::binary);
+            GdsStream gds(os);
+            gds.beginLib(5, "lib", 0.001, 1e-9);
+            gds.beginStruct("INV");
+            gds.writeBoundary(31, 0, Box<LocType>(0, 0, 100, 20));
+            gds.endStruct();
+            gds.endLib();
+        }
+        auto addInv = [&](const std::string &output)
+        {
+            IndexType cktIdx = _db.allocateCkt();
+            auto &ckt = _db.subCkt(cktIdx);
+            ckt.setName("INV");
+            ckt.net(ckt.allocateNet()).setName("A");
+            ckt.net(ckt.allocateNet()).setName(output);
+            return cktIdx;
+        };
+        IndexType first = addInv("Z");
+        IndexType second = addInv("Z");
+        IndexType wrong = addInv("ZN");
+        auto &library = _db.stdCellLibrary();
+        ASSERT_TRUE(library.setup(_db.subCkt(first), pinFile, gdsFile));
+        ASSERT_TRUE(library.setup(_db.subCkt(second), pinFile, gdsFile));
+        EXPECT_FALSE(library.setup(_db.subCkt(wrong), pinFile, gdsFile));
+        EXPECT_EQ(library.numCells(), static_cast<IndexType>(1));
+        EXPECT_EQ(library.numLoads(), static_cast<IndexType>(1));
+        EXPECT_EQ(library.numHits(), static_cast<IndexType>(2));
+        const CktGraph &firstCkt = _db.subCkt(first);
+        const CktGraph &secondCkt = _db.subCkt(second);
+        EXPECT_TRUE(secondCkt.isLayoutShared());
+        EXPECT_EQ(&firstCkt.layout(), &secondCkt.layout());
+        ASSERT_EQ(secondCkt.layout().numRects(0), static_cast<IndexType>(1));
+        EXPECT_EQ(secondCkt.layout().boundary(), Box<LocType>(0, 0, 100, 200));
+        EXPECT_EQ(secondCkt.gdsData().bbox(), Box<LocType>(0, 0, 100, 200));
+        EXPECT_EQ(secondCkt.net(1).ioPinShape(0), Box<LocType>(90, 90, 100, 110));
+        EXPECT_EQ(secondCkt.net(1).ioLayer(), static_cast<IndexType>(1));
+        EXPECT_FALSE(_db.subCkt(wrong).hasLayout());
+        // A library of several cells must have the cell
+        const std::string libFile = UNITTEST_TOP_DIR + "./stdCellLib.gds";
+        {
+            std::ofstream os(libFile, std::ios::binary);
+            GdsStream gds(os);
+            gds.beginLib(5, "lib", 0.001, 1e-9);
+            for (const char *cellName : {"BUF", "NAND"})
+            {
+                gds.beginStruct(cellName);
+                gds.writeBoundary(31, 0, Box<LocType>(0, 0, 100, 20));
+                gds.endStruct();
+            }
+            gds.endLib();
+        }
+        IndexType missing = addInv("Z");
+        _db.subCkt(missing).setName("NOR");
+        EXPECT_FALSE(library.setup(_db.subCkt(missing), pinFile, libFile));
+        EXPECT_FALSE(library.hasCell("NOR"));
+        // A copy shares the layout too, and a modification copies it
+        CktGraph copy(secondCkt);
+        EXPECT_TRUE(copy.isLayoutShared());
+        copy.layout().insertRect(0, Box<LocType>(0, 0, 1, 1));
+        EXPECT_FALSE(copy.isLayoutShared());
+        EXPECT_EQ(copy.layout().numRects(0), static_cast<IndexType>(2));
+        EXPECT_EQ(secondCkt.layout().numRects(0), static_cast<IndexType>(1));
+        EXPECT_TRUE(secondCkt.isLayoutShared());
+        library.clear();
+        EXPECT_EQ(firstCkt.layout().numRects(0), static_cast<IndexType>(1));
+        GdsMappedLibrary::closeAll();
+        std::remove(pinFile.c_str());
+        std::remove(gdsFile.c_str());
+        std::remove(libFile.c_str());
+    }
+
+    TEST_F(DesignDBTest, primarySymTest)
+    {
+        IndexType topIdx = initDiffPair();
+        PrimarySym primarySym(_db);
+        ASSERT_TRUE(primarySym.isPrimary(topIdx));
+        primarySym.generate(topIdx, {"gnd"});
+        EXPECT_EQ(primarySym.deviceSizes(0), std::vector<IntType>({200, 100, 1}));
+        // The differential pair, its tail and the load between the outputs. The diode has no mate
+        EXPECT_EQ(primarySym.symPairArray(), std::vector<IndexType>({0, 1}));
+        EXPECT_EQ(primarySym.selfSymArray(), std::vector<IndexType>({2, 3}));
+        EXPECT_EQ(primarySym.symNetPairArray(), std::vector<IndexType>({0, 1, 2, 3}));
+        EXPECT_EQ(primarySym.selfSymNetArray(), std::vector<IndexType>({4}));
+        auto &constraint = _db.subCkt(topIdx).constraint();
+        constraint.addSymPair(3, 4);
+        primarySym.apply(constraint);
+        EXPECT_TRUE(constraint.isSymGenerated());
+        ASSERT_EQ(constraint.numSymPairs(), 1);
+        EXPECT_EQ(constraint.symPair(0), std::make_pair(IndexType(0), IndexType(1)));
+        EXPECT_EQ(constraint.numSelfSyms(), 2);
+        EXPECT_EQ(constraint.numSymNetPairs(), 2);
+        EXPECT_EQ(constraint.numSelfSymNets(), 1);
+        // A sub circuit is not a device
+        IndexType hierIdx = _db.allocateCkt();
+        IndexType nodeIdx = _db.subCkt(hierIdx).allocateNode();
+        _db.subCkt(hierIdx).node(nodeIdx).setSubgraphIdx(topIdx);
+        EXPECT_FALSE(primarySym.isPrimary(hierIdx));
+    }
+
+    TEST_F(DesignDBTest, spectralSimTest)
+    {
+        // The Laplacian spectra of a path, which is tridiagonal, and of a star
+        std::vector<RealType> path = {1, -1, 0, -1, 2, -1, 0, -1, 1};
+        auto pathSpectrum = SpectralSim::symmetricEigenvalues(path, 3);
+        ASSERT_EQ(pathSpectrum.size(), 3);
+        EXPECT_NEAR(pathSpectrum[0], 0.0, 1e-12);
+        EXPECT_NEAR(pathSpectrum[1], 1.0, 1e-12);
+        EXPECT_NEAR(pathSpectrum[2], 3.0, 1e-12);
+        std::vector<RealType> star = {3, -1, -1, -1, -1, 1, 0, 0, -1, 0, 1, 0, -1, 0, 0, 1};
+        auto starSpectrum = SpectralSim::symmetricEigenvalues(star, 4);
+        ASSERT_EQ(starSpectrum.size(), 4);
+        EXPECT_NEAR(starSpectrum[0], 0.0, 1e-12);
+        EXPECT_NEAR(starSpectrum[1], 1.0, 1e-12);
+        EXPECT_NEAR(starSpectrum[2], 1.0, 1e-12);
+        EXPECT_NEAR(starSpectrum[3], 4.0, 1e-12);
+        // The exact p-values of scipy.stats.ks_2samp
+        EXPECT_DOUBLE_EQ(SpectralSim::ksPValue({1, 2, 3}, {1, 2, 3}), 1.0);
+        EXPECT_NEAR(SpectralSim::ksPValue({1, 2, 3}, {4, 5, 6}), 0.1, 1e-12);
+        EXPECT_NEAR(SpectralSim::ksPValue({1, 2}, {3, 4, 5}), 0.2, 1e-12);
+        EXPECT_DOUBLE_EQ(SpectralSim::ksPValue({}, {1}), 0.0);
+
+        IndexType topIdx = initDiffPair();
+        SpectralSim sim(_db);
+        sim.build(topIdx, {"gnd"});
+        const auto &graph = sim.graph();
+        EXPECT_EQ(graph.numVertices(), 19);
+        EXPECT_EQ(graph.numNodeVertices(3), 3);
+        // The drain and the gate of the diode are on a same net
+        EXPECT_EQ(graph.neighbors(graph.nodeBegin(4) + 1).size(), 2);
+        // The halves of the differential pair are mirrored
+        EXPECT_EQ(sim.center(0, SimCenterType::PAGERANK), std::make_pair(graph.nodeBegin(0) + 1, IndexType(2)));
+        EXPECT_DOUBLE_EQ(sim.score(0, 1), 1.0);
+        IndexType numSpectra = sim.numCachedSpectra();
+        EXPECT_EQ(sim.scores({0, 1, 1, 0}), std::vector<RealType>({1.0, 1.0}));
+        EXPECT_EQ(sim.numCachedSpectra(), numSpectra);
+        RealType score = sim.score(0, 4, SimCenterType::JORDAN);
+        EXPECT_GE(score, 0.0);
+        EXPECT_LE(score, 1.0);
+    }
+
+    TEST(SpectralSimExampleTest, comparator)
+    {
+        // The scores GraphSim.specSimScore gives on the graph of S3DET.constructGraph for the comparator example, with the ignore_set of S3DET.
+        // The nets are in upper case there, so GND and VDD are not ignored
+        DesignDB db;
+        ASSERT_TRUE(PARSE::parseNetlist(UNITTEST_TOP_DIR + "/../../../../../examples/comp/comp.sp", db, false));
+        const auto &ckt = db.subCkt(0);
+        ASSERT_EQ(ckt.numNodes(), 17);
+        std::vector<std::string> ignoredNets = {"gnd", "vss", "vss_sub", "vrefn", "vrefnd", "avss", "dvss", "vss_d",
+            "vdd", "vdd_and", "vdd_c", "vdd_comp", "vdd_gm", "vddd", "vdda", "veld", "avdd", "vrefp", "vrefnp", "avdd_sar", "vdd_ac", "dvdd", "vdd_int", "vddac", "vdd_d"};
+        SpectralSim sim(db);
+        sim.build(0, ignoredNets);
+        EXPECT_EQ(sim.graph().numVertices(), 68);
+        auto nodeIdx = [&](const std::string &name)
+        {
+            for (IndexType idx = 0; idx < ckt.numNodes(); ++idx)
+            {
+                const std::string &nodeName = ckt.node(idx).name();
+                if (nodeName.size() > name.size() && nodeName.compare(nodeName.size() - name.size() - 1, std::string::npos, "_" + name) == 0)
+                {
+                    return idx;
+                }
+            }
+            return INDEX_TYPE_MAX;
+        };
+        const std::vector<std::tuple<std::string, std::string, RealType>> references = {
+            {"M5", "M6", 1.0}, {"M3", "M4", 1.0}, {"M16", "M17", 1.0}, {"M8", "M15", 1.0}, {"M13", "M14", 1.0}, {"M18", "M19", 1.0},
+            {"M10", "M12", 1.0}, {"M0", "M22", 1.0},
+            {"M7", "M5", 0.004563727412231046}, {"M5", "M3", 0.09059232874191592}, {"M16", "M8", 0.6901844796763248}, {"M18", "M10", 0.9998819701222671}};
+        for (const auto &reference : references)
+        {
+            IndexType nodeIdxA = nodeIdx(std::get<0>(reference));
+            IndexType nodeIdxB = nodeIdx(std::get<1>(reference));
+            ASSERT_NE(nodeIdxA, INDEX_TYPE_MAX) << std::get<0>(reference);
+            ASSERT_NE(nodeIdxB, INDEX_TYPE_MAX) << std::get<1>(reference);
+            EXPECT_NEAR(sim.score(nodeIdxA, nodeIdxB), std::get<2>(reference), 1e-12) << std::get<0>(reference) << " " << std::get<1>(reference);
+        }
+        // The center of M0 is its gate, as its drain and source are both on GND. The center of M5 is its drain
+        EXPECT_EQ(sim.center(nodeIdx("M0"), SimCenterType::PAGERANK), std::make_pair(sim.graph().nodeBegin(nodeIdx("M0")) + 2, IndexType(2)));
+        EXPECT_EQ(sim.center(nodeIdx("M5"), SimCenterType::PAGERANK), std::make_pair(sim.graph().nodeBegin(nodeIdx("M5")) + 1, IndexType(2)));
+    }
+
+    TEST(SyntheticDesignTest, generate)
+    {
+        auto techDB = std::make_shared<TechDB>();
+        techDB->addNewLayer(6, "OD");
+        techDB->addNewLayer(17, "PO");
+        techDB->addNewLayer(31, "M1");
+        DesignDB db;
+        db.setTechDB(techDB);
+        SyntheticSpec spec;
+        spec.depth = 2;
+        spec.fanOut = 3;
+        spec.devicesPerLeaf = 10;
+        spec.rectsPerDevice = 5;
+        spec.seed = 7;
+        SyntheticDesign generator(db);
+        IndexType topIdx = generator.generate(spec);
+        // 1 + 3 + 9 sub circuits, and 10 devices in each of the 9 leaves
+        EXPECT_EQ(generator.numGeneratedCkts(), 103);
+        EXPECT_EQ(generator.numDeviceInstances(), 90u);
+        EXPECT_EQ(db.numCkts(), 103);
+        ASSERT_TRUE(db.findRootCkt());
+        EXPECT_EQ(db.rootCktIdx(), topIdx);
+        EXPECT_EQ(db.subCkt(topIdx).name(), "SYN_TOP");
+        IndexType numDevices = 0;
+        for (IndexType cktIdx = 0; cktIdx < db.numCkts(); ++cktIdx)
+        {
+            const auto &ckt = db.subCkt(cktIdx);
+            if (MfUtil::isImplTypeDevice(ckt.implType()))
+            {
+                ++numDevices;
+                EXPECT_TRUE(ckt.isImpl());
+                EXPECT_EQ(ckt.layout().numRects(0) + ckt.layout().numRects(1) + ckt.layout().numRects(2), 5);
+                EXPECT_EQ(ckt.numPsubs() + ckt.numNwells(), 1);
+                continue;
+            }
+            EXPECT_TRUE(ckt.net(0).isVdd());
+            EXPECT_TRUE(ckt.net(1).isVss());
+            for (const auto &pin : ckt.pinArray())
+            {
+                EXPECT_LT(pin.netIdx(), ckt.numNets());
+                EXPECT_NE(pin.intNetIdx(), INDEX_TYPE_MAX);
+            }
+            for (IndexType netIdx = 2 + spec.numSignalIos; netIdx < ckt.numNets(); ++netIdx)
+            {
+                EXPECT_GE(ckt.net(netIdx).numPins(), 2);
+                EXPECT_LE(ckt.net(netIdx).numPins(), spec.maxNetDegree + 1);
+            }
+        }
+        EXPECT_EQ(numDevices, 90);
+
+        // The same seed gives the same design, and the masters are shared when limited
+        DesignDB again;
+        again.setTechDB(techDB);
+        SyntheticDesign(again).generate(spec);
+        ASSERT_EQ(again.numCkts(), db.numCkts());
+        for (IndexType cktIdx = 0; cktIdx < db.numCkts(); ++cktIdx)
+        {
+            EXPECT_EQ(again.subCkt(cktIdx).numNets(), db.subCkt(cktIdx).numNets());
+            EXPECT_EQ(again.subCkt(cktIdx).implType(), db.subCkt(cktIdx).implType());
+        }
+        DesignDB shared;
+        spec.numMasters = 2;
+        SyntheticDesign sharedGenerator(shared);
+        sharedGenerator.generate(spec);
+        EXPECT_EQ(sharedGenerator.numGeneratedCkts(), 1 + 2 + 2 + 2 * 10);
+        EXPECT_EQ(sharedGenerator.numDeviceInstances(), 90u);
+        EXPECT_TRUE(shared.findRootCkt());
+        // Without a technology database, the devices get no layout
+        EXPECT_TRUE(MfUtil::isImplTypeDevice(shared.subCkt(1).implType()));
+        EXPECT_FALSE(shared.subCkt(1).isImpl());
+    }
 } // End of the unittest namespace
 
 PROJECT_NAMESPACE_END
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "global/global.h"
+#include "db/DrcScreen.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace unittest
+{
+    /// @brief test the rule screening on one metal layer, min width 50, min spacing 50 by a parallel run length table and min area 10000
+    class DrcScreenTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                _techDB.addNewLayer(21, "M1");
+                _techDB.addNewLayer(22, "M2");
+                LayerRule rule;
+                rule.setMinWidth(50);
+                rule.setMinArea(10000);
+                rule.setSpacingTable({0, 100}, {0, 200}, {50, 60, 50, 80});
+                _techDB.setLayerRule(0, rule);
+                _layout.init(_techDB.numLayers());
+                _layout.insertRect(0, 0, 0, 30, 400); // 0: narrow
+                _layout.insertRect(0, 200, 0, 230, 400); // 1, 2: fragments of one wide shape
+                _layout.insertRect(0, 230, 0, 300, 400);
+                _layout.insertRect(0, 500, 0, 600, 200); // 3, 4: 40 apart, short parallel run
+                _layout.insertRect(0, 640, 0, 740, 200);
+                _layout.insertRect(0, 1000, 0, 1150, 300); // 5, 6: 70 apart, wide and long parallel run
+                _layout.insertRect(0, 1220, 0, 1400, 300);
+                _layout.insertRect(0, 2000, 0, 2060, 100); // 7: small
+                _layout.insertRect(0, 2500, 0, 2600, 60); // 8, 9: small L shape
+                _layout.insertRect(0, 2540, 0, 2600, 100);
+                _layout.insertRect(0, 4000, 0, 4100, 100); // 10, 11: 42 apart diagonally
+                _layout.insertRect(0, 4130, 130, 4230, 230);
+                _layout.insertRect(1, 0, 0, 1, 1); // No rule on M2
+            }
+            /// @brief expect the violations of two screens to be the same
+            static void expectSame(const DrcScreen &lhs, const DrcScreen &rhs)
+            {
+                EXPECT_EQ(lhs.typeArray(), rhs.typeArray());
+                EXPECT_EQ(lhs.layerArray(), rhs.layerArray());
+                EXPECT_EQ(lhs.rectArray(), rhs.rectArray());
+                EXPECT_EQ(lhs.otherRectArray(), rhs.otherRectArray());
+                EXPECT_EQ(lhs.measuredArray(), rhs.measuredArray());
+                EXPECT_EQ(lhs.requiredArray(), rhs.requiredArray());
+            }
+            TechDB _techDB;
+            Layout _layout;
+    };
+
+    TEST_F (DrcScreenTest, Check)
+    {
+        DrcScreen screen(_techDB);
+        ASSERT_EQ(screen.check(_layout), 6u);
+        EXPECT_EQ(screen.numViolations(DrcViolationType::MIN_WIDTH), 1u);
+        EXPECT_EQ(screen.numViolations(DrcViolationType::MIN_SPACING), 3u);
+        EXPECT_EQ(screen.numViolations(DrcViolationType::MIN_AREA), 2u);
+        EXPECT_EQ(std::vector<IndexType>(6, 0), screen.layerArray());
+        // Sorted by type, then by rectangles
+        EXPECT_EQ(screen.type(0), DrcViolationType::MIN_WIDTH);
+        EXPECT_EQ(screen.rect(0), 0u);
+        EXPECT_EQ(screen.otherRect(0), INDEX_TYPE_MAX);
+        EXPECT_EQ(screen.measured(0), 30);
+        EXPECT_EQ(screen.required(0), 50);
+        EXPECT_EQ(std::vector<IndexType>({3, 5, 10}), std::vector<IndexType>(screen.rectArray().begin() + 1, screen.rectArray().begin() + 4));
+        EXPECT_EQ(std::vector<IndexType>({4, 6, 11}), std::vector<IndexType>(screen.otherRectArray().begin() + 1, screen.otherRectArray().begin() + 4));
+        EXPECT_EQ(std::vector<std::int64_t>({40, 70, 42}), std::vector<std::int64_t>(screen.measuredArray().begin() + 1, screen.measuredArray().begin() + 4));
+        EXPECT_EQ(std::vector<std::int64_t>({50, 80, 50}), std::vector<std::int64_t>(screen.requiredArray().begin() + 1, screen.requiredArray().begin() + 4));
+        EXPECT_EQ(screen.rect(4), 7u);
+        EXPECT_EQ(screen.measured(4), 6000);
+        EXPECT_EQ(screen.rect(5), 8u);
+        EXPECT_EQ(screen.measured(5), 8400);
+        EXPECT_EQ(screen.required(5), 10000);
+    }
+
+    TEST_F (DrcScreenTest, Recheck)
+    {
+        DrcScreen screen(_techDB);
+        screen.check(_layout);
+        // Move rect 4 away from rect 3
+        _layout.layer(0).setRect(4, Box<LocType>(700, 0, 800, 200));
+        EXPECT_EQ(screen.recheck(_layout, 0, {4}), 5u);
+        DrcScreen full(_techDB);
+        full.check(_layout);
+        expectSame(screen, full);
+        // Split the L shape into two small shapes
+        _layout.layer(0).setRect(9, Box<LocType>(2800, 0, 2860, 200));
+        EXPECT_EQ(screen.recheck(_layout, 0, {9}), 5u);
+        full.check(_layout);
+        expectSame(screen, full);
+        EXPECT_EQ(screen.rect(4), 8u);
+        EXPECT_EQ(screen.measured(4), 6000);
+        // Append a rectangle growing the small shape 7 and moving close to shape 0
+        _layout.insertRect(0, 2060, 0, 2200, 100);
+        _layout.layer(0).setRect(1, Box<LocType>(60, 0, 230, 400));
+        EXPECT_EQ(screen.recheck(_layout, std::vector<std::vector<IndexType>>({{1}})), 5u);
+        full.check(_layout);
+        expectSame(screen, full);
+        EXPECT_EQ(screen.type(1), DrcViolationType::MIN_SPACING);
+        EXPECT_EQ(screen.rect(1), 0u);
+        EXPECT_EQ(screen.otherRect(1), 1u);
+        // Losing rectangles checks the whole layer
+        _layout.layer(0).mergeRects();
+        screen.recheck(_layout, 0, {});
+        full.check(_layout);
+        expectSame(screen, full);
+    }
+}
+
+PROJECT_NAMESPACE_END
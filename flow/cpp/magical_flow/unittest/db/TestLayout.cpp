@@ -0,0 +1,398 @@
+#include <gtest/gtest.h>
+#include "global/global.h"
+#include "db/Layout.h"
+#include "db/GraphComponents.h"
+#include "db/ShapeBuffer.h"
+#include "util/Polygon2Rect.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace unittest
+{
+    class LayoutQueryTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                // A 10x10 array of 10x10 squares with a pitch of 20
+                for (LocType y = 0; y < 10; ++y)
+                {
+                    for (LocType x = 0; x < 10; ++x)
+                    {
+                        _layout.insertRect(1, x * 20, y * 20, x * 20 + 10, y * 20 + 10);
+                    }
+                }
+            }
+            Layout _layout;
+    };
+
+    TEST_F (LayoutQueryTest, Overlap)
+    {
+        // Shares area with rect 0 only. Touches rect 1 and rect 10
+        auto result = _layout.queryOverlap(1, Box<LocType>(5, 5, 20, 20));
+        EXPECT_EQ(std::vector<IndexType>({0}), result);
+        result = _layout.queryOverlap(1, Box<LocType>(5, 5, 20, 20), true);
+        EXPECT_EQ(std::vector<IndexType>({0, 1, 10, 11}), result);
+        EXPECT_TRUE(_layout.queryOverlap(0, Box<LocType>(5, 5, 20, 20)).empty());
+    }
+
+    TEST_F (LayoutQueryTest, Window)
+    {
+        auto result = _layout.queryWindow(1, Box<LocType>(0, 0, 35, 15));
+        EXPECT_EQ(std::vector<IndexType>({0, 1}), result);
+    }
+
+    TEST_F (LayoutQueryTest, Nearest)
+    {
+        auto result = _layout.queryNearest(1, XY<LocType>(1000, 1000), 1);
+        EXPECT_EQ(std::vector<IndexType>({99}), result);
+        result = _layout.queryNearest(1, XY<LocType>(41, 5), 2);
+        EXPECT_EQ(std::vector<IndexType>({2, 1}), result);
+    }
+
+    TEST_F (LayoutQueryTest, InvalidateOnInsert)
+    {
+        EXPECT_TRUE(_layout.queryOverlap(1, Box<LocType>(500, 500, 600, 600)).empty());
+        IndexType rectIdx = _layout.insertRect(1, 510, 510, 520, 520);
+        EXPECT_EQ(std::vector<IndexType>({rectIdx}), _layout.queryOverlap(1, Box<LocType>(500, 500, 600, 600)));
+    }
+
+    TEST (RectKernelTest, TransformAndBoundingBox)
+    {
+        // Longer than the vector width to cover both the vector body and the scalar tail
+        const IndexType num = 21;
+        std::vector<LocType> xLo(num), yLo(num), xHi(num), yHi(num);
+        for (IndexType idx = 0; idx < num; ++idx)
+        {
+            LocType v = static_cast<LocType>(idx);
+            xLo[idx] = v; yLo[idx] = -v; xHi[idx] = v + 5; yHi[idx] = 2 * v;
+        }
+        RectKernel::mirror(xLo.data(), xHi.data(), num, 100);
+        RectKernel::translate(xLo.data(), yLo.data(), xHi.data(), yHi.data(), num, 3, -4);
+        for (IndexType idx = 0; idx < num; ++idx)
+        {
+            LocType v = static_cast<LocType>(idx);
+            EXPECT_EQ(100 - (v + 5) + 3, xLo[idx]);
+            EXPECT_EQ(100 - v + 3, xHi[idx]);
+            EXPECT_EQ(-v - 4, yLo[idx]);
+            EXPECT_EQ(2 * v - 4, yHi[idx]);
+        }
+        auto bbox = RectKernel::boundingBox(xLo.data(), yLo.data(), xHi.data(), yHi.data(), num);
+        EXPECT_EQ(Box<LocType>(78, -24, 103, 36), bbox);
+        auto empty = RectKernel::boundingBox(xLo.data(), yLo.data(), xHi.data(), yHi.data(), 0);
+        EXPECT_FALSE(empty.valid());
+    }
+
+    TEST (RectKernelTest, BatchedBoxTests)
+    {
+        // A grid of boxes around the query box, including the touching, degenerate and corner ones
+        std::vector<LocType> xLo, yLo, xHi, yHi;
+        for (LocType y = -6; y <= 26; y += 4)
+        {
+            for (LocType x = -6; x <= 26; x += 3)
+            {
+                xLo.emplace_back(x); yLo.emplace_back(y);
+                xHi.emplace_back(x + (x & 3) * 2); yHi.emplace_back(y + 5);
+            }
+        }
+        const IndexType num = xLo.size();
+        const Box<LocType> box(0, 0, 20, 20);
+        std::vector<IndexType> candidates;
+        for (IndexType idx = num; idx-- > 0;)
+        {
+            candidates.emplace_back(idx);
+        }
+        std::vector<unsigned char> mask(num);
+        std::vector<IndexType> selected(num);
+        for (bool touch : {false, true})
+        {
+            RectKernel::overlapMask(xLo.data(), yLo.data(), xHi.data(), yHi.data(), num, box, touch, mask.data());
+            IndexType numSelected = RectKernel::filterOverlap(xLo.data(), yLo.data(), xHi.data(), yHi.data(), candidates.data(), num, box, touch, selected.data());
+            std::vector<IndexType> expected;
+            for (IndexType idx : candidates)
+            {
+                const Box<LocType> rect(xLo[idx], yLo[idx], xHi[idx], yHi[idx]);
+                bool hit = touch ? rect.intersect(box) : rect.overlap(box);
+                EXPECT_EQ(hit, mask[idx] != 0);
+                if (hit)
+                {
+                    expected.emplace_back(idx);
+                }
+            }
+            EXPECT_EQ(expected, std::vector<IndexType>(selected.begin(), selected.begin() + numSelected));
+        }
+        std::vector<LocType> spacings(num), widths(num), runs(num);
+        RectKernel::spacing(xLo.data(), yLo.data(), xHi.data(), yHi.data(), candidates.data(), num, box, spacings.data(), widths.data(), runs.data());
+        for (IndexType idx = 0; idx < num; ++idx)
+        {
+            const IndexType rectIdx = candidates[idx];
+            const Box<LocType> rect(xLo[rectIdx], yLo[rectIdx], xHi[rectIdx], yHi[rectIdx]);
+            const auto width = klib::boxWidth(box, rect);
+            EXPECT_EQ(klib::boxSpacing(box, rect), spacings[idx]);
+            EXPECT_EQ(std::max(width.first, width.second), widths[idx]);
+            EXPECT_EQ(klib::boxParallelRun(box, rect), runs[idx]);
+        }
+    }
+
+    TEST_F (LayoutQueryTest, InsertLayout)
+    {
+        Layout top;
+        top.insertRect(1, 0, 0, 1, 1);
+        _layout.setRectDatatype(1, 3, 7);
+        top.insertLayout(_layout, 1000, 50, true);
+        EXPECT_EQ(101u, top.numRects(1));
+        // Rect 3 of the sub layout is (60, 0, 70, 10), mirrored about x = 95 inside the sub layout boundary (0, 0, 190, 190)
+        EXPECT_EQ(Box<LocType>(190 - 70 + 1000, 50, 190 - 60 + 1000, 60), top.rect(1, 4).rect());
+        EXPECT_EQ(7u, top.rect(1, 4).datatype());
+        EXPECT_EQ(Box<LocType>(0, 0, 1190, 240), top.boundary());
+        ASSERT_EQ(1u, top.layer(1).flattenedRectRanges().size());
+        EXPECT_EQ(1u, top.layer(1).flattenedRectRanges().front().first);
+        EXPECT_EQ(101u, top.layer(1).flattenedRectRanges().front().second);
+        // The inserted rectangles are visible to the spatial queries
+        EXPECT_EQ(std::vector<IndexType>({4}), top.queryOverlap(1, Box<LocType>(1121, 51, 1129, 59)));
+    }
+
+    TEST (LayoutInsertTest, Orientations)
+    {
+        Layout sub;
+        sub.insertRect(2, 10, 20, 40, 30);
+        sub.insertRect(2, 0, 0, 5, 70);
+        sub.insertRect(3, 50, 60, 100, 100);
+        sub.insertText(3, "A", 12, 34);
+        const OriType orients[] = {OriType::N, OriType::S, OriType::W, OriType::E, OriType::FN, OriType::FS, OriType::FW, OriType::FE};
+        for (OriType orient : orients)
+        {
+            for (bool flip : {false, true})
+            {
+                Layout top;
+                XY<LocType> offset(1000, -500);
+                top.insertLayout(sub, offset, orient, flip);
+                LayoutPlacement placement(&sub, offset, orient, flip);
+                for (IndexType layerIdx : {2u, 3u})
+                {
+                    ASSERT_EQ(sub.numRects(layerIdx), top.numRects(layerIdx));
+                    for (IndexType rectIdx = 0; rectIdx < sub.numRects(layerIdx); ++rectIdx)
+                    {
+                        // The same as transforming the two corners one by one
+                        const auto rect = sub.layer(layerIdx).box(rectIdx);
+                        CktNode node;
+                        node.offset() = offset;
+                        node.setOrient(orient);
+                        node.setFlipVertFlag(flip);
+                        Box<LocType> expected(node.toParentCoord(rect.ll(), sub.boundary()));
+                        expected.join(node.toParentCoord(rect.ur(), sub.boundary()));
+                        EXPECT_EQ(expected, top.rect(layerIdx, rectIdx).rect());
+                    }
+                }
+                ASSERT_EQ(1u, top.numTexts(3));
+                CktNode node;
+                node.offset() = offset;
+                node.setOrient(orient);
+                node.setFlipVertFlag(flip);
+                EXPECT_EQ(node.toParentCoord(XY<LocType>(12, 34), sub.boundary()), top.text(3, 0).coord());
+                EXPECT_EQ(1u, top.layer(3).flattenedTextRanges().size());
+            }
+        }
+    }
+
+    TEST (LayoutInsertTest, Batch)
+    {
+        Layout sub;
+        sub.insertRect(2, 0, 0, 10, 10);
+        sub.insertText(2, "A", 5, 5);
+        std::vector<LayoutPlacement> placements;
+        for (LocType idx = 0; idx < 5000; ++idx)
+        {
+            placements.emplace_back(&sub, XY<LocType>(idx * 20, 0), OriType::N, false);
+        }
+        Layout top;
+        top.insertLayouts(placements, false);
+        ASSERT_EQ(5000u, top.numRects(2));
+        EXPECT_EQ(0u, top.numTexts(2));
+        EXPECT_EQ(Box<LocType>(40, 0, 50, 10), top.rect(2, 2).rect());
+        EXPECT_EQ(Box<LocType>(0, 0, 4999 * 20 + 10, 10), top.boundary());
+    }
+
+    TEST (LayoutMergeTest, Rects)
+    {
+        // Abutting fingers flattened from sub layouts merge into one, the other datatype stays apart
+        Layout sub;
+        sub.insertRect(2, 0, 0, 10, 40);
+        std::vector<LayoutPlacement> placements;
+        for (LocType idx = 0; idx < 100; ++idx)
+        {
+            placements.emplace_back(&sub, XY<LocType>(idx * 10, 0), OriType::N, false);
+        }
+        Layout top;
+        top.insertLayouts(placements, false);
+        top.insertRect(2, 500, 30, 520, 60);
+        top.insertRect(2, 0, 0, 10, 10);
+        top.setRectDatatype(2, 101, 5);
+        top.insertRect(3, 0, 0, 0, 10);
+        const Box<LocType> boundary = top.boundary();
+        EXPECT_EQ(99u, top.mergeRects());
+        ASSERT_EQ(3u, top.numRects(2));
+        EXPECT_EQ(Box<LocType>(0, 0, 1000, 40), top.rect(2, 0).rect());
+        EXPECT_EQ(Box<LocType>(500, 40, 520, 60), top.rect(2, 1).rect());
+        EXPECT_EQ(5u, top.rect(2, 2).datatype());
+        EXPECT_TRUE(top.layer(2).flattenedRectRanges().empty());
+        // The empty rectangle is kept
+        EXPECT_EQ(1u, top.numRects(3));
+        EXPECT_EQ(boundary, top.boundary());
+        EXPECT_EQ(std::vector<IndexType>({1}), top.queryOverlap(2, Box<LocType>(505, 45, 506, 46)));
+
+        // Random overlapping rectangles: the merged ones are disjoint and cover the same cells
+        std::vector<Box<LocType>> rects;
+        std::uint32_t seed = 7;
+        auto draw = [&](LocType n) { seed = seed * 1103515245u + 12345u; return static_cast<LocType>((seed >> 8) % n); };
+        for (IndexType idx = 0; idx < 200; ++idx)
+        {
+            LocType x = draw(60), y = draw(60);
+            rects.emplace_back(x, y, x + 1 + draw(10), y + 1 + draw(10));
+        }
+        std::vector<Box<LocType>> merged = rects;
+        klib::boxUnionRectangles(merged);
+        EXPECT_LT(merged.size(), rects.size());
+        for (LocType y = 0; y < 70; ++y)
+        {
+            for (LocType x = 0; x < 70; ++x)
+            {
+                auto covers = [&](const Box<LocType> &rect) { return rect.xLo() <= x && x < rect.xHi() && rect.yLo() <= y && y < rect.yHi(); };
+                bool inRects = std::any_of(rects.begin(), rects.end(), covers);
+                EXPECT_EQ(inRects ? 1 : 0, std::count_if(merged.begin(), merged.end(), covers));
+            }
+        }
+    }
+
+    TEST (LayoutPolygonTest, Slicing)
+    {
+        // An L shape with a repeated closing point and a collinear vertex
+        std::vector<XY<LocType>> pts({XY<LocType>(0, 0), XY<LocType>(10, 0), XY<LocType>(20, 0), XY<LocType>(20, 10), XY<LocType>(10, 10),
+                XY<LocType>(10, 30), XY<LocType>(0, 30), XY<LocType>(0, 0)});
+        ASSERT_TRUE(::klib::simplifyRectilinear(pts));
+        ASSERT_EQ(6u, pts.size());
+        std::vector<XY<LocType>> diagonal({XY<LocType>(0, 0), XY<LocType>(10, 0), XY<LocType>(0, 10)});
+        EXPECT_FALSE(::klib::simplifyRectilinear(diagonal));
+
+        Layout sub;
+        sub.insertRect(2, 30, 0, 40, 10);
+        EXPECT_EQ(0u, sub.insertPolygon(2, pts.begin(), pts.end(), 3));
+        EXPECT_EQ(Box<LocType>(0, 0, 40, 30), sub.boundary());
+        const LayoutLayer &layer = sub.layer(2);
+        EXPECT_EQ(1u, layer.numPolygons());
+        EXPECT_EQ(3u, layer.polygonDatatype(0));
+        EXPECT_EQ(pts, layer.polygon(0));
+        // Sliced when inserted, so that reading the layer does not change it
+        const IndexType numRects = layer.numStoredRects();
+        ASSERT_GT(numRects, 1u);
+        EXPECT_EQ(1u, layer.slicedRectRanges().size());
+        EXPECT_EQ(1u, layer.numPlainRects());
+        const auto slices = layer.polygonRectRange(0);
+        EXPECT_EQ(1u, slices.first);
+        EXPECT_EQ(numRects, slices.second);
+        EXPECT_EQ(3u, layer.datatype(1));
+        EXPECT_EQ(numRects, layer.numRects());
+        EXPECT_EQ(std::vector<IndexType>({0}), layer.queryOverlap(Box<LocType>(35, 5, 36, 6), false));
+        EXPECT_FALSE(layer.queryOverlap(Box<LocType>(5, 25, 6, 26), false).empty());
+        // The writers skip the slices
+        const auto skipped = layer.skippedRectRanges(true);
+        ASSERT_EQ(1u, skipped.size());
+        EXPECT_EQ(slices, skipped.front());
+        // A rectangle inserted after the slices is not one of them
+        EXPECT_EQ(numRects, sub.insertRect(2, 50, 0, 60, 10));
+        EXPECT_EQ(2u, layer.numPlainRects());
+        EXPECT_EQ(Box<LocType>(50, 0, 60, 10), layer.box(numRects));
+        EXPECT_EQ(numRects + 1, layer.numRects());
+        EXPECT_EQ(slices, layer.skippedRectRanges(false).front());
+
+        // The vertices are transformed exactly as the points
+        Layout top;
+        XY<LocType> offset(1000, -500);
+        top.insertLayout(sub, offset, OriType::FE, true);
+        CktNode node;
+        node.offset() = offset;
+        node.setOrient(OriType::FE);
+        node.setFlipVertFlag(true);
+        ASSERT_EQ(1u, top.numPolygons(2));
+        EXPECT_EQ(2u, top.layer(2).numPlainRects());
+        // Sliced once transformed
+        EXPECT_EQ(1u, top.layer(2).slicedRectRanges().size());
+        for (IndexType ptIdx = 0; ptIdx < pts.size(); ++ptIdx)
+        {
+            EXPECT_EQ(node.toParentCoord(pts[ptIdx], sub.boundary()), top.layer(2).polygonPoint(0, ptIdx));
+        }
+        ASSERT_EQ(1u, top.layer(2).flattenedPolygonRanges().size());
+        EXPECT_EQ(2u, top.layer(2).flattenedRectRanges().front().second);
+        Box<LocType> expected(node.toParentCoord(sub.boundary().ll(), sub.boundary()));
+        expected.join(node.toParentCoord(sub.boundary().ur(), sub.boundary()));
+        EXPECT_EQ(expected, top.boundary());
+        // Merging keeps the polygons apart from the rectangles
+        top.insertRect(2, expected.xLo(), expected.yLo(), expected.xLo() + 5, expected.yLo() + 5);
+        top.mergeRects();
+        EXPECT_EQ(1u, top.numPolygons(2));
+        EXPECT_EQ(top.layer(2).numPlainRects() + top.layer(2).polygonRectRange(0).second - top.layer(2).polygonRectRange(0).first, top.numRects(2));
+    }
+
+    TEST (LayoutPolygonTest, UnsortedSlices)
+    {
+        // The slices of the second polygon come before the slices of the first, with a plain rectangle between them
+        Layout layout;
+        layout.insertRect(1, 0, 0, 10, 10);
+        layout.insertRect(1, 40, 0, 50, 10);
+        layout.insertRect(1, 60, 0, 70, 10);
+        layout.insertRect(1, 20, 0, 30, 10);
+        const std::vector<LocType> xs({20, 30, 30, 20, 40, 50, 50, 40});
+        const std::vector<LocType> ys({0, 0, 10, 10, 0, 0, 10, 10});
+        const std::vector<IndexType> start({0, 4});
+        const std::vector<IndexType> datatype({0, 0});
+        layout.layer(1).assignPolygons(8, xs.data(), ys.data(), 2, start.data(), datatype.data(), {{3, 4}, {1, 2}});
+        EXPECT_EQ(2u, layout.layer(1).numPlainRects());
+        // The writers go through the ranges in order
+        const std::vector<std::pair<IndexType, IndexType>> expected({{1, 2}, {3, 4}});
+        EXPECT_EQ(expected, layout.layer(1).skippedRectRanges(false));
+    }
+
+    TEST (ShapeBufferTest, RoundTrip)
+    {
+        Layout placed;
+        placed.insertRect(2, 0, 0, 10, 10);
+        placed.insertRect(3, 5, 5, 20, 30);
+        placed.setRectDatatype(3, 0, 7);
+        placed.insertText(3, "VDD", 6, 6);
+        ShapeBuffer buffer;
+        buffer.addLayout(placed);
+        ASSERT_EQ(2u, buffer.numShapes());
+        EXPECT_EQ(Box<LocType>(5, 5, 20, 30), buffer.shape(1));
+        EXPECT_EQ(3u, buffer.layer(1));
+        EXPECT_EQ(7u, buffer.datatype(1));
+        EXPECT_EQ(INDEX_TYPE_MAX, buffer.net(0));
+        ASSERT_EQ(1u, buffer.numTexts());
+        EXPECT_EQ(3u, buffer.textLayer(0));
+        EXPECT_EQ(placed.boundary(), buffer.boundary());
+        // The router reports its wires in bulk, tagged by the nets
+        ShapeBuffer routed;
+        routed.addShapes({2, 4}, {0, 0}, {-5, 0, 0, 2, 10, 10, 40, 12}, {1, 1});
+        EXPECT_EQ(1u, routed.net(1));
+        EXPECT_EQ(Box<LocType>(-5, 0, 40, 12), routed.boundary());
+        Layout layout;
+        buffer.applyTo(layout);
+        routed.applyTo(layout);
+        ASSERT_EQ(2u, layout.numRects(2));
+        EXPECT_EQ(Box<LocType>(-5, 0, 0, 2), layout.rect(2, 1).rect());
+        EXPECT_EQ(7u, layout.rect(3, 0).datatype());
+        EXPECT_EQ(1u, layout.numRects(4));
+        EXPECT_EQ("VDD", layout.text(3, 0).text());
+        EXPECT_EQ(Box<LocType>(-5, 0, 40, 30), layout.boundary());
+        TechDB techDB;
+        for (IndexType layerIdx = 0; layerIdx < 5; ++layerIdx)
+        {
+            techDB.addNewLayer(10 * layerIdx + 1, "L" + std::to_string(layerIdx));
+        }
+        EXPECT_EQ(std::vector<IndexType>({21, 41}), routed.pdkLayerArray(techDB));
+        routed.clear();
+        EXPECT_EQ(0u, routed.numShapes());
+        EXPECT_FALSE(routed.boundary().valid());
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "global/global.h"
+#include "db/LayoutConnectivity.h"
+#include "db/PcellGenerator.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace unittest
+{
+    /// @brief test the connectivity extraction on M1 and M2 connected by VIA1, under a well
+    class LayoutConnectivityTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                _techDB.addNewLayer(3, "NW");
+                _techDB.addNewLayer(31, "M1");
+                _techDB.addNewLayer(32, "M2");
+                _techDB.addNewLayer(51, "VIA1");
+                _techDB.addCutConnection(3, 1);
+                _techDB.addCutConnection(3, 2);
+                for (const char *name : {"A", "B", "C", "D"})
+                {
+                    _ckt.net(_ckt.allocateNet()).setName(name);
+                }
+                auto &layout = _ckt.layout();
+                layout.init(_techDB.numLayers());
+                layout.insertRect(0, 0, 0, 2000, 2000); // The well connects nothing
+                // A: from the io shape on M1 through the via to the text on M2
+                _ckt.net(0).addIoPin(0, 0, 10, 10, 1);
+                layout.insertRect(1, 0, 0, 100, 10);
+                layout.insertRect(3, 90, 0, 100, 10);
+                layout.insertRect(2, 90, 0, 100, 200);
+                layout.insertText(2, "A", 95, 190);
+                // B: two io shapes on unconnected wires
+                _ckt.net(1).addIoPin(300, 0, 310, 10, 1);
+                layout.insertRect(1, 300, 0, 400, 10);
+                _ckt.net(1).addIoPin(500, 0, 510, 10, 2);
+                layout.insertRect(2, 500, 0, 600, 10);
+                // C and D: the texts on abutting wires
+                layout.insertRect(1, 1000, 0, 1100, 10);
+                layout.insertText(1, "C", 1000, 5);
+                layout.insertRect(1, 1100, 0, 1200, 10);
+                layout.insertText(1, "D", 1150, 5);
+                // A via on nothing
+                layout.insertRect(3, 700, 0, 710, 10);
+            }
+            TechDB _techDB;
+            CktGraph _ckt;
+    };
+
+    TEST_F (LayoutConnectivityTest, OpensAndShorts)
+    {
+        LayoutConnectivity conn(_techDB);
+        EXPECT_EQ(conn.check(_ckt, nullptr), 2u);
+        EXPECT_EQ(conn.component(0, 0), INDEX_TYPE_MAX);
+        const IndexType compA = conn.component(1, 0);
+        EXPECT_EQ(conn.component(2, 0), compA);
+        EXPECT_EQ(conn.component(3, 0), compA);
+        EXPECT_EQ(conn.componentNet(compA), 0u);
+        EXPECT_NE(conn.component(1, 1), conn.component(2, 1));
+        EXPECT_EQ(conn.componentNet(conn.component(3, 1)), INDEX_TYPE_MAX);
+        ASSERT_EQ(conn.numOpens(), 1u);
+        EXPECT_EQ(conn.openNet(0), 1u);
+        EXPECT_EQ(conn.openNumComponents(0), 2u);
+        ASSERT_EQ(conn.numShorts(), 1u);
+        EXPECT_EQ(conn.shortNet(0), 2u);
+        EXPECT_EQ(conn.shortOtherNet(0), 3u);
+        EXPECT_EQ(conn.shortLayer(0), 1u);
+        EXPECT_EQ(conn.shortRect(0), 2u);
+        // Without the texts, C and D are not labeled and A is only labeled by its io shape
+        conn.setUseTexts(false);
+        EXPECT_EQ(conn.check(_ckt, nullptr), 1u);
+        EXPECT_EQ(conn.numShorts(), 0u);
+    }
+
+    TEST_F (LayoutConnectivityTest, NoLayerStack)
+    {
+        // Without the cuts, A is open between M1 and M2
+        TechDB flat;
+        flat.addNewLayer(3, "NW");
+        flat.addNewLayer(31, "M1");
+        flat.addNewLayer(32, "M2");
+        flat.addNewLayer(51, "VIA1");
+        LayoutConnectivity conn(flat);
+        conn.setUseTexts(false);
+        conn.check(_ckt, nullptr);
+        EXPECT_EQ(conn.openNetArray(), std::vector<IndexType>({1}));
+        conn.setUseTexts(true);
+        conn.check(_ckt, nullptr);
+        EXPECT_EQ(conn.openNetArray(), std::vector<IndexType>({0, 1}));
+        // Without a layer stack every layer connects, the well too
+        EXPECT_NE(conn.component(0, 0), INDEX_TYPE_MAX);
+    }
+
+    TEST (LayoutConnectivity, DiffusionSplitAtGates)
+    {
+        // A generated NMOS of 2 fingers: the CO on the source and the drain columns land on the same OD rectangle
+        auto techDB = std::make_shared<TechDB>();
+        for (const auto &layer : std::vector<std::pair<IndexType, std::string>>{{3, "NW"}, {6, "OD"}, {17, "PO"}, {25, "PP"}, {26, "NP"}, {30, "CO"},
+                {31, "M1"}, {32, "M2"}, {51, "VIA1"}})
+        {
+            techDB->addNewLayer(layer.first, layer.second);
+        }
+        const IndexType od = techDB->layerNameToIdx("OD");
+        const IndexType po = techDB->layerNameToIdx("PO");
+        for (IndexType layer : {po, od, techDB->layerNameToIdx("M1")})
+        {
+            techDB->addCutConnection(techDB->layerNameToIdx("CO"), layer);
+        }
+        techDB->addCutConnection(techDB->layerNameToIdx("VIA1"), techDB->layerNameToIdx("M1"));
+        techDB->addCutConnection(techDB->layerNameToIdx("VIA1"), techDB->layerNameToIdx("M2"));
+        DesignDB db;
+        db.setTechDB(techDB);
+        IndexType propIdx = db.phyPropDB().allocateNch();
+        db.phyPropDB().nch(propIdx).setWidth(1000000);
+        db.phyPropDB().nch(propIdx).setLength(100000);
+        db.phyPropDB().nch(propIdx).setNumFingers(2);
+        IndexType cktIdx = db.allocateCkt();
+        auto &ckt = db.subCkt(cktIdx);
+        ckt.setImplType(ImplType::PCELL_Nch);
+        ckt.setImplIdx(propIdx);
+        // The drain, the gate and the source, without a bulk tap
+        for (const char *name : {"0", "1", "2"})
+        {
+            ckt.net(ckt.allocateNet()).setName(name);
+        }
+        ASSERT_TRUE(PcellGenerator(db).generate(cktIdx, false));
+        // Conducting through the gates, the drain and the source are shorted
+        LayoutConnectivity merged(*techDB);
+        EXPECT_EQ(merged.check(ckt, nullptr), 1u);
+        ASSERT_EQ(merged.numShorts(), 1u);
+        EXPECT_EQ(merged.shortNet(0), 0u);
+        EXPECT_EQ(merged.shortOtherNet(0), 2u);
+        // Split at the gates, the 3 columns of the diffusion are apart
+        techDB->setGateLayer(od, po);
+        LayoutConnectivity split(*techDB);
+        EXPECT_EQ(split.check(ckt, nullptr), 0u);
+        const IndexType drain = split.component(techDB->layerNameToIdx("M2"), 0);
+        EXPECT_EQ(split.componentNet(drain), 0u);
+        // The diffusion rectangle is in the component of its first piece, left of the gates, under the first source column
+        EXPECT_EQ(split.component(od, 0), split.component(techDB->layerNameToIdx("M1"), 1));
+        EXPECT_EQ(split.componentNet(split.component(od, 0)), 2u);
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "global/global.h"
+#include "db/PcellGenerator.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace unittest
+{
+    /// @brief test the devices in the layers of the mock PDK, with the default rules and 1000 dbu per um
+    class PcellGeneratorTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                auto techDB = std::make_shared<TechDB>();
+                for (const auto &layer : std::vector<std::pair<IndexType, std::string>>{{3, "NW"}, {6, "OD"}, {17, "PO"}, {25, "PP"}, {26, "NP"}, {29, "RPO"},
+                        {30, "CO"}, {31, "M1"}, {32, "M2"}, {51, "VIA1"}})
+                {
+                    techDB->addNewLayer(layer.first, layer.second);
+                }
+                _techDB = techDB;
+                _db.setTechDB(techDB);
+            }
+            IndexType addCkt(ImplType implType, IndexType propIdx, IndexType numNets)
+            {
+                IndexType cktIdx = _db.allocateCkt();
+                auto &ckt = _db.subCkt(cktIdx);
+                ckt.setImplType(implType);
+                ckt.setImplIdx(propIdx);
+                for (IndexType idx = 0; idx < numNets; ++idx)
+                {
+                    ckt.net(ckt.allocateNet()).setName(std::to_string(idx));
+                }
+                return cktIdx;
+            }
+            IndexType count(IndexType cktIdx, const std::string &layerName) const
+            {
+                return _db.subCkt(cktIdx).layout().numRects(_techDB->layerNameToIdx(layerName));
+            }
+            std::shared_ptr<TechDB> _techDB;
+            DesignDB _db;
+    };
+
+    TEST_F (PcellGeneratorTest, Nch)
+    {
+        IndexType propIdx = _db.phyPropDB().allocateNch();
+        _db.phyPropDB().nch(propIdx).setWidth(1000000);
+        _db.phyPropDB().nch(propIdx).setLength(100000);
+        _db.phyPropDB().nch(propIdx).setNumFingers(2);
+        IndexType cktIdx = addCkt(ImplType::PCELL_Nch, propIdx, 4);
+        PcellGenerator generator(_db);
+        ASSERT_TRUE(generator.canGenerate(cktIdx));
+        ASSERT_TRUE(generator.generate(cktIdx, false));
+        auto &ckt = _db.subCkt(cktIdx);
+        // 2 fingers of 500 x 100, the source and drain columns 110 wide
+        EXPECT_EQ(ckt.layout().rect(_techDB->layerNameToIdx("OD"), 0).rect(), Box<LocType>(0, 0, 530, 500));
+        EXPECT_EQ(count(cktIdx, "OD"), 2u);
+        EXPECT_EQ(count(cktIdx, "PO"), 3u);
+        // 4 on the gate bar, 6 in each of the 3 columns, 6 on the tap
+        EXPECT_EQ(count(cktIdx, "CO"), 4u + 3 * 6 + 6);
+        EXPECT_EQ(count(cktIdx, "VIA1"), 1u);
+        EXPECT_EQ(count(cktIdx, "NW"), 0u);
+        EXPECT_EQ(count(cktIdx, "PP"), 1u);
+        EXPECT_EQ(ckt.net(0).ioShape(), Box<LocType>(230, 200, 300, 300));
+        EXPECT_EQ(ckt.net(0).ioLayer(), 2u);
+        EXPECT_EQ(ckt.net(1).ioShape(), Box<LocType>(110, 600, 420, 660));
+        EXPECT_EQ(ckt.net(2).ioShape(), Box<LocType>(0, -200, 530, -100));
+        EXPECT_EQ(ckt.net(3).ioShape(), Box<LocType>(0, -400, 530, -300));
+        EXPECT_EQ(ckt.net(3).ioLayer(), 1u);
+        EXPECT_EQ(ckt.layout().boundary(), Box<LocType>(-40, -440, 570, 660));
+        EXPECT_EQ(ckt.gdsData().bbox(), ckt.layout().boundary());
+        EXPECT_TRUE(ckt.gdsData().gdsFile().empty());
+
+        // Without a bulk net, a PMOS has no tap and sits in an NW
+        IndexType pchIdx = _db.phyPropDB().allocatePch();
+        _db.phyPropDB().pch(pchIdx).setWidth(1000000);
+        _db.phyPropDB().pch(pchIdx).setLength(100000);
+        IndexType pmosIdx = addCkt(ImplType::PCELL_Pch, pchIdx, 3);
+        ASSERT_TRUE(generator.generate(pmosIdx, false));
+        EXPECT_EQ(count(pmosIdx, "OD"), 1u);
+        EXPECT_EQ(count(pmosIdx, "NW"), 1u);
+        EXPECT_EQ(count(pmosIdx, "NP"), 0u);
+    }
+
+    TEST_F (PcellGeneratorTest, ResFlip)
+    {
+        IndexType propIdx = _db.phyPropDB().allocateRes();
+        auto &res = _db.phyPropDB().resister(propIdx);
+        res.setWr(400000);
+        res.setLr(2000000);
+        res.setSegNum(2);
+        res.setSeries(true);
+        IndexType cktIdx = addCkt(ImplType::PCELL_Res, propIdx, 2);
+        PcellGenerator generator(_db);
+        ASSERT_TRUE(generator.generate(cktIdx, false));
+        auto &ckt = _db.subCkt(cktIdx);
+        EXPECT_EQ(count(cktIdx, "PO"), 2u);
+        EXPECT_EQ(count(cktIdx, "RPO"), 2u);
+        // The 4 heads and the strap at the top
+        EXPECT_EQ(count(cktIdx, "M1"), 5u);
+        EXPECT_EQ(ckt.net(0).ioShape(), Box<LocType>(0, 0, 400, 60));
+        EXPECT_EQ(ckt.net(1).ioShape(), Box<LocType>(500, 0, 900, 60));
+        EXPECT_EQ(ckt.layout().boundary(), Box<LocType>(-40, 0, 940, 2120));
+        // Mirrored, the ends swap sides and the boundary stays
+        ASSERT_TRUE(generator.generate(cktIdx, true));
+        EXPECT_EQ(count(cktIdx, "PO"), 2u);
+        EXPECT_EQ(ckt.net(0).ioShape(), Box<LocType>(500, 0, 900, 60));
+        EXPECT_EQ(ckt.net(1).ioShape(), Box<LocType>(0, 0, 400, 60));
+        EXPECT_EQ(ckt.layout().boundary(), Box<LocType>(-40, 0, 940, 2120));
+    }
+
+    TEST_F (PcellGeneratorTest, CapGenerateAll)
+    {
+        std::vector<IndexType> cktIdxs;
+        for (IndexType idx = 0; idx < 8; ++idx)
+        {
+            IndexType propIdx = _db.phyPropDB().allocateCap();
+            auto &cap = _db.phyPropDB().capacitor(propIdx);
+            cap.setW(100000);
+            cap.setLr(1000000);
+            cap.setSpacing(100000);
+            cap.setNumFingers(4);
+            cap.setStm(1);
+            cap.setSpm(2);
+            cktIdxs.emplace_back(addCkt(ImplType::PCELL_Cap, propIdx, 2));
+        }
+        // Without its length, the last one is left alone
+        _db.phyPropDB().capacitor(7).setLr(-1);
+        cktIdxs.emplace_back(addCkt(ImplType::UNSET, 0, 2));
+        PcellGenerator generator(_db);
+        EXPECT_FALSE(generator.canGenerate(cktIdxs.back()));
+        EXPECT_EQ(generator.generateAll(cktIdxs, std::vector<bool>(cktIdxs.size(), false)), 7u);
+        for (IndexType idx = 0; idx < 7; ++idx)
+        {
+            auto &ckt = _db.subCkt(cktIdxs[idx]);
+            // 2 buses and 4 fingers on each metal, 7 vias on each bus
+            EXPECT_EQ(count(cktIdxs[idx], "M1"), 6u);
+            EXPECT_EQ(count(cktIdxs[idx], "M2"), 6u);
+            EXPECT_EQ(count(cktIdxs[idx], "VIA1"), 14u);
+            EXPECT_EQ(ckt.net(0).ioShape(), Box<LocType>(0, 1200, 700, 1300));
+            EXPECT_EQ(ckt.net(1).ioShape(), Box<LocType>(0, 0, 700, 100));
+            EXPECT_EQ(ckt.net(1).ioLayer(), 1u);
+            EXPECT_EQ(ckt.layout().boundary(), Box<LocType>(0, 0, 700, 1300));
+        }
+        EXPECT_FALSE(_db.subCkt(cktIdxs[7]).hasLayout());
+    }
+}
+
+PROJECT_NAMESPACE_END
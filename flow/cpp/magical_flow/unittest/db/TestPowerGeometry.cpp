@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "global/global.h"
+#include "db/PowerGeometry.h"
+#include "db/DrcScreen.h"
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace unittest
+{
+    /// @brief test the power geometry in the layers of the mock PDK, with a CO of 40 and 50 apart
+    class PowerGeometryTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                _techDB = std::make_shared<TechDB>();
+                for (const auto &layer : std::vector<std::pair<IndexType, std::string>>{{3, "NW"}, {6, "OD"}, {25, "PP"}, {26, "NP"}, {30, "CO"}, {31, "M1"}, {32, "M2"}, {51, "VIA1"}})
+                {
+                    _techDB->addNewLayer(layer.first, layer.second);
+                }
+                LayerRule co;
+                co.setMinWidth(40);
+                co.setMinSpacing(50);
+                _techDB->setLayerRule(_techDB->layerNameToIdx("CO"), co);
+            }
+            IndexType count(const ShapeBuffer &buffer, const std::string &layerName) const
+            {
+                const auto &layers = buffer.layerArray();
+                return std::count(layers.begin(), layers.end(), _techDB->layerNameToIdx(layerName));
+            }
+            std::shared_ptr<TechDB> _techDB;
+    };
+
+    TEST_F (PowerGeometryTest, GuardRing)
+    {
+        PowerGeometry geometry(*_techDB);
+        EXPECT_EQ(geometry.rule().contactSize, 40);
+        EXPECT_EQ(geometry.rule().contactSpacing, 50);
+        ShapeBuffer buffer;
+        auto sides = geometry.addGuardRing(Box<LocType>(0, 0, 1000, 600), false, buffer, 3);
+        EXPECT_EQ(sides[0], Box<LocType>(-200, -200, 1200, 0));
+        EXPECT_EQ(sides[1], Box<LocType>(1000, 0, 1200, 600));
+        EXPECT_EQ(count(buffer, "OD"), 4u);
+        EXPECT_EQ(count(buffer, "M1"), 4u);
+        EXPECT_EQ(count(buffer, "PP"), 4u);
+        EXPECT_EQ(count(buffer, "NW"), 0u);
+        // 160 x 1360 inside the enclosure of the bottom side: 2 x 15 cuts, and 2 x 6 on the left and right sides
+        EXPECT_EQ(count(buffer, "CO"), 2u * (2 * 15 + 2 * 6));
+        EXPECT_EQ(buffer.net(0), 3u);
+        // The contacts are inside the sides, and keep their spacing
+        Layout layout;
+        buffer.applyTo(layout);
+        const IndexType coLayer = _techDB->layerNameToIdx("CO");
+        DrcScreen screen(*_techDB);
+        EXPECT_EQ(screen.check(layout), 0u);
+        for (IndexType rectIdx = 0; rectIdx < layout.numRects(coLayer); ++rectIdx)
+        {
+            const Box<LocType> cut = layout.rect(coLayer, rectIdx).rect();
+            EXPECT_TRUE(std::any_of(sides.begin(), sides.end(), [&](const Box<LocType> &side) { return side.cover(cut); }));
+        }
+
+        ShapeBuffer well;
+        geometry.addGuardRing(Box<LocType>(0, 0, 1000, 600), true, well);
+        EXPECT_EQ(count(well, "NP"), 4u);
+        ASSERT_EQ(count(well, "NW"), 1u);
+        EXPECT_EQ(well.boundary(), Box<LocType>(-400, -400, 1400, 1000));
+    }
+
+    TEST_F (PowerGeometryTest, ViaStack)
+    {
+        PowerGeometry geometry(*_techDB);
+        ShapeBuffer buffer;
+        geometry.addViaStack(Box<LocType>(0, 0, 200, 100), 1, 3, buffer);
+        // No M3 nor VIA2 in the technology
+        EXPECT_EQ(count(buffer, "M1"), 1u);
+        EXPECT_EQ(count(buffer, "M2"), 1u);
+        // 180 x 80 inside the enclosure: 2 x 1 cuts of 50 and 50 apart
+        EXPECT_EQ(count(buffer, "VIA1"), 2u);
+        EXPECT_EQ(PowerGeometry::metalLayer(*_techDB, _techDB->layerNameToIdx("M2")), 2u);
+        EXPECT_EQ(PowerGeometry::metalLayer(*_techDB, _techDB->layerNameToIdx("VIA1")), 0u);
+    }
+
+    TEST_F (PowerGeometryTest, IoPinNode)
+    {
+        DesignDB designDB;
+        designDB.setTechDB(_techDB);
+        IndexType cktIdx = designDB.allocateCkt();
+        designDB.subCkt(cktIdx).allocateNet();
+        PowerGeometry geometry(*_techDB);
+        ShapeBuffer buffer;
+        geometry.addPowerStripe(Box<LocType>(-105, 1000, 2005, 1500), 2, buffer);
+        geometry.addGuardRing(Box<LocType>(0, 0, 1000, 600), false, buffer);
+        IndexType nodeIdx = PowerGeometry::insertIoPinNode(designDB, cktIdx, 0, buffer, true, 100);
+        const CktGraph &ckt = designDB.subCkt(cktIdx);
+        ASSERT_EQ(ckt.numNodes(), 1u);
+        const CktNode &node = ckt.node(nodeIdx);
+        ASSERT_EQ(node.numPins(), 1u);
+        const Pin &pin = ckt.pin(node.pinIdx(0));
+        EXPECT_EQ(pin.netIdx(), 0u);
+        EXPECT_EQ(pin.intNetIdx(), 0u);
+        // The stripe on M2 and the four sides on M1
+        const Net &net = ckt.net(0);
+        ASSERT_EQ(net.numIoPins(), 5u);
+        EXPECT_EQ(net.ioPinMetalLayer(0), 2u);
+        EXPECT_EQ(net.ioPinShape(0), Box<LocType>(-105, 1000, 2005, 1500));
+        const CktGraph &cell = designDB.subCkt(node.subgraphIdx());
+        EXPECT_TRUE(cell.isImpl());
+        EXPECT_EQ(cell.net(0).numIoPins(), 5u);
+        EXPECT_EQ(cell.layout().numRects(_techDB->layerNameToIdx("CO")), 2u * (2 * 15 + 2 * 6));
+        // Past the grid, as Placer.upscaleBBox
+        EXPECT_EQ(cell.layout().boundary(), Box<LocType>(-300, -300, 2100, 1600));
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "db/TechDB.h"
+#include "parser/GdsMappedLibrary.h"
+#include "parser/GdsStreamReader.h"
+#include "util/GzipStream.h"
+#include "writer/GdsStreamWriter.h"
+
+extern std::string UNITTEST_TOP_DIR;
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace unittest
+{
+    /// @brief test the streaming GDSII reader on a small hierarchy written by GdsStream
+    class TestGdsStreamReader : public::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                testFile = UNITTEST_TOP_DIR + "./stream_reader.gds";
+                std::ofstream os(testFile, std::ios::binary);
+                GdsStream gds(os);
+                gds.beginLib(5, "lib", 0.001, 1e-9);
+                // MID references LEAF before LEAF is defined
+                gds.beginStruct("MID");
+                gds.writeBoundary(1, 0, Box<LocType>(0, 0, 1, 1));
+                gds.writeSref("LEAF", XY<LocType>(10, 0), 90, false);
+                gds.endStruct();
+                gds.beginStruct("LEAF");
+                gds.writeBoundary(1, 3, Box<LocType>(0, 0, 10, 20));
+                gds.writeBoundary(99, 0, Box<LocType>(0, 0, 5, 5));
+                gds.endStruct();
+                gds.beginStruct("ORPHAN");
+                gds.writeBoundary(1, 0, Box<LocType>(-500, -500, -400, -400));
+                gds.endStruct();
+                gds.beginStruct("TOP");
+                gds.writeBoundary(1, 0, Box<LocType>(100, 100, 110, 110));
+                gds.writeSref("MID", XY<LocType>(1000, 0), 0, true);
+                gds.writeSref("LEAF", XY<LocType>(0, 0), 180, false);
+                gds.endStruct();
+                gds.endLib();
+            }
+            void TearDown() override
+            {
+                std::remove(testFile.c_str());
+            }
+        public:
+            std::string testFile; ///< The GDSII file
+    };
+    TEST_F(TestGdsStreamReader, flatten)
+    {
+        TechDB techDB;
+        techDB.addNewLayer(1, "M1");
+        Layout layout;
+        layout.init(techDB.numLayers());
+        GdsStreamReader reader(layout, techDB);
+        EXPECT_TRUE(reader.read(testFile));
+        EXPECT_EQ(reader.topCellName(), "TOP");
+        // Layer 99 is not in the tech and ORPHAN is not instantiated
+        ASSERT_EQ(layout.numRects(0), 4);
+        EXPECT_EQ(layout.rect(0, 0).rect(), Box<LocType>(100, 100, 110, 110));
+        // MID reflected about the x axis at (1000, 0)
+        EXPECT_EQ(layout.rect(0, 1).rect(), Box<LocType>(1000, -1, 1001, 0));
+        // LEAF rotated by 90 degree in MID, then reflected
+        EXPECT_EQ(layout.rect(0, 2).rect(), Box<LocType>(990, -10, 1010, 0));
+        EXPECT_EQ(layout.rect(0, 2).datatype(), 3);
+        // LEAF rotated by 180 degree in TOP
+        EXPECT_EQ(layout.rect(0, 3).rect(), Box<LocType>(-10, -20, 0, 0));
+    }
+    TEST_F(TestGdsStreamReader, elementOrder)
+    {
+        // A horizontal PATH of width 10 from (0, y) to (100, y), hand-encoded as GdsStream writes no paths
+        auto writePath = [](std::ostream &os, std::int32_t y)
+        {
+            const std::int32_t xy[4] = {0, y, 100, y};
+            std::string bytes("\x00\x04\x09\x00" "\x00\x06\x0D\x02\x00\x01" "\x00\x06\x0E\x02\x00\x00" "\x00\x08\x0F\x03\x00\x00\x00\x0A" "\x00\x14\x10\x03", 28);
+            for (std::int32_t value : xy)
+            {
+                for (int shift = 24; shift >= 0; shift -= 8)
+                {
+                    bytes.push_back(static_cast<char>((static_cast<std::uint32_t>(value) >> shift) & 0xFF));
+                }
+            }
+            bytes.append("\x00\x04\x11\x00", 4);
+            os.write(bytes.data(), bytes.size());
+        };
+        {
+            std::ofstream os(testFile, std::ios::binary);
+            GdsStream gds(os);
+            gds.beginLib(5, "lib", 0.001, 1e-9);
+            gds.beginStruct("TOP");
+            gds.flush();
+            writePath(os, 0);
+            gds.writeBoundary(1, 0, Box<LocType>(200, 200, 210, 210));
+            gds.flush();
+            writePath(os, 50);
+            gds.endStruct();
+            gds.endLib();
+        }
+        TechDB techDB;
+        techDB.addNewLayer(1, "M1");
+        Layout layout;
+        layout.init(techDB.numLayers());
+        ASSERT_TRUE(GdsStreamReader(layout, techDB).read(testFile));
+        // The paths and the boundaries keep the order of the elements
+        ASSERT_EQ(layout.numRects(0), 3);
+        EXPECT_EQ(layout.rect(0, 0).rect(), Box<LocType>(0, -5, 100, 5));
+        EXPECT_EQ(layout.rect(0, 1).rect(), Box<LocType>(200, 200, 210, 210));
+        EXPECT_EQ(layout.rect(0, 2).rect(), Box<LocType>(0, 45, 100, 55));
+    }
+    TEST_F(TestGdsStreamReader, mapped)
+    {
+        TechDB techDB;
+        techDB.addNewLayer(1, "M1");
+        Layout streamed;
+        streamed.init(techDB.numLayers());
+        ASSERT_TRUE(GdsStreamReader(streamed, techDB).read(testFile));
+        // The top cell gives the same shapes as the streaming reader
+        GdsMappedLibrary library(testFile);
+        ASSERT_TRUE(library.valid());
+        ASSERT_EQ(library.numCells(), 4);
+        EXPECT_EQ(library.topCellName(), "TOP");
+        EXPECT_EQ(library.cellIdx("ORPHAN"), 2);
+        EXPECT_EQ(library.cellIdx("NONE"), INDEX_TYPE_MAX);
+        Layout layout;
+        layout.init(techDB.numLayers());
+        ASSERT_TRUE(library.readCell("TOP", layout, techDB));
+        ASSERT_EQ(layout.numRects(0), streamed.numRects(0));
+        for (IndexType rectIdx = 0; rectIdx < layout.numRects(0); ++rectIdx)
+        {
+            EXPECT_EQ(layout.rect(0, rectIdx).rect(), streamed.rect(0, rectIdx).rect());
+            EXPECT_EQ(layout.rect(0, rectIdx).datatype(), streamed.rect(0, rectIdx).datatype());
+        }
+        // Any cell of the library, with the cells it references
+        Layout mid;
+        mid.init(techDB.numLayers());
+        ASSERT_TRUE(library.readCell("MID", mid, techDB));
+        ASSERT_EQ(mid.numRects(0), 2);
+        EXPECT_EQ(mid.rect(0, 0).rect(), Box<LocType>(0, 0, 1, 1));
+        EXPECT_EQ(mid.rect(0, 1).rect(), Box<LocType>(-10, 0, 10, 10));
+        EXPECT_FALSE(library.readCell("NONE", mid, techDB));
+        // The shared libraries stay mapped until closed
+        GdsMappedLibrary::closeAll();
+        auto shared = GdsMappedLibrary::open(testFile);
+        ASSERT_NE(shared, nullptr);
+        EXPECT_EQ(GdsMappedLibrary::open(testFile), shared);
+        EXPECT_EQ(GdsMappedLibrary::numOpen(), 1);
+        GdsMappedLibrary::closeAll();
+        EXPECT_EQ(GdsMappedLibrary::numOpen(), 0);
+        EXPECT_TRUE(shared->valid());
+        EXPECT_FALSE(GdsMappedLibrary(testFile + ".none").valid());
+    }
+    TEST_F(TestGdsStreamReader, gzip)
+    {
+        // Small chunks so that the background threads hand over many of them
+        std::string gzFile = testFile + ".gz";
+        {
+            std::ifstream in(testFile, std::ios::binary);
+            GzipOFStream out(gzFile, 9, 16);
+            ASSERT_TRUE(out.isOpen());
+            out << in.rdbuf();
+            EXPECT_EQ(static_cast<std::streamoff>(out.tellp()), static_cast<std::streamoff>(out.numBytesIn()));
+            EXPECT_TRUE(out.close());
+        }
+        {
+            std::ifstream plain(testFile, std::ios::binary);
+            std::string expected((std::istreambuf_iterator<char>(plain)), std::istreambuf_iterator<char>());
+            GzipIFStream in(gzFile, 16);
+            ASSERT_TRUE(in.isOpen());
+            std::string actual((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            EXPECT_TRUE(in.valid());
+            EXPECT_EQ(actual, expected);
+        }
+        TechDB techDB;
+        techDB.addNewLayer(1, "M1");
+        Layout layout;
+        layout.init(techDB.numLayers());
+        GdsStreamReader reader(layout, techDB);
+        EXPECT_TRUE(reader.read(gzFile));
+        EXPECT_EQ(reader.topCellName(), "TOP");
+        EXPECT_EQ(layout.numRects(0), 4);
+        // A stream cut before its end, and one with a wrong trailer, are not read
+        std::string cutFile = testFile + ".cut.gz";
+        {
+            std::ifstream in(gzFile, std::ios::binary);
+            std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            for (std::size_t numBytes : {bytes.size() / 2, bytes.size() - 4, bytes.size()})
+            {
+                std::string cut = bytes.substr(0, numBytes);
+                if (numBytes == bytes.size())
+                {
+                    cut[numBytes - 5] ^= 0x1;
+                }
+                {
+                    std::ofstream out(cutFile, std::ios::binary);
+                    out << cut;
+                }
+                GzipIFStream cutIn(cutFile, 16);
+                std::string actual((std::istreambuf_iterator<char>(cutIn)), std::istreambuf_iterator<char>());
+                EXPECT_FALSE(cutIn.valid()) << numBytes;
+                EXPECT_FALSE(PlainFile(cutFile).valid()) << numBytes;
+            }
+        }
+        std::remove(cutFile.c_str());
+        std::remove(gzFile.c_str());
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include "parser/ParseNetlist.h"
+
+extern std::string UNITTEST_TOP_DIR;
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace unittest
+{
+    /// @brief test the hspice netlist parser
+    class TestNetlistParser : public::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                testFile = UNITTEST_TOP_DIR + "./inv.hspice.sp";
+            }
+        public:
+            std::string testFile; ///< The hspice netlist
+    };
+    TEST_F(TestNetlistParser, hspice)
+    {
+        DesignDB designDB;
+        ASSERT_TRUE(PROJECT_NAMESPACE::PARSE::parseNetlist(testFile, designDB, true));
+        // INV, BUF, then the devices of INV and the resistor of BUF
+        ASSERT_EQ(designDB.numCkts(), 5);
+        const auto &inv = designDB.subCkt(0);
+        EXPECT_EQ(inv.name(), "INV");
+        ASSERT_EQ(inv.numNets(), 4);
+        EXPECT_EQ(inv.net(3).name(), "vss");
+        EXPECT_EQ(inv.net(3).ioPos(), 3);
+        EXPECT_EQ(inv.node(0).name(), "INV_xm0");
+        EXPECT_EQ(inv.node(0).subgraphIdx(), 2);
+        // The bulk of the nmos is a substrate pin
+        EXPECT_EQ(inv.pin(3).pinType(), PinType::PSUB);
+        EXPECT_EQ(inv.net(3).numSubs(), 1);
+
+        const auto &buf = designDB.subCkt(1);
+        EXPECT_EQ(buf.name(), "BUF");
+        ASSERT_EQ(buf.numNets(), 5);
+        EXPECT_EQ(buf.net(4).name(), "mid");
+        EXPECT_FALSE(buf.net(4).isIo());
+        EXPECT_EQ(buf.node(1).subgraphIdx(), 0);
+        EXPECT_EQ(buf.pin(4).intNetIdx(), 0);
+        EXPECT_EQ(buf.node(2).subgraphIdx(), 4);
+
+        const auto &props = designDB.phyPropDB();
+        const auto &pch = designDB.subCkt(3);
+        EXPECT_EQ(pch.name(), "INV_xm1");
+        EXPECT_EQ(pch.implType(), ImplType::PCELL_Pch);
+        EXPECT_EQ(pch.numNwells(), 1);
+        ASSERT_EQ(props.numPch(), 1);
+        EXPECT_EQ(props.pch(0).length(), 40000);
+        EXPECT_EQ(props.pch(0).width(), 1600000);
+        EXPECT_EQ(props.pch(0).mult(), 2);
+        EXPECT_EQ(props.pch(0).numFingers(), 2);
+        EXPECT_EQ(props.pch(0).attr(), "pch_lvt_mac");
+        ASSERT_EQ(props.numRes(), 1);
+        EXPECT_TRUE(props.resister(0).series());
+        EXPECT_EQ(props.resister(0).segNum(), 9);
+        EXPECT_EQ(designDB.subCkt(4).implType(), ImplType::PCELL_Res);
+        EXPECT_EQ(designDB.subCkt(4).numPsubs(), 1);
+    }
+
+    TEST_F(TestNetlistParser, invalidInstance)
+    {
+        const std::string fileName = UNITTEST_TOP_DIR + "/invalidInstance.sp";
+        for (const char *text : {".subckt INV i zn vdd vss\nxm0 l=40e-9 w=1.2u\n.ends INV\n",
+                                 "xm0 zn i vss vss nch_lvt_mac l=40e-9\n.subckt INV i zn vdd vss\n.ends INV\n"})
+        {
+            {
+                std::ofstream os(fileName);
+                os << text;
+            }
+            DesignDB designDB;
+            EXPECT_FALSE(PROJECT_NAMESPACE::PARSE::parseNetlist(fileName, designDB, true)) << text;
+        }
+        {
+            // The control statements are skipped
+            std::ofstream os(fileName);
+            os << ".option post\n.subckt INV i zn vdd vss\n.param w=1u\nxm0 zn i vss vss nch_lvt_mac l=40e-9 w=1.2u multi=1 nf=2\n.ends INV\n.end\n";
+        }
+        DesignDB designDB;
+        EXPECT_TRUE(PROJECT_NAMESPACE::PARSE::parseNetlist(fileName, designDB, true));
+        std::remove(fileName.c_str());
+    }
+} // End of the unittest namespace
+
+PROJECT_NAMESPACE_END
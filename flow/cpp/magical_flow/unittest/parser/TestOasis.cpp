@@ -0,0 +1,278 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <tuple>
+#include "db/DesignDB.h"
+#include "parser/GdsMappedLibrary.h"
+#include "parser/OasisReader.h"
+#include "writer/GdsBatchWriter.h"
+#include "writer/OasisWriter.h"
+
+extern std::string UNITTEST_TOP_DIR;
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace unittest
+{
+    /// @brief test the OASIS writer and reader on a device array placed three times in a row and once flipped
+    class TestOasis : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                auto techDB = std::make_shared<TechDB>();
+                techDB->addNewLayer(1, "M1");
+                techDB->addNewLayer(2, "CO");
+                _db.setTechDB(techDB);
+                IndexType subIdx = _db.allocateCkt();
+                _topIdx = _db.allocateCkt();
+                auto &sub = _db.subCkt(subIdx);
+                sub.setName("dev");
+                for (LocType col = 0; col < 8; ++col)
+                {
+                    // The fingers in a row and the contacts in a grid
+                    sub.layout().insertRect(0, col * 20, 0, col * 20 + 5, 50);
+                    for (LocType row = 0; row < 3; ++row)
+                    {
+                        IndexType rectIdx = sub.layout().insertRect(1, col * 20 + 1, row * 10 + 5, col * 20 + 4, row * 10 + 8);
+                        sub.layout().setRectDatatype(1, rectIdx, 2);
+                    }
+                }
+                sub.layout().insertRect(0, -7, -3, 151, 0);
+                sub.layout().insertText(0, "G", 2, 25);
+                // A guard ring like polygon, starting with a vertical edge
+                const std::vector<XY<LocType>> ring({XY<LocType>(-7, 60), XY<LocType>(-7, 80), XY<LocType>(151, 80), XY<LocType>(151, 60),
+                        XY<LocType>(141, 60), XY<LocType>(141, 70), XY<LocType>(3, 70), XY<LocType>(3, 60)});
+                sub.layout().insertPolygon(0, ring.begin(), ring.end(), 4);
+                sub.layout().setBoundary(-7, -3, 151, 80);
+                auto &top = _db.subCkt(_topIdx);
+                top.setName("top");
+                for (IndexType nodeIdx = 0; nodeIdx < 4; ++nodeIdx)
+                {
+                    top.node(top.allocateNode()).setSubgraphIdx(subIdx);
+                    top.node(nodeIdx).setOffset(static_cast<LocType>(nodeIdx) * 200, 0);
+                }
+                top.node(3).setOffset(0, 300);
+                top.node(3).setFlipVertFlag(true);
+                top.node(3).setOrient(OriType::S);
+                _db.insertSubLayouts(_topIdx);
+                top.layout().insertRect(1, 0, 500, 1000, 510);
+                top.layout().insertText(1, "VDD", 10, 505);
+                _file = UNITTEST_TOP_DIR + "./test_oasis.oas";
+            }
+            void TearDown() override
+            {
+                std::remove(_file.c_str());
+            }
+            /// @brief the rectangles of a layout as (layer, box, datatype), sorted
+            static std::vector<std::tuple<IndexType, LocType, LocType, LocType, LocType, IndexType>> rects(const Layout &layout)
+            {
+                std::vector<std::tuple<IndexType, LocType, LocType, LocType, LocType, IndexType>> result;
+                for (IndexType layerIdx = 0; layerIdx < 2; ++layerIdx)
+                {
+                    for (IndexType rectIdx = 0; rectIdx < layout.numRects(layerIdx); ++rectIdx)
+                    {
+                        const auto &box = layout.layer(layerIdx).box(rectIdx);
+                        result.emplace_back(layerIdx, box.xLo(), box.yLo(), box.xHi(), box.yHi(), layout.layer(layerIdx).datatype(rectIdx));
+                    }
+                }
+                std::sort(result.begin(), result.end());
+                return result;
+            }
+            /// @brief the polygons of a layout as (layer, datatype, vertices), sorted
+            static std::vector<std::tuple<IndexType, IndexType, std::vector<XY<LocType>>>> polygons(const Layout &layout)
+            {
+                std::vector<std::tuple<IndexType, IndexType, std::vector<XY<LocType>>>> result;
+                for (IndexType layerIdx = 0; layerIdx < 2; ++layerIdx)
+                {
+                    for (IndexType polyIdx = 0; polyIdx < layout.numPolygons(layerIdx); ++polyIdx)
+                    {
+                        result.emplace_back(layerIdx, layout.layer(layerIdx).polygonDatatype(polyIdx), layout.layer(layerIdx).polygon(polyIdx));
+                    }
+                }
+                std::sort(result.begin(), result.end());
+                return result;
+            }
+            /// @brief the texts of a layout as (layer, string, x, y), sorted
+            static std::vector<std::tuple<IndexType, std::string, LocType, LocType>> texts(const Layout &layout)
+            {
+                std::vector<std::tuple<IndexType, std::string, LocType, LocType>> result;
+                for (IndexType layerIdx = 0; layerIdx < 2; ++layerIdx)
+                {
+                    for (const auto &text : layout.layer(layerIdx).textList())
+                    {
+                        result.emplace_back(layerIdx, text.text(), text.coord().x(), text.coord().y());
+                    }
+                }
+                std::sort(result.begin(), result.end());
+                return result;
+            }
+            /// @brief write the top circuit, read it back and compare with the flattened layout
+            void roundTrip(const std::string &fileName, bool hierarchical, int compressionLevel)
+            {
+                ASSERT_TRUE(OasisWriter(_db, _db.techDB()).writeLayout(_topIdx, fileName, hierarchical, compressionLevel));
+                Layout layout;
+                layout.init(_db.techDB().numLayers());
+                OasisReader reader(layout, _db.techDB());
+                ASSERT_TRUE(reader.read(fileName));
+                EXPECT_EQ(reader.topCellName(), "top");
+                const auto &expected = _db.subCkt(_topIdx).layout();
+                EXPECT_EQ(polygons(layout), polygons(expected));
+                EXPECT_EQ(4u, layout.numPolygons(0));
+                EXPECT_EQ(rects(layout), rects(expected));
+                EXPECT_EQ(texts(layout), texts(expected));
+            }
+        public:
+            DesignDB _db; ///< The design
+            IndexType _topIdx = INDEX_TYPE_MAX; ///< The top circuit
+            std::string _file; ///< The OASIS file
+    };
+
+    TEST_F(TestOasis, arrays)
+    {
+        std::vector<XY<LocType>> positions;
+        for (LocType col = 0; col < 8; ++col)
+        {
+            for (LocType row = 0; row < 3; ++row)
+            {
+                positions.emplace_back(col * 20 + 1, row * 10 + 5);
+            }
+        }
+        positions.emplace_back(500, 500);
+        positions.emplace_back(300, 5);
+        std::vector<WRITER::OasisArray> arrays;
+        WRITER::findOasisArrays(positions, arrays);
+        // The 8 x 3 grid, and (300, 5) does not continue its first row at the pitch 20
+        ASSERT_EQ(arrays.size(), 3u);
+        EXPECT_EQ(arrays[0].origin, XY<LocType>(1, 5));
+        EXPECT_EQ(arrays[0].cols, 8u);
+        EXPECT_EQ(arrays[0].rows, 3u);
+        EXPECT_EQ(arrays[0].colSpace, 20);
+        EXPECT_EQ(arrays[0].rowSpace, 10);
+        EXPECT_EQ(arrays[1].origin, XY<LocType>(300, 5));
+        EXPECT_EQ(arrays[1].cols * arrays[1].rows, 1u);
+        EXPECT_EQ(arrays[2].origin, XY<LocType>(500, 500));
+    }
+    TEST(OasisStreamTest, knownBytes)
+    {
+        // A cell with two rectangles, encoded by hand after SEMI P39
+        std::ostringstream os;
+        {
+            OasisStream stream(os, 0);
+            stream.beginFile(1000);
+            stream.writeCellName("TOP");
+            stream.beginCell(0);
+            WRITER::OasisArray array;
+            array.origin = XY<LocType>(-50, 300);
+            stream.writeRectangle(1, 0, 100, 200, array);
+            // A square after it on the same row: only the x delta
+            array.origin = XY<LocType>(50, 300);
+            stream.writeRectangle(1, 0, 100, 100, array);
+            stream.endCell();
+            stream.endFile();
+        }
+        std::string expected("%SEMI-OASIS\r\n", 13);
+        const std::vector<std::uint8_t> records = {
+            // START: version "1.0", unit 1000 as a positive integer real, offset-flag 0 and the 12 table offsets
+            0x01, 0x03, '1', '.', '0', 0x00, 0xE8, 0x07, 0x00, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            // CELLNAME "TOP", CELL of reference 0 and XYRELATIVE
+            0x03, 0x03, 'T', 'O', 'P', 0x0D, 0x00, 0x10,
+            // RECTANGLE 0WHXY0DL: layer 1, datatype 0, width 100, height 200, x -50, y 300
+            0x14, 0x7B, 0x01, 0x00, 0x64, 0xC8, 0x01, 0x65, 0xD8, 0x04,
+            // RECTANGLE S00X0000: the modal width reused as the height, x +100
+            0x14, 0x90, 0xC8, 0x01};
+        expected.append(records.begin(), records.end());
+        // END: the 252 bytes of padding and the validation scheme 0
+        expected.append({0x02, static_cast<char>(0xFC), 0x01});
+        expected.append(252, '\0');
+        expected.push_back(0x00);
+        EXPECT_EQ(os.str(), expected);
+    }
+    TEST_F(TestOasis, roundTrip)
+    {
+        roundTrip(_file, false, 0);
+        roundTrip(_file, false, MfGzip::DEFAULT_LEVEL);
+        roundTrip(_file, true, 0);
+        roundTrip(_file, true, MfGzip::DEFAULT_LEVEL);
+        std::string gzFile = _file + ".gz";
+        roundTrip(gzFile, true, MfGzip::DEFAULT_LEVEL);
+        std::remove(gzFile.c_str());
+    }
+    TEST_F(TestOasis, hierarchyWithoutMarks)
+    {
+        // The copies of the sub layouts are found from the nodes, as for a layout read back from a file
+        auto &top = _db.subCkt(_topIdx).layout();
+        for (IndexType layerIdx = 0; layerIdx < top.numLayers(); ++layerIdx)
+        {
+            top.layer(layerIdx).setFlattenedRanges({}, {});
+            top.layer(layerIdx).setFlattenedPolygonRanges({});
+        }
+        roundTrip(_file, true, 0);
+        const std::string gdsFile = _file + ".gds";
+        ASSERT_TRUE(GdsStreamWriter(_db, _db.techDB()).writeGdsLayout(_topIdx, gdsFile, true));
+        GdsMappedLibrary library(gdsFile);
+        ASSERT_TRUE(library.valid());
+        Layout layout;
+        layout.init(_db.techDB().numLayers());
+        ASSERT_TRUE(library.readCell("top", layout, _db.techDB()));
+        EXPECT_EQ(rects(layout), rects(top));
+        EXPECT_EQ(polygons(layout), polygons(top));
+        std::remove(gdsFile.c_str());
+    }
+    TEST_F(TestOasis, size)
+    {
+        std::string gdsFile = _file + ".gds";
+        ASSERT_TRUE(GdsStreamWriter(_db, _db.techDB()).writeGdsLayout(_topIdx, gdsFile));
+        // The file opens but the writes fail
+        if (std::ifstream("/dev/full").good())
+        {
+            EXPECT_FALSE(GdsStreamWriter(_db, _db.techDB()).writeGdsLayout(_topIdx, "/dev/full"));
+        }
+        ASSERT_TRUE(OasisWriter(_db, _db.techDB()).writeLayout(_topIdx, _file, false, 0));
+        std::ifstream gds(gdsFile, std::ios::binary | std::ios::ate);
+        std::ifstream oas(_file, std::ios::binary | std::ios::ate);
+        // The repetitions alone, without the CBLOCKs, are several times smaller than a BOUNDARY per rectangle
+        EXPECT_LT(5 * static_cast<std::streamoff>(oas.tellg()), static_cast<std::streamoff>(gds.tellg()));
+        std::remove(gdsFile.c_str());
+    }
+    TEST_F(TestOasis, gdsBatch)
+    {
+        const IndexType subIdx = 0;
+        GdsBatchWriter writer(_db, _db.techDB());
+        EXPECT_EQ(writer.uniqueCells({_topIdx, subIdx, _topIdx}, true), std::vector<IndexType>({subIdx, _topIdx}));
+        EXPECT_EQ(writer.uniqueCells({_topIdx, subIdx}, false), std::vector<IndexType>({_topIdx, subIdx}));
+        // Each file is read back as the flattened rectangles of its circuit
+        const std::vector<IndexType> cktIdxs = {_topIdx, subIdx, _topIdx};
+        const std::vector<std::string> files = {_file + ".top.gds", _file + ".dev.gds", _file + ".top.gds.gz"};
+        EXPECT_EQ(writer.writeGdsLayouts(cktIdxs, files, true), 3u);
+        const IndexType readIdx = _db.allocateCkt();
+        for (IndexType fileIdx = 0; fileIdx < files.size(); ++fileIdx)
+        {
+            _db.subCkt(readIdx).layout().clear();
+            _db.subCkt(readIdx).parseGDS(files[fileIdx]);
+            const auto &expected = _db.subCkt(cktIdxs[fileIdx]).layout();
+            EXPECT_EQ(rects(_db.subCkt(readIdx).layout()), rects(expected));
+            std::remove(files[fileIdx].c_str());
+        }
+        // The merged library has each cell once
+        const std::string merged = _file + ".merged.gds";
+        ASSERT_TRUE(writer.writeMergedLibrary({_topIdx, subIdx}, merged, true));
+        {
+            GdsMappedLibrary library(merged);
+            ASSERT_TRUE(library.valid());
+            EXPECT_EQ(library.numCells(), 2u);
+            EXPECT_EQ(library.topCellName(), "top");
+            for (IndexType cktIdx : {subIdx, _topIdx})
+            {
+                Layout layout;
+                layout.init(_db.techDB().numLayers());
+                ASSERT_TRUE(library.readCell(_db.subCkt(cktIdx).name(), layout, _db.techDB()));
+                EXPECT_EQ(rects(layout), rects(_db.subCkt(cktIdx).layout()));
+            }
+        }
+        std::remove(merged.c_str());
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "parser/RunSpec.h"
+
+extern std::string UNITTEST_TOP_DIR;
+
+PROJECT_NAMESPACE_BEGIN
+
+namespace unittest
+{
+    /// @brief test the JSON run specification on files written into the test data directory
+    class TestRunSpec : public ::testing::Test
+    {
+        protected:
+            void TearDown() override
+            {
+                std::remove(fileName().c_str());
+                std::remove((fileName() + ".out").c_str());
+            }
+            std::string fileName() const { return UNITTEST_TOP_DIR + "/runSpecTest.json"; }
+            bool read(const std::string &text, RunSpec &spec) const
+            {
+                {
+                    std::ofstream os(fileName());
+                    os << text;
+                }
+                return spec.read(fileName());
+            }
+            static std::string slurp(const std::string &fileName)
+            {
+                std::ifstream is(fileName);
+                std::stringstream buffer;
+                buffer << is.rdbuf();
+                return buffer.str();
+            }
+    };
+
+    TEST_F(TestRunSpec, values)
+    {
+        RunSpec spec;
+        ASSERT_TRUE(read("{\n"
+                         "  \"resultDir\" : \"./ota1/\",\n"
+                         "  \"hspice_netlist\": \"a \\\"b\\\" \\\\ c\\n\\u00e9\",\n"
+                         "  \"nativePcell\" : true, \"dumpRouteGds\" : false,\n"
+                         "  \"numWorkers\" : -4.5e1,\n"
+                         "  \"reflowCacheDir\" : null,\n"
+                         "  \"vddNetNames\" : [\"VDD\", \"vdda\"],\n"
+                         "  \"mixed\" : [\"VDD\", 1],\n"
+                         "  \"empty\" : [],\n"
+                         "  \"nested\" : {\"a\" : [1, {\"b\" : null}], \"c\" : \"}\"},\n"
+                         "  \"resultDir\" : \"./ota2/\"\n"
+                         "}\n", spec));
+        // The later duplicate wins
+        EXPECT_EQ(spec.string("resultDir"), "./ota2/");
+        EXPECT_EQ(spec.string("hspice_netlist"), "a \"b\" \\ c\n\xc3\xa9");
+        EXPECT_TRUE(spec.boolean("nativePcell", false));
+        EXPECT_FALSE(spec.boolean("dumpRouteGds", true));
+        // The other kinds give the defaults
+        EXPECT_TRUE(spec.has("numWorkers"));
+        EXPECT_EQ(spec.string("numWorkers", "none"), "none");
+        EXPECT_TRUE(spec.boolean("numWorkers", true));
+        EXPECT_FALSE(spec.has("reflowCacheDir"));
+        EXPECT_FALSE(spec.has("missing"));
+        EXPECT_EQ(spec.strings("vddNetNames", {}), std::vector<std::string>({"VDD", "vdda"}));
+        EXPECT_EQ(spec.strings("mixed", {"x"}), std::vector<std::string>({"x"}));
+        EXPECT_TRUE(spec.strings("empty", {"x"}).empty());
+        EXPECT_TRUE(spec.has("nested"));
+        EXPECT_EQ(spec.string("nested", "object"), "object");
+        EXPECT_TRUE(read("{ }", spec));
+        EXPECT_FALSE(spec.has("resultDir"));
+    }
+
+    TEST_F(TestRunSpec, invalid)
+    {
+        RunSpec spec;
+        for (const char *text : {"", "[]", "{\"a\" : 1,}", "{\"a\" : 1", "{\"a\" 1}", "{\"a\" : 1x}", "{\"a\" : tru}", "{\"a\" : \"b}", "{\"a\" : \"\\u12\"}",
+                "{\"a\" : [1, 2}", "{\"a\" : 1} {}", "{a : 1}"})
+        {
+            EXPECT_FALSE(read(text, spec)) << text;
+            EXPECT_FALSE(spec.has("a")) << text;
+        }
+        EXPECT_FALSE(spec.read(UNITTEST_TOP_DIR + "/noSuchRunSpec.json"));
+    }
+
+    TEST_F(TestRunSpec, writeBack)
+    {
+        RunSpec spec;
+        ASSERT_TRUE(read("{\"resultDir\" : \"./ota1/\", \"numWorkers\" : 4, \"flags\" : {\"x\" : [true]}, \"checkpointDir\" : \"ckpt\"}", spec));
+        spec.setJson("checkpointDir", "null");
+        spec.setJson("resumeCheckpoint", RunSpec::quote("dir/\"native\".mfdb\n"));
+        const std::string outName = fileName() + ".out";
+        ASSERT_TRUE(spec.write(outName));
+        // The values not set are written as they were read, in the order they were read, and the new keys after them
+        const std::string text = slurp(outName);
+        EXPECT_NE(text.find("\"numWorkers\" : 4"), std::string::npos);
+        EXPECT_NE(text.find("\"flags\" : {\"x\" : [true]}"), std::string::npos);
+        EXPECT_LT(text.find("\"resultDir\""), text.find("\"checkpointDir\""));
+        EXPECT_LT(text.find("\"checkpointDir\""), text.find("\"resumeCheckpoint\""));
+        RunSpec written;
+        ASSERT_TRUE(written.read(outName));
+        EXPECT_EQ(written.string("resultDir"), "./ota1/");
+        EXPECT_FALSE(written.has("checkpointDir"));
+        EXPECT_EQ(written.string("resumeCheckpoint"), "dir/\"native\".mfdb\n");
+    }
+}
+
+PROJECT_NAMESPACE_END
@@ -67,6 +67,41 @@ namespace unittest
         EXPECT_EQ(techDB.dbLayerToPdk(10), 25);
         EXPECT_EQ(techDB.pdkLayerToDb(25), 10);
         EXPECT_EQ(techDB.layerNameToIdx("M5"), 10);
+
+        // A layer out of the order of the tech layers is rejected
+        const IndexType numLayers = techDB.numLayers();
+        EXPECT_EQ(techDB.addNewLayer(1, "PO2"), INDEX_TYPE_MAX);
+        EXPECT_EQ(techDB.numLayers(), numLayers);
+        EXPECT_EQ(techDB.layerNameToIdx("PO2"), INDEX_TYPE_MAX);
+    }
+    TEST_F(TestSimpleTechParser, rules)
+    {
+        TechDB techDB;
+        ASSERT_TRUE(PROJECT_NAMESPACE::PARSE::parseSimpleTechRules(UNITTEST_TOP_DIR + "./rule.simple.tech", techDB));
+        ASSERT_EQ(techDB.numLayers(), 3u);
+        EXPECT_EQ(techDB.layerNameToIdx("CO"), 1);
+        EXPECT_TRUE(techDB.layerRule(0).empty());
+        EXPECT_EQ(techDB.layerRule(1).minSpacing(), 70);
+        const auto &metal = techDB.layerRule(2);
+        EXPECT_EQ(metal.minWidth(), 50);
+        EXPECT_EQ(metal.minArea(), 10000);
+        ASSERT_TRUE(metal.hasSpacingTable());
+        EXPECT_EQ(metal.spacing(50, 0), 50);
+        EXPECT_EQ(metal.spacing(50, 300), 60);
+        EXPECT_EQ(metal.spacing(100, 300), 60); // Not wider than 0.10
+        EXPECT_EQ(metal.spacing(120, 300), 80);
+        EXPECT_EQ(metal.spacing(120, 200), 50); // Not longer than 0.20
+        EXPECT_EQ(metal.maxSpacing(), 80);
+        // CO connects the layers before and after it in the file
+        ASSERT_TRUE(techDB.isCutLayer(1));
+        EXPECT_FALSE(techDB.isCutLayer(2));
+        EXPECT_EQ(techDB.cutConnections(1), std::vector<IndexType>({0, 2}));
+        // Only the rules of the layers already in the technology
+        TechDB layers;
+        layers.addNewLayer(21, "M1");
+        ASSERT_TRUE(PROJECT_NAMESPACE::PARSE::parseSimpleTechRules(UNITTEST_TOP_DIR + "./rule.simple.tech", layers));
+        ASSERT_EQ(layers.numLayers(), 1u);
+        EXPECT_EQ(layers.layerRule(0).minWidth(), 50);
     }
 }
 
@@ -8,7 +8,6 @@ import subprocess
 import magicalFlow
 import S3DET
 import os
-import ConstGenPy
 
 class Constraint(object):
     def __init__(self, magicalDB):
@@ -18,31 +17,80 @@ class Constraint(object):
         self.s3det = S3DET.S3DET(self.mDB)
 
     def genConstraint(self, cktIdx, dirName):
-        cktname = self.dDB.subCkt(cktIdx).name
-        if not os.path.isfile(dirName+cktname+'.sym'):
-            if self.primaryCell(cktIdx):
+        """
+        @brief generate the symmetry constraints of a circuit into its constraint store
+        @return the dict of symmetric node names
+        """
+        ckt = self.dDB.subCkt(cktIdx)
+        cktname = ckt.name
+        if not ckt.constraint().isSymGenerated():
+            if os.path.isfile(dirName+cktname+'.sym'):
+                # Constraints provided by the user or by an earlier run
+                self.loadSym(cktIdx, dirName)
+            elif self.primaryCell(cktIdx):
                 #pass
-                self.primarySym(cktIdx, dirName)
+                if self.mDB.params.nativeConstGen:
+                    self.primarySymNative(cktIdx)
+                    if self.mDB.params.dumpConstraintFiles:
+                        self.dumpSym(cktIdx, dirName)
+                else:
+                    self.primarySym(cktIdx, dirName)
+                    self.loadSym(cktIdx, dirName) # ConstGen only writes files
                 #print "%s is a primary cell, generating constraints." % cktname
-                #print "Constraints saved at %s.sym" % cktname 
             else:
                 self.s3det.systemSym(cktIdx, dirName)
+                if self.mDB.params.dumpConstraintFiles:
+                    self.dumpSym(cktIdx, dirName)
                 #print "%s is not a primary cell." % cktname
-                #print "Constraints saved at %s.sym" % cktname 
-        return self.parseSym(cktIdx, dirName)
+        return self.symDict(cktIdx)
 
-    def parseSym(self, cktIdx, dirName):
-        cktname = self.dDB.subCkt(cktIdx).name
+    def symDict(self, cktIdx):
+        """
+        @brief the symmetric node pairs by names
+        """
+        ckt = self.dDB.subCkt(cktIdx)
+        cons = ckt.constraint()
         symDict = dict()
-        symFile = dirName + cktname + ".sym"
-        with open(symFile) as fin:
-            lines = fin.readlines()
-            for line in lines:
-                cellNames = line.split()
-                if len(cellNames) > 1:
-                    symDict[cellNames[0]] = cellNames[1]
+        for i in range(cons.numSymPairs()):
+            nodeA, nodeB = cons.symPair(i)
+            symDict[ckt.node(nodeA).name] = ckt.node(nodeB).name
         return symDict
 
+    def loadSym(self, cktIdx, dirName):
+        """
+        @brief read .sym and .symnet files into the constraint store
+        """
+        ckt = self.dDB.subCkt(cktIdx)
+        cons = ckt.constraint()
+        cons.clearSym()
+        nodeIdx = dict((ckt.node(idx).name, idx) for idx in range(ckt.numNodes()))
+        netIdx = dict((ckt.net(idx).name, idx) for idx in range(ckt.numNets()))
+        with open(dirName + ckt.name + ".sym") as fin:
+            for line in fin:
+                names = line.split()
+                if len(names) > 1:
+                    cons.addSymPair(nodeIdx[names[0]], nodeIdx[names[1]])
+                elif len(names) == 1:
+                    cons.addSelfSym(nodeIdx[names[0]])
+        symNetFile = dirName + ckt.name + ".symnet"
+        if os.path.isfile(symNetFile):
+            with open(symNetFile) as fin:
+                for line in fin:
+                    names = line.split()
+                    if len(names) > 1:
+                        cons.addSymNetPair(netIdx[names[0]], netIdx[names[1]])
+                    elif len(names) == 1:
+                        cons.addSelfSymNet(netIdx[names[0]])
+        cons.markSymGenerated()
+
+    def dumpSym(self, cktIdx, dirName):
+        """
+        @brief write the constraint store as .sym and .symnet files
+        """
+        ckt = self.dDB.subCkt(cktIdx)
+        dumpSymFile(ckt, dirName + ckt.name + ".sym")
+        dumpSymNetFile(ckt, dirName + ckt.name + ".symnet")
+
     def primaryCell(self, cktIdx):
         """
         @brief Checking if cell is primary
@@ -57,7 +105,20 @@ class Constraint(object):
                 return False
         return True
 
+    def primarySymNative(self, cktIdx):
+        """
+        @brief generate the constraints of a primary cell in C++, straight into its constraint store
+        """
+        primarySym = magicalFlow.PrimarySym(self.dDB)
+        powerNets = S3DET.ignore_set.union(self.mDB.params.vddNetNames, self.mDB.params.vssNetNames)
+        primarySym.generate(cktIdx, list(powerNets))
+        primarySym.apply(self.dDB.subCkt(cktIdx).constraint())
+
     def primarySym(self, cktIdx, dirName):
+        """
+        @brief generate the constraint files of a primary cell with ConstGen
+        """
+        import ConstGenPy
         constGen = ConstGenPy.ConstGen()
         ckt = self.dDB.subCkt(cktIdx)
         phyDB = self.dDB.phyPropDB()
@@ -147,3 +208,27 @@ class Constraint(object):
         for net in range(ckt.numNets()):
             fout.write("NET\n%d\n%s\n" % (net, ckt.net(net).name))
 
+
+def dumpSymFile(ckt, filename):
+    """
+    @brief write the symmetric nodes of a circuit in the .sym format
+    """
+    cons = ckt.constraint()
+    with open(filename, "w") as symFile:
+        for i in range(cons.numSymPairs()):
+            nodeA, nodeB = cons.symPair(i)
+            symFile.write("%s %s\n" % (ckt.node(nodeA).name, ckt.node(nodeB).name))
+        for i in range(cons.numSelfSyms()):
+            symFile.write("%s\n" % ckt.node(cons.selfSym(i)).name)
+
+def dumpSymNetFile(ckt, filename):
+    """
+    @brief write the symmetric nets of a circuit in the .symnet format
+    """
+    cons = ckt.constraint()
+    with open(filename, "w") as netFile:
+        for i in range(cons.numSymNetPairs()):
+            netA, netB = cons.symNetPair(i)
+            netFile.write("%s %s\n" % (ckt.net(netA).name, ckt.net(netB).name))
+        for i in range(cons.numSelfSymNets()):
+            netFile.write("%s\n" % ckt.net(cons.selfSymNet(i)).name)
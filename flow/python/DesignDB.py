@@ -488,7 +488,7 @@ class Netlist_parser(object):
                     inst.parameters['multi'] = inst.parameters['m']
                 if inst.reference in nmos_set: 
                     nchId = self.db.phyPropDB().allocateNch()
-                    nch = self.db.phyPropDB().nch(nchId)
+                    nch = self.db.phyPropDB().mutableNch(nchId)
                     nch.length = self.get_value(inst.parameters['l'], unit=1e-12)
                     nch.width = self.get_value(inst.parameters['w'], unit=1e-12)
                     nch.numFingers = self.get_value(inst.parameters['nf'], unit=1)
@@ -501,7 +501,7 @@ class Netlist_parser(object):
                     self.db.subCkt(subckt_idx).implType = magicalFlow.ImplTypePCELL_Nch
                 elif inst.reference in pmos_set: 
                     pchId = self.db.phyPropDB().allocatePch()
-                    pch = self.db.phyPropDB().pch(pchId)
+                    pch = self.db.phyPropDB().mutablePch(pchId)
                     pch.length = self.get_value(inst.parameters['l'], unit=1e-12)
                     pch.width = self.get_value(inst.parameters['w'], unit=1e-12)
                     pch.numFingers = self.get_value(inst.parameters['nf'], unit=1)
@@ -516,7 +516,7 @@ class Netlist_parser(object):
                     self.db.subCkt(subckt_idx).implType = magicalFlow.ImplTypePCELL_Pch
                 elif inst.reference in resistor_set: 
                     resId = self.db.phyPropDB().allocateRes()
-                    res = self.db.phyPropDB().resistor(resId)
+                    res = self.db.phyPropDB().mutableResistor(resId)
                     res.lr = self.get_value(inst.parameters['lr'], unit=1e-12)
                     res.wr = self.get_value(inst.parameters['wr'], unit=1e-12)
                     if 'series' in inst.parameters.keys():
@@ -535,7 +535,7 @@ class Netlist_parser(object):
                     self.db.subCkt(subckt_idx).implType = magicalFlow.ImplTypePCELL_Res
                 elif inst.reference in capacitor_set:
                     capId = self.db.phyPropDB().allocateCap()
-                    cap = self.db.phyPropDB().capacitor(capId)
+                    cap = self.db.phyPropDB().mutableCapacitor(capId)
                     cap.w = self.get_value(inst.parameters['w'], unit=1e-12)
                     cap.spacing = self.get_value(inst.parameters['s'], unit=1e-12)
                     cap.numFingers = self.get_value(inst.parameters['nr'], unit=1)
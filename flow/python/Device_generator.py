@@ -145,7 +145,6 @@ class Device_generator(object):
 
     def readGDS(self, cktIdx, dirname):
         ckt = self.dDB.subCkt(cktIdx)
-        ckt.setTechDB(self.tDB)
         cirname = ckt.name
         fileName = dirname + cirname + '.gds'
         ckt.parseGDS(fileName)
@@ -9,9 +9,15 @@ import magicalFlow
 import Device_generator
 import Constraint
 import PnR
+import Placer
 import StdCell
+import Scheduler
+from concurrent.futures import ThreadPoolExecutor
+import json
+import queue
 import subprocess
 import time
+import os
 
 
 class Flow(object):
@@ -23,21 +29,297 @@ class Flow(object):
         self.pnrs = []
         self.runtime = 0
 
+    def reportBindingFallbacks(self):
+        """
+        @brief tell once at startup which requested exchanges the placer and router bindings do not provide, and what the flow does instead
+        """
+        if self.params.routeInMemory and not Placer.routerTakesShapes():
+            print("[W] The router binding has no loadShapes/routedShapes: the layouts go to and from the router through the .place.gds and .route.gds files")
+        if not Placer.placerTakesPathArrays():
+            if Placer.placerTakesPathWeights():
+                print("[W] The placer binding has no addSignalPaths: the signal paths are added one pin at a time")
+            else:
+                print("[W] The placer binding has no addSignalPaths/setSignalPathWeight: the signal paths are added one pin at a time, without their weights")
+
     def run(self):
         """
         @brief the main function to run the flow
         @return if successful
         """
         self.resultName = self.mDB.params.resultDir
+        if self.params.traceFile is not None:
+            magicalFlow.Tracer.enable(True)
+            if self.params.traceMemory and hasattr(magicalFlow, 'MemoryUsage'):
+                magicalFlow.Tracer.enableMemoryTracking(True)
+        if self.params.asyncLogging:
+            magicalFlow.MsgPrinter.startAsync()
+        self.reportBindingFallbacks()
+        if self.params.deviceLayoutCacheDir is not None:
+            if not os.path.isdir(self.params.deviceLayoutCacheDir):
+                os.makedirs(self.params.deviceLayoutCacheDir)
+            self.dDB.deviceLayoutCache().setCacheDir(self.params.deviceLayoutCacheDir)
+        self.saveCheckpoint("parse")
+        self.traceMemory("parse")
         topCktIdx = self.mDB.topCktIdx() # The index of the topckt
+        self.restoreCachedSubtrees(topCktIdx)
+        if self.params.floorplanEstimate:
+            self.estimateFloorplan(topCktIdx)
+            if self.params.floorplanOnly:
+                self.writeTrace()
+                magicalFlow.MsgPrinter.flush()
+                return True
+        self.dispatchRemoteSubtrees(topCktIdx)
         start = time.time()
-        self.implCktLayout(topCktIdx)
+        if not self.dDB.subCkt(topCktIdx).isImpl:
+            self.implCktLayout(topCktIdx)
         end = time.time()
         print("runtime ", end - start)
+        self.traceMemory("place")
         for pnr in self.pnrs:
-            pnr.routeOnly()
+            with magicalFlow.TraceScope(self.dDB.subCkt(pnr.cktIdx).name, "route"):
+                pnr.routeOnly()
+        self.storeImplementedSubtrees()
+        self.storeSubtreeResult(topCktIdx)
+        self.exportLayouts(topCktIdx)
+        self.traceMemory("route")
+        self.writeTrace()
+        magicalFlow.MsgPrinter.flush()
         return True
 
+    def writeTrace(self):
+        """
+        @brief write the Chrome trace of the run into params.traceFile and print the summary per stage
+        """
+        if self.params.traceFile is None:
+            return
+        if not magicalFlow.Tracer.writeChromeTrace(self.params.traceFile):
+            print("[W] Cannot write trace %s" % self.params.traceFile)
+        print(magicalFlow.Tracer.summary())
+
+    def estimateFloorplan(self, topCktIdx):
+        """
+        @brief estimate the sizes of the circuits under a top circuit bottom-up, without generating the devices or implementing the real layouts.
+        The devices take their cached layout boundaries, or their area model. Each circuit is then floorplanned by a fast placement of its nodes at the sizes of its sub circuits,
+        and its parents see the extent of that floorplan.
+        The estimates are informational: they are printed and returned, and the implementation after them does not read them
+        @return the magicalFlow.FloorplanEstimator with the sizes
+        """
+        estimator = magicalFlow.FloorplanEstimator(self.dDB)
+        estimator.setUtilization(self.params.floorplanUtilization)
+        estimator.setAspectRatio(self.params.floorplanAspectRatio)
+        # Sizes the estimator once for all the circuits, so that the jobs below only set the entries of their own circuits
+        estimator.estimate(topCktIdx)
+        def floorplanOneCkt(cktIdx):
+            ckt = self.dDB.subCkt(cktIdx)
+            if ckt.isImpl or self.isCktStdCells(cktIdx) or ckt.numNodes() == 0:
+                return None
+            estimator.estimateCkt(cktIdx)
+            # The sub circuits are done before this job starts. Their boxes are copied out before placing
+            boxes = []
+            for nodeIdx in range(ckt.numNodes()):
+                node = ckt.node(nodeIdx)
+                if node.isLeaf():
+                    boxes.append((0, 0, 0, 0))
+                    continue
+                bBox = estimator.boundary(node.graphIdx)
+                boxes.append((bBox.xLo, bBox.yLo, bBox.xHi, bBox.yHi))
+            pnr = PnR.PnR(self.mDB)
+            with magicalFlow.TraceScope(ckt.name, "floorplan"):
+                size = Placer.Placer(self.mDB, cktIdx, self.resultName, pnr.gridStep, pnr.halfMetWid).floorplan(boxes)
+            if size[0] > 0 and size[1] > 0:
+                estimator.setSize(cktIdx, size[0], size[1])
+            return size
+        scheduler = Scheduler.Scheduler(self.dDB, self.params.numWorkers)
+        for cktIdx, size in scheduler.run(topCktIdx, floorplanOneCkt, self.isCktExpanded):
+            if size is None:
+                continue
+            print("Flow: estimated %s %d x %d from %s" % (self.dDB.subCkt(cktIdx).name, estimator.width(cktIdx), estimator.height(cktIdx), estimator.source(cktIdx).name))
+        return estimator
+
+    def reflowFile(self, cktIdx):
+        """
+        @brief the file keeping the implementation of a circuit in params.reflowCacheDir, named by its content digest
+        """
+        return os.path.join(self.params.reflowCacheDir, self.cktHashes.hashString(cktIdx) + ".mfsub")
+
+    def restoreCachedSubtrees(self, topCktIdx):
+        """
+        @brief restore the circuits whose content digests are unchanged since a previous run, from params.reflowCacheDir.
+        The digests are taken before anything is implemented, so that they are the same when the implemented circuits are stored
+        """
+        if self.params.reflowCacheDir is None:
+            return
+        if not os.path.isdir(self.params.reflowCacheDir):
+            os.makedirs(self.params.reflowCacheDir)
+        # The flow settings changing the layouts. The paths of the results and the bookkeeping are left out
+        volatile = set(['resultDir', 'numWorkers', 'checkpointDir', 'resumeCheckpoint', 'reflowCacheDir', 'deviceLayoutCacheDir', 'dumpConstraintFiles', 'dumpRouteGds',
+            'remoteWorkers', 'remoteJobDir', 'subtreeResult'])
+        # The input files by their contents rather than their paths, so that an edited netlist or technology file invalidates the cache
+        inputFiles = set(['spectre_netlist', 'hspice_netlist', 'simple_tech_file', 'techfile', 'ruleTechFile', 'lef', 'stdCellGdsLibrary'])
+        settings = sorted((key, repr(value)) for key, value in vars(self.params).items() if key not in volatile and key not in inputFiles)
+        for key in sorted(inputFiles):
+            filename = getattr(self.params, key, None)
+            if filename:
+                settings.append((key, magicalFlow.CktContentHash.fileHash(filename)))
+        self.cktHashes = magicalFlow.CktContentHash(self.dDB)
+        self.cktHashes.build(magicalFlow.CktContentHash.stringHash(repr(settings)))
+        hierarchy = self.dDB.hierarchy()
+        visited = set()
+        stack = [topCktIdx]
+        while stack:
+            cktIdx = stack.pop()
+            if cktIdx in visited or not self.isCktExpanded(cktIdx):
+                continue
+            visited.add(cktIdx)
+            if self.dDB.loadSubtreeCheckpoint(cktIdx, self.reflowFile(cktIdx)):
+                print("Flow: restored unchanged circuit", self.dDB.subCkt(cktIdx).name)
+                continue
+            stack.extend(hierarchy.children(cktIdx))
+
+    def storeImplementedSubtrees(self):
+        """
+        @brief keep the circuits implemented in this run in params.reflowCacheDir, for the later runs
+        """
+        if self.params.reflowCacheDir is None:
+            return
+        for pnr in self.pnrs:
+            if not self.dDB.saveSubtreeCheckpoint(pnr.cktIdx, self.reflowFile(pnr.cktIdx)):
+                print("[W] Cannot keep circuit %s in %s" % (self.dDB.subCkt(pnr.cktIdx).name, self.params.reflowCacheDir))
+
+    def exclusiveSubtrees(self, topCktIdx):
+        """
+        @brief find the sub circuits of the top circuit whose subtrees share no circuit to implement with the rest of the design, so that they may be implemented apart.
+        The devices and the standard cells may be shared, as their layouts are generated the same way anywhere
+        @return the indices of the roots of the subtrees not implemented yet
+        """
+        hierarchy = self.dDB.hierarchy()
+        trees = dict()
+        owners = dict() # The sub circuits of the top reaching each circuit to implement
+        for childIdx in hierarchy.children(topCktIdx):
+            tree = []
+            stack = [childIdx]
+            while stack:
+                cktIdx = stack.pop()
+                if cktIdx in tree:
+                    continue
+                tree.append(cktIdx)
+                stack.extend(hierarchy.children(cktIdx))
+            trees[childIdx] = [cktIdx for cktIdx in tree if self.isCktExpanded(cktIdx)]
+            for cktIdx in trees[childIdx]:
+                owners.setdefault(cktIdx, set()).add(childIdx)
+        roots = []
+        for childIdx, tree in trees.items():
+            if not self.isCktExpanded(childIdx) or self.dDB.subCkt(childIdx).isImpl:
+                continue
+            if all(len(owners[cktIdx]) == 1 for cktIdx in tree):
+                roots.append(childIdx)
+        return roots
+
+    def dispatchRemoteSubtrees(self, topCktIdx):
+        """
+        @brief implement the exclusive subtrees under the top circuit by params.remoteWorkers, and merge the results back.
+        Each subtree is written as a design checkpoint of its own, with only the circuits and the physical properties it uses. A worker flow resumes from it with the parameters of this flow,
+        parsing the same technology file, and writes the implementation of its root as a subtree snapshot. The snapshot restores the layouts and the io pins into the circuits here,
+        so that the local flow takes them as implemented. The files go through params.remoteJobDir, which the workers should see at the same path.
+        The subtrees failing remotely are implemented locally
+        """
+        if not self.params.remoteWorkers or self.dDB.subCkt(topCktIdx).isImpl:
+            return
+        roots = self.exclusiveSubtrees(topCktIdx)
+        if not roots:
+            return
+        jobDir = self.params.remoteJobDir
+        if jobDir is None:
+            jobDir = os.path.join(self.resultName, "remote")
+        if not os.path.isdir(jobDir):
+            os.makedirs(jobDir)
+        # The sub designs are written here before dispatching, as the hierarchy cache of the design is not shared with the threads
+        jobs = []
+        for cktIdx in roots:
+            prefix = os.path.join(jobDir, "%d_%s" % (cktIdx, self.dDB.subCkt(cktIdx).name))
+            if not self.dDB.saveSubDesignCheckpoint(cktIdx, prefix + ".mfdb"):
+                print("[W] Cannot write the sub design of %s, implemented locally" % self.dDB.subCkt(cktIdx).name)
+                continue
+            data = dict(vars(self.params))
+            data.update({'resumeCheckpoint' : prefix + ".mfdb", 'subtreeResult' : prefix + ".mfsub", 'remoteWorkers' : [], 'checkpointDir' : None, 'traceFile' : None, 'floorplanOnly' : False})
+            with open(prefix + ".json", 'w') as f:
+                json.dump(data, f)
+            if os.path.exists(prefix + ".mfsub"):
+                os.remove(prefix + ".mfsub")
+            jobs.append((cktIdx, prefix))
+        workers = queue.Queue()
+        for command in self.params.remoteWorkers:
+            workers.put(command)
+        def runJob(job):
+            cktIdx, prefix = job
+            command = workers.get() # Each worker runs one job at a time
+            try:
+                with magicalFlow.TraceScope(self.dDB.subCkt(cktIdx).name, "remote"):
+                    return subprocess.call(command.format(params=prefix + ".json"), shell=True)
+            finally:
+                workers.put(command)
+        with ThreadPoolExecutor(max_workers=len(self.params.remoteWorkers)) as pool:
+            status = list(pool.map(runJob, jobs))
+        for (cktIdx, prefix), code in zip(jobs, status):
+            name = self.dDB.subCkt(cktIdx).name
+            if code == 0 and self.dDB.loadSubtreeCheckpoint(cktIdx, prefix + ".mfsub"):
+                print("Flow: merged circuit %s implemented remotely" % name)
+            else:
+                print("[W] Remote job of %s failed with status %d, implemented locally" % (name, code))
+
+    def storeSubtreeResult(self, topCktIdx):
+        """
+        @brief write the implementation of the top circuit into params.subtreeResult, for the flow which dispatched this one
+        """
+        if self.params.subtreeResult is None:
+            return
+        if not self.dDB.saveSubtreeCheckpoint(topCktIdx, self.params.subtreeResult):
+            print("[W] Cannot write the subtree result %s" % self.params.subtreeResult)
+
+    def exportLayouts(self, topCktIdx):
+        """
+        @brief write the routed layouts of the circuits implemented in this run into params.exportGdsDir as <name>.gds, flattened,
+        and every distinct cell under the top circuit into params.exportMergedGds. The files are encoded in parallel while being written
+        """
+        if self.params.exportGdsDir is None and self.params.exportMergedGds is None:
+            return
+        if not hasattr(magicalFlow, 'writeGdsLayouts'):
+            print("[W] No batch GDSII writer, the layouts are not exported")
+            return
+        tDB = self.mDB.techDB
+        if self.params.exportGdsDir is not None:
+            if not os.path.isdir(self.params.exportGdsDir):
+                os.makedirs(self.params.exportGdsDir)
+            cktIdxs = [pnr.cktIdx for pnr in self.pnrs]
+            filenames = [os.path.join(self.params.exportGdsDir, self.dDB.subCkt(cktIdx).name + '.gds') for cktIdx in cktIdxs]
+            numWritten = magicalFlow.writeGdsLayouts(cktIdxs, filenames, self.dDB, tDB, False)
+            if numWritten < len(cktIdxs):
+                print("[W] %d of %d layouts not exported into %s" % (len(cktIdxs) - numWritten, len(cktIdxs), self.params.exportGdsDir))
+        if self.params.exportMergedGds is not None:
+            if not magicalFlow.writeMergedGdsLibrary([topCktIdx], self.params.exportMergedGds, self.dDB, tDB, True):
+                print("[W] Cannot write the merged library %s" % self.params.exportMergedGds)
+
+    def traceMemory(self, stage):
+        """
+        @brief sample the memory footprint of the design after a stage into the trace, per component, as "memory <stage> <component>"
+        """
+        if not hasattr(magicalFlow, 'MemoryUsage') or not magicalFlow.Tracer.memoryTrackingEnabled():
+            return
+        magicalFlow.MemoryUsage.ofDesign(self.dDB).trace(stage)
+
+    def saveCheckpoint(self, stage):
+        """
+        @brief write a snapshot of the design after a stage into params.checkpointDir, as <stage>.mfdb
+        Only the snapshot after parsing is written: the placement state the router needs lives in the PnR objects and is not part of a snapshot
+        """
+        if self.params.checkpointDir is None:
+            return
+        if not os.path.isdir(self.params.checkpointDir):
+            os.makedirs(self.params.checkpointDir)
+        checkpoint = os.path.join(self.params.checkpointDir, stage + ".mfdb")
+        if not self.dDB.saveCheckpoint(checkpoint):
+            print("[W] Cannot write checkpoint %s" % checkpoint)
+
     def generateConstraints(self):
         for cktIdx in range(self.dDB.numCkts()):
             ckt = self.dDB.subCkt(cktIdx) #magicalFlow.CktGraph
@@ -45,7 +327,7 @@ class Flow(object):
                 continue
             if self.isCktStdCells(cktIdx):
                 continue
-            self.symDict = self.constraint.genConstraint(cktIdx, self.resultName)
+            self.constraint.genConstraint(cktIdx, self.resultName)
 
 
     def isCktStdCells(self, cktIdx):
@@ -55,60 +337,111 @@ class Flow(object):
             return False
 
 
-    def setup(self, cktIdx):
+    def setup(self, cktIdx, symDict):
         ckt = self.dDB.subCkt(cktIdx) 
+        devices = [] # The sub circuit and the flip of each device instance, in order
         for nodeIdx in range(ckt.numNodes()):
             flipCell = False
             cktNode = ckt.node(nodeIdx)
             # Flip cell if is in the "right" half device of symmetry
-            if cktNode.name in self.symDict.values():
+            if cktNode.name in symDict.values():
                 flipCell = True
             if cktNode.isLeaf():
                 continue
             subCktIdx = self.dDB.subCkt(cktIdx).node(nodeIdx).graphIdx
-            devGen = Device_generator.Device_generator(self.mDB)
             if magicalFlow.isImplTypeDevice(self.dDB.subCkt(subCktIdx).implType):
-                if flipCell:
-                    devGen.generateDevice(subCktIdx, self.resultName+'/gds/', True) #FIXME: directly add to the database
-                else:
-                    devGen.generateDevice(subCktIdx, self.resultName+'/gds/', False)
-                devGen.readGDS(subCktIdx, self.resultName+'/gds/')
+                devices.append((subCktIdx, flipCell))
             else:
                 if flipCell:
                     cktNode.flipVertFlag = True
+        self.setupDevices(devices)
+
+    def pcellGenerator(self):
+        """
+        @brief the C++ device generator, or None for the device generator of the PDK
+        """
+        if not self.params.nativePcell or not hasattr(magicalFlow, 'PcellGenerator'):
+            return None
+        return magicalFlow.PcellGenerator(self.dDB)
+
+    def setupDevices(self, devices):
+        """
+        @brief generate the layouts of the device instances of a circuit
+        The devices the C++ generator supports are generated in parallel, in rounds of distinct circuits: round k has the k-th instance of each circuit,
+        so that each circuit ends with the layout of its last instance, as generated one by one
+        """
+        pcell = self.pcellGenerator()
+        rounds = []
+        numInstances = dict()
+        for subCktIdx, flipCell in devices:
+            # The devices with the same properties share one generated layout
+            if pcell is not None and pcell.canGenerate(subCktIdx):
+                k = numInstances.get(subCktIdx, 0)
+                numInstances[subCktIdx] = k + 1
+                if k == len(rounds):
+                    rounds.append([])
+                rounds[k].append((subCktIdx, flipCell))
+                continue
+            if self.dDB.restoreDeviceLayout(subCktIdx, flipCell):
+                continue
+            devGen = Device_generator.Device_generator(self.mDB)
+            if flipCell:
+                devGen.generateDevice(subCktIdx, self.resultName+'/gds/', True) #FIXME: directly add to the database
+            else:
+                devGen.generateDevice(subCktIdx, self.resultName+'/gds/', False)
+            devGen.readGDS(subCktIdx, self.resultName+'/gds/')
+            self.dDB.cacheDeviceLayout(subCktIdx, flipCell)
+        for devRound in rounds:
+            pending = [(subCktIdx, flipCell) for subCktIdx, flipCell in devRound if not self.dDB.restoreDeviceLayout(subCktIdx, flipCell)]
+            pcell.generateAll([subCktIdx for subCktIdx, _ in pending], [flipCell for _, flipCell in pending])
+            for subCktIdx, flipCell in pending:
+                self.dDB.cacheDeviceLayout(subCktIdx, flipCell)
+
+    def isCktExpanded(self, cktIdx):
+        """
+        @brief whether the circuits instantiated by a circuit are implemented before it
+        """
+        ckt = self.dDB.subCkt(cktIdx)
+        return not magicalFlow.isImplTypeDevice(ckt.implType) and not self.isCktStdCells(cktIdx)
 
     def implCktLayout(self, cktIdx):
         """
-        @brief implement the circuit layout
+        @brief implement the circuit layout, after the layouts of all the circuits it instantiates
+        The independent sub circuits are dispatched to params.numWorkers workers. They only overlap in the bindings releasing the GIL, see Scheduler
+        """
+        scheduler = Scheduler.Scheduler(self.dDB, self.params.numWorkers)
+        for subCktIdx, pnr in scheduler.run(cktIdx, self.implOneCkt, self.isCktExpanded):
+            if pnr is None:
+                continue
+            self.runtime += pnr.runtime
+            self.pnrs.append(pnr)
+
+    def implOneCkt(self, cktIdx):
+        """
+        @brief implement the circuit layout, assuming its sub circuits are implemented
+        @return the PnR of the circuit, or None for devices and standard cells
         """
         dDB = self.mDB.designDB.db #c++ database
         ckt = dDB.subCkt(cktIdx) #magicalFlow.CktGraph
         # If the ckt is a device, generation will be added in setup()
         if magicalFlow.isImplTypeDevice(ckt.implType):
-            Device_generator.Device_generator(self.mDB).generateDevice(cktIdx, self.resultName+'/gds/') #FIXME: directly add to the database
-            return
+            with magicalFlow.TraceScope(ckt.name, "device"):
+                pcell = self.pcellGenerator()
+                if pcell is None or not pcell.generate(cktIdx, False):
+                    Device_generator.Device_generator(self.mDB).generateDevice(cktIdx, self.resultName+'/gds/') #FIXME: directly add to the database
+            return None
         # If the ckt is a standard cell
         # This version only support DFCNQD2BWP and NR2D8BWP, hard-encoded
         # TODO: This should be parsed from the json file
         if self.isCktStdCells(cktIdx):
             StdCell.StdCell(self.mDB).setup(cktIdx, self.resultName)
-            return
-        # If the ckt is actually a circuit instead of a device
-        for nodeIdx in range(ckt.numNodes()):
-            cktNode = ckt.node(nodeIdx) # magicalFlow.CktNode
-            if cktNode.isLeaf(): # Do not go deeper for leaf node
-                continue
-            subCkt = dDB.subCkt(cktNode.graphIdx)
-            if (subCkt.isImpl): # Do not duplicately implement the layout
-                continue
-            self.implCktLayout(cktNode.graphIdx) # Recursively implement all the children
-            ckt = dDB.subCkt(cktIdx) # just to make sure the reference is not messed up
-        # After all the children being implemented. P&R at this circuit
-        ckt = dDB.subCkt(cktIdx) #magicalFlow.CktGraph
-        self.symDict = self.constraint.genConstraint(cktIdx, self.resultName)
-        self.setup(cktIdx)
+            return None
+        # P&R at this circuit. One Constraint per job, as the symmetry detection keeps its graph in the object
+        with magicalFlow.TraceScope(ckt.name, "constraint"):
+            symDict = Constraint.Constraint(self.mDB).genConstraint(cktIdx, self.resultName)
+        self.setup(cktIdx, symDict)
         pnr = PnR.PnR(self.mDB)
-        pnr.placeOnly(cktIdx, self.resultName)
-        self.runtime += pnr.runtime
-        self.pnrs.append(pnr)
+        with magicalFlow.TraceScope(ckt.name, "place"):
+            pnr.placeOnly(cktIdx, self.resultName)
+        return pnr
         #PnR.PnR(self.mDB).implLayout(cktIdx, self.resultName)
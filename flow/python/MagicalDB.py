@@ -11,17 +11,38 @@ import magicalFlow
 class MagicalDB(object):
     def __init__(self, params):
         self.designDB = DesignDB.DesignDB()
+        self._csflow = None
         self.params = params
         self.digitalNetNames = ["clk"]
         self.techDB = magicalFlow.TechDB()
 
     def parse(self):
+        if self.params.resumeCheckpoint is not None:
+            return self.resume(self.params.resumeCheckpoint)
         self.parse_input_netlist(self.params)
         self.parse_simple_techfile(self.params.simple_tech_file)
         self.designDB.db.findRootCkt() # After the parsing, find the root circuit of the hierarchy
+        self.designDB.db.compactConnectivity() # The netlist is complete: pack the pin lists of the nodes and the nets
         self.postProcessing()
         return True
 
+    def resume(self, checkpoint):
+        """
+        @brief load the design from a snapshot written by Flow, instead of parsing the netlist
+        The power and digital nets are already marked in the snapshot. The technology is not part of it and is parsed again.
+        Only a snapshot taken before placement can be resumed, as the placement state the router needs is not saved
+        """
+        if not self.designDB.db.loadCheckpoint(checkpoint):
+            print("[E] Cannot resume from checkpoint %s" % checkpoint)
+            return False
+        rootCktIdx = self.designDB.db.rootCktIdx()
+        if rootCktIdx < self.designDB.db.numCkts() and self.designDB.db.subCkt(rootCktIdx).isImpl:
+            print("[E] Cannot resume from checkpoint %s: the top circuit is already placed. Resume from the snapshot after parsing" % checkpoint)
+            return False
+        self.parse_simple_techfile(self.params.simple_tech_file)
+        self.designDB.db.compactConnectivity()
+        return True
+
     def postProcessing(self):
         self.markPowerNets()
         self.markDigitalNets()
@@ -29,6 +50,9 @@ class MagicalDB(object):
 
     def parse_simple_techfile(self, params):
         magicalFlow.parseSimpleTechFile( params, self.techDB)
+        if self.params.ruleTechFile is not None:
+            magicalFlow.parseSimpleTechRules(self.params.ruleTechFile, self.techDB)
+        self.designDB.db.setTechDB(self.techDB) # Shared by all the circuits
 
     def parse_input_netlist(self, params):
         if (params.hspice_netlist is not None):
@@ -40,29 +64,70 @@ class MagicalDB(object):
         raise ParamException("No input netlist file!")
 
     def read_spectre_netlist(self, sp_netlist):
+        if self.read_native_netlist(sp_netlist, False):
+            return
         self.designDB.read_spectre_netlist(sp_netlist)
 
     def read_hspice_netlist(self, sp_netlist):
+        if self.read_native_netlist(sp_netlist, True):
+            return
         self.designDB.read_hspice_netlist(sp_netlist)
 
+    def read_native_netlist(self, sp_netlist, isHspice):
+        """
+        @brief parse the netlist with the C++ parser, unless params.nativeNetlistParser is off
+        @return whether parsed. If not, the design is reset for the Python parser
+        """
+        if not self.params.nativeNetlistParser:
+            return False
+        if magicalFlow.parseNetlist(sp_netlist, self.designDB.db, isHspice):
+            return True
+        print("[W] The native parser failed on %s, falling back to the Python parser" % sp_netlist)
+        self.designDB = DesignDB.DesignDB()
+        self._csflow = None
+        return False
+
     """
     Current & Signal Flow
     """
+    def csflow(self):
+        """
+        @brief the CSFlow of the design, one for all its placers so that the signal paths it caches are reused across them
+        """
+        if self._csflow is None:
+            self._csflow = magicalFlow.CSFlow(self.designDB.db)
+        return self._csflow
+
     def computeCurrentFlow(self):
-        csflow = magicalFlow.CSFlow(self.designDB.db)
-        for cktIdx in range(self.designDB.db.numCkts()):
-            ckt = self.designDB.db.subCkt(cktIdx)
-            if ckt.implType == magicalFlow.ImplTypeUNSET:
-                csflow.computeCurrentFlow(ckt)
-                with open(self.params.resultDir + ckt.name + '.sigpath','w') as f:
-                    pinNamePaths = csflow.currentPinPaths();
-                    cellNamePaths = csflow.currentCellPaths();
-                    assert len(pinNamePaths) == len(cellNamePaths)
-                    for i in range(len(pinNamePaths)):
-                        assert len(pinNamePaths[i]) == len(cellNamePaths[i])
-                        for j in range(len(pinNamePaths[i])):
-                            f.write(cellNamePaths[i][j] + " " + pinNamePaths[i][j] + " ")
-                        f.write("\n")
+        """
+        @brief store the current paths of the circuits as signal paths in their constraint stores
+        """
+        for result in self.csflow().computeAllCurrentFlows():
+            ckt = self.designDB.db.subCkt(result.cktIdx())
+            cons = ckt.constraint()
+            cons.clearSignalPaths()
+            nodes = result.nodeArray()
+            intNets = result.intNetArray()
+            pathStart = result.pathStartArray()
+            for i in range(result.numCurrentPaths()):
+                cons.allocateSignalPath(False)
+                for k in range(pathStart[i], pathStart[i + 1]):
+                    cons.addPinToSignalPath(int(nodes[k]), int(intNets[k]))
+            if self.params.dumpConstraintFiles:
+                self.dumpSigpathFile(ckt, self.params.resultDir + ckt.name + '.sigpath')
+
+    def dumpSigpathFile(self, ckt, filename):
+        """
+        @brief write the signal paths of a circuit in the .sigpath format
+        """
+        cons = ckt.constraint()
+        with open(filename, 'w') as f:
+            for i in range(cons.numSignalPaths()):
+                for pos in range(cons.signalPathLength(i)):
+                    node = ckt.node(cons.signalPathNode(i, pos))
+                    pinName = self.designDB.db.subCkt(node.graphIdx).net(cons.signalPathIntNet(i, pos)).name
+                    f.write(node.name + " " + pinName + " ")
+                f.write("\n")
     """
     Post-processing
     """
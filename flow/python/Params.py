@@ -20,12 +20,43 @@ class Params:
         self.hspice_netlist = None # Input hspice netlist file
         self.simple_tech_file = "" # Input simple tech file
         self.techfile = ""
+        self.ruleTechFile = None # Simple tech file with the width, spacing and area rules of the layers, in the LEF-like format. Screen the routed layouts against them. None for no screening
         self.lef = ""
         self.vddNetNames = ["VDD", "vdd", "vdda", "vddd"]
         self.vssNetNames = ["VSS", "GND", "vss", "gnd", "vssa", "vssd"]
         self.digitalNetNames = ["clk"]
         self.stdCells = ['SR_Latch_LVT','NR2D8BWP_LVT','BUFFD4BWP_LVT','DFCND4BWP_LVT','INVD4BWP_LVT','DFCNQD2BWP_LVT', 'DFCND4BWP_LVT_stupid']
+        self.stdCellGdsLibrary = None # Read the layouts of the standard cells out of this GDSII library, kept mapped across the cells. None for the stdcell/<name>.route.gds file of each cell
         self.resultDir = None
+        self.dumpConstraintFiles = False # Also write the in-memory constraints as .sym/.symnet/.sigpath files, for debugging
+        self.numWorkers = 1 # The number of sub circuits in progress at once. Only the GDS reading and writing overlap, as the placer and the router hold the GIL
+        self.deviceLayoutCacheDir = None # Keep the generated device layouts in this directory between runs. None for memory only
+        self.nativeNetlistParser = True # Parse the netlist in C++. False for the Python parser of DesignDB.py
+        self.nativeConstGen = False # Generate the constraints of the primary cells in C++ instead of with ConstGen. Off until checked against ConstGen on more designs
+        self.nativePowerGeometry = False # Generate the guard rings, the power stripes and the power pin vias in C++ from the technology rules. False for the cells of the device generator
+        self.nativePcell = False # Generate the layouts of the MOS, resistor and capacitor devices in C++ from their properties and the technology rules, in parallel. False for the device generator of the PDK
+        self.routeInMemory = True # Exchange the placed layout and the routed wires with the router as shape arrays if its binding supports them, which the flow reports at startup otherwise. False for the .place.gds and .route.gds files
+        self.dumpRouteGds = False # Also write the .place.gds and .route.gds files when routing in memory, for sign-off
+        self.mergeLayoutRects = True # Merge the abutting and overlapping rectangles of the placed and the routed layouts before writing them and handing them to the router
+        self.checkConnectivity = False # Extract the connectivity of each routed layout and report the open and shorted nets before LVS. Off until validated on the cells of real PDKs
+        self.checkpointDir = None # Write a binary snapshot of the design into this directory after parsing, as parse.mfdb. None for no snapshots
+        self.resumeCheckpoint = None # Load the design from a snapshot taken before placement, e.g. parse.mfdb, instead of parsing the netlist
+        self.reflowCacheDir = None # Keep the implemented circuits in this directory by their content digests, and restore the unchanged ones in later runs. None for no reuse
+        self.traceFile = None # Write the Chrome trace of the run into this file, and print the time spent per stage. None for no tracing
+        self.traceMemory = False # With traceFile, also sample the memory footprint of the design after each stage, and the resident memory peaks of the parsing, flattening and writing
+        self.exportGdsDir = None # Write the routed layout of each circuit implemented in this run into this directory as <name>.gds, encoded in parallel. None for no export
+        self.exportMergedGds = None # Write one GDSII library with every distinct cell under the top circuit into this file. None for no library
+        self.asyncLogging = True # Print the messages of the C++ side from a background thread, so that the workers do not wait for the log file
+        self.placeNumStarts = 1 # The number of placer instances solving each circuit from different starting points, each in a forked process. Only the best placement is kept
+        self.placeStartSettings = [] # The placer settings of the starts, cycled over them: a list of {setter name: [arguments]}, applied after the input is fed. Without a placer seed, one for each start
+        self.placeScoreWeights = [1.0, 1.0, 1.0] # The weights of the area and the HPWL, relative to the best start, and of the symmetry residual in grid steps, for ranking the starts
+        self.floorplanEstimate = False # Estimate the sizes of the circuits bottom-up and floorplan each one against the sizes of its sub circuits, before generating any device. The estimates are only printed, the implementation does not use them
+        self.floorplanOnly = False # Stop after the floorplan estimation
+        self.floorplanUtilization = 0.6 # The fraction of the area of a circuit its sub circuits fill, for the circuits without a floorplan
+        self.floorplanAspectRatio = 1.0 # The target width over height of the circuits without a floorplan
+        self.remoteWorkers = [] # The shell commands running a flow on another machine, with {params} in place of its parameter file, e.g. "ssh host python3 /path/Magical.py {params}". The exclusive subtrees under the top circuit are implemented by them concurrently. Empty for implementing everything here
+        self.remoteJobDir = None # The directory for the sub designs, the parameters and the results of the remote jobs, shared with the remote workers. None for resultDir/remote
+        self.subtreeResult = None # Write the implementation of the top circuit as a subtree snapshot into this file at the end of the flow, for the flow dispatching it. None for no result
         self.powerLayer = 6 # m6
         self.psubLayer = self.powerLayer # same as power pin
         self.smallModuleAreaThreshold = 60 # um^2
@@ -93,16 +124,11 @@ simple_tech_file [required]    | input simple techfile
 
     def fromJson(self, data):
         """
-        @brief load form json 
+        @brief load form json. Every attribute set in __init__ is read under its own name, so that a file written from vars() loads back the same
         """
-        if 'spectre_netlist' in data: self.spectre_netlist = data['spectre_netlist']
-        if 'hspice_netlist' in data: self.hspice_netlist = data['hspice_netlist']
-        if 'simple_tech_file' in data: self.simple_tech_file = data['simple_tech_file']
-        if 'resultDir' in data: self.resultDir = data['resultDir']
-        if 'lef' in data : self.lef = data['lef']
-        if 'techfile' in data : self.techfile = data['techfile']
-        if 'vddNetNames' in data : self.vddNetNames = data['vddNetNames']
-        if 'vssNetNames' in data : self.vssNetNames = data['vssNetNames']
+        for key in vars(self):
+            if key in data:
+                setattr(self, key, data[key])
 
     def dump(self, filename):
         """
@@ -7,6 +7,63 @@ import device_generation.basic as basic
 import gdspy
 import device_generation.glovar as glovar
 import time
+import Constraint
+import numpy as np
+import multiprocessing
+
+def routerTakesShapes():
+    """
+    @brief whether the router binding takes the placed layout and returns the routed wires as shape arrays
+    """
+    return hasattr(anaroutePy.AnaroutePy, 'loadShapes') and hasattr(anaroutePy.AnaroutePy, 'routedShapes')
+
+def placerTakesPathArrays():
+    """
+    @brief whether the placer binding takes all the signal paths of a circuit in one call, as index arrays
+    """
+    return hasattr(IdeaPlaceExPy.IdeaPlaceEx, 'addSignalPaths')
+
+def placerTakesPathWeights():
+    """
+    @brief whether the placer binding takes the weights of the signal paths added one by one
+    """
+    return hasattr(IdeaPlaceExPy.IdeaPlaceEx, 'setSignalPathWeight')
+
+def routeInMemory(params):
+    """
+    @brief whether the placed layout and the routed wires are exchanged with the router as shape arrays instead of GDSII files
+    @param the parameters of the flow
+    """
+    return params.routeInMemory and routerTakesShapes()
+
+class PlacementSolution(object):
+    """
+    @brief the results of a solved placer that the placement output reads, copied out of the placer so that they can be sent from another process.
+    It answers the same queries as the placer
+    """
+    def __init__(self, placer, symAxis, numCells, ioNets):
+        """
+        @param first: the solved placer
+        @param second: the symmetry axis it returned
+        @param third: the number of cells
+        @param fourth: the indices of the nets with io pins
+        """
+        self.symAxis = symAxis
+        self.cellLocs = [(placer.xCellLoc(cellIdx), placer.yCellLoc(cellIdx)) for cellIdx in range(numCells)]
+        self.cellNames = [placer.cellName(cellIdx) for cellIdx in range(numCells)]
+        self.ioPins = dict((netIdx, (placer.iopinX(netIdx), placer.iopinY(netIdx), placer.isIoPinVertical(netIdx))) for netIdx in ioNets)
+    def xCellLoc(self, cellIdx):
+        return self.cellLocs[cellIdx][0]
+    def yCellLoc(self, cellIdx):
+        return self.cellLocs[cellIdx][1]
+    def cellName(self, cellIdx):
+        return self.cellNames[cellIdx]
+    def iopinX(self, netIdx):
+        return self.ioPins[netIdx][0]
+    def iopinY(self, netIdx):
+        return self.ioPins[netIdx][1]
+    def isIoPinVertical(self, netIdx):
+        return self.ioPins[netIdx][2]
 
 class Placer(object):
     def __init__(self, magicalDB, cktIdx, dirname, gridStep, halfMetWid):
@@ -41,48 +98,323 @@ class Placer(object):
         self.dumpInput()
         self.placer.numThreads(1) #FIXME
         start = time.time()
-        self.symAxis = self.placer.solve(self.gridStep)
+        numStarts = self.numPlaceStarts()
+        if numStarts > 1:
+            self.solveMultiStart(numStarts)
+        else:
+            self.symAxis = self.placer.solve(self.gridStep)
         end = time.time()
         self.runtime = end-start
         print("placement finished: ", self.ckt.name, "runtime", end-start)
         self.processPlacementOutput()
+    def numPlaceStarts(self):
+        """
+        @brief the number of placer instances to run on the circuit.
+        The starts differ by the seed if the placer takes one, and by params.placeStartSettings.
+        Without a seed, each start needs its own setting, as the starts would repeat otherwise
+        """
+        numStarts = max(1, int(self.params.placeNumStarts))
+        numSettings = len(self.params.placeStartSettings)
+        if numStarts > 1 and not hasattr(self.placer, 'setSeed') and numSettings < numStarts:
+            raise Exception("Placer: %d starts of %s cannot differ: the placer takes no seed and params.placeStartSettings has %d settings"
+                    % (numStarts, self.ckt.name, numSettings))
+        return numStarts
+    def configureStart(self, placer, startIdx):
+        """
+        @brief set the seed and the settings of a start on its placer
+        @param first: the placer, with its input fed
+        @param second: the index of the start
+        """
+        if hasattr(placer, 'setSeed'):
+            placer.setSeed(startIdx)
+        settings = self.params.placeStartSettings
+        if not settings:
+            return
+        for name, args in settings[startIdx % len(settings)].items():
+            if not hasattr(placer, name):
+                raise Exception("Placer: unknown placer setting %s in params.placeStartSettings" % name)
+            getattr(placer, name)(*args)
+    def solveMultiStart(self, numStarts):
+        """
+        @brief solve the circuit from several starts and keep the best one as self.placer.
+        Every start has its own placer fed from the circuit. The placer binding is not known to release the GIL or to be thread-safe,
+        so each start is solved in a forked process, which sends back its PlacementSolution. Without fork, the starts are solved one after the other.
+        self.placer is then the PlacementSolution of the best start
+        @param the number of starts
+        """
+        placers = [self.placer]
+        for startIdx in range(1, numStarts):
+            self.placer = IdeaPlaceExPy.IdeaPlaceEx()
+            self.nodeToCellIdx = []
+            self.dumpInput()
+            self.placer.numThreads(1)
+            placers.append(self.placer)
+        for startIdx, placer in enumerate(placers):
+            self.configureStart(placer, startIdx)
+        name = self.ckt.name
+        self.collectScoreInput() # Before the fork, for the parent to score the solutions
+        with magicalFlow.TraceScope("%s %d starts" % (name, numStarts), "place"):
+            if 'fork' in multiprocessing.get_all_start_methods():
+                context = multiprocessing.get_context('fork')
+                workers = []
+                for placer in placers:
+                    reader, writer = context.Pipe(duplex=False)
+                    process = context.Process(target=self.solveStart, args=(placer, writer))
+                    process.start()
+                    writer.close()
+                    workers.append((process, reader))
+                solutions = []
+                for startIdx, (process, reader) in enumerate(workers):
+                    try:
+                        solutions.append(reader.recv())
+                    except EOFError:
+                        solutions.append(None)
+                    process.join()
+                    if solutions[-1] is None:
+                        raise Exception("Placer: start %d of %s failed, exit code %s" % (startIdx, name, process.exitcode))
+            else:
+                print("[W] Placer: no fork on this platform, solving the %d starts of %s one after the other" % (numStarts, name))
+                solutions = [self.solveStart(placer) for placer in placers]
+        scores = [self.placementScore(solution, solution.symAxis) for solution in solutions]
+        costs = self.rankScores(scores)
+        best = min(range(numStarts), key=lambda startIdx: (costs[startIdx], startIdx))
+        for startIdx in range(numStarts):
+            area, hpwl, symResidual = scores[startIdx]
+            print("placement start %d of %s: area %d HPWL %d symmetry residual %d cost %.4f%s"
+                    % (startIdx, name, area, hpwl, symResidual, costs[startIdx], " (best)" if startIdx == best else ""))
+            if magicalFlow.Tracer.enabled():
+                prefix = "place %s start %d " % (name, startIdx)
+                magicalFlow.Tracer.count(prefix + "area", area)
+                magicalFlow.Tracer.count(prefix + "hpwl", hpwl)
+                magicalFlow.Tracer.count(prefix + "symmetry residual", symResidual)
+        if magicalFlow.Tracer.enabled():
+            magicalFlow.Tracer.count("place %s best start" % name, best)
+        self.placer = solutions[best]
+        self.symAxis = solutions[best].symAxis
+    def solveStart(self, placer, connection=None):
+        """
+        @brief solve a start and read its solution out of the placer
+        @param first: the placer of the start, configured
+        @param second: the end of a pipe to send the solution through, from a forked process. None to return it
+        @return the PlacementSolution
+        """
+        ioNets = []
+        if self.useIoPin:
+            ioNets = [netIdx for netIdx in range(self.ckt.numNets()) if self.ckt.net(netIdx).isIo() and not self.ckt.net(netIdx).isPower()]
+        solution = PlacementSolution(placer, placer.solve(self.gridStep), self.numCktNodes, ioNets)
+        if connection is not None:
+            connection.send(solution)
+            connection.close()
+        return solution
+    def placementScore(self, placer, symAxis):
+        """
+        @brief score the solution of a placer
+        @param first: the solved placer
+        @param second: the symmetry axis it returned
+        @return the area of the bounding box of the cells, the HPWL of the pin centers of the non power nets and
+        the symmetry residual: the sum over the symmetric pairs and the self symmetric cells of how far their centers are from mirroring about the axis
+        """
+        if not hasattr(self, 'cellBoxes'):
+            self.collectScoreInput()
+        locs = np.array([[placer.xCellLoc(nodeIdx), placer.yCellLoc(nodeIdx)] for nodeIdx in range(self.numCktNodes)], dtype=np.float64).reshape(-1, 2)
+        lo = locs + self.cellBoxes[:, :2]
+        hi = locs + self.cellBoxes[:, 2:]
+        area = 0
+        if self.numCktNodes > 0:
+            extent = hi.max(axis=0) - lo.min(axis=0)
+            area = int(extent[0] * extent[1])
+        hpwl = 0
+        if len(self.pinNets) > 0:
+            pins = locs[self.pinNodes] + self.pinOffsets
+            netStart = np.flatnonzero(np.r_[True, self.pinNets[1:] != self.pinNets[:-1]])
+            span = np.maximum.reduceat(pins, netStart, axis=0) - np.minimum.reduceat(pins, netStart, axis=0)
+            hpwl = int(span.sum())
+        symResidual = 0
+        centers = (lo + hi) / 2
+        if len(self.symPairs) > 0:
+            a = centers[self.symPairs[:, 0]]
+            b = centers[self.symPairs[:, 1]]
+            symResidual += np.abs(a[:, 0] + b[:, 0] - 2 * symAxis).sum() + np.abs(a[:, 1] - b[:, 1]).sum()
+        if len(self.selfSyms) > 0:
+            symResidual += np.abs(2 * centers[self.selfSyms, 0] - 2 * symAxis).sum()
+        return area, hpwl, int(symResidual)
+    def collectScoreInput(self):
+        """
+        @brief the geometry of the circuit the scores need, the same for every start: the boundaries of the cells, the pin shape centers of the nets,
+        and the symmetric cells of the constraint store. The symmetry read from a .sym file is not scored
+        """
+        boxes = []
+        for nodeIdx in range(self.numCktNodes):
+            bBox = self.dDB.subCkt(self.ckt.node(nodeIdx).graphIdx).layoutView().boundary()
+            boxes.append([bBox.xLo, bBox.yLo, bBox.xHi, bBox.yHi])
+        self.cellBoxes = np.array(boxes, dtype=np.float64).reshape(-1, 4)
+        pinNets, pinNodes, pinOffsets = [], [], []
+        for netIdx in range(self.ckt.numNets()):
+            net = self.ckt.net(netIdx)
+            if net.isPower():
+                continue
+            for pinId in range(net.numPins()):
+                pin = self.ckt.pin(net.pinIdx(pinId))
+                if not pin.valid or pin.nodeIdx >= self.numCktNodes:
+                    continue
+                subNet = self.dDB.subCkt(self.ckt.node(pin.nodeIdx).graphIdx).net(pin.intNetIdx)
+                if subNet.ioLayer > 10: # No pin in the placer, see placeParsePin
+                    continue
+                shape = subNet.ioShape()
+                pinNets.append(netIdx)
+                pinNodes.append(pin.nodeIdx)
+                pinOffsets.append([(shape.xLo + shape.xHi) / 2.0, (shape.yLo + shape.yHi) / 2.0])
+        self.pinNets = np.array(pinNets, dtype=np.int64)
+        self.pinNodes = np.array(pinNodes, dtype=np.int64)
+        self.pinOffsets = np.array(pinOffsets, dtype=np.float64).reshape(-1, 2)
+        cons = self.ckt.constraint()
+        pairs, selfSyms = [], []
+        if cons.isSymGenerated():
+            pairs = [cons.symPair(i) for i in range(cons.numSymPairs())]
+            selfSyms = [cons.selfSym(i) for i in range(cons.numSelfSyms())]
+        self.symPairs = np.array(pairs, dtype=np.int64).reshape(-1, 2)
+        self.selfSyms = np.array(selfSyms, dtype=np.int64)
+    def rankScores(self, scores):
+        """
+        @brief the costs of the starts by params.placeScoreWeights, lower is better
+        @param the (area, HPWL, symmetry residual) of each start
+        @return the cost of each start
+        """
+        weights = self.params.placeScoreWeights
+        minArea = max(1, min(score[0] for score in scores))
+        minHpwl = max(1, min(score[1] for score in scores))
+        return [weights[0] * area / float(minArea) + weights[1] * hpwl / float(minHpwl) + weights[2] * symResidual / float(self.gridStep)
+                for area, hpwl, symResidual in scores]
+    def floorplan(self, boxes):
+        """
+        @brief a fast placement of the nodes at the estimated sizes of their sub circuits, before the devices are generated.
+        Every pin is at the center of its node, and there are no io pins, power stripes or guard rings. The circuit is not changed
+        @param the estimated (xLo, yLo, xHi, yHi) boundary of each node, empty for the leaf nodes
+        @return the width and the height of the bounding box of the placed nodes
+        """
+        self.implRealLayout = False
+        self.useIoPin = False
+        self.placer.readTechSimpleFile(self.params.simple_tech_file)
+        assert len(boxes) == self.numCktNodes, "Placer.floorplan: %d boxes for %d nodes" % (len(boxes), self.numCktNodes)
+        for nodeIdx in range(self.numCktNodes):
+            node = self.ckt.node(nodeIdx)
+            cellIdx = self.placer.allocateCell()
+            self.nodeToCellIdx.append(cellIdx)
+            self.placer.setCellName(cellIdx, node.name)
+            self.placer.addCellShape(cellIdx, 0, boxes[nodeIdx][0], boxes[nodeIdx][1], boxes[nodeIdx][2], boxes[nodeIdx][3])
+        placerPins = dict() # (node, sub circuit net) -> placer pin
+        for netIdx in range(self.ckt.numNets()):
+            net = self.ckt.net(netIdx)
+            dbNetIdx = self.placer.allocateNet()
+            self.placer.setNetName(dbNetIdx, net.name)
+            if net.isPower():
+                self.placer.setNetWgt(dbNetIdx, 0)
+            for pinId in range(net.numPins()):
+                pin = self.ckt.pin(net.pinIdx(pinId))
+                if not pin.valid:
+                    continue
+                key = (pin.nodeIdx, pin.intNetIdx)
+                if key not in placerPins:
+                    box = boxes[pin.nodeIdx]
+                    centerX = (box[0] + box[2]) // 2
+                    centerY = (box[1] + box[3]) // 2
+                    placerPins[key] = self.placer.allocatePin(pin.nodeIdx)
+                    self.placer.setPinName(placerPins[key], net.name)
+                    self.placer.addPinShape(placerPins[key], centerX, centerY, centerX, centerY)
+                self.placer.addPinToNet(placerPins[key], dbNetIdx)
+        if self.ckt.constraint().isSymGenerated():
+            self.placeSym()
+        self.placer.closeVirtualPinAssignment()
+        self.placer.numThreads(1)
+        self.symAxis = self.placer.solve(self.gridStep)
+        if self.numCktNodes == 0:
+            return 0, 0
+        xLo = min(self.placer.xCellLoc(nodeIdx) + boxes[nodeIdx][0] for nodeIdx in range(self.numCktNodes))
+        yLo = min(self.placer.yCellLoc(nodeIdx) + boxes[nodeIdx][1] for nodeIdx in range(self.numCktNodes))
+        xHi = max(self.placer.xCellLoc(nodeIdx) + boxes[nodeIdx][2] for nodeIdx in range(self.numCktNodes))
+        yHi = max(self.placer.yCellLoc(nodeIdx) + boxes[nodeIdx][3] for nodeIdx in range(self.numCktNodes))
+        return int(round(xHi - xLo)), int(round(yHi - yLo))
     def dumpInput(self):
         self.placer.readTechSimpleFile(self.params.simple_tech_file)
         self.placeParsePin()
         self.placeConnection()
-        self.placer.readSymFile(self.dirname + self.ckt.name + '.sym') # FIXME: use in memory interface
-        self.placeParseSigpath()
-        self.computeAndAddPowerCurrentFlow()
+        self.placeSym()
+        self.placeSignalPaths()
         self.placeParseBoundary()
         if self.debug:
             gdspy.current_library = gdspy.GdsLibrary()
             self.tempCell = gdspy.Cell("FLOORPLAN")
         self.configureIoPinParameters()
-        self.placer.readSymNetFile(self.dirname + self.ckt.name + '.symnet') # FIXME: use in memory interface
+        self.placeSymNet()
         #self.feedDeviceProximity()
     
-    def placeParseSigpath(self):
-        filename = self.dirname + self.ckt.name + '.sigpath' #FIXME: use in memeory interface
-        if os.path.isfile(filename):
+    def placeSym(self):
+        """
+        @brief add the symmetric nodes in the constraint store of the circuit to the placer
+        """
+        cons = self.ckt.constraint()
+        if not cons.isSymGenerated():
+            self.placer.readSymFile(self.dirname + self.ckt.name + '.sym')
+            return
+        symGrpIdx = self.placer.allocateSymGrp()
+        for i in range(cons.numSymPairs()):
+            nodeA, nodeB = cons.symPair(i)
+            self.placer.addSymPair(symGrpIdx, self.nodeToCellIdx[nodeA], self.nodeToCellIdx[nodeB])
+        for i in range(cons.numSelfSyms()):
+            self.placer.addSelfSym(symGrpIdx, self.nodeToCellIdx[cons.selfSym(i)])
+    def placeSymNet(self):
+        """
+        @brief add the symmetric nets in the constraint store of the circuit to the placer
+        """
+        filename = self.dirname + self.ckt.name + '.symnet'
+        if self.ckt.constraint().isSymGenerated():
+            Constraint.dumpSymNetFile(self.ckt, filename) # FIXME: the placer only reads symmetric nets from a file
+        self.placer.readSymNetFile(filename)
+    def placeSignalPaths(self):
+        """
+        @brief feed the signal paths and the power current paths to the placer as one set compiled by magicalFlow.PlacerPathSet:
+        in the placer cells and pins, without the repeated and the contained paths, and weighted by the current they carry.
+        The signal paths come from the constraint store, else from the .sigpath file, else from CSFlow
+        """
+        cons = self.ckt.constraint()
+        filename = self.dirname + self.ckt.name + '.sigpath'
+        isPrimary = self.ckt.implType == magicalFlow.ImplTypeUNSET
+        csflow = self.mDB.csflow()
+        paths = magicalFlow.PlacerPathSet(self.dDB, self.cktIdx)
+        if cons.numSignalPaths() > 0:
+            paths.addConstraintPaths(cons)
+        elif os.path.isfile(filename):
             self.placer.readSigpathFile(filename)
-    def computeAndAddPowerCurrentFlow(self):
-        #if self.isTopLevel:
-        #    return
-        print("computeAndAddPowerCurrentFlow")
-        csflow = magicalFlow.CSFlow(self.dDB)
-        ckt = self.ckt
-        if ckt.implType == magicalFlow.ImplTypeUNSET:
-            csflow.computeCurrentFlow(ckt)
-            pinNamePaths = csflow.currentPinPaths();
-            cellNamePaths = csflow.currentCellPaths();
-            csflow.computeCurrentFlow(ckt)
-            for i in range(len(pinNamePaths)):
-                pathIdx = self.placer.allocateSignalPath()
+        elif isPrimary:
+            paths.addSignalPaths(csflow.signalFlow(self.cktIdx))
+        if isPrimary:
+            paths.addCurrentPaths(csflow.currentFlow(self.cktIdx))
+        paths.compile()
+        print("Placer: %d signal and current paths for %s, %d redundant ones dropped" % (paths.numPaths(), self.ckt.name, paths.numRedundantPaths()))
+        self.addPlacerPaths(paths)
+    def addPlacerPaths(self, paths):
+        """
+        @brief hand a compiled magicalFlow.PlacerPathSet to the placer, in one call if it takes the index arrays
+        """
+        isPower = [paths.isPower(i) for i in range(paths.numPaths())]
+        if placerTakesPathArrays():
+            self.placer.addSignalPaths(paths.pathStartArray(), paths.cellArray(), paths.pinArray(), paths.weightArray(), isPower)
+            return
+        # The fallback reported by Flow.reportBindingFallbacks
+        hasWeight = placerTakesPathWeights()
+        cells = paths.cellArray()
+        intNets = paths.intNetArray()
+        pathStart = paths.pathStartArray()
+        for i in range(paths.numPaths()):
+            pathIdx = self.placer.allocateSignalPath()
+            if isPower[i]:
                 self.placer.markSignalPathAsPower(pathIdx)
-                print("allocate signal path", pathIdx)
-                for j in range(len(pinNamePaths[i])):
-                    self.placer.addPinToSignalPath(pathIdx, cellNamePaths[i][j], pinNamePaths[i][j])
-                    print("add pin to signal path", pathIdx, cellNamePaths[i][j], pinNamePaths[i][j])
+            if hasWeight:
+                self.placer.setSignalPathWeight(pathIdx, paths.weight(i))
+            for k in range(pathStart[i], pathStart[i + 1]):
+                node = self.ckt.node(int(cells[k]))
+                pinName = self.dDB.subCkt(node.graphIdx).net(int(intNets[k])).name
+                self.placer.addPinToSignalPath(pathIdx, node.name, pinName)
     def feedDeviceProximity(self):
         for idx in range(len(self.deviceProximityTypes)):
             deviceType = self.deviceProximityTypes[idx]
@@ -179,18 +511,27 @@ class Placer(object):
                                   origin[1] + yHiLen)
 
     def updatePlacementResult(self):
+        """
+        @brief rebuild the layout of the circuit from the instance views of its nodes, after the nodes moved
+        """
         self.ckt.layout().clear()
-        for nodeIdx in range(self.ckt.numNodes()):
-            cktNode = self.ckt.node(nodeIdx)
-            subCkt = self.dDB.subCkt(cktNode.graphIdx)
-            x_offset = cktNode.offset().x
-            y_offset = cktNode.offset().y
-            self.ckt.layout().insertLayout(subCkt.layout(), x_offset, y_offset, cktNode.flipVertFlag)
+        self.dDB.insertSubLayouts(self.cktIdx, False)
         # write guardring using gdspy
         for grCell in self.guardRingGrCells:
-            self.addPycell(self.ckt.layout(), grCell)
-        # Output placement result
-        magicalFlow.writeGdsLayout(self.cktIdx, self.dirname + self.ckt.name + '.place.gds', self.dDB, self.tDB)
+            if isinstance(grCell, magicalFlow.ShapeBuffer):
+                grCell.applyTo(self.ckt.layout())
+            else:
+                self.addPycell(self.ckt.layout(), grCell)
+        if self.params.mergeLayoutRects:
+            self.ckt.layout().mergeRects()
+        self.writePlaceGds()
+
+    def writePlaceGds(self):
+        """
+        @brief output the placement result for the router, unless the router takes it in memory
+        """
+        if not routeInMemory(self.params) or self.params.dumpRouteGds:
+            magicalFlow.writeLayoutFile(self.cktIdx, self.dirname + self.ckt.name + '.place.gds', self.dDB, self.tDB)
 
     def resetPlacer(self):
         """
@@ -205,33 +546,37 @@ class Placer(object):
     def writeoutPlacementResult(self):
         # Write results to flow
         self.initPowerPins()
+        # Write the offsets of all the nodes in one call
+        offsets = np.array([[self.placer.xCellLoc(nodeIdx) - self.origin[0], self.placer.yCellLoc(nodeIdx) - self.origin[1]]
+                            for nodeIdx in range(self.numCktNodes)], dtype=np.int32).reshape(-1, 2)
+        self.ckt.setNodeOffsets(offsets)
         for nodeIdx in range(self.numCktNodes):
             cktNode = self.ckt.node(nodeIdx)
-            subCkt = self.dDB.subCkt(cktNode.graphIdx)
-            x_offset = self.placer.xCellLoc(nodeIdx) - self.origin[0]
-            y_offset = self.placer.yCellLoc(nodeIdx) - self.origin[1]
+            x_offset = int(offsets[nodeIdx, 0])
+            y_offset = int(offsets[nodeIdx, 1])
             print("node ", cktNode.name, x_offset, y_offset)
-            cktNode.setOffset(x_offset, y_offset)
-            self.ckt.layout().insertLayout(subCkt.layout(), x_offset, y_offset, cktNode.flipVertFlag)
+            # The view reads the offset and the flip of the node just set, and copies the sub layout only into the parent
+            view = self.dDB.instanceView(self.cktIdx, nodeIdx)
+            view.materialize(self.ckt.layout(), False)
             print(cktNode.name, self.placer.cellName(nodeIdx), x_offset, y_offset, "PLACEMENT")
             if self.debug:
-                boundary = subCkt.layout().boundary()
-                rect = gdspy.Rectangle((boundary.xLo+x_offset,boundary.yLo+y_offset), (boundary.xHi+x_offset,boundary.yHi+y_offset))
-                text = gdspy.Text(cktNode.name,50,((boundary.xLo+boundary.xHi)/2+x_offset,(boundary.yLo+boundary.yHi)/2+y_offset),layer=100)
+                # The footprint of the node in the parent
+                boundary = view.boundary()
+                rect = gdspy.Rectangle((boundary.xLo,boundary.yLo), (boundary.xHi,boundary.yHi))
+                text = gdspy.Text(cktNode.name,50,((boundary.xLo+boundary.xHi)/2,(boundary.yLo+boundary.yHi)/2),layer=100)
                 self.tempCell.add(rect)
                 self.tempCell.add(text)
         cktBoundaryBox = self.ckt.layout().boundary()
         #Process io pins      
         if self.useIoPin:
+            ioOffsets = np.array([self.iopinOffsetx, self.iopinOffsety], dtype=np.int32).T.reshape(-1, 2)
+            self.ckt.setNodeOffsets(ioOffsets[:self.ckt.numNodes() - self.numCktNodes], self.numCktNodes)
             for nodeIdx in range(self.numCktNodes, self.ckt.numNodes()):
-                cktNode = self.ckt.node(nodeIdx)
-                subCkt = self.dDB.subCkt(cktNode.graphIdx)
-                x_offset = self.iopinOffsetx[nodeIdx - self.numCktNodes]
-                y_offset = self.iopinOffsety[nodeIdx - self.numCktNodes]
-                cktNode.setOffset(x_offset, y_offset)
-                self.ckt.layout().insertLayout(subCkt.layout(), x_offset, y_offset, cktNode.flipVertFlag)
+                self.dDB.instanceView(self.cktIdx, nodeIdx).materialize(self.ckt.layout(), False)
         # write guardring using gdspy
-        if self.cktNeedSub(self.cktIdx) and self.implRealLayout:
+        if self.cktNeedSub(self.cktIdx) and self.implRealLayout and self.params.nativePowerGeometry:
+            self.addGuardRingNative(cktBoundaryBox)
+        elif self.cktNeedSub(self.cktIdx) and self.implRealLayout:
             print("Adding GuardRing to Cell")
             print("origin", self.origin[0], self.origin[1])
             # Leave additional 80nm spacing
@@ -248,12 +593,9 @@ class Placer(object):
             cktBBoxAfterGuardRing = self.ckt.layout().boundary()
             self.addPowerStripe(cktBoundaryBox, cktBBoxAfterGuardRing)
             for nodeIdx in range(existingNodes, self.ckt.numNodes()):
-                cktNode = self.ckt.node(nodeIdx)
-                subCkt = self.dDB.subCkt(cktNode.graphIdx)
-                cktNode.setOffset(0, 0)
-                self.ckt.layout().insertLayout(subCkt.layout(), 0, 0, cktNode.flipVertFlag)
-        # Output placement result
-        magicalFlow.writeGdsLayout(self.cktIdx, self.dirname + self.ckt.name + '.place.gds', self.dDB, self.tDB)
+                self.ckt.node(nodeIdx).setOffset(0, 0)
+                self.dDB.instanceView(self.cktIdx, nodeIdx).materialize(self.ckt.layout(), False)
+        self.writePlaceGds()
         self.origin = [0,0]
         if self.debug:
             gdspy.write_gds(self.dirname+self.ckt.name+'.floorplan.gds', [self.tempCell], unit=1.0e-9, precision=1.0e-9)
@@ -307,13 +649,21 @@ class Placer(object):
                     continue
             conLayer = conCkt.net(conNet).ioPinMetalLayer(0) 
             ioshape = conCkt.net(conNet).ioPinShape(0)
-            if conLayer < topmet:
+            if conLayer < topmet and self.params.nativePowerGeometry:
+                stack = magicalFlow.ShapeBuffer()
+                magicalFlow.PowerGeometry(self.tDB).addViaStack(ioshape, conLayer, topmet, stack)
+                stack.applyTo(conCkt.layout())
+                conCkt.net(conNet).ioLayer = topmet
+            elif conLayer < topmet:
                 met_cell = basic.basic.power_pin_init([ioshape.xLo/1000.0, ioshape.yLo/1000.0], [ioshape.xHi/1000.0, ioshape.yHi/1000.0], conLayer+1, topmet)
                 self.addPycell(conCkt.layout(), met_cell)
                 conCkt.net(conNet).ioLayer = topmet
 
 
     def addPycellIoPinToNet(self, netIdx, offsetX, offsetY, pyCell, isPowerStripe=False):
+        if offsetX == 0 and offsetY == 0 and hasattr(magicalFlow, 'PowerGeometry'):
+            self.addIoPinNodeNative(netIdx, self.pycellShapes(pyCell), isPowerStripe)
+            return
         polygons = pyCell.get_polygons(True)
         layers = polygons.keys()
         routableShapes = []
@@ -443,6 +793,9 @@ class Placer(object):
         fWidth =  halfWidth *2 
         print("width, ", fWidth, "height", fHeight, "vdd offset", vddOffset[0], vddOffset[1])
         print("width, ", fWidth, "height", fHeight, "vss offset", vssOffset[0], vssOffset[1])
+        if self.params.nativePowerGeometry:
+            self.addPowerStripeNative(fWidth, fHeight, vddOffset, vssOffset)
+            return
         vddStripe = basic.basic.power_strip(fWidth, fHeight, vddOffset, lay=[self.params.powerLayer])
         print("generated vdd")
         vssStripe = basic.basic.power_strip(fWidth, fHeight, vssOffset, lay=[self.params.powerLayer])
@@ -538,7 +891,7 @@ class Placer(object):
         for nodeIdx in range(self.ckt.numNodes()):
             cktNode = self.ckt.node(nodeIdx)
             subCkt = self.dDB.subCkt(cktNode.graphIdx)
-            bBox = subCkt.layout().boundary()
+            bBox = subCkt.layoutView().boundary()
             self.placer.addCellShape(nodeIdx, 0, bBox.xLo, bBox.yLo, bBox.xHi, bBox.yHi)
             if self.debug:
                 outFile.write("%d %d %d %d\n" % (bBox.xLo, bBox.yLo, bBox.xHi, bBox.yHi))
@@ -589,6 +942,9 @@ class Placer(object):
         return pinCount + netPsub, bool(netPsub), bool(netNwell)
 
     def addPycell(self, layout, pyCell):
+        if hasattr(magicalFlow, 'ShapeBuffer'):
+            self.pycellShapes(pyCell).applyTo(layout)
+            return
         polygons = pyCell.get_polygons(True)
         layers = polygons.keys()
         for layer in layers:
@@ -604,6 +960,64 @@ class Placer(object):
                 if datatype != 0:
                     layout.setRectDatatype(layerIdx, rectIdx, datatype)
 
+    def pycellShapes(self, pyCell):
+        """
+        @brief the rectangles of a gdspy cell as a magicalFlow.ShapeBuffer, converted layer by layer in numpy as addPycell does polygon by polygon
+        """
+        shapes = magicalFlow.ShapeBuffer()
+        for (pdkLayer, datatype), polyList in pyCell.get_polygons(True).items():
+            if len(polyList) == 0:
+                continue
+            corners = np.array([[poly[0][0], poly[0][1], poly[2][0], poly[2][1]] for poly in polyList])
+            rects = np.rint(corners * 200).astype(np.int32) * 5
+            layerIdx = self.tDB.pdkLayerToDb(pdkLayer)
+            shapes.addShapes(np.full(len(rects), layerIdx, dtype=np.uint32), np.full(len(rects), datatype, dtype=np.uint32), rects)
+        return shapes
+
+    def addIoPinNodeNative(self, netIdx, shapes, isPowerStripe):
+        """
+        @brief connect the shapes to a net as a new io pin cell in one call, as addIoPinToNet does shape by shape
+        """
+        magicalFlow.PowerGeometry.insertIoPinNode(self.dDB, self.cktIdx, netIdx, shapes, isPowerStripe, self.gridStep)
+        self.ckt = self.dDB.subCkt(self.cktIdx) # The circuits may have moved
+
+    def addGuardRingNative(self, cktBoundaryBox):
+        """
+        @brief add the substrate guard ring of magicalFlow.PowerGeometry around the placement, with the vias of its bottom side up to params.psubLayer as the psub pin
+        """
+        inner = magicalFlow.BoxLoc()
+        # Leave additional 80nm spacing
+        inner.xLo = cktBoundaryBox.xLo - 80
+        inner.yLo = cktBoundaryBox.yLo - 80
+        inner.xHi = cktBoundaryBox.xHi + 80
+        inner.yHi = cktBoundaryBox.yHi + 80
+        geometry = magicalFlow.PowerGeometry(self.tDB)
+        ring = magicalFlow.ShapeBuffer()
+        sides = geometry.addGuardRing(inner, False, ring)
+        geometry.addViaStack(sides[0], 1, self.params.psubLayer, ring)
+        ring.applyTo(self.ckt.layout())
+        self.subShapeList.append([sides[0].xLo, sides[0].yLo, sides[0].xHi, sides[0].yHi])
+        self.guardRingGrCells.append(ring)
+
+    def addPowerStripeNative(self, fWidth, fHeight, vddOffset, vssOffset):
+        """
+        @brief add the power stripes of addPowerStripe with magicalFlow.PowerGeometry, as io pin cells of the power nets
+        """
+        geometry = magicalFlow.PowerGeometry(self.tDB)
+        for netIdx in range(self.ckt.numNets()):
+            net = self.ckt.net(netIdx)
+            if not net.isVdd() and not net.isVss():
+                continue
+            offset = vddOffset if net.isVdd() else vssOffset
+            stripe = magicalFlow.BoxLoc()
+            stripe.xLo = int(round(offset[0] * 1000))
+            stripe.yLo = int(round(offset[1] * 1000))
+            stripe.xHi = stripe.xLo + int(round(fWidth * 1000))
+            stripe.yHi = stripe.yLo + int(round(fHeight * 1000))
+            shapes = magicalFlow.ShapeBuffer()
+            geometry.addPowerStripe(stripe, self.params.powerLayer, shapes)
+            self.addIoPinNodeNative(netIdx, shapes, True)
+
     def subShape(self, subPin):
         shape = subPin.normalize_shape()
         # Only the lower metal for now
@@ -12,6 +12,7 @@ import os
 import Router
 import Placer
 import gdspy
+import numpy as np
 from device_generation.glovar import tsmc40_glovar as glovar
 
 class PnR(object):
@@ -27,6 +28,7 @@ class PnR(object):
         self.debug = True
         self.params = self.mDB.params
         self.runtime = 0
+        self.netLengths = None # The estimated wire lengths of the nets of the circuit under routing
 
     def implLayout(self, cktIdx, dirname):
         """
@@ -82,6 +84,7 @@ class PnR(object):
         self.symAxis = self.p.symAxis
         self.origin = self.p.origin
         self.subShapeList = self.p.subShapeList
+        self.netLengths = None
         self.upscaleBBox(self.gridStep, self.dDB.subCkt(cktIdx), self.origin)
 
     def runRoute(self, cktIdx, dirname):
@@ -102,7 +105,13 @@ class PnR(object):
             self.writeiopifile(cktIdx, iopinfile)
         router.parseLef(self.params.lef)
         router.parseTechfile(self.params.techfile)
-        router.parseGds(placeFile)
+        inMemory = Placer.routeInMemory(self.params)
+        if inMemory:
+            # The placed layout as shape arrays in the GDSII layers, in the router units like addShape2Pin
+            placed = magicalFlow.ShapeBuffer.fromCkt(self.dDB, cktIdx)
+            router.loadShapes(placed.pdkLayerArray(self.tDB), placed.datatypeArray(), 2 * placed.rectArray())
+        else:
+            router.parseGds(placeFile)
         self.routeParsePin(router, cktIdx, dirname+ckt.name+'.gr')  
         router.setGridStep(2*self.gridStep)
         router.setSymAxisX(2*self.symAxis)
@@ -120,13 +129,62 @@ class PnR(object):
         if not routerPass:
             print("Routing failed! ckt ", ckt.name)
             assert(routerPass)
-        router.writeLayoutGds(placeFile, dirname+ckt.name+'.route.gds', True)
-        router.writeDumb(placeFile, dirname+ckt.name+'.ioPin') 
+        if not inMemory or self.params.dumpRouteGds:
+            router.writeLayoutGds(placeFile, dirname+ckt.name+'.route.gds', True)
+            router.writeDumb(placeFile, dirname+ckt.name+'.ioPin') 
         # Read results to flow
-        ckt.setTechDB(self.tDB)
-        ckt.parseGDS(dirname+ckt.name+'.route.gds')
+        if inMemory:
+            self.applyRoutedShapes(router, ckt)
+        else:
+            ckt.parseGDS(dirname+ckt.name+'.route.gds')
+        if self.params.mergeLayoutRects:
+            ckt.layout().mergeRects()
+        if self.tDB.hasLayerRules():
+            self.screenRules(ckt)
+        if self.params.checkConnectivity:
+            self.checkConnectivity(cktIdx)
         self.upscaleBBox(self.gridStep, ckt, self.origin)
 
+    def screenRules(self, ckt):
+        """
+        @brief check the routed layout of a circuit against the width, spacing and area rules, and report the violations before the sign-off check
+        """
+        screen = magicalFlow.DrcScreen(self.tDB)
+        if screen.check(ckt.layout()) == 0:
+            return
+        print("PnR: %d rule violations in %s: %d width, %d spacing, %d area" % (screen.numViolations(), ckt.name,
+            screen.numViolationsOf(magicalFlow.DrcViolationType.MIN_WIDTH),
+            screen.numViolationsOf(magicalFlow.DrcViolationType.MIN_SPACING),
+            screen.numViolationsOf(magicalFlow.DrcViolationType.MIN_AREA)))
+
+    def checkConnectivity(self, cktIdx):
+        """
+        @brief extract the routed layout of a circuit and report the open and shorted nets before LVS
+        """
+        ckt = self.dDB.subCkt(cktIdx)
+        conn = magicalFlow.LayoutConnectivity(self.tDB)
+        # The texts of the sub layouts name the nets of the sub circuits
+        conn.setUseTexts(False)
+        if conn.check(self.dDB, cktIdx) == 0:
+            return
+        print("PnR: %d opens and %d shorts in %s" % (conn.numOpens(), conn.numShorts(), ckt.name))
+        for openIdx in range(conn.numOpens()):
+            print("PnR: open net %s in %d pieces" % (ckt.net(conn.openNet(openIdx)).name, conn.openNumComponents(openIdx)))
+        for shortIdx in range(conn.numShorts()):
+            print("PnR: short between %s and %s" % (ckt.net(conn.shortNet(shortIdx)).name, ckt.net(conn.shortOtherNet(shortIdx)).name))
+
+    def applyRoutedShapes(self, router, ckt):
+        """
+        @brief append the routed wires into the placed layout of a circuit, as the .route.gds would have them
+        @param first: the router, after solving
+        @param second: the circuit
+        """
+        layers, datatypes, rects, nets = router.routedShapes()
+        dbLayers = np.array([self.tDB.pdkLayerToDb(int(layer)) for layer in layers], dtype=np.uint32)
+        routed = magicalFlow.ShapeBuffer()
+        routed.addShapes(dbLayers, datatypes, np.asarray(rects) // 2, nets)
+        routed.applyTo(ckt.layout())
+
     def upscaleBBox(self, gridStep, ckt, origin):
         """
         @brief for legalize the boundary box after the routing. The routing wire might change the boundary of placement, so that the bounding box need to be adjust to multiple of grid step
@@ -157,30 +215,13 @@ class PnR(object):
                                   origin[1] + yHiLen)
 
     def iterateNetPinShapes(self, cktIdx, netIdx, callback):
-        ckt = self.dDB.subCkt(cktIdx)
-        net = ckt.net(netIdx)
-        grPinCount, isPsub, isNwell = self.netPinCount(ckt, net)
-        for pinId in range(net.numPins()):
-            pinIdx = net.pinIdx(pinId)
-            pin = ckt.pin(pinIdx)
-            conNode = pin.nodeIdx
-            conNet = pin.intNetIdx
-            conCkt = self.dDB.subCkt(ckt.node(conNode).graphIdx)
-            if not pin.valid:
-                continue
-            if pin.pinType == magicalFlow.PinType.PSUB:
-                assert net.isSub, net.name
-                if conCkt.implType != magicalFlow.ImplTypePCELL_Cap:
-                    continue
-            # Router starts as 0 with M1
-            for iopinidx in range(conCkt.net(conNet).numIoPins()):
-                conLayer = conCkt.net(conNet).ioPinMetalLayer(iopinidx) - 1
-                ioshape = conCkt.net(conNet).ioPinShape(iopinidx)
-                conShape = self.adjustIoShape(ioshape, ckt.node(conNode).offset(), conCkt.layout().boundary(), ckt.node(conNode).flipVertFlag)
-                # GDS and LEF unit mismatch, multiply by 2
-                assert conShape[0] <= conShape[2]
-                assert conShape[1] <= conShape[3]
-                callback(conShape, False)
+        # The pin shapes of the nets are resolved once per placement in the database
+        netPinShapes = self.dDB.netPinShapes(cktIdx)
+        shapeStart = netPinShapes.shapeStartArray()
+        rects = netPinShapes.rectArray()
+        isPsub = netPinShapes.hasPsub(netIdx)
+        for shapeIdx in range(shapeStart[netIdx], shapeStart[netIdx + 1]):
+            callback(rects[shapeIdx].tolist(), False)
         if isPsub:
             assert self.cktNeedSub(cktIdx)
             # GDS and LEF unit mismatch, multiply by 2
@@ -221,9 +262,16 @@ class PnR(object):
             outFile.write('Offset %d %d\n' % (self.origin[0],self.origin[1]))
             outFile.write('symAxis %d\n' % (self.symAxis))
             specFile = open(fileName + '.spec', 'w')
+        netPinShapes = self.dDB.netPinShapes(cktIdx)
+        shapeStart = netPinShapes.shapeStartArray()
+        rects = netPinShapes.rectArray()
+        layers = netPinShapes.layerArray()
+        pinIds = netPinShapes.pinIdArray()
+        powerStripes = netPinShapes.powerStripeArray()
+        subNetIos = netPinShapes.subNetIoArray()
         for netIdx in self.routerNets:
             net = ckt.net(netIdx)
-            grPinCount, isPsub, isNwell = self.netPinCount(ckt, net)
+            isPsub = netPinShapes.hasPsub(netIdx)
             pinName[netIdx] = dict()
             netIsPower = 0
             if net.isPower() and not self.isSmallModule:
@@ -231,34 +279,28 @@ class PnR(object):
             if self.debug:
                 pass
                 #outFile.write(net.name + ' ' + str(netIdx) + ' ' + str(grPinCount) + ' 1\n')
-            for pinId in range(net.numPins()):
-                pinIdx = net.pinIdx(pinId)
-                pin = ckt.pin(pinIdx)
-                conNode = pin.nodeIdx
-                conNet = pin.intNetIdx
-                conCkt = self.dDB.subCkt(ckt.node(conNode).graphIdx)
-                if not pin.valid:
-                    continue
-                if pin.pinType == magicalFlow.PinType.PSUB:
-                    assert net.isSub, net.name
-                    if conCkt.implType != magicalFlow.ImplTypePCELL_Cap:
-                        continue
+            # The shapes of a pin are contiguous, the invalid and the substrate pins are already skipped
+            shapeIdx = shapeStart[netIdx]
+            while shapeIdx < shapeStart[netIdx + 1]:
+                pinId = int(pinIds[shapeIdx])
+                pinEnd = shapeIdx
+                while pinEnd < shapeStart[netIdx + 1] and pinIds[pinEnd] == pinId:
+                    pinEnd += 1
+                pinShapes = range(shapeIdx, pinEnd)
+                shapeIdx = pinEnd
                 pinName[netIdx][pinId] = pinNameIdx
                 iopinshapeIsPowerStripe = 0
-                if conCkt.net(conNet).isIoPowerStripe(0) and not self.isSmallModule:
-                    if conCkt.net(conNet).isIo():
+                if powerStripes[pinShapes[0]] and not self.isSmallModule:
+                    if subNetIos[pinShapes[0]]:
                         continue # do not give router lower level power stripe pin
                     iopinshapeIsPowerStripe = 1
                 print("addPin", str(pinNameIdx), net.isPower(), iopinshapeIsPowerStripe)
                 router.addPin(str(pinNameIdx), net.isPower(), iopinshapeIsPowerStripe)
                 # Router starts as 0 with M
-                for iopinidx in range(conCkt.net(conNet).numIoPins()):
-                    conLayer = conCkt.net(conNet).ioPinMetalLayer(iopinidx) - 1
-                    ioshape = conCkt.net(conNet).ioPinShape(iopinidx)
-                    conShape = self.adjustIoShape(ioshape, ckt.node(conNode).offset(), conCkt.layout().boundary(), ckt.node(conNode).flipVertFlag)
+                for pinShapeIdx in pinShapes:
+                    conLayer = int(layers[pinShapeIdx]) - 1
+                    conShape = rects[pinShapeIdx].tolist()
                     # GDS and LEF unit mismatch, multiply by 2
-                    assert conShape[0] <= conShape[2]
-                    assert conShape[1] <= conShape[3]
                     router.addShape2Pin(pinNameIdx, conLayer, conShape[0]*2, conShape[1]*2, conShape[2]*2, conShape[3]*2)
                     print("addShape2Pin",pinNameIdx, conLayer, conShape[0]*2, conShape[1]*2, conShape[2]*2, conShape[3]*2)
                     if self.debug:
@@ -288,7 +330,7 @@ class PnR(object):
             specFile.write(string)   
         for netIdx in self.routerNets: 
             net = ckt.net(netIdx)  
-            grPinCount, isPsub, isNwell = self.netPinCount(ckt, net)    
+            isPsub = netPinShapes.hasPsub(netIdx)
             width, cuts, rows, cols = self.determineNetWidthVia(cktIdx, netIdx)
             width = self.dbuToRouterDbu(width)
             routerNetIdx = router.addNet(net.name, width, cuts, net.isPower() and not self.isSmallModule, rows, cols)  
@@ -324,11 +366,9 @@ class PnR(object):
         return xLo_s, xHi_s
 
     def cktNeedSub(self, cktIdx):
-        ckt = self.dDB.subCkt(cktIdx)
-        for netIdx in range(ckt.numNets()):
-            net = ckt.net(netIdx)
-            _, isPsub, _ = self.netPinCount(ckt, net)
-            if isPsub:
+        netPinShapes = self.dDB.netPinShapes(cktIdx)
+        for netIdx in range(netPinShapes.numNets()):
+            if netPinShapes.hasPsub(netIdx):
                 return True
         return False
 
@@ -419,18 +459,26 @@ class PnR(object):
         print("setwidth", self.dDB.subCkt(cktIdx).name, net.name, width)
         print("setvia", viaType[1], viaType[2], viaType[3])
         return (self.umToDbu(width), viaType[1], viaType[2], viaType[3])
+    def netLengthEstimator(self, cktIdx):
+        """
+        @brief the wire lengths of all the nets of a circuit, evaluated again after the placement changes
+        """
+        netPinShapes = self.dDB.netPinShapes(cktIdx)
+        if self.netLengths is None or self.netLengths[0] != cktIdx or self.netLengths[1] != netPinShapes.signature():
+            estimator = magicalFlow.NetLengthEstimator(netPinShapes)
+            if len(self.subShapeList) > 0:
+                subShape = self.subShapeList[0]
+                assert subShape[0] <= subShape[2]
+                assert subShape[1] <= subShape[3]
+                estimator.setSubShape(subShape[0], subShape[1], subShape[2], subShape[3])
+            estimator.evaluate()
+            self.netLengths = (cktIdx, netPinShapes.signature(), estimator)
+        return self.netLengths[2]
     def calcNetLength(self, cktIdx, netIdx):
         """
-        @brief calculate the hpwl. return in um
+        @brief calculate the larger extent of the bounding box of the net. return in um
         """
-        bbox = [1e20, 1e20, -1e20, -1e20]
-        def unionBBox(shape, dontcare):
-            bbox[0] = min(bbox[0], shape[0])
-            bbox[1] = min(bbox[1], shape[1])
-            bbox[2] = max(bbox[2], shape[2])
-            bbox[3] = max(bbox[3], shape[3])
-        self.iterateNetPinShapes(cktIdx, netIdx, unionBBox)
-        wl = max(bbox[2] - bbox[0], bbox[3] - bbox[1])
+        wl = self.netLengthEstimator(cktIdx).length(netIdx, magicalFlow.NetLengthMetric.MAX_EXTENT)
         if self.dbuToUm(wl) > 100:
             print("longwire", self.dDB.subCkt(cktIdx).name, self.dDB.subCkt(cktIdx).net(netIdx).name, self.dbuToUm(wl))
         return self.dbuToUm(wl)
@@ -22,6 +22,10 @@ class S3DET(object):
         self.tDB = magicalDB.techDB
         self.symTol = symTol
         self.addPins = True
+        # Only score the pairs of devices with the same type and properties
+        self.matchDevices = True
+        # Score the pairs with the native spectral kernel instead of GraphSim
+        self.nativeGraphSim = True
         # Modified for fix for local graph generation
         #self.graph = nx.Graph()
         #self.circuitNodes = dict()
@@ -37,10 +41,15 @@ class S3DET(object):
         self.graphSim = GraphSim.GraphSim(self.graph)
         #
         ckt = self.dDB.subCkt(cktIdx)
-        cktNodes = range(ckt.numNodes())
         symVal = dict()
         symPair = dict()
-        for nodeIdxA, nodeIdxB in combinations(cktNodes, 2):
+        # Only the node pairs with the same structural signature can pass the checks below
+        candidates = magicalFlow.SymCandidates(self.dDB)
+        candidates.find(cktIdx, list(ignore_set), self.matchDevices)
+        if self.nativeGraphSim:
+            spectralSim = magicalFlow.SpectralSim(self.dDB)
+            spectralSim.build(cktIdx, list(ignore_set))
+        for nodeIdxA, nodeIdxB in candidates.pairArray().tolist():
             nodeA = ckt.node(nodeIdxA)
             nodeB = ckt.node(nodeIdxB)
             cktA = self.dDB.subCkt(nodeA.graphIdx)
@@ -55,7 +64,10 @@ class S3DET(object):
             if boxA == boxB and nx.could_be_isomorphic(subgraphA, subgraphB):
                 if nodeIdxA not in symVal:
                     symVal[nodeIdxA] = dict()
-                symVal[nodeIdxA][nodeIdxB] = self.graphSim.specSimScore(subgraphA, subgraphB)
+                if self.nativeGraphSim:
+                    symVal[nodeIdxA][nodeIdxB] = spectralSim.score(nodeIdxA, nodeIdxB)
+                else:
+                    symVal[nodeIdxA][nodeIdxB] = self.graphSim.specSimScore(subgraphA, subgraphB)
                 if nodeIdxB not in symVal:
                     symVal[nodeIdxB] = dict()
                 symVal[nodeIdxB][nodeIdxA] = symVal[nodeIdxA][nodeIdxB]
@@ -87,37 +99,28 @@ class S3DET(object):
                     symVal.pop(idxB, None)
                 else:
                     continue
-        filename = dirName + ckt.name + ".sym"
-        symFile = open(filename, "w")
+        cons = ckt.constraint()
+        cons.clearSym()
         for idxA in symPair:
             idxB = symPair[idxA]
-            nameA = ckt.node(idxA).name
-            nameB = ckt.node(idxB).name
             if symVal[idxA][idxB] >= self.symTol:
-                symFile.write("%s %s\n" % (nameA, nameB))
+                cons.addSymPair(idxA, idxB)
             """
             else:
-                print "waived constraint", nameA, nameB, symVal[idxA][idxB]
+                print "waived constraint", ckt.node(idxA).name, ckt.node(idxB).name, symVal[idxA][idxB]
             """
         hierGraph = self.hierGraph(cktIdx)
         selfSym = self.selfSym(symPair, hierGraph)
         for idx in selfSym:
-            name = ckt.node(idx).name
-            symFile.write("%s\n" % name)
+            cons.addSelfSym(idx)
         symNet = self.symNet(cktIdx, symPair, selfSym)
-        filename = dirName + ckt.name + ".symnet"
-        netFile = open(filename, "w")
         for idxA in symNet:
             idxB = symNet[idxA]
             if idxA == idxB:
-                name = ckt.net(idxA).name
-                netFile.write("%s\n" % name)
+                cons.addSelfSymNet(idxA)
             else:
-                nameA = ckt.net(idxA).name
-                nameB = ckt.net(idxB).name
-                netFile.write("%s %s\n" % (nameA, nameB))
-        symFile.close()
-        netFile.close()
+                cons.addSymNetPair(idxA, idxB)
+        cons.markSymGenerated()
 
     def selfSym(self, symPair, hierGraph):
         selfSym = set()
@@ -0,0 +1,92 @@
+##
+# @file Scheduler.py
+# @date 10/14/2026
+# @brief Dispatch the sub circuits of the hierarchy to a pool of workers, each after the circuits it instantiates
+#
+
+from concurrent.futures import ThreadPoolExecutor, FIRST_COMPLETED, wait
+import magicalFlow
+
+class Scheduler(object):
+    """
+    @brief run one job per circuit under a top circuit, bottom-up along the hierarchy.
+    A circuit becomes ready once the jobs of all the circuits it instantiates are finished.
+    The ready circuits are dispatched to a thread pool. The results are returned in the depth-first post-order of the serial flow,
+    whatever the completion order is.
+    The jobs only overlap in the bindings releasing the GIL, such as parseGDS and writeGdsLayoutStreaming.
+    The placer and the router bindings hold it, so the placement and the routing of the workers still run one at a time
+    """
+    def __init__(self, dDB, numWorkers=1):
+        """
+        @param first: the c++ design database
+        @param second: the maximum number of jobs running at the same time
+        """
+        self.dDB = dDB
+        self.numWorkers = max(1, int(numWorkers))
+
+    def buildDag(self, topCktIdx, isExpanded):
+        """
+        @brief collect the circuits to implement under a top circuit
+        @param first: the top circuit
+        @param second: function telling whether the circuits instantiated by a circuit are implemented before it
+        @return the circuits in the depth-first post-order, and the list of children of each circuit.
+        The devices are implemented by their parents, and the implemented circuits are done already, so neither is a child
+        """
+        hierarchy = self.dDB.hierarchy()
+        order = []
+        children = dict()
+        children[topCktIdx] = []
+        stack = [(topCktIdx, [] if not isExpanded(topCktIdx) else hierarchy.children(topCktIdx), 0)]
+        while stack:
+            cktIdx, subCkts, pos = stack.pop()
+            if pos >= len(subCkts):
+                order.append(cktIdx)
+                continue
+            stack.append((cktIdx, subCkts, pos + 1))
+            childIdx = subCkts[pos]
+            subCkt = self.dDB.subCkt(childIdx)
+            if subCkt.isImpl or magicalFlow.isImplTypeDevice(subCkt.implType):
+                continue
+            children[cktIdx].append(childIdx)
+            if childIdx not in children:
+                children[childIdx] = []
+                stack.append((childIdx, [] if not isExpanded(childIdx) else hierarchy.children(childIdx), 0))
+        return order, children
+
+    def run(self, topCktIdx, job, isExpanded):
+        """
+        @brief run the jobs of the circuits under a top circuit
+        @param first: the top circuit
+        @param second: function of a circuit index, implementing the circuit
+        @param third: function telling whether the circuits instantiated by a circuit are implemented before it
+        @return the list of (cktIdx, result of the job), in the depth-first post-order
+        """
+        order, children = self.buildDag(topCktIdx, isExpanded)
+        if self.numWorkers == 1:
+            return [(cktIdx, job(cktIdx)) for cktIdx in order]
+        parents = dict((cktIdx, []) for cktIdx in order)
+        numPending = dict()
+        for cktIdx in order:
+            numPending[cktIdx] = len(children[cktIdx])
+            for childIdx in children[cktIdx]:
+                parents[childIdx].append(cktIdx)
+        # Dispatch the ready circuits in the post-order, so that a single worker reproduces the serial flow
+        rank = dict((cktIdx, pos) for pos, cktIdx in enumerate(order))
+        ready = [cktIdx for cktIdx in order if numPending[cktIdx] == 0]
+        results = dict()
+        running = dict()
+        with ThreadPoolExecutor(max_workers=self.numWorkers) as pool:
+            while ready or running:
+                while ready and len(running) < self.numWorkers:
+                    cktIdx = ready.pop(0)
+                    running[pool.submit(job, cktIdx)] = cktIdx
+                done, _ = wait(list(running.keys()), return_when=FIRST_COMPLETED)
+                for future in done:
+                    cktIdx = running.pop(future)
+                    results[cktIdx] = future.result() # Re-raise the failure of a job
+                    for parentIdx in parents[cktIdx]:
+                        numPending[parentIdx] -= 1
+                        if numPending[parentIdx] == 0:
+                            ready.append(parentIdx)
+                ready.sort(key=lambda idx: rank[idx])
+        return [(cktIdx, results[cktIdx]) for cktIdx in order]
@@ -16,10 +16,17 @@ class StdCell(object):
 
     def setup(self, cktIdx, dirName):
         ckt = self.dDB.subCkt(cktIdx)
+        # The cells are loaded once, and their layout shared by all the circuits of a cell
+        library = self.mDB.params.stdCellGdsLibrary
+        gdsFile = library if library is not None else dirName+'stdcell/'+ckt.name+'.route.gds'
+        if self.dDB.stdCellLibrary().setup(ckt, dirName+'stdcell/'+ckt.name+'.route.gds.dumb', gdsFile):
+            ckt.isImpl = True
+            return
         Router.Router(self.mDB).readBackDumbFile(dirName+'stdcell/'+ckt.name+'.route.gds.dumb', cktIdx)
         #cmd = "cp " + dirName+'stdcell/'+cirname+'.route.gds ' + dirName+cirname+'.route.gds'
         #subprocess.call(cmd, shell=True)
         self.dDB.subCkt(cktIdx).isImpl = True
         # Read standard cell.
-        ckt.setTechDB(self.tDB)
+        if library is not None and ckt.parseGDSCell(library, ckt.name):
+            return
         ckt.parseGDS(dirName+'stdcell/'+ckt.name+'.route.gds')
@@ -0,0 +1,72 @@
+##
+# @file TestParams.py
+# @date 10/14/2026
+# @brief The loading of the flow parameters from the run specs. Run with python3 -m unittest discover -s flow/python/unittest -p "Test*.py"
+#
+
+import json
+import os
+import sys
+import tempfile
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir))
+import Params
+
+class ParamsTest(unittest.TestCase):
+    def loadSpec(self, data):
+        """
+        @brief load the parameters from a run spec holding the data
+        """
+        fd, filename = tempfile.mkstemp(suffix=".json")
+        with os.fdopen(fd, 'w') as f:
+            json.dump(data, f)
+        params = Params.Params()
+        try:
+            params.load(filename)
+        finally:
+            os.remove(filename)
+        return params
+
+    def test_reflowCacheDir(self):
+        self.assertIsNone(Params.Params().reflowCacheDir)
+        params = self.loadSpec({'reflowCacheDir': '/tmp/reflow'})
+        self.assertEqual('/tmp/reflow', params.reflowCacheDir)
+
+    def test_nativeConstGen(self):
+        self.assertFalse(Params.Params().nativeConstGen)
+        self.assertTrue(self.loadSpec({'nativeConstGen': True}).nativeConstGen)
+
+    def test_routeExchange(self):
+        params = self.loadSpec({'routeInMemory': False, 'dumpRouteGds': True})
+        self.assertFalse(params.routeInMemory)
+        self.assertTrue(params.dumpRouteGds)
+
+    def test_mergeLayoutRects(self):
+        self.assertTrue(Params.Params().mergeLayoutRects)
+        self.assertFalse(self.loadSpec({'mergeLayoutRects': False}).mergeLayoutRects)
+
+    def test_asyncLogging(self):
+        self.assertTrue(Params.Params().asyncLogging)
+        self.assertFalse(self.loadSpec({'asyncLogging': False}).asyncLogging)
+
+    def test_roundTrip(self):
+        # As Flow.dispatchRemoteSubtrees writes the parameters of a remote worker
+        params = Params.Params()
+        for key, value in vars(params).items():
+            if isinstance(value, bool):
+                setattr(params, key, not value)
+            elif value is None or isinstance(value, str):
+                setattr(params, key, key + '.value')
+            elif isinstance(value, (int, float)):
+                setattr(params, key, value + 1)
+            elif isinstance(value, list):
+                setattr(params, key, value + [key])
+        loaded = self.loadSpec(dict(vars(params)))
+        defaults = vars(Params.Params())
+        for key, value in vars(params).items():
+            self.assertEqual(value, getattr(loaded, key), key)
+            self.assertNotEqual(defaults[key], getattr(loaded, key), key)
+
+if __name__ == '__main__':
+    unittest.main()